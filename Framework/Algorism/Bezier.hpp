@@ -1,8 +1,9 @@
 #pragma once
 #include <cassert>
-#include <map>
+#include <vector>
 
 #include "Curve.hpp"
+#include "MatrixComposeDecompose.hpp"
 #include "geommath.hpp"
 #include "numerical.hpp"
 
@@ -10,8 +11,9 @@ namespace My {
 template <typename TVAL, typename TPARAM>
 class Bezier : public CurveBase, public Curve<TVAL, TPARAM> {
    private:
-    std::map<TVAL, TVAL> m_IncomingControlPoints;
-    std::map<TVAL, TVAL> m_OutgoingControlPoints;
+    // by knot, in the same order
+    std::vector<TVAL> m_IncomingControlPoints;
+    std::vector<TVAL> m_OutgoingControlPoints;
 
    public:
     Bezier() : CurveBase(CurveType::kBezier) {}
@@ -42,10 +44,17 @@ class Bezier : public CurveBase, public Curve<TVAL, TPARAM> {
         }
     }
 
+    // control points of the knot added last
     void AddControlPoints(const TVAL knot, const TVAL incoming_cp,
                           const TVAL outgoing_cp) {
-        m_IncomingControlPoints.insert({knot, incoming_cp});
-        m_OutgoingControlPoints.insert({knot, outgoing_cp});
+        m_IncomingControlPoints.push_back(incoming_cp);
+        m_OutgoingControlPoints.push_back(outgoing_cp);
+    }
+
+    void GetControlPoints(size_t index, TVAL& incoming_cp,
+                          TVAL& outgoing_cp) const {
+        incoming_cp = m_IncomingControlPoints[index];
+        outgoing_cp = m_OutgoingControlPoints[index];
     }
 
     [[nodiscard]] TPARAM Reverse(TVAL t, size_t& index) const final {
@@ -76,11 +85,9 @@ class Bezier : public CurveBase, public Curve<TVAL, TPARAM> {
             break;
         }
 
-        TVAL c1, c2;
-        assert(m_OutgoingControlPoints.contains(t1));
-        assert(m_IncomingControlPoints.contains(t2));
-        c1 = m_OutgoingControlPoints.at(t1);
-        c2 = m_IncomingControlPoints.at(t2);
+        assert(index < m_IncomingControlPoints.size());
+        const TVAL c1 = m_OutgoingControlPoints[index - 1];
+        const TVAL c2 = m_IncomingControlPoints[index];
 
         typename NewtonRapson<TVAL, TPARAM>::nr_f f = [t2, t1, c2, c1,
                                                        t](TPARAM s) {
@@ -111,11 +118,9 @@ class Bezier : public CurveBase, public Curve<TVAL, TPARAM> {
             auto t1 = Curve<TVAL, TPARAM>::m_Knots[index - 1];
             auto t2 = Curve<TVAL, TPARAM>::m_Knots[index];
 
-            TVAL c1, c2;
-            assert(m_OutgoingControlPoints.contains(t1));
-            assert(m_IncomingControlPoints.contains(t2));
-            c1 = m_OutgoingControlPoints.at(t1);
-            c2 = m_IncomingControlPoints.at(t2);
+            assert(index < m_IncomingControlPoints.size());
+            const TVAL c1 = m_OutgoingControlPoints[index - 1];
+            const TVAL c2 = m_IncomingControlPoints[index];
 
             return (t2 - 3.0f * c2 + 3.0f * c1 - t1) * pow(s, 3.0f) +
                    3.0f * (c2 - 2.0f * c1 + t1) * pow(s, 2.0f) +
@@ -128,8 +133,9 @@ template <typename T>
 class Bezier<Quaternion<T>, T> : public CurveBase,
                                  public Curve<Quaternion<T>, T> {
    private:
-    std::map<Quaternion<T>, Quaternion<T>> m_IncomingControlPoints;
-    std::map<Quaternion<T>, Quaternion<T>> m_OutgoingControlPoints;
+    // by knot, in the same order
+    std::vector<Quaternion<T>> m_IncomingControlPoints;
+    std::vector<Quaternion<T>> m_OutgoingControlPoints;
 
    public:
     Bezier() : CurveBase(CurveType::kBezier) {}
@@ -161,27 +167,47 @@ class Bezier<Quaternion<T>, T> : public CurveBase,
         }
     }
 
+    // control points of the knot added last
     void AddControlPoints(const Quaternion<T>& knot,
                           const Quaternion<T>& incoming_cp,
                           const Quaternion<T>& outgoing_cp) {
-        assert(incoming_cp <= knot && knot <= outgoing_cp);
-        m_IncomingControlPoints.insert({knot, incoming_cp});
-        m_OutgoingControlPoints.insert({knot, outgoing_cp});
+        m_IncomingControlPoints.push_back(incoming_cp);
+        m_OutgoingControlPoints.push_back(outgoing_cp);
     }
 
-    T Reverse(Quaternion<T> t, size_t& index) const final {
-        T result = 0;
-        assert(0);
+    void GetControlPoints(size_t index, Quaternion<T>& incoming_cp,
+                          Quaternion<T>& outgoing_cp) const {
+        incoming_cp = m_IncomingControlPoints[index];
+        outgoing_cp = m_OutgoingControlPoints[index];
+    }
 
-        return result;
+    // along the arcs between the knots, the control points pull the curve
+    // off them only a little
+    T Reverse(Quaternion<T> t, size_t& index) const final {
+        return ReverseByDistance<Quaternion<T>, T>(
+            Curve<Quaternion<T>, T>::m_Knots, t, index,
+            QuaternionAngle<T>);
     }
 
     [[nodiscard]] Quaternion<T> Interpolate(T s,
                                             const size_t index) const final {
-        Quaternion<T> result{0};
-        assert(0);
+        if (Curve<Quaternion<T>, T>::m_Knots.empty())
+            return Quaternion<T>{0, 0, 0, 1};
 
-        return result;
+        if (Curve<Quaternion<T>, T>::m_Knots.size() == 1)
+            return Curve<Quaternion<T>, T>::m_Knots[0];
+        else if (Curve<Quaternion<T>, T>::m_Knots.size() < index + 1)
+            return Curve<Quaternion<T>, T>::m_Knots.back();
+        else if (index == 0)
+            return Curve<Quaternion<T>, T>::m_Knots.front();
+        else {
+            assert(index < m_IncomingControlPoints.size());
+            return QuaternionBezier(
+                Curve<Quaternion<T>, T>::m_Knots[index - 1],
+                m_OutgoingControlPoints[index - 1],
+                m_IncomingControlPoints[index],
+                Curve<Quaternion<T>, T>::m_Knots[index], s);
+        }
     }
 };
 
@@ -189,8 +215,9 @@ template <>
 class Bezier<Matrix4X4f, float> : public CurveBase,
                                   public Curve<Matrix4X4f, float> {
    private:
-    std::map<Matrix4X4f, Matrix4X4f> m_IncomingControlPoints;
-    std::map<Matrix4X4f, Matrix4X4f> m_OutgoingControlPoints;
+    // by knot, in the same order
+    std::vector<Matrix4X4f> m_IncomingControlPoints;
+    std::vector<Matrix4X4f> m_OutgoingControlPoints;
 
    public:
     Bezier() : CurveBase(CurveType::kBezier) {}
@@ -222,25 +249,76 @@ class Bezier<Matrix4X4f, float> : public CurveBase,
         }
     }
 
+    // control points of the knot added last
     void AddControlPoints(const Matrix4X4f& knot, const Matrix4X4f& incoming_cp,
                           const Matrix4X4f& outgoing_cp) {
-        assert(incoming_cp <= knot && knot <= outgoing_cp);
-        m_IncomingControlPoints.insert({knot, incoming_cp});
-        m_OutgoingControlPoints.insert({knot, outgoing_cp});
+        m_IncomingControlPoints.push_back(incoming_cp);
+        m_OutgoingControlPoints.push_back(outgoing_cp);
     }
 
-    float Reverse(Matrix4X4f t, size_t& index) const final {
-        float result = 0.0f;
-        assert(0);
+    void GetControlPoints(size_t index, Matrix4X4f& incoming_cp,
+                          Matrix4X4f& outgoing_cp) const {
+        incoming_cp = m_IncomingControlPoints[index];
+        outgoing_cp = m_OutgoingControlPoints[index];
+    }
 
-        return result;
+    // along the lines between the knots, as Linear does
+    float Reverse(Matrix4X4f t, size_t& index) const final {
+        return ReverseByDistance<Matrix4X4f, float>(
+            Curve<Matrix4X4f, float>::m_Knots, t, index,
+            [](const Matrix4X4f& a, const Matrix4X4f& b) {
+                float sum = 0.0f;
+                for (int r = 0; r < 4; r++) {
+                    for (int c = 0; c < 4; c++) {
+                        sum += (a[r][c] - b[r][c]) * (a[r][c] - b[r][c]);
+                    }
+                }
+                return std::sqrt(sum);
+            });
     }
 
+    // the knots and control points decomposed, the scale and translation
+    // on cubics and the rotation on a spherical Bezier
     [[nodiscard]] Matrix4X4f Interpolate(float s,
                                          const size_t index) const final {
         Matrix4X4f result;
         BuildIdentityMatrix(result);
-        assert(0);
+        if (Curve<Matrix4X4f, float>::m_Knots.empty()) return result;
+        if (Curve<Matrix4X4f, float>::m_Knots.size() == 1)
+            return Curve<Matrix4X4f, float>::m_Knots[0];
+        else if (Curve<Matrix4X4f, float>::m_Knots.size() < index + 1)
+            return Curve<Matrix4X4f, float>::m_Knots.back();
+        else if (index == 0)
+            return Curve<Matrix4X4f, float>::m_Knots.front();
+        else {
+            assert(index < m_IncomingControlPoints.size());
+            const Matrix4X4f points[4] = {
+                Curve<Matrix4X4f, float>::m_Knots[index - 1],
+                m_OutgoingControlPoints[index - 1],
+                m_IncomingControlPoints[index],
+                Curve<Matrix4X4f, float>::m_Knots[index]};
+
+            Quaternion<float> rotations[4];
+            Vector3f scalars[4], translations[4];
+            for (int i = 0; i < 4; i++) {
+                Matrix4X4fDecompose(points[i], rotations[i], scalars[i],
+                                    translations[i]);
+            }
+
+            const float t = 1.0f - s;
+            const float weights[4] = {t * t * t, 3.0f * t * t * s,
+                                      3.0f * t * s * s, s * s * s};
+            Vector3f scalar({0.0f, 0.0f, 0.0f});
+            Vector3f translation({0.0f, 0.0f, 0.0f});
+            for (int i = 0; i < 4; i++) {
+                scalar = scalar + weights[i] * scalars[i];
+                translation = translation + weights[i] * translations[i];
+            }
+            const auto rotation = QuaternionBezier(
+                rotations[0], rotations[1], rotations[2], rotations[3], s);
+
+            Matrix4X4fCompose(result, rotation, scalar, translation);
+        }
 
         return result;
     }
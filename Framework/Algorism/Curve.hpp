@@ -1,4 +1,5 @@
 #pragma once
+#include <limits>
 #include <vector>
 
 #include "portable.hpp"
@@ -27,5 +28,32 @@ class Curve {
     [[nodiscard]] virtual TVAL Interpolate(TPARAM t,
                                            const size_t index) const = 0;
     void AddKnot(const TVAL knot) { m_Knots.push_back(knot); }
+    [[nodiscard]] const std::vector<TVAL>& GetKnots() const { return m_Knots; }
 };
+
+// Reverse() for values with no order, such as rotations: the segment
+// passing closest to v, and how far along it v is, by distance(a, b)
+// between two values
+template <typename TVAL, typename TPARAM, typename DISTANCE>
+TPARAM ReverseByDistance(const std::vector<TVAL>& knots, const TVAL& v,
+                         size_t& index, DISTANCE distance) {
+    index = 0;
+    if (knots.size() < 2) return TPARAM(0);
+
+    TPARAM result = 0;
+    TPARAM nearest = std::numeric_limits<TPARAM>::max();
+    for (size_t i = 1; i < knots.size(); i++) {
+        const TPARAM d1 = distance(knots[i - 1], v);
+        const TPARAM d2 = distance(v, knots[i]);
+        // how far out of the way of the segment v is
+        const TPARAM detour = d1 + d2 - distance(knots[i - 1], knots[i]);
+        if (detour < nearest) {
+            nearest = detour;
+            index = i;
+            result = d1 + d2 > 0 ? d1 / (d1 + d2) : TPARAM(0);
+        }
+    }
+
+    return result;
+}
 }  // namespace My
@@ -0,0 +1,62 @@
+#pragma once
+#include <cmath>
+
+#include "geommath.hpp"
+
+namespace My {
+// View frustum as 6 inward facing planes (a, b, c, d), a point p is inside
+// a plane when a * p.x + b * p.y + c * p.z + d >= 0.
+// Planes are extracted from a (model *) view * projection matrix in our row
+// vector convention (Gribb & Hartmann), so passing model * view * projection
+// gives the frustum in object space.
+template <class T>
+struct Frustum {
+    enum { kLeft = 0, kRight, kBottom, kTop, kNear, kFar, kPlaneCount };
+
+    Vector4<T> planes[kPlaneCount];
+
+    Frustum() = default;
+
+    // zero_to_one_depth: clip space depth is [0, 1] (D3D, Vulkan, Metal)
+    // rather than [-1, 1] (OpenGL)
+    explicit Frustum(const Matrix4X4<T>& m, bool zero_to_one_depth = true) {
+        auto column = [&m](int j) {
+            return Vector4<T>({m[0][j], m[1][j], m[2][j], m[3][j]});
+        };
+
+        const auto c0 = column(0);
+        const auto c1 = column(1);
+        const auto c2 = column(2);
+        const auto c3 = column(3);
+
+        planes[kLeft] = c3 + c0;
+        planes[kRight] = c3 - c0;
+        planes[kBottom] = c3 + c1;
+        planes[kTop] = c3 - c1;
+        planes[kNear] = zero_to_one_depth ? c2 : c3 + c2;
+        planes[kFar] = c3 - c2;
+
+        for (auto& plane : planes) {
+            const T l = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] +
+                                  plane[2] * plane[2]);
+            if (l > 0) plane = plane * (T(1) / l);
+        }
+    }
+
+    [[nodiscard]] T Distance(int plane, const Vector3<T>& p) const {
+        return planes[plane][0] * p[0] + planes[plane][1] * p[1] +
+               planes[plane][2] * p[2] + planes[plane][3];
+    }
+
+    // false only when the sphere is completely outside of the frustum
+    [[nodiscard]] bool IntersectSphere(const Vector3<T>& center,
+                                       T radius) const {
+        for (int i = 0; i < kPlaneCount; i++) {
+            if (Distance(i, center) < -radius) return false;
+        }
+        return true;
+    }
+};
+
+using Frustumf = Frustum<float>;
+}  // namespace My
@@ -0,0 +1,1053 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "geommath.hpp"
+
+// GJK distance and EPA penetration depth between convex shapes, without any
+// heap allocation: the simplex and the EPA polytope live on the stack and
+// the support mappings are resolved at compile time for each pair of shape
+// types.
+//
+// Shapes give their support mapping in their own space, ConvexInstance
+// places a shape in the world.
+
+namespace My {
+constexpr uint32_t kMaxConvexContactPoints = 4;
+// largest polygon returned by SupportFace()
+constexpr uint32_t kMaxSupportFacePoints = 32;
+
+namespace details {
+template <typename T>
+inline T dot(const Vector3<T>& a, const Vector3<T>& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+template <typename T>
+inline Vector3<T> cross(const Vector3<T>& a, const Vector3<T>& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0]};
+}
+
+template <typename T>
+inline T length_squared(const Vector3<T>& v) {
+    return dot(v, v);
+}
+}  // namespace details
+
+// a point, used to run GJK on the center of a sphere
+template <typename T>
+struct PointSupport {
+    using value_type = T;
+
+    [[nodiscard]] Vector3<T> Support(const Vector3<T>&) const {
+        return Vector3<T>(0);
+    }
+
+    uint32_t SupportFace(const Vector3<T>& direction, Vector3<T>* points,
+                         Vector3<T>& normal) const {
+        points[0] = Vector3<T>(0);
+        normal = direction;
+        return 1;
+    }
+};
+
+template <typename T>
+struct SphereSupport {
+    using value_type = T;
+    T radius;
+
+    [[nodiscard]] Vector3<T> Support(const Vector3<T>& direction) const {
+        const T length = std::sqrt(details::length_squared(direction));
+        if (length <= std::numeric_limits<T>::min()) {
+            return {radius, 0, 0};
+        }
+        return direction * (radius / length);
+    }
+
+    uint32_t SupportFace(const Vector3<T>& direction, Vector3<T>* points,
+                         Vector3<T>& normal) const {
+        points[0] = Support(direction);
+        normal = direction;
+        return 1;
+    }
+};
+
+template <typename T>
+struct BoxSupport {
+    using value_type = T;
+    Vector3<T> halfExtents;
+
+    [[nodiscard]] Vector3<T> Support(const Vector3<T>& direction) const {
+        return {(direction[0] < 0) ? -halfExtents[0] : halfExtents[0],
+                (direction[1] < 0) ? -halfExtents[1] : halfExtents[1],
+                (direction[2] < 0) ? -halfExtents[2] : halfExtents[2]};
+    }
+
+    // the face most aligned with direction, counter clockwise seen from
+    // outside
+    uint32_t SupportFace(const Vector3<T>& direction, Vector3<T>* points,
+                         Vector3<T>& normal) const {
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (std::abs(direction[i]) > std::abs(direction[axis])) axis = i;
+        }
+        const T sign = (direction[axis] < 0) ? T(-1) : T(1);
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+
+        normal = Vector3<T>(0);
+        normal[axis] = sign;
+
+        const T corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+        for (int i = 0; i < 4; i++) {
+            // (u, v, axis) is right handed, walk the other way on the
+            // negative side
+            const int k = (sign > 0) ? i : 3 - i;
+            auto& p = points[i];
+            p[axis] = sign * halfExtents[axis];
+            p[u] = corners[k][0] * halfExtents[u];
+            p[v] = corners[k][1] * halfExtents[v];
+        }
+        return 4;
+    }
+};
+
+// Convex polyhedron given by its vertices. Faces are optional, they give
+// contact manifolds of several points.
+template <typename T>
+struct ConvexHullSupport {
+    using value_type = T;
+    std::vector<Vector3<T>> vertices;
+    // vertex indices of each face, counter clockwise seen from outside,
+    // face i is [faceOffsets[i], faceOffsets[i + 1])
+    std::vector<uint32_t> faceIndices;
+    std::vector<uint32_t> faceOffsets{0};
+    std::vector<Vector3<T>> faceNormals;
+
+    void AddFace(const uint32_t* indices, uint32_t count) {
+        assert(count >= 3);
+        // Newell's method, robust to slightly non planar faces
+        Vector3<T> normal(0);
+        for (uint32_t i = 0; i < count; i++) {
+            const auto& a = vertices[indices[i]];
+            const auto& b = vertices[indices[(i + 1) % count]];
+            normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+            normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+            normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+        }
+        const T length = std::sqrt(details::length_squared(normal));
+        faceNormals.push_back(normal * (T(1) / length));
+        faceIndices.insert(faceIndices.end(), indices, indices + count);
+        faceOffsets.push_back(static_cast<uint32_t>(faceIndices.size()));
+    }
+
+    [[nodiscard]] size_t GetFaceCount() const { return faceNormals.size(); }
+
+    [[nodiscard]] Vector3<T> Support(const Vector3<T>& direction) const {
+        assert(!vertices.empty());
+        size_t best = 0;
+        T best_score = details::dot(vertices[0], direction);
+        for (size_t i = 1; i < vertices.size(); i++) {
+            const T score = details::dot(vertices[i], direction);
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+        return vertices[best];
+    }
+
+    uint32_t SupportFace(const Vector3<T>& direction, Vector3<T>* points,
+                         Vector3<T>& normal) const {
+        if (faceNormals.empty()) {
+            points[0] = Support(direction);
+            normal = direction;
+            return 1;
+        }
+
+        size_t best = 0;
+        T best_score = details::dot(faceNormals[0], direction);
+        for (size_t i = 1; i < faceNormals.size(); i++) {
+            const T score = details::dot(faceNormals[i], direction);
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+
+        normal = faceNormals[best];
+        const uint32_t begin = faceOffsets[best];
+        const uint32_t count =
+            std::min(faceOffsets[best + 1] - begin, kMaxSupportFacePoints);
+        for (uint32_t i = 0; i < count; i++) {
+            points[i] = vertices[faceIndices[begin + i]];
+        }
+        return count;
+    }
+};
+
+// dot(normal, x) <= intercept, in the space of the shape. Not a support
+// shape, pairs with a half space have their own closed form.
+template <typename T>
+struct HalfSpace {
+    using value_type = T;
+    Vector3<T> normal;
+    T intercept;
+};
+
+// A shape placed in the world: axis holds the world images of the shape
+// axes (no scale), position the world position of its origin.
+template <class Shape>
+struct ConvexInstance {
+    using T = typename Shape::value_type;
+
+    const Shape& shape;
+    Vector3<T> position;
+    Vector3<T> axis[3];
+
+    ConvexInstance(const Shape& shape_, const Vector3<T>& position_)
+        : shape(shape_), position(position_) {
+        axis[0] = {1, 0, 0};
+        axis[1] = {0, 1, 0};
+        axis[2] = {0, 0, 1};
+    }
+
+    ConvexInstance(const Shape& shape_, const Vector3<T>& position_,
+                   const Vector3<T> axis_[3])
+        : shape(shape_), position(position_) {
+        axis[0] = axis_[0];
+        axis[1] = axis_[1];
+        axis[2] = axis_[2];
+    }
+
+    [[nodiscard]] Vector3<T> ToLocalDirection(const Vector3<T>& v) const {
+        return {details::dot(v, axis[0]), details::dot(v, axis[1]),
+                details::dot(v, axis[2])};
+    }
+
+    [[nodiscard]] Vector3<T> ToWorldDirection(const Vector3<T>& v) const {
+        return axis[0] * v[0] + axis[1] * v[1] + axis[2] * v[2];
+    }
+
+    [[nodiscard]] Vector3<T> Support(const Vector3<T>& direction) const {
+        return position +
+               ToWorldDirection(shape.Support(ToLocalDirection(direction)));
+    }
+
+    uint32_t SupportFace(const Vector3<T>& direction, Vector3<T>* points,
+                         Vector3<T>& normal) const {
+        const uint32_t count =
+            shape.SupportFace(ToLocalDirection(direction), points, normal);
+        for (uint32_t i = 0; i < count; i++) {
+            points[i] = position + ToWorldDirection(points[i]);
+        }
+        normal = ToWorldDirection(normal);
+        return count;
+    }
+};
+
+// a vertex of the Minkowski difference A - B, with the points of A and B
+// it comes from
+template <typename T>
+struct SupportPoint {
+    Vector3<T> w;
+    Vector3<T> a;
+    Vector3<T> b;
+};
+
+template <typename T>
+struct Simplex {
+    SupportPoint<T> points[4];
+    // barycentric coordinates of the point closest to the origin
+    T lambda[4];
+    uint32_t count = 0;
+};
+
+template <typename T>
+struct GjkResult {
+    bool intersecting;
+    T distance;
+    // closest points, on A and on B
+    Vector3<T> pointA;
+    Vector3<T> pointB;
+    uint32_t iterations;
+};
+
+template <typename T>
+struct ConvexContact {
+    Vector3<T> normal;  // from A to B
+    uint32_t pointCount;
+    // half way between the two surfaces
+    Vector3<T> points[kMaxConvexContactPoints];
+    T depths[kMaxConvexContactPoints];
+};
+
+namespace details {
+constexpr uint32_t kMaxGjkIterations = 64;
+constexpr uint32_t kMaxEpaVertices = 64;
+constexpr uint32_t kMaxEpaFaces = 2 * kMaxEpaVertices;
+
+template <typename T>
+constexpr T gjk_tolerance() {
+    // squared distances below this, relative to the size of the simplex,
+    // count as touching
+    return std::numeric_limits<T>::epsilon();
+}
+
+template <class A, class B>
+inline SupportPoint<typename A::T> support_point(
+    const A& a, const B& b, const Vector3<typename A::T>& direction) {
+    SupportPoint<typename A::T> result;
+    result.a = a.Support(direction);
+    result.b = b.Support(-direction);
+    result.w = result.a - result.b;
+    return result;
+}
+
+// The closest point to the origin on the simplex. The simplex is reduced to
+// the vertices needed to express it, lambda holds their weights. Returns
+// false if the simplex is a tetrahedron containing the origin.
+
+template <typename T>
+Vector3<T> closest_on_segment(Simplex<T>& s) {
+    const Vector3<T> a = s.points[0].w;
+    const Vector3<T> ab = s.points[1].w - a;
+    const T denominator = length_squared(ab);
+    const T t = (denominator > 0) ? -dot(a, ab) / denominator : T(0);
+
+    if (t <= 0) {
+        s.count = 1;
+        s.lambda[0] = 1;
+        return a;
+    }
+    if (t >= 1) {
+        s.points[0] = s.points[1];
+        s.count = 1;
+        s.lambda[0] = 1;
+        return s.points[0].w;
+    }
+    s.lambda[0] = 1 - t;
+    s.lambda[1] = t;
+    return a + ab * t;
+}
+
+// Ericson, Real-Time Collision Detection, 5.1.5, with the origin as query
+template <typename T>
+Vector3<T> closest_on_triangle(Simplex<T>& s) {
+    const SupportPoint<T> A = s.points[0];
+    const SupportPoint<T> B = s.points[1];
+    const SupportPoint<T> C = s.points[2];
+    const Vector3<T> ab = B.w - A.w;
+    const Vector3<T> ac = C.w - A.w;
+
+    auto set1 = [&](const SupportPoint<T>& p) {
+        s.points[0] = p;
+        s.count = 1;
+        s.lambda[0] = 1;
+        return p.w;
+    };
+    auto set2 = [&](const SupportPoint<T>& p, const SupportPoint<T>& q,
+                    T t) {
+        s.points[0] = p;
+        s.points[1] = q;
+        s.count = 2;
+        s.lambda[0] = 1 - t;
+        s.lambda[1] = t;
+        return p.w + (q.w - p.w) * t;
+    };
+
+    const T d1 = -dot(ab, A.w);
+    const T d2 = -dot(ac, A.w);
+    if (d1 <= 0 && d2 <= 0) return set1(A);
+
+    const T d3 = -dot(ab, B.w);
+    const T d4 = -dot(ac, B.w);
+    if (d3 >= 0 && d4 <= d3) return set1(B);
+
+    const T vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return set2(A, B, d1 / (d1 - d3));
+
+    const T d5 = -dot(ab, C.w);
+    const T d6 = -dot(ac, C.w);
+    if (d6 >= 0 && d5 <= d6) return set1(C);
+
+    const T vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return set2(A, C, d2 / (d2 - d6));
+
+    const T va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return set2(B, C, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const T denominator = va + vb + vc;
+    if (denominator <= 0) {
+        // degenerate triangle, keep its longest edge
+        s.count = 2;
+        if (length_squared(ac) > length_squared(ab)) s.points[1] = C;
+        return closest_on_segment(s);
+    }
+    const T v = vb / denominator;
+    const T w = vc / denominator;
+    s.lambda[0] = 1 - v - w;
+    s.lambda[1] = v;
+    s.lambda[2] = w;
+    return A.w + ab * v + ac * w;
+}
+
+template <typename T>
+bool closest_on_tetrahedron(Simplex<T>& s, Vector3<T>& closest) {
+    const SupportPoint<T> p[4] = {s.points[0], s.points[1], s.points[2],
+                                  s.points[3]};
+    // faces with the vertex opposite to them
+    const int faces[4][4] = {
+        {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+    bool outside_any = false;
+    T best_distance = std::numeric_limits<T>::max();
+    Simplex<T> best;
+
+    for (const auto& f : faces) {
+        const Vector3<T>& a = p[f[0]].w;
+        const Vector3<T> n = cross(p[f[1]].w - a, p[f[2]].w - a);
+        const T sign_origin = -dot(a, n);
+        const T sign_opposite = dot(p[f[3]].w - a, n);
+        // a flat tetrahedron has the origin outside of all its faces
+        if (sign_origin * sign_opposite > 0) continue;
+
+        outside_any = true;
+        Simplex<T> face;
+        face.points[0] = p[f[0]];
+        face.points[1] = p[f[1]];
+        face.points[2] = p[f[2]];
+        face.count = 3;
+        const Vector3<T> q = closest_on_triangle(face);
+        const T distance = length_squared(q);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = face;
+            closest = q;
+        }
+    }
+
+    if (!outside_any) return false;
+
+    s = best;
+    return true;
+}
+
+template <typename T>
+void witness_points(const Simplex<T>& s, Vector3<T>& a, Vector3<T>& b) {
+    a = Vector3<T>(0);
+    b = Vector3<T>(0);
+    for (uint32_t i = 0; i < s.count; i++) {
+        a = a + s.points[i].a * s.lambda[i];
+        b = b + s.points[i].b * s.lambda[i];
+    }
+}
+}  // namespace details
+
+// Distance between two convex shapes. Returns true if they intersect, the
+// simplex then encloses the origin (or nearly touches it) and is ready for
+// Epa(). Otherwise result has the distance and the closest points.
+template <class A, class B>
+bool GjkDistance(const A& a, const B& b, Simplex<typename A::T>& simplex,
+                 GjkResult<typename A::T>& result) {
+    using T = typename A::T;
+    using namespace details;
+
+    Vector3<T> v = a.position - b.position;
+    if (length_squared(v) <= std::numeric_limits<T>::min()) v = {1, 0, 0};
+
+    simplex.points[0] = support_point(a, b, -v);
+    simplex.lambda[0] = 1;
+    simplex.count = 1;
+    v = simplex.points[0].w;
+
+    result.intersecting = false;
+    result.iterations = 0;
+
+    const T tolerance = gjk_tolerance<T>();
+    const T relative_tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+
+    while (result.iterations++ < kMaxGjkIterations) {
+        const T distance_squared = length_squared(v);
+
+        T max_norm = 0;
+        for (uint32_t i = 0; i < simplex.count; i++) {
+            max_norm = std::max(max_norm, length_squared(simplex.points[i].w));
+        }
+        if (distance_squared <= tolerance * max_norm) {
+            result.intersecting = true;
+            break;
+        }
+
+        const SupportPoint<T> w = support_point(a, b, -v);
+
+        // no progress toward the origin, v is the closest point
+        if (distance_squared - dot(v, w.w) <=
+            relative_tolerance * relative_tolerance * distance_squared) {
+            break;
+        }
+
+        bool duplicate = false;
+        for (uint32_t i = 0; i < simplex.count; i++) {
+            if (length_squared(simplex.points[i].w - w.w) <=
+                tolerance * distance_squared) {
+                duplicate = true;
+            }
+        }
+        if (duplicate) break;
+
+        simplex.points[simplex.count++] = w;
+
+        switch (simplex.count) {
+            case 2:
+                v = closest_on_segment(simplex);
+                break;
+            case 3:
+                v = closest_on_triangle(simplex);
+                break;
+            case 4:
+                if (!closest_on_tetrahedron(simplex, v)) {
+                    result.intersecting = true;
+                }
+                break;
+        }
+
+        if (result.intersecting) break;
+    }
+
+    if (result.intersecting) {
+        result.distance = 0;
+    } else {
+        result.distance = std::sqrt(length_squared(v));
+    }
+    witness_points(simplex, result.pointA, result.pointB);
+
+    return result.intersecting;
+}
+
+// Penetration depth and direction of two intersecting shapes, from the
+// simplex left by GjkDistance(). normal goes from A to B: moving B by
+// normal * depth separates the shapes. Returns false on degenerate input.
+template <class A, class B>
+bool Epa(const A& a, const B& b, Simplex<typename A::T>& simplex,
+         Vector3<typename A::T>& normal, typename A::T& depth,
+         Vector3<typename A::T>& point_a, Vector3<typename A::T>& point_b) {
+    using T = typename A::T;
+    using namespace details;
+
+    const T tolerance = std::sqrt(std::numeric_limits<T>::epsilon());
+
+    // grow the simplex to a tetrahedron, the origin may lie on its border
+    if (simplex.count == 1) {
+        const Vector3<T> directions[6] = {{1, 0, 0},  {-1, 0, 0}, {0, 1, 0},
+                                          {0, -1, 0}, {0, 0, 1},  {0, 0, -1}};
+        for (const auto& d : directions) {
+            const auto w = support_point(a, b, d);
+            if (length_squared(w.w - simplex.points[0].w) > tolerance) {
+                simplex.points[simplex.count++] = w;
+                break;
+            }
+        }
+    }
+    if (simplex.count == 2) {
+        const Vector3<T> line = simplex.points[1].w - simplex.points[0].w;
+        // any direction orthogonal to the line, and a second one
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (std::abs(line[i]) < std::abs(line[axis])) axis = i;
+        }
+        Vector3<T> e(0);
+        e[axis] = 1;
+        const Vector3<T> d1 = cross(line, e);
+        const Vector3<T> d2 = cross(line, d1);
+        for (const auto& d : {d1, -d1, d2, -d2}) {
+            const auto w = support_point(a, b, d);
+            if (length_squared(cross(w.w - simplex.points[0].w, line)) >
+                tolerance * length_squared(line)) {
+                simplex.points[simplex.count++] = w;
+                break;
+            }
+        }
+    }
+    if (simplex.count == 3) {
+        const Vector3<T> n =
+            cross(simplex.points[1].w - simplex.points[0].w,
+                  simplex.points[2].w - simplex.points[0].w);
+        for (const auto& d : {n, -n}) {
+            const auto w = support_point(a, b, d);
+            if (std::abs(dot(w.w - simplex.points[0].w, n)) >
+                tolerance * std::sqrt(length_squared(n))) {
+                simplex.points[simplex.count++] = w;
+                break;
+            }
+        }
+    }
+    if (simplex.count < 4) return false;
+
+    struct Face {
+        uint32_t v[3];
+        Vector3<T> normal;
+        T distance;
+    };
+
+    SupportPoint<T> vertices[kMaxEpaVertices];
+    Face faces[kMaxEpaFaces];
+    uint32_t vertex_count = 4;
+    uint32_t face_count = 0;
+    for (uint32_t i = 0; i < 4; i++) vertices[i] = simplex.points[i];
+
+    auto add_face = [&](uint32_t i, uint32_t j, uint32_t k) {
+        if (face_count == kMaxEpaFaces) return false;
+        Vector3<T> n = cross(vertices[j].w - vertices[i].w,
+                             vertices[k].w - vertices[i].w);
+        const T length = std::sqrt(length_squared(n));
+        if (length <= std::numeric_limits<T>::min()) return false;
+        n = n * (T(1) / length);
+
+        auto& face = faces[face_count++];
+        face.v[0] = i;
+        face.v[1] = j;
+        face.v[2] = k;
+        face.normal = n;
+        face.distance = dot(n, vertices[i].w);
+        return true;
+    };
+
+    // outward faces of the tetrahedron
+    {
+        const T volume = dot(vertices[1].w - vertices[0].w,
+                             cross(vertices[2].w - vertices[0].w,
+                                   vertices[3].w - vertices[0].w));
+        if (volume < 0) std::swap(vertices[1], vertices[2]);
+        if (!add_face(0, 2, 1) || !add_face(0, 1, 3) || !add_face(0, 3, 2) ||
+            !add_face(1, 2, 3)) {
+            return false;
+        }
+    }
+
+    uint32_t closest = 0;
+    while (true) {
+        closest = 0;
+        for (uint32_t i = 1; i < face_count; i++) {
+            if (faces[i].distance < faces[closest].distance) closest = i;
+        }
+
+        const Face face = faces[closest];
+        const SupportPoint<T> w = support_point(a, b, face.normal);
+        const T progress = dot(w.w, face.normal) - face.distance;
+        if (progress <= tolerance * std::max(T(1), face.distance) ||
+            vertex_count == kMaxEpaVertices) {
+            break;
+        }
+
+        const uint32_t new_vertex = vertex_count++;
+        vertices[new_vertex] = w;
+
+        // remove the faces seen from w, the edges they share cancel out and
+        // what is left is the horizon
+        uint32_t edges[kMaxEpaFaces * 3][2];
+        uint32_t edge_count = 0;
+        auto add_edge = [&](uint32_t i, uint32_t j) {
+            for (uint32_t e = 0; e < edge_count; e++) {
+                if (edges[e][0] == j && edges[e][1] == i) {
+                    edges[e][0] = edges[edge_count - 1][0];
+                    edges[e][1] = edges[edge_count - 1][1];
+                    edge_count--;
+                    return;
+                }
+            }
+            edges[edge_count][0] = i;
+            edges[edge_count][1] = j;
+            edge_count++;
+        };
+
+        for (uint32_t i = 0; i < face_count;) {
+            const Face& f = faces[i];
+            if (dot(f.normal, w.w - vertices[f.v[0]].w) > 0) {
+                add_edge(f.v[0], f.v[1]);
+                add_edge(f.v[1], f.v[2]);
+                add_edge(f.v[2], f.v[0]);
+                faces[i] = faces[--face_count];
+            } else {
+                i++;
+            }
+        }
+
+        for (uint32_t e = 0; e < edge_count; e++) {
+            if (!add_face(edges[e][0], edges[e][1], new_vertex)) {
+                // out of room or flat, the closest face so far will do
+                break;
+            }
+        }
+
+        if (face_count == 0) return false;
+    }
+
+    const Face& face = faces[closest];
+    normal = face.normal;
+    depth = face.distance;
+
+    // barycentric coordinates of the projection of the origin
+    const Vector3<T> p = face.normal * face.distance;
+    const Vector3<T>& v0 = vertices[face.v[0]].w;
+    const Vector3<T>& v1 = vertices[face.v[1]].w;
+    const Vector3<T>& v2 = vertices[face.v[2]].w;
+    const T area = dot(cross(v1 - v0, v2 - v0), face.normal);
+    T l1 = dot(cross(p - v0, v2 - v0), face.normal) / area;
+    T l2 = dot(cross(v1 - v0, p - v0), face.normal) / area;
+    l1 = std::clamp(l1, T(0), T(1));
+    l2 = std::clamp(l2, T(0), T(1) - l1);
+    const T l0 = 1 - l1 - l2;
+
+    point_a = vertices[face.v[0]].a * l0 + vertices[face.v[1]].a * l1 +
+              vertices[face.v[2]].a * l2;
+    point_b = vertices[face.v[0]].b * l0 + vertices[face.v[1]].b * l1 +
+              vertices[face.v[2]].b * l2;
+
+    return true;
+}
+
+namespace details {
+// reference faces more tilted than this from the normal give a single point
+template <typename T>
+constexpr T kFaceContactAlignment = T(0.95);
+
+// keeps the deepest point, the point farthest from it, and the two points
+// which make the largest area with them
+template <typename T>
+void reduce_contacts(const Vector3<T>* points, const T* depths, uint32_t count,
+                     ConvexContact<T>& contact) {
+    if (count <= kMaxConvexContactPoints) {
+        for (uint32_t i = 0; i < count; i++) {
+            contact.points[i] = points[i];
+            contact.depths[i] = depths[i];
+        }
+        contact.pointCount = count;
+        return;
+    }
+
+    uint32_t chosen[4];
+    chosen[0] = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        if (depths[i] > depths[chosen[0]]) chosen[0] = i;
+    }
+
+    chosen[1] = chosen[0];
+    T best = -1;
+    for (uint32_t i = 0; i < count; i++) {
+        const T d = length_squared(points[i] - points[chosen[0]]);
+        if (d > best) {
+            best = d;
+            chosen[1] = i;
+        }
+    }
+
+    const Vector3<T>& a = points[chosen[0]];
+    const Vector3<T>& b = points[chosen[1]];
+    const Vector3<T> reference = cross(b - a, contact.normal);
+
+    // the farthest point on each side of the line ab
+    chosen[2] = chosen[0];
+    chosen[3] = chosen[1];
+    T best_positive = 0;
+    T best_negative = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const T side = dot(points[i] - a, reference);
+        if (side > best_positive) {
+            best_positive = side;
+            chosen[2] = i;
+        } else if (side < best_negative) {
+            best_negative = side;
+            chosen[3] = i;
+        }
+    }
+
+    contact.pointCount = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        bool duplicate = false;
+        for (uint32_t j = 0; j < i; j++) {
+            if (chosen[j] == chosen[i]) duplicate = true;
+        }
+        if (duplicate) continue;
+        contact.points[contact.pointCount] = points[chosen[i]];
+        contact.depths[contact.pointCount] = depths[chosen[i]];
+        contact.pointCount++;
+    }
+}
+
+// Clips the incident polygon against the side planes of the reference
+// polygon (Sutherland-Hodgman) and keeps the points below the reference
+// face. Returns false if nothing is left.
+template <typename T>
+bool clip_faces(const Vector3<T>* reference, uint32_t reference_count,
+                const Vector3<T>& reference_normal, const Vector3<T>* incident,
+                uint32_t incident_count, bool flip,
+                ConvexContact<T>& contact) {
+    constexpr uint32_t kCapacity = 2 * kMaxSupportFacePoints;
+    Vector3<T> buffers[2][kCapacity];
+    uint32_t count = std::min(incident_count, kCapacity);
+    for (uint32_t i = 0; i < count; i++) buffers[0][i] = incident[i];
+
+    int current = 0;
+    for (uint32_t e = 0; e < reference_count && count; e++) {
+        const Vector3<T>& r0 = reference[e];
+        const Vector3<T>& r1 = reference[(e + 1) % reference_count];
+        const Vector3<T> side = cross(r1 - r0, reference_normal);
+
+        const Vector3<T>* in = buffers[current];
+        Vector3<T>* out = buffers[current ^ 1];
+        uint32_t out_count = 0;
+
+        for (uint32_t i = 0; i < count; i++) {
+            const Vector3<T>& p = in[i];
+            const Vector3<T>& q = in[(i + 1) % count];
+            const T dp = dot(side, p - r0);
+            const T dq = dot(side, q - r0);
+
+            if (dp <= 0 && out_count < kCapacity) out[out_count++] = p;
+            if ((dp < 0) != (dq < 0) && out_count < kCapacity) {
+                out[out_count++] = p + (q - p) * (dp / (dp - dq));
+            }
+        }
+
+        count = out_count;
+        current ^= 1;
+    }
+
+    Vector3<T> points[kCapacity];
+    T depths[kCapacity];
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const Vector3<T>& p = buffers[current][i];
+        const T separation = dot(reference_normal, p - reference[0]);
+        if (separation > 0) continue;
+
+        // clipping on a corner gives the same point twice
+        const Vector3<T> point = p - reference_normal * (separation * T(0.5));
+        bool duplicate = false;
+        for (uint32_t j = 0; j < kept; j++) {
+            if (length_squared(points[j] - point) <=
+                gjk_tolerance<T>() * (T(1) + length_squared(point))) {
+                duplicate = true;
+            }
+        }
+        if (duplicate) continue;
+
+        points[kept] = point;
+        depths[kept] = -separation;
+        kept++;
+    }
+    if (!kept) return false;
+
+    contact.normal = flip ? -reference_normal : reference_normal;
+    reduce_contacts(points, depths, kept, contact);
+    return true;
+}
+
+// Contact points around the deepest point found by EPA: if the features of
+// A and B facing each other are faces, the points of their overlap
+template <class A, class B>
+void generate_contacts(const A& a, const B& b,
+                       const Vector3<typename A::T>& normal,
+                       typename A::T depth,
+                       const Vector3<typename A::T>& point,
+                       ConvexContact<typename A::T>& contact) {
+    using T = typename A::T;
+
+    Vector3<T> face_a[kMaxSupportFacePoints];
+    Vector3<T> face_b[kMaxSupportFacePoints];
+    Vector3<T> normal_a, normal_b;
+    const uint32_t count_a = a.SupportFace(normal, face_a, normal_a);
+    const uint32_t count_b = b.SupportFace(-normal, face_b, normal_b);
+
+    if (count_a >= 3 && count_b >= 3) {
+        const T alignment_a = dot(normal_a, normal);
+        const T alignment_b = -dot(normal_b, normal);
+
+        if (alignment_a >= alignment_b &&
+            alignment_a > kFaceContactAlignment<T>) {
+            if (clip_faces(face_a, count_a, normal_a, face_b, count_b, false,
+                           contact)) {
+                return;
+            }
+        } else if (alignment_b > kFaceContactAlignment<T>) {
+            if (clip_faces(face_b, count_b, normal_b, face_a, count_a, true,
+                           contact)) {
+                return;
+            }
+        }
+    }
+
+    contact.normal = normal;
+    contact.pointCount = 1;
+    contact.points[0] = point;
+    contact.depths[0] = depth;
+}
+}  // namespace details
+
+// Contact between two convex shapes: GJK, then EPA if they intersect, then
+// face clipping for a manifold of up to four points. Returns false if the
+// shapes are apart.
+template <class A, class B>
+bool CollideConvex(const A& a, const B& b,
+                   ConvexContact<typename A::T>& contact) {
+    using T = typename A::T;
+
+    Simplex<T> simplex;
+    GjkResult<T> gjk;
+    if (!GjkDistance(a, b, simplex, gjk)) return false;
+
+    Vector3<T> normal, point_a, point_b;
+    T depth;
+    if (!Epa(a, b, simplex, normal, depth, point_a, point_b)) return false;
+
+    details::generate_contacts(a, b, normal, depth,
+                               (point_a + point_b) * T(0.5), contact);
+    return true;
+}
+
+// Spheres are their center point inflated by the radius: GJK on the center
+// gives the contact directly, EPA is only needed when the center is inside
+// the other shape.
+template <typename T, class B>
+bool CollideConvex(const ConvexInstance<SphereSupport<T>>& a, const B& b,
+                   ConvexContact<T>& contact) {
+    const PointSupport<T> point;
+    const ConvexInstance<PointSupport<T>> center(point, a.position);
+
+    Simplex<T> simplex;
+    GjkResult<T> gjk;
+    if (!GjkDistance(center, b, simplex, gjk)) {
+        if (gjk.distance > a.shape.radius) return false;
+
+        const Vector3<T> normal =
+            (gjk.pointB - gjk.pointA) * (T(1) / gjk.distance);
+        const T depth = a.shape.radius - gjk.distance;
+        contact.normal = normal;
+        contact.pointCount = 1;
+        contact.points[0] = gjk.pointB - normal * (depth * T(0.5));
+        contact.depths[0] = depth;
+        return true;
+    }
+
+    simplex = Simplex<T>();
+    if (!GjkDistance(a, b, simplex, gjk)) return false;
+
+    Vector3<T> normal, point_a, point_b;
+    T depth;
+    if (!Epa(a, b, simplex, normal, depth, point_a, point_b)) return false;
+
+    contact.normal = normal;
+    contact.pointCount = 1;
+    contact.points[0] = (point_a + point_b) * T(0.5);
+    contact.depths[0] = depth;
+    return true;
+}
+
+template <typename T, class A>
+bool CollideConvex(const A& a, const ConvexInstance<SphereSupport<T>>& b,
+                   ConvexContact<T>& contact) {
+    if (!CollideConvex(b, a, contact)) return false;
+    contact.normal = -contact.normal;
+    return true;
+}
+
+template <typename T>
+bool CollideConvex(const ConvexInstance<SphereSupport<T>>& a,
+                   const ConvexInstance<SphereSupport<T>>& b,
+                   ConvexContact<T>& contact) {
+    const Vector3<T> d = b.position - a.position;
+    const T radii = a.shape.radius + b.shape.radius;
+    const T distance_squared = details::length_squared(d);
+    if (distance_squared > radii * radii) return false;
+
+    const T distance = std::sqrt(distance_squared);
+    contact.normal = (distance > std::numeric_limits<T>::min())
+                         ? d * (T(1) / distance)
+                         : Vector3<T>({0, 0, 1});
+    const T depth = radii - distance;
+    contact.pointCount = 1;
+    contact.points[0] =
+        a.position + contact.normal * (a.shape.radius - depth * T(0.5));
+    contact.depths[0] = depth;
+    return true;
+}
+
+// Against a half space: the face of the shape facing the plane, clipped by
+// the plane.
+template <typename T, class A>
+bool CollideConvex(const A& a, const ConvexInstance<HalfSpace<T>>& b,
+                   ConvexContact<T>& contact) {
+    const Vector3<T> n = b.ToWorldDirection(b.shape.normal);
+    const T intercept = details::dot(n, b.position) + b.shape.intercept;
+
+    const T deepest = intercept - details::dot(n, a.Support(-n));
+    if (deepest < 0) return false;
+
+    Vector3<T> face[kMaxSupportFacePoints];
+    Vector3<T> face_normal;
+    const uint32_t count = a.SupportFace(-n, face, face_normal);
+
+    Vector3<T> points[kMaxSupportFacePoints];
+    T depths[kMaxSupportFacePoints];
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const T depth = intercept - details::dot(n, face[i]);
+        if (depth < 0) continue;
+        points[kept] = face[i] + n * (depth * T(0.5));
+        depths[kept] = depth;
+        kept++;
+    }
+
+    contact.normal = -n;
+    if (!kept) {
+        // round shapes have no face
+        const Vector3<T> p = a.Support(-n);
+        points[0] = p + n * (deepest * T(0.5));
+        depths[0] = deepest;
+        kept = 1;
+    }
+    details::reduce_contacts(points, depths, kept, contact);
+    return true;
+}
+
+template <typename T, class B>
+bool CollideConvex(const ConvexInstance<HalfSpace<T>>& a, const B& b,
+                   ConvexContact<T>& contact) {
+    if (!CollideConvex(b, a, contact)) return false;
+    contact.normal = -contact.normal;
+    return true;
+}
+
+template <typename T>
+bool CollideConvex(const ConvexInstance<SphereSupport<T>>& a,
+                   const ConvexInstance<HalfSpace<T>>& b,
+                   ConvexContact<T>& contact) {
+    const Vector3<T> n = b.ToWorldDirection(b.shape.normal);
+    const T intercept = details::dot(n, b.position) + b.shape.intercept;
+    const T depth = intercept + a.shape.radius - details::dot(n, a.position);
+    if (depth < 0) return false;
+
+    contact.normal = -n;
+    contact.pointCount = 1;
+    contact.points[0] = a.position - n * (a.shape.radius - depth * T(0.5));
+    contact.depths[0] = depth;
+    return true;
+}
+
+template <typename T>
+bool CollideConvex(const ConvexInstance<HalfSpace<T>>& a,
+                   const ConvexInstance<SphereSupport<T>>& b,
+                   ConvexContact<T>& contact) {
+    if (!CollideConvex(b, a, contact)) return false;
+    contact.normal = -contact.normal;
+    return true;
+}
+}  // namespace My
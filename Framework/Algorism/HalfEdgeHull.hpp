@@ -0,0 +1,512 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "GjkEpa.hpp"
+#include "geommath.hpp"
+
+// Quickhull over flat arrays: vertices, half edges and faces are indices
+// into contiguous vectors and the conflict lists are vectors of point
+// indices, so a hull of a few thousand points builds in one go at load time.
+//
+// With a vertex budget, the point farthest outside the current hull is
+// always added first and the build stops when the budget is spent, which
+// gives the inner hull of that many vertices closest to the full one.
+
+namespace My {
+template <typename T>
+class HalfEdgeHull {
+   public:
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    struct HalfEdge {
+        uint32_t vertex;  // where the edge starts
+        uint32_t twin;
+        uint32_t next;
+        uint32_t face;
+    };
+
+    struct Face {
+        uint32_t edge;  // one of its three half edges
+        Vector3<T> normal;
+        T distance;  // dot(normal, x) = distance on the plane
+        bool alive;
+        // points outside of this face, the farthest one first
+        std::vector<uint32_t> conflicts;
+    };
+
+    // Builds the hull of points, 0 for no vertex budget. Returns false if
+    // the points are flat (no volume), the hull is then empty.
+    bool Build(const Vector3<T>* points, size_t count,
+               uint32_t max_vertex_count = 0) {
+        Clear();
+        if (count < 4) return false;
+
+        m_pPoints = points;
+        m_MaxVertexCount = max_vertex_count ? std::max(max_vertex_count, 4u)
+                                            : UINT32_MAX;
+
+        // tolerance from the extent of the input
+        Vector3<T> max_abs(0);
+        for (size_t i = 0; i < count; i++) {
+            for (int k = 0; k < 3; k++) {
+                max_abs[k] = std::max(max_abs[k], std::abs(points[i][k]));
+            }
+        }
+        m_Tolerance = T(64) * std::numeric_limits<T>::epsilon() *
+                      (max_abs[0] + max_abs[1] + max_abs[2]);
+
+        if (!buildTetrahedron(count)) {
+            Clear();
+            return false;
+        }
+
+        while (m_VertexCount < m_MaxVertexCount) {
+            const uint32_t face = nextFace();
+            if (face == kInvalidIndex) break;
+            addPoint(face);
+        }
+
+        removeInnerVertices();
+        m_pPoints = nullptr;
+        return true;
+    }
+
+    void Clear() {
+        m_Vertices.clear();
+        m_Edges.clear();
+        m_Faces.clear();
+        m_VertexIndices.clear();
+        m_VertexCount = 0;
+        m_nNextFace = 0;
+    }
+
+    [[nodiscard]] bool Empty() const { return m_Faces.empty(); }
+
+    // input points on the hull, by input index
+    [[nodiscard]] const std::vector<uint32_t>& GetVertexIndices() const {
+        return m_VertexIndices;
+    }
+    [[nodiscard]] const std::vector<Vector3<T>>& GetVertices() const {
+        return m_Vertices;
+    }
+    // the edges of face f are 3f to 3f + 2, dead ones have no face
+    [[nodiscard]] const std::vector<HalfEdge>& GetHalfEdges() const {
+        return m_Edges;
+    }
+    // dead faces stay in place, check Face::alive
+    [[nodiscard]] const std::vector<Face>& GetFaces() const { return m_Faces; }
+
+    [[nodiscard]] size_t GetFaceCount() const {
+        return std::count_if(m_Faces.begin(), m_Faces.end(),
+                             [](const Face& f) { return f.alive; });
+    }
+
+    // The hull as a support shape. Adjacent triangles in the same plane are
+    // merged into polygons, as contact clipping wants whole faces.
+    [[nodiscard]] ConvexHullSupport<T> GetSupport() const {
+        // group the coplanar triangles with a union find, against the
+        // normal of the group so that fine curved meshes do not chain up
+        std::vector<uint32_t> group(m_Faces.size());
+        std::iota(group.begin(), group.end(), 0);
+        auto find = [&](uint32_t f) {
+            while (group[f] != f) {
+                group[f] = group[group[f]];
+                f = group[f];
+            }
+            return f;
+        };
+
+        const T cos_tolerance = T(1) - T(1e-4);
+        for (uint32_t e = 0; e < m_Edges.size(); e++) {
+            const HalfEdge& edge = m_Edges[e];
+            if (edge.face == kInvalidIndex) continue;
+            const uint32_t root_a = find(edge.face);
+            const uint32_t root_b = find(m_Edges[edge.twin].face);
+            if (root_a == root_b) continue;
+
+            const Face& a = m_Faces[root_a];
+            const Face& b = m_Faces[root_b];
+            if (details::dot(a.normal, b.normal) < cos_tolerance) continue;
+            // the far vertex of the other triangle on the plane of a
+            const uint32_t far_vertex =
+                m_Edges[m_Edges[m_Edges[edge.twin].next].next].vertex;
+            if (std::abs(details::dot(a.normal, m_Vertices[far_vertex]) -
+                         a.distance) > 4 * m_Tolerance) {
+                continue;
+            }
+            group[root_b] = root_a;
+        }
+
+        // faces by group
+        std::vector<std::pair<uint32_t, uint32_t>> members;
+        for (uint32_t f = 0; f < m_Faces.size(); f++) {
+            if (m_Faces[f].alive) members.emplace_back(find(f), f);
+        }
+        std::sort(members.begin(), members.end());
+
+        ConvexHullSupport<T> result;
+        std::vector<uint32_t> remap(m_Vertices.size(), kInvalidIndex);
+        std::vector<uint32_t> boundary_from(m_Vertices.size(), kInvalidIndex);
+        std::vector<uint32_t> loop;
+
+        for (size_t begin = 0; begin < members.size();) {
+            const uint32_t root = members[begin].first;
+            size_t end = begin;
+
+            // the boundary are the edges whose twin is in another group,
+            // chained by their start vertices
+            uint32_t start = kInvalidIndex;
+            uint32_t boundary_count = 0;
+            Vector3<T> normal(0);
+            for (; end < members.size() && members[end].first == root; end++) {
+                const uint32_t f = members[end].second;
+                normal = normal + m_Faces[f].normal;
+                for (uint32_t e = 3 * f; e < 3 * f + 3; e++) {
+                    if (find(m_Edges[m_Edges[e].twin].face) == root) continue;
+                    boundary_from[m_Edges[e].vertex] = e;
+                    boundary_count++;
+                    start = e;
+                }
+            }
+
+            loop.clear();
+            uint32_t e = start;
+            do {
+                loop.push_back(m_Edges[e].vertex);
+                e = boundary_from[m_Edges[m_Edges[e].next].vertex];
+            } while (e != start && e != kInvalidIndex &&
+                     loop.size() <= boundary_count);
+            for (const auto v : loop) boundary_from[v] = kInvalidIndex;
+
+            for (auto& v : loop) {
+                if (remap[v] == kInvalidIndex) {
+                    remap[v] = static_cast<uint32_t>(result.vertices.size());
+                    result.vertices.push_back(m_Vertices[v]);
+                }
+                v = remap[v];
+            }
+
+            const T length = std::sqrt(details::length_squared(normal));
+            result.faceNormals.push_back(normal * (T(1) / length));
+            result.faceIndices.insert(result.faceIndices.end(), loop.begin(),
+                                      loop.end());
+            result.faceOffsets.push_back(
+                static_cast<uint32_t>(result.faceIndices.size()));
+
+            begin = end;
+        }
+
+        return result;
+    }
+
+   private:
+    [[nodiscard]] T distance(uint32_t face, const Vector3<T>& p) const {
+        return details::dot(m_Faces[face].normal, p) - m_Faces[face].distance;
+    }
+
+    uint32_t addVertex(uint32_t point) {
+        m_Vertices.push_back(m_pPoints[point]);
+        m_VertexIndices.push_back(point);
+        m_VertexCount++;
+        return static_cast<uint32_t>(m_Vertices.size() - 1);
+    }
+
+    // new triangle a, b, c (counter clockwise seen from outside), with its
+    // three half edges, twins left unset
+    uint32_t addFace(uint32_t a, uint32_t b, uint32_t c) {
+        const auto face = static_cast<uint32_t>(m_Faces.size());
+        const auto edge = static_cast<uint32_t>(m_Edges.size());
+
+        m_Edges.push_back({a, kInvalidIndex, edge + 1, face});
+        m_Edges.push_back({b, kInvalidIndex, edge + 2, face});
+        m_Edges.push_back({c, kInvalidIndex, edge, face});
+
+        Face f;
+        f.edge = edge;
+        f.alive = true;
+        const Vector3<T>& pa = m_Vertices[a];
+        Vector3<T> n = details::cross(m_Vertices[b] - pa, m_Vertices[c] - pa);
+        const T length = std::sqrt(details::length_squared(n));
+        f.normal = (length > 0) ? n * (T(1) / length) : n;
+        f.distance = details::dot(f.normal, pa);
+        m_Faces.push_back(std::move(f));
+
+        return face;
+    }
+
+    void link(uint32_t e1, uint32_t e2) {
+        m_Edges[e1].twin = e2;
+        m_Edges[e2].twin = e1;
+    }
+
+    // adds the point to the conflict list of the face it is farthest
+    // outside of, among faces [first, last)
+    void assign(uint32_t point, const uint32_t* faces, size_t count) {
+        T best = m_Tolerance;
+        uint32_t best_face = kInvalidIndex;
+        for (size_t i = 0; i < count; i++) {
+            const T d = distance(faces[i], m_pPoints[point]);
+            if (d > best) {
+                best = d;
+                best_face = faces[i];
+            }
+        }
+        if (best_face == kInvalidIndex) return;
+
+        auto& conflicts = m_Faces[best_face].conflicts;
+        conflicts.push_back(point);
+        // keep the farthest point first
+        if (conflicts.size() > 1 &&
+            best > distance(best_face, m_pPoints[conflicts[0]])) {
+            std::swap(conflicts.front(), conflicts.back());
+        }
+    }
+
+    bool buildTetrahedron(size_t count) {
+        // extreme points on each axis, the farthest pair of them first
+        uint32_t extremes[6] = {0, 0, 0, 0, 0, 0};
+        for (uint32_t i = 1; i < count; i++) {
+            for (int k = 0; k < 3; k++) {
+                if (m_pPoints[i][k] < m_pPoints[extremes[2 * k]][k]) {
+                    extremes[2 * k] = i;
+                }
+                if (m_pPoints[i][k] > m_pPoints[extremes[2 * k + 1]][k]) {
+                    extremes[2 * k + 1] = i;
+                }
+            }
+        }
+
+        uint32_t a = 0, b = 0;
+        T best = 0;
+        for (int k = 0; k < 3; k++) {
+            const T d = details::length_squared(m_pPoints[extremes[2 * k + 1]] -
+                                                m_pPoints[extremes[2 * k]]);
+            if (d > best) {
+                best = d;
+                a = extremes[2 * k];
+                b = extremes[2 * k + 1];
+            }
+        }
+        if (best <= m_Tolerance * m_Tolerance) return false;
+
+        // farthest from the line ab
+        const Vector3<T> ab = m_pPoints[b] - m_pPoints[a];
+        uint32_t c = 0;
+        best = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const T d = details::length_squared(
+                details::cross(m_pPoints[i] - m_pPoints[a], ab));
+            if (d > best) {
+                best = d;
+                c = i;
+            }
+        }
+        if (best <= m_Tolerance * m_Tolerance * details::length_squared(ab)) {
+            return false;
+        }
+
+        // farthest from the plane abc
+        Vector3<T> n = details::cross(ab, m_pPoints[c] - m_pPoints[a]);
+        n = n * (T(1) / std::sqrt(details::length_squared(n)));
+        uint32_t d = 0;
+        best = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const T h = std::abs(details::dot(m_pPoints[i] - m_pPoints[a], n));
+            if (h > best) {
+                best = h;
+                d = i;
+            }
+        }
+        if (best <= m_Tolerance) return false;
+
+        const uint32_t va = addVertex(a);
+        uint32_t vb = addVertex(b);
+        uint32_t vc = addVertex(c);
+        const uint32_t vd = addVertex(d);
+
+        // abc must face away from d
+        if (details::dot(m_pPoints[d] - m_pPoints[a], n) > 0) {
+            std::swap(vb, vc);
+        }
+
+        const uint32_t f0 = addFace(va, vb, vc);
+        const uint32_t f1 = addFace(va, vd, vb);
+        const uint32_t f2 = addFace(vb, vd, vc);
+        const uint32_t f3 = addFace(vc, vd, va);
+
+        // edges of face f are 3f, 3f + 1 and 3f + 2
+        link(3 * f0 + 0, 3 * f1 + 2);  // ab - ba
+        link(3 * f0 + 1, 3 * f2 + 2);  // bc - cb
+        link(3 * f0 + 2, 3 * f3 + 2);  // ca - ac
+        link(3 * f1 + 0, 3 * f3 + 1);  // ad - da
+        link(3 * f1 + 1, 3 * f2 + 0);  // db - bd
+        link(3 * f2 + 1, 3 * f3 + 0);  // dc - cd
+
+        const uint32_t faces[4] = {f0, f1, f2, f3};
+        for (uint32_t i = 0; i < count; i++) {
+            if (i == a || i == b || i == c || i == d) continue;
+            assign(i, faces, 4);
+        }
+
+        return true;
+    }
+
+    // the face with the next point to add: the first with conflicts, or
+    // with a vertex budget the one whose point is the farthest out
+    uint32_t nextFace() {
+        if (m_MaxVertexCount == UINT32_MAX) {
+            for (; m_nNextFace < m_Faces.size(); m_nNextFace++) {
+                const Face& f = m_Faces[m_nNextFace];
+                if (f.alive && !f.conflicts.empty()) return m_nNextFace;
+            }
+            return kInvalidIndex;
+        }
+
+        uint32_t best_face = kInvalidIndex;
+        T best = 0;
+        for (uint32_t i = 0; i < m_Faces.size(); i++) {
+            const Face& f = m_Faces[i];
+            if (!f.alive || f.conflicts.empty()) continue;
+            const T d = distance(i, m_pPoints[f.conflicts[0]]);
+            if (d > best) {
+                best = d;
+                best_face = i;
+            }
+        }
+        return best_face;
+    }
+
+    // A vertex added early can end up inside the hull when points farther
+    // out are added next to it, drop those.
+    void removeInnerVertices() {
+        std::vector<uint32_t> remap(m_Vertices.size(), kInvalidIndex);
+        for (const auto& edge : m_Edges) {
+            if (edge.face != kInvalidIndex) remap[edge.vertex] = 0;
+        }
+
+        uint32_t count = 0;
+        for (uint32_t v = 0; v < m_Vertices.size(); v++) {
+            if (remap[v] == kInvalidIndex) continue;
+            remap[v] = count;
+            m_Vertices[count] = m_Vertices[v];
+            m_VertexIndices[count] = m_VertexIndices[v];
+            count++;
+        }
+        m_Vertices.resize(count);
+        m_VertexIndices.resize(count);
+
+        for (auto& edge : m_Edges) {
+            edge.vertex = (edge.face != kInvalidIndex) ? remap[edge.vertex]
+                                                       : kInvalidIndex;
+        }
+    }
+
+    void addPoint(uint32_t face) {
+        const uint32_t point = m_Faces[face].conflicts[0];
+        const Vector3<T>& eye = m_pPoints[point];
+
+        // depth first walk over the faces seen from the point, the edges
+        // crossed to hidden faces come out as the horizon in order
+        m_Horizon.clear();
+        m_Visible.clear();
+
+        m_Visible.push_back(face);
+        auto& stack = m_Stack;
+        stack.clear();
+        stack.push_back({face, m_Faces[face].edge, m_Faces[face].edge, false});
+        m_Faces[face].alive = false;
+
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.started && frame.edge == frame.first) {
+                stack.pop_back();
+                continue;
+            }
+            frame.started = true;
+
+            const uint32_t e = frame.edge;
+            frame.edge = m_Edges[e].next;
+
+            const uint32_t twin = m_Edges[e].twin;
+            const uint32_t neighbor = m_Edges[twin].face;
+            if (!m_Faces[neighbor].alive) continue;  // visible, seen already
+
+            if (distance(neighbor, eye) > m_Tolerance) {
+                m_Faces[neighbor].alive = false;
+                m_Visible.push_back(neighbor);
+                const uint32_t first = m_Edges[twin].next;
+                stack.push_back({neighbor, first, first, false});
+            } else {
+                m_Horizon.push_back(e);
+            }
+        }
+
+        // a fan of new faces from the horizon to the point
+        const uint32_t vertex = addVertex(point);
+        const auto first_face = static_cast<uint32_t>(m_Faces.size());
+        const auto horizon_count = static_cast<uint32_t>(m_Horizon.size());
+        m_NewFaces.clear();
+        for (uint32_t i = 0; i < horizon_count; i++) {
+            const HalfEdge& e = m_Edges[m_Horizon[i]];
+            const uint32_t head = m_Edges[e.next].vertex;
+            const uint32_t outside = e.twin;
+            const uint32_t f = addFace(e.vertex, head, vertex);
+            link(3 * f, outside);
+            m_NewFaces.push_back(f);
+        }
+        for (uint32_t i = 0; i < horizon_count; i++) {
+            const uint32_t f = first_face + i;
+            const uint32_t next = first_face + (i + 1) % horizon_count;
+            assert(m_Edges[3 * f + 1].vertex == m_Edges[3 * next].vertex);
+            link(3 * f + 1, 3 * next + 2);
+        }
+
+        // the points outside of the removed faces go to the new ones
+        for (const auto v : m_Visible) {
+            auto conflicts = std::move(m_Faces[v].conflicts);
+            m_Faces[v].conflicts.clear();
+            for (const auto p : conflicts) {
+                if (p == point) continue;
+                assign(p, m_NewFaces.data(), m_NewFaces.size());
+            }
+        }
+
+        // the edges of face f are 3f to 3f + 2, the twins of the horizon
+        // now belong to the new faces
+        for (const auto v : m_Visible) {
+            for (uint32_t e = 3 * v; e < 3 * v + 3; e++) {
+                m_Edges[e].face = kInvalidIndex;
+            }
+        }
+    }
+
+    const Vector3<T>* m_pPoints{nullptr};
+    T m_Tolerance{0};
+    uint32_t m_MaxVertexCount{UINT32_MAX};
+    uint32_t m_VertexCount{0};
+    uint32_t m_nNextFace{0};
+
+    std::vector<Vector3<T>> m_Vertices;
+    std::vector<uint32_t> m_VertexIndices;
+    std::vector<HalfEdge> m_Edges;
+    std::vector<Face> m_Faces;
+
+    // scratch of addPoint()
+    struct Frame {
+        uint32_t face;
+        uint32_t first;
+        uint32_t edge;
+        bool started;
+    };
+    std::vector<Frame> m_Stack;
+    std::vector<uint32_t> m_Horizon;
+    std::vector<uint32_t> m_Visible;
+    std::vector<uint32_t> m_NewFaces;
+};
+}  // namespace My
@@ -80,18 +80,28 @@ class Linear<Quaternion<T>, T> : public CurveBase,
     }
 
     T Reverse(Quaternion<T> v, size_t& index) const final {
-        T result = 0;
-        assert(0);
-
-        return result;
+        return ReverseByDistance<Quaternion<T>, T>(
+            Curve<Quaternion<T>, T>::m_Knots, v, index,
+            QuaternionAngle<T>);
     }
 
     [[nodiscard]] Quaternion<T> Interpolate(T s,
                                             const size_t index) const final {
-        Quaternion<T> result{0};
-        assert(0);
+        if (Curve<Quaternion<T>, T>::m_Knots.empty())
+            return Quaternion<T>{0, 0, 0, 1};
 
-        return result;
+        if (Curve<Quaternion<T>, T>::m_Knots.size() == 1)
+            return Curve<Quaternion<T>, T>::m_Knots[0];
+        else if (Curve<Quaternion<T>, T>::m_Knots.size() < index + 1)
+            return Curve<Quaternion<T>, T>::m_Knots.back();
+        else if (index == 0)
+            return Curve<Quaternion<T>, T>::m_Knots.front();
+        else {
+            auto q1 = Curve<Quaternion<T>, T>::m_Knots[index - 1];
+            auto q2 = Curve<Quaternion<T>, T>::m_Knots[index];
+
+            return Slerp(q1, q2, s);
+        }
     }
 };
 
@@ -111,10 +121,17 @@ class Linear<Matrix4X4f, float> : public CurveBase,
     }
 
     float Reverse(Matrix4X4f v, size_t& index) const final {
-        float result = 0.0f;
-        assert(0);
-
-        return result;
+        return ReverseByDistance<Matrix4X4f, float>(
+            Curve<Matrix4X4f, float>::m_Knots, v, index,
+            [](const Matrix4X4f& a, const Matrix4X4f& b) {
+                float sum = 0.0f;
+                for (int r = 0; r < 4; r++) {
+                    for (int c = 0; c < 4; c++) {
+                        sum += (a[r][c] - b[r][c]) * (a[r][c] - b[r][c]);
+                    }
+                }
+                return std::sqrt(sum);
+            });
     }
 
     [[nodiscard]] Matrix4X4f Interpolate(float s,
@@ -134,7 +151,7 @@ class Linear<Matrix4X4f, float> : public CurveBase,
 
             Vector3f translation1, translation2;
             Vector3f scalar1, scalar2;
-            Vector3f rotation1, rotation2;
+            Quaternion<float> rotation1, rotation2;
 
             Matrix4X4fDecompose(v1, rotation1, scalar1, translation1);
             Matrix4X4fDecompose(v2, rotation2, scalar2, translation2);
@@ -144,7 +161,7 @@ class Linear<Matrix4X4f, float> : public CurveBase,
             // Interpolate scalar
             Vector3f scalar = (1.0f - s) * scalar1 + s * scalar2;
             // Interpolate rotation
-            Vector3f rotation = (1.0f - s) * rotation1 + s * rotation2;
+            Quaternion<float> rotation = Slerp(rotation1, rotation2, s);
 
             // compose the interpolated matrix
             Matrix4X4fCompose(result, rotation, scalar, translation);
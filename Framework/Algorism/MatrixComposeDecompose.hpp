@@ -96,6 +96,48 @@ inline void Matrix4X4fDecompose(const Matrix4X4f& matrix, Vector3f& rotation,
     rotation.Set({theta_x, theta_y, theta_z});
 }
 
+// the same with the rotation as a quaternion, which interpolates by slerp
+// rather than angle by angle
+inline void Matrix4X4fCompose(Matrix4X4f& matrix,
+                              const Quaternion<float>& rotation,
+                              const Vector3f& scalar,
+                              const Vector3f& translation) {
+    Matrix4X4f matrix_rotate;
+    MatrixRotationQuaternion(matrix_rotate, rotation);
+    Matrix4X4f matrix_scale;
+    MatrixScale(matrix_scale, scalar);
+    Matrix4X4f matrix_translation;
+    MatrixTranslation(matrix_translation, translation);
+    matrix = matrix_scale * matrix_rotate * matrix_translation;
+}
+
+inline void Matrix4X4fDecompose(const Matrix4X4f& matrix,
+                                Quaternion<float>& rotation, Vector3f& scalar,
+                                Vector3f& translation) {
+    translation.Set({matrix[3][0], matrix[3][1], matrix[3][2]});
+
+    Matrix3X3f bases = {{{matrix[0][0], matrix[0][1], matrix[0][2]},
+                         {matrix[1][0], matrix[1][1], matrix[1][2]},
+                         {matrix[2][0], matrix[2][1], matrix[2][2]}}};
+
+    Matrix3X3f U, P;
+    MatrixPolarDecompose(bases, U, P);
+    scalar.Set({P[0][0], P[1][1], P[2][2]});
+
+    // a mirror, U is a rotation with the scale negated
+    Vector3f x_axis({U[0][0], U[0][1], U[0][2]});
+    Vector3f y_axis({U[1][0], U[1][1], U[1][2]});
+    Vector3f z_axis({U[2][0], U[2][1], U[2][2]});
+    float determinant;
+    DotProduct(determinant, CrossProduct(x_axis, y_axis), z_axis);
+    if (determinant < 0.0f) {
+        U = U * -1.0f;
+        scalar = scalar * -1.0f;
+    }
+
+    QuaternionRotationMatrix(rotation, U);
+}
+
 template <typename T, int N>
 T Determin(const Matrix<T, N, N>& matrix) {
     T result = 1;
@@ -0,0 +1,535 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "geommath.hpp"
+
+namespace My {
+// Post-transform vertex cache statistics of an indexed triangle list.
+//   ACMR: average cache miss ratio, transformed vertices per triangle
+//         (0.5 is the theoretical best for a regular grid, 3.0 the worst)
+//   ATVR: average transform to vertex ratio, transformed vertices per
+//         unique vertex (1.0 is optimal)
+struct VertexCacheStatistics {
+    size_t triangles_count = 0;
+    size_t vertices_transformed = 0;
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+// describes one interleaved or planar vertex stream used for welding
+struct VertexStream {
+    const void* data;
+    size_t stride;
+};
+
+constexpr uint32_t kInvalidVertexIndex = (std::numeric_limits<uint32_t>::max)();
+
+// Simulate a FIFO post-transform cache of cache_size entries
+inline VertexCacheStatistics AnalyzeVertexCache(
+    const std::vector<uint32_t>& indices, size_t vertex_count,
+    uint32_t cache_size = 16) {
+    VertexCacheStatistics result;
+    result.triangles_count = indices.size() / 3;
+
+    std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+    uint32_t timestamp = cache_size + 1;
+
+    for (const auto& index : indices) {
+        assert(index < vertex_count);
+        if (timestamp - cache_timestamps[index] > cache_size) {
+            cache_timestamps[index] = timestamp++;
+            result.vertices_transformed++;
+        }
+    }
+
+    // only count the vertices actually referenced
+    size_t unique_vertices = 0;
+    for (const auto& t : cache_timestamps) {
+        if (t) unique_vertices++;
+    }
+
+    if (result.triangles_count) {
+        result.acmr = static_cast<float>(result.vertices_transformed) /
+                      static_cast<float>(result.triangles_count);
+    }
+
+    if (unique_vertices) {
+        result.atvr = static_cast<float>(result.vertices_transformed) /
+                      static_cast<float>(unique_vertices);
+    }
+
+    return result;
+}
+
+namespace details {
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+constexpr uint32_t kForsythCacheSize = 32;
+constexpr float kForsythCacheDecayPower = 1.5f;
+constexpr float kForsythLastTriScore = 0.75f;
+constexpr float kForsythValenceBoostScale = 2.0f;
+constexpr float kForsythValenceBoostPower = 0.5f;
+
+inline float ForsythVertexScore(int32_t cache_position,
+                                uint32_t remaining_valence) {
+    if (remaining_valence == 0) {
+        // no triangle needs this vertex anymore
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // the most recent triangle should not get a bonus, otherwise
+            // we would keep favoring the same area
+            score = kForsythLastTriScore;
+        } else {
+            assert(cache_position < static_cast<int32_t>(kForsythCacheSize));
+            const float scaler = 1.0f / (kForsythCacheSize - 3);
+            score = 1.0f - (cache_position - 3) * scaler;
+            score = std::pow(score, kForsythCacheDecayPower);
+        }
+    }
+
+    // bonus points for having low number of triangles left to draw, so that
+    // lone vertices are cleaned up early
+    score += kForsythValenceBoostScale *
+             std::pow(static_cast<float>(remaining_valence),
+                      -kForsythValenceBoostPower);
+
+    return score;
+}
+
+struct TriangleAdjacency {
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> data;
+};
+
+inline void BuildTriangleAdjacency(TriangleAdjacency& adjacency,
+                                   const std::vector<uint32_t>& indices,
+                                   size_t vertex_count) {
+    adjacency.counts.assign(vertex_count, 0);
+    adjacency.offsets.assign(vertex_count, 0);
+    adjacency.data.resize(indices.size());
+
+    for (const auto& index : indices) {
+        adjacency.counts[index]++;
+    }
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < vertex_count; i++) {
+        adjacency.offsets[i] = offset;
+        offset += adjacency.counts[i];
+    }
+
+    // fill in triangle lists, using offsets as running cursors
+    std::vector<uint32_t> cursors = adjacency.offsets;
+    for (size_t i = 0; i < indices.size(); i++) {
+        adjacency.data[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+}
+}  // namespace details
+
+// Reorder triangles to maximize post-transform vertex cache hits.
+// indices is an indexed triangle list and is rewritten in place.
+inline void OptimizeVertexCache(std::vector<uint32_t>& indices,
+                                size_t vertex_count) {
+    using namespace details;
+
+    const size_t triangles_count = indices.size() / 3;
+    if (triangles_count == 0) return;
+
+    TriangleAdjacency adjacency;
+    BuildTriangleAdjacency(adjacency, indices, vertex_count);
+
+    // remaining valence is tracked in-place by compacting the adjacency list
+    std::vector<uint32_t>& live_triangles = adjacency.counts;
+
+    std::vector<int32_t> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (size_t i = 0; i < vertex_count; i++) {
+        vertex_scores[i] = ForsythVertexScore(-1, live_triangles[i]);
+    }
+
+    std::vector<float> triangle_scores(triangles_count);
+    for (size_t i = 0; i < triangles_count; i++) {
+        triangle_scores[i] = vertex_scores[indices[i * 3 + 0]] +
+                             vertex_scores[indices[i * 3 + 1]] +
+                             vertex_scores[indices[i * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangles_count, false);
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t cache[kForsythCacheSize + 3];
+    uint32_t cache_new[kForsythCacheSize + 3];
+    uint32_t cache_count = 0;
+
+    size_t input_cursor = 0;
+    int64_t current_triangle = 0;
+
+    while (current_triangle >= 0) {
+        const auto a = indices[current_triangle * 3 + 0];
+        const auto b = indices[current_triangle * 3 + 1];
+        const auto c = indices[current_triangle * 3 + 2];
+
+        result.push_back(a);
+        result.push_back(b);
+        result.push_back(c);
+        emitted[current_triangle] = true;
+        triangle_scores[current_triangle] = 0.0f;
+
+        // push the three vertices to the head of the LRU cache
+        uint32_t cache_new_count = 0;
+        cache_new[cache_new_count++] = a;
+        cache_new[cache_new_count++] = b;
+        cache_new[cache_new_count++] = c;
+
+        for (uint32_t i = 0; i < cache_count; i++) {
+            const auto index = cache[i];
+            if (index != a && index != b && index != c) {
+                cache_new[cache_new_count++] = index;
+            }
+        }
+
+        std::swap(cache, cache_new);
+        cache_count = (std::min)(cache_new_count, kForsythCacheSize);
+
+        // remove the emitted triangle from the adjacency of its vertices
+        for (const auto& v : {a, b, c}) {
+            auto* neighbours = &adjacency.data[adjacency.offsets[v]];
+            auto& count = live_triangles[v];
+            for (uint32_t i = 0; i < count; i++) {
+                if (neighbours[i] == current_triangle) {
+                    neighbours[i] = neighbours[count - 1];
+                    count--;
+                    break;
+                }
+            }
+        }
+
+        // update cache positions; vertices pushed out of the cache lose
+        // their cache score as well
+        for (uint32_t i = 0; i < cache_new_count; i++) {
+            const auto index = cache[i];
+            cache_positions[index] =
+                (i < kForsythCacheSize) ? static_cast<int32_t>(i) : -1;
+        }
+
+        // rescore the vertices touched and their triangles, and pick the
+        // best candidate among them
+        int64_t best_triangle = -1;
+        float best_score = 0.0f;
+
+        for (uint32_t i = 0; i < cache_new_count; i++) {
+            const auto index = cache[i];
+            const float score =
+                ForsythVertexScore(cache_positions[index], live_triangles[index]);
+            const float score_diff = score - vertex_scores[index];
+            vertex_scores[index] = score;
+
+            const auto* neighbours = &adjacency.data[adjacency.offsets[index]];
+            for (uint32_t j = 0; j < live_triangles[index]; j++) {
+                const auto tri = neighbours[j];
+                triangle_scores[tri] += score_diff;
+                if (triangle_scores[tri] > best_score) {
+                    best_triangle = tri;
+                    best_score = triangle_scores[tri];
+                }
+            }
+        }
+
+        if (best_triangle < 0) {
+            // nothing in the cache is usable, restart from the next
+            // triangle that has not been emitted yet
+            while (input_cursor < triangles_count && emitted[input_cursor]) {
+                input_cursor++;
+            }
+
+            best_triangle = (input_cursor < triangles_count)
+                                ? static_cast<int64_t>(input_cursor)
+                                : -1;
+        }
+
+        current_triangle = best_triangle;
+    }
+
+    assert(result.size() == indices.size());
+    indices.swap(result);
+}
+
+namespace details {
+// writes the clusters of indices sorted outward facing first to result,
+// leaves it empty if there is only one cluster
+inline void SortClustersByOutwardness(std::vector<uint32_t>& result,
+                                      const std::vector<uint32_t>& indices,
+                                      const Vector3f* positions,
+                                      size_t vertex_count, float threshold,
+                                      uint32_t cache_size,
+                                      bool soft_boundaries) {
+    result.clear();
+    const size_t triangles_count = indices.size() / 3;
+
+    // split into clusters at the points where the simulated cache is
+    // entirely flushed (hard boundaries), then further split where the
+    // running ACMR of the cluster stays within the threshold (soft
+    // boundaries)
+    std::vector<uint32_t> clusters;
+    {
+        std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+        uint32_t timestamp = cache_size + 1;
+
+        std::vector<uint32_t> misses(triangles_count);
+        size_t total_misses = 0;
+        for (size_t i = 0; i < triangles_count; i++) {
+            uint32_t m = 0;
+            for (uint32_t k = 0; k < 3; k++) {
+                const auto index = indices[i * 3 + k];
+                if (timestamp - cache_timestamps[index] > cache_size) {
+                    cache_timestamps[index] = timestamp++;
+                    m++;
+                }
+            }
+            misses[i] = m;
+            total_misses += m;
+        }
+
+        const float mesh_acmr = static_cast<float>(total_misses) /
+                                static_cast<float>(triangles_count);
+
+        size_t cluster_misses = 0;
+        size_t cluster_start = 0;
+        for (size_t i = 0; i < triangles_count; i++) {
+            const bool hard_boundary = (misses[i] == 3);
+            const bool soft_boundary =
+                soft_boundaries && (i - cluster_start) > 0 &&
+                static_cast<float>(cluster_misses) /
+                        static_cast<float>(i - cluster_start) <=
+                    mesh_acmr * threshold &&
+                misses[i] >= 2;
+
+            if (i == 0 || hard_boundary || soft_boundary) {
+                clusters.push_back(static_cast<uint32_t>(i));
+                cluster_start = i;
+                cluster_misses = 0;
+            }
+
+            cluster_misses += misses[i];
+        }
+    }
+
+    const size_t cluster_count = clusters.size();
+    if (cluster_count <= 1) return;
+
+    // mesh centroid, area weighted
+    Vector3f mesh_centroid(0.0f);
+    float mesh_area = 0.0f;
+    std::vector<Vector3f> cluster_centroids(cluster_count);
+    std::vector<Vector3f> cluster_normals(cluster_count);
+
+    for (size_t c = 0; c < cluster_count; c++) {
+        const size_t begin = clusters[c];
+        const size_t end =
+            (c + 1 < cluster_count) ? clusters[c + 1] : triangles_count;
+
+        Vector3f centroid(0.0f);
+        Vector3f normal(0.0f);
+        float area = 0.0f;
+
+        for (size_t i = begin; i < end; i++) {
+            const auto& p0 = positions[indices[i * 3 + 0]];
+            const auto& p1 = positions[indices[i * 3 + 1]];
+            const auto& p2 = positions[indices[i * 3 + 2]];
+
+            Vector3f n;
+            CrossProduct(n, p1 - p0, p2 - p0);
+            const float a = Length(n);
+
+            centroid = centroid + (p0 + p1 + p2) * (a / 3.0f);
+            normal = normal + n;
+            area += a;
+        }
+
+        mesh_centroid = mesh_centroid + centroid;
+        mesh_area += area;
+
+        cluster_centroids[c] = (area > 0.0f) ? centroid * (1.0f / area)
+                                             : positions[indices[begin * 3]];
+        const float l = Length(normal);
+        cluster_normals[c] = (l > 0.0f) ? normal * (1.0f / l) : Vector3f(0.0f);
+    }
+
+    if (mesh_area > 0.0f) mesh_centroid = mesh_centroid * (1.0f / mesh_area);
+
+    std::vector<float> sort_keys(cluster_count);
+    for (size_t c = 0; c < cluster_count; c++) {
+        float d;
+        DotProduct(d, cluster_centroids[c] - mesh_centroid, cluster_normals[c]);
+        sort_keys[c] = d;
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return sort_keys[a] > sort_keys[b];
+    });
+
+    result.reserve(indices.size());
+    for (const auto& c : order) {
+        const size_t begin = clusters[c];
+        const size_t end =
+            (c + 1 < cluster_count) ? clusters[c + 1] : triangles_count;
+        result.insert(result.end(), indices.begin() + begin * 3,
+                      indices.begin() + end * 3);
+    }
+}
+}  // namespace details
+
+// Reorder the clusters of a cache optimized triangle list so that the
+// outward facing ones are drawn first, which reduces overdraw from most
+// viewpoints (Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw", 2007).
+// threshold bounds how much ACMR we allow to lose, e.g. 1.05 means 5%.
+// Splitting at soft boundaries is tried with a decreasing threshold, then at
+// cache flushes only, and the order is kept if every attempt loses too much.
+inline void OptimizeOverdraw(std::vector<uint32_t>& indices,
+                             const Vector3f* positions, size_t vertex_count,
+                             float threshold = 1.05f,
+                             uint32_t cache_size = 16) {
+    if (indices.size() < 3 || positions == nullptr) return;
+
+    const auto budget = static_cast<double>(
+        AnalyzeVertexCache(indices, vertex_count, cache_size)
+            .vertices_transformed) * threshold;
+
+    // smaller clusters sort better but lose more at each cluster start
+    const uint32_t kSoftAttempts = 4;
+    float split_threshold = threshold;
+
+    std::vector<uint32_t> result;
+    for (uint32_t attempt = 0; attempt <= kSoftAttempts; attempt++) {
+        details::SortClustersByOutwardness(
+            result, indices, positions, vertex_count, split_threshold,
+            cache_size, attempt < kSoftAttempts);
+        split_threshold = 1.0f + (split_threshold - 1.0f) * 0.5f;
+        if (result.empty()) return;
+        if (AnalyzeVertexCache(result, vertex_count, cache_size)
+                .vertices_transformed <= budget) {
+            indices.swap(result);
+            return;
+        }
+    }
+}
+
+// Generate a remap table which orders vertices by first use in the index
+// buffer, so that vertex fetch walks memory linearly. Vertices not
+// referenced are mapped to kInvalidVertexIndex and dropped.
+// Returns the number of vertices after remap.
+inline size_t OptimizeVertexFetchRemap(std::vector<uint32_t>& remap,
+                                       const std::vector<uint32_t>& indices,
+                                       size_t vertex_count) {
+    remap.assign(vertex_count, kInvalidVertexIndex);
+
+    uint32_t next_vertex = 0;
+    for (const auto& index : indices) {
+        assert(index < vertex_count);
+        if (remap[index] == kInvalidVertexIndex) {
+            remap[index] = next_vertex++;
+        }
+    }
+
+    return next_vertex;
+}
+
+// Generate a remap table which merges vertices whose data are bitwise
+// identical in all of the given streams. Only vertices referenced by
+// indices are considered. Returns the number of unique vertices.
+inline size_t GenerateVertexRemap(std::vector<uint32_t>& remap,
+                                  const std::vector<uint32_t>& indices,
+                                  size_t vertex_count,
+                                  const std::vector<VertexStream>& streams) {
+    remap.assign(vertex_count, kInvalidVertexIndex);
+
+    // FNV-1a over all attribute bytes of a vertex
+    auto hash = [&streams](uint32_t v) {
+        uint64_t h = 14695981039346656037ull;
+        for (const auto& stream : streams) {
+            const auto* p =
+                reinterpret_cast<const uint8_t*>(stream.data) + v * stream.stride;
+            for (size_t i = 0; i < stream.stride; i++) {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    };
+
+    auto equal = [&streams](uint32_t a, uint32_t b) {
+        for (const auto& stream : streams) {
+            const auto* p = reinterpret_cast<const uint8_t*>(stream.data);
+            if (memcmp(p + a * stream.stride, p + b * stream.stride,
+                       stream.stride) != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::unordered_multimap<uint64_t, uint32_t> lookup;
+    lookup.reserve(vertex_count);
+
+    uint32_t next_vertex = 0;
+    for (const auto& index : indices) {
+        assert(index < vertex_count);
+        if (remap[index] != kInvalidVertexIndex) continue;
+
+        const auto h = hash(index);
+        auto range = lookup.equal_range(h);
+        bool found = false;
+        for (auto it = range.first; it != range.second; it++) {
+            if (equal(it->second, index)) {
+                remap[index] = remap[it->second];
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            lookup.emplace(h, index);
+            remap[index] = next_vertex++;
+        }
+    }
+
+    return next_vertex;
+}
+
+inline void RemapIndexBuffer(std::vector<uint32_t>& indices,
+                             const std::vector<uint32_t>& remap) {
+    for (auto& index : indices) {
+        assert(remap[index] != kInvalidVertexIndex);
+        index = remap[index];
+    }
+}
+
+// dst must have room for the remapped vertex count times stride
+inline void RemapVertexBuffer(void* dst, const void* src, size_t vertex_count,
+                              size_t stride,
+                              const std::vector<uint32_t>& remap) {
+    auto* d = reinterpret_cast<uint8_t*>(dst);
+    const auto* s = reinterpret_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < vertex_count; i++) {
+        if (remap[i] != kInvalidVertexIndex) {
+            memcpy(d + remap[i] * stride, s + i * stride, stride);
+        }
+    }
+}
+}  // namespace My
@@ -0,0 +1,322 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "geommath.hpp"
+
+namespace My {
+namespace details {
+// symmetric 4x4 error quadric (Garland & Heckbert, "Surface Simplification
+// Using Quadric Error Metrics", 1997), weighted by triangle area
+struct Quadric {
+    double a00{0}, a01{0}, a02{0}, a11{0}, a12{0}, a22{0};
+    double b0{0}, b1{0}, b2{0};
+    double c{0};
+    double w{0};
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00;
+        a01 += q.a01;
+        a02 += q.a02;
+        a11 += q.a11;
+        a12 += q.a12;
+        a22 += q.a22;
+        b0 += q.b0;
+        b1 += q.b1;
+        b2 += q.b2;
+        c += q.c;
+        w += q.w;
+        return *this;
+    }
+
+    // weighted average of squared distances to the accumulated planes
+    [[nodiscard]] double Error(const Vector3f& v) const {
+        const double x = v[0], y = v[1], z = v[2];
+        double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return (w > 0.0) ? std::fabs(e) / w : 0.0;
+    }
+
+    static Quadric FromTriangle(const Vector3f& p0, const Vector3f& p1,
+                                const Vector3f& p2) {
+        Quadric q;
+        Vector3f n;
+        CrossProduct(n, p1 - p0, p2 - p0);
+        const double area = Length(n);
+        if (area <= 0.0) return q;
+
+        const double nx = n[0] / area, ny = n[1] / area, nz = n[2] / area;
+        const double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+
+        q.a00 = area * nx * nx;
+        q.a01 = area * nx * ny;
+        q.a02 = area * nx * nz;
+        q.a11 = area * ny * ny;
+        q.a12 = area * ny * nz;
+        q.a22 = area * nz * nz;
+        q.b0 = area * nx * d;
+        q.b1 = area * ny * d;
+        q.b2 = area * nz * d;
+        q.c = area * d * d;
+        q.w = area;
+
+        return q;
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double error;
+};
+
+inline uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    return (a < b) ? (static_cast<uint64_t>(a) << 32 | b)
+                   : (static_cast<uint64_t>(b) << 32 | a);
+}
+}  // namespace details
+
+// Simplify an indexed triangle list by collapsing edges in quadric error
+// order. Vertices are only ever collapsed onto an existing neighbour, so the
+// result indexes into the same vertex buffer.
+// Border vertices and vertices sharing a position with others (attribute
+// seams) are locked to keep the silhouette and the UV layout intact.
+// target_error is relative to the mesh extent; the error actually reached
+// is returned in result_error (same unit) when it is not null.
+inline void SimplifyMesh(std::vector<uint32_t>& destination,
+                         const std::vector<uint32_t>& indices,
+                         const Vector3f* positions, size_t vertex_count,
+                         size_t target_index_count, float target_error,
+                         float* result_error = nullptr) {
+    using namespace details;
+
+    destination = indices;
+    if (result_error) *result_error = 0.0f;
+    if (indices.size() < 3 || vertex_count == 0) return;
+
+    // normalize positions so that the error is scale independent
+    Vector3f bbmin((std::numeric_limits<float>::max)());
+    Vector3f bbmax(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < vertex_count; i++) {
+        for (int k = 0; k < 3; k++) {
+            bbmin[k] = (std::min)(bbmin[k], positions[i][k]);
+            bbmax[k] = (std::max)(bbmax[k], positions[i][k]);
+        }
+    }
+
+    float extent = (std::max)(
+        {bbmax[0] - bbmin[0], bbmax[1] - bbmin[1], bbmax[2] - bbmin[2]});
+    const float scale = (extent > 0.0f) ? 1.0f / extent : 1.0f;
+
+    std::vector<Vector3f> points(vertex_count);
+    for (size_t i = 0; i < vertex_count; i++) {
+        points[i] = (positions[i] - bbmin) * scale;
+    }
+
+    // vertices sharing the same position are on an attribute seam
+    std::vector<bool> locked(vertex_count, false);
+    {
+        std::vector<uint32_t> order(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++) order[i] = i;
+        auto less = [positions](uint32_t a, uint32_t b) {
+            for (int k = 0; k < 3; k++) {
+                if (positions[a][k] != positions[b][k])
+                    return positions[a][k] < positions[b][k];
+            }
+            return false;
+        };
+        std::sort(order.begin(), order.end(), less);
+        for (size_t i = 1; i < vertex_count; i++) {
+            if (!less(order[i - 1], order[i])) {
+                locked[order[i - 1]] = locked[order[i]] = true;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const auto q = Quadric::FromTriangle(points[indices[i + 0]],
+                                             points[indices[i + 1]],
+                                             points[indices[i + 2]]);
+        for (int k = 0; k < 3; k++) {
+            quadrics[indices[i + k]] += q;
+        }
+    }
+
+    const double error_limit =
+        static_cast<double>(target_error) * static_cast<double>(target_error);
+    double max_error = 0.0;
+
+    std::vector<uint32_t> adjacency_offsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> collapse_remap(vertex_count);
+    std::vector<bool> touched(vertex_count);
+    std::vector<Collapse> collapses;
+    std::unordered_map<uint64_t, uint32_t> edge_usage;
+
+    while (destination.size() > target_index_count) {
+        const size_t triangles_count = destination.size() / 3;
+
+        // vertex to triangle adjacency
+        adjacency_offsets.assign(vertex_count + 1, 0);
+        for (const auto& index : destination) adjacency_offsets[index + 1]++;
+        for (size_t i = 0; i < vertex_count; i++)
+            adjacency_offsets[i + 1] += adjacency_offsets[i];
+        adjacency.resize(destination.size());
+        {
+            std::vector<uint32_t> cursors(adjacency_offsets.begin(),
+                                          adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < destination.size(); i++) {
+                adjacency[cursors[destination[i]]++] =
+                    static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // any edge not shared by exactly two triangles is on a border or
+        // non-manifold; lock its vertices for this pass
+        edge_usage.clear();
+        for (size_t t = 0; t < triangles_count; t++) {
+            for (int k = 0; k < 3; k++) {
+                edge_usage[EdgeKey(destination[t * 3 + k],
+                                   destination[t * 3 + (k + 1) % 3])]++;
+            }
+        }
+
+        std::vector<bool> border(vertex_count, false);
+        for (const auto& [key, count] : edge_usage) {
+            if (count != 2) {
+                border[key >> 32] = true;
+                border[key & 0xffffffff] = true;
+            }
+        }
+
+        // candidate collapses
+        collapses.clear();
+        for (const auto& [key, count] : edge_usage) {
+            const auto a = static_cast<uint32_t>(key >> 32);
+            const auto b = static_cast<uint32_t>(key & 0xffffffff);
+            for (const auto& [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+                if (locked[from] || border[from]) continue;
+                Quadric q = quadrics[from];
+                q += quadrics[to];
+                collapses.push_back({from, to, q.Error(points[to])});
+            }
+        }
+
+        if (collapses.empty()) break;
+
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) {
+                      return x.error < y.error;
+                  });
+
+        for (uint32_t i = 0; i < vertex_count; i++) collapse_remap[i] = i;
+        std::fill(touched.begin(), touched.end(), false);
+
+        // each collapse removes two triangles in the manifold case
+        size_t triangles_left = triangles_count;
+        const size_t target_triangles = target_index_count / 3;
+        size_t collapsed = 0;
+
+        for (const auto& collapse : collapses) {
+            if (triangles_left <= target_triangles) break;
+            if (collapse.error > error_limit) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+
+            // reject the collapse if any remaining triangle around 'from'
+            // would flip or degenerate
+            bool flipped = false;
+            for (auto j = adjacency_offsets[collapse.from];
+                 j < adjacency_offsets[collapse.from + 1] && !flipped; j++) {
+                const auto t = adjacency[j];
+                const uint32_t* tri = &destination[t * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to ||
+                    tri[2] == collapse.to)
+                    continue;
+
+                Vector3f p[3], q[3];
+                for (int k = 0; k < 3; k++) {
+                    p[k] = points[tri[k]];
+                    q[k] = (tri[k] == collapse.from) ? points[collapse.to]
+                                                     : points[tri[k]];
+                }
+
+                Vector3f n0, n1;
+                CrossProduct(n0, p[1] - p[0], p[2] - p[0]);
+                CrossProduct(n1, q[1] - q[0], q[2] - q[0]);
+                float d;
+                DotProduct(d, n0, n1);
+                const float l = Length(n0) * Length(n1);
+                flipped = !(l > 0.0f) || d < 0.25f * l;
+            }
+
+            if (flipped) continue;
+
+            collapse_remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            max_error = (std::max)(max_error, collapse.error);
+
+            // keep the one ring stable for the rest of this pass so that
+            // the flip test above stays valid
+            for (auto j = adjacency_offsets[collapse.from];
+                 j < adjacency_offsets[collapse.from + 1]; j++) {
+                const uint32_t* tri = &destination[adjacency[j] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+            }
+
+            triangles_left -= (std::min<size_t>)(2, triangles_left);
+            collapsed++;
+        }
+
+        if (collapsed == 0) break;
+
+        // apply the collapses and drop degenerated triangles
+        size_t write = 0;
+        for (size_t t = 0; t < triangles_count; t++) {
+            const auto a = collapse_remap[destination[t * 3 + 0]];
+            const auto b = collapse_remap[destination[t * 3 + 1]];
+            const auto c = collapse_remap[destination[t * 3 + 2]];
+            if (a != b && b != c && c != a) {
+                destination[write++] = a;
+                destination[write++] = b;
+                destination[write++] = c;
+            }
+        }
+        destination.resize(write);
+    }
+
+    if (result_error) {
+        *result_error = static_cast<float>(std::sqrt(max_error));
+    }
+}
+
+// Select the coarsest LOD whose error, projected onto the screen, stays
+// below pixel_threshold.
+// lod_errors are object space errors in ascending order; distance is the
+// distance from the camera to the object; fov_y is the vertical field of view
+// in radians and viewport_height is in pixels.
+inline uint32_t SelectLodByScreenSpaceError(const float* lod_errors,
+                                            uint32_t lod_count, float distance,
+                                            float fov_y, float viewport_height,
+                                            float pixel_threshold) {
+    if (lod_count == 0 || distance <= 0.0f) return 0;
+
+    // pixels per world unit at the given distance
+    const float projection_scale =
+        viewport_height / (2.0f * distance * std::tan(fov_y * 0.5f));
+
+    uint32_t lod = 0;
+    for (uint32_t i = 1; i < lod_count; i++) {
+        if (lod_errors[i] * projection_scale > pixel_threshold) break;
+        lod = i;
+    }
+
+    return lod;
+}
+}  // namespace My
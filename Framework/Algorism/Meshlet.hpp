@@ -0,0 +1,277 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Frustum.hpp"
+#include "geommath.hpp"
+
+namespace My {
+// A cluster of at most max_vertices vertices and max_triangles triangles.
+// Vertices are referenced indirectly through meshlet_vertices so that the
+// data could be consumed by mesh shaders, triangles are stored as 3 local
+// (8-bit) vertex indices each in meshlet_triangles.
+struct Meshlet {
+    uint32_t vertex_offset;
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+};
+
+// Bounding sphere and normal cone of a meshlet.
+// The whole meshlet faces away from a camera at position c when
+//   dot(normalize(cone_apex - c), cone_axis) >= cone_cutoff
+struct MeshletBounds {
+    Vector3f center;
+    float radius;
+    Vector3f cone_apex;
+    Vector3f cone_axis;
+    float cone_cutoff;
+};
+
+// a range in an index buffer, in indices
+struct MeshletIndexRange {
+    uint32_t offset;
+    uint32_t count;
+};
+
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// Greedily split an indexed triangle list into meshlets, following the
+// order of the index buffer. Run the vertex cache optimizer first for
+// better locality. Returns the number of meshlets.
+inline size_t BuildMeshlets(std::vector<Meshlet>& meshlets,
+                            std::vector<uint32_t>& meshlet_vertices,
+                            std::vector<uint8_t>& meshlet_triangles,
+                            const std::vector<uint32_t>& indices,
+                            size_t vertex_count,
+                            uint32_t max_vertices = kMeshletMaxVertices,
+                            uint32_t max_triangles = kMeshletMaxTriangles) {
+    assert(max_vertices >= 3 && max_vertices <= 256);
+    assert(max_triangles >= 1);
+
+    meshlets.clear();
+    meshlet_vertices.clear();
+    meshlet_triangles.clear();
+
+    // local index of each vertex in the current meshlet, 0xff if absent
+    std::vector<uint8_t> local(vertex_count, 0xff);
+
+    Meshlet current = {0, 0, 0, 0};
+
+    auto flush = [&]() {
+        if (current.triangle_count == 0) return;
+        for (uint32_t i = 0; i < current.vertex_count; i++) {
+            local[meshlet_vertices[current.vertex_offset + i]] = 0xff;
+        }
+        meshlets.push_back(current);
+        current.vertex_offset += current.vertex_count;
+        current.triangle_offset += current.triangle_count * 3;
+        current.vertex_count = 0;
+        current.triangle_count = 0;
+    };
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const uint32_t a = indices[i + 0];
+        const uint32_t b = indices[i + 1];
+        const uint32_t c = indices[i + 2];
+        assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+        uint32_t extra = 0;
+        if (local[a] == 0xff) extra++;
+        if (local[b] == 0xff && b != a) extra++;
+        if (local[c] == 0xff && c != a && c != b) extra++;
+
+        if (current.vertex_count + extra > max_vertices ||
+            current.triangle_count >= max_triangles) {
+            flush();
+        }
+
+        for (const auto& v : {a, b, c}) {
+            if (local[v] == 0xff) {
+                local[v] = static_cast<uint8_t>(current.vertex_count++);
+                meshlet_vertices.push_back(v);
+            }
+            meshlet_triangles.push_back(local[v]);
+        }
+
+        current.triangle_count++;
+    }
+
+    flush();
+
+    return meshlets.size();
+}
+
+inline MeshletBounds ComputeMeshletBounds(
+    const Meshlet& meshlet, const std::vector<uint32_t>& meshlet_vertices,
+    const std::vector<uint8_t>& meshlet_triangles, const Vector3f* positions) {
+    MeshletBounds bounds;
+
+    auto vertex = [&](uint32_t t, uint32_t k) -> const Vector3f& {
+        return positions[meshlet_vertices
+                              [meshlet.vertex_offset +
+                               meshlet_triangles[meshlet.triangle_offset +
+                                                 t * 3 + k]]];
+    };
+
+    // bounding sphere (Ritter): start from the two most distant points
+    // along the axis of largest spread, then grow to enclose everything
+    {
+        const Vector3f* p = &positions[meshlet_vertices[meshlet.vertex_offset]];
+        const Vector3f* pmin[3] = {p, p, p};
+        const Vector3f* pmax[3] = {p, p, p};
+        for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+            const auto& v = positions[meshlet_vertices[meshlet.vertex_offset + i]];
+            for (int k = 0; k < 3; k++) {
+                if (v[k] < (*pmin[k])[k]) pmin[k] = &v;
+                if (v[k] > (*pmax[k])[k]) pmax[k] = &v;
+            }
+        }
+
+        int axis = 0;
+        float spread = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            const float d = Length(*pmax[k] - *pmin[k]);
+            if (d > spread) {
+                spread = d;
+                axis = k;
+            }
+        }
+
+        Vector3f center = (*pmin[axis] + *pmax[axis]) * 0.5f;
+        float radius = spread * 0.5f;
+
+        for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+            const auto& v = positions[meshlet_vertices[meshlet.vertex_offset + i]];
+            const float d = Length(v - center);
+            if (d > radius) {
+                const float r = (radius + d) * 0.5f;
+                center = center + (v - center) * ((r - radius) / d);
+                radius = r;
+            }
+        }
+
+        bounds.center = center;
+        bounds.radius = radius;
+    }
+
+    // normal cone
+    std::vector<Vector3f> normals;
+    normals.reserve(meshlet.triangle_count);
+    Vector3f axis(0.0f);
+    for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+        Vector3f n;
+        CrossProduct(n, vertex(t, 1) - vertex(t, 0), vertex(t, 2) - vertex(t, 0));
+        const float l = Length(n);
+        if (l > 0.0f) {
+            n = n * (1.0f / l);
+            normals.push_back(n);
+            axis = axis + n;
+        }
+    }
+
+    const float axis_length = Length(axis);
+    bounds.cone_apex = bounds.center;
+    bounds.cone_axis = Vector3f(0.0f);
+    bounds.cone_cutoff = 1.0f;  // never culled
+
+    if (axis_length <= 0.0f) return bounds;
+    axis = axis * (1.0f / axis_length);
+
+    float min_dp = 1.0f;
+    for (const auto& n : normals) {
+        float dp;
+        DotProduct(dp, n, axis);
+        min_dp = (std::min)(min_dp, dp);
+    }
+
+    bounds.cone_axis = axis;
+
+    // the cone is wider than a hemisphere, the meshlet can always be seen
+    if (min_dp <= 0.0f) return bounds;
+
+    // move the apex back along the axis so that every triangle plane is in
+    // front of it, which makes the cone test conservative for any camera
+    // position
+    float max_t = 0.0f;
+    uint32_t n_index = 0;
+    for (uint32_t t = 0; t < meshlet.triangle_count; t++) {
+        Vector3f n;
+        CrossProduct(n, vertex(t, 1) - vertex(t, 0), vertex(t, 2) - vertex(t, 0));
+        if (!(Length(n) > 0.0f)) continue;
+        const auto& normal = normals[n_index++];
+        float dc, dn;
+        DotProduct(dc, bounds.center - vertex(t, 0), normal);
+        DotProduct(dn, axis, normal);
+        max_t = (std::max)(max_t, dc / dn);
+    }
+
+    bounds.cone_apex = bounds.center - axis * max_t;
+    bounds.cone_cutoff = std::sqrt(1.0f - min_dp * min_dp);
+
+    return bounds;
+}
+
+// Write the triangles of each meshlet contiguously as a regular index buffer
+// and return where each meshlet lives in it, so that backends without mesh
+// shaders could draw subsets of the mesh.
+inline void FlattenMeshlets(std::vector<uint32_t>& indices,
+                            std::vector<MeshletIndexRange>& ranges,
+                            const std::vector<Meshlet>& meshlets,
+                            const std::vector<uint32_t>& meshlet_vertices,
+                            const std::vector<uint8_t>& meshlet_triangles) {
+    indices.clear();
+    ranges.clear();
+
+    for (const auto& meshlet : meshlets) {
+        ranges.push_back({static_cast<uint32_t>(indices.size()),
+                          meshlet.triangle_count * 3});
+        for (uint32_t i = 0; i < meshlet.triangle_count * 3; i++) {
+            indices.push_back(
+                meshlet_vertices[meshlet.vertex_offset +
+                                 meshlet_triangles[meshlet.triangle_offset + i]]);
+        }
+    }
+}
+
+// Frustum and backface cone culling of meshlets. frustum and camera_position
+// must be in the same space as the meshlet bounds (normally object space).
+// Visible ranges are appended to visible, adjacent ones merged.
+// Returns the number of meshlets which passed.
+inline size_t CullMeshlets(std::vector<MeshletIndexRange>& visible,
+                           const std::vector<MeshletIndexRange>& ranges,
+                           const std::vector<MeshletBounds>& bounds,
+                           const Frustumf& frustum,
+                           const Vector3f& camera_position) {
+    assert(ranges.size() == bounds.size());
+    size_t passed = 0;
+
+    for (size_t i = 0; i < ranges.size(); i++) {
+        const auto& b = bounds[i];
+
+        if (!frustum.IntersectSphere(b.center, b.radius)) continue;
+
+        if (b.cone_cutoff < 1.0f) {
+            const Vector3f view = b.cone_apex - camera_position;
+            const float l = Length(view);
+            float d;
+            DotProduct(d, view, b.cone_axis);
+            if (d >= b.cone_cutoff * l) continue;
+        }
+
+        passed++;
+
+        if (!visible.empty() &&
+            visible.back().offset + visible.back().count == ranges[i].offset) {
+            visible.back().count += ranges[i].count;
+        } else {
+            visible.push_back(ranges[i]);
+        }
+    }
+
+    return passed;
+}
+}  // namespace My
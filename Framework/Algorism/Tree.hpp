@@ -22,6 +22,11 @@ class TreeNode {
         m_Children.push_back(std::move(sub_node));
     }
 
+    [[nodiscard]] const std::list<std::shared_ptr<TreeNode>>& GetChildren()
+        const {
+        return m_Children;
+    }
+
     friend std::ostream& operator<<(std::ostream& out, const TreeNode& node) {
         node.dump(out);
         out << std::endl;
@@ -0,0 +1,205 @@
+#include "AudioMixer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "geommath.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+// frames a voice is mixed at a time, bounding the scratch buffers
+constexpr size_t kBlockFrames = 256;
+
+// a mono voice at constant power, so a sound moving across keeps its
+// loudness. A stereo one is balanced, a channel only ever turned down.
+void pan_gains(float volume, float pan, uint16_t channel_count,
+               float* gains) {
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    if (channel_count == 1) {
+        const float angle = (pan + 1.0f) * PI * 0.25f;
+        gains[0] = volume * cos(angle);
+        gains[1] = volume * sin(angle);
+    } else {
+        gains[0] = volume * min(1.0f, 1.0f - pan);
+        gains[1] = volume * min(1.0f, 1.0f + pan);
+    }
+}
+
+// dst[i] is window at position + i * step, between its neighbours
+void resample_linear(const float* window, float position, float step,
+                     size_t count, float* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float p = position + static_cast<float>(i) * step;
+        const auto k = static_cast<size_t>(p);
+        const float t = p - static_cast<float>(k);
+        dst[i] = window[k] + (window[k + 1] - window[k]) * t;
+    }
+}
+
+// adds left and right, the gains going linearly from from to to
+void accumulate(const float* left, const float* right, size_t count,
+                const float* from, const float* to, float* frames) {
+    const float ramp = 1.0f / static_cast<float>(count);
+    const float left_step = (to[0] - from[0]) * ramp;
+    const float right_step = (to[1] - from[1]) * ramp;
+    for (size_t i = 0; i < count; i++) {
+        const float s = static_cast<float>(i + 1);
+        frames[2 * i] += left[i] * (from[0] + left_step * s);
+        frames[2 * i + 1] += right[i] * (from[1] + right_step * s);
+    }
+}
+}  // namespace
+
+AudioMixer::VoiceId AudioMixer::AddVoice(shared_ptr<AudioSource> source,
+                                         float volume, float pan) {
+    lock_guard<mutex> lock(m_Lock);
+    auto& voice = m_Voices.emplace_back();
+    voice.id = m_nNextId++;
+    voice.source = std::move(source);
+    voice.volume = volume;
+    voice.pan = pan;
+    return voice.id;
+}
+
+void AudioMixer::StopVoice(VoiceId id) {
+    lock_guard<mutex> lock(m_Lock);
+    m_Voices.erase(remove_if(m_Voices.begin(), m_Voices.end(),
+                             [id](const Voice& voice) {
+                                 return voice.id == id;
+                             }),
+                   m_Voices.end());
+}
+
+void AudioMixer::StopAllVoices() {
+    lock_guard<mutex> lock(m_Lock);
+    m_Voices.clear();
+}
+
+void AudioMixer::SetVolume(VoiceId id, float volume) {
+    lock_guard<mutex> lock(m_Lock);
+    if (auto* voice = findVoice(id)) voice->volume = volume;
+}
+
+void AudioMixer::SetPan(VoiceId id, float pan) {
+    lock_guard<mutex> lock(m_Lock);
+    if (auto* voice = findVoice(id)) voice->pan = pan;
+}
+
+bool AudioMixer::IsPlaying(VoiceId id) const {
+    lock_guard<mutex> lock(m_Lock);
+    return any_of(m_Voices.begin(), m_Voices.end(),
+                  [id](const Voice& voice) { return voice.id == id; });
+}
+
+size_t AudioMixer::GetVoiceCount() const {
+    lock_guard<mutex> lock(m_Lock);
+    return m_Voices.size();
+}
+
+AudioMixer::Voice* AudioMixer::findVoice(VoiceId id) {
+    for (auto& voice : m_Voices) {
+        if (voice.id == id) return &voice;
+    }
+    return nullptr;
+}
+
+void AudioMixer::Mix(float* frames, size_t frame_count) {
+    fill_n(frames, frame_count * kChannelCount, 0.0f);
+
+    lock_guard<mutex> lock(m_Lock);
+    for (size_t begin = 0; begin < frame_count; begin += kBlockFrames) {
+        const size_t count = min(kBlockFrames, frame_count - begin);
+        m_Voices.erase(
+            remove_if(m_Voices.begin(), m_Voices.end(),
+                      [&](Voice& voice) {
+                          return !mixVoice(
+                              voice, frames + begin * kChannelCount, count);
+                      }),
+            m_Voices.end());
+    }
+}
+
+bool AudioMixer::mixVoice(Voice& voice, float* frames, size_t frame_count) {
+    auto& source = *voice.source;
+    const uint16_t channel_count = source.GetChannelCount();
+    const float step = static_cast<float>(source.GetSampleRate()) /
+                       static_cast<float>(m_nSampleRate);
+
+    // the frames interpolated between, up to the one after the last
+    size_t have = voice.window[0].size();
+    const size_t needed =
+        static_cast<size_t>(voice.position +
+                            static_cast<float>(frame_count - 1) * step) +
+        2;
+    if (have < needed && !voice.ended) {
+        m_Interleaved.resize((needed - have) * channel_count);
+        const size_t read = source.Read(m_Interleaved.data(), needed - have);
+        for (uint16_t c = 0; c < channel_count; c++) {
+            auto& window = voice.window[c];
+            window.resize(have + read);
+            for (size_t i = 0; i < read; i++) {
+                window[have + i] = m_Interleaved[i * channel_count + c];
+            }
+        }
+        if (read < needed - have) {
+            if (source.IsFinished()) {
+                // fades out towards silence after the last frame
+                voice.ended = true;
+                for (uint16_t c = 0; c < channel_count; c++) {
+                    voice.window[c].push_back(0.0f);
+                }
+            } else {
+                m_nUnderrunCount++;
+            }
+        }
+        have = voice.window[0].size();
+    }
+
+    // as many as there are frames for, the rest is silence
+    size_t count = frame_count;
+    if (have < needed) {
+        const float span = static_cast<float>(have) - 1.0f - voice.position;
+        count = span > 0.0f ? static_cast<size_t>(ceil(span / step)) : 0;
+        count = min(count, frame_count);
+        while (count &&
+               static_cast<size_t>(voice.position +
+                                   static_cast<float>(count - 1) * step) +
+                       1 >=
+                   have) {
+            count--;
+        }
+    }
+
+    float gains[kChannelCount];
+    pan_gains(voice.volume, voice.pan, channel_count, gains);
+    if (!voice.started) {
+        copy_n(gains, kChannelCount, voice.gains);
+        voice.started = true;
+    }
+
+    if (count) {
+        m_Resampled.resize(kBlockFrames * channel_count);
+        for (uint16_t c = 0; c < channel_count; c++) {
+            resample_linear(voice.window[c].data(), voice.position, step,
+                            count, &m_Resampled[c * kBlockFrames]);
+        }
+        const float* left = m_Resampled.data();
+        const float* right =
+            channel_count == 1 ? left : left + kBlockFrames;
+        accumulate(left, right, count, voice.gains, gains, frames);
+    }
+    copy_n(gains, kChannelCount, voice.gains);
+
+    // drop the frames played past
+    const float end = voice.position + static_cast<float>(count) * step;
+    const size_t consumed = min(static_cast<size_t>(end), have);
+    voice.position = end - static_cast<float>(consumed);
+    for (uint16_t c = 0; c < channel_count; c++) {
+        auto& window = voice.window[c];
+        window.erase(window.begin(), window.begin() + consumed);
+    }
+
+    return !voice.ended || voice.window[0].size() >= 2;
+}
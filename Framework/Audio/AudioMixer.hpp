@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AudioSource.hpp"
+
+namespace My {
+// Sums any number of voices into stereo float frames at one sample rate.
+// Each voice is converted from the rate of its source by linear
+// interpolation, then scaled by its volume and panned; changes of either
+// are ramped over a block so they do not click. Voices are removed once
+// their source has finished.
+//
+// The voices can be changed from any thread while another one mixes.
+class AudioMixer {
+   public:
+    using VoiceId = int32_t;
+    static constexpr uint16_t kChannelCount = 2;
+
+    explicit AudioMixer(uint32_t sample_rate = 48000)
+        : m_nSampleRate(sample_rate) {}
+
+    void SetSampleRate(uint32_t sample_rate) { m_nSampleRate = sample_rate; }
+    [[nodiscard]] uint32_t GetSampleRate() const { return m_nSampleRate; }
+
+    // pan from -1, left only, to 1, right only
+    VoiceId AddVoice(std::shared_ptr<AudioSource> source, float volume,
+                     float pan);
+    void StopVoice(VoiceId id);
+    void StopAllVoices();
+    void SetVolume(VoiceId id, float volume);
+    void SetPan(VoiceId id, float pan);
+    [[nodiscard]] bool IsPlaying(VoiceId id) const;
+    [[nodiscard]] size_t GetVoiceCount() const;
+
+    // overwrites frame_count interleaved stereo frames
+    void Mix(float* frames, size_t frame_count);
+
+    // times a voice had fewer frames ready than it had to play
+    [[nodiscard]] size_t GetUnderrunCount() const { return m_nUnderrunCount; }
+
+   private:
+    struct Voice {
+        VoiceId id;
+        std::shared_ptr<AudioSource> source;
+        float volume;
+        float pan;
+        // as last mixed, ramped towards volume and pan
+        float gains[kChannelCount];
+        bool started{false};
+        // the source has no more frames than those in window
+        bool ended{false};
+        // in source frames from the first one in window
+        float position{0.0f};
+        // source frames not yet played past, a plane per channel
+        std::vector<float> window[kChannelCount];
+    };
+
+    Voice* findVoice(VoiceId id);
+    // false once the voice has nothing left to play
+    bool mixVoice(Voice& voice, float* frames, size_t frame_count);
+
+   private:
+    uint32_t m_nSampleRate;
+    mutable std::mutex m_Lock;
+    std::vector<Voice> m_Voices;
+    VoiceId m_nNextId{0};
+    size_t m_nUnderrunCount{0};
+    // per block
+    std::vector<float> m_Interleaved;
+    std::vector<float> m_Resampled;
+};
+}  // namespace My
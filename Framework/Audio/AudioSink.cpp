@@ -0,0 +1,79 @@
+#include "AudioSink.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PcmConversion.hpp"
+#include "WAVE.hpp"
+
+using namespace My;
+using namespace std;
+
+void NullAudioSink::Write(const float* frames, size_t frame_count) {
+    for (size_t i = 0; i < frame_count * m_nChannelCount; i++) {
+        m_fPeak = max(m_fPeak, fabs(frames[i]));
+    }
+    m_nFrameCount += frame_count;
+}
+
+bool WaveFileAudioSink::Open(uint32_t sample_rate, uint16_t channel_count) {
+    Close();
+
+    m_pFile = fopen(m_Path.c_str(), "wb");
+    if (!m_pFile) {
+        fprintf(stderr, "Can not open %s for writing\n", m_Path.c_str());
+        return false;
+    }
+
+    m_nChannelCount = channel_count;
+    m_nDataSize = 0;
+
+    // the sizes are filled in by Close()
+    WAVE_FILEHEADER file_header = {
+        {'R', 'I', 'F', 'F'}, 0, {'W', 'A', 'V', 'E'}};
+    WAVE_FORMAT_CHUNKHEADER format_chunk_header = {
+        {{'f', 'm', 't', ' '},
+         sizeof(WAVE_FORMAT_CHUNKHEADER) - sizeof(WAVE_CHUNKHEADER)},
+        1,  // PCM
+        channel_count,
+        sample_rate,
+        sample_rate * channel_count * 2,
+        static_cast<uint16_t>(channel_count * 2),
+        16};
+    WAVE_DATA_CHUNKHEADER data_chunk_header = {{{'d', 'a', 't', 'a'}, 0}};
+    fwrite(&file_header, sizeof(file_header), 1, m_pFile);
+    fwrite(&format_chunk_header, sizeof(format_chunk_header), 1, m_pFile);
+    fwrite(&data_chunk_header, sizeof(data_chunk_header), 1, m_pFile);
+
+    return true;
+}
+
+void WaveFileAudioSink::Write(const float* frames, size_t frame_count) {
+    if (!m_pFile) return;
+
+    const size_t sample_count = frame_count * m_nChannelCount;
+    m_Samples.resize(sample_count);
+    ConvertFromFloat(m_nChannelCount == 1 ? AudioClipFormat::MONO_16
+                                          : AudioClipFormat::STEREO_16,
+                     frames, sample_count, m_Samples.data());
+    fwrite(m_Samples.data(), sizeof(int16_t), sample_count, m_pFile);
+    m_nDataSize += static_cast<uint32_t>(sample_count * sizeof(int16_t));
+}
+
+void WaveFileAudioSink::Close() {
+    if (!m_pFile) return;
+
+    const uint32_t file_size =
+        sizeof(WAVE_FILEHEADER) + sizeof(WAVE_FORMAT_CHUNKHEADER) +
+        sizeof(WAVE_DATA_CHUNKHEADER) + m_nDataSize - RIFF_HEADER_SIZE;
+    fseek(m_pFile, offsetof(WAVE_FILEHEADER, FileSize), SEEK_SET);
+    fwrite(&file_size, sizeof(file_size), 1, m_pFile);
+    fseek(m_pFile,
+          sizeof(WAVE_FILEHEADER) + sizeof(WAVE_FORMAT_CHUNKHEADER) +
+              offsetof(WAVE_CHUNKHEADER, ChunkSize),
+          SEEK_SET);
+    fwrite(&m_nDataSize, sizeof(m_nDataSize), 1, m_pFile);
+
+    fclose(m_pFile);
+    m_pFile = nullptr;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "IAudioSink.hpp"
+
+namespace My {
+// Drops what is written, keeping count of it. For running without a device.
+class NullAudioSink : _implements_ IAudioSink {
+   public:
+    bool Open(uint32_t sample_rate, uint16_t channel_count) override {
+        m_nSampleRate = sample_rate;
+        m_nChannelCount = channel_count;
+        m_nFrameCount = 0;
+        m_fPeak = 0.0f;
+        return true;
+    }
+    void Write(const float* frames, size_t frame_count) override;
+    void Close() override {}
+
+    [[nodiscard]] uint32_t GetSampleRate() const { return m_nSampleRate; }
+    [[nodiscard]] uint16_t GetChannelCount() const { return m_nChannelCount; }
+    [[nodiscard]] size_t GetFrameCount() const { return m_nFrameCount; }
+    // largest magnitude of a sample written
+    [[nodiscard]] float GetPeak() const { return m_fPeak; }
+
+   private:
+    uint32_t m_nSampleRate{0};
+    uint16_t m_nChannelCount{0};
+    size_t m_nFrameCount{0};
+    float m_fPeak{0.0f};
+};
+
+// Writes a 16-bit PCM wave file, complete once closed.
+class WaveFileAudioSink : _implements_ IAudioSink {
+   public:
+    explicit WaveFileAudioSink(std::string path) : m_Path(std::move(path)) {}
+    ~WaveFileAudioSink() override { Close(); }
+
+    bool Open(uint32_t sample_rate, uint16_t channel_count) override;
+    void Write(const float* frames, size_t frame_count) override;
+    void Close() override;
+
+   private:
+    std::string m_Path;
+    FILE* m_pFile{nullptr};
+    uint16_t m_nChannelCount{0};
+    uint32_t m_nDataSize{0};
+    std::vector<int16_t> m_Samples;
+};
+}  // namespace My
@@ -0,0 +1,84 @@
+#include "AudioSource.hpp"
+
+#include <algorithm>
+
+#include "PcmConversion.hpp"
+#include "Resampler.hpp"
+
+using namespace My;
+using namespace std;
+
+AudioClipSource::AudioClipSource(const AudioClip& clip, bool loop,
+                                 uint32_t sample_rate)
+    : AudioSource(clip.channel_num, sample_rate),
+      m_nFrameCount(clip.data_length / clip.block_size),
+      m_bLoop(loop) {
+    m_Samples.resize(m_nFrameCount * m_nChannelCount);
+    ConvertToFloat(clip.format, clip.data, m_Samples.size(), m_Samples.data());
+
+    if (sample_rate != clip.sample_rate) {
+        PolyphaseResampler resampler(clip.sample_rate, sample_rate);
+        const size_t frame_count = resampler.GetOutputFrameCount(m_nFrameCount);
+        vector<float, TaggedAllocator<float>> resampled(
+            frame_count * m_nChannelCount, m_Samples.get_allocator());
+        resampler.Process(m_Samples.data(), m_nFrameCount, m_nChannelCount,
+                          resampled.data());
+        m_Samples = std::move(resampled);
+        m_nFrameCount = frame_count;
+    }
+}
+
+size_t AudioClipSource::Read(float* frames, size_t frame_count) {
+    size_t read = 0;
+    while (read < frame_count && m_nFrameCount) {
+        if (m_nFrame == m_nFrameCount) {
+            if (!m_bLoop) break;
+            m_nFrame = 0;
+        }
+        const size_t count = min(frame_count - read, m_nFrameCount - m_nFrame);
+        copy_n(&m_Samples[m_nFrame * m_nChannelCount], count * m_nChannelCount,
+               frames + read * m_nChannelCount);
+        m_nFrame += count;
+        read += count;
+    }
+    return read;
+}
+
+StreamingAudioSource::StreamingAudioSource(unique_ptr<WaveStream> stream,
+                                           bool loop, size_t buffer_frames)
+    : AudioSource(stream->GetFormat().channel_num,
+                  stream->GetFormat().sample_rate),
+      m_pStream(std::move(stream)),
+      m_Ring(buffer_frames * m_nChannelCount),
+      m_bLoop(loop) {}
+
+size_t StreamingAudioSource::Read(float* frames, size_t frame_count) {
+    // the decoder writes whole frames only
+    const size_t frames_ready =
+        min(frame_count, m_Ring.GetReadAvailable() / m_nChannelCount);
+    return m_Ring.Read(frames, frames_ready * m_nChannelCount) /
+           m_nChannelCount;
+}
+
+bool StreamingAudioSource::Decode() {
+    if (m_bEndOfStream.load(memory_order_relaxed)) return false;
+
+    size_t frame_count = m_Ring.GetWriteAvailable() / m_nChannelCount;
+    while (frame_count) {
+        m_Decoded.resize(frame_count * m_nChannelCount);
+        const size_t read = m_pStream->Read(m_Decoded.data(), frame_count);
+        m_Ring.Write(m_Decoded.data(), read * m_nChannelCount);
+        frame_count -= read;
+
+        if (read == 0) {
+            // at the end of the data
+            if (!m_bLoop || !m_pStream->Rewind() ||
+                m_pStream->GetFrameCount() == 0) {
+                m_bEndOfStream.store(true, memory_order_release);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AudioClip.hpp"
+#include "MemoryTracker.hpp"
+#include "RingBuffer.hpp"
+#include "WaveStream.hpp"
+
+namespace My {
+// A sound the mixer plays, read as interleaved float frames at its own
+// sample rate. Read() and IsFinished() are called from the mixer thread
+// only.
+class AudioSource {
+   public:
+    AudioSource(uint16_t channel_count, uint32_t sample_rate)
+        : m_nChannelCount(channel_count), m_nSampleRate(sample_rate) {}
+    virtual ~AudioSource() = default;
+
+    // up to frame_count frames, fewer when no more are ready yet or the
+    // sound has ended
+    virtual size_t Read(float* frames, size_t frame_count) = 0;
+    // no frame is left to read
+    [[nodiscard]] virtual bool IsFinished() const = 0;
+
+    [[nodiscard]] uint16_t GetChannelCount() const { return m_nChannelCount; }
+    [[nodiscard]] uint32_t GetSampleRate() const { return m_nSampleRate; }
+
+   protected:
+    uint16_t m_nChannelCount;
+    uint32_t m_nSampleRate;
+};
+
+// A clip loaded as a whole. It is converted to float, and to sample_rate
+// if it is not at it, once when created; playing it is then a copy.
+class AudioClipSource : public AudioSource {
+   public:
+    AudioClipSource(const AudioClip& clip, bool loop, uint32_t sample_rate);
+
+    size_t Read(float* frames, size_t frame_count) override;
+    [[nodiscard]] bool IsFinished() const override {
+        return !m_bLoop && m_nFrame == m_nFrameCount;
+    }
+
+   private:
+    std::vector<float, TaggedAllocator<float>> m_Samples{
+        TaggedAllocator<float>(MemoryTag::kAudio)};
+    size_t m_nFrameCount;
+    size_t m_nFrame{0};
+    bool m_bLoop;
+};
+
+// A clip decoded from a WaveStream ahead of the mixer, into a lock free
+// ring buffer. Decode() is called from one decoder thread, Read() from the
+// mixer one.
+class StreamingAudioSource : public AudioSource {
+   public:
+    // buffer_frames decoded ahead at most
+    StreamingAudioSource(std::unique_ptr<WaveStream> stream, bool loop,
+                         size_t buffer_frames);
+
+    size_t Read(float* frames, size_t frame_count) override;
+    [[nodiscard]] bool IsFinished() const override {
+        return m_bEndOfStream.load(std::memory_order_acquire) &&
+               m_Ring.GetReadAvailable() == 0;
+    }
+
+    // decoder thread: fills the ring buffer up, false once there is nothing
+    // more to decode
+    bool Decode();
+
+   private:
+    std::unique_ptr<WaveStream> m_pStream;
+    RingBuffer<float> m_Ring;
+    // what the decoder read, before it goes in the ring buffer
+    std::vector<float> m_Decoded;
+    bool m_bLoop;
+    std::atomic<bool> m_bEndOfStream{false};
+};
+}  // namespace My
@@ -0,0 +1,179 @@
+#include "PcmConversion.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace My;
+using namespace std;
+
+namespace {
+// half away from zero, by truncation, which has an instruction of its own
+// where std::lround() is a call
+inline int32_t round_to_int(float value) {
+    return static_cast<int32_t>(value + (value < 0.0f ? -0.5f : 0.5f));
+}
+
+// the largest float under 2^31, as 2^31 itself does not fit in an int32_t
+constexpr float kInt32Max = 2147483520.0f;
+
+void uint8_to_float(const uint8_t* src, size_t count, float* dst) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (static_cast<float>(src[i]) - 128.0f) * (1.0f / 128.0f);
+    }
+}
+
+void float_to_uint8(const float* src, size_t count, uint8_t* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float scaled = std::clamp(src[i] * 128.0f, -128.0f, 127.0f);
+        dst[i] = static_cast<uint8_t>(round_to_int(scaled) + 128);
+    }
+}
+
+void int16_to_float(const int16_t* src, size_t count, float* dst) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / 32768.0f);
+    }
+}
+
+void float_to_int16(const float* src, size_t count, int16_t* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float scaled = std::clamp(src[i] * 32768.0f, -32768.0f, 32767.0f);
+        dst[i] = static_cast<int16_t>(round_to_int(scaled));
+    }
+}
+
+// little endian, 3 bytes a sample
+void int24_to_float(const uint8_t* src, size_t count, float* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const auto packed = static_cast<uint32_t>(src[3 * i]) |
+                            static_cast<uint32_t>(src[3 * i + 1]) << 8 |
+                            static_cast<uint32_t>(src[3 * i + 2]) << 16;
+        // the sign bit moved to the top and back
+        const int32_t value = static_cast<int32_t>(packed << 8) >> 8;
+        dst[i] = static_cast<float>(value) * (1.0f / 8388608.0f);
+    }
+}
+
+void float_to_int24(const float* src, size_t count, uint8_t* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float scaled =
+            std::clamp(src[i] * 8388608.0f, -8388608.0f, 8388607.0f);
+        const auto value = static_cast<uint32_t>(round_to_int(scaled));
+        dst[3 * i] = static_cast<uint8_t>(value);
+        dst[3 * i + 1] = static_cast<uint8_t>(value >> 8);
+        dst[3 * i + 2] = static_cast<uint8_t>(value >> 16);
+    }
+}
+
+void int32_to_float(const int32_t* src, size_t count, float* dst) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / 2147483648.0f);
+    }
+}
+
+void float_to_int32(const float* src, size_t count, int32_t* dst) {
+    for (size_t i = 0; i < count; i++) {
+        const float scaled =
+            std::clamp(src[i] * 2147483648.0f, -2147483648.0f, kInt32Max);
+        dst[i] = round_to_int(scaled);
+    }
+}
+
+bool is_float(AudioClipFormat format) {
+    return format == AudioClipFormat::MONO_FLOAT32 ||
+           format == AudioClipFormat::STEREO_FLOAT32;
+}
+}  // namespace
+
+uint16_t My::GetBytesPerSample(AudioClipFormat format) {
+    switch (format) {
+        case AudioClipFormat::MONO_8:
+        case AudioClipFormat::STEREO_8:
+            return 1;
+        case AudioClipFormat::MONO_16:
+        case AudioClipFormat::STEREO_16:
+            return 2;
+        case AudioClipFormat::MONO_24:
+        case AudioClipFormat::STEREO_24:
+            return 3;
+        case AudioClipFormat::MONO_32:
+        case AudioClipFormat::STEREO_32:
+        case AudioClipFormat::MONO_FLOAT32:
+        case AudioClipFormat::STEREO_FLOAT32:
+            return 4;
+    }
+    return 0;
+}
+
+uint16_t My::GetChannelCount(AudioClipFormat format) {
+    switch (format) {
+        case AudioClipFormat::MONO_8:
+        case AudioClipFormat::MONO_16:
+        case AudioClipFormat::MONO_24:
+        case AudioClipFormat::MONO_32:
+        case AudioClipFormat::MONO_FLOAT32:
+            return 1;
+        case AudioClipFormat::STEREO_8:
+        case AudioClipFormat::STEREO_16:
+        case AudioClipFormat::STEREO_24:
+        case AudioClipFormat::STEREO_32:
+        case AudioClipFormat::STEREO_FLOAT32:
+            return 2;
+    }
+    return 0;
+}
+
+void My::ConvertToFloat(AudioClipFormat format, const void* src,
+                        size_t sample_count, float* dst) {
+    if (is_float(format)) {
+        memcpy(dst, src, sample_count * sizeof(float));
+        return;
+    }
+
+    switch (GetBytesPerSample(format)) {
+        case 1:
+            uint8_to_float(static_cast<const uint8_t*>(src), sample_count,
+                           dst);
+            break;
+        case 2:
+            int16_to_float(static_cast<const int16_t*>(src), sample_count,
+                           dst);
+            break;
+        case 3:
+            int24_to_float(static_cast<const uint8_t*>(src), sample_count,
+                           dst);
+            break;
+        case 4:
+            int32_to_float(static_cast<const int32_t*>(src), sample_count,
+                           dst);
+            break;
+        default:
+            assert(0);
+    }
+}
+
+void My::ConvertFromFloat(AudioClipFormat format, const float* src,
+                          size_t sample_count, void* dst) {
+    if (is_float(format)) {
+        memcpy(dst, src, sample_count * sizeof(float));
+        return;
+    }
+
+    switch (GetBytesPerSample(format)) {
+        case 1:
+            float_to_uint8(src, sample_count, static_cast<uint8_t*>(dst));
+            break;
+        case 2:
+            float_to_int16(src, sample_count, static_cast<int16_t*>(dst));
+            break;
+        case 3:
+            float_to_int24(src, sample_count, static_cast<uint8_t*>(dst));
+            break;
+        case 4:
+            float_to_int32(src, sample_count, static_cast<int32_t*>(dst));
+            break;
+        default:
+            assert(0);
+    }
+}
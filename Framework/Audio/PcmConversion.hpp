@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioClip.hpp"
+
+namespace My {
+// Conversions between the sample formats of AudioClip and the 32-bit float
+// samples the mixer works in, -1 to 1. Counts are of samples, a frame of a
+// stereo clip having two. The loops have no dependency from one sample to
+// the next and round without calling into the C library, so the compiler
+// vectorizes them.
+
+[[nodiscard]] uint16_t GetBytesPerSample(AudioClipFormat format);
+[[nodiscard]] uint16_t GetChannelCount(AudioClipFormat format);
+
+void ConvertToFloat(AudioClipFormat format, const void* src,
+                    size_t sample_count, float* dst);
+
+// integers rounded and clamped, floats copied as they are
+void ConvertFromFloat(AudioClipFormat format, const float* src,
+                      size_t sample_count, void* dst);
+}  // namespace My
@@ -0,0 +1,99 @@
+#include "Resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "geommath.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+// of the Nyquist rate, the rest is the transition band of the filter
+constexpr double kPassBand = 0.9;
+// partial sums kept apart, so the dot product vectorizes without
+// reassociating the floating point additions
+constexpr uint32_t kLanes = 8;
+
+double sinc(double x) { return x == 0.0 ? 1.0 : sin(PI * x) / (PI * x); }
+
+// Blackman, over [-taps / 2, taps / 2]
+double window(double x, uint32_t taps) {
+    const double t = x / taps;
+    return 0.42 + 0.5 * cos(2.0 * PI * t) + 0.08 * cos(4.0 * PI * t);
+}
+}  // namespace
+
+PolyphaseResampler::PolyphaseResampler(uint32_t input_rate,
+                                       uint32_t output_rate) {
+    const uint32_t divisor = gcd(input_rate, output_rate);
+    m_nUp = output_rate / divisor;
+    m_nDown = input_rate / divisor;
+    m_nPhases = min(m_nUp, kMaxPhases);
+    m_nTaps = kTaps * max(1u, (m_nDown + m_nUp - 1) / m_nUp);
+    // taps before the one the output frame is on or after
+    const uint32_t taps_before = m_nTaps / 2 - 1;
+
+    // in cycles per input frame
+    const double cutoff =
+        0.5 * kPassBand * min(1.0, static_cast<double>(output_rate) /
+                                       static_cast<double>(input_rate));
+    m_Coefficients.resize(static_cast<size_t>(m_nPhases) * m_nTaps);
+    for (uint32_t p = 0; p < m_nPhases; p++) {
+        const double fraction = static_cast<double>(p) / m_nPhases;
+        float* coefficients = &m_Coefficients[p * m_nTaps];
+        double sum = 0.0;
+        for (uint32_t k = 0; k < m_nTaps; k++) {
+            const double distance =
+                static_cast<double>(k) - taps_before - fraction;
+            const double c = 2.0 * cutoff * sinc(2.0 * cutoff * distance) *
+                             window(distance, m_nTaps);
+            coefficients[k] = static_cast<float>(c);
+            sum += c;
+        }
+        // a constant stays the same
+        for (uint32_t k = 0; k < m_nTaps; k++) {
+            coefficients[k] = static_cast<float>(coefficients[k] / sum);
+        }
+    }
+}
+
+size_t PolyphaseResampler::GetOutputFrameCount(
+    size_t input_frame_count) const {
+    return (static_cast<uint64_t>(input_frame_count) * m_nUp + m_nDown - 1) /
+           m_nDown;
+}
+
+void PolyphaseResampler::Process(const float* input, size_t input_frame_count,
+                                 uint16_t channel_count, float* output) {
+    const size_t output_frame_count = GetOutputFrameCount(input_frame_count);
+    const uint32_t taps_before = m_nTaps / 2 - 1;
+    m_Padded.assign(input_frame_count + m_nTaps, 0.0f);
+
+    for (uint16_t c = 0; c < channel_count; c++) {
+        for (size_t i = 0; i < input_frame_count; i++) {
+            m_Padded[taps_before + i] = input[i * channel_count + c];
+        }
+
+        for (size_t n = 0; n < output_frame_count; n++) {
+            // output frame n is at n * down / up input frames
+            const uint64_t position = static_cast<uint64_t>(n) * m_nDown;
+            const size_t i = position / m_nUp;
+            const auto phase = static_cast<uint32_t>(
+                (position % m_nUp) * m_nPhases / m_nUp);
+
+            const float* x = &m_Padded[i];
+            const float* h = &m_Coefficients[phase * m_nTaps];
+            float sums[kLanes] = {};
+            for (uint32_t k = 0; k < m_nTaps; k += kLanes) {
+                for (uint32_t l = 0; l < kLanes; l++) {
+                    sums[l] += h[k + l] * x[k + l];
+                }
+            }
+            float sum = 0.0f;
+            for (float partial : sums) sum += partial;
+            output[n * channel_count + c] = sum;
+        }
+    }
+}
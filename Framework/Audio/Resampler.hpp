@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace My {
+// Converts interleaved float frames from one sample rate to another with a
+// windowed sinc filter. The ratio is reduced to up / down; an output frame
+// falls on one of up fractions of an input frame, and each fraction, or
+// phase, has its own coefficients computed once: kTaps of them, times the
+// ratio when going down so the filter is as sharp at the output rate. Below
+// the lower of the two Nyquist rates the signal is kept, above it filtered
+// out.
+//
+// A ratio with more than kMaxPhases phases rounds down to one of
+// kMaxPhases.
+class PolyphaseResampler {
+   public:
+    static constexpr uint32_t kTaps = 32;
+    static constexpr uint32_t kMaxPhases = 256;
+
+    PolyphaseResampler(uint32_t input_rate, uint32_t output_rate);
+
+    [[nodiscard]] size_t GetOutputFrameCount(size_t input_frame_count) const;
+
+    // the whole of a clip, silence assumed before and after it
+    void Process(const float* input, size_t input_frame_count,
+                 uint16_t channel_count, float* output);
+
+   private:
+    uint32_t m_nUp;
+    uint32_t m_nDown;
+    uint32_t m_nPhases;
+    uint32_t m_nTaps;
+    // m_nTaps a phase
+    std::vector<float> m_Coefficients;
+    // a channel of the input with m_nTaps frames of silence around it
+    std::vector<float> m_Padded;
+};
+}  // namespace My
@@ -0,0 +1,133 @@
+#include "WaveStream.hpp"
+
+#include <cstring>
+
+#include "PcmConversion.hpp"
+#include "WAVE.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+bool is_marker(const uint8_t* marker, const char* name) {
+    return memcmp(marker, name, 4) == 0;
+}
+}  // namespace
+
+bool WaveStream::Open(IAssetLoader* pAssetLoader, const char* path) {
+    Close();
+
+    m_pAssetLoader = pAssetLoader;
+    m_pFile = pAssetLoader->OpenFile(path, IAssetLoader::MY_OPEN_BINARY);
+    if (!m_pFile) {
+        fprintf(stderr, "Can not open %s\n", path);
+        return false;
+    }
+
+    Buffer file_header(sizeof(WAVE_FILEHEADER));
+    if (!m_pAssetLoader->SyncRead(m_pFile, file_header)) {
+        Close();
+        return false;
+    }
+    const auto* pFileHeader =
+        reinterpret_cast<const WAVE_FILEHEADER*>(file_header.GetData());
+    if (!is_marker(pFileHeader->Magic, "RIFF") ||
+        !is_marker(pFileHeader->FileTypeHeader, "WAVE")) {
+        fprintf(stderr, "%s is not a wave file\n", path);
+        Close();
+        return false;
+    }
+
+    // the chunks up to the data one, skipping those not needed. The format
+    // chunk comes first.
+    size_t offset = sizeof(WAVE_FILEHEADER);
+    bool has_format = false;
+    Buffer chunk_header(sizeof(WAVE_CHUNKHEADER));
+    while (m_pAssetLoader->SyncRead(m_pFile, chunk_header)) {
+        WAVE_CHUNKHEADER header;
+        memcpy(&header, chunk_header.GetData(), sizeof(header));
+        offset += sizeof(WAVE_CHUNKHEADER);
+
+        if (is_marker(header.ChunkMarker, "fmt ")) {
+            // the extensible one is the largest there is
+            WAVE_FORMAT_EXTENSIBLE_CHUNKHEADER format{};
+            const size_t min_size =
+                sizeof(WAVE_FORMAT_CHUNKHEADER) - sizeof(WAVE_CHUNKHEADER);
+            if (header.ChunkSize < min_size) break;
+            Buffer body(header.ChunkSize);
+            if (!m_pAssetLoader->SyncRead(m_pFile, body)) break;
+            memcpy(&format, &header, sizeof(header));
+            memcpy(reinterpret_cast<uint8_t*>(&format) +
+                       sizeof(WAVE_CHUNKHEADER),
+                   body.GetData(),
+                   min<size_t>(header.ChunkSize,
+                               sizeof(format) - sizeof(WAVE_CHUNKHEADER)));
+            if (!WaveParser::ParseFormat(format, m_Format)) {
+                fprintf(stderr, "%s: %u channels of %u bits not supported\n",
+                        path, m_Format.channel_num, m_Format.bits_per_sample);
+                break;
+            }
+            has_format = true;
+            offset += header.ChunkSize;
+            // chunks are word aligned
+            if (header.ChunkSize & 1) {
+                m_pAssetLoader->Seek(m_pFile, 1, IAssetLoader::MY_SEEK_CUR);
+                offset++;
+            }
+        } else if (is_marker(header.ChunkMarker, "data")) {
+            if (!has_format) break;
+            m_Format.data = nullptr;
+            m_Format.data_length = header.ChunkSize;
+            m_nDataOffset = offset;
+            m_nFramesLeft = GetFrameCount();
+            return true;
+        } else {
+            const size_t size = header.ChunkSize + (header.ChunkSize & 1);
+            m_pAssetLoader->Seek(m_pFile, static_cast<long>(size),
+                                 IAssetLoader::MY_SEEK_CUR);
+            offset += size;
+        }
+    }
+
+    fprintf(stderr, "%s has no wave data\n", path);
+    Close();
+    return false;
+}
+
+void WaveStream::Close() {
+    if (m_pFile) {
+        m_pAssetLoader->CloseFile(m_pFile);
+        m_pFile = nullptr;
+    }
+    m_nFramesLeft = 0;
+}
+
+size_t WaveStream::Read(float* frames, size_t frame_count) {
+    frame_count = min(frame_count, m_nFramesLeft);
+    if (!frame_count) return 0;
+
+    // SyncRead() reads as much as the buffer holds
+    const size_t size = frame_count * m_Format.block_size;
+    if (m_Chunk.GetDataSize() != size) {
+        m_Chunk = Buffer(size);
+    }
+    if (!m_pAssetLoader->SyncRead(m_pFile, m_Chunk)) {
+        m_nFramesLeft = 0;
+        return 0;
+    }
+
+    ConvertToFloat(m_Format.format, m_Chunk.GetData(),
+                   frame_count * m_Format.channel_num, frames);
+    m_nFramesLeft -= frame_count;
+    return frame_count;
+}
+
+bool WaveStream::Rewind() {
+    if (!m_pFile ||
+        m_pAssetLoader->Seek(m_pFile, static_cast<long>(m_nDataOffset),
+                             IAssetLoader::MY_SEEK_SET) != 0) {
+        return false;
+    }
+    m_nFramesLeft = GetFrameCount();
+    return true;
+}
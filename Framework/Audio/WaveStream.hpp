@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioClip.hpp"
+#include "Buffer.hpp"
+#include "IAssetLoader.hpp"
+
+namespace My {
+// Reads the samples of a wave file a chunk at a time through an
+// IAssetLoader, converted to float, so a long clip never has to be in
+// memory as a whole.
+class WaveStream {
+   public:
+    WaveStream() = default;
+    ~WaveStream() { Close(); }
+
+    WaveStream(const WaveStream&) = delete;
+    WaveStream& operator=(const WaveStream&) = delete;
+
+    // reads the header, false if the file is not a wave file in one of the
+    // formats AudioClipFormat has
+    bool Open(IAssetLoader* pAssetLoader, const char* path);
+    void Close();
+
+    // up to frame_count interleaved frames, fewer at the end of the data
+    size_t Read(float* frames, size_t frame_count);
+    // back to the first frame
+    bool Rewind();
+
+    // data is null, data_length is the size of the data chunk
+    [[nodiscard]] const AudioClip& GetFormat() const { return m_Format; }
+    [[nodiscard]] size_t GetFrameCount() const {
+        return m_Format.data_length / m_Format.block_size;
+    }
+
+   private:
+    IAssetLoader* m_pAssetLoader{nullptr};
+    IAssetLoader::AssetFilePtr m_pFile{nullptr};
+    AudioClip m_Format{};
+    // from the start of the file
+    size_t m_nDataOffset{0};
+    size_t m_nFramesLeft{0};
+    Buffer m_Chunk;
+};
+}  // namespace My
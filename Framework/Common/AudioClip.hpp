@@ -4,11 +4,19 @@
 #include <iostream>
 
 namespace My {
+    // 8-bit samples are unsigned, the other integer ones signed, 24-bit
+    // ones packed in 3 bytes
     enum class AudioClipFormat : uint16_t {
         MONO_8,
         MONO_16,
         STEREO_8,
-        STEREO_16
+        STEREO_16,
+        MONO_24,
+        STEREO_24,
+        MONO_32,
+        STEREO_32,
+        MONO_FLOAT32,
+        STEREO_FLOAT32
     };
 
     struct AudioClip {
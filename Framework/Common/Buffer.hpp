@@ -4,13 +4,19 @@
 #include <cstring>
 #include <memory>
 
+#include "MemoryTracker.hpp"
+
 namespace My {
+// The data is counted under the MemoryTagScope current when the buffer
+// took it, for as long as the buffer owns it.
 class Buffer {
    public:
     Buffer() = default;
 
-    explicit Buffer(size_t size, size_t alignment = 4) : m_szSize(size) {
+    explicit Buffer(size_t size, size_t alignment = 4)
+        : m_szSize(size), m_Tag(MemoryTagScope::GetCurrentTag()) {
         m_pData = reinterpret_cast<uint8_t*>(new uint8_t[size]);
+        MemoryTracker::RecordAllocation(m_Tag, m_szSize);
     }
 
     Buffer(const Buffer& rhs) = delete;
@@ -18,6 +24,7 @@ class Buffer {
     Buffer(Buffer&& rhs) noexcept {
         m_pData = rhs.m_pData;
         m_szSize = rhs.m_szSize;
+        m_Tag = rhs.m_Tag;
         rhs.m_pData = nullptr;
         rhs.m_szSize = 0;
     }
@@ -25,40 +32,52 @@ class Buffer {
     Buffer& operator=(const Buffer& rhs) = delete;
 
     Buffer& operator=(Buffer&& rhs) noexcept {
-        delete[] m_pData;
+        release();
         m_pData = rhs.m_pData;
         m_szSize = rhs.m_szSize;
+        m_Tag = rhs.m_Tag;
         rhs.m_pData = nullptr;
         rhs.m_szSize = 0;
         return *this;
     }
 
-    ~Buffer() {
-        if (m_pData != nullptr) {
-            delete[] m_pData;
-        }
-    }
+    ~Buffer() { release(); }
 
     [[nodiscard]] uint8_t* GetData() { return m_pData; };
     [[nodiscard]] const uint8_t* GetData() const { return m_pData; };
     [[nodiscard]] size_t GetDataSize() const { return m_szSize; };
+    [[nodiscard]] MemoryTag GetTag() const { return m_Tag; }
+
+    // the caller owns the data from now on, it is no longer counted
     uint8_t* MoveData() {
+        if (m_pData != nullptr) MemoryTracker::RecordFree(m_Tag, m_szSize);
         uint8_t* tmp = m_pData;
         m_pData = nullptr;
         m_szSize = 0;
         return tmp;
     }
 
+    // takes data, allocated with new[]
     void SetData(uint8_t* data, size_t size) {
-        if (m_pData != nullptr) {
-            delete[] m_pData;
-        }
+        release();
         m_pData = data;
         m_szSize = size;
+        m_Tag = MemoryTagScope::GetCurrentTag();
+        if (m_pData != nullptr) MemoryTracker::RecordAllocation(m_Tag, size);
     }
 
    protected:
+    void release() {
+        if (m_pData != nullptr) {
+            MemoryTracker::RecordFree(m_Tag, m_szSize);
+            delete[] m_pData;
+        }
+        m_pData = nullptr;
+        m_szSize = 0;
+    }
+
     uint8_t* m_pData{nullptr};
     size_t m_szSize{0};
+    MemoryTag m_Tag{MemoryTag::kUntagged};
 };
 }  // namespace My
@@ -12,9 +12,36 @@ struct DrawBatchContext : PerBatchConstants {
     std::shared_ptr<SceneGeometryNode> node;
     material_textures material;
 
+    // mesh LOD, selected per frame by screen space error
+    uint32_t lod{0};
+    std::vector<float> lodErrors;  // object space error of each LOD
+    BoundingBox boundingBox;       // object space bounding box of the mesh
+
+    // meshlets of the index array drawn by this batch, owned by the mesh.
+    // when clustersCulled is set only visibleRanges are drawn at LOD 0.
+    const MeshletClusters* meshlets{nullptr};
+    std::vector<MeshletIndexRange> visibleRanges;
+    bool clustersCulled{false};
+
     virtual ~DrawBatchContext() = default;
 };
 
+// Simulation state needed to render one frame: camera, lights and the
+// model matrix of every batch context (in batchContexts order). It is
+// captured once the frame has been simulated and only read afterwards, so
+// the next frame can be simulated and captured into another snapshot while
+// this one is rendered.
+struct RenderSnapshot {
+    uint64_t frameNumber{0};    // 0 if nothing has been captured yet
+    uint64_t sceneRevision{0};  // scene the batch contexts were built from
+    // copied by SyncScene(), the canvas may be resized while capturing
+    uint32_t canvasWidth{0};
+    uint32_t canvasHeight{0};
+    PerFrameConstants frameConstants;
+    LightInfo lightInfo;
+    std::vector<Matrix4X4f> modelMatrices;
+};
+
 struct Frame : global_textures {
     int32_t frameIndex{0};
     DrawFrameContext frameContext;
@@ -45,6 +45,7 @@ struct GfxConfiguration {
     static const uint32_t kMaxShadowMapCount{8};
     static const uint32_t kMaxGlobalShadowMapCount{1};
     static const uint32_t kMaxCubeShadowMapCount{2};
+    static const uint32_t kMaxLodCount{8};
 
     static const uint32_t kShadowMapWidth = 512;       // normal shadow map
     static const uint32_t kShadowMapHeight = 512;      // normal shadow map
@@ -59,6 +60,8 @@ struct GfxConfiguration {
 
     bool fixOpenGLPerspectiveMatrix = false;
 
+    float lodPixelError = 1.0f;  ///< max screen space error of mesh LOD in pixels
+
     friend std::ostream& operator<<(std::ostream& out,
                                     const GfxConfiguration& conf) {
         out << "App Name:" << conf.appName << std::endl;
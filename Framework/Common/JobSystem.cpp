@@ -0,0 +1,212 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Profiler.hpp"
+
+using namespace My;
+using namespace std;
+
+JobSystem::JobSystem(int32_t worker_count) {
+    if (worker_count < 0) {
+        const auto hardware_threads =
+            static_cast<int32_t>(thread::hardware_concurrency());
+        worker_count = (hardware_threads > 1) ? hardware_threads - 1 : 0;
+    }
+
+    m_Workers.reserve(worker_count);
+    for (int32_t i = 0; i < worker_count; i++) {
+        m_Workers.emplace_back(&JobSystem::workerMain, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        lock_guard<mutex> lock(m_QueueMutex);
+        m_bStop = true;
+    }
+    m_QueueCondition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+JobSystem::JobHandle JobSystem::CreateJob(function<void()> function) {
+    auto job = make_shared<Job>();
+    job->function = std::move(function);
+    return job;
+}
+
+void JobSystem::AddDependency(const JobHandle& job,
+                              const JobHandle& dependency) {
+    assert(job && dependency);
+    lock_guard<mutex> lock(dependency->lock);
+    if (dependency->finished) return;
+    job->pending++;
+    dependency->dependents.push_back(job);
+}
+
+void JobSystem::Submit(const JobHandle& job) {
+    if (--job->pending == 0) {
+        enqueue(job);
+    }
+}
+
+JobSystem::JobHandle JobSystem::Schedule(
+    function<void()> function, initializer_list<JobHandle> dependencies) {
+    auto job = CreateJob(std::move(function));
+    for (const auto& dependency : dependencies) {
+        AddDependency(job, dependency);
+    }
+    Submit(job);
+    return job;
+}
+
+JobSystem::JobHandle JobSystem::ScheduleBackground(function<void()> function) {
+    auto job = CreateJob(std::move(function));
+    job->background = true;
+    Submit(job);
+    return job;
+}
+
+JobSystem::JobHandle JobSystem::ScheduleParallelFor(
+    size_t begin, size_t end, size_t grain_size, RangeFunction function,
+    initializer_list<JobHandle> dependencies) {
+    grain_size = max<size_t>(grain_size, 1);
+
+    // the chunks share one copy of the function
+    auto shared_function = make_shared<RangeFunction>(std::move(function));
+
+    auto join = CreateJob([] {});
+    vector<JobHandle> chunks;
+    chunks.reserve((end > begin) ? (end - begin + grain_size - 1) / grain_size
+                                 : 0);
+
+    for (size_t chunk_begin = begin; chunk_begin < end;
+         chunk_begin += grain_size) {
+        const size_t chunk_end = min(chunk_begin + grain_size, end);
+        auto chunk = CreateJob([shared_function, chunk_begin, chunk_end] {
+            (*shared_function)(chunk_begin, chunk_end);
+        });
+        for (const auto& dependency : dependencies) {
+            AddDependency(chunk, dependency);
+        }
+        AddDependency(join, chunk);
+        chunks.push_back(std::move(chunk));
+    }
+
+    if (chunks.empty()) {
+        for (const auto& dependency : dependencies) {
+            AddDependency(join, dependency);
+        }
+    }
+
+    for (const auto& chunk : chunks) {
+        Submit(chunk);
+    }
+    Submit(join);
+
+    return join;
+}
+
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain_size,
+                            RangeFunction function) {
+    // nothing to split, skip the queue
+    if (end <= begin) return;
+    if (end - begin <= grain_size) {
+        function(begin, end);
+        return;
+    }
+
+    Wait(ScheduleParallelFor(begin, end, grain_size, std::move(function)));
+}
+
+void JobSystem::Wait(const JobHandle& job) {
+    while (!job->finished) {
+        JobHandle next;
+        {
+            unique_lock<mutex> lock(m_QueueMutex);
+            auto background = m_BackgroundQueue.end();
+            m_QueueCondition.wait(lock, [this, &job, &background] {
+                if (job->background) {
+                    background = find(m_BackgroundQueue.begin(),
+                                      m_BackgroundQueue.end(), job);
+                }
+                return !m_Queue.empty() || job->finished ||
+                       background != m_BackgroundQueue.end();
+            });
+            if (job->finished) break;
+            if (!m_Queue.empty()) {
+                next = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            } else {
+                next = std::move(*background);
+                m_BackgroundQueue.erase(background);
+            }
+        }
+        execute(next);
+    }
+}
+
+void JobSystem::enqueue(const JobHandle& job) {
+    {
+        lock_guard<mutex> lock(m_QueueMutex);
+        if (job->background) {
+            m_BackgroundQueue.push_back(job);
+        } else {
+            m_Queue.push_back(job);
+        }
+    }
+    // a thread waiting for a background job must see it queued
+    if (job->background) {
+        m_QueueCondition.notify_all();
+    } else {
+        m_QueueCondition.notify_one();
+    }
+}
+
+void JobSystem::execute(const JobHandle& job) {
+    if (job->function) {
+        job->function();
+    }
+
+    vector<JobHandle> dependents;
+    {
+        lock_guard<mutex> lock(job->lock);
+        job->finished = true;
+        dependents.swap(job->dependents);
+    }
+
+    for (const auto& dependent : dependents) {
+        Submit(dependent);
+    }
+
+    // wake up the threads waiting on this job. Take the queue lock so that
+    // a waiter cannot miss the notification between its check and its wait
+    {
+        lock_guard<mutex> lock(m_QueueMutex);
+    }
+    m_QueueCondition.notify_all();
+}
+
+void JobSystem::workerMain() {
+    Profiler::SetThreadName("JobSystemWorker");
+    while (true) {
+        JobHandle job;
+        {
+            unique_lock<mutex> lock(m_QueueMutex);
+            m_QueueCondition.wait(lock, [this] {
+                return m_bStop || !m_Queue.empty() ||
+                       !m_BackgroundQueue.empty();
+            });
+            if (m_bStop && m_Queue.empty() && m_BackgroundQueue.empty())
+                return;
+            auto& queue = m_Queue.empty() ? m_BackgroundQueue : m_Queue;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        execute(job);
+    }
+}
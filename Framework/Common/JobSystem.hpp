@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace My {
+// Fixed size worker pool running a graph of small jobs.
+// A job becomes runnable once it has been submitted and all the jobs it
+// depends on have finished. Threads waiting for a job help executing queued
+// jobs, so waiting from inside a job does not dead lock and a pool with no
+// worker thread runs everything on the waiting thread. Background jobs are
+// only helped with by the threads waiting for them, so that a long job is not
+// run inline by a thread waiting for a short one.
+class JobSystem {
+   public:
+    struct Job {
+        std::function<void()> function;
+        // unfinished dependencies, plus one until the job is submitted
+        std::atomic<int32_t> pending{1};
+        std::atomic<bool> finished{false};
+        bool background{false};
+        std::mutex lock;
+        std::vector<std::shared_ptr<Job>> dependents;
+    };
+
+    using JobHandle = std::shared_ptr<Job>;
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+    // a negative worker_count means one worker per hardware thread besides
+    // the calling one, 0 runs every job on the thread waiting for it
+    explicit JobSystem(int32_t worker_count = -1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    [[nodiscard]] uint32_t GetWorkerCount() const {
+        return static_cast<uint32_t>(m_Workers.size());
+    }
+
+    // build the graph: create jobs, wire dependencies, then submit them
+    JobHandle CreateJob(std::function<void()> function);
+    // must be called before job is submitted
+    void AddDependency(const JobHandle& job, const JobHandle& dependency);
+    void Submit(const JobHandle& job);
+
+    // create and submit a job in one go
+    JobHandle Schedule(std::function<void()> function,
+                       std::initializer_list<JobHandle> dependencies = {});
+
+    // create and submit a background job, picked up by the workers or by
+    // Wait() on the job itself
+    JobHandle ScheduleBackground(std::function<void()> function);
+
+    // split [begin, end) into chunks of at most grain_size elements, one job
+    // each. The returned handle finishes when every chunk has finished.
+    JobHandle ScheduleParallelFor(
+        size_t begin, size_t end, size_t grain_size, RangeFunction function,
+        std::initializer_list<JobHandle> dependencies = {});
+
+    // blocking version of ScheduleParallelFor
+    void ParallelFor(size_t begin, size_t end, size_t grain_size,
+                     RangeFunction function);
+
+    // run queued jobs on the calling thread until job has finished, and job
+    // itself if it is a queued background job
+    void Wait(const JobHandle& job);
+
+   private:
+    void enqueue(const JobHandle& job);
+    void execute(const JobHandle& job);
+    void workerMain();
+
+   private:
+    std::vector<std::thread> m_Workers;
+    std::deque<JobHandle> m_Queue;
+    std::deque<JobHandle> m_BackgroundQueue;
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueCondition;
+    bool m_bStop{false};
+};
+}  // namespace My
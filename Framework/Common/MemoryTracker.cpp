@@ -0,0 +1,179 @@
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+using namespace My;
+using namespace std;
+
+namespace {
+// written by the thread owning them only, hence the load and store instead
+// of a fetch_add
+struct TagCounters {
+    atomic<int64_t> allocated{0};
+    atomic<int64_t> freed{0};
+    atomic<int64_t> allocations{0};
+    atomic<int64_t> frees{0};
+    // allocated - freed at its highest since NextFrame() reset it
+    atomic<int64_t> high{0};
+};
+
+struct alignas(64) ThreadCounters {
+    TagCounters tags[kMemoryTagCount];
+};
+
+inline void add(atomic<int64_t>& counter, int64_t value) {
+    counter.store(counter.load(memory_order_relaxed) + value,
+                  memory_order_relaxed);
+}
+
+struct Registry {
+    mutex lock;
+    // one per thread which ever allocated, they are not reused as what a
+    // thread allocated may be freed by another one
+    deque<ThreadCounters> threads;
+
+    // main loop thread only
+    // allocated - freed of each thread when its high was last reset
+    vector<array<int64_t, kMemoryTagCount>> baselines;
+    MemoryTagStats stats[kMemoryTagCount];
+};
+
+// never destroyed, memory may still be freed by static destructors
+Registry& registry() {
+    static auto* instance = new Registry;
+    return *instance;
+}
+
+thread_local ThreadCounters* t_pCounters = nullptr;
+thread_local MemoryTag t_CurrentTag = MemoryTag::kUntagged;
+
+TagCounters& counters(MemoryTag tag) {
+    if (!t_pCounters) {
+        auto& r = registry();
+        lock_guard<mutex> lock(r.lock);
+        t_pCounters = &r.threads.emplace_back();
+    }
+    return t_pCounters->tags[static_cast<size_t>(tag)];
+}
+}  // namespace
+
+const char* My::GetMemoryTagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::kUntagged:
+            return "Untagged";
+        case MemoryTag::kTextures:
+            return "Textures";
+        case MemoryTag::kMeshes:
+            return "Meshes";
+        case MemoryTag::kSceneGraph:
+            return "SceneGraph";
+        case MemoryTag::kAnimation:
+            return "Animation";
+        case MemoryTag::kPhysics:
+            return "Physics";
+        case MemoryTag::kAudio:
+            return "Audio";
+        case MemoryTag::kParsers:
+            return "Parsers";
+        case MemoryTag::kCount:
+            break;
+    }
+    return "Unknown";
+}
+
+void MemoryTracker::RecordAllocation(MemoryTag tag, size_t size) {
+    auto& c = counters(tag);
+    const auto allocated =
+        c.allocated.load(memory_order_relaxed) + static_cast<int64_t>(size);
+    c.allocated.store(allocated, memory_order_relaxed);
+    add(c.allocations, 1);
+
+    const auto live = allocated - c.freed.load(memory_order_relaxed);
+    if (live > c.high.load(memory_order_relaxed)) {
+        c.high.store(live, memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::RecordFree(MemoryTag tag, size_t size) {
+    auto& c = counters(tag);
+    add(c.freed, static_cast<int64_t>(size));
+    add(c.frees, 1);
+}
+
+void MemoryTracker::NextFrame() {
+    auto& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    r.baselines.resize(r.threads.size(), {});
+
+    for (size_t t = 0; t < kMemoryTagCount; t++) {
+        int64_t bytes = 0, count = 0, allocations = 0, rise = 0;
+        for (size_t i = 0; i < r.threads.size(); i++) {
+            auto& c = r.threads[i].tags[t];
+            const auto allocated = c.allocated.load(memory_order_relaxed);
+            const auto freed = c.freed.load(memory_order_relaxed);
+            const auto thread_allocations =
+                c.allocations.load(memory_order_relaxed);
+            bytes += allocated - freed;
+            count += thread_allocations - c.frees.load(memory_order_relaxed);
+            allocations += thread_allocations;
+
+            // how far above where it started the frame this thread went
+            auto& baseline = r.baselines[i][t];
+            rise += max<int64_t>(
+                c.high.exchange(allocated - freed, memory_order_relaxed) -
+                    baseline,
+                0);
+            baseline = allocated - freed;
+        }
+
+        auto& stats = r.stats[t];
+        stats.frameHighWater = max(bytes, stats.bytes + rise);
+        stats.peakBytes = max(stats.peakBytes, stats.frameHighWater);
+        stats.bytes = bytes;
+        stats.count = count;
+        stats.allocationCount = static_cast<uint64_t>(allocations);
+    }
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag) {
+    return registry().stats[static_cast<size_t>(tag)];
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, size_t bytes) {
+    registry().stats[static_cast<size_t>(tag)].budget = bytes;
+}
+
+bool MemoryTracker::IsOverBudget(MemoryTag tag) {
+    const auto& stats = registry().stats[static_cast<size_t>(tag)];
+    return stats.budget &&
+           stats.frameHighWater > static_cast<int64_t>(stats.budget);
+}
+
+void MemoryTracker::Report(std::ostream& out) {
+    out << left << setw(12) << "Tag" << right << setw(14) << "Bytes"
+        << setw(10) << "Count" << setw(14) << "Frame High" << setw(14)
+        << "Peak" << setw(14) << "Budget" << endl;
+    for (size_t t = 0; t < kMemoryTagCount; t++) {
+        const auto tag = static_cast<MemoryTag>(t);
+        const auto stats = GetStats(tag);
+        out << left << setw(12) << GetMemoryTagName(tag) << right << setw(14)
+            << stats.bytes << setw(10) << stats.count << setw(14)
+            << stats.frameHighWater << setw(14) << stats.peakBytes
+            << setw(14) << stats.budget << (IsOverBudget(tag) ? " !" : "")
+            << endl;
+    }
+}
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) : m_PreviousTag(t_CurrentTag) {
+    t_CurrentTag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope() { t_CurrentTag = m_PreviousTag; }
+
+MemoryTag MemoryTagScope::GetCurrentTag() { return t_CurrentTag; }
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <utility>
+
+namespace My {
+// what the memory is for, the unit budgets are set in
+enum class MemoryTag : uint8_t {
+    kUntagged,
+    kTextures,
+    kMeshes,
+    kSceneGraph,
+    kAnimation,
+    kPhysics,
+    kAudio,
+    kParsers,
+    kCount
+};
+
+constexpr size_t kMemoryTagCount = static_cast<size_t>(MemoryTag::kCount);
+
+const char* GetMemoryTagName(MemoryTag tag);
+
+struct MemoryTagStats {
+    // live at the end of the last frame
+    int64_t bytes{0};
+    int64_t count{0};
+    // since the start
+    uint64_t allocationCount{0};
+    // the most live during the last frame, and during any frame
+    int64_t frameHighWater{0};
+    int64_t peakBytes{0};
+    // 0 for none
+    size_t budget{0};
+};
+
+// Bytes and allocations of each tag. Every thread counts into counters of
+// its own, which only it writes, so recording an allocation takes neither a
+// lock nor an atomic read-modify-write; NextFrame() adds them up once a
+// frame.
+//
+// The high water mark of a frame sums what each thread had at its highest,
+// which is exact when one thread allocates the tag during the frame and an
+// upper bound otherwise.
+class MemoryTracker {
+   public:
+    static void RecordAllocation(MemoryTag tag, size_t size);
+    static void RecordFree(MemoryTag tag, size_t size);
+
+    // Everything below is for the main loop thread only.
+
+    static void NextFrame();
+    [[nodiscard]] static MemoryTagStats GetStats(MemoryTag tag);
+
+    // the high water mark of the last frame is compared against it
+    static void SetBudget(MemoryTag tag, size_t bytes);
+    [[nodiscard]] static bool IsOverBudget(MemoryTag tag);
+
+    // one line per tag
+    static void Report(std::ostream& out);
+};
+
+// Memory without a tag of its own, a Buffer for one, is counted under the
+// tag of the innermost scope alive on the thread allocating it.
+class MemoryTagScope {
+   public:
+    explicit MemoryTagScope(MemoryTag tag);
+    ~MemoryTagScope();
+
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+    [[nodiscard]] static MemoryTag GetCurrentTag();
+
+   private:
+    MemoryTag m_PreviousTag;
+};
+
+// std allocator counting what it allocates under its tag
+template <typename T>
+class TaggedAllocator {
+   public:
+    using value_type = T;
+
+    explicit TaggedAllocator(MemoryTag tag) : m_Tag(tag) {}
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other) : m_Tag(other.GetTag()) {}
+
+    T* allocate(size_t n) {
+        MemoryTracker::RecordAllocation(m_Tag, n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        MemoryTracker::RecordFree(m_Tag, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    [[nodiscard]] MemoryTag GetTag() const { return m_Tag; }
+
+    template <typename U>
+    bool operator==(const TaggedAllocator<U>& other) const {
+        return m_Tag == other.GetTag();
+    }
+
+   private:
+    MemoryTag m_Tag;
+};
+
+// make_shared, the object and its control block counted under tag
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeTaggedShared(MemoryTag tag, Args&&... args) {
+    return std::allocate_shared<T>(TaggedAllocator<T>(tag),
+                                   std::forward<Args>(args)...);
+}
+}  // namespace My
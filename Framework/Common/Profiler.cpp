@@ -0,0 +1,232 @@
+#include "Profiler.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include "RingBuffer.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t index)
+        : zones(Profiler::kThreadBufferZones), index(index) {}
+
+    // written by the thread owning it, read by NextFrame()
+    RingBuffer<ProfileZone> zones;
+    atomic<uint64_t> dropped{0};
+    const uint32_t index;
+
+    // the rest under Registry::lock
+    bool owned{true};
+    string name;
+};
+
+struct Registry {
+    mutex lock;
+    // never shrinks, the buffer of a thread which exited goes to the next
+    // thread to record a zone
+    vector<unique_ptr<ThreadBuffer>> buffers;
+
+    // main loop thread only
+    deque<ProfileFrame> frames;
+    uint64_t frameNumber{0};
+    uint64_t frameBegin{0};
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+const chrono::steady_clock::time_point& start_time() {
+    static const auto instance = chrono::steady_clock::now();
+    return instance;
+}
+
+// a buffer is only taken once a thread closes its first zone, naming a
+// thread costs nothing while profiling is disabled
+struct ThreadSlot {
+    ThreadBuffer* buffer{nullptr};
+    uint32_t depth{0};
+    string name;
+
+    ~ThreadSlot() {
+        if (buffer) {
+            lock_guard<mutex> lock(registry().lock);
+            buffer->owned = false;
+        }
+    }
+};
+
+thread_local ThreadSlot t_Slot;
+
+ThreadBuffer* thread_buffer() {
+    if (t_Slot.buffer) return t_Slot.buffer;
+
+    auto& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    for (auto& buffer : r.buffers) {
+        if (!buffer->owned) {
+            buffer->owned = true;
+            t_Slot.buffer = buffer.get();
+            break;
+        }
+    }
+    if (!t_Slot.buffer) {
+        r.buffers.push_back(make_unique<ThreadBuffer>(
+            static_cast<uint32_t>(r.buffers.size())));
+        t_Slot.buffer = r.buffers.back().get();
+    }
+    t_Slot.buffer->name = t_Slot.name;
+    return t_Slot.buffer;
+}
+
+void write_string(ostream& out, const char* value) {
+    out << '"';
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) >= 0x20) {
+            out << *c;
+        }
+    }
+    out << '"';
+}
+
+// microseconds, exactly
+void write_time(ostream& out, uint64_t nanoseconds) {
+    const auto fraction = nanoseconds % 1000;
+    out << nanoseconds / 1000 << '.' << fraction / 100 << fraction / 10 % 10
+        << fraction % 10;
+}
+
+// the frames get a track of their own above the threads
+constexpr uint32_t kFrameTrack = 0;
+
+void write_complete_event(ostream& out, const char* name, uint32_t track,
+                          uint64_t begin, uint64_t end) {
+    out << "{\"name\":";
+    write_string(out, name);
+    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track << ",\"ts\":";
+    write_time(out, begin);
+    out << ",\"dur\":";
+    write_time(out, end - begin);
+    out << '}';
+}
+
+void write_track_name(ostream& out, uint32_t track, const string& name) {
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << track << ",\"args\":{\"name\":";
+    write_string(out, name.c_str());
+    out << "}}";
+}
+}  // namespace
+
+void Profiler::SetThreadName(const char* name) {
+    t_Slot.name = name;
+    if (t_Slot.buffer) {
+        lock_guard<mutex> lock(registry().lock);
+        t_Slot.buffer->name = name;
+    }
+}
+
+std::string Profiler::GetThreadName(uint32_t thread) {
+    auto& r = registry();
+    {
+        lock_guard<mutex> lock(r.lock);
+        if (thread < r.buffers.size() && !r.buffers[thread]->name.empty()) {
+            return r.buffers[thread]->name;
+        }
+    }
+    return "Thread " + to_string(thread);
+}
+
+uint64_t Profiler::Now() {
+    return static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start_time())
+            .count());
+}
+
+uint64_t Profiler::BeginZone() {
+    t_Slot.depth++;
+    return Now();
+}
+
+void Profiler::EndZone(const char* name, uint64_t begin) {
+    const auto end = Now();
+    auto* buffer = thread_buffer();
+    const ProfileZone zone{name, begin, end, buffer->index, --t_Slot.depth};
+    if (!buffer->zones.Write(&zone, 1)) {
+        buffer->dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Profiler::NextFrame() {
+    auto& r = registry();
+    ProfileFrame frame;
+    frame.number = r.frameNumber++;
+    frame.begin = r.frameBegin;
+    frame.end = Now();
+    r.frameBegin = frame.end;
+
+    {
+        lock_guard<mutex> lock(r.lock);
+        ProfileZone zones[256];
+        for (auto& buffer : r.buffers) {
+            while (const auto count = buffer->zones.Read(zones, 256)) {
+                frame.zones.insert(frame.zones.end(), zones, zones + count);
+            }
+            frame.droppedCount +=
+                buffer->dropped.exchange(0, memory_order_relaxed);
+        }
+    }
+
+    // nothing to show for the frames profiling was disabled
+    if (!IsEnabled() && frame.zones.empty()) return;
+
+    r.frames.push_back(std::move(frame));
+    if (r.frames.size() > kFrameHistory) r.frames.pop_front();
+}
+
+const std::deque<ProfileFrame>& Profiler::GetFrames() {
+    return registry().frames;
+}
+
+void Profiler::ClearFrames() { registry().frames.clear(); }
+
+void Profiler::WriteChromeTrace(std::ostream& out) {
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&out, &first] {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    set<uint32_t> threads;
+    for (const auto& frame : GetFrames()) {
+        const auto name = "Frame " + to_string(frame.number);
+        separate();
+        write_complete_event(out, name.c_str(), kFrameTrack, frame.begin,
+                             frame.end);
+        for (const auto& zone : frame.zones) {
+            separate();
+            write_complete_event(out, zone.name, zone.thread + 1, zone.begin,
+                                 zone.end);
+            threads.insert(zone.thread);
+        }
+    }
+
+    separate();
+    write_track_name(out, kFrameTrack, "Frames");
+    for (const auto thread : threads) {
+        separate();
+        write_track_name(out, thread + 1, GetThreadName(thread));
+    }
+
+    out << "],\n\"displayTimeUnit\":\"ms\"}\n";
+}
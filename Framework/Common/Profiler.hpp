@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace My {
+// a timed scope, times are nanoseconds since the profiler started
+struct ProfileZone {
+    // a string literal, only the pointer is kept
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    // index of the thread, see Profiler::GetThreadName()
+    uint32_t thread;
+    // number of zones open around it on its thread
+    uint32_t depth;
+};
+
+struct ProfileFrame {
+    uint64_t number{0};
+    uint64_t begin{0};
+    uint64_t end{0};
+    // in the order they were closed, across all threads
+    std::vector<ProfileZone> zones;
+    // lost because a thread's buffer was full
+    uint64_t droppedCount{0};
+};
+
+// CPU timeline of the engine. PROFILE_SCOPE() zones are written by the
+// thread closing them into a ring buffer of its own, without locks; the
+// main loop calls NextFrame() once a frame to gather them.
+//
+// Disabled, the default, a zone costs one branch on a flag when opened and
+// one on a local when closed. The zone covers the rest of its scope, so its
+// destructor has to know whether it was opened; both branches always go the
+// same way while the profiler stays disabled.
+class Profiler {
+   public:
+    [[nodiscard]] static bool IsEnabled() {
+        return m_bEnabled.load(std::memory_order_relaxed);
+    }
+    static void SetEnabled(bool enable) {
+        m_bEnabled.store(enable, std::memory_order_relaxed);
+    }
+
+    // shown in the timeline and the trace instead of "Thread <index>"
+    static void SetThreadName(const char* name);
+    [[nodiscard]] static std::string GetThreadName(uint32_t thread);
+
+    [[nodiscard]] static uint64_t Now();
+
+    // used by ProfileScope
+    static uint64_t BeginZone();
+    static void EndZone(const char* name, uint64_t begin);
+
+    // Everything below is for the main loop thread only.
+
+    // closes the current frame with the zones closed since the last call.
+    // The most recent kFrameHistory frames are kept.
+    static void NextFrame();
+    [[nodiscard]] static const std::deque<ProfileFrame>& GetFrames();
+    static void ClearFrames();
+
+    // the kept frames in the Trace Event Format of chrome://tracing and
+    // Perfetto
+    static void WriteChromeTrace(std::ostream& out);
+
+    static constexpr size_t kFrameHistory = 300;
+    // per thread and frame, the rest are dropped
+    static constexpr size_t kThreadBufferZones = 16384;
+
+   private:
+    static inline std::atomic<bool> m_bEnabled{false};
+};
+
+// the flag is read once, the destructor only tests m_szName
+class ProfileScope {
+   public:
+    explicit ProfileScope(const char* name) {
+        if (Profiler::IsEnabled()) {
+            m_szName = name;
+            m_nBegin = Profiler::BeginZone();
+        }
+    }
+    ~ProfileScope() {
+        if (m_szName) Profiler::EndZone(m_szName, m_nBegin);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+   private:
+    const char* m_szName{nullptr};
+    uint64_t m_nBegin{0};
+};
+}  // namespace My
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// times the rest of the enclosing scope. Only the pointer to name is kept,
+// it has to outlive the profiler: a string literal.
+#define PROFILE_SCOPE(name) \
+    My::ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
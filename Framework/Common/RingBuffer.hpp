@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace My {
+// Fixed size queue between exactly one producer thread and one consumer
+// thread. Neither side ever blocks or takes a lock: each owns one index and
+// only reads the other's, so Write() and Read() move as many elements as
+// there are room for or available and return how many that was.
+template <typename T>
+class RingBuffer {
+   public:
+    // rounded up to a power of two
+    explicit RingBuffer(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        m_Data.resize(size);
+        m_nMask = size - 1;
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    [[nodiscard]] size_t GetCapacity() const { return m_Data.size(); }
+
+    // by the consumer, at least this many can be read
+    [[nodiscard]] size_t GetReadAvailable() const {
+        return m_nWrite.load(std::memory_order_acquire) -
+               m_nRead.load(std::memory_order_relaxed);
+    }
+
+    // by the producer, at least this many can be written
+    [[nodiscard]] size_t GetWriteAvailable() const {
+        return m_Data.size() - (m_nWrite.load(std::memory_order_relaxed) -
+                                m_nRead.load(std::memory_order_acquire));
+    }
+
+    // producer only
+    size_t Write(const T* data, size_t count) {
+        const size_t write = m_nWrite.load(std::memory_order_relaxed);
+        const size_t read = m_nRead.load(std::memory_order_acquire);
+        count = std::min(count, m_Data.size() - (write - read));
+
+        // in at most two pieces, up to the end and from the front
+        const size_t begin = write & m_nMask;
+        const size_t first = std::min(count, m_Data.size() - begin);
+        std::copy_n(data, first, m_Data.data() + begin);
+        if (count > first) {
+            std::copy_n(data + first, count - first, m_Data.data());
+        }
+
+        m_nWrite.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // consumer only
+    size_t Read(T* data, size_t count) {
+        const size_t read = m_nRead.load(std::memory_order_relaxed);
+        const size_t write = m_nWrite.load(std::memory_order_acquire);
+        count = std::min(count, write - read);
+
+        const size_t begin = read & m_nMask;
+        const size_t first = std::min(count, m_Data.size() - begin);
+        std::copy_n(m_Data.data() + begin, first, data);
+        if (count > first) {
+            std::copy_n(m_Data.data(), count - first, data + first);
+        }
+
+        m_nRead.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+   private:
+    std::vector<T> m_Data;
+    size_t m_nMask{0};
+    // monotonic, the elements in the buffer are [m_nRead, m_nWrite). Apart
+    // so the two threads do not share a cache line.
+    alignas(64) std::atomic<size_t> m_nWrite{0};
+    alignas(64) std::atomic<size_t> m_nRead{0};
+};
+}  // namespace My
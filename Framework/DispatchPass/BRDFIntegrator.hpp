@@ -5,6 +5,9 @@ namespace My {
 class BRDFIntegrator : public BaseDispatchPass {
    public:
     using BaseDispatchPass::BaseDispatchPass;
+    [[nodiscard]] const char* GetName() const override {
+        return "BRDFIntegrator";
+    }
     void Dispatch(Frame& frame) final;
 };
 }  // namespace My
\ No newline at end of file
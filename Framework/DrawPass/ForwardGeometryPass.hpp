@@ -20,5 +20,9 @@ class ForwardGeometryPass : public BaseDrawPass {
 #endif
         m_bClearRT = true;
     }
+
+    [[nodiscard]] const char* GetName() const override {
+        return "ForwardGeometryPass";
+    }
 };
 }  // namespace My
@@ -14,5 +14,9 @@ class OverlayPass : public BaseDrawPass {
         m_DrawSubPasses.push_back(std::make_shared<GuiSubPass>(
             m_pGraphicsManager, m_pPipelineStateManager));
     }
+
+    [[nodiscard]] const char* GetName() const override {
+        return "OverlayPass";
+    }
 };
 }  // namespace My
@@ -7,6 +7,10 @@ class ShadowMapPass : public BaseDrawPass {
     using BaseDrawPass::BaseDrawPass;
     ~ShadowMapPass() override = default;
 
+    [[nodiscard]] const char* GetName() const override {
+        return "ShadowMapPass";
+    }
+
     void BeginPass(Frame& frame) override {}
     void Draw(Frame& frame) final;
     void EndPass(Frame& frame) override {}
@@ -1,7 +1,14 @@
 #include "GuiSubPass.hpp"
 #include "imgui/imgui.h"
 
+#include <algorithm>
 #include <deque>
+#include <fstream>
+#include <map>
+#include <string_view>
+
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
 
 using namespace My;
 
@@ -41,11 +48,111 @@ static void TexturePreviewer(const TextureBase& texture, ImVec2 size = {64, 64},
     }
 }
 
+// one row per nesting level of each thread, across the whole frame
+static void ProfilerTimeline(const ProfileFrame& profile) {
+    constexpr float row_height = 18.0f;
+    const auto duration =
+        static_cast<float>(std::max<uint64_t>(profile.end - profile.begin, 1));
+
+    std::map<uint32_t, uint32_t> levels;
+    for (const auto& zone : profile.zones) {
+        levels[zone.thread] = std::max(levels[zone.thread], zone.depth + 1);
+    }
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    const float width = ImGui::GetContentRegionAvail().x;
+    for (const auto& [thread, level_count] : levels) {
+        ImGui::Text("%s", Profiler::GetThreadName(thread).c_str());
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(ImVec2(width, level_count * row_height));
+
+        for (const auto& zone : profile.zones) {
+            if (zone.thread != thread) continue;
+            // zones of work started in an earlier frame are cut at its begin
+            auto x = [&](uint64_t time) {
+                const auto offset = static_cast<float>(
+                    std::max(time, profile.begin) - profile.begin);
+                return origin.x + width * std::min(offset / duration, 1.0f);
+            };
+            const ImVec2 min(x(zone.begin), origin.y + zone.depth * row_height);
+            const ImVec2 max(std::max(x(zone.end), min.x + 1.0f),
+                             min.y + row_height - 1.0f);
+            const float hue = static_cast<float>(
+                std::hash<std::string_view>()(zone.name) % 64) / 64.0f;
+            draw_list->AddRectFilled(min, max,
+                                     ImColor::HSV(hue, 0.5f, 0.7f));
+            draw_list->PushClipRect(min, max, true);
+            draw_list->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f),
+                               IM_COL32_WHITE, zone.name);
+            draw_list->PopClipRect();
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s: %.3f ms", zone.name,
+                                  (zone.end - zone.begin) / 1e6);
+            }
+        }
+    }
+}
+
+// one row per tag, the budget editable in MB
+static void MemoryTrackerTable() {
+    constexpr float kMB = 1024.0f * 1024.0f;
+    if (!ImGui::BeginTable("memory", 6, ImGuiTableFlags_Borders)) return;
+
+    ImGui::TableSetupColumn((const char*)u8"标签");
+    ImGui::TableSetupColumn((const char*)u8"当前 (MB)");
+    ImGui::TableSetupColumn((const char*)u8"分配数");
+    ImGui::TableSetupColumn((const char*)u8"帧峰值 (MB)");
+    ImGui::TableSetupColumn((const char*)u8"历史峰值 (MB)");
+    ImGui::TableSetupColumn((const char*)u8"预算 (MB)");
+    ImGui::TableHeadersRow();
+
+    for (size_t i = 0; i < kMemoryTagCount; i++) {
+        const auto tag = static_cast<MemoryTag>(i);
+        const auto stats = MemoryTracker::GetStats(tag);
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", GetMemoryTagName(tag));
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", stats.bytes / kMB);
+        ImGui::TableNextColumn();
+        ImGui::Text("%lld", (long long)stats.count);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", stats.frameHighWater / kMB);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", stats.peakBytes / kMB);
+        ImGui::TableNextColumn();
+
+        ImGui::PushID(static_cast<int>(i));
+        int budget = static_cast<int>(stats.budget / (1024 * 1024));
+        ImGui::SetNextItemWidth(80.0f);
+        if (ImGui::InputInt("##budget", &budget, 0)) {
+            MemoryTracker::SetBudget(
+                tag, static_cast<size_t>(std::max(budget, 0)) * 1024 * 1024);
+        }
+        if (stats.budget) {
+            ImGui::SameLine();
+            const float used = stats.frameHighWater / (stats.budget * 1.0f);
+            if (used > 1.0f) {
+                ImGui::PushStyleColor(ImGuiCol_PlotHistogram,
+                                      ImVec4(0.9f, 0.2f, 0.2f, 1.0f));
+            }
+            ImGui::ProgressBar(std::min(used, 1.0f), ImVec2(-1.0f, 0.0f));
+            if (used > 1.0f) ImGui::PopStyleColor();
+        }
+        ImGui::PopID();
+    }
+
+    ImGui::EndTable();
+}
+
 void GuiSubPass::Draw(Frame& frame) {
     if (ImGui::GetCurrentContext()) {
 	    static bool show_app_metrics = false;
 	    static bool show_app_debug_panel = true;
 	    static bool show_app_about = false;
+        static bool show_app_profiler = false;
+        static bool show_app_memory = false;
         size_t texture_view_index = 0;
 
         ImGui::DockSpaceOverViewport(ImGui::GetMainViewport());
@@ -85,6 +192,8 @@ void GuiSubPass::Draw(Frame& frame) {
             {
 			    ImGui::MenuItem((const char*)u8"调试窗口", NULL, &show_app_debug_panel);
 			    ImGui::MenuItem((const char*)u8"ImGui状态及调试窗口", NULL, &show_app_metrics);
+                ImGui::MenuItem((const char*)u8"性能分析", NULL, &show_app_profiler);
+                ImGui::MenuItem((const char*)u8"内存", NULL, &show_app_memory);
                 ImGui::EndMenu();
             }
             if (ImGui::BeginMenu((const char*)u8"帮助"))
@@ -95,6 +204,49 @@ void GuiSubPass::Draw(Frame& frame) {
             ImGui::EndMainMenuBar();
         }
 
+        if (show_app_profiler) {
+            static bool paused = false;
+            static ProfileFrame shown;
+
+            ImGui::Begin((const char*)u8"性能分析", &show_app_profiler);
+
+            bool enabled = Profiler::IsEnabled();
+            if (ImGui::Checkbox((const char*)u8"启用", &enabled)) {
+                Profiler::SetEnabled(enabled);
+            }
+            ImGui::SameLine();
+            ImGui::Checkbox((const char*)u8"暂停", &paused);
+            ImGui::SameLine();
+            if (ImGui::Button((const char*)u8"导出 Chrome Trace")) {
+                std::ofstream trace("profile.json");
+                Profiler::WriteChromeTrace(trace);
+            }
+
+            const auto& frames = Profiler::GetFrames();
+            if (!paused && !frames.empty()) shown = frames.back();
+
+            auto getFrameTime = [](void* data, int index) -> float {
+                const auto& profile = ((decltype(&frames))data)->at(index);
+                return (profile.end - profile.begin) / 1e6f;
+            };
+            ImGui::PlotLines((const char*)u8"帧时间", getFrameTime,
+                             (void*)&frames, frames.size(), 0, "ms", 0.0f);
+
+            ImGui::Text((const char*)u8"第 %llu 帧 %.3f 毫秒, 丢弃 %llu 个区段",
+                        (unsigned long long)shown.number,
+                        (shown.end - shown.begin) / 1e6,
+                        (unsigned long long)shown.droppedCount);
+            ProfilerTimeline(shown);
+
+            ImGui::End();
+        }
+
+        if (show_app_memory) {
+            ImGui::Begin((const char*)u8"内存", &show_app_memory);
+            MemoryTrackerTable();
+            ImGui::End();
+        }
+
         if (show_app_debug_panel) {
             static std::deque<float> fps_data;
 
@@ -1181,6 +1181,109 @@ inline void MatrixRotationQuaternion(Matrix4X4f& matrix, Quaternion<T> q) {
     matrix = rotation;
 }
 
+// the inverse of MatrixRotationQuaternion() for the 3x3 rotation m, from the
+// largest of w, x, y and z for precision
+template <class T>
+inline void QuaternionRotationMatrix(Quaternion<T>& q, const Matrix3X3f& m) {
+    const T trace = m[0][0] + m[1][1] + m[2][2];
+    if (trace > 0) {
+        const T s = std::sqrt(trace + 1) * 2;
+        q = {(m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s,
+             (m[0][1] - m[1][0]) / s, s / 4};
+    } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+        const T s = std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]) * 2;
+        q = {s / 4, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s,
+             (m[1][2] - m[2][1]) / s};
+    } else if (m[1][1] > m[2][2]) {
+        const T s = std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]) * 2;
+        q = {(m[0][1] + m[1][0]) / s, s / 4, (m[1][2] + m[2][1]) / s,
+             (m[2][0] - m[0][2]) / s};
+    } else {
+        const T s = std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]) * 2;
+        q = {(m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, s / 4,
+             (m[0][1] - m[1][0]) / s};
+    }
+}
+
+// rotation of angle radians around the unit axis, the same rotation as
+// MatrixRotationAxis()
+inline void QuaternionRotationAxis(Quaternion<float>& q, const Vector3f& axis,
+                                   const float angle) {
+    const float s = std::sin(angle * 0.5f);
+    q = {axis[0] * s, axis[1] * s, axis[2] * s, std::cos(angle * 0.5f)};
+}
+
+inline Quaternion<float> QuaternionRotationAxis(const Vector3f& axis,
+                                                const float angle) {
+    Quaternion<float> q;
+    QuaternionRotationAxis(q, axis, angle);
+    return q;
+}
+
+// normalized linear blend from a to b. q and -q are the same rotation, so
+// it goes the shorter way round.
+template <class T>
+inline Quaternion<T> Nlerp(const Quaternion<T>& a, const Quaternion<T>& b,
+                           const T s) {
+    T dot;
+    DotProduct(dot, a, b);
+    const T s_b = dot < 0 ? -s : s;
+
+    Quaternion<T> result;
+    for (int i = 0; i < 4; i++) {
+        result[i] = (1 - s) * a[i] + s_b * b[i];
+    }
+    Normalize(result);
+
+    return result;
+}
+
+// blend from a to b at a constant angular speed, the shorter way round
+template <class T>
+inline Quaternion<T> Slerp(const Quaternion<T>& a, const Quaternion<T>& b,
+                           const T s) {
+    T dot;
+    DotProduct(dot, a, b);
+    const T sign = dot < 0 ? -1 : 1;
+    dot *= sign;
+
+    // nearly the same rotation, the arc is a line
+    if (dot > T(0.9995)) return Nlerp(a, b, s);
+
+    const T theta = std::acos(dot);
+    const T sin_theta = std::sin(theta);
+    const T w_a = std::sin((1 - s) * theta) / sin_theta;
+    const T w_b = sign * std::sin(s * theta) / sin_theta;
+
+    Quaternion<T> result;
+    for (int i = 0; i < 4; i++) {
+        result[i] = w_a * a[i] + w_b * b[i];
+    }
+
+    return result;
+}
+
+// the cubic Bezier from p1 to p2 with control points c1 and c2 on the unit
+// sphere, De Casteljau's construction with slerps in place of lerps
+template <class T>
+inline Quaternion<T> QuaternionBezier(const Quaternion<T>& p1,
+                                      const Quaternion<T>& c1,
+                                      const Quaternion<T>& c2,
+                                      const Quaternion<T>& p2, const T s) {
+    const auto q1 = Slerp(p1, c1, s);
+    const auto q2 = Slerp(c1, c2, s);
+    const auto q3 = Slerp(c2, p2, s);
+    return Slerp(Slerp(q1, q2, s), Slerp(q2, q3, s), s);
+}
+
+// the angle of the rotation from a to b
+template <class T>
+inline T QuaternionAngle(const Quaternion<T>& a, const Quaternion<T>& b) {
+    T dot;
+    DotProduct(dot, a, b);
+    return 2 * std::acos(std::min(std::fabs(dot), T(1)));
+}
+
 inline void MatrixScale(Matrix4X4f& matrix, const float x, const float y,
                         const float z) {
     Matrix4X4f scale = {{
@@ -1,10 +1,10 @@
 #pragma once
+#include "HalfEdgeHull.hpp"
 #include "Polyhedron.hpp"
-#include "quickhull.hpp"
 
 namespace My {
 template <typename T>
-class ConvexHull : public Polyhedron<T>, protected QuickHull<T> {
+class ConvexHull : public Polyhedron<T> {
    public:
     ConvexHull() = default;
     ~ConvexHull() override = default;
@@ -30,20 +30,65 @@ class ConvexHull : public Polyhedron<T>, protected QuickHull<T> {
         m_PointSet.insert(point_set.begin(), point_set.end());
         m_bFullyBuild = false;
     }
+    // keep at most this many vertices, 0 for all of them
+    void SetMaxVertexCount(uint32_t count) {
+        m_nMaxVertexCount = count;
+        m_bFullyBuild = false;
+    }
+    // builds the whole hull in one go, always returns false as there is
+    // nothing left to do
     bool Iterate() {
         if (!m_bFullyBuild) {
-            m_bFullyBuild = !QuickHull<T>::Iterate(*this, m_PointSet);
+            build();
+            m_bFullyBuild = true;
         }
 
-        return !m_bFullyBuild;
+        return false;
     }
     [[nodiscard]] PointSet<T> GetPointSet() const { return m_PointSet; }
     [[nodiscard]] Polyhedron<T> GetHull() const {
         return *static_cast<const Polyhedron<T>*>(this);
     }
+    // the hull as flat arrays, for the narrowphase
+    [[nodiscard]] const ConvexHullSupport<T>& GetSupport() const {
+        return m_Support;
+    }
 
    protected:
+    void build() {
+        std::vector<Vector3<T>> points;
+        points.reserve(m_PointSet.size());
+        for (const auto& point : m_PointSet) points.push_back(*point);
+
+        HalfEdgeHull<T> hull;
+        hull.Build(points.data(), points.size(), m_nMaxVertexCount);
+        m_Support = hull.GetSupport();
+
+        // the polyhedron shares one point object per hull vertex
+        Polyhedron<T>::Faces.clear();
+        PointList<T> vertices;
+        Point<T> center(0);
+        for (const auto& v : m_Support.vertices) {
+            vertices.push_back(std::make_shared<Point<T>>(v));
+            center = center + v;
+        }
+        if (vertices.empty()) return;
+        const auto inner_point = std::make_shared<Point<T>>(
+            center * (T(1) / static_cast<T>(vertices.size())));
+
+        for (size_t f = 0; f < m_Support.GetFaceCount(); f++) {
+            PointList<T> face;
+            for (auto i = m_Support.faceOffsets[f];
+                 i < m_Support.faceOffsets[f + 1]; i++) {
+                face.push_back(vertices[m_Support.faceIndices[i]]);
+            }
+            Polyhedron<T>::AddFace(std::move(face), inner_point);
+        }
+    }
+
     PointSet<T> m_PointSet;
+    ConvexHullSupport<T> m_Support;
+    uint32_t m_nMaxVertexCount{0};
     bool m_bFullyBuild = false;
 };
 }  // namespace My
@@ -3,8 +3,8 @@
 #include "Hitable.hpp"
 
 namespace My {
-ENUM(GeometryType){kBox,   kCapsule,    kCone,   kCylinder,
-                   kPlane, kPolyhydron, kSphere, kTriangle};
+ENUM(GeometryType){kBox,   kCapsule,    kCone,   kCylinder,  kPlane,
+                   kPolyhydron, kSphere, kTriangle, kHeightfield};
 
 template <class T>
 class Geometry : _implements_ Hitable<T> {
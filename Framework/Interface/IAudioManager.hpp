@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+
+#include "IRuntimeModule.hpp"
+
+namespace My {
+_Interface_ IAudioManager : _inherits_ IRuntimeModule {
+   public:
+    using VoiceId = int32_t;
+    static constexpr VoiceId kInvalidVoice = -1;
+
+    IAudioManager() = default;
+    virtual ~IAudioManager() = default;
+
+    // the whole clip is loaded first, for short sounds played often
+    virtual VoiceId PlayClip(const char* path, float volume = 1.0f,
+                             float pan = 0.0f, bool loop = false) = 0;
+    // decoded a chunk at a time while it plays, for long ones
+    virtual VoiceId StreamClip(const char* path, float volume = 1.0f,
+                               float pan = 0.0f, bool loop = false) = 0;
+
+    virtual void StopVoice(VoiceId voice) = 0;
+    virtual void SetVoiceVolume(VoiceId voice, float volume) = 0;
+    // from -1, left only, to 1, right only
+    virtual void SetVoicePan(VoiceId voice, float pan) = 0;
+    [[nodiscard]] virtual bool IsVoicePlaying(VoiceId voice) const = 0;
+};
+}  // namespace My
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Interface.hpp"
+
+namespace My {
+// Where the mixer sends its output: interleaved 32-bit float frames at the
+// sample rate and channel count it was opened with. A device sink may block
+// in Write() until there is room.
+_Interface_ IAudioSink {
+   public:
+    IAudioSink() = default;
+    virtual ~IAudioSink() = default;
+
+    virtual bool Open(uint32_t sample_rate, uint16_t channel_count) = 0;
+    virtual void Write(const float* frames, size_t frame_count) = 0;
+    virtual void Close() = 0;
+};
+}  // namespace My
@@ -14,6 +14,21 @@ _Interface_ IGraphicsManager : _inherits_ IRuntimeModule {
     virtual void Draw() = 0;
     virtual void Present() = 0;
 
+    // Pipelined frame loop, Tick() runs the four steps in order.
+    // SyncScene() rebuilds the GPU resources when the scene has changed and
+    // returns false if there is no scene to render yet. It must not run
+    // concurrently with any other module.
+    virtual bool SyncScene() = 0;
+    // true if the published snapshot belongs to the current scene
+    [[nodiscard]] virtual bool IsSnapshotReady() const = 0;
+    // reads the simulation state into the back snapshot, may run on any
+    // thread concurrently with RenderFrame() once the simulation is done
+    virtual void CaptureSnapshot() = 0;
+    // makes the back snapshot the one to render, nothing else may run
+    virtual void PublishSnapshot() = 0;
+    // renders the published snapshot, on the thread owning the context
+    virtual void RenderFrame() = 0;
+
     virtual void ResizeCanvas(int32_t width, int32_t height) = 0;
 
     virtual void SetPipelineState(
@@ -6,6 +6,8 @@ namespace My {
 _Interface_ IPass {
    public:
     virtual ~IPass() = default;
+    // shown in the profiler
+    [[nodiscard]] virtual const char* GetName() const = 0;
     virtual void BeginPass(Frame & frame) = 0;
     virtual void EndPass(Frame & frame) = 0;
 };
@@ -1,11 +1,53 @@
 #pragma once
 #include <vector>
 
+#include "Geometry.hpp"
 #include "IRuntimeModule.hpp"
 #include "SceneGeometryNode.hpp"
 #include "SceneObjectGeometry.hpp"
 
 namespace My {
+// Spatial queries, issued in batches (see IPhysicsManager::CastRays()).
+// Rigid bodies are the ones SceneGeometryNode::RigidBody() returns, the
+// ignored one is left out of the results.
+struct PhysicsRay {
+    Vector3f origin;
+    Vector3f direction;  // unit length
+    float maxDistance;
+    void* ignoredRigidBody{nullptr};
+};
+
+// a sphere of radius, or a box of halfExtents, placed in the world
+struct PhysicsQueryShape {
+    GeometryType type{GeometryType::kSphere};
+    float radius{0.0f};
+    Vector3f halfExtents;
+    Vector3f position;
+    Quaternion<float> orientation{0.0f, 0.0f, 0.0f, 1.0f};
+    void* ignoredRigidBody{nullptr};
+};
+
+// the shape moved along a unit direction, without turning
+struct PhysicsShapeSweep : PhysicsQueryShape {
+    Vector3f direction;
+    float maxDistance;
+};
+
+struct PhysicsQueryHit {
+    void* rigidBody;  // nullptr if nothing was hit
+    float distance;
+    Vector3f point;
+    Vector3f normal;  // of the surface hit
+};
+
+// Transforms of all the rigid bodies, published once per Tick(), at the
+// handle each body was linked to its node with (see
+// SceneGeometryNode::RigidBodyHandle()). Valid until the next Tick().
+struct PhysicsTransforms {
+    const Matrix4X4f* transforms{nullptr};
+    size_t count{0};
+};
+
 _Interface_ IPhysicsManager : _inherits_ IRuntimeModule {
    public:
     IPhysicsManager() = default;
@@ -19,8 +61,28 @@ _Interface_ IPhysicsManager : _inherits_ IRuntimeModule {
     virtual void ClearRigidBodies() = 0;
 
     virtual Matrix4X4f GetRigidBodyTransform(void* rigidBody) = 0;
+    virtual PhysicsTransforms GetRigidBodyTransforms() = 0;
     virtual void UpdateRigidBodyTransform(SceneGeometryNode & node) = 0;
 
     virtual void ApplyCentralForce(void* rigidBody, Vector3f force) = 0;
+
+    // each Tick() then simulates exactly frame_time seconds, for benchmarks
+    // and replays. 0 goes back to the backend's own pacing.
+    virtual void SetFixedFrameTime(float frame_time) = 0;
+    // contact points found by the last Tick()
+    virtual size_t GetContactCount() = 0;
+
+    // One call runs a whole batch of queries, on several threads where the
+    // backend can, and writes one result per query to arrays of the
+    // caller: hits[i] is the first hit of rays[i] or sweeps[i]. The bodies
+    // overlapping shapes[i] go from rigid_bodies + i * max_results, at most
+    // max_results of them, result_counts[i] of them.
+    virtual void CastRays(const PhysicsRay* rays, size_t count,
+                          PhysicsQueryHit* hits) = 0;
+    virtual void OverlapShapes(const PhysicsQueryShape* shapes, size_t count,
+                               void** rigid_bodies, uint32_t max_results,
+                               uint32_t* result_counts) = 0;
+    virtual void SweepShapes(const PhysicsShapeSweep* sweeps, size_t count,
+                             PhysicsQueryHit* hits) = 0;
 };
 }  // namespace My
@@ -1,10 +1,18 @@
 #include "AnimationManager.hpp"
+
+#include <atomic>
+
 #include "BaseApplication.hpp"
 #include "SceneManager.hpp"
 
 using namespace My;
 using namespace std;
 
+namespace {
+// clips are small, a job takes a few
+constexpr size_t kClipsPerJob = 16;
+}  // namespace
+
 int AnimationManager::Initialize() { return 0; }
 
 void AnimationManager::Finalize() { ClearAnimationClips(); }
@@ -26,7 +34,7 @@ void AnimationManager::Tick() {
                 BaseSceneNode::animation_clip_iterator it;
                 if (pNode->GetFirstAnimationClip(it)) {
                     do {
-                        AddAnimationClip(it->second);
+                        addAnimationClip(it->second, pNode);
                     } while (pNode->GetNextAnimationClip(it));
                 }
             }
@@ -45,14 +53,136 @@ void AnimationManager::Tick() {
 
     m_TimeLineValue = std::chrono::steady_clock::now() - m_TimeLineStartPoint;
 
-    for (const auto& clip : m_AnimationClips) {
-        clip->Update(m_TimeLineValue.count());
+    Update(m_TimeLineValue.count());
+}
+
+void AnimationManager::Update(float time_point) {
+    auto* pApp = dynamic_cast<BaseApplication*>(m_pApp);
+    auto* pJobSystem = pApp ? pApp->GetJobSystem() : nullptr;
+    const auto viewer = getViewer();
+    const size_t count = m_AnimationClips.size();
+
+    if (!pJobSystem) {
+        updateLods(0, count, viewer);
+        m_nUpdatedClipCount = updateClips(0, count, time_point);
+    } else {
+        pJobSystem->ParallelFor(0, count, kClipsPerJob,
+                                [this, &viewer](size_t begin, size_t end) {
+                                    updateLods(begin, end, viewer);
+                                });
+
+        atomic<size_t> updated{0};
+        pJobSystem->ParallelFor(
+            0, count, kClipsPerJob,
+            [this, time_point, &updated](size_t begin, size_t end) {
+                updated += updateClips(begin, end, time_point);
+            });
+        m_nUpdatedClipCount = updated;
     }
+
+    m_nTickCount++;
 }
 
 void AnimationManager::AddAnimationClip(
     const std::shared_ptr<SceneObjectAnimationClip>& clip) {
-    m_AnimationClips.push_back(clip);
+    addAnimationClip(clip, nullptr);
+}
+
+void AnimationManager::ClearAnimationClips() {
+    m_AnimationClips.clear();
+    m_nTickCount = 0;
+}
+
+void AnimationManager::addAnimationClip(
+    const std::shared_ptr<SceneObjectAnimationClip>& clip,
+    const std::shared_ptr<BaseSceneNode>& node) {
+    auto& animated = m_AnimationClips.emplace_back();
+    animated.clip = clip;
+    animated.isCompiled = animated.compiled.Compile(*clip);
+    if (animated.isCompiled && m_fCompressionTolerance > 0.0f) {
+        animated.compressed.Compress(animated.compiled,
+                                     m_fCompressionTolerance);
+        animated.isCompressed = true;
+        // the keys are in compressed now
+        animated.compiled = CompiledAnimationClip();
+    }
+    animated.node = node;
+}
+
+AnimationManager::Viewer AnimationManager::getViewer() const {
+    Viewer viewer;
+
+    auto* pApp = dynamic_cast<BaseApplication*>(m_pApp);
+    if (!pApp || !pApp->GetSceneManager()) return viewer;
+    auto scene = pApp->GetSceneManager()->GetSceneForRendering();
+    if (!scene) return viewer;
+    auto pCameraNode = scene->GetFirstCameraNode();
+    if (!pCameraNode) return viewer;
+    auto pCamera = dynamic_pointer_cast<SceneObjectPerspectiveCamera>(
+        scene->GetCamera(pCameraNode->GetSceneObjectRef()));
+    if (!pCamera) return viewer;
+
+    // the camera as GraphicsManager::CalculateCameraMatrix() sets it up
+    const auto transform = *pCameraNode->GetCalculatedTransform();
+    viewer.position = {transform[3][0], transform[3][1], transform[3][2]};
+    Matrix4X4f view, projection;
+    BuildViewRHMatrix(view, viewer.position, pCameraNode->GetTarget(),
+                      {0.0f, 0.0f, 1.0f});
+    const auto& conf = pApp->GetConfiguration();
+    BuildPerspectiveFovRHMatrix(
+        projection, pCamera->GetFov(),
+        static_cast<float>(conf.screenWidth) / conf.screenHeight,
+        pCamera->GetNearClipDistance(), pCamera->GetFarClipDistance());
+    viewer.frustum = Frustumf(view * projection);
+    viewer.valid = true;
+
+    return viewer;
+}
+
+void AnimationManager::updateLods(size_t begin, size_t end,
+                                  const Viewer& viewer) {
+    for (size_t i = begin; i < end; i++) {
+        auto& animated = m_AnimationClips[i];
+        animated.lod = kAnimationLodFull;
+
+        auto node = animated.node.lock();
+        if (!viewer.valid || !node) continue;
+
+        const auto transform = *node->GetCalculatedTransform();
+        const Vector3f position = {transform[3][0], transform[3][1],
+                                   transform[3][2]};
+        if (!viewer.frustum.IntersectSphere(position, m_fLodRadius)) {
+            animated.lod = kAnimationLodHidden;
+        } else if (Length(position - viewer.position) > m_fLodDistance) {
+            animated.lod = kAnimationLodFar;
+        }
+    }
 }
 
-void AnimationManager::ClearAnimationClips() { m_AnimationClips.clear(); }
+size_t AnimationManager::updateClips(size_t begin, size_t end,
+                                     float time_point) {
+    static constexpr uint32_t intervals[] = {1, kFarTickInterval,
+                                             kHiddenTickInterval};
+
+    size_t updated = 0;
+    for (size_t i = begin; i < end; i++) {
+        auto& animated = m_AnimationClips[i];
+
+        // every clip gets its first pose, then the clips of a reduced
+        // rate take turns so they do not all land on the same tick
+        if (m_nTickCount && (m_nTickCount + i) % intervals[animated.lod]) {
+            continue;
+        }
+
+        if (animated.isCompressed) {
+            animated.compressed.Evaluate(time_point);
+        } else if (animated.isCompiled) {
+            animated.compiled.Evaluate(time_point);
+        } else {
+            animated.clip->Update(time_point);
+        }
+        updated++;
+    }
+
+    return updated;
+}
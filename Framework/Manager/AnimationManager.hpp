@@ -1,13 +1,29 @@
 #pragma once
 #include <chrono>
-#include <list>
+#include <vector>
 
+#include "CompiledAnimationClip.hpp"
+#include "CompressedAnimationClip.hpp"
+#include "Frustum.hpp"
 #include "IAnimationManager.hpp"
 #include "SceneObject.hpp"
 
 namespace My {
+class BaseSceneNode;
+
 class AnimationManager : _implements_ IAnimationManager {
    public:
+    // how often a clip is evaluated: every tick when its node is in view
+    // and near, 1 tick in kFarTickInterval when it is far, 1 in
+    // kHiddenTickInterval when it is out of view
+    enum AnimationLod : uint8_t {
+        kAnimationLodFull,
+        kAnimationLodFar,
+        kAnimationLodHidden
+    };
+    static constexpr uint32_t kFarTickInterval = 4;
+    static constexpr uint32_t kHiddenTickInterval = 16;
+
     AnimationManager() {}
     ~AnimationManager() override {}
     int Initialize() override;
@@ -18,11 +34,75 @@ class AnimationManager : _implements_ IAnimationManager {
         const std::shared_ptr<SceneObjectAnimationClip>& clip) override;
     void ClearAnimationClips() override;
 
+    // evaluates the clips due at this tick, on the job system if there is
+    // one. Tick() calls it with the time since the scene was loaded.
+    void Update(float time_point);
+
+    // nodes farther than distance from the camera are far, a node is out of
+    // view when a sphere of radius around it is
+    void SetLodDistance(float distance) { m_fLodDistance = distance; }
+    void SetLodRadius(float radius) { m_fLodRadius = radius; }
+    // clips added from then on are compressed within tolerance, see
+    // CompressedAnimationClip. 0, the default, leaves them compiled only.
+    void SetCompressionTolerance(float tolerance) {
+        m_fCompressionTolerance = tolerance;
+    }
+
+    [[nodiscard]] size_t GetAnimationClipCount() const {
+        return m_AnimationClips.size();
+    }
+    // clips evaluated by the last Update(), and their LOD
+    [[nodiscard]] size_t GetUpdatedClipCount() const {
+        return m_nUpdatedClipCount;
+    }
+    [[nodiscard]] AnimationLod GetAnimationLod(size_t index) const {
+        return m_AnimationClips[index].lod;
+    }
+
+   private:
+    struct AnimatedClip {
+        std::shared_ptr<SceneObjectAnimationClip> clip;
+        // evaluated instead of clip when it could be compiled, and
+        // compressed instead of compiled when that is asked for
+        CompiledAnimationClip compiled;
+        CompressedAnimationClip compressed;
+        bool isCompiled{false};
+        bool isCompressed{false};
+        // where the LOD is measured from, none for full rate
+        std::weak_ptr<BaseSceneNode> node;
+        AnimationLod lod{kAnimationLodFull};
+    };
+
+    struct Viewer {
+        bool valid{false};
+        Vector3f position;
+        Frustumf frustum;
+    };
+
+    void addAnimationClip(
+        const std::shared_ptr<SceneObjectAnimationClip>& clip,
+        const std::shared_ptr<BaseSceneNode>& node);
+    [[nodiscard]] Viewer getViewer() const;
+    // only reads the nodes, so it is done for every clip before any of
+    // them writes its transforms
+    void updateLods(size_t begin, size_t end, const Viewer& viewer);
+    // evaluates the clips of [begin, end) due at this tick, returns how
+    // many
+    size_t updateClips(size_t begin, size_t end, float time_point);
+
    private:
     uint64_t m_nSceneRevision{0};
     std::chrono::steady_clock::time_point m_TimeLineStartPoint;
     std::chrono::duration<float> m_TimeLineValue;
-    std::list<std::shared_ptr<SceneObjectAnimationClip>> m_AnimationClips;
+    // contiguous, each clip only writes the transforms it animates so
+    // ranges of it are evaluated in parallel
+    std::vector<AnimatedClip> m_AnimationClips;
     bool m_bTimeLineStarted{false};
+
+    float m_fLodDistance{50.0f};
+    float m_fLodRadius{2.0f};
+    float m_fCompressionTolerance{0.0f};
+    uint64_t m_nTickCount{0};
+    size_t m_nUpdatedClipCount{0};
 };
-}  // namespace My
\ No newline at end of file
+}  // namespace My
@@ -1,5 +1,7 @@
 #include "AssetLoader.hpp"
 
+#include "Profiler.hpp"
+
 using namespace My;
 using namespace std;
 
@@ -120,6 +122,7 @@ AssetLoader::AssetFilePtr AssetLoader::OpenFile(const char* name,
 }
 
 Buffer AssetLoader::SyncOpenAndReadText(const char* filePath) {
+    PROFILE_SCOPE("AssetLoader::SyncOpenAndReadText");
     AssetFilePtr fp = OpenFile(filePath, MY_OPEN_TEXT);
     Buffer buff;
 
@@ -144,6 +147,7 @@ Buffer AssetLoader::SyncOpenAndReadText(const char* filePath) {
 }
 
 Buffer AssetLoader::SyncOpenAndReadBinary(const char* filePath) {
+    PROFILE_SCOPE("AssetLoader::SyncOpenAndReadBinary");
     AssetFilePtr fp = OpenFile(filePath, MY_OPEN_BINARY);
     Buffer buff;
 
@@ -0,0 +1,189 @@
+#include "AudioManager.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "BaseApplication.hpp"
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+#include "WAVE.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+// frames the mixer thread mixes at a time, and how many of those it keeps
+// queued in the sink ahead of what has been played
+constexpr size_t kMixBlockFrames = 512;
+constexpr size_t kMixBlocksAhead = 2;
+// the decoder thread checks the streams at least this often
+constexpr auto kDecodeInterval = chrono::milliseconds(5);
+}  // namespace
+
+int AudioManager::Initialize() {
+    if (m_bInitialized) return 0;
+
+    if (!m_pSink) m_pSink = &m_NullSink;
+    if (!m_pSink->Open(m_Mixer.GetSampleRate(), AudioMixer::kChannelCount)) {
+        cerr << "[AudioManager] Failed to open the audio sink" << endl;
+        return -1;
+    }
+    m_bInitialized = true;
+
+    m_bStop = false;
+    if (m_bThreaded) {
+        m_DecoderThread = thread(&AudioManager::decoderMain, this);
+        m_MixerThread = thread(&AudioManager::mixerMain, this);
+    }
+
+    return 0;
+}
+
+void AudioManager::Finalize() {
+    if (!m_bInitialized) return;
+
+    m_bStop = true;
+    m_DecoderCondition.notify_all();
+    if (m_MixerThread.joinable()) m_MixerThread.join();
+    if (m_DecoderThread.joinable()) m_DecoderThread.join();
+
+    m_Mixer.StopAllVoices();
+    m_Streams.clear();
+    m_pSink->Close();
+    m_bInitialized = false;
+}
+
+AudioManager::VoiceId AudioManager::PlayClip(const char* path, float volume,
+                                             float pan, bool loop) {
+    MemoryTagScope memory_tag(MemoryTag::kAudio);
+    auto pAssetLoader =
+        dynamic_cast<BaseApplication*>(m_pApp)->GetAssetLoader();
+    Buffer buffer = pAssetLoader->SyncOpenAndReadBinary(path);
+    if (!buffer.GetDataSize()) {
+        cerr << "[AudioManager] Can not load " << path << endl;
+        return kInvalidVoice;
+    }
+
+    PROFILE_SCOPE("WaveParser::Parse");
+    WaveParser parser;
+    const AudioClip clip = parser.Parse(buffer);
+    if (!clip.data) {
+        cerr << "[AudioManager] Can not play " << path << endl;
+        return kInvalidVoice;
+    }
+    // in the format of the mixer from now on, buffer is no longer needed
+    auto source = MakeTaggedShared<AudioClipSource>(
+        MemoryTag::kAudio, clip, loop, m_Mixer.GetSampleRate());
+    return m_Mixer.AddVoice(std::move(source), volume, pan);
+}
+
+AudioManager::VoiceId AudioManager::StreamClip(const char* path, float volume,
+                                               float pan, bool loop) {
+    MemoryTagScope memory_tag(MemoryTag::kAudio);
+    auto pAssetLoader =
+        dynamic_cast<BaseApplication*>(m_pApp)->GetAssetLoader();
+    auto stream = make_unique<WaveStream>();
+    if (!stream->Open(pAssetLoader, path)) {
+        cerr << "[AudioManager] Can not stream " << path << endl;
+        return kInvalidVoice;
+    }
+
+    auto source = MakeTaggedShared<StreamingAudioSource>(
+        MemoryTag::kAudio, std::move(stream), loop, m_nStreamBufferFrames);
+    // before the mixer gets to it, so it does not start with an underrun
+    source->Decode();
+    {
+        lock_guard<mutex> lock(m_StreamLock);
+        m_Streams.push_back(source);
+    }
+    return m_Mixer.AddVoice(std::move(source), volume, pan);
+}
+
+void AudioManager::StopVoice(VoiceId voice) { m_Mixer.StopVoice(voice); }
+
+void AudioManager::SetVoiceVolume(VoiceId voice, float volume) {
+    m_Mixer.SetVolume(voice, volume);
+}
+
+void AudioManager::SetVoicePan(VoiceId voice, float pan) {
+    m_Mixer.SetPan(voice, pan);
+}
+
+bool AudioManager::IsVoicePlaying(VoiceId voice) const {
+    return m_Mixer.IsPlaying(voice);
+}
+
+void AudioManager::Mix(size_t frame_count) {
+    if (!m_bInitialized) return;
+    PROFILE_SCOPE("AudioManager::Mix");
+
+    if (!m_bThreaded) decodeStreams();
+
+    m_MixBuffer.resize(frame_count * AudioMixer::kChannelCount);
+    m_Mixer.Mix(m_MixBuffer.data(), frame_count);
+    m_pSink->Write(m_MixBuffer.data(), frame_count);
+
+    if (m_bThreaded) {
+        m_bDecodeRequested = true;
+        m_DecoderCondition.notify_one();
+    }
+}
+
+void AudioManager::decodeStreams() {
+    PROFILE_SCOPE("AudioManager::decodeStreams");
+    vector<shared_ptr<StreamingAudioSource>> streams;
+    {
+        lock_guard<mutex> lock(m_StreamLock);
+        streams = m_Streams;
+    }
+
+    // outside of the lock, a clip can be streamed meanwhile
+    vector<StreamingAudioSource*> decoded;
+    for (const auto& stream : streams) {
+        if (!stream->Decode()) decoded.push_back(stream.get());
+    }
+    streams.clear();
+
+    // those fully decoded, and those the mixer no longer has a voice for
+    lock_guard<mutex> lock(m_StreamLock);
+    m_Streams.erase(
+        remove_if(m_Streams.begin(), m_Streams.end(),
+                  [&decoded](const shared_ptr<StreamingAudioSource>& stream) {
+                      return stream.use_count() == 1 ||
+                             find(decoded.begin(), decoded.end(),
+                                  stream.get()) != decoded.end();
+                  }),
+        m_Streams.end());
+}
+
+void AudioManager::decoderMain() {
+    Profiler::SetThreadName("AudioDecoder");
+    while (!m_bStop) {
+        decodeStreams();
+
+        unique_lock<mutex> lock(m_StreamLock);
+        m_DecoderCondition.wait_for(lock, kDecodeInterval, [this] {
+            return m_bStop || m_bDecodeRequested.exchange(false);
+        });
+    }
+}
+
+void AudioManager::mixerMain() {
+    Profiler::SetThreadName("AudioMixer");
+    const double sample_rate = m_Mixer.GetSampleRate();
+    const auto start = chrono::steady_clock::now();
+    size_t mixed = 0;
+
+    while (!m_bStop) {
+        const chrono::duration<double> elapsed =
+            chrono::steady_clock::now() - start;
+        const auto played = static_cast<size_t>(elapsed.count() * sample_rate);
+        if (mixed < played + kMixBlocksAhead * kMixBlockFrames) {
+            Mix(kMixBlockFrames);
+            mixed += kMixBlockFrames;
+        } else {
+            this_thread::sleep_for(chrono::duration<double>(
+                0.5 * kMixBlockFrames / sample_rate));
+        }
+    }
+}
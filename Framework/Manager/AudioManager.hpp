@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AudioMixer.hpp"
+#include "AudioSink.hpp"
+#include "IAudioManager.hpp"
+
+namespace My {
+// Plays clips through an AudioMixer into an IAudioSink. Streamed clips are
+// decoded on a decoder thread into lock free ring buffers the mixer thread
+// reads from, so neither waits for the other; the mixer thread keeps the
+// sink fed a couple of blocks ahead of real time.
+//
+// Without threads nothing runs on its own: Mix() decodes and mixes on the
+// calling thread, for headless tests and rendering audio offline.
+class AudioManager : _implements_ IAudioManager {
+   public:
+    AudioManager() = default;
+    ~AudioManager() override { Finalize(); }
+
+    int Initialize() override;
+    void Finalize() override;
+    void Tick() override {}
+
+    VoiceId PlayClip(const char* path, float volume = 1.0f, float pan = 0.0f,
+                     bool loop = false) override;
+    VoiceId StreamClip(const char* path, float volume = 1.0f,
+                       float pan = 0.0f, bool loop = false) override;
+
+    void StopVoice(VoiceId voice) override;
+    void SetVoiceVolume(VoiceId voice, float volume) override;
+    void SetVoicePan(VoiceId voice, float pan) override;
+    [[nodiscard]] bool IsVoicePlaying(VoiceId voice) const override;
+
+    // set before Initialize(). nullptr, the default, mixes into a
+    // NullAudioSink.
+    void SetSink(IAudioSink* sink) { m_pSink = sink; }
+    void SetSampleRate(uint32_t sample_rate) {
+        m_Mixer.SetSampleRate(sample_rate);
+    }
+    void SetThreaded(bool threaded) { m_bThreaded = threaded; }
+    // frames a streamed clip is decoded ahead, at its own sample rate
+    void SetStreamBufferFrames(size_t frames) {
+        m_nStreamBufferFrames = frames;
+    }
+
+    // mixes frame_count frames into the sink. The mixer thread calls it, do
+    // not when threaded.
+    void Mix(size_t frame_count);
+
+    [[nodiscard]] const AudioMixer& GetMixer() const { return m_Mixer; }
+
+   private:
+    void decodeStreams();
+    void decoderMain();
+    void mixerMain();
+
+   private:
+    AudioMixer m_Mixer;
+    IAudioSink* m_pSink{nullptr};
+    NullAudioSink m_NullSink;
+    bool m_bThreaded{true};
+    bool m_bInitialized{false};
+    size_t m_nStreamBufferFrames{16384};
+    std::vector<float> m_MixBuffer;
+
+    // what the decoder thread tops up
+    std::vector<std::shared_ptr<StreamingAudioSource>> m_Streams;
+    std::mutex m_StreamLock;
+    std::condition_variable m_DecoderCondition;
+
+    std::atomic<bool> m_bDecodeRequested{false};
+
+    std::thread m_DecoderThread;
+    std::thread m_MixerThread;
+    std::atomic<bool> m_bStop{false};
+};
+}  // namespace My
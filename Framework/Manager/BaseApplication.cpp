@@ -3,6 +3,9 @@
 #include <cassert>
 #include <iostream>
 
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+
 using namespace My;
 using namespace std;
 
@@ -12,7 +15,13 @@ int BaseApplication::Initialize() {
 
     cout << m_Config;
 
-    for (auto module : runtime_modules) {
+    m_pJobSystem = make_unique<JobSystem>();
+    cerr << "[BaseApplication] Job System started with "
+         << m_pJobSystem->GetWorkerCount() << " worker threads" << endl;
+
+    Profiler::SetThreadName("Main");
+
+    for (const auto& [module, name] : runtime_modules) {
         if ((ret = module->Initialize()) != 0) {
             std::cerr << "Module initialize failed!\n";
             break;
@@ -24,20 +33,81 @@ int BaseApplication::Initialize() {
 
 // Finalize all sub modules and clean up all runtime temporary files.
 void BaseApplication::Finalize() {
-    for (auto module : runtime_modules) {
+    for (const auto& [module, name] : runtime_modules) {
         module->Finalize();
     }
 
     runtime_modules.clear();
+
+    m_pJobSystem.reset();
 }
 
 // One cycle of the main loop
 void BaseApplication::Tick() {
-    for (auto module : runtime_modules) {
+    // everything of the last frame has finished by now
+    Profiler::NextFrame();
+    MemoryTracker::NextFrame();
+
+    if (!m_bPipelinedFrameLoop || !m_pJobSystem || !m_pGraphicsManager) {
+        tickSerial();
+        return;
+    }
+
+    // the scene changed (or there is nothing to render yet), nothing has
+    // been captured for it so run this frame serially
+    if (!m_pGraphicsManager->SyncScene() ||
+        !m_pGraphicsManager->IsSnapshotReady()) {
+        tickSerial();
+        return;
+    }
+
+    // simulate the next frame and capture it, while the current one is
+    // rendered. The graphics and pipeline state managers own the graphics
+    // context, so they stay on this thread. The simulation is a background
+    // job, so that the waits of RenderFrame() do not run it inline.
+    auto simulation = m_pJobSystem->ScheduleBackground([this] {
+        for (const auto& [module, name] : runtime_modules) {
+            if (module == m_pGraphicsManager ||
+                module == m_pPipelineStateManager)
+                continue;
+            PROFILE_SCOPE(name);
+            module->Tick();
+        }
+        PROFILE_SCOPE("CaptureSnapshot");
+        m_pGraphicsManager->CaptureSnapshot();
+    });
+
+    if (m_pPipelineStateManager) {
+        PROFILE_SCOPE("PipelineStateManager");
+        m_pPipelineStateManager->Tick();
+    }
+    {
+        PROFILE_SCOPE("GraphicsManager");
+        m_pGraphicsManager->RenderFrame();
+    }
+
+    {
+        PROFILE_SCOPE("WaitSimulation");
+        m_pJobSystem->Wait(simulation);
+    }
+    m_pGraphicsManager->PublishSnapshot();
+}
+
+void BaseApplication::tickSerial() {
+    for (const auto& [module, name] : runtime_modules) {
+        PROFILE_SCOPE(name);
         module->Tick();
     }
 }
 
+std::vector<const char*> BaseApplication::GetModuleNames() const {
+    vector<const char*> names;
+    for (const auto& [module, name] : runtime_modules) {
+        names.push_back(name);
+    }
+    return names;
+}
+
 void BaseApplication::SetCommandLineParameters(int argc, char** argv) {
     m_nArgC = argc;
     m_ppArgV = argv;
@@ -55,61 +125,67 @@ bool BaseApplication::IsQuit() const { return m_bQuit; }
 void BaseApplication::RegisterManagerModule(IGraphicsManager* mgr) {
     m_pGraphicsManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "GraphicsManager"});
 }
 
 void BaseApplication::RegisterManagerModule(IMemoryManager* mgr) {
     m_pMemoryManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "MemoryManager"});
 }
 
 void BaseApplication::RegisterManagerModule(IAssetLoader* mgr) {
     m_pAssetLoader = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "AssetLoader"});
 }
 
 void BaseApplication::RegisterManagerModule(IInputManager* mgr) {
     m_pInputManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "InputManager"});
 }
 
 void BaseApplication::RegisterManagerModule(ISceneManager* mgr) {
     m_pSceneManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "SceneManager"});
 }
 
 #ifdef DEBUG
 void BaseApplication::RegisterManagerModule(IDebugManager* mgr) {
     m_pDebugManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "DebugManager"});
 }
 #endif
 
 void BaseApplication::RegisterManagerModule(IAnimationManager* mgr) {
     m_pAnimationManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "AnimationManager"});
 }
 
 void BaseApplication::RegisterManagerModule(IPhysicsManager* mgr) {
     m_pPhysicsManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "PhysicsManager"});
 }
 
 void BaseApplication::RegisterManagerModule(IPipelineStateManager* mgr) {
     m_pPipelineStateManager = mgr;
     mgr->SetAppPointer(this);
-    runtime_modules.push_back(mgr);
+    runtime_modules.push_back({mgr, "PipelineStateManager"});
+}
+
+void BaseApplication::RegisterManagerModule(IAudioManager* mgr) {
+    m_pAudioManager = mgr;
+    mgr->SetAppPointer(this);
+    runtime_modules.push_back({mgr, "AudioManager"});
 }
 
 void BaseApplication::RegisterManagerModule(IGameLogic* logic) {
     m_pGameLogic = logic;
     logic->SetAppPointer(this);
-    runtime_modules.push_back(logic);
+    runtime_modules.push_back({logic, "GameLogic"});
 }
@@ -1,8 +1,10 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include "IAnimationManager.hpp"
 #include "IApplication.hpp"
 #include "IAssetLoader.hpp"
+#include "IAudioManager.hpp"
 #include "IDebugManager.hpp"
 #include "IGameLogic.hpp"
 #include "IGraphicsManager.hpp"
@@ -11,6 +13,7 @@
 #include "IPhysicsManager.hpp"
 #include "IPipelineStateManager.hpp"
 #include "IRuntimeModule.hpp"
+#include "JobSystem.hpp"
 #include "ISceneManager.hpp"
 
 namespace My {
@@ -49,6 +52,7 @@ class BaseApplication : _implements_ IApplication {
     void RegisterManagerModule(IAnimationManager* mgr);
     void RegisterManagerModule(IPhysicsManager* mgr);
     void RegisterManagerModule(IPipelineStateManager* mgr);
+    void RegisterManagerModule(IAudioManager* mgr);
     void RegisterManagerModule(IGameLogic* logic);
 #ifdef DEBUG
     void RegisterManagerModule(IDebugManager* mgr);
@@ -64,10 +68,25 @@ class BaseApplication : _implements_ IApplication {
     IPipelineStateManager* GetPipelineStateManager() {
         return m_pPipelineStateManager;
     }
+    IAudioManager* GetAudioManager() { return m_pAudioManager; }
     IGameLogic* GetGameLogic() { return m_pGameLogic; }
 #ifdef DEBUG
     IDebugManager* GetDebugManager() { return m_pDebugManager; }
 #endif
+    // the registered modules in the order they tick, also the names of the
+    // profiler zones around their Tick()
+    [[nodiscard]] std::vector<const char*> GetModuleNames() const;
+
+    // shared by all the modules, valid between Initialize() and Finalize()
+    JobSystem* GetJobSystem() { return m_pJobSystem.get(); }
+
+    // When enabled, frame N + 1 is simulated on the job system while frame
+    // N is rendered on the calling thread. On by default, disable it to tick
+    // the modules one after another, e.g. when debugging.
+    void SetPipelinedFrameLoop(bool enable) { m_bPipelinedFrameLoop = enable; }
+    [[nodiscard]] bool IsPipelinedFrameLoop() const {
+        return m_bPipelinedFrameLoop;
+    }
 
    protected:
     // Flag if need quit the main loop of the application
@@ -84,12 +103,24 @@ class BaseApplication : _implements_ IApplication {
     IAnimationManager* m_pAnimationManager = nullptr;
     IPhysicsManager* m_pPhysicsManager = nullptr;
     IPipelineStateManager* m_pPipelineStateManager = nullptr;
+    IAudioManager* m_pAudioManager = nullptr;
     IGameLogic* m_pGameLogic = nullptr;
 #ifdef DEBUG
     IDebugManager* m_pDebugManager = nullptr;
 #endif
 
+    std::unique_ptr<JobSystem> m_pJobSystem;
+    bool m_bPipelinedFrameLoop = true;
+
+   private:
+    void tickSerial();
+
    private:
-    std::vector<IRuntimeModule*> runtime_modules;
+    struct RuntimeModule {
+        IRuntimeModule* module;
+        // of its role, the profiler zone around its Tick()
+        const char* name;
+    };
+    std::vector<RuntimeModule> runtime_modules;
 };
 }  // namespace My
@@ -5,12 +5,16 @@
 
 #include "BRDFIntegrator.hpp"
 #include "BaseApplication.hpp"
+#include "MeshSimplifier.hpp"
+#include "Meshlet.hpp"
 #include "SceneManager.hpp"
 
 #include "ForwardGeometryPass.hpp"
 #include "ShadowMapPass.hpp"
 #include "OverlayPass.hpp"
 
+#include "Profiler.hpp"
+
 #include "imgui.h"
 
 using namespace My;
@@ -60,12 +64,20 @@ void GraphicsManager::Finalize() {
 }
 
 void GraphicsManager::Tick() {
+    if (!SyncScene()) return;  // scene is not loaded yet
+
+    CaptureSnapshot();
+    PublishSnapshot();
+    RenderFrame();
+}
+
+bool GraphicsManager::SyncScene() {
     auto pSceneManager =
         dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
 
     if (pSceneManager) {
         auto rev = pSceneManager->GetSceneRevision();
-        if (rev == 0) return;  // scene is not loaded yet
+        if (rev == 0) return false;  // scene is not loaded yet
         assert(m_nSceneRevision <= rev);
         if (m_nSceneRevision < rev) {
             EndScene();
@@ -80,7 +92,24 @@ void GraphicsManager::Tick() {
         }
     }
 
-    UpdateConstants();
+    // ResizeCanvas() runs on this thread, CaptureSnapshot() may not
+    auto& snapshot = m_Snapshots[m_nRenderSnapshot ^ 1];
+    snapshot.canvasWidth = m_canvasWidth;
+    snapshot.canvasHeight = m_canvasHeight;
+
+    return true;
+}
+
+bool GraphicsManager::IsSnapshotReady() const {
+    const auto& snapshot = m_Snapshots[m_nRenderSnapshot];
+    return snapshot.frameNumber != 0 &&
+           snapshot.sceneRevision == m_nSceneRevision;
+}
+
+void GraphicsManager::PublishSnapshot() { m_nRenderSnapshot ^= 1; }
+
+void GraphicsManager::RenderFrame() {
+    ApplySnapshot(m_Snapshots[m_nRenderSnapshot]);
 
     BeginFrame(m_Frames[m_nFrameIndex]);
     ImGui::NewFrame();
@@ -89,7 +118,10 @@ void GraphicsManager::Tick() {
     ImGui::Render();
     EndFrame(m_Frames[m_nFrameIndex]);
 
-    Present();
+    {
+        PROFILE_SCOPE("Present");
+        Present();
+    }
 
     ImGuiIO& io = ImGui::GetIO();
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -174,71 +206,152 @@ void GraphicsManager::ResizeCanvas(int32_t width, int32_t height) {
     }
 }
 
-void GraphicsManager::UpdateConstants() {
-    // update scene object position
+// batch contexts updated by one job, small enough to keep all the cores
+// busy and large enough to amortize the scheduling cost
+static const size_t kBatchesPerJob = 128;
+
+void GraphicsManager::CaptureSnapshot() {
+    auto& snapshot = m_Snapshots[m_nRenderSnapshot ^ 1];
+
+    // the batch contexts are shared by all the frames and only change in
+    // SyncScene(), so frame 0 can be read while another frame is rendered
+    const auto& batchContexts = m_Frames[0].batchContexts;
+    const size_t batch_count = batchContexts.size();
+    snapshot.modelMatrices.resize(batch_count);
+
+    // gather the lights first, so that each of them could be set up
+    // independently
+    PrepareLights(snapshot);
+    const size_t light_count = m_ActiveLights.size();
+
+    // the physics manager has published all its bodies once for the step
+    PhysicsTransforms transforms;
+    if (auto pPhysicsManager =
+            dynamic_cast<BaseApplication*>(m_pApp)->GetPhysicsManager()) {
+        transforms = pPhysicsManager->GetRigidBodyTransforms();
+    }
+
+    auto pJobSystem = dynamic_cast<BaseApplication*>(m_pApp)->GetJobSystem();
+
+    if (!pJobSystem) {
+        UpdateModelMatrices(snapshot, transforms, 0, batch_count);
+        CalculateCameraMatrix(snapshot);
+        CalculateLights(snapshot, 0, light_count);
+    } else {
+        // model matrices, camera and lights do not depend on each other
+        auto model_matrices = pJobSystem->ScheduleParallelFor(
+            0, batch_count, kBatchesPerJob,
+            [this, &snapshot, &transforms](size_t begin, size_t end) {
+                UpdateModelMatrices(snapshot, transforms, begin, end);
+            });
+
+        auto camera = pJobSystem->Schedule(
+            [this, &snapshot] { CalculateCameraMatrix(snapshot); });
+
+        auto lights = pJobSystem->ScheduleParallelFor(
+            0, light_count, 1, [this, &snapshot](size_t begin, size_t end) {
+                CalculateLights(snapshot, begin, end);
+            });
+
+        pJobSystem->Wait(model_matrices);
+        pJobSystem->Wait(camera);
+        pJobSystem->Wait(lights);
+    }
+
+    snapshot.sceneRevision = m_nSceneRevision;
+    snapshot.frameNumber = ++m_nCapturedFrameCount;
+}
+
+void GraphicsManager::ApplySnapshot(const RenderSnapshot& snapshot) {
     auto& frame = m_Frames[m_nFrameIndex];
+    const size_t batch_count = frame.batchContexts.size();
+    assert(snapshot.modelMatrices.size() == batch_count);
+
+    static_cast<PerFrameConstants&>(frame.frameContext) =
+        snapshot.frameConstants;
+    memcpy(frame.lightInfo.lights, snapshot.lightInfo.lights,
+           sizeof(Light) * snapshot.frameConstants.numLights);
+
+    // LOD selection and cluster culling only depend on the batch itself and
+    // the camera, so each range is done in one go
+    auto update_batches = [this, &snapshot](size_t begin, size_t end) {
+        auto& frame = m_Frames[m_nFrameIndex];
+        for (size_t n = begin; n < end; n++) {
+            frame.batchContexts[n]->modelMatrix = snapshot.modelMatrices[n];
+        }
+        SelectLods(begin, end);
+        CullClusters(begin, end);
+    };
 
-    for (auto& pDbc : frame.batchContexts) {
-        if (void* rigidBody = pDbc->node->RigidBody()) {
-            Matrix4X4f trans;
-            BuildIdentityMatrix(trans);
-
-            // the geometry has rigid body bounded, we blend the simlation
-            // result here.
-            auto pPhysicsManager =
-                dynamic_cast<BaseApplication*>(m_pApp)->GetPhysicsManager();
-
-            if (pPhysicsManager) {
-                Matrix4X4f simulated_result =
-                    dynamic_cast<BaseApplication*>(m_pApp)
-                        ->GetPhysicsManager()
-                        ->GetRigidBodyTransform(rigidBody);
-
-                // apply the rotation part of the simlation result
-                memcpy(trans[0], simulated_result[0], sizeof(float) * 3);
-                memcpy(trans[1], simulated_result[1], sizeof(float) * 3);
-                memcpy(trans[2], simulated_result[2], sizeof(float) * 3);
-
-                // replace the translation part of the matrix with simlation
-                // result directly
-                memcpy(trans[3], simulated_result[3], sizeof(float) * 3);
-            }
+    auto pJobSystem = dynamic_cast<BaseApplication*>(m_pApp)->GetJobSystem();
+
+    if (!pJobSystem) {
+        update_batches(0, batch_count);
+    } else {
+        pJobSystem->ParallelFor(0, batch_count, kBatchesPerJob,
+                                update_batches);
+    }
+}
 
-            pDbc->modelMatrix = trans;
+void GraphicsManager::UpdateModelMatrices(RenderSnapshot& snapshot,
+                                          const PhysicsTransforms& transforms,
+                                          size_t begin, size_t end) {
+    // update scene object position
+    const auto& batchContexts = m_Frames[0].batchContexts;
+
+    for (size_t i = begin; i < end; i++) {
+        const auto& node = *batchContexts[i]->node;
+        const uint32_t handle = node.RigidBodyHandle();
+        // the geometry has rigid body bounded, the simulation result
+        // replaces its transform
+        if (node.RigidBody() && handle < transforms.count) {
+            snapshot.modelMatrices[i] = transforms.transforms[handle];
         } else {
-            pDbc->modelMatrix = *pDbc->node->GetCalculatedTransform();
+            snapshot.modelMatrices[i] = *node.GetCalculatedTransform();
         }
     }
-
-    // Generate the view matrix based on the camera's position.
-    CalculateCameraMatrix();
-    CalculateLights();
 }
 
 void GraphicsManager::Draw() {
     auto& frame = m_Frames[m_nFrameIndex];
 
     for (auto& pDispatchPass : m_DispatchPasses) {
-        pDispatchPass->BeginPass(frame);
-        pDispatchPass->Dispatch(frame);
+        PROFILE_SCOPE(pDispatchPass->GetName());
+        {
+            PROFILE_SCOPE("BeginPass");
+            pDispatchPass->BeginPass(frame);
+        }
+        {
+            PROFILE_SCOPE("Dispatch");
+            pDispatchPass->Dispatch(frame);
+        }
+        PROFILE_SCOPE("EndPass");
         pDispatchPass->EndPass(frame);
     }
 
     for (auto& pDrawPass : m_DrawPasses) {
-        pDrawPass->BeginPass(frame);
-        pDrawPass->Draw(frame);
+        PROFILE_SCOPE(pDrawPass->GetName());
+        {
+            PROFILE_SCOPE("BeginPass");
+            pDrawPass->BeginPass(frame);
+        }
+        {
+            PROFILE_SCOPE("Draw");
+            pDrawPass->Draw(frame);
+        }
+        PROFILE_SCOPE("EndPass");
         pDrawPass->EndPass(frame);
     }
 }
 
-void GraphicsManager::CalculateCameraMatrix() {
+void GraphicsManager::CalculateCameraMatrix(RenderSnapshot& snapshot) {
     auto pSceneManager =
         dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
 
     if (pSceneManager) {
         auto& scene = pSceneManager->GetSceneForRendering();
         auto pCameraNode = scene->GetFirstCameraNode();
-        DrawFrameContext& frameContext = m_Frames[m_nFrameIndex].frameContext;
+        PerFrameConstants& frameContext = snapshot.frameConstants;
         if (pCameraNode) {
             auto transform = *pCameraNode->GetCalculatedTransform();
             Vector3f position =
@@ -253,6 +366,8 @@ void GraphicsManager::CalculateCameraMatrix() {
             Vector3f position = {0.0f, -5.0f, 0.0f},
                      lookAt = {0.0f, 0.0f, 0.0f}, up = {0.0f, 0.0f, 1.0f};
             BuildViewRHMatrix(frameContext.viewMatrix, position, lookAt, up);
+
+            frameContext.camPos = {position[0], position[1], position[2], 0.0f};
         }
 
         float fieldOfView = PI / 3.0f;
@@ -270,7 +385,8 @@ void GraphicsManager::CalculateCameraMatrix() {
         }
 
 
-        float screenAspect = (float)m_canvasWidth / (float)m_canvasHeight;
+        float screenAspect =
+            (float)snapshot.canvasWidth / (float)snapshot.canvasHeight;
 
         assert(m_pApp);
         const GfxConfiguration& conf = m_pApp->GetConfiguration();
@@ -288,11 +404,92 @@ void GraphicsManager::CalculateCameraMatrix() {
     }
 }
 
-void GraphicsManager::CalculateLights() {
-    DrawFrameContext& frameContext = m_Frames[m_nFrameIndex].frameContext;
-    auto& light_info = m_Frames[m_nFrameIndex].lightInfo;
+void GraphicsManager::SelectLods(size_t begin, size_t end) {
+    auto& frame = m_Frames[m_nFrameIndex];
+    const DrawFrameContext& frameContext = frame.frameContext;
+    const GfxConfiguration& conf = m_pApp->GetConfiguration();
+
+    // projectionMatrix[1][1] is cot(fov / 2) for both clip space conventions
+    const float fov = 2.0f * atan(1.0f / frameContext.projectionMatrix[1][1]);
+    const Vector3f camera_position = {frameContext.camPos[0],
+                                      frameContext.camPos[1],
+                                      frameContext.camPos[2]};
+
+    for (size_t n = begin; n < end; n++) {
+        auto& pDbc = frame.batchContexts[n];
+        const auto lod_count = static_cast<uint32_t>(pDbc->lodErrors.size());
+        if (lod_count <= 1) continue;
+
+        const auto& model = pDbc->modelMatrix;
+        Vector4f center = {pDbc->boundingBox.centroid[0],
+                           pDbc->boundingBox.centroid[1],
+                           pDbc->boundingBox.centroid[2], 1.0f};
+        Transform(center, model);
+
+        // errors and bounds are in object space, so take the largest scale
+        // of the model matrix into account
+        float scale = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            scale = max(scale, Length(Vector3f({model[i][0], model[i][1],
+                                                model[i][2]})));
+        }
+
+        const float radius = Length(pDbc->boundingBox.extent) * scale;
+        const float distance =
+            Length(Vector3f({center[0], center[1], center[2]}) -
+                   camera_position) -
+            radius;
+
+        float lod_errors[GfxConfiguration::kMaxLodCount];
+        const uint32_t count = (lod_count < GfxConfiguration::kMaxLodCount)
+                                   ? lod_count
+                                   : GfxConfiguration::kMaxLodCount;
+        for (uint32_t i = 0; i < count; i++) {
+            lod_errors[i] = pDbc->lodErrors[i] * scale;
+        }
+
+        pDbc->lod = SelectLodByScreenSpaceError(
+            lod_errors, count, distance, fov, static_cast<float>(m_canvasHeight),
+            conf.lodPixelError);
+    }
+}
+
+void GraphicsManager::CullClusters(size_t begin, size_t end) {
+    auto& frame = m_Frames[m_nFrameIndex];
+    const DrawFrameContext& frameContext = frame.frameContext;
+    const GfxConfiguration& conf = m_pApp->GetConfiguration();
+
+    const Matrix4X4f view_projection =
+        frameContext.viewMatrix * frameContext.projectionMatrix;
+
+    for (size_t n = begin; n < end; n++) {
+        auto& pDbc = frame.batchContexts[n];
+        pDbc->clustersCulled = false;
+        if (!pDbc->meshlets || pDbc->lod != 0) continue;
 
-    frameContext.numLights = 0;
+        // cull in object space, so meshlet bounds can be used as they are
+        Matrix4X4f inverse_model = pDbc->modelMatrix;
+        if (!InverseMatrix4X4f(inverse_model)) continue;
+
+        Vector4f camera = {frameContext.camPos[0], frameContext.camPos[1],
+                           frameContext.camPos[2], 1.0f};
+        Transform(camera, inverse_model);
+
+        const Frustumf frustum(pDbc->modelMatrix * view_projection,
+                               !conf.fixOpenGLPerspectiveMatrix);
+
+        pDbc->visibleRanges.clear();
+        CullMeshlets(pDbc->visibleRanges, pDbc->meshlets->ranges,
+                     pDbc->meshlets->bounds, frustum,
+                     Vector3f({camera[0], camera[1], camera[2]}));
+        pDbc->clustersCulled = true;
+    }
+}
+
+void GraphicsManager::PrepareLights(RenderSnapshot& snapshot) {
+    PerFrameConstants& frameContext = snapshot.frameConstants;
+
+    m_ActiveLights.clear();
 
     auto pSceneManager =
         dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
@@ -308,9 +505,35 @@ void GraphicsManager::CalculateLights() {
     if (pSceneManager) {
         auto& scene = pSceneManager->GetSceneForRendering();
         for (const auto& LightNode : scene->LightNodes) {
-            Light& light = light_info.lights[frameContext.numLights];
+            if (m_ActiveLights.size() == MAX_LIGHTS) break;
             auto pLightNode = LightNode.second.lock();
             if (!pLightNode) continue;
+            auto pLight = scene->GetLight(pLightNode->GetSceneObjectRef());
+            if (!pLight) {
+                assert(0);
+                continue;
+            }
+            m_ActiveLights.emplace_back(pLightNode, pLight);
+        }
+    }
+
+    frameContext.numLights = static_cast<int32_t>(m_ActiveLights.size());
+}
+
+void GraphicsManager::CalculateLights(RenderSnapshot& snapshot, size_t begin,
+                                      size_t end) {
+    auto& light_info = snapshot.lightInfo;
+
+    auto pSceneManager =
+        dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
+
+    const GfxConfiguration& conf = m_pApp->GetConfiguration();
+
+    if (pSceneManager) {
+        auto& scene = pSceneManager->GetSceneForRendering();
+        for (size_t n = begin; n < end; n++) {
+            Light& light = light_info.lights[n];
+            const auto& pLightNode = m_ActiveLights[n].first;
             auto trans_ptr = pLightNode->GetCalculatedTransform();
             light.lightPosition = {0.0f, 0.0f, 0.0f, 1.0f};
             light.lightDirection = {0.0f, 0.0f, -1.0f, 0.0f};
@@ -318,160 +541,157 @@ void GraphicsManager::CalculateLights() {
             Transform(light.lightDirection, *trans_ptr);
             Normalize(light.lightDirection);
 
-            auto pLight = scene->GetLight(pLightNode->GetSceneObjectRef());
-            if (pLight) {
-                light.lightGuid = pLight->GetGuid();
-                light.lightColor = pLight->GetColor().Value;
-                light.lightIntensity = pLight->GetIntensity();
-                light.lightCastShadow = pLight->GetIfCastShadow();
-                const AttenCurve& atten_curve =
-                    pLight->GetDistanceAttenuation();
-                light.lightDistAttenCurveType = atten_curve.type;
-                memcpy(light.lightDistAttenCurveParams, &atten_curve.u,
-                       sizeof(atten_curve.u));
-                light.lightAngleAttenCurveType = AttenCurveType::kNone;
-
-                Matrix4X4f view;
-                Matrix4X4f projection;
-                BuildIdentityMatrix(projection);
-
-                float nearClipDistance = 1.0f;
-                float farClipDistance = 1000.0f;
+            const auto& pLight = m_ActiveLights[n].second;
+            light.lightGuid = pLight->GetGuid();
+            light.lightColor = pLight->GetColor().Value;
+            light.lightIntensity = pLight->GetIntensity();
+            light.lightCastShadow = pLight->GetIfCastShadow();
+            const AttenCurve& atten_curve =
+                pLight->GetDistanceAttenuation();
+            light.lightDistAttenCurveType = atten_curve.type;
+            memcpy(light.lightDistAttenCurveParams, &atten_curve.u,
+                   sizeof(atten_curve.u));
+            light.lightAngleAttenCurveType = AttenCurveType::kNone;
+
+            Matrix4X4f view;
+            Matrix4X4f projection;
+            BuildIdentityMatrix(projection);
+
+            float nearClipDistance = 1.0f;
+            float farClipDistance = 1000.0f;
+
+            if (pLight->GetType() ==
+                SceneObjectType::kSceneObjectTypeLightInfi) {
+                light.lightType = LightType::Infinity;
+
+                Vector4f target = {0.0f, 0.0f, 0.0f, 1.0f};
+
+                auto pCameraNode = scene->GetFirstCameraNode();
+                if (pCameraNode) {
+                    auto pCamera =
+                        scene->GetCamera(pCameraNode->GetSceneObjectRef());
+                    nearClipDistance = pCamera->GetNearClipDistance();
+                    farClipDistance = pCamera->GetFarClipDistance();
+
+                    target[2] = -(0.75f * nearClipDistance +
+                                  0.25f * farClipDistance);
+
+                    // calculate the camera target position
+                    auto trans_ptr = pCameraNode->GetCalculatedTransform();
+                    Transform(target, *trans_ptr);
+                }
 
-                if (pLight->GetType() ==
-                    SceneObjectType::kSceneObjectTypeLightInfi) {
-                    light.lightType = LightType::Infinity;
+                light.lightPosition =
+                    target - light.lightDirection * farClipDistance;
+                Vector3f position;
+                position.Set((float*)light.lightPosition);
+                Vector3f lookAt;
+                lookAt.Set((float*)target);
+                Vector3f up = {0.0f, 0.0f, 1.0f};
+                if (abs(light.lightDirection[0]) <= 0.2f &&
+                    abs(light.lightDirection[1]) <= 0.2f) {
+                    up = {0.1f, 0.1f, 1.0f};
+                }
+                BuildViewRHMatrix(view, position, lookAt, up);
 
-                    Vector4f target = {0.0f, 0.0f, 0.0f, 1.0f};
+                float sm_half_dist = min(farClipDistance * 0.25f, 800.0f);
 
-                    auto pCameraNode = scene->GetFirstCameraNode();
-                    if (pCameraNode) {
-                        auto pCamera =
-                            scene->GetCamera(pCameraNode->GetSceneObjectRef());
-                        nearClipDistance = pCamera->GetNearClipDistance();
-                        farClipDistance = pCamera->GetFarClipDistance();
+                if (conf.fixOpenGLPerspectiveMatrix) {
+                    BuildOpenglOrthographicRHMatrix(projection, -sm_half_dist,
+                                            sm_half_dist, sm_half_dist,
+                                            -sm_half_dist, nearClipDistance,
+                                            farClipDistance + sm_half_dist);
+                } else {
+                    BuildOrthographicRHMatrix(projection, -sm_half_dist,
+                                            sm_half_dist, sm_half_dist,
+                                            -sm_half_dist, nearClipDistance,
+                                            farClipDistance + sm_half_dist);
 
-                        target[2] = -(0.75f * nearClipDistance +
-                                      0.25f * farClipDistance);
+                }
 
-                        // calculate the camera target position
-                        auto trans_ptr = pCameraNode->GetCalculatedTransform();
-                        Transform(target, *trans_ptr);
-                    }
+                // notify shader about the infinity light by setting 4th
+                // field to 0
+                light.lightPosition[3] = 0.0f;
+            } else {
+                Vector3f position;
+                position.Set(light.lightPosition);
+                Vector4f tmp = light.lightPosition + light.lightDirection;
+                Vector3f lookAt;
+                lookAt.Set(tmp);
+                Vector3f up = {0.0f, 0.0f, 1.0f};
+                if (abs(light.lightDirection[0]) <= 0.1f &&
+                    abs(light.lightDirection[1]) <= 0.1f) {
+                    up = {0.0f, 0.707f, 0.707f};
+                }
+                BuildViewRHMatrix(view, position, lookAt, up);
 
-                    light.lightPosition =
-                        target - light.lightDirection * farClipDistance;
-                    Vector3f position;
-                    position.Set((float*)light.lightPosition);
-                    Vector3f lookAt;
-                    lookAt.Set((float*)target);
-                    Vector3f up = {0.0f, 0.0f, 1.0f};
-                    if (abs(light.lightDirection[0]) <= 0.2f &&
-                        abs(light.lightDirection[1]) <= 0.2f) {
-                        up = {0.1f, 0.1f, 1.0f};
+                if (pLight->GetType() ==
+                    SceneObjectType::kSceneObjectTypeLightSpot) {
+                    light.lightType = LightType::Spot;
+
+                    auto plight =
+                        dynamic_pointer_cast<SceneObjectSpotLight>(pLight);
+                    const AttenCurve& angle_atten_curve =
+                        plight->GetAngleAttenuation();
+                    light.lightAngleAttenCurveType = angle_atten_curve.type;
+                    memcpy(light.lightAngleAttenCurveParams,
+                           &angle_atten_curve.u,
+                           sizeof(angle_atten_curve.u));
+
+                    float fieldOfView =
+                        light.lightAngleAttenCurveParams[0][1] * 2.0f;
+                    float screenAspect = 1.0f;
+
+                    // Build the perspective projection matrix.
+                    if (conf.fixOpenGLPerspectiveMatrix) {
+                        BuildOpenglPerspectiveFovRHMatrix(
+                            projection, fieldOfView, screenAspect,
+                            nearClipDistance, farClipDistance);
+                    } else {
+                        BuildPerspectiveFovRHMatrix(projection,
+                                                    fieldOfView, screenAspect,
+                                                    nearClipDistance, farClipDistance);
                     }
-                    BuildViewRHMatrix(view, position, lookAt, up);
+                } else if (pLight->GetType() ==
+                           SceneObjectType::kSceneObjectTypeLightArea) {
+                    light.lightType = LightType::Area;
 
-                    float sm_half_dist = min(farClipDistance * 0.25f, 800.0f);
+                    auto plight =
+                        dynamic_pointer_cast<SceneObjectAreaLight>(pLight);
+                    light.lightSize = plight->GetDimension();
+                } else  // omni light
+                {
+                    light.lightType = LightType::Omni;
 
-                    if (conf.fixOpenGLPerspectiveMatrix) {
-                        BuildOpenglOrthographicRHMatrix(projection, -sm_half_dist,
-                                                sm_half_dist, sm_half_dist,
-                                                -sm_half_dist, nearClipDistance,
-                                                farClipDistance + sm_half_dist);
-                    } else {
-                        BuildOrthographicRHMatrix(projection, -sm_half_dist,
-                                                sm_half_dist, sm_half_dist,
-                                                -sm_half_dist, nearClipDistance,
-                                                farClipDistance + sm_half_dist);
+                    // auto plight =
+                    // dynamic_pointer_cast<SceneObjectOmniLight>(pLight);
 
-                    }
+                    float fieldOfView =
+                        PI / 2.0f;  // 90 degree for each cube map face
+                    float screenAspect = 1.0f;
 
-                    // notify shader about the infinity light by setting 4th
-                    // field to 0
-                    light.lightPosition[3] = 0.0f;
-                } else {
-                    Vector3f position;
-                    position.Set(light.lightPosition);
-                    Vector4f tmp = light.lightPosition + light.lightDirection;
-                    Vector3f lookAt;
-                    lookAt.Set(tmp);
-                    Vector3f up = {0.0f, 0.0f, 1.0f};
-                    if (abs(light.lightDirection[0]) <= 0.1f &&
-                        abs(light.lightDirection[1]) <= 0.1f) {
-                        up = {0.0f, 0.707f, 0.707f};
-                    }
-                    BuildViewRHMatrix(view, position, lookAt, up);
-
-                    if (pLight->GetType() ==
-                        SceneObjectType::kSceneObjectTypeLightSpot) {
-                        light.lightType = LightType::Spot;
-
-                        auto plight =
-                            dynamic_pointer_cast<SceneObjectSpotLight>(pLight);
-                        const AttenCurve& angle_atten_curve =
-                            plight->GetAngleAttenuation();
-                        light.lightAngleAttenCurveType = angle_atten_curve.type;
-                        memcpy(light.lightAngleAttenCurveParams,
-                               &angle_atten_curve.u,
-                               sizeof(angle_atten_curve.u));
-
-                        float fieldOfView =
-                            light.lightAngleAttenCurveParams[0][1] * 2.0f;
-                        float screenAspect = 1.0f;
-
-                        // Build the perspective projection matrix.
-                        if (conf.fixOpenGLPerspectiveMatrix) {
-                            BuildOpenglPerspectiveFovRHMatrix(
-                                projection, fieldOfView, screenAspect,
-                                nearClipDistance, farClipDistance);
-                        } else {
-                            BuildPerspectiveFovRHMatrix(projection,
-                                                        fieldOfView, screenAspect,
-                                                        nearClipDistance, farClipDistance);
-                        }
-                    } else if (pLight->GetType() ==
-                               SceneObjectType::kSceneObjectTypeLightArea) {
-                        light.lightType = LightType::Area;
-
-                        auto plight =
-                            dynamic_pointer_cast<SceneObjectAreaLight>(pLight);
-                        light.lightSize = plight->GetDimension();
-                    } else  // omni light
-                    {
-                        light.lightType = LightType::Omni;
-
-                        // auto plight =
-                        // dynamic_pointer_cast<SceneObjectOmniLight>(pLight);
-
-                        float fieldOfView =
-                            PI / 2.0f;  // 90 degree for each cube map face
-                        float screenAspect = 1.0f;
-
-                        // Build the perspective projection matrix.
-                        if (conf.fixOpenGLPerspectiveMatrix) {
-                            BuildOpenglPerspectiveFovRHMatrix(
-                                projection, fieldOfView, screenAspect,
-                                nearClipDistance, farClipDistance);
-                        } else {
-                            BuildPerspectiveFovRHMatrix(projection,
-                                                        fieldOfView, screenAspect,
-                                                        nearClipDistance, farClipDistance);
-                        }
+                    // Build the perspective projection matrix.
+                    if (conf.fixOpenGLPerspectiveMatrix) {
+                        BuildOpenglPerspectiveFovRHMatrix(
+                            projection, fieldOfView, screenAspect,
+                            nearClipDistance, farClipDistance);
+                    } else {
+                        BuildPerspectiveFovRHMatrix(projection,
+                                                    fieldOfView, screenAspect,
+                                                    nearClipDistance, farClipDistance);
                     }
                 }
-
-                light.lightViewMatrix = view;
-                light.lightProjectionMatrix = projection;
-                frameContext.numLights++;
-            } else {
-                assert(0);
             }
+
+            light.lightViewMatrix = view;
+            light.lightProjectionMatrix = projection;
         }
     }
 }
 
 void GraphicsManager::BeginScene(const Scene& scene) {
+    PROFILE_SCOPE("GraphicsManager::BeginScene");
+
     // first, call init passes on frame 0
     for (const auto& pPass : m_InitPasses) {
         pPass->BeginPass(m_Frames[0]);
@@ -11,6 +11,7 @@
 #include "IDispatchPass.hpp"
 #include "IDrawPass.hpp"
 #include "IGraphicsManager.hpp"
+#include "IPhysicsManager.hpp"
 #include "Polyhedron.hpp"
 #include "Scene.hpp"
 #include "cbuffer.h"
@@ -26,6 +27,12 @@ class GraphicsManager : _implements_ IGraphicsManager {
 
     void Tick() override;
 
+    bool SyncScene() override;
+    [[nodiscard]] bool IsSnapshotReady() const override;
+    void CaptureSnapshot() override;
+    void PublishSnapshot() override;
+    void RenderFrame() override;
+
     void Draw() override;
     void Present() override {}
 
@@ -87,10 +94,20 @@ class GraphicsManager : _implements_ IGraphicsManager {
 
    private:
     void InitConstants() {}
-    void CalculateCameraMatrix();
-    void CalculateLights();
+    void CalculateCameraMatrix(RenderSnapshot& snapshot);
+    void PrepareLights(RenderSnapshot& snapshot);
+
+    // the stages below work on a range of batch contexts or lights, so that
+    // they could be split into jobs
+    void UpdateModelMatrices(RenderSnapshot& snapshot,
+                             const PhysicsTransforms& transforms,
+                             size_t begin, size_t end);
+    void CalculateLights(RenderSnapshot& snapshot, size_t begin, size_t end);
+    void SelectLods(size_t begin, size_t end);
+    void CullClusters(size_t begin, size_t end);
 
-    void UpdateConstants();
+    // copy the snapshot into the current frame, then select LODs and cull
+    void ApplySnapshot(const RenderSnapshot& snapshot);
 
    protected:
     uint64_t m_nSceneRevision{0};
@@ -112,5 +129,15 @@ class GraphicsManager : _implements_ IGraphicsManager {
 
    private:
     bool m_bInitialize = false;
+
+    // lights set up in the current frame, gathered by PrepareLights()
+    std::vector<std::pair<std::shared_ptr<SceneLightNode>,
+                          std::shared_ptr<SceneObjectLight>>>
+        m_ActiveLights;
+
+    // one snapshot is read by the renderer while the other one is captured
+    std::array<RenderSnapshot, 2> m_Snapshots;
+    uint32_t m_nRenderSnapshot{0};
+    uint64_t m_nCapturedFrameCount{0};
 };
 }  // namespace My
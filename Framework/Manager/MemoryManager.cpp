@@ -26,17 +26,17 @@ int MemoryManager::Initialize() { return 0; }
 void MemoryManager::Finalize() { assert(m_mapMemoryAllocationInfo.empty()); }
 
 void MemoryManager::Tick() {
-#if DEBUG
-    static int count = 0;
-
-    if (count++ == 3600) {
-        for (auto info : m_mapMemoryAllocationInfo) {
-            cerr << info.first << '\t';
-            cerr << info.second.PageMemoryType;
-            cerr << info.second.PageSize;
+    for (size_t i = 0; i < kMemoryTagCount; i++) {
+        const auto tag = static_cast<MemoryTag>(i);
+        const bool over = MemoryTracker::IsOverBudget(tag);
+        if (over && !m_bOverBudget[i]) {
+            const auto stats = MemoryTracker::GetStats(tag);
+            cerr << "[MemoryManager] " << GetMemoryTagName(tag)
+                 << " over budget: " << stats.frameHighWater << " of "
+                 << stats.budget << " bytes" << endl;
         }
+        m_bOverBudget[i] = over;
     }
-#endif
 }
 
 void* MemoryManager::AllocatePage(size_t size) {
@@ -44,16 +44,20 @@ void* MemoryManager::AllocatePage(size_t size) {
 
     p = static_cast<uint8_t*>(malloc(size));
     if (p) {
-        MemoryAllocationInfo info = {size, MemoryType::CPU};
+        MemoryAllocationInfo info = {size, MemoryType::CPU,
+                                     MemoryTagScope::GetCurrentTag()};
         m_mapMemoryAllocationInfo.insert({p, info});
+        MemoryTracker::RecordAllocation(info.PageTag, size);
     }
 
     return static_cast<void*>(p);
 }
 
 void MemoryManager::FreePage(void* p) {
-    if (m_mapMemoryAllocationInfo.contains(p)) {
-        m_mapMemoryAllocationInfo.erase(p);
+    auto it = m_mapMemoryAllocationInfo.find(p);
+    if (it != m_mapMemoryAllocationInfo.end()) {
+        MemoryTracker::RecordFree(it->second.PageTag, it->second.PageSize);
+        m_mapMemoryAllocationInfo.erase(it);
         free(p);
     }
 }
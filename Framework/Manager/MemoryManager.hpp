@@ -4,6 +4,7 @@
 #include <ostream>
 
 #include "IMemoryManager.hpp"
+#include "MemoryTracker.hpp"
 #include "portable.hpp"
 
 namespace My {
@@ -25,8 +26,12 @@ class MemoryManager : _implements_ IMemoryManager {
     struct MemoryAllocationInfo {
         size_t PageSize;
         MemoryType PageMemoryType;
+        MemoryTag PageTag;
     };
 
     std::map<void*, MemoryAllocationInfo> m_mapMemoryAllocationInfo;
+
+    // tags over budget in the last frame, to only warn as they go over
+    bool m_bOverBudget[kMemoryTagCount]{};
 };
 }  // namespace My
@@ -20,8 +20,27 @@ _Interface_ PhysicsManager : _implements_ IPhysicsManager {
     void ClearRigidBodies() override {}
 
     Matrix4X4f GetRigidBodyTransform(void* rigidBody) override { return Matrix4X4f(); }
+    PhysicsTransforms GetRigidBodyTransforms() override { return {}; }
     void UpdateRigidBodyTransform(SceneGeometryNode & node) override {}
 
     void ApplyCentralForce(void* rigidBody, Vector3f force) override {}
+
+    void SetFixedFrameTime(float frame_time) override {}
+    size_t GetContactCount() override { return 0; }
+
+    // nothing to hit
+    void CastRays(const PhysicsRay* rays, size_t count,
+                  PhysicsQueryHit* hits) override {
+        for (size_t i = 0; i < count; i++) hits[i].rigidBody = nullptr;
+    }
+    void OverlapShapes(const PhysicsQueryShape* shapes, size_t count,
+                       void** rigid_bodies, uint32_t max_results,
+                       uint32_t* result_counts) override {
+        for (size_t i = 0; i < count; i++) result_counts[i] = 0;
+    }
+    void SweepShapes(const PhysicsShapeSweep* sweeps, size_t count,
+                     PhysicsQueryHit* hits) override {
+        for (size_t i = 0; i < count; i++) hits[i].rigidBody = nullptr;
+    }
 };
 }  // namespace My
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include "AssetLoader.hpp"
 #include "BaseApplication.hpp"
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
 
 using namespace My;
 using namespace std;
@@ -33,6 +35,9 @@ int SceneManager::LoadScene(const char* scene_file_name) {
 void SceneManager::ResetScene() { m_nSceneRevision++; }
 
 bool SceneManager::LoadOgexScene(const char* ogex_scene_file_name) {
+    PROFILE_SCOPE("SceneManager::LoadOgexScene");
+    // what the scene keeps is tagged where it is created
+    MemoryTagScope memory_tag(MemoryTag::kParsers);
     auto pAssetLoader = dynamic_cast<BaseApplication*>(m_pApp)->GetAssetLoader();
 
     string ogex_text =
@@ -42,12 +47,92 @@ bool SceneManager::LoadOgexScene(const char* ogex_scene_file_name) {
         return false;
     }
 
-    OgexParser ogex_parser;
-    m_pScene = ogex_parser.Parse(ogex_text);
+    {
+        PROFILE_SCOPE("OgexParser::Parse");
+        OgexParser ogex_parser;
+        m_pScene = ogex_parser.Parse(ogex_text);
+    }
+
+    if (m_pScene && m_bOptimizeMeshes) {
+        OptimizeMeshes();
+    }
+
+    if (m_pScene && m_bBuildMeshlets) {
+        BuildMeshlets();
+    }
+
+    if (m_pScene && m_nLodCount) {
+        GenerateLods();
+    }
 
     return static_cast<bool>(m_pScene);
 }
 
+void SceneManager::OptimizeMeshes() {
+    size_t triangles = 0;
+    size_t transformed_before = 0;
+    size_t transformed_after = 0;
+    size_t vertices_before = 0;
+    size_t vertices_after = 0;
+
+    for (const auto& _it : m_pScene->Geometries) {
+        const auto& pGeometry = _it.second;
+        for (size_t lod = 0;; lod++) {
+            auto pMesh = pGeometry->GetMeshLOD(lod).lock();
+            if (!pMesh) break;
+
+            auto report = pMesh->Optimize();
+            triangles += report.before.triangles_count;
+            transformed_before += report.before.vertices_transformed;
+            transformed_after += report.after.vertices_transformed;
+            vertices_before += report.vertices_before;
+            vertices_after += report.vertices_after;
+        }
+    }
+
+    if (triangles) {
+        cerr << "[SceneManager] Mesh optimization: " << triangles
+             << " triangles, vertices " << vertices_before << " -> "
+             << vertices_after << ", ACMR "
+             << static_cast<float>(transformed_before) / triangles << " -> "
+             << static_cast<float>(transformed_after) / triangles << endl;
+    }
+}
+
+void SceneManager::BuildMeshlets() {
+    size_t meshlets = 0;
+
+    for (const auto& _it : m_pScene->Geometries) {
+        const auto& pGeometry = _it.second;
+        auto pMesh = pGeometry->GetMesh().lock();
+        if (!pMesh) continue;
+
+        meshlets += pMesh->BuildMeshlets();
+    }
+
+    cerr << "[SceneManager] Built " << meshlets << " meshlets" << endl;
+}
+
+void SceneManager::GenerateLods() {
+    size_t meshes = 0;
+    size_t lods = 0;
+
+    for (const auto& _it : m_pScene->Geometries) {
+        const auto& pGeometry = _it.second;
+        // meshes already carrying authored LODs are left as they are
+        if (pGeometry->GetMeshLOD(1).lock()) continue;
+
+        auto pMesh = pGeometry->GetMesh().lock();
+        if (!pMesh) continue;
+
+        lods += pMesh->GenerateLods(m_nLodCount);
+        meshes++;
+    }
+
+    cerr << "[SceneManager] Generated " << lods << " LODs for " << meshes
+         << " meshes" << endl;
+}
+
 const std::shared_ptr<Scene> SceneManager::GetSceneForRendering() const {
     // TODO: we should perform CPU scene crop at here
     return m_pScene;
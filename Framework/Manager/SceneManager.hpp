@@ -29,11 +29,22 @@ class SceneManager : _implements_ ISceneManager {
     std::weak_ptr<SceneObjectGeometry> GetSceneGeometryObject(
         const std::string& key) const override;
 
+    void EnableMeshOptimization(bool enable) { m_bOptimizeMeshes = enable; }
+    void EnableMeshletBuilding(bool enable) { m_bBuildMeshlets = enable; }
+    // 0 disables automatic LOD generation
+    void SetLodCount(uint32_t lod_count) { m_nLodCount = lod_count; }
+
    protected:
     bool LoadOgexScene(const char* ogex_scene_file_name);
+    void OptimizeMeshes();
+    void BuildMeshlets();
+    void GenerateLods();
 
    protected:
     std::shared_ptr<Scene> m_pScene;
     uint64_t m_nSceneRevision = 0;
+    bool m_bOptimizeMeshes = true;
+    bool m_bBuildMeshlets = true;
+    uint32_t m_nLodCount = 3;
 };
 }  // namespace My
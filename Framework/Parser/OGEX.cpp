@@ -1,4 +1,5 @@
 #include "OGEX.hpp"
+#include "MemoryTracker.hpp"
 
 using namespace My;
 
@@ -45,18 +46,21 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             return;
         case OGEX::kStructureNode: {
             node =
-                std::make_shared<SceneEmptyNode>(structure.GetStructureName());
+                MakeTaggedShared<SceneEmptyNode>(
+                    MemoryTag::kSceneGraph, structure.GetStructureName());
         } break;
         case OGEX::kStructureBoneNode: {
             auto _node =
-                std::make_shared<SceneBoneNode>(structure.GetStructureName());
+                MakeTaggedShared<SceneBoneNode>(
+                    MemoryTag::kSceneGraph, structure.GetStructureName());
             std::string _key = structure.GetStructureName();
             scene.BoneNodes.emplace(_key, _node);
             node = _node;
         } break;
         case OGEX::kStructureGeometryNode: {
             std::string _key = structure.GetStructureName();
-            auto _node = std::make_shared<SceneGeometryNode>(_key);
+            auto _node = MakeTaggedShared<SceneGeometryNode>(
+                MemoryTag::kSceneGraph, _key);
             const auto& _structure =
                 dynamic_cast<const OGEX::GeometryNodeStructure&>(structure);
 
@@ -86,7 +90,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
         } break;
         case OGEX::kStructureLightNode: {
             auto _node =
-                std::make_shared<SceneLightNode>(structure.GetStructureName());
+                MakeTaggedShared<SceneLightNode>(
+                    MemoryTag::kSceneGraph, structure.GetStructureName());
             const auto& _structure =
                 dynamic_cast<const OGEX::LightNodeStructure&>(structure);
 
@@ -103,7 +108,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
         } break;
         case OGEX::kStructureCameraNode: {
             auto _node =
-                std::make_shared<SceneCameraNode>(structure.GetStructureName());
+                MakeTaggedShared<SceneCameraNode>(
+                    MemoryTag::kSceneGraph, structure.GetStructureName());
             const auto& _structure =
                 dynamic_cast<const OGEX::CameraNodeStructure&>(structure);
 
@@ -120,7 +126,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             const auto& _structure =
                 dynamic_cast<const OGEX::GeometryObjectStructure&>(structure);
             std::string _key = _structure.GetStructureName();
-            auto _object = std::make_shared<SceneObjectGeometry>();
+            auto _object = MakeTaggedShared<SceneObjectGeometry>(
+                MemoryTag::kSceneGraph);
 
             // properties
             _object->SetVisibility(_structure.GetVisibleFlag());
@@ -184,7 +191,7 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             for (int32_t i = 0; i < _count; i++) {
                 const OGEX::MeshStructure* _mesh = (*_meshs)[i];
                 std::shared_ptr<SceneObjectMesh> mesh =
-                    make_shared<SceneObjectMesh>();
+                    MakeTaggedShared<SceneObjectMesh>(MemoryTag::kMeshes);
                 const std::string _primitive_type =
                     static_cast<const char*>(_mesh->GetMeshPrimitive());
                 if (_primitive_type == "points") {
@@ -397,7 +404,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                     // ExchangeYandZ(matrix);
                 }
                 transform =
-                    std::make_shared<SceneObjectTransform>(matrix, object_flag);
+                    MakeTaggedShared<SceneObjectTransform>(
+                        MemoryTag::kSceneGraph, matrix, object_flag);
                 base_node->AppendTransform(_key, transform);
             }
         }
@@ -411,11 +419,12 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             auto kind = _structure.GetTranslationKind();
             auto data = _structure.GetTranslation();
             if (kind == "xyz") {
-                translation = std::make_shared<SceneObjectTranslation>(
-                    data[0], data[1], data[2], object_flag);
+                translation = MakeTaggedShared<SceneObjectTranslation>(
+                    MemoryTag::kSceneGraph, data[0], data[1], data[2],
+                    object_flag);
             } else {
-                translation = std::make_shared<SceneObjectTranslation>(
-                    kind[0], data[0], object_flag);
+                translation = MakeTaggedShared<SceneObjectTranslation>(
+                    MemoryTag::kSceneGraph, kind[0], data[0], object_flag);
             }
             auto _key = _structure.GetStructureName();
             base_node->AppendTransform(_key, std::move(translation));
@@ -430,20 +439,22 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             auto kind = _structure.GetRotationKind();
             auto data = _structure.GetRotation();
             if (kind == "x") {
-                rotation = std::make_shared<SceneObjectRotation>('x', data[0],
-                                                                 object_flag);
+                rotation = MakeTaggedShared<SceneObjectRotation>(
+                    MemoryTag::kSceneGraph, 'x', data[0], object_flag);
             } else if (kind == "y") {
-                rotation = std::make_shared<SceneObjectRotation>('y', data[0],
-                                                                 object_flag);
+                rotation = MakeTaggedShared<SceneObjectRotation>(
+                    MemoryTag::kSceneGraph, 'y', data[0], object_flag);
             } else if (kind == "z") {
-                rotation = std::make_shared<SceneObjectRotation>('z', data[0],
-                                                                 object_flag);
+                rotation = MakeTaggedShared<SceneObjectRotation>(
+                    MemoryTag::kSceneGraph, 'z', data[0], object_flag);
             } else if (kind == "axis") {
-                rotation = std::make_shared<SceneObjectRotation>(
+                rotation = MakeTaggedShared<SceneObjectRotation>(
+                    MemoryTag::kSceneGraph,
                     Vector3f({data[0], data[1], data[2]}), data[3],
                     object_flag);
             } else if (kind == "quaternion") {
-                rotation = std::make_shared<SceneObjectRotation>(
+                rotation = MakeTaggedShared<SceneObjectRotation>(
+                    MemoryTag::kSceneGraph,
                     Quaternion<float>({data[0], data[1], data[2], data[3]}),
                     object_flag);
             }
@@ -460,17 +471,18 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             auto kind = _structure.GetScaleKind();
             auto data = _structure.GetScale();
             if (kind == "x") {
-                scale = std::make_shared<SceneObjectScale>('x', data[0],
-                                                           object_flag);
+                scale = MakeTaggedShared<SceneObjectScale>(
+                    MemoryTag::kSceneGraph, 'x', data[0], object_flag);
             } else if (kind == "y") {
-                scale = std::make_shared<SceneObjectScale>('y', data[0],
-                                                           object_flag);
+                scale = MakeTaggedShared<SceneObjectScale>(
+                    MemoryTag::kSceneGraph, 'y', data[0], object_flag);
             } else if (kind == "z") {
-                scale = std::make_shared<SceneObjectScale>('z', data[0],
-                                                           object_flag);
+                scale = MakeTaggedShared<SceneObjectScale>(
+                    MemoryTag::kSceneGraph, 'z', data[0], object_flag);
             } else if (kind == "xyz") {
-                scale = std::make_shared<SceneObjectScale>(
-                    data[0], data[1], data[2], object_flag);
+                scale = MakeTaggedShared<SceneObjectScale>(
+                    MemoryTag::kSceneGraph, data[0], data[1], data[2],
+                    object_flag);
             }
             auto _key = _structure.GetStructureName();
             base_node->AppendTransform(_key, std::move(scale));
@@ -482,7 +494,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             std::string material_name;
             const char* _name = _structure.GetMaterialName();
             std::string _key = _structure.GetStructureName();
-            auto material = std::make_shared<SceneObjectMaterial>();
+            auto material = MakeTaggedShared<SceneObjectMaterial>(
+                MemoryTag::kSceneGraph);
             material->SetName(_name);
 
             const ODDL::Structure* _sub_structure =
@@ -537,13 +550,17 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             std::shared_ptr<SceneObjectLight> light;
 
             if (!strncmp(_type_str, "infinite", 8)) {
-                light = std::make_shared<SceneObjectInfiniteLight>();
+                light = MakeTaggedShared<SceneObjectInfiniteLight>(
+                    MemoryTag::kSceneGraph);
             } else if (!strncmp(_type_str, "point", 5)) {
-                light = std::make_shared<SceneObjectOmniLight>();
+                light = MakeTaggedShared<SceneObjectOmniLight>(
+                    MemoryTag::kSceneGraph);
             } else if (!strncmp(_type_str, "spot", 4)) {
-                light = std::make_shared<SceneObjectSpotLight>();
+                light = MakeTaggedShared<SceneObjectSpotLight>(
+                    MemoryTag::kSceneGraph);
             } else if (!strncmp(_type_str, "area", 4)) {
-                light = std::make_shared<SceneObjectAreaLight>();
+                light = MakeTaggedShared<SceneObjectAreaLight>(
+                    MemoryTag::kSceneGraph);
             } else {
                 assert(0);
             }
@@ -681,7 +698,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
             const auto& _structure =
                 dynamic_cast<const OGEX::CameraObjectStructure&>(structure);
             std::string _key = _structure.GetStructureName();
-            auto camera = std::make_shared<SceneObjectPerspectiveCamera>();
+            auto camera = MakeTaggedShared<SceneObjectPerspectiveCamera>(
+                MemoryTag::kSceneGraph);
 
             const ODDL::Structure* _sub_structure =
                 _structure.GetFirstCoreSubnode();
@@ -731,7 +749,8 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                 dynamic_cast<const OGEX::AnimationStructure&>(structure);
             auto clip_index = _structure.GetClipIndex();
             std::shared_ptr<SceneObjectAnimationClip> clip =
-                std::make_shared<SceneObjectAnimationClip>(clip_index);
+                MakeTaggedShared<SceneObjectAnimationClip>(
+                    MemoryTag::kAnimation, clip_index);
 
             const ODDL::Structure* _sub_structure =
                 _structure.GetFirstCoreSubnode();
@@ -800,11 +819,13 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                         ->GetFirstCoreSubnode());
                             const float* out_cp =
                                 &dataStructure->GetDataElement(0);
-                            time_curve = std::make_shared<Bezier<float, float>>(
-                                time_knots, in_cp, out_cp, time_key_data_count);
+                            time_curve = MakeTaggedShared<Bezier<float, float>>(
+                                MemoryTag::kAnimation, time_knots, in_cp,
+                                out_cp, time_key_data_count);
                         } else {
-                            time_curve = std::make_shared<Linear<float, float>>(
-                                time_knots, time_key_data_count);
+                            time_curve = MakeTaggedShared<Linear<float, float>>(
+                                MemoryTag::kAnimation, time_knots,
+                                time_key_data_count);
                         }
 
                         if (value_structure.GetCurveType() == "bezier") {
@@ -831,14 +852,16 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                 case 0:
                                 case 1: {
                                     value_curve =
-                                        std::make_shared<Bezier<float, float>>(
+                                        MakeTaggedShared<Bezier<float, float>>(
+                                            MemoryTag::kAnimation,
                                             value_knots, in_cp, out_cp,
                                             value_key_data_count);
                                     type = SceneObjectTrackType::kScalar;
                                 } break;
                                 case 3: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Bezier<Vector3f, Vector3f>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<const Vector3f*>(
                                             value_knots),
                                         reinterpret_cast<const Vector3f*>(
@@ -849,8 +872,9 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                     type = SceneObjectTrackType::kVector3;
                                 } break;
                                 case 4: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Bezier<Quaternion<float>, float>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<
                                             const Quaternion<float>*>(
                                             value_knots),
@@ -862,8 +886,9 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                     type = SceneObjectTrackType::kQuoternion;
                                 } break;
                                 case 16: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Bezier<Matrix4X4f, float>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<const Matrix4X4f*>(
                                             value_knots),
                                         reinterpret_cast<const Matrix4X4f*>(
@@ -882,21 +907,24 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                 case 0:
                                 case 1: {
                                     value_curve =
-                                        std::make_shared<Linear<float, float>>(
-                                            value_knots, value_key_data_count);
+                                        MakeTaggedShared<Linear<float, float>>(
+                                            MemoryTag::kAnimation, value_knots,
+                                            value_key_data_count);
                                     type = SceneObjectTrackType::kScalar;
                                 } break;
                                 case 3: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Linear<Vector3f, Vector3f>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<const Vector3f*>(
                                             value_knots),
                                         value_key_data_count);
                                     type = SceneObjectTrackType::kVector3;
                                 } break;
                                 case 4: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Linear<Quaternion<float>, float>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<
                                             const Quaternion<float>*>(
                                             value_knots),
@@ -904,8 +932,9 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                                     type = SceneObjectTrackType::kQuoternion;
                                 } break;
                                 case 16: {
-                                    value_curve = std::make_shared<
+                                    value_curve = MakeTaggedShared<
                                         Linear<Matrix4X4f, float>>(
+                                        MemoryTag::kAnimation,
                                         reinterpret_cast<const Matrix4X4f*>(
                                             value_knots),
                                         value_key_data_count);
@@ -916,8 +945,9 @@ void OgexParser::ConvertOddlStructureToSceneNode(
                             }
                         }
 
-                        track = std::make_shared<SceneObjectTrack>(
-                            trans, time_curve, value_curve, type);
+                        track = MakeTaggedShared<SceneObjectTrack>(
+                            MemoryTag::kAnimation, trans, time_curve,
+                            value_curve, type);
 
                         clip->AddTrack(track);
                     } break;
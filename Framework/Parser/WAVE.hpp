@@ -25,15 +25,94 @@ struct WAVE_FORMAT_CHUNKHEADER : WAVE_CHUNKHEADER {
     uint16_t BitsPerSample;
 };
 
+// the format is then in the first 2 bytes of SubFormat
+struct WAVE_FORMAT_EXTENSIBLE_CHUNKHEADER : WAVE_FORMAT_CHUNKHEADER {
+    uint16_t ExtensionSize;
+    uint16_t ValidBitsPerSample;
+    uint32_t ChannelMask;
+    uint8_t SubFormat[16];
+};
+
 struct WAVE_DATA_CHUNKHEADER : WAVE_CHUNKHEADER {};
 #pragma pack(pop)
 
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
 constexpr uint32_t RIFF_HEADER_SIZE = offsetof(WAVE_FILEHEADER, FileTypeHeader);
 
 class WaveParser : _implements_ AudioClipParser {
    public:
+    // fills in the format of audio_clip, false if it is not one
+    // AudioClipFormat has. The chunk of an extensible format must be whole.
+    static bool ParseFormat(const WAVE_FORMAT_CHUNKHEADER& header,
+                            AudioClip& audio_clip) {
+        audio_clip.channel_num = header.ChannelNum;
+        audio_clip.sample_rate = header.SampleRate;
+        audio_clip.block_size = header.BlockSize;
+        audio_clip.bits_per_sample = header.BitsPerSample;
+
+        uint16_t format_type = header.FormatType;
+        if (format_type == WAVE_FORMAT_EXTENSIBLE) {
+            if (header.ChunkSize < sizeof(WAVE_FORMAT_EXTENSIBLE_CHUNKHEADER) -
+                                       sizeof(WAVE_CHUNKHEADER)) {
+                return false;
+            }
+            const auto& extensible =
+                static_cast<const WAVE_FORMAT_EXTENSIBLE_CHUNKHEADER&>(header);
+            format_type = static_cast<uint16_t>(extensible.SubFormat[0] |
+                                                extensible.SubFormat[1] << 8);
+        }
+
+        AudioClipFormat mono;
+        AudioClipFormat stereo;
+        if (format_type == WAVE_FORMAT_PCM) {
+            switch (audio_clip.bits_per_sample) {
+                case 8:
+                    mono = AudioClipFormat::MONO_8;
+                    stereo = AudioClipFormat::STEREO_8;
+                    break;
+                case 16:
+                    mono = AudioClipFormat::MONO_16;
+                    stereo = AudioClipFormat::STEREO_16;
+                    break;
+                case 24:
+                    mono = AudioClipFormat::MONO_24;
+                    stereo = AudioClipFormat::STEREO_24;
+                    break;
+                case 32:
+                    mono = AudioClipFormat::MONO_32;
+                    stereo = AudioClipFormat::STEREO_32;
+                    break;
+                default:
+                    return false;
+            }
+        } else if (format_type == WAVE_FORMAT_IEEE_FLOAT &&
+                   audio_clip.bits_per_sample == 32) {
+            mono = AudioClipFormat::MONO_FLOAT32;
+            stereo = AudioClipFormat::STEREO_FLOAT32;
+        } else {
+            return false;
+        }
+
+        switch (audio_clip.channel_num) {
+            case 1:
+                audio_clip.format = mono;
+                return true;
+            case 2:
+                audio_clip.format = stereo;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // a clip without data if it has no data chunk or its format is not
+    // one AudioClipFormat has
     AudioClip Parse(Buffer& buf) override {
-        AudioClip audio_clip;
+        AudioClip audio_clip{};
+        bool has_format = false;
 
         const uint8_t* pData = buf.GetData();
         [[maybe_unused]] const uint8_t* pDataEnd =
@@ -64,47 +143,10 @@ class WaveParser : _implements_ AudioClipParser {
                 const auto* pFormatChunkHeader =
                     reinterpret_cast<const WAVE_FORMAT_CHUNKHEADER*>(pData);
 
-                audio_clip.channel_num = pFormatChunkHeader->ChannelNum;
-                audio_clip.sample_rate = pFormatChunkHeader->SampleRate;
-                audio_clip.block_size = pFormatChunkHeader->BlockSize;
-                audio_clip.bits_per_sample = pFormatChunkHeader->BitsPerSample;
-
-                switch (audio_clip.channel_num) {
-                    case 1:
-                        switch (audio_clip.bits_per_sample) {
-                            case 8:
-                                audio_clip.format = AudioClipFormat::MONO_8;
-                                break;
-
-                            case 16:
-                                audio_clip.format = AudioClipFormat::MONO_16;
-                                break;
-
-                            default:
-                                assert(0);
-                                break;
-                        }
-                        break;
-
-                    case 2:
-                        switch (audio_clip.bits_per_sample) {
-                            case 8:
-                                audio_clip.format = AudioClipFormat::STEREO_8;
-                                break;
-
-                            case 16:
-                                audio_clip.format = AudioClipFormat::STEREO_16;
-                                break;
-
-                            default:
-                                assert(0);
-                                break;
-                        }
-                        break;
-
-                    default:
-                        assert(0);
-                        break;
+                has_format = ParseFormat(*pFormatChunkHeader, audio_clip);
+                if (!has_format) {
+                    std::cerr << "Unsupported Wave format" << std::endl;
+                    return {};
                 }
             } else if (pChunkHeader->ChunkMarker[0] == 'd' &&
                        pChunkHeader->ChunkMarker[1] == 'a' &&
@@ -128,6 +170,11 @@ class WaveParser : _implements_ AudioClipParser {
 
         assert(pData == pDataEnd);
 
+        if (!has_format || !audio_clip.data) {
+            std::cerr << "Wave file without format or data" << std::endl;
+            return {};
+        }
+
         return audio_clip;
     }
 };
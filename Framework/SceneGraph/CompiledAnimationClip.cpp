@@ -0,0 +1,445 @@
+#include "CompiledAnimationClip.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Bezier.hpp"
+#include "Linear.hpp"
+#include "MatrixComposeDecompose.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+void append(vector<float>& floats, float value) { floats.push_back(value); }
+
+void append(vector<float>& floats, const Vector3f& value) {
+    floats.insert(floats.end(), {value[0], value[1], value[2]});
+}
+
+void append(vector<float>& floats, const Quaternion<float>& value) {
+    floats.insert(floats.end(), {value[0], value[1], value[2], value[3]});
+}
+
+// rotation, scale and translation, as Linear<Matrix4X4f, float> blends them
+void append(vector<float>& floats, const Matrix4X4f& value) {
+    Quaternion<float> rotation;
+    Vector3f scalar, translation;
+    Matrix4X4fDecompose(value, rotation, scalar, translation);
+    append(floats, rotation);
+    append(floats, scalar);
+    append(floats, translation);
+}
+
+// the knots of a curve of TVAL, and their control points if it is a Bezier
+// curve. false if it is neither.
+template <typename TVAL, typename TPARAM>
+bool get_keys(const CurveBase& curve, vector<float>& knots,
+              vector<float>& incoming_cp, vector<float>& outgoing_cp) {
+    knots.clear();
+    incoming_cp.clear();
+    outgoing_cp.clear();
+
+    if (const auto* linear =
+            dynamic_cast<const Linear<TVAL, TPARAM>*>(&curve)) {
+        for (const auto& knot : linear->GetKnots()) append(knots, knot);
+        return true;
+    }
+
+    if (const auto* bezier =
+            dynamic_cast<const Bezier<TVAL, TPARAM>*>(&curve)) {
+        const auto& bezier_knots = bezier->GetKnots();
+        for (size_t i = 0; i < bezier_knots.size(); i++) {
+            TVAL in_cp, out_cp;
+            bezier->GetControlPoints(i, in_cp, out_cp);
+            append(knots, bezier_knots[i]);
+            append(incoming_cp, in_cp);
+            append(outgoing_cp, out_cp);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// where a s^3 + b s^2 + c s + d reaches t, by Newton's method as
+// Bezier::Reverse() does, from the linear guess rather than 0.5
+float solve_cubic(const float* cubic, float t, float s) {
+    for (int i = 0; i < 16; i++) {
+        const float f = ((cubic[0] * s + cubic[1]) * s + cubic[2]) * s +
+                        cubic[3] - t;
+        const float fprime =
+            (3.0f * cubic[0] * s + 2.0f * cubic[1]) * s + cubic[2];
+        if (fprime == 0.0f) break;
+        const float step = f / fprime;
+        s -= step;
+        if (fabs(step) < 1e-6f) break;
+    }
+    return s;
+}
+}  // namespace
+
+bool CompiledAnimationClip::bake(const SceneObjectTrack& track,
+                                 BakedTrack& baked) {
+    auto* transform = track.GetTransform().get();
+    baked.transform = transform;
+
+    // the updates the transform has for the track, as SceneObjectTrack
+    // would call them
+    const auto type = track.GetTrackType();
+    char kind = 0;
+    switch (transform->GetType()) {
+        case SceneObjectType::kSceneObjectTypeTranslate:
+            kind = static_cast<SceneObjectTranslation*>(transform)->GetKind();
+            if (type == SceneObjectTrackType::kVector3) {
+                baked.target = Target::kTranslate;
+            } else if (type == SceneObjectTrackType::kScalar && kind) {
+                baked.target = static_cast<Target>(
+                    static_cast<int>(Target::kTranslateX) + (kind - 'x'));
+            } else if (type != SceneObjectTrackType::kMatrix) {
+                return false;
+            }
+            break;
+        case SceneObjectType::kSceneObjectTypeRotate:
+            kind = static_cast<SceneObjectRotation*>(transform)->GetKind();
+            if (type == SceneObjectTrackType::kVector3) {
+                baked.target = Target::kRotateYawPitchRoll;
+            } else if (type == SceneObjectTrackType::kQuoternion) {
+                baked.target = Target::kRotate;
+            } else if (type == SceneObjectTrackType::kScalar && kind) {
+                baked.target = static_cast<Target>(
+                    static_cast<int>(Target::kRotateX) + (kind - 'x'));
+            } else if (type != SceneObjectTrackType::kMatrix) {
+                return false;
+            }
+            break;
+        case SceneObjectType::kSceneObjectTypeScale:
+            kind = static_cast<SceneObjectScale*>(transform)->GetKind();
+            if (type == SceneObjectTrackType::kScalar && kind) {
+                baked.target = static_cast<Target>(
+                    static_cast<int>(Target::kScaleX) + (kind - 'x'));
+            } else if (type == SceneObjectTrackType::kQuoternion) {
+                return false;
+            } else if (type != SceneObjectTrackType::kMatrix) {
+                // a scalar scales all three axes
+                baked.target = Target::kScale;
+            }
+            break;
+        default:
+            if (type != SceneObjectTrackType::kMatrix) return false;
+    }
+    if (kind && (kind < 'x' || kind > 'z')) return false;
+
+    if (!get_keys<float, float>(*track.GetTimeCurve(), baked.times,
+                                baked.timeIncoming, baked.timeOutgoing)) {
+        return false;
+    }
+
+    const auto& value_curve = *track.GetValueCurve();
+    bool baked_values = false;
+    switch (type) {
+        case SceneObjectTrackType::kScalar:
+            baked.components = 1;
+            baked_values = get_keys<float, float>(
+                value_curve, baked.values, baked.valueIncoming,
+                baked.valueOutgoing);
+            break;
+        case SceneObjectTrackType::kVector3:
+            baked.components = 3;
+            baked_values = get_keys<Vector3f, Vector3f>(
+                value_curve, baked.values, baked.valueIncoming,
+                baked.valueOutgoing);
+            break;
+        case SceneObjectTrackType::kQuoternion:
+            baked.components = 4;
+            baked_values = get_keys<Quaternion<float>, float>(
+                value_curve, baked.values, baked.valueIncoming,
+                baked.valueOutgoing);
+            break;
+        case SceneObjectTrackType::kMatrix:
+            baked.components = 10;
+            baked.target = Target::kMatrix;
+            baked_values = get_keys<Matrix4X4f, float>(
+                value_curve, baked.values, baked.valueIncoming,
+                baked.valueOutgoing);
+            break;
+    }
+
+    // the value of each time key
+    return baked_values && !baked.times.empty() &&
+           baked.values.size() == baked.times.size() * baked.components;
+}
+
+template <uint32_t kComponents>
+void CompiledAnimationClip::add(TrackSet<kComponents>& set,
+                                const BakedTrack& track) {
+    const auto count = static_cast<uint32_t>(track.times.size());
+    set.transforms.push_back(track.transform);
+    set.targets.push_back(track.target);
+    set.firstKey.push_back(static_cast<uint32_t>(set.times.size()));
+    set.keyCount.push_back(count);
+    set.cursor.push_back(0);
+    set.times.insert(set.times.end(), track.times.begin(), track.times.end());
+    set.values.insert(set.values.end(), track.values.begin(),
+                      track.values.end());
+
+    // the cubic of each segment, expanded as Bezier::Interpolate() does.
+    // The first key starts no segment, its coefficients are left at 0.
+    auto add_cubics = [&set, count](const vector<float>& knots,
+                                    const vector<float>& incoming_cp,
+                                    const vector<float>& outgoing_cp,
+                                    uint32_t components,
+                                    uint32_t rotation_components) {
+        const auto first = static_cast<uint32_t>(set.coefficients.size());
+        set.coefficients.resize(first + 4 * components * count, 0.0f);
+        for (uint32_t k = 1; k < count; k++) {
+            for (uint32_t c = 0; c < components; c++) {
+                const float p1 = knots[(k - 1) * components + c];
+                const float c1 = outgoing_cp[(k - 1) * components + c];
+                const float c2 = incoming_cp[k * components + c];
+                const float p2 = knots[k * components + c];
+                float* cubic =
+                    &set.coefficients[first + 4 * (k * components + c)];
+                if (c < rotation_components) {
+                    // slerped, not expanded
+                    cubic[0] = p1;
+                    cubic[1] = c1;
+                    cubic[2] = c2;
+                    cubic[3] = p2;
+                    continue;
+                }
+                cubic[0] = p2 - 3.0f * c2 + 3.0f * c1 - p1;
+                cubic[1] = 3.0f * (c2 - 2.0f * c1 + p1);
+                cubic[2] = 3.0f * (c1 - p1);
+                cubic[3] = p1;
+            }
+        }
+        return first;
+    };
+
+    set.timeCoefficients.push_back(
+        track.timeIncoming.empty()
+            ? kLinear
+            : add_cubics(track.times, track.timeIncoming, track.timeOutgoing,
+                         1, 0));
+    set.valueCoefficients.push_back(
+        track.valueIncoming.empty()
+            ? kLinear
+            : add_cubics(track.values, track.valueIncoming,
+                         track.valueOutgoing, kComponents,
+                         TrackSet<kComponents>::kRotationComponents));
+}
+
+bool CompiledAnimationClip::Compile(const SceneObjectAnimationClip& clip) {
+    m_Scalars.Clear();
+    m_Vectors.Clear();
+    m_Quaternions.Clear();
+    m_Matrices.Clear();
+
+    BakedTrack baked;
+    for (const auto& track : clip.GetTracks()) {
+        // SceneObjectTrack::Update() does nothing for them either
+        if (!track->GetTransform()) continue;
+
+        if (!bake(*track, baked)) {
+            m_Scalars.Clear();
+            m_Vectors.Clear();
+            m_Quaternions.Clear();
+            m_Matrices.Clear();
+            return false;
+        }
+
+        switch (baked.components) {
+            case 1:
+                add(m_Scalars, baked);
+                break;
+            case 3:
+                add(m_Vectors, baked);
+                break;
+            case 4:
+                add(m_Quaternions, baked);
+                break;
+            default:
+                add(m_Matrices, baked);
+        }
+    }
+
+    return true;
+}
+
+void CompiledAnimationClip::Evaluate(float time_point) {
+    m_Scalars.Evaluate(time_point);
+    m_Vectors.Evaluate(time_point);
+    m_Quaternions.Evaluate(time_point);
+    m_Matrices.Evaluate(time_point);
+}
+
+template <uint32_t kComponents>
+void CompiledAnimationClip::TrackSet<kComponents>::Clear() {
+    transforms.clear();
+    targets.clear();
+    firstKey.clear();
+    keyCount.clear();
+    cursor.clear();
+    timeCoefficients.clear();
+    valueCoefficients.clear();
+    times.clear();
+    values.clear();
+    coefficients.clear();
+}
+
+template <uint32_t kComponents>
+void CompiledAnimationClip::TrackSet<kComponents>::Sample(
+    size_t i, float time_point, uint32_t& cursor, float* value) const {
+    const uint32_t count = keyCount[i];
+    const float* t = &times[firstKey[i]];
+    const float* v = &values[firstKey[i] * kComponents];
+
+    if (count < 2 || time_point <= t[0]) {
+        copy_n(v, kComponents, value);
+    } else if (time_point >= t[count - 1]) {
+        copy_n(v + (count - 1) * kComponents, kComponents, value);
+    } else {
+        // time going forward moves the cursor by a key or two at most
+        uint32_t k = cursor;
+        if (k == 0 || k >= count || time_point < t[k - 1]) {
+            k = static_cast<uint32_t>(
+                upper_bound(t + 1, t + count, time_point) - t);
+        } else {
+            while (time_point >= t[k]) k++;
+        }
+        cursor = k;
+
+        float s = (time_point - t[k - 1]) / (t[k] - t[k - 1]);
+        if (timeCoefficients[i] != kLinear) {
+            s = solve_cubic(&coefficients[timeCoefficients[i] + 4 * k],
+                            time_point, s);
+        }
+
+        constexpr uint32_t r = kRotationComponents;
+        Quaternion<float> rotation;
+        if (valueCoefficients[i] == kLinear) {
+            const float* v1 = v + (k - 1) * kComponents;
+            const float* v2 = v + k * kComponents;
+            for (uint32_t c = r; c < kComponents; c++) {
+                value[c] = (1.0f - s) * v1[c] + s * v2[c];
+            }
+            if constexpr (r) {
+                rotation = Slerp(Quaternion<float>{v1[0], v1[1], v1[2], v1[3]},
+                                 Quaternion<float>{v2[0], v2[1], v2[2], v2[3]},
+                                 s);
+            }
+        } else {
+            const float* cubic =
+                &coefficients[valueCoefficients[i] + 4 * kComponents * k];
+            for (uint32_t c = r; c < kComponents; c++) {
+                const float* cubic_c = cubic + 4 * c;
+                value[c] =
+                    ((cubic_c[0] * s + cubic_c[1]) * s + cubic_c[2]) * s +
+                    cubic_c[3];
+            }
+            if constexpr (r) {
+                // the control points of each component, see add()
+                Quaternion<float> points[4];
+                for (uint32_t c = 0; c < r; c++) {
+                    for (int p = 0; p < 4; p++) {
+                        points[p][c] = cubic[4 * c + p];
+                    }
+                }
+                rotation = QuaternionBezier(points[0], points[1], points[2],
+                                            points[3], s);
+            }
+        }
+        if constexpr (r) copy_n(&rotation[0], r, value);
+    }
+}
+
+template <uint32_t kComponents>
+Matrix4X4f CompiledAnimationClip::toMatrix(Target target,
+                                           const float* value) {
+    Matrix4X4f matrix;
+    if constexpr (kComponents == 10) {
+        Matrix4X4fCompose(
+            matrix,
+            Quaternion<float>{value[0], value[1], value[2], value[3]},
+            Vector3f({value[4], value[5], value[6]}),
+            Vector3f({value[7], value[8], value[9]}));
+    } else if constexpr (kComponents == 4) {
+        // kRotate, the only target of a quaternion
+        MatrixRotationQuaternion(
+            matrix,
+            Quaternion<float>{value[0], value[1], value[2], value[3]});
+    } else {
+        Vector3f vector(value[0]);
+        if constexpr (kComponents == 3) {
+            vector = Vector3f({value[0], value[1], value[2]});
+        }
+
+        switch (target) {
+            case Target::kTranslateX:
+                MatrixTranslation(matrix, value[0], 0.0f, 0.0f);
+                break;
+            case Target::kTranslateY:
+                MatrixTranslation(matrix, 0.0f, value[0], 0.0f);
+                break;
+            case Target::kTranslateZ:
+                MatrixTranslation(matrix, 0.0f, 0.0f, value[0]);
+                break;
+            case Target::kTranslate:
+                MatrixTranslation(matrix, vector);
+                break;
+            case Target::kRotateX:
+                MatrixRotationX(matrix, value[0]);
+                break;
+            case Target::kRotateY:
+                MatrixRotationY(matrix, value[0]);
+                break;
+            case Target::kRotateZ:
+                MatrixRotationZ(matrix, value[0]);
+                break;
+            case Target::kRotateYawPitchRoll:
+                MatrixRotationYawPitchRoll(matrix, vector[0], vector[1],
+                                           vector[2]);
+                break;
+            case Target::kScaleX:
+                MatrixScale(matrix, value[0], 1.0f, 1.0f);
+                break;
+            case Target::kScaleY:
+                MatrixScale(matrix, 1.0f, value[0], 1.0f);
+                break;
+            case Target::kScaleZ:
+                MatrixScale(matrix, 1.0f, 1.0f, value[0]);
+                break;
+            case Target::kScale:
+                MatrixScale(matrix, vector);
+                break;
+            case Target::kRotate:
+            case Target::kMatrix:
+                break;
+        }
+    }
+
+    return matrix;
+}
+
+template <uint32_t kComponents>
+void CompiledAnimationClip::TrackSet<kComponents>::Evaluate(
+    float time_point) {
+    float value[kComponents];
+    for (size_t i = 0; i < transforms.size(); i++) {
+        Sample(i, time_point, cursor[i], value);
+        // final in SceneObjectTransform, no virtual call
+        transforms[i]->Update(toMatrix<kComponents>(targets[i], value));
+    }
+}
+
+// for CompressedAnimationClip
+template struct CompiledAnimationClip::TrackSet<1>;
+template struct CompiledAnimationClip::TrackSet<3>;
+template struct CompiledAnimationClip::TrackSet<4>;
+template struct CompiledAnimationClip::TrackSet<10>;
+template Matrix4X4f CompiledAnimationClip::toMatrix<1>(Target, const float*);
+template Matrix4X4f CompiledAnimationClip::toMatrix<3>(Target, const float*);
+template Matrix4X4f CompiledAnimationClip::toMatrix<4>(Target, const float*);
+template Matrix4X4f CompiledAnimationClip::toMatrix<10>(Target,
+                                                        const float*);
@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "SceneObjectAnimation.hpp"
+
+namespace My {
+// A SceneObjectAnimationClip baked for playback. The keys of its tracks are
+// kept in flat arrays, one set of arrays per value size, with the Bezier
+// segments turned into cubic coefficients and the matrix keys already
+// decomposed. Evaluate() sets the same transforms as
+// SceneObjectAnimationClip::Update() without virtual calls, finding the
+// keys from where the last call left off.
+//
+// The transforms animated are not owned, the clip compiled keeps them.
+class CompiledAnimationClip {
+   public:
+    // false, and nothing compiled, if one of the tracks is one that
+    // SceneObjectTrack::Update() can not evaluate either
+    bool Compile(const SceneObjectAnimationClip& clip);
+    void Evaluate(float time_point);
+
+    [[nodiscard]] size_t GetTrackCount() const {
+        return m_Scalars.transforms.size() + m_Vectors.transforms.size() +
+               m_Quaternions.transforms.size() + m_Matrices.transforms.size();
+    }
+    [[nodiscard]] size_t GetKeyCount() const {
+        return m_Scalars.times.size() + m_Vectors.times.size() +
+               m_Quaternions.times.size() + m_Matrices.times.size();
+    }
+    // bytes of the keys
+    [[nodiscard]] size_t GetMemorySize() const {
+        return m_Scalars.GetMemorySize() + m_Vectors.GetMemorySize() +
+               m_Quaternions.GetMemorySize() + m_Matrices.GetMemorySize();
+    }
+
+   private:
+    // what a value of the track is turned into
+    enum class Target : uint8_t {
+        kTranslateX,
+        kTranslateY,
+        kTranslateZ,
+        kTranslate,
+        kRotateX,
+        kRotateY,
+        kRotateZ,
+        kRotateYawPitchRoll,
+        kRotate,
+        kScaleX,
+        kScaleY,
+        kScaleZ,
+        kScale,
+        kMatrix,
+    };
+
+    static constexpr uint32_t kLinear = 0xFFFFFFFF;
+
+    // tracks whose values are kComponents floats: 1 for scalars, 3 for
+    // vectors, 4 for quaternions, 10 for matrices as a quaternion, scale
+    // and translation
+    template <uint32_t kComponents>
+    struct TrackSet {
+        // the leading components slerped as a quaternion rather than
+        // blended one by one
+        static constexpr uint32_t kRotationComponents =
+            kComponents == 4 || kComponents == 10 ? 4 : 0;
+
+        // by track
+        std::vector<SceneObjectTransform*> transforms;
+        std::vector<Target> targets;
+        std::vector<uint32_t> firstKey;
+        std::vector<uint32_t> keyCount;
+        // key ending the segment last evaluated
+        std::vector<uint32_t> cursor;
+        // first of the coefficients of the track, kLinear if it has none
+        std::vector<uint32_t> timeCoefficients;
+        std::vector<uint32_t> valueCoefficients;
+
+        // by key
+        std::vector<float> times;
+        std::vector<float> values;  // kComponents a key
+
+        // by Bezier key, for the segment ending at it: a, b, c, d of
+        // a s^3 + b s^2 + c s + d, 4 for the time and 4 * kComponents for
+        // the value. For the rotation components the four control points
+        // of the segment instead.
+        std::vector<float> coefficients;
+
+        void Clear();
+        void Evaluate(float time_point);
+        // the value of track i, from the segment after cursor on
+        void Sample(size_t i, float time_point, uint32_t& cursor,
+                    float* value) const;
+        [[nodiscard]] size_t GetMemorySize() const {
+            return (times.size() + values.size() + coefficients.size()) *
+                       sizeof(float) +
+                   transforms.size() * (sizeof(SceneObjectTransform*) +
+                                        sizeof(Target) + 5 * sizeof(uint32_t));
+        }
+    };
+
+    // the keys of one track as floats, before they go in a set
+    struct BakedTrack {
+        SceneObjectTransform* transform;
+        Target target;
+        uint32_t components;
+        std::vector<float> times;
+        std::vector<float> values;
+        // control points of each key, empty for linear curves
+        std::vector<float> timeIncoming;
+        std::vector<float> timeOutgoing;
+        std::vector<float> valueIncoming;
+        std::vector<float> valueOutgoing;
+    };
+
+    static bool bake(const SceneObjectTrack& track, BakedTrack& baked);
+    // the matrix a value of kComponents floats sets target to
+    template <uint32_t kComponents>
+    static Matrix4X4f toMatrix(Target target, const float* value);
+    template <uint32_t kComponents>
+    static void add(TrackSet<kComponents>& set, const BakedTrack& track);
+
+    // reads the keys to compress them
+    friend class CompressedAnimationClip;
+
+   private:
+    TrackSet<1> m_Scalars;
+    TrackSet<3> m_Vectors;
+    TrackSet<4> m_Quaternions;
+    TrackSet<10> m_Matrices;
+};
+}  // namespace My
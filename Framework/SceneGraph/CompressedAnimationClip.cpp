@@ -0,0 +1,306 @@
+#include "CompressedAnimationClip.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace My;
+using namespace std;
+
+namespace {
+constexpr float kQuantizationSteps = 65535.0f;
+// the three smallest components of a unit quaternion are within 1/sqrt(2)
+// of 0, in 15 bits each
+constexpr float kSmallestThreeRange = 0.70710678f;
+constexpr float kSmallestThreeSteps = 32767.0f;
+
+uint16_t quantize(float value, float minimum, float extent) {
+    if (extent <= 0.0f) return 0;
+    const float unit = std::clamp((value - minimum) / extent, 0.0f, 1.0f);
+    return static_cast<uint16_t>(lround(unit * kQuantizationSteps));
+}
+
+float dequantize(uint16_t word, float minimum, float extent) {
+    return minimum + word * (extent / kQuantizationSteps);
+}
+
+// the largest component is left out, the unit length gives it back. Which
+// one it is goes in the top bits of the first two words.
+void encode_rotation(const float* value, uint16_t* words) {
+    Quaternion<float> rotation{value[0], value[1], value[2], value[3]};
+    Normalize(rotation);
+    uint32_t largest = 0;
+    for (uint32_t c = 1; c < 4; c++) {
+        if (fabs(rotation[c]) > fabs(rotation[largest])) largest = c;
+    }
+    // q and -q are the same rotation, the one with it positive is kept
+    const float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint32_t w = 0;
+    for (uint32_t c = 0; c < 4; c++) {
+        if (c == largest) continue;
+        const float unit = std::clamp(
+            sign * rotation[c] / kSmallestThreeRange * 0.5f + 0.5f, 0.0f,
+            1.0f);
+        words[w++] = static_cast<uint16_t>(lround(unit * kSmallestThreeSteps));
+    }
+    words[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    words[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+}
+
+void decode_rotation(const uint16_t* words, float* value) {
+    const uint32_t largest = (words[0] >> 15) | ((words[1] >> 15) << 1);
+    float length_squared = 0.0f;
+    uint32_t w = 0;
+    for (uint32_t c = 0; c < 4; c++) {
+        if (c == largest) continue;
+        const float unit = (words[w++] & 0x7FFF) / kSmallestThreeSteps;
+        value[c] = (unit * 2.0f - 1.0f) * kSmallestThreeRange;
+        length_squared += value[c] * value[c];
+    }
+    value[largest] = sqrt(max(0.0f, 1.0f - length_squared));
+}
+
+// as CompiledAnimationClip blends two keys: a slerp for the first
+// rotation_components, the others linearly
+void blend(const float* a, const float* b, float s, uint32_t components,
+           uint32_t rotation_components, float* value) {
+    for (uint32_t c = rotation_components; c < components; c++) {
+        value[c] = (1.0f - s) * a[c] + s * b[c];
+    }
+    if (rotation_components) {
+        const auto rotation =
+            Slerp(Quaternion<float>{a[0], a[1], a[2], a[3]},
+                  Quaternion<float>{b[0], b[1], b[2], b[3]}, s);
+        copy_n(&rotation[0], 4, value);
+    }
+}
+
+// the largest difference of a component, or angle for a rotation
+float difference(const float* a, const float* b, uint32_t components,
+                 uint32_t rotation_components) {
+    float result = 0.0f;
+    for (uint32_t c = rotation_components; c < components; c++) {
+        result = max(result, fabs(a[c] - b[c]));
+    }
+    if (rotation_components) {
+        result = max(result, QuaternionAngle(
+                                 Quaternion<float>{a[0], a[1], a[2], a[3]},
+                                 Quaternion<float>{b[0], b[1], b[2], b[3]}));
+    }
+    return result;
+}
+}  // namespace
+
+void CompressedAnimationClip::Compress(const CompiledAnimationClip& compiled,
+                                       float tolerance, float sample_rate) {
+    m_Tracks.clear();
+    m_Times.clear();
+    m_Values.clear();
+    m_Ranges.clear();
+
+    // in the order CompiledAnimationClip::Evaluate() sets them
+    addTracks(compiled.m_Scalars, tolerance, sample_rate);
+    addTracks(compiled.m_Vectors, tolerance, sample_rate);
+    addTracks(compiled.m_Quaternions, tolerance, sample_rate);
+    addTracks(compiled.m_Matrices, tolerance, sample_rate);
+}
+
+void CompressedAnimationClip::Evaluate(float time_point) {
+    for (auto& track : m_Tracks) {
+        switch (track.components) {
+            case 1:
+                evaluate<1>(track, time_point);
+                break;
+            case 3:
+                evaluate<3>(track, time_point);
+                break;
+            case 4:
+                evaluate<4>(track, time_point);
+                break;
+            default:
+                evaluate<10>(track, time_point);
+        }
+    }
+}
+
+template <uint32_t kComponents>
+void CompressedAnimationClip::addTracks(
+    const CompiledAnimationClip::TrackSet<kComponents>& set, float tolerance,
+    float sample_rate) {
+    constexpr uint32_t r =
+        CompiledAnimationClip::TrackSet<kComponents>::kRotationComponents;
+    // the smallest three of a rotation take 3 words, then one a component
+    constexpr uint32_t kFirstWord = r ? 3 : 0;
+    constexpr uint32_t kWords = kFirstWord + kComponents - r;
+
+    vector<float> times, samples, decoded;
+    vector<uint16_t> words;
+    for (size_t i = 0; i < set.transforms.size(); i++) {
+        // the keys, and sample_rate samples a second between them for the
+        // curves that are not lines
+        const float* keys = &set.times[set.firstKey[i]];
+        times.clear();
+        for (uint32_t k = 0; k < set.keyCount[i]; k++) {
+            times.push_back(keys[k]);
+            if (k + 1 == set.keyCount[i]) break;
+            const auto steps = static_cast<uint32_t>(
+                ceil((keys[k + 1] - keys[k]) * sample_rate));
+            for (uint32_t j = 1; j < steps; j++) {
+                times.push_back(keys[k] +
+                                (keys[k + 1] - keys[k]) * j / steps);
+            }
+        }
+        const auto count = static_cast<uint32_t>(times.size());
+
+        samples.resize(count * kComponents);
+        uint32_t cursor = 0;
+        for (uint32_t j = 0; j < count; j++) {
+            set.Sample(i, times[j], cursor, &samples[j * kComponents]);
+        }
+
+        Track track;
+        track.transform = set.transforms[i];
+        track.target = set.targets[i];
+        track.components = kComponents;
+        track.startTime = times.front();
+        track.duration = times.back() - times.front();
+        track.firstKey = static_cast<uint32_t>(m_Times.size());
+        track.firstValue = static_cast<uint32_t>(m_Values.size());
+        track.firstRange = static_cast<uint32_t>(m_Ranges.size());
+        track.cursor = 0;
+
+        for (uint32_t c = r; c < kComponents; c++) {
+            float minimum = samples[c];
+            float maximum = samples[c];
+            for (uint32_t j = 1; j < count; j++) {
+                minimum = min(minimum, samples[j * kComponents + c]);
+                maximum = max(maximum, samples[j * kComponents + c]);
+            }
+            m_Ranges.push_back(minimum);
+            m_Ranges.push_back(maximum - minimum);
+        }
+        const float* ranges = m_Ranges.data() + track.firstRange;
+
+        // every sample quantized, and back, so the keys are dropped by the
+        // error of what is played
+        words.resize(count * kWords);
+        decoded.resize(count * kComponents);
+        for (uint32_t j = 0; j < count; j++) {
+            const float* sample = &samples[j * kComponents];
+            uint16_t* word = &words[j * kWords];
+            float* value = &decoded[j * kComponents];
+            if constexpr (r) {
+                encode_rotation(sample, word);
+                decode_rotation(word, value);
+            }
+            for (uint32_t c = r; c < kComponents; c++) {
+                const float minimum = ranges[2 * (c - r)];
+                const float extent = ranges[2 * (c - r) + 1];
+                uint16_t& w = word[kFirstWord + c - r];
+                w = quantize(sample[c], minimum, extent);
+                value[c] = dequantize(w, minimum, extent);
+            }
+        }
+        vector<uint16_t> quantized_times(count);
+        for (uint32_t j = 0; j < count; j++) {
+            quantized_times[j] =
+                quantize(times[j], track.startTime, track.duration);
+        }
+
+        // a track that does not move keeps its first key only
+        bool still = true;
+        for (uint32_t j = 1; j < count && still; j++) {
+            still = difference(&decoded[0], &samples[j * kComponents],
+                               kComponents, r) <= tolerance;
+        }
+
+        // each segment as long as the samples it skips stay in tolerance
+        vector<uint32_t> kept = {0};
+        if (!still) {
+            uint32_t a = 0;
+            float value[kComponents];
+            for (uint32_t b = 2; b < count; b++) {
+                const float span = static_cast<float>(quantized_times[b]) -
+                                   quantized_times[a];
+                bool fits = span > 0.0f;
+                for (uint32_t j = a + 1; j < b && fits; j++) {
+                    const float s = (quantized_times[j] - quantized_times[a]) /
+                                    span;
+                    blend(&decoded[a * kComponents], &decoded[b * kComponents],
+                          s, kComponents, r, value);
+                    fits = difference(value, &samples[j * kComponents],
+                                      kComponents, r) <= tolerance;
+                }
+                if (!fits && quantized_times[b - 1] > quantized_times[a]) {
+                    a = b - 1;
+                    kept.push_back(a);
+                }
+            }
+            if (count > 1) kept.push_back(count - 1);
+        }
+
+        for (const auto j : kept) {
+            m_Times.push_back(quantized_times[j]);
+            m_Values.insert(m_Values.end(), &words[j * kWords],
+                            &words[j * kWords] + kWords);
+        }
+        track.keyCount = static_cast<uint32_t>(kept.size());
+        m_Tracks.push_back(track);
+    }
+}
+
+template <uint32_t kComponents>
+void CompressedAnimationClip::evaluate(Track& track, float time_point) {
+    constexpr uint32_t r =
+        CompiledAnimationClip::TrackSet<kComponents>::kRotationComponents;
+    constexpr uint32_t kFirstWord = r ? 3 : 0;
+    constexpr uint32_t kWords = kFirstWord + kComponents - r;
+
+    const uint32_t count = track.keyCount;
+    const uint16_t* times = &m_Times[track.firstKey];
+    const uint16_t* words = &m_Values[track.firstValue];
+    const float* ranges = m_Ranges.data() + track.firstRange;
+
+    auto decode = [words, ranges](uint32_t k, float* value) {
+        const uint16_t* word = words + k * kWords;
+        if constexpr (r) decode_rotation(word, value);
+        for (uint32_t c = r; c < kComponents; c++) {
+            value[c] = dequantize(word[kFirstWord + c - r], ranges[2 * (c - r)],
+                                  ranges[2 * (c - r) + 1]);
+        }
+    };
+
+    float value[kComponents];
+    // in the steps the times are quantized to
+    const float t = track.duration > 0.0f ? (time_point - track.startTime) /
+                                                track.duration *
+                                                kQuantizationSteps
+                                          : 0.0f;
+    if (count < 2 || t <= times[0]) {
+        decode(0, value);
+    } else if (t >= times[count - 1]) {
+        decode(count - 1, value);
+    } else {
+        // as CompiledAnimationClip, time going forward moves the cursor by
+        // a key or two at most
+        uint32_t k = track.cursor;
+        if (k == 0 || k >= count || t < times[k - 1]) {
+            k = static_cast<uint32_t>(
+                upper_bound(times + 1, times + count, t,
+                            [](float a, uint16_t b) { return a < b; }) -
+                times);
+        } else {
+            while (t >= times[k]) k++;
+        }
+        track.cursor = k;
+
+        float a[kComponents], b[kComponents];
+        decode(k - 1, a);
+        decode(k, b);
+        const float s = (t - times[k - 1]) / (times[k] - times[k - 1]);
+        blend(a, b, s, kComponents, r, value);
+    }
+
+    track.transform->Update(
+        CompiledAnimationClip::toMatrix<kComponents>(track.target, value));
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "CompiledAnimationClip.hpp"
+
+namespace My {
+// A CompiledAnimationClip with fewer, smaller keys. Every track is sampled
+// at its keys and at a fixed rate between them, and the samples a linear
+// blend (a slerp for rotations) of their neighbours gives back within a
+// tolerance are dropped. The keys left are quantized to 16 bits: times
+// over the duration of the track, values over the range of each component,
+// and rotations as the smallest three components of the quaternion.
+// Evaluate() decodes the two keys around the time point and nothing else.
+//
+// Like CompiledAnimationClip the transforms animated are not owned.
+class CompressedAnimationClip {
+   public:
+    // tolerance is in the units of the values, radians for rotations
+    void Compress(const CompiledAnimationClip& compiled, float tolerance,
+                  float sample_rate = 30.0f);
+    void Evaluate(float time_point);
+
+    [[nodiscard]] size_t GetTrackCount() const { return m_Tracks.size(); }
+    [[nodiscard]] size_t GetKeyCount() const { return m_Times.size(); }
+    // where the last track ends
+    [[nodiscard]] float GetEndTime() const {
+        float end_time = 0.0f;
+        for (const auto& track : m_Tracks) {
+            end_time = std::max(end_time, track.startTime + track.duration);
+        }
+        return end_time;
+    }
+    // bytes of the keys, as CompiledAnimationClip::GetMemorySize()
+    [[nodiscard]] size_t GetMemorySize() const {
+        return m_Tracks.size() * sizeof(Track) +
+               (m_Times.size() + m_Values.size()) * sizeof(uint16_t) +
+               m_Ranges.size() * sizeof(float);
+    }
+
+   private:
+    struct Track {
+        SceneObjectTransform* transform;
+        float startTime;
+        float duration;
+        // into m_Times, m_Values and m_Ranges
+        uint32_t firstKey;
+        uint32_t firstValue;
+        uint32_t firstRange;
+        uint32_t keyCount;
+        // key ending the segment last evaluated
+        uint32_t cursor;
+        CompiledAnimationClip::Target target;
+        // 1, 3, 4 or 10 floats a value, as CompiledAnimationClip has them
+        uint8_t components;
+    };
+
+    template <uint32_t kComponents>
+    void addTracks(const CompiledAnimationClip::TrackSet<kComponents>& set,
+                   float tolerance, float sample_rate);
+    template <uint32_t kComponents>
+    void evaluate(Track& track, float time_point);
+
+   private:
+    std::vector<Track> m_Tracks;
+    // by key, 0 to 65535 over the duration of the track
+    std::vector<uint16_t> m_Times;
+    // by key, the words of the value: the smallest three of a rotation,
+    // then one for each other component
+    std::vector<uint16_t> m_Values;
+    // by track, minimum and extent of each component not in a rotation
+    std::vector<float> m_Ranges;
+};
+}  // namespace My
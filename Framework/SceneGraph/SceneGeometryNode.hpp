@@ -10,6 +10,7 @@ class SceneGeometryNode : public SceneNode<SceneObjectGeometry> {
     bool m_bMotionBlur;
     std::vector<std::string> m_Materials;
     void* m_pRigidBody = nullptr;
+    uint32_t m_nRigidBodyHandle = 0;
 
    protected:
     void dump(std::ostream& out) const override {
@@ -45,7 +46,11 @@ class SceneGeometryNode : public SceneNode<SceneObjectGeometry> {
         return std::string("default");
     };
 
-    void LinkRigidBody(void* rigidBody) { m_pRigidBody = rigidBody; }
+    // handle is where the physics manager publishes the body's transform
+    void LinkRigidBody(void* rigidBody, uint32_t handle) {
+        m_pRigidBody = rigidBody;
+        m_nRigidBodyHandle = handle;
+    }
 
     void* UnlinkRigidBody() {
         void* rigidBody = m_pRigidBody;
@@ -54,6 +59,9 @@ class SceneGeometryNode : public SceneNode<SceneObjectGeometry> {
         return rigidBody;
     }
 
-    void* RigidBody() { return m_pRigidBody; }
+    [[nodiscard]] void* RigidBody() const { return m_pRigidBody; }
+    [[nodiscard]] uint32_t RigidBodyHandle() const {
+        return m_nRigidBodyHandle;
+    }
 };
 }  // namespace My
\ No newline at end of file
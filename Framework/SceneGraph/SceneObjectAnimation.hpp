@@ -19,6 +19,10 @@ class SceneObjectAnimationClip : public BaseSceneObject,
           m_nIndex(index) {}
     int GetIndex() { return m_nIndex; }
     void AddTrack(std::shared_ptr<SceneObjectTrack>& track);
+    [[nodiscard]] const std::vector<std::shared_ptr<SceneObjectTrack>>&
+    GetTracks() const {
+        return m_Tracks;
+    }
     void Update(const float time_point) final;
 
     friend std::ostream& operator<<(std::ostream& out,
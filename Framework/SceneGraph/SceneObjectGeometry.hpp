@@ -50,8 +50,10 @@ class SceneObjectGeometry : public BaseSceneObject {
     [[nodiscard]] BoundingBox GetBoundingBox() const {
         return m_Mesh.empty() ? BoundingBox() : m_Mesh[0]->GetBoundingBox();
     }
-    [[nodiscard]] ConvexHull<float> GetConvexHull() const {
-        return m_Mesh.empty() ? ConvexHull<float>() : m_Mesh[0]->GetConvexHull();
+    [[nodiscard]] ConvexHull<float> GetConvexHull(
+        uint32_t max_vertex_count = 0) const {
+        return m_Mesh.empty() ? ConvexHull<float>()
+                              : m_Mesh[0]->GetConvexHull(max_vertex_count);
     }
 
     friend std::ostream& operator<<(std::ostream& out,
@@ -1,4 +1,5 @@
 #pragma once
+#include "MemoryTracker.hpp"
 #include "SceneObjectTypeDef.hpp"
 
 namespace My {
@@ -21,7 +22,12 @@ class SceneObjectIndexArray {
           m_szRestartIndex(restart_index),
           m_DataType(data_type),
           m_pData(data),
-          m_szData(data_size){};
+          m_szData(data_size) {
+        // the data is owned from here on
+        if (m_pData) {
+            MemoryTracker::RecordAllocation(MemoryTag::kMeshes, GetDataSize());
+        }
+    }
 
     SceneObjectIndexArray(const SceneObjectIndexArray& rhs) = delete;
 
@@ -35,12 +41,16 @@ class SceneObjectIndexArray {
     }
 
     ~SceneObjectIndexArray() {
-        if (m_pData) delete[] m_pData;
+        if (m_pData) {
+            MemoryTracker::RecordFree(MemoryTag::kMeshes, GetDataSize());
+            delete[] m_pData;
+        }
     }
 
     [[nodiscard]] uint32_t GetMaterialIndex() const {
         return m_nMaterialIndex;
     };
+    [[nodiscard]] size_t GetRestartIndex() const { return m_szRestartIndex; };
     [[nodiscard]] IndexDataType GetIndexType() const { return m_DataType; };
     [[nodiscard]] const void* GetData() const { return m_pData; };
     [[nodiscard]] size_t GetDataSize() const {
@@ -74,8 +74,10 @@ BoundingBox SceneObjectMesh::GetBoundingBox() const {
     return result;
 }
 
-ConvexHull<float> SceneObjectMesh::GetConvexHull() const {
+ConvexHull<float> SceneObjectMesh::GetConvexHull(
+    uint32_t max_vertex_count) const {
     ConvexHull<float> hull;
+    hull.SetMaxVertexCount(max_vertex_count);
 
     auto count = m_VertexArray.size();
     for (decltype(count) n = 0; n < count; n++) {
@@ -104,8 +106,406 @@ ConvexHull<float> SceneObjectMesh::GetConvexHull() const {
         }
     }
 
-    // calculate the convex hull
+    // calculate the convex hull, in one go
     hull.Iterate();
 
     return hull;
 }
+
+static size_t VertexComponentCount(VertexDataType data_type) {
+    switch (data_type) {
+        case VertexDataType::kVertexDataTypeFloat1:
+        case VertexDataType::kVertexDataTypeDouble1:
+            return 1;
+        case VertexDataType::kVertexDataTypeFloat2:
+        case VertexDataType::kVertexDataTypeDouble2:
+            return 2;
+        case VertexDataType::kVertexDataTypeFloat3:
+        case VertexDataType::kVertexDataTypeDouble3:
+            return 3;
+        case VertexDataType::kVertexDataTypeFloat4:
+        case VertexDataType::kVertexDataTypeDouble4:
+            return 4;
+        default:
+            assert(0);
+    }
+
+    return 0;
+}
+
+static void ReadPositions(std::vector<Vector3f>& positions,
+                          const std::vector<SceneObjectVertexArray>& arrays,
+                          size_t vertex_count) {
+    positions.clear();
+    for (const auto& vertex_array : arrays) {
+        if (vertex_array.GetAttributeName() != "position") continue;
+        const auto data_type = vertex_array.GetDataType();
+        if (data_type == VertexDataType::kVertexDataTypeFloat3) {
+            const auto* p =
+                reinterpret_cast<const Vector3f*>(vertex_array.GetData());
+            positions.assign(p, p + vertex_count);
+        } else if (data_type == VertexDataType::kVertexDataTypeDouble3) {
+            const auto* p =
+                reinterpret_cast<const double*>(vertex_array.GetData());
+            positions.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; i++) {
+                positions[i] = Vector3f{static_cast<float>(p[i * 3 + 0]),
+                                        static_cast<float>(p[i * 3 + 1]),
+                                        static_cast<float>(p[i * 3 + 2])};
+            }
+        }
+        break;
+    }
+}
+
+// returns false if the index array restarts primitives, its restart values
+// are not vertex indices and the algorithms below do not handle them
+static bool ReadIndices(std::vector<uint32_t>& indices,
+                        const SceneObjectIndexArray& index_array) {
+    const auto count = index_array.GetIndexCount();
+    const auto* data = index_array.GetData();
+    indices.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        switch (index_array.GetIndexType()) {
+            case IndexDataType::kIndexDataTypeInt8:
+                indices[i] = reinterpret_cast<const uint8_t*>(data)[i];
+                break;
+            case IndexDataType::kIndexDataTypeInt16:
+                indices[i] = reinterpret_cast<const uint16_t*>(data)[i];
+                break;
+            case IndexDataType::kIndexDataTypeInt32:
+                indices[i] = reinterpret_cast<const uint32_t*>(data)[i];
+                break;
+            case IndexDataType::kIndexDataTypeInt64:
+                indices[i] = static_cast<uint32_t>(
+                    reinterpret_cast<const uint64_t*>(data)[i]);
+                break;
+            default:
+                assert(0);
+        }
+    }
+
+    const auto restart_index = index_array.GetRestartIndex();
+    if (restart_index == 0) return true;
+    return std::find(indices.begin(), indices.end(), restart_index) ==
+           indices.end();
+}
+
+static SceneObjectIndexArray WriteIndices(
+    const std::vector<uint32_t>& indices,
+    const SceneObjectIndexArray& index_array) {
+    const auto count = indices.size();
+    const auto type = index_array.GetIndexType();
+    uint8_t* data = nullptr;
+
+    // SceneObjectIndexArray frees its data as uint8_t[]
+    switch (type) {
+        case IndexDataType::kIndexDataTypeInt8: {
+            data = new uint8_t[count];
+            for (size_t i = 0; i < count; i++)
+                data[i] = static_cast<uint8_t>(indices[i]);
+        } break;
+        case IndexDataType::kIndexDataTypeInt16: {
+            data = new uint8_t[count * sizeof(uint16_t)];
+            auto* p = reinterpret_cast<uint16_t*>(data);
+            for (size_t i = 0; i < count; i++)
+                p[i] = static_cast<uint16_t>(indices[i]);
+        } break;
+        case IndexDataType::kIndexDataTypeInt32: {
+            data = new uint8_t[count * sizeof(uint32_t)];
+            auto* p = reinterpret_cast<uint32_t*>(data);
+            for (size_t i = 0; i < count; i++) p[i] = indices[i];
+        } break;
+        case IndexDataType::kIndexDataTypeInt64: {
+            data = new uint8_t[count * sizeof(uint64_t)];
+            auto* p = reinterpret_cast<uint64_t*>(data);
+            for (size_t i = 0; i < count; i++) p[i] = indices[i];
+        } break;
+        default:
+            assert(0);
+    }
+
+    return SceneObjectIndexArray(index_array.GetMaterialIndex(),
+                                 index_array.GetRestartIndex(), type, data,
+                                 count);
+}
+
+MeshOptimizationReport SceneObjectMesh::AnalyzeVertexCache() const {
+    MeshOptimizationReport report;
+    report.vertices_before = report.vertices_after = GetVertexCount();
+
+    std::vector<uint32_t> indices;
+    for (const auto& index_array : m_IndexArray) {
+        if (!ReadIndices(indices, index_array)) continue;
+        auto stat = My::AnalyzeVertexCache(indices, GetVertexCount());
+        report.before.triangles_count += stat.triangles_count;
+        report.before.vertices_transformed += stat.vertices_transformed;
+    }
+
+    if (report.before.triangles_count) {
+        report.before.acmr =
+            static_cast<float>(report.before.vertices_transformed) /
+            static_cast<float>(report.before.triangles_count);
+    }
+
+    if (report.vertices_before) {
+        report.before.atvr =
+            static_cast<float>(report.before.vertices_transformed) /
+            static_cast<float>(report.vertices_before);
+    }
+
+    report.after = report.before;
+
+    return report;
+}
+
+MeshOptimizationReport SceneObjectMesh::Optimize(float overdraw_threshold) {
+    MeshOptimizationReport report = AnalyzeVertexCache();
+
+    if (m_PrimitiveType != PrimitiveType::kPrimitiveTypeTriList ||
+        m_VertexArray.empty() || m_IndexArray.empty()) {
+        return report;
+    }
+
+    auto vertex_count = GetVertexCount();
+
+    std::vector<std::vector<uint32_t>> index_groups(m_IndexArray.size());
+    std::vector<uint32_t> all_indices;
+    for (size_t i = 0; i < m_IndexArray.size(); i++) {
+        if (!ReadIndices(index_groups[i], m_IndexArray[i])) {
+            cerr << "[SceneObjectMesh] primitive restart is used, skip "
+                    "optimization."
+                 << endl;
+            return report;
+        }
+        all_indices.insert(all_indices.end(), index_groups[i].begin(),
+                           index_groups[i].end());
+    }
+
+    std::vector<VertexStream> streams;
+    for (const auto& vertex_array : m_VertexArray) {
+        if (vertex_array.GetVertexCount() != vertex_count) {
+            // streams of different length could not share index
+            cerr << "[SceneObjectMesh] vertex streams mismatch, skip "
+                    "optimization."
+                 << endl;
+            return report;
+        }
+        streams.push_back({vertex_array.GetData(),
+                           vertex_array.GetDataSize() / vertex_count});
+    }
+
+    // 1. weld duplicated vertices and drop unreferenced ones
+    std::vector<uint32_t> remap;
+    auto new_vertex_count =
+        GenerateVertexRemap(remap, all_indices, vertex_count, streams);
+
+    std::vector<std::vector<uint8_t>> vertex_data(m_VertexArray.size());
+    for (size_t n = 0; n < m_VertexArray.size(); n++) {
+        vertex_data[n].resize(new_vertex_count * streams[n].stride);
+        RemapVertexBuffer(vertex_data[n].data(), streams[n].data, vertex_count,
+                          streams[n].stride, remap);
+        streams[n].data = vertex_data[n].data();
+    }
+
+    for (auto& indices : index_groups) {
+        RemapIndexBuffer(indices, remap);
+    }
+    vertex_count = new_vertex_count;
+
+    // positions are needed for overdraw ordering
+    std::vector<Vector3f> positions;
+    for (size_t n = 0; n < m_VertexArray.size(); n++) {
+        if (m_VertexArray[n].GetAttributeName() != "position") continue;
+        const auto data_type = m_VertexArray[n].GetDataType();
+        if (data_type == VertexDataType::kVertexDataTypeFloat3) {
+            const auto* p =
+                reinterpret_cast<const Vector3f*>(vertex_data[n].data());
+            positions.assign(p, p + vertex_count);
+        } else if (data_type == VertexDataType::kVertexDataTypeDouble3) {
+            const auto* p =
+                reinterpret_cast<const double*>(vertex_data[n].data());
+            positions.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; i++) {
+                positions[i] = Vector3f{static_cast<float>(p[i * 3 + 0]),
+                                        static_cast<float>(p[i * 3 + 1]),
+                                        static_cast<float>(p[i * 3 + 2])};
+            }
+        }
+        break;
+    }
+
+    // 2. reorder triangles for vertex cache, then overdraw
+    all_indices.clear();
+    for (auto& indices : index_groups) {
+        OptimizeVertexCache(indices, vertex_count);
+        if (!positions.empty()) {
+            OptimizeOverdraw(indices, positions.data(), vertex_count,
+                             overdraw_threshold);
+        }
+        all_indices.insert(all_indices.end(), indices.begin(), indices.end());
+    }
+
+    // 3. reorder vertices for fetch locality
+    new_vertex_count =
+        OptimizeVertexFetchRemap(remap, all_indices, vertex_count);
+
+    std::vector<SceneObjectVertexArray> vertex_arrays;
+    for (size_t n = 0; n < m_VertexArray.size(); n++) {
+        const auto& vertex_array = m_VertexArray[n];
+        const auto stride = streams[n].stride;
+        auto* data = new uint8_t[new_vertex_count * stride];
+        RemapVertexBuffer(data, vertex_data[n].data(), vertex_count, stride,
+                          remap);
+
+        const auto element_count =
+            new_vertex_count * VertexComponentCount(vertex_array.GetDataType());
+        vertex_arrays.emplace_back(
+            vertex_array.GetAttributeName().c_str(),
+            vertex_array.GetMorphTargetIndex(), vertex_array.GetDataType(),
+            data, element_count);
+    }
+
+    std::vector<SceneObjectIndexArray> index_arrays;
+    for (size_t i = 0; i < m_IndexArray.size(); i++) {
+        RemapIndexBuffer(index_groups[i], remap);
+        index_arrays.push_back(WriteIndices(index_groups[i], m_IndexArray[i]));
+    }
+
+    m_VertexArray.swap(vertex_arrays);
+    m_IndexArray.swap(index_arrays);
+
+    // derived data refer to the old vertex and triangle order
+    m_LodIndexArray.clear();
+    m_LodError.clear();
+    m_Meshlets.clear();
+
+    auto after = AnalyzeVertexCache();
+    report.after = after.before;
+    report.vertices_after = after.vertices_before;
+
+    return report;
+}
+
+uint32_t SceneObjectMesh::GenerateLods(uint32_t lod_count,
+                                       float reduction_ratio,
+                                       float max_error) {
+    m_LodIndexArray.clear();
+    m_LodError.clear();
+
+    if (m_PrimitiveType != PrimitiveType::kPrimitiveTypeTriList ||
+        m_IndexArray.empty()) {
+        return 0;
+    }
+
+    const auto vertex_count = GetVertexCount();
+
+    std::vector<Vector3f> positions;
+    ReadPositions(positions, m_VertexArray, vertex_count);
+
+    if (positions.empty()) return 0;
+
+    // the simplifier reports errors relative to the largest extent
+    const auto bounding_box = GetBoundingBox();
+    const float extent =
+        2.0f * (std::max)({bounding_box.extent[0], bounding_box.extent[1],
+                           bounding_box.extent[2]});
+
+    std::vector<std::vector<uint32_t>> lods(m_IndexArray.size());
+    for (size_t i = 0; i < m_IndexArray.size(); i++) {
+        if (!ReadIndices(lods[i], m_IndexArray[i])) return 0;
+    }
+
+    // each level is simplified from the previous one, so its deviation
+    // from LOD 0 is bounded by the sum of the errors of the steps
+    float total_error = 0.0f;
+
+    for (uint32_t lod = 1; lod <= lod_count; lod++) {
+        size_t source_index_count = 0;
+        size_t result_index_count = 0;
+        float lod_error = 0.0f;
+        const float step_error = max_error - total_error;
+        if (step_error <= 0.0f) break;
+
+        std::vector<std::vector<uint32_t>> results(lods.size());
+        for (size_t i = 0; i < lods.size(); i++) {
+            const auto target_index_count =
+                static_cast<size_t>(lods[i].size() * reduction_ratio) / 3 * 3;
+            float error;
+            SimplifyMesh(results[i], lods[i], positions.data(), vertex_count,
+                         target_index_count, step_error, &error);
+            OptimizeVertexCache(results[i], vertex_count);
+
+            source_index_count += lods[i].size();
+            result_index_count += results[i].size();
+            lod_error = (std::max)(lod_error, error);
+        }
+
+        // stop when the simplifier could not make a meaningful progress
+        if (result_index_count == 0 ||
+            result_index_count > source_index_count * 0.9f) {
+            break;
+        }
+
+        std::vector<SceneObjectIndexArray> index_arrays;
+        for (size_t i = 0; i < results.size(); i++) {
+            index_arrays.push_back(WriteIndices(results[i], m_IndexArray[i]));
+        }
+
+        m_LodIndexArray.push_back(std::move(index_arrays));
+        total_error += lod_error;
+        m_LodError.push_back(total_error * extent);
+        lods.swap(results);
+    }
+
+    return static_cast<uint32_t>(m_LodIndexArray.size());
+}
+
+size_t SceneObjectMesh::BuildMeshlets(uint32_t max_vertices,
+                                      uint32_t max_triangles) {
+    m_Meshlets.clear();
+
+    if (m_PrimitiveType != PrimitiveType::kPrimitiveTypeTriList ||
+        m_IndexArray.empty()) {
+        return 0;
+    }
+
+    const auto vertex_count = GetVertexCount();
+
+    std::vector<Vector3f> positions;
+    ReadPositions(positions, m_VertexArray, vertex_count);
+    if (positions.empty()) return 0;
+
+    size_t total = 0;
+    std::vector<uint32_t> indices;
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> meshlet_vertices;
+    std::vector<uint8_t> meshlet_triangles;
+    std::vector<uint32_t> flat;
+
+    m_Meshlets.resize(m_IndexArray.size());
+    for (size_t i = 0; i < m_IndexArray.size(); i++) {
+        if (!ReadIndices(indices, m_IndexArray[i])) {
+            m_Meshlets.clear();
+            return 0;
+        }
+        My::BuildMeshlets(meshlets, meshlet_vertices, meshlet_triangles,
+                          indices, vertex_count, max_vertices, max_triangles);
+
+        auto& clusters = m_Meshlets[i];
+        FlattenMeshlets(flat, clusters.ranges, meshlets, meshlet_vertices,
+                        meshlet_triangles);
+        assert(flat == indices);
+
+        for (const auto& meshlet : meshlets) {
+            clusters.bounds.push_back(ComputeMeshletBounds(
+                meshlet, meshlet_vertices, meshlet_triangles,
+                positions.data()));
+        }
+
+        total += meshlets.size();
+    }
+
+    return total;
+}
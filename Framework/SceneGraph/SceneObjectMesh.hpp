@@ -3,18 +3,42 @@
 
 #include "BaseSceneObject.hpp"
 #include "ConvexHull.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
+#include "Meshlet.hpp"
 #include "SceneObjectIndexArray.hpp"
 #include "SceneObjectTypeDef.hpp"
 #include "SceneObjectVertexArray.hpp"
 #include "geommath.hpp"
 
 namespace My {
+struct MeshOptimizationReport {
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+    size_t vertices_before = 0;
+    size_t vertices_after = 0;
+};
+
+// meshlets of one index array, as ranges of that index array
+struct MeshletClusters {
+    std::vector<MeshletIndexRange> ranges;
+    std::vector<MeshletBounds> bounds;
+};
+
 class SceneObjectMesh : public BaseSceneObject {
    protected:
     std::vector<SceneObjectIndexArray> m_IndexArray;
     std::vector<SceneObjectVertexArray> m_VertexArray;
     PrimitiveType m_PrimitiveType{PrimitiveType::kPrimitiveTypeNone};
 
+    // simplified index arrays for LOD 1..n, sharing m_VertexArray
+    std::vector<std::vector<SceneObjectIndexArray>> m_LodIndexArray;
+    // object space error of LOD 1..n
+    std::vector<float> m_LodError;
+
+    // meshlets of each index array (LOD 0 only)
+    std::vector<MeshletClusters> m_Meshlets;
+
    public:
     explicit SceneObjectMesh(bool visible = true, bool shadow = true,
                              bool motion_blur = true)
@@ -23,7 +47,10 @@ class SceneObjectMesh : public BaseSceneObject {
         : BaseSceneObject(SceneObjectType::kSceneObjectTypeMesh),
           m_IndexArray(std::move(mesh.m_IndexArray)),
           m_VertexArray(std::move(mesh.m_VertexArray)),
-          m_PrimitiveType(mesh.m_PrimitiveType){};
+          m_PrimitiveType(mesh.m_PrimitiveType),
+          m_LodIndexArray(std::move(mesh.m_LodIndexArray)),
+          m_LodError(std::move(mesh.m_LodError)),
+          m_Meshlets(std::move(mesh.m_Meshlets)){};
     void AddIndexArray(SceneObjectIndexArray&& array) {
         m_IndexArray.push_back(std::forward<SceneObjectIndexArray>(array));
     };
@@ -53,8 +80,48 @@ class SceneObjectMesh : public BaseSceneObject {
         return m_IndexArray[index];
     };
     const PrimitiveType& GetPrimitiveType() { return m_PrimitiveType; };
+
+    // LOD 0 is the source index arrays
+    [[nodiscard]] uint32_t GetLodCount() const {
+        return static_cast<uint32_t>(m_LodIndexArray.size() + 1);
+    };
+    [[nodiscard]] const SceneObjectIndexArray& GetLodIndexArray(
+        const uint32_t lod, const size_t index) const {
+        return (lod == 0) ? m_IndexArray[index]
+                          : m_LodIndexArray[lod - 1][index];
+    };
+    [[nodiscard]] float GetLodError(const uint32_t lod) const {
+        return (lod == 0) ? 0.0f : m_LodError[lod - 1];
+    };
     [[nodiscard]] BoundingBox GetBoundingBox() const;
-    [[nodiscard]] ConvexHull<float> GetConvexHull() const;
+    // hull of the positions, with at most max_vertex_count vertices when
+    // not 0
+    [[nodiscard]] ConvexHull<float> GetConvexHull(
+        uint32_t max_vertex_count = 0) const;
+
+    // weld duplicate vertices, reorder triangles for post-transform cache
+    // and overdraw, then reorder vertices for fetch locality.
+    // only triangle lists without primitive restart are optimized, other
+    // meshes are left untouched.
+    MeshOptimizationReport Optimize(float overdraw_threshold = 1.05f);
+    [[nodiscard]] MeshOptimizationReport AnalyzeVertexCache() const;
+
+    // generate up to lod_count simplified index arrays, each one with
+    // about reduction_ratio of the triangles of the previous level, as long
+    // as the error accumulated from LOD 0 stays below max_error (relative to
+    // the mesh extent). returns the number of LODs generated.
+    uint32_t GenerateLods(uint32_t lod_count, float reduction_ratio = 0.5f,
+                          float max_error = 0.02f);
+
+    // split each index array into meshlets for cluster culling. the index
+    // arrays are not reordered, meshlets are consecutive triangles of them.
+    // returns the total number of meshlets.
+    size_t BuildMeshlets(uint32_t max_vertices = kMeshletMaxVertices,
+                         uint32_t max_triangles = kMeshletMaxTriangles);
+    [[nodiscard]] bool HasMeshlets() const { return !m_Meshlets.empty(); }
+    [[nodiscard]] const MeshletClusters& GetMeshlets(const size_t index) const {
+        return m_Meshlets[index];
+    };
 
     friend std::ostream& operator<<(std::ostream& out,
                                     const SceneObjectMesh& obj);
@@ -30,6 +30,21 @@ class SceneObjectTerrain : public BaseSceneObject {
         return m_Textures[index];
     }
 
+    // height maps of tile (i, j), as named by SetName
+    static constexpr uint32_t GetGridWidth() { return nMaxTerrainGridWidth; }
+    static constexpr uint32_t GetGridHeight() { return nMaxTerrainGridHeight; }
+    static constexpr uint32_t GetTileIndex(uint32_t i, uint32_t j) {
+        return i * nMaxTerrainGridHeight + j;
+    }
+
+    // world units between two texels, and the height of a texel at 1.0
+    void SetScale(float spacing, float height) {
+        m_fSpacing = spacing;
+        m_fHeightScale = height;
+    }
+    [[nodiscard]] float GetSpacing() const { return m_fSpacing; }
+    [[nodiscard]] float GetHeightScale() const { return m_fHeightScale; }
+
    private:
     static const int32_t nMaxTerrainGridWidth = 16;
     static const int32_t nMaxTerrainGridHeight = 16;
@@ -37,5 +52,7 @@ class SceneObjectTerrain : public BaseSceneObject {
         nMaxTerrainGridWidth * nMaxTerrainGridHeight;
 
     SceneObjectTexture m_Textures[nMaxTerrainHeightMapCount];
+    float m_fSpacing{1.0f};
+    float m_fHeightScale{1.0f};
 };
 }  // namespace My
\ No newline at end of file
@@ -11,8 +11,10 @@ using namespace std;
 #include "DDS.hpp"
 #include "HDR.hpp"
 #include "JPEG.hpp"
+#include "MemoryTracker.hpp"
 #include "PNG.hpp"
 #include "PVR.hpp"
+#include "Profiler.hpp"
 #include "TGA.hpp"
 
 void SceneObjectTexture::LoadTextureAsync() {
@@ -28,8 +30,11 @@ bool SceneObjectTexture::LoadTexture() {
 
     cerr << "Start async loading of " << m_Name << endl;
 
+    // the file and whatever the parser needs along the way
+    MemoryTagScope memory_tag(MemoryTag::kParsers);
     Image image;
     Buffer buf = assetLoader.SyncOpenAndReadBinary(m_Name.c_str());
+    PROFILE_SCOPE("ImageParser::Parse");
     string ext = m_Name.substr(m_Name.find_last_of('.'));
     if (ext == ".jpg" || ext == ".jpeg") {
         JfifParser jfif_parser;
@@ -61,7 +66,13 @@ bool SceneObjectTexture::LoadTexture() {
 
     cerr << "End async loading of " << m_Name << endl;
 
-    atomic_store_explicit(&m_pImage, make_shared<Image>(std::move(image)),
+    // the pixels are counted as long as the image is shared
+    MemoryTracker::RecordAllocation(MemoryTag::kTextures, image.data_size);
+    shared_ptr<Image> pImage(new Image(std::move(image)), [](Image* p) {
+        MemoryTracker::RecordFree(MemoryTag::kTextures, p->data_size);
+        delete p;
+    });
+    atomic_store_explicit(&m_pImage, std::move(pImage),
                           std::memory_order_release);
 
     return true;
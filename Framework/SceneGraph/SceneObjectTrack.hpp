@@ -33,6 +33,20 @@ class SceneObjectTrack : public BaseSceneObject,
           m_kTrackType(type) {}
     void Update(const float time_point) final;
 
+    [[nodiscard]] const std::shared_ptr<SceneObjectTransform>& GetTransform()
+        const {
+        return m_pTransform;
+    }
+    [[nodiscard]] const std::shared_ptr<CurveBase>& GetTimeCurve() const {
+        return m_Time;
+    }
+    [[nodiscard]] const std::shared_ptr<CurveBase>& GetValueCurve() const {
+        return m_Value;
+    }
+    [[nodiscard]] SceneObjectTrackType GetTrackType() const {
+        return m_kTrackType;
+    }
+
    private:
     template <typename U>
     void UpdateTransform(const U new_val);
@@ -89,6 +89,9 @@ class SceneObjectTranslation : public SceneObjectTransform {
         m_bSceneObjectOnly = object_only;
     }
 
+    // axis the scalar updates move along, 0 if there is none
+    [[nodiscard]] char GetKind() const { return m_Kind; }
+
     void Update(const float amount) final {
         switch (m_Kind) {
             case 'x':
@@ -160,6 +163,9 @@ class SceneObjectRotation : public SceneObjectTransform {
         m_bSceneObjectOnly = object_only;
     }
 
+    // axis the scalar updates turn about, 0 if there is none
+    [[nodiscard]] char GetKind() const { return m_Kind; }
+
     void Update(const float theta) final {
         switch (m_Kind) {
             case 'x':
@@ -221,6 +227,9 @@ class SceneObjectScale : public SceneObjectTransform {
         m_bSceneObjectOnly = object_only;
     }
 
+    // axis the scalar updates scale, 0 for all three
+    [[nodiscard]] char GetKind() const { return m_Kind; }
+
     void Update(const float amount) final {
         switch (m_Kind) {
             case 'x':
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 
+#include "MemoryTracker.hpp"
 #include "SceneObjectTypeDef.hpp"
 
 namespace My {
@@ -30,7 +31,12 @@ class SceneObjectVertexArray {
           m_nMorphTargetIndex(morph_index),
           m_DataType(data_type),
           m_pData(data),
-          m_szData(data_size){};
+          m_szData(data_size) {
+        // the data is owned from here on
+        if (m_pData) {
+            MemoryTracker::RecordAllocation(MemoryTag::kMeshes, GetDataSize());
+        }
+    }
 
     SceneObjectVertexArray(const SceneObjectVertexArray& rhs) = delete;
 
@@ -44,12 +50,18 @@ class SceneObjectVertexArray {
     }
 
     ~SceneObjectVertexArray() {
-        if (m_pData) delete[] m_pData;
+        if (m_pData) {
+            MemoryTracker::RecordFree(MemoryTag::kMeshes, GetDataSize());
+            delete[] m_pData;
+        }
     }
 
     [[nodiscard]] const std::string& GetAttributeName() const {
         return m_strAttribute;
     };
+    [[nodiscard]] uint32_t GetMorphTargetIndex() const {
+        return m_nMorphTargetIndex;
+    };
     [[nodiscard]] VertexDataType GetDataType() const { return m_DataType; };
     [[nodiscard]] size_t GetDataSize() const {
         size_t size = m_szData;
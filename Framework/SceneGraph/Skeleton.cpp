@@ -0,0 +1,185 @@
+#include "Skeleton.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CompiledAnimationClip.hpp"
+#include "SceneBoneNode.hpp"
+
+using namespace My;
+using namespace std;
+
+Matrix4X4f My::JointPoseToMatrix(const JointPose& pose) {
+    // scale, then rotate, then translate, rows being the images of the axes
+    Matrix4X4f matrix;
+    MatrixRotationQuaternion(matrix, pose.rotation);
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            matrix[r][c] *= pose.scale[r];
+        }
+        matrix[3][r] = pose.translation[r];
+    }
+    return matrix;
+}
+
+JointPose My::JointPoseFromMatrix(const Matrix4X4f& matrix) {
+    JointPose pose;
+    Matrix3X3f rotation;
+    for (int r = 0; r < 3; r++) {
+        const Vector3f row = {matrix[r][0], matrix[r][1], matrix[r][2]};
+        pose.scale[r] = Length(row);
+        for (int c = 0; c < 3; c++) {
+            rotation[r][c] = pose.scale[r] > 0.0f ? row[c] / pose.scale[r]
+                                                  : (r == c ? 1.0f : 0.0f);
+        }
+        pose.translation[r] = matrix[3][r];
+    }
+
+    // a mirror is a negative scale along x
+    const Vector3f x_axis = {rotation[0][0], rotation[0][1], rotation[0][2]};
+    const Vector3f y_axis = {rotation[1][0], rotation[1][1], rotation[1][2]};
+    const Vector3f z_axis = {rotation[2][0], rotation[2][1], rotation[2][2]};
+    float determinant;
+    DotProduct(determinant, CrossProduct(x_axis, y_axis), z_axis);
+    if (determinant < 0.0f) {
+        pose.scale[0] = -pose.scale[0];
+        for (int c = 0; c < 3; c++) rotation[0][c] = -rotation[0][c];
+    }
+
+    QuaternionRotationMatrix(pose.rotation, rotation);
+
+    return pose;
+}
+
+void My::BlendPoses(const JointPose* a, const JointPose* b, float weight,
+                    size_t count, JointPose* out) {
+    const float one_minus_weight = 1.0f - weight;
+    for (size_t i = 0; i < count; i++) {
+        const auto& qa = a[i].rotation;
+        const auto& qb = b[i].rotation;
+        const float dot =
+            qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        // q and -q are the same rotation, blend towards the nearer one
+        const float weight_b = dot < 0.0f ? -weight : weight;
+
+        Quaternion<float> rotation;
+        float length_squared = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            rotation[k] = qa[k] * one_minus_weight + qb[k] * weight_b;
+            length_squared += rotation[k] * rotation[k];
+        }
+        const float inverse_length = 1.0f / sqrt(length_squared);
+        for (int k = 0; k < 4; k++) {
+            out[i].rotation[k] = rotation[k] * inverse_length;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            out[i].translation[k] = a[i].translation[k] * one_minus_weight +
+                                    b[i].translation[k] * weight;
+            out[i].scale[k] =
+                a[i].scale[k] * one_minus_weight + b[i].scale[k] * weight;
+        }
+    }
+}
+
+int16_t Skeleton::AddJoint(const std::string& name, int16_t parent,
+                           const JointPose& bind_pose) {
+    assert(parent < static_cast<int16_t>(m_Parents.size()));
+    const auto index = static_cast<int16_t>(m_Parents.size());
+    m_Parents.push_back(parent);
+    m_Names.push_back(name);
+    m_BindPose.push_back(bind_pose);
+
+    // the model space bind pose, inverted
+    Matrix4X4f model = JointPoseToMatrix(bind_pose);
+    if (parent != kNoParent) {
+        Matrix4X4f parent_model = m_InverseBindMatrices[parent];
+        InverseMatrix4X4f(parent_model);
+        model = model * parent_model;
+    }
+    if (!InverseMatrix4X4f(model)) BuildIdentityMatrix(model);
+    m_InverseBindMatrices.push_back(model);
+
+    return index;
+}
+
+void Skeleton::AddBoneNodes(const BaseSceneNode& root, int16_t parent,
+                            std::vector<const BaseSceneNode*>& nodes) {
+    const auto joint =
+        AddJoint(root.GetName(), parent,
+                 JointPoseFromMatrix(*root.GetCalculatedTransform()));
+    nodes.push_back(&root);
+
+    for (const auto& child : root.GetChildren()) {
+        if (auto bone = dynamic_pointer_cast<SceneBoneNode>(child)) {
+            AddBoneNodes(*bone, joint, nodes);
+        }
+    }
+}
+
+int16_t Skeleton::FindJoint(const std::string& name) const {
+    auto it = find(m_Names.begin(), m_Names.end(), name);
+    return it == m_Names.end() ? kNoParent
+                               : static_cast<int16_t>(it - m_Names.begin());
+}
+
+void Skeleton::LocalToModel(const JointPose* local, Matrix4X4f* model) const {
+    for (size_t i = 0; i < m_Parents.size(); i++) {
+        model[i] = JointPoseToMatrix(local[i]);
+        if (m_Parents[i] != kNoParent) {
+            model[i] = model[i] * model[m_Parents[i]];
+        }
+    }
+}
+
+void Skeleton::GetSkinningMatrices(const Matrix4X4f* model,
+                                   Matrix4X4f* skinning) const {
+    for (size_t i = 0; i < m_Parents.size(); i++) {
+        skinning[i] = m_InverseBindMatrices[i] * model[i];
+    }
+}
+
+SkeletalAnimationClip::SkeletalAnimationClip(size_t joint_count,
+                                             float duration,
+                                             float sample_rate)
+    : m_nJointCount(joint_count),
+      m_nFrameCount(
+          static_cast<size_t>(ceil(max(duration, 0.0f) * sample_rate)) + 1),
+      m_fDuration(max(duration, 0.0f)),
+      m_fSampleRate(sample_rate),
+      m_Poses(m_nFrameCount * joint_count) {
+    // a little faster than asked, so the last frame is at the end
+    if (m_fDuration > 0.0f) {
+        m_fSampleRate = static_cast<float>(m_nFrameCount - 1) / m_fDuration;
+    }
+}
+
+void SkeletalAnimationClip::Record(
+    CompiledAnimationClip& clip,
+    const std::vector<const BaseSceneNode*>& nodes) {
+    assert(nodes.size() == m_nJointCount);
+    for (size_t frame = 0; frame < m_nFrameCount; frame++) {
+        clip.Evaluate(min(static_cast<float>(frame) / m_fSampleRate,
+                          m_fDuration));
+        auto* poses = GetFrame(frame);
+        for (size_t i = 0; i < m_nJointCount; i++) {
+            poses[i] =
+                JointPoseFromMatrix(*nodes[i]->GetCalculatedTransform());
+        }
+    }
+}
+
+void SkeletalAnimationClip::Sample(float time_point, JointPose* pose) const {
+    if (m_nFrameCount == 1) {
+        copy_n(GetFrame(0), m_nJointCount, pose);
+        return;
+    }
+
+    const float position =
+        clamp(time_point, 0.0f, m_fDuration) * m_fSampleRate;
+    const auto frame =
+        min(static_cast<size_t>(position), m_nFrameCount - 2);
+    BlendPoses(GetFrame(frame), GetFrame(frame + 1),
+               min(position - static_cast<float>(frame), 1.0f),
+               m_nJointCount, pose);
+}
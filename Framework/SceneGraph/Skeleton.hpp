@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BaseSceneNode.hpp"
+#include "geommath.hpp"
+
+namespace My {
+class CompiledAnimationClip;
+
+// local transform of a joint, relative to its parent
+struct JointPose {
+    Quaternion<float> rotation{0.0f, 0.0f, 0.0f, 1.0f};
+    Vector3f translation;
+    Vector3f scale{1.0f, 1.0f, 1.0f};
+};
+
+Matrix4X4f JointPoseToMatrix(const JointPose& pose);
+// rotation and scale of a matrix without shear
+JointPose JointPoseFromMatrix(const Matrix4X4f& matrix);
+
+// a + (b - a) * weight for each of the count joints, rotations by nlerp
+// along the shorter arc. out may be a or b.
+void BlendPoses(const JointPose* a, const JointPose* b, float weight,
+                size_t count, JointPose* out);
+
+// Joints in flat arrays, a parent always before its children, so the model
+// space pose is one pass over the parent indices.
+class Skeleton {
+   public:
+    static constexpr int16_t kNoParent = -1;
+
+    // parent must already be in the skeleton, the model space bind pose is
+    // taken from bind_pose
+    int16_t AddJoint(const std::string& name, int16_t parent,
+                     const JointPose& bind_pose);
+
+    // the bone nodes under root, root included, depth first. The nodes are
+    // appended to nodes in joint order, their current transforms are the
+    // bind pose.
+    void AddBoneNodes(const BaseSceneNode& root, int16_t parent,
+                      std::vector<const BaseSceneNode*>& nodes);
+
+    [[nodiscard]] size_t GetJointCount() const { return m_Parents.size(); }
+    [[nodiscard]] const std::vector<int16_t>& GetParents() const {
+        return m_Parents;
+    }
+    [[nodiscard]] const std::vector<JointPose>& GetBindPose() const {
+        return m_BindPose;
+    }
+    [[nodiscard]] const std::vector<Matrix4X4f>& GetInverseBindMatrices()
+        const {
+        return m_InverseBindMatrices;
+    }
+    // kNoParent if there is no such joint
+    [[nodiscard]] int16_t FindJoint(const std::string& name) const;
+
+    // model = local * model of the parent
+    void LocalToModel(const JointPose* local, Matrix4X4f* model) const;
+    // what takes a vertex of the bind pose to the model space pose
+    void GetSkinningMatrices(const Matrix4X4f* model,
+                             Matrix4X4f* skinning) const;
+
+   private:
+    std::vector<int16_t> m_Parents;
+    std::vector<std::string> m_Names;
+    std::vector<JointPose> m_BindPose;
+    std::vector<Matrix4X4f> m_InverseBindMatrices;
+};
+
+// The local poses of every joint sampled at a fixed rate, so sampling is
+// two frames and a blend whatever the curves of the source clip were.
+class SkeletalAnimationClip {
+   public:
+    SkeletalAnimationClip(size_t joint_count, float duration,
+                          float sample_rate);
+
+    // evaluates clip at each frame and reads back the local transforms of
+    // the bone nodes it animates, in joint order
+    void Record(CompiledAnimationClip& clip,
+                const std::vector<const BaseSceneNode*>& nodes);
+
+    [[nodiscard]] size_t GetJointCount() const { return m_nJointCount; }
+    [[nodiscard]] size_t GetFrameCount() const { return m_nFrameCount; }
+    [[nodiscard]] float GetDuration() const { return m_fDuration; }
+    [[nodiscard]] float GetSampleRate() const { return m_fSampleRate; }
+
+    // the joint_count poses of a frame
+    JointPose* GetFrame(size_t frame) {
+        return &m_Poses[frame * m_nJointCount];
+    }
+    [[nodiscard]] const JointPose* GetFrame(size_t frame) const {
+        return &m_Poses[frame * m_nJointCount];
+    }
+
+    // time_point is clamped to the clip
+    void Sample(float time_point, JointPose* pose) const;
+
+   private:
+    size_t m_nJointCount;
+    size_t m_nFrameCount;
+    float m_fDuration;
+    float m_fSampleRate;
+    // by frame, then by joint
+    std::vector<JointPose> m_Poses;
+};
+}  // namespace My
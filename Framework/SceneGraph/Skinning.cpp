@@ -0,0 +1,208 @@
+#include "Skinning.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Skeleton.hpp"
+
+using namespace My;
+using namespace std;
+
+namespace {
+// vertices skinned together. The joints of each vertex are gathered one
+// vertex at a time, everything after that is a loop over the lanes, which
+// is what the compiler vectorizes.
+constexpr size_t kLanes = 8;
+
+struct Lanes3 {
+    float x[kLanes];
+    float y[kLanes];
+    float z[kLanes];
+};
+
+struct Lanes4 {
+    float x[kLanes];
+    float y[kLanes];
+    float z[kLanes];
+    float w[kLanes];
+};
+
+// float3 of count vertices from base, by component. The lanes past count
+// are 0 so they can go through the same arithmetic.
+void load(const float* stream, size_t base, size_t count, Lanes3& lanes) {
+    for (size_t l = 0; l < kLanes; l++) {
+        const float* v = stream + (base + min(l, count - 1)) * 3;
+        const float used = l < count ? 1.0f : 0.0f;
+        lanes.x[l] = v[0] * used;
+        lanes.y[l] = v[1] * used;
+        lanes.z[l] = v[2] * used;
+    }
+}
+
+void store(const Lanes3& lanes, size_t base, size_t count, float* stream) {
+    for (size_t l = 0; l < count; l++) {
+        float* v = stream + (base + l) * 3;
+        v[0] = lanes.x[l];
+        v[1] = lanes.y[l];
+        v[2] = lanes.z[l];
+    }
+}
+
+// rotates v by the unit quaternion (r, w): v + 2 r x (r x v + w v).
+// Without __restrict the compiler keeps it scalar rather than checking
+// whether result overlaps the inputs.
+void rotate(const Lanes4& __restrict r, const Lanes3& __restrict v,
+            Lanes3& __restrict result) {
+    for (size_t l = 0; l < kLanes; l++) {
+        const float x = r.x[l], y = r.y[l], z = r.z[l], w = r.w[l];
+        const float ax = y * v.z[l] - z * v.y[l] + w * v.x[l];
+        const float ay = z * v.x[l] - x * v.z[l] + w * v.y[l];
+        const float az = x * v.y[l] - y * v.x[l] + w * v.z[l];
+        result.x[l] = v.x[l] + 2.0f * (y * az - z * ay);
+        result.y[l] = v.y[l] + 2.0f * (z * ax - x * az);
+        result.z[l] = v.z[l] + 2.0f * (x * ay - y * ax);
+    }
+}
+}  // namespace
+
+void My::BuildDualQuaternions(const Matrix4X4f* skinning, size_t count,
+                              DualQuaternion* result) {
+    for (size_t i = 0; i < count; i++) {
+        const auto& r = result[i].real =
+            JointPoseFromMatrix(skinning[i]).rotation;
+        const float tx = skinning[i][3][0];
+        const float ty = skinning[i][3][1];
+        const float tz = skinning[i][3][2];
+        // 0.5 * (t, 0) * r
+        result[i].dual = {
+            0.5f * (r[3] * tx + ty * r[2] - tz * r[1]),
+            0.5f * (r[3] * ty + tz * r[0] - tx * r[2]),
+            0.5f * (r[3] * tz + tx * r[1] - ty * r[0]),
+            -0.5f * (tx * r[0] + ty * r[1] + tz * r[2])};
+    }
+}
+
+void My::SkinLinearBlend(const Matrix4X4f* skinning,
+                         const SkinningStreams& streams, size_t begin,
+                         size_t end) {
+    for (size_t base = begin; base < end; base += kLanes) {
+        const size_t count = min(kLanes, end - base);
+
+        // the weighted sum of the joint matrices, first 3 columns of the 4
+        // rows, as 12 rows of lanes
+        float m[12][kLanes] = {};
+        for (size_t l = 0; l < count; l++) {
+            for (uint32_t k = 0; k < kMaxJointInfluences; k++) {
+                const size_t i = (base + l) * kMaxJointInfluences + k;
+                const float weight = streams.weights[i];
+                if (weight == 0.0f) continue;
+                const float* joint = skinning[streams.joints[i]];
+                for (int r = 0; r < 4; r++) {
+                    m[r * 3 + 0][l] += weight * joint[r * 4 + 0];
+                    m[r * 3 + 1][l] += weight * joint[r * 4 + 1];
+                    m[r * 3 + 2][l] += weight * joint[r * 4 + 2];
+                }
+            }
+        }
+
+        Lanes3 in, out;
+        load(streams.positions, base, count, in);
+        for (size_t l = 0; l < kLanes; l++) {
+            out.x[l] = in.x[l] * m[0][l] + in.y[l] * m[3][l] +
+                       in.z[l] * m[6][l] + m[9][l];
+            out.y[l] = in.x[l] * m[1][l] + in.y[l] * m[4][l] +
+                       in.z[l] * m[7][l] + m[10][l];
+            out.z[l] = in.x[l] * m[2][l] + in.y[l] * m[5][l] +
+                       in.z[l] * m[8][l] + m[11][l];
+        }
+        store(out, base, count, streams.skinnedPositions);
+
+        if (!streams.normals) continue;
+        load(streams.normals, base, count, in);
+        for (size_t l = 0; l < kLanes; l++) {
+            out.x[l] =
+                in.x[l] * m[0][l] + in.y[l] * m[3][l] + in.z[l] * m[6][l];
+            out.y[l] =
+                in.x[l] * m[1][l] + in.y[l] * m[4][l] + in.z[l] * m[7][l];
+            out.z[l] =
+                in.x[l] * m[2][l] + in.y[l] * m[5][l] + in.z[l] * m[8][l];
+        }
+        store(out, base, count, streams.skinnedNormals);
+    }
+}
+
+void My::SkinDualQuaternion(const DualQuaternion* transforms,
+                            const SkinningStreams& streams, size_t begin,
+                            size_t end) {
+    for (size_t base = begin; base < end; base += kLanes) {
+        const size_t count = min(kLanes, end - base);
+
+        // the weighted sum of the dual quaternions, each on the side of
+        // the first one so that opposite quaternions do not cancel out
+        Lanes4 real = {};
+        Lanes4 dual = {};
+        for (size_t l = 0; l < count; l++) {
+            const size_t first = (base + l) * kMaxJointInfluences;
+            const auto& pivot = transforms[streams.joints[first]].real;
+            for (uint32_t k = 0; k < kMaxJointInfluences; k++) {
+                float weight = streams.weights[first + k];
+                if (weight == 0.0f) continue;
+                const auto& dq = transforms[streams.joints[first + k]];
+                const float dot = pivot[0] * dq.real[0] +
+                                  pivot[1] * dq.real[1] +
+                                  pivot[2] * dq.real[2] + pivot[3] * dq.real[3];
+                if (dot < 0.0f) weight = -weight;
+                real.x[l] += weight * dq.real[0];
+                real.y[l] += weight * dq.real[1];
+                real.z[l] += weight * dq.real[2];
+                real.w[l] += weight * dq.real[3];
+                dual.x[l] += weight * dq.dual[0];
+                dual.y[l] += weight * dq.dual[1];
+                dual.z[l] += weight * dq.dual[2];
+                dual.w[l] += weight * dq.dual[3];
+            }
+        }
+
+        // unused lanes are all 0 and stay so. On its own, the branch of
+        // sqrt() setting errno would keep the loop below scalar.
+        float inverse_length[kLanes];
+        for (size_t l = 0; l < kLanes; l++) {
+            const float length_squared =
+                real.x[l] * real.x[l] + real.y[l] * real.y[l] +
+                real.z[l] * real.z[l] + real.w[l] * real.w[l];
+            inverse_length[l] =
+                length_squared > 0.0f ? 1.0f / sqrt(length_squared) : 0.0f;
+        }
+
+        // normalized, and the translation 2 * dual * conjugate(real)
+        Lanes3 translation;
+        for (size_t l = 0; l < kLanes; l++) {
+            const float x = real.x[l] *= inverse_length[l];
+            const float y = real.y[l] *= inverse_length[l];
+            const float z = real.z[l] *= inverse_length[l];
+            const float w = real.w[l] *= inverse_length[l];
+            const float dx = dual.x[l] * inverse_length[l];
+            const float dy = dual.y[l] * inverse_length[l];
+            const float dz = dual.z[l] * inverse_length[l];
+            const float dw = dual.w[l] * inverse_length[l];
+            translation.x[l] = 2.0f * (w * dx - dw * x + y * dz - z * dy);
+            translation.y[l] = 2.0f * (w * dy - dw * y + z * dx - x * dz);
+            translation.z[l] = 2.0f * (w * dz - dw * z + x * dy - y * dx);
+        }
+
+        Lanes3 in, out;
+        load(streams.positions, base, count, in);
+        rotate(real, in, out);
+        for (size_t l = 0; l < kLanes; l++) {
+            out.x[l] += translation.x[l];
+            out.y[l] += translation.y[l];
+            out.z[l] += translation.z[l];
+        }
+        store(out, base, count, streams.skinnedPositions);
+
+        if (!streams.normals) continue;
+        load(streams.normals, base, count, in);
+        rotate(real, in, out);
+        store(out, base, count, streams.skinnedNormals);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "geommath.hpp"
+
+namespace My {
+// joints a vertex at most, the weights of the unused ones are 0
+constexpr uint32_t kMaxJointInfluences = 4;
+
+// a rotation followed by a translation, the dual part being
+// 0.5 * translation * real
+struct DualQuaternion {
+    Quaternion<float> real{0.0f, 0.0f, 0.0f, 1.0f};
+    Quaternion<float> dual;
+};
+
+// the rotation and translation of each skinning matrix, scale is dropped
+void BuildDualQuaternions(const Matrix4X4f* skinning, size_t count,
+                          DualQuaternion* result);
+
+// The vertex streams of one skinned mesh. Positions and normals are float3
+// a vertex, as the "position" and "normal" vertex arrays are, so the
+// skinned streams can be uploaded as they are. joints and weights are
+// kMaxJointInfluences a vertex.
+struct SkinningStreams {
+    const uint16_t* joints;
+    const float* weights;
+    const float* positions;
+    const float* normals;  // may be null
+    float* skinnedPositions;
+    float* skinnedNormals;  // null if normals is
+};
+
+// Vertices [begin, end) of streams, several vertices at a time. Disjoint
+// ranges of one mesh can be skinned on different threads.
+//
+// Linear blend skinning takes any matrix but collapses volume at twisting
+// joints, dual quaternion skinning keeps it but only takes rigid
+// transforms. Normals are not renormalized after a scale.
+void SkinLinearBlend(const Matrix4X4f* skinning,
+                     const SkinningStreams& streams, size_t begin,
+                     size_t end);
+void SkinDualQuaternion(const DualQuaternion* transforms,
+                        const SkinningStreams& streams, size_t begin,
+                        size_t end);
+}  // namespace My
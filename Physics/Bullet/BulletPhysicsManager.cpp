@@ -3,10 +3,34 @@
 #include <iostream>
 
 #include "BaseApplication.hpp"
+#include "BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h"
 
 using namespace My;
 using namespace std;
 
+namespace {
+Matrix4X4f to_matrix(const btTransform& trans) {
+    Matrix4X4f result;
+    auto basis = trans.getBasis();
+    auto origin = trans.getOrigin();
+    BuildIdentityMatrix(result);
+    result.data[0][0] = static_cast<float>(basis[0][0]);
+    result.data[1][0] = static_cast<float>(basis[0][1]);
+    result.data[2][0] = static_cast<float>(basis[0][2]);
+    result.data[0][1] = static_cast<float>(basis[1][0]);
+    result.data[1][1] = static_cast<float>(basis[1][1]);
+    result.data[2][1] = static_cast<float>(basis[1][2]);
+    result.data[0][2] = static_cast<float>(basis[2][0]);
+    result.data[1][2] = static_cast<float>(basis[2][1]);
+    result.data[2][2] = static_cast<float>(basis[2][2]);
+    result.data[3][0] = static_cast<float>(origin.getX());
+    result.data[3][1] = static_cast<float>(origin.getY());
+    result.data[3][2] = static_cast<float>(origin.getZ());
+
+    return result;
+}
+}  // namespace
+
 int BulletPhysicsManager::Initialize() {
     // Build the broadphase
     m_btBroadphase = new btDbvtBroadphase();
@@ -47,7 +71,27 @@ void BulletPhysicsManager::Tick() {
         m_nSceneRevision = rev;
     }
 
-    m_btDynamicsWorld->stepSimulation(1.0f / 60.0f, 10);
+    const float frame_time =
+        (m_fFixedFrameTime > 0.0f) ? m_fFixedFrameTime : 1.0f / 60.0f;
+    m_btDynamicsWorld->stepSimulation(frame_time, 10);
+
+    m_Transforms.resize(m_btRigidBodies.size());
+    for (size_t i = 0; i < m_btRigidBodies.size(); i++) {
+        if (!m_btRigidBodies[i]) continue;
+        btTransform trans;
+        m_btRigidBodies[i]->getMotionState()->getWorldTransform(trans);
+        m_Transforms[i] = to_matrix(trans);
+    }
+}
+
+size_t BulletPhysicsManager::GetContactCount() {
+    size_t count = 0;
+    const int manifold_count = m_btDispatcher->getNumManifolds();
+    for (int i = 0; i < manifold_count; i++) {
+        count +=
+            m_btDispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+    }
+    return count;
 }
 
 void BulletPhysicsManager::CreateRigidBody(
@@ -123,7 +167,13 @@ void BulletPhysicsManager::CreateRigidBody(
         default:;
     }
 
-    node.LinkRigidBody(rigidBody);
+    uint32_t handle = 0;
+    if (rigidBody) {
+        handle = static_cast<uint32_t>(m_btRigidBodies.size());
+        rigidBody->setUserIndex(static_cast<int>(handle));
+        m_btRigidBodies.push_back(rigidBody);
+    }
+    node.LinkRigidBody(rigidBody, handle);
 }
 
 void BulletPhysicsManager::UpdateRigidBodyTransform(SceneGeometryNode& node) {
@@ -146,6 +196,7 @@ void BulletPhysicsManager::DeleteRigidBody(SceneGeometryNode& node) {
     auto* rigidBody = reinterpret_cast<btRigidBody*>(node.UnlinkRigidBody());
     if (rigidBody) {
         m_btDynamicsWorld->removeRigidBody(rigidBody);
+        m_btRigidBodies[rigidBody->getUserIndex()] = nullptr;
 
         delete rigidBody->getMotionState();
         delete rigidBody;
@@ -189,31 +240,15 @@ void BulletPhysicsManager::ClearRigidBodies() {
     }
 
     m_btCollisionShapes.clear();
+    m_btRigidBodies.clear();
 }
 
 Matrix4X4f BulletPhysicsManager::GetRigidBodyTransform(void* rigidBody) {
-    Matrix4X4f result;
     btTransform trans;
     reinterpret_cast<btRigidBody*>(rigidBody)
         ->getMotionState()
         ->getWorldTransform(trans);
-    auto basis = trans.getBasis();
-    auto origin = trans.getOrigin();
-    BuildIdentityMatrix(result);
-    result.data[0][0] = static_cast<float>(basis[0][0]);
-    result.data[1][0] = static_cast<float>(basis[0][1]);
-    result.data[2][0] = static_cast<float>(basis[0][2]);
-    result.data[0][1] = static_cast<float>(basis[1][0]);
-    result.data[1][1] = static_cast<float>(basis[1][1]);
-    result.data[2][1] = static_cast<float>(basis[1][2]);
-    result.data[0][2] = static_cast<float>(basis[2][0]);
-    result.data[1][2] = static_cast<float>(basis[2][1]);
-    result.data[2][2] = static_cast<float>(basis[2][2]);
-    result.data[3][0] = static_cast<float>(origin.getX());
-    result.data[3][1] = static_cast<float>(origin.getY());
-    result.data[3][2] = static_cast<float>(origin.getZ());
-
-    return result;
+    return to_matrix(trans);
 }
 
 void BulletPhysicsManager::ApplyCentralForce(void* rigidBody, Vector3f force) {
@@ -221,4 +256,170 @@ void BulletPhysicsManager::ApplyCentralForce(void* rigidBody, Vector3f force) {
     btVector3 _force(force[0], force[1], force[2]);
     _rigidBody->activate(true);
     _rigidBody->applyCentralForce(_force);
-}
\ No newline at end of file
+}
+
+namespace {
+inline btVector3 to_bullet(const Vector3f& v) {
+    return btVector3(v[0], v[1], v[2]);
+}
+
+inline Vector3f from_bullet(const btVector3& v) {
+    return Vector3f({static_cast<float>(v.getX()),
+                     static_cast<float>(v.getY()),
+                     static_cast<float>(v.getZ())});
+}
+
+// quaternions are stored as (x, y, z, w)
+inline btTransform to_bullet(const Vector3f& position,
+                             const Quaternion<float>& orientation) {
+    return btTransform(btQuaternion(orientation[0], orientation[1],
+                                    orientation[2], orientation[3]),
+                       to_bullet(position));
+}
+
+// the query shape, on the stack
+struct QueryShape {
+    explicit QueryShape(const PhysicsQueryShape& query)
+        : sphere(query.radius),
+          box(to_bullet(query.halfExtents)),
+          type(query.type) {}
+
+    btConvexShape* Get() {
+        if (type == GeometryType::kBox) return &box;
+        return &sphere;
+    }
+
+    btSphereShape sphere;
+    btBoxShape box;
+    GeometryType type;
+};
+
+inline void* rigid_body_of(const btCollisionObject* object) {
+    return const_cast<btRigidBody*>(btRigidBody::upcast(object));
+}
+
+struct RayCallback : btCollisionWorld::ClosestRayResultCallback {
+    RayCallback(const btVector3& from, const btVector3& to, void* ignored)
+        : ClosestRayResultCallback(from, to), m_pIgnored(ignored) {}
+
+    bool needsCollision(btBroadphaseProxy* proxy) const override {
+        return proxy->m_clientObject != m_pIgnored &&
+               ClosestRayResultCallback::needsCollision(proxy);
+    }
+
+    void* m_pIgnored;
+};
+
+struct SweepCallback : btCollisionWorld::ClosestConvexResultCallback {
+    SweepCallback(const btVector3& from, const btVector3& to, void* ignored)
+        : ClosestConvexResultCallback(from, to), m_pIgnored(ignored) {}
+
+    bool needsCollision(btBroadphaseProxy* proxy) const override {
+        return proxy->m_clientObject != m_pIgnored &&
+               ClosestConvexResultCallback::needsCollision(proxy);
+    }
+
+    void* m_pIgnored;
+};
+
+// collects the distinct bodies touching the query object
+struct OverlapCallback : btCollisionWorld::ContactResultCallback {
+    OverlapCallback(const btCollisionObject* query, void** results,
+                    uint32_t max_results, void* ignored)
+        : m_pQuery(query),
+          m_pResults(results),
+          m_nMaxResults(max_results),
+          m_pIgnored(ignored) {}
+
+    bool needsCollision(btBroadphaseProxy* proxy) const override {
+        return proxy->m_clientObject != m_pIgnored &&
+               ContactResultCallback::needsCollision(proxy);
+    }
+
+    btScalar addSingleResult(btManifoldPoint& point,
+                             const btCollisionObjectWrapper* object0, int,
+                             int, const btCollisionObjectWrapper* object1,
+                             int, int) override {
+        if (point.getDistance() > 0.0 || m_nCount == m_nMaxResults) {
+            return 0.0;
+        }
+        const btCollisionObject* other = object0->getCollisionObject();
+        if (other == m_pQuery) other = object1->getCollisionObject();
+        void* rigidBody = rigid_body_of(other);
+        for (uint32_t i = 0; i < m_nCount; i++) {
+            if (m_pResults[i] == rigidBody) return 0.0;
+        }
+        m_pResults[m_nCount++] = rigidBody;
+        return 0.0;
+    }
+
+    const btCollisionObject* m_pQuery;
+    void** m_pResults;
+    uint32_t m_nMaxResults;
+    uint32_t m_nCount{0};
+    void* m_pIgnored;
+};
+}  // namespace
+
+void BulletPhysicsManager::CastRays(const PhysicsRay* rays, size_t count,
+                                    PhysicsQueryHit* hits) {
+    for (size_t i = 0; i < count; i++) {
+        const auto& ray = rays[i];
+        auto& hit = hits[i];
+        const btVector3 from = to_bullet(ray.origin);
+        const btVector3 to =
+            to_bullet(ray.origin + ray.direction * ray.maxDistance);
+        RayCallback callback(from, to, ray.ignoredRigidBody);
+        m_btDynamicsWorld->rayTest(from, to, callback);
+
+        hit.rigidBody = nullptr;
+        if (!callback.hasHit()) continue;
+        hit.rigidBody = rigid_body_of(callback.m_collisionObject);
+        hit.distance = static_cast<float>(callback.m_closestHitFraction) *
+                       ray.maxDistance;
+        hit.point = from_bullet(callback.m_hitPointWorld);
+        hit.normal = from_bullet(callback.m_hitNormalWorld);
+    }
+}
+
+void BulletPhysicsManager::OverlapShapes(const PhysicsQueryShape* shapes,
+                                         size_t count, void** rigid_bodies,
+                                         uint32_t max_results,
+                                         uint32_t* result_counts) {
+    for (size_t i = 0; i < count; i++) {
+        const auto& query = shapes[i];
+        QueryShape shape(query);
+        btCollisionObject object;
+        object.setCollisionShape(shape.Get());
+        object.setWorldTransform(to_bullet(query.position, query.orientation));
+
+        OverlapCallback callback(&object, rigid_bodies + i * max_results,
+                                 max_results, query.ignoredRigidBody);
+        m_btDynamicsWorld->contactTest(&object, callback);
+        result_counts[i] = callback.m_nCount;
+    }
+}
+
+void BulletPhysicsManager::SweepShapes(const PhysicsShapeSweep* sweeps,
+                                       size_t count, PhysicsQueryHit* hits) {
+    for (size_t i = 0; i < count; i++) {
+        const auto& sweep = sweeps[i];
+        auto& hit = hits[i];
+        QueryShape shape(sweep);
+        const btTransform from = to_bullet(sweep.position, sweep.orientation);
+        const btTransform to = to_bullet(
+            sweep.position + sweep.direction * sweep.maxDistance,
+            sweep.orientation);
+        SweepCallback callback(from.getOrigin(), to.getOrigin(),
+                               sweep.ignoredRigidBody);
+        m_btDynamicsWorld->convexSweepTest(shape.Get(), from, to, callback);
+
+        hit.rigidBody = nullptr;
+        if (!callback.hasHit()) continue;
+        hit.rigidBody = rigid_body_of(callback.m_hitCollisionObject);
+        hit.distance = static_cast<float>(callback.m_closestHitFraction) *
+                       sweep.maxDistance;
+        hit.point = from_bullet(callback.m_hitPointWorld);
+        hit.normal = from_bullet(callback.m_hitNormalWorld);
+    }
+}
@@ -20,12 +20,30 @@ class BulletPhysicsManager : public PhysicsManager {
     void ClearRigidBodies() override;
 
     Matrix4X4f GetRigidBodyTransform(void* rigidBody) override;
+    PhysicsTransforms GetRigidBodyTransforms() override {
+        return {m_Transforms.data(), m_Transforms.size()};
+    }
     void UpdateRigidBodyTransform(SceneGeometryNode& node) override;
 
     void ApplyCentralForce(void* rigidBody, Vector3f force) override;
 
+    void SetFixedFrameTime(float frame_time) override {
+        m_fFixedFrameTime = frame_time;
+    }
+    size_t GetContactCount() override;
+
+    // one query after the other, Bullet's queries are not thread safe
+    void CastRays(const PhysicsRay* rays, size_t count,
+                  PhysicsQueryHit* hits) override;
+    void OverlapShapes(const PhysicsQueryShape* shapes, size_t count,
+                       void** rigid_bodies, uint32_t max_results,
+                       uint32_t* result_counts) override;
+    void SweepShapes(const PhysicsShapeSweep* sweeps, size_t count,
+                     PhysicsQueryHit* hits) override;
+
    protected:
     uint64_t m_nSceneRevision{0};
+    float m_fFixedFrameTime{0.0f};
     btBroadphaseInterface* m_btBroadphase;
     btDefaultCollisionConfiguration* m_btCollisionConfiguration;
     btCollisionDispatcher* m_btDispatcher;
@@ -33,5 +51,9 @@ class BulletPhysicsManager : public PhysicsManager {
     btDiscreteDynamicsWorld* m_btDynamicsWorld;
 
     std::vector<btCollisionShape*> m_btCollisionShapes;
+    // the handle of a body is its user index, slots are reused once the
+    // bodies are cleared
+    std::vector<btRigidBody*> m_btRigidBodies;
+    std::vector<Matrix4X4f> m_Transforms;
 };
 }  // namespace My
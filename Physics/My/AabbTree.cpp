@@ -0,0 +1,292 @@
+#include "AabbTree.hpp"
+
+#include <algorithm>
+
+using namespace My;
+using namespace std;
+
+namespace {
+// how many steps ahead of the motion the fat bounds reach
+const float kDisplacementMultiplier = 4.0f;
+
+inline float surface_area(const Vector3f& min, const Vector3f& max) {
+    const float dx = max[0] - min[0];
+    const float dy = max[1] - min[1];
+    const float dz = max[2] - min[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+inline void merge(const Vector3f& min_a, const Vector3f& max_a,
+                  const Vector3f& min_b, const Vector3f& max_b, Vector3f& min,
+                  Vector3f& max) {
+    for (int i = 0; i < 3; i++) {
+        min[i] = std::min(min_a[i], min_b[i]);
+        max[i] = std::max(max_a[i], max_b[i]);
+    }
+}
+
+inline bool contains(const Vector3f& outer_min, const Vector3f& outer_max,
+                     const Vector3f& min, const Vector3f& max) {
+    return outer_min[0] <= min[0] && outer_min[1] <= min[1] &&
+           outer_min[2] <= min[2] && max[0] <= outer_max[0] &&
+           max[1] <= outer_max[1] && max[2] <= outer_max[2];
+}
+}  // namespace
+
+int32_t AabbTree::allocateNode() {
+    if (m_nFreeList == kNullNode) {
+        m_Nodes.emplace_back();
+        m_Nodes.back().parent = kNullNode;
+        m_nFreeList = static_cast<int32_t>(m_Nodes.size() - 1);
+    }
+
+    const int32_t node = m_nFreeList;
+    m_nFreeList = m_Nodes[node].parent;
+
+    auto& n = m_Nodes[node];
+    n.parent = kNullNode;
+    n.child1 = kNullNode;
+    n.child2 = kNullNode;
+    n.height = 0;
+    n.userData = 0;
+    return node;
+}
+
+void AabbTree::freeNode(int32_t node) {
+    m_Nodes[node].parent = m_nFreeList;
+    m_Nodes[node].height = -1;
+    m_nFreeList = node;
+}
+
+int32_t AabbTree::CreateProxy(const Vector3f& min, const Vector3f& max,
+                              uint32_t user_data, float margin) {
+    const int32_t proxy = allocateNode();
+    const Vector3f fat(margin);
+    m_Nodes[proxy].min = min - fat;
+    m_Nodes[proxy].max = max + fat;
+    m_Nodes[proxy].userData = user_data;
+
+    insertLeaf(proxy);
+    m_nProxyCount++;
+    return proxy;
+}
+
+void AabbTree::DestroyProxy(int32_t proxy) {
+    assert(m_Nodes[proxy].IsLeaf());
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    m_nProxyCount--;
+}
+
+bool AabbTree::MoveProxy(int32_t proxy, const Vector3f& min,
+                         const Vector3f& max, const Vector3f& displacement,
+                         float margin) {
+    assert(m_Nodes[proxy].IsLeaf());
+
+    if (contains(m_Nodes[proxy].min, m_Nodes[proxy].max, min, max)) {
+        return false;
+    }
+
+    removeLeaf(proxy);
+
+    // extend the bounds in the direction of the motion, so that the proxy
+    // stays inside them for a few steps
+    Vector3f fat_min = min - Vector3f(margin);
+    Vector3f fat_max = max + Vector3f(margin);
+    for (int i = 0; i < 3; i++) {
+        const float d = displacement[i] * kDisplacementMultiplier;
+        if (d < 0.0f) {
+            fat_min[i] += d;
+        } else {
+            fat_max[i] += d;
+        }
+    }
+    m_Nodes[proxy].min = fat_min;
+    m_Nodes[proxy].max = fat_max;
+
+    insertLeaf(proxy);
+    return true;
+}
+
+void AabbTree::Clear() {
+    m_Nodes.clear();
+    m_nRoot = kNullNode;
+    m_nFreeList = kNullNode;
+    m_nProxyCount = 0;
+}
+
+void AabbTree::insertLeaf(int32_t leaf) {
+    if (m_nRoot == kNullNode) {
+        m_nRoot = leaf;
+        m_Nodes[leaf].parent = kNullNode;
+        return;
+    }
+
+    const Vector3f leaf_min = m_Nodes[leaf].min;
+    const Vector3f leaf_max = m_Nodes[leaf].max;
+
+    // descend to the sibling with the lowest cost: the area of the new
+    // parent plus the growth of all the ancestors
+    int32_t index = m_nRoot;
+    while (!m_Nodes[index].IsLeaf()) {
+        const Node& node = m_Nodes[index];
+
+        Vector3f min, max;
+        merge(node.min, node.max, leaf_min, leaf_max, min, max);
+        const float area = surface_area(node.min, node.max);
+        const float combined_area = surface_area(min, max);
+
+        // cost of making a new parent for this node and the leaf
+        const float cost = 2.0f * combined_area;
+        // cost pushed down to the children
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](int32_t child) {
+            const Node& c = m_Nodes[child];
+            Vector3f child_min, child_max;
+            merge(c.min, c.max, leaf_min, leaf_max, child_min, child_max);
+            float result = surface_area(child_min, child_max);
+            if (!c.IsLeaf()) result -= surface_area(c.min, c.max);
+            return result + inheritance_cost;
+        };
+
+        const float cost1 = child_cost(node.child1);
+        const float cost2 = child_cost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+
+        index = (cost1 < cost2) ? node.child1 : node.child2;
+    }
+
+    const int32_t sibling = index;
+    const int32_t old_parent = m_Nodes[sibling].parent;
+    const int32_t new_parent = allocateNode();
+    auto& parent = m_Nodes[new_parent];
+    parent.parent = old_parent;
+    merge(leaf_min, leaf_max, m_Nodes[sibling].min, m_Nodes[sibling].max,
+          parent.min, parent.max);
+    parent.height = m_Nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    m_Nodes[sibling].parent = new_parent;
+    m_Nodes[leaf].parent = new_parent;
+
+    if (old_parent != kNullNode) {
+        if (m_Nodes[old_parent].child1 == sibling) {
+            m_Nodes[old_parent].child1 = new_parent;
+        } else {
+            m_Nodes[old_parent].child2 = new_parent;
+        }
+    } else {
+        m_nRoot = new_parent;
+    }
+
+    refit(new_parent);
+}
+
+void AabbTree::removeLeaf(int32_t leaf) {
+    if (leaf == m_nRoot) {
+        m_nRoot = kNullNode;
+        return;
+    }
+
+    const int32_t parent = m_Nodes[leaf].parent;
+    const int32_t grand_parent = m_Nodes[parent].parent;
+    const int32_t sibling = (m_Nodes[parent].child1 == leaf)
+                                ? m_Nodes[parent].child2
+                                : m_Nodes[parent].child1;
+
+    // the sibling takes the place of the parent
+    if (grand_parent != kNullNode) {
+        if (m_Nodes[grand_parent].child1 == parent) {
+            m_Nodes[grand_parent].child1 = sibling;
+        } else {
+            m_Nodes[grand_parent].child2 = sibling;
+        }
+        m_Nodes[sibling].parent = grand_parent;
+        freeNode(parent);
+
+        refit(grand_parent);
+    } else {
+        m_nRoot = sibling;
+        m_Nodes[sibling].parent = kNullNode;
+        freeNode(parent);
+    }
+}
+
+void AabbTree::refit(int32_t node) {
+    int32_t index = node;
+    while (index != kNullNode) {
+        index = balance(index);
+
+        auto& n = m_Nodes[index];
+        const auto& child1 = m_Nodes[n.child1];
+        const auto& child2 = m_Nodes[n.child2];
+        n.height = 1 + std::max(child1.height, child2.height);
+        merge(child1.min, child1.max, child2.min, child2.max, n.min, n.max);
+
+        index = n.parent;
+    }
+}
+
+// Rotates the taller child of a up if the children heights differ by more
+// than one, returns the node now at the place of a.
+int32_t AabbTree::balance(int32_t a) {
+    Node& node_a = m_Nodes[a];
+    if (node_a.IsLeaf() || node_a.height < 2) return a;
+
+    const int32_t b = node_a.child1;
+    const int32_t c = node_a.child2;
+    const int32_t difference = m_Nodes[c].height - m_Nodes[b].height;
+
+    // promote the taller child, its taller child stays below it and its
+    // other child goes to a
+    auto rotate = [&](int32_t up, int32_t other) {
+        Node& node_up = m_Nodes[up];
+        const int32_t f = node_up.child1;
+        const int32_t g = node_up.child2;
+
+        node_up.child1 = a;
+        node_up.parent = node_a.parent;
+        node_a.parent = up;
+
+        if (node_up.parent != kNullNode) {
+            if (m_Nodes[node_up.parent].child1 == a) {
+                m_Nodes[node_up.parent].child1 = up;
+            } else {
+                m_Nodes[node_up.parent].child2 = up;
+            }
+        } else {
+            m_nRoot = up;
+        }
+
+        const bool f_taller = m_Nodes[f].height > m_Nodes[g].height;
+        const int32_t kept = f_taller ? f : g;
+        const int32_t given = f_taller ? g : f;
+
+        node_up.child2 = kept;
+        if (node_a.child1 == up) {
+            node_a.child1 = given;
+        } else {
+            node_a.child2 = given;
+        }
+        m_Nodes[given].parent = a;
+
+        merge(m_Nodes[other].min, m_Nodes[other].max, m_Nodes[given].min,
+              m_Nodes[given].max, node_a.min, node_a.max);
+        node_a.height =
+            1 + std::max(m_Nodes[other].height, m_Nodes[given].height);
+
+        merge(node_a.min, node_a.max, m_Nodes[kept].min, m_Nodes[kept].max,
+              node_up.min, node_up.max);
+        node_up.height = 1 + std::max(node_a.height, m_Nodes[kept].height);
+
+        return up;
+    };
+
+    if (difference > 1) return rotate(c, b);
+    if (difference < -1) return rotate(b, c);
+
+    return a;
+}
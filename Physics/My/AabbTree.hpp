@@ -0,0 +1,174 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "geommath.hpp"
+
+namespace My {
+// Dynamic bounding volume hierarchy of fattened boxes. Leaves are inserted
+// next to the sibling which grows the tree surface the least and the tree
+// is kept height balanced with rotations, so that it stays good while the
+// proxies move, without ever being rebuilt.
+class AabbTree {
+   public:
+    static constexpr int32_t kNullNode = -1;
+
+    AabbTree() = default;
+
+    // the bounds are enlarged by margin on each side
+    int32_t CreateProxy(const Vector3f& min, const Vector3f& max,
+                        uint32_t user_data, float margin);
+    void DestroyProxy(int32_t proxy);
+
+    // Returns false if the fat bounds of the proxy still contain the new
+    // bounds, nothing is done then. Otherwise the proxy is reinserted with
+    // bounds enlarged by margin, and a few times displacement in the
+    // direction the body goes, and the ancestors are refitted.
+    bool MoveProxy(int32_t proxy, const Vector3f& min, const Vector3f& max,
+                   const Vector3f& displacement, float margin);
+
+    // callback(int32_t proxy) is called for every proxy whose fat bounds
+    // overlap [min, max], the query stops if it returns false
+    template <class Callback>
+    void Query(const Vector3f& min, const Vector3f& max,
+               Callback&& callback) const;
+    // the same for the proxies whose fat bounds the segment from origin to
+    // origin + direction * max_distance crosses
+    template <class Callback>
+    void RayCast(const Vector3f& origin, const Vector3f& direction,
+                 float max_distance, Callback&& callback) const;
+
+    [[nodiscard]] const Vector3f& GetFatMin(int32_t proxy) const {
+        return m_Nodes[proxy].min;
+    }
+    [[nodiscard]] const Vector3f& GetFatMax(int32_t proxy) const {
+        return m_Nodes[proxy].max;
+    }
+    [[nodiscard]] uint32_t GetUserData(int32_t proxy) const {
+        return m_Nodes[proxy].userData;
+    }
+
+    [[nodiscard]] int32_t GetHeight() const {
+        return (m_nRoot == kNullNode) ? 0 : m_Nodes[m_nRoot].height;
+    }
+    [[nodiscard]] size_t GetProxyCount() const { return m_nProxyCount; }
+
+    void Clear();
+
+   private:
+    struct Node {
+        Vector3f min;
+        Vector3f max;
+        uint32_t userData;
+        // parent, or next free node when the node is not used
+        int32_t parent;
+        int32_t child1;
+        int32_t child2;
+        // 0 for leaves, -1 for free nodes
+        int32_t height;
+
+        [[nodiscard]] bool IsLeaf() const { return child1 == kNullNode; }
+    };
+
+    int32_t allocateNode();
+    void freeNode(int32_t node);
+
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    int32_t balance(int32_t node);
+    // recompute bounds and heights from node up to the root
+    void refit(int32_t node);
+
+   private:
+    std::vector<Node> m_Nodes;
+    int32_t m_nRoot = kNullNode;
+    int32_t m_nFreeList = kNullNode;
+    size_t m_nProxyCount = 0;
+};
+
+template <class Callback>
+void AabbTree::Query(const Vector3f& min, const Vector3f& max,
+                     Callback&& callback) const {
+    if (m_nRoot == kNullNode) return;
+
+    // the tree is balanced, its height stays far below the stack size
+    constexpr int32_t kStackSize = 256;
+    int32_t stack[kStackSize];
+    int32_t count = 0;
+    stack[count++] = m_nRoot;
+
+    while (count) {
+        const int32_t index = stack[--count];
+        const Node& node = m_Nodes[index];
+
+        if (node.max[0] < min[0] || max[0] < node.min[0] ||
+            node.max[1] < min[1] || max[1] < node.min[1] ||
+            node.max[2] < min[2] || max[2] < node.min[2]) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            if (!callback(index)) return;
+        } else {
+            assert(count + 2 <= kStackSize);
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+
+template <class Callback>
+void AabbTree::RayCast(const Vector3f& origin, const Vector3f& direction,
+                       float max_distance, Callback&& callback) const {
+    if (m_nRoot == kNullNode) return;
+
+    // slabs of the node bounds, the axes the ray runs along only need the
+    // origin between the planes
+    bool parallel[3];
+    Vector3f inverse;
+    for (int k = 0; k < 3; k++) {
+        parallel[k] = direction[k] > -1e-12f && direction[k] < 1e-12f;
+        inverse[k] = parallel[k] ? 0.0f : 1.0f / direction[k];
+    }
+    auto crosses = [&](const Node& node) {
+        float enter = 0.0f;
+        float exit = max_distance;
+        for (int k = 0; k < 3; k++) {
+            if (parallel[k]) {
+                if (origin[k] < node.min[k] || node.max[k] < origin[k]) {
+                    return false;
+                }
+                continue;
+            }
+            float t1 = (node.min[k] - origin[k]) * inverse[k];
+            float t2 = (node.max[k] - origin[k]) * inverse[k];
+            if (t1 > t2) std::swap(t1, t2);
+            enter = (t1 > enter) ? t1 : enter;
+            exit = (t2 < exit) ? t2 : exit;
+            if (enter > exit) return false;
+        }
+        return true;
+    };
+
+    constexpr int32_t kStackSize = 256;
+    int32_t stack[kStackSize];
+    int32_t count = 0;
+    stack[count++] = m_nRoot;
+
+    while (count) {
+        const int32_t index = stack[--count];
+        const Node& node = m_Nodes[index];
+        if (!crosses(node)) continue;
+
+        if (node.IsLeaf()) {
+            if (!callback(index)) return;
+        } else {
+            assert(count + 2 <= kStackSize);
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+}  // namespace My
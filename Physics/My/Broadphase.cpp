@@ -0,0 +1,600 @@
+#include "Broadphase.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace My;
+using namespace std;
+
+namespace {
+inline bool overlap(const Vector3f& min_a, const Vector3f& max_a,
+                    const Vector3f& min_b, const Vector3f& max_b) {
+    return !(max_a[0] < min_b[0] || max_b[0] < min_a[0] ||
+             max_a[1] < min_b[1] || max_b[1] < min_a[1] ||
+             max_a[2] < min_b[2] || max_b[2] < min_a[2]);
+}
+
+// slab test of the segment from origin to origin + direction * max_distance
+inline bool crosses(const Vector3f& origin, const Vector3f& direction,
+                    float max_distance, const Vector3f& min,
+                    const Vector3f& max) {
+    float enter = 0.0f;
+    float exit = max_distance;
+    for (int k = 0; k < 3; k++) {
+        if (fabs(direction[k]) < 1e-12f) {
+            if (origin[k] < min[k] || max[k] < origin[k]) return false;
+            continue;
+        }
+        const float inverse = 1.0f / direction[k];
+        float t1 = (min[k] - origin[k]) * inverse;
+        float t2 = (max[k] - origin[k]) * inverse;
+        if (t1 > t2) swap(t1, t2);
+        enter = std::max(enter, t1);
+        exit = std::min(exit, t2);
+        if (enter > exit) return false;
+    }
+    return true;
+}
+
+inline BodyPair make_pair_of(BodyId a, BodyId b) {
+    return (a < b) ? BodyPair(a, b) : BodyPair(b, a);
+}
+
+template <class T>
+inline void grow_to(vector<T>& array, BodyId id, const T& value) {
+    if (id >= array.size()) array.resize(id + 1, value);
+}
+}  // namespace
+
+/*
+ * BruteForceBroadphase
+ */
+void BruteForceBroadphase::Add(BodyId id, const Vector3f& min,
+                               const Vector3f& max, bool is_static) {
+    grow_to(m_Index, id, static_cast<uint32_t>(kInvalidBodyId));
+    m_Index[id] = static_cast<uint32_t>(m_Ids.size());
+    m_Ids.push_back(id);
+    m_Min.push_back(min);
+    m_Max.push_back(max);
+    m_Static.push_back(is_static);
+}
+
+void BruteForceBroadphase::Remove(BodyId id) {
+    const uint32_t index = m_Index[id];
+    assert(index < m_Ids.size());
+
+    m_Index[m_Ids.back()] = index;
+    m_Index[id] = kInvalidBodyId;
+
+    m_Ids[index] = m_Ids.back();
+    m_Min[index] = m_Min.back();
+    m_Max[index] = m_Max.back();
+    m_Static[index] = m_Static.back();
+    m_Ids.pop_back();
+    m_Min.pop_back();
+    m_Max.pop_back();
+    m_Static.pop_back();
+}
+
+void BruteForceBroadphase::Move(BodyId id, const Vector3f& min,
+                                const Vector3f& max, const Vector3f&) {
+    const uint32_t index = m_Index[id];
+    m_Min[index] = min;
+    m_Max[index] = max;
+}
+
+void BruteForceBroadphase::Clear() {
+    m_Ids.clear();
+    m_Min.clear();
+    m_Max.clear();
+    m_Static.clear();
+    m_Index.clear();
+}
+
+void BruteForceBroadphase::GetPairs(vector<BodyPair>& pairs) {
+    pairs.clear();
+
+    const size_t count = m_Ids.size();
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            if (m_Static[i] && m_Static[j]) continue;
+            if (!overlap(m_Min[i], m_Max[i], m_Min[j], m_Max[j])) continue;
+
+            pairs.push_back(make_pair_of(m_Ids[i], m_Ids[j]));
+        }
+    }
+}
+
+void BruteForceBroadphase::Query(const Vector3f& min, const Vector3f& max,
+                                 vector<BodyId>& ids) const {
+    for (size_t i = 0; i < m_Ids.size(); i++) {
+        if (overlap(min, max, m_Min[i], m_Max[i])) ids.push_back(m_Ids[i]);
+    }
+}
+
+void BruteForceBroadphase::RayQuery(const Vector3f& origin,
+                                    const Vector3f& direction,
+                                    float max_distance,
+                                    vector<BodyId>& ids) const {
+    for (size_t i = 0; i < m_Ids.size(); i++) {
+        if (crosses(origin, direction, max_distance, m_Min[i], m_Max[i])) {
+            ids.push_back(m_Ids[i]);
+        }
+    }
+}
+
+/*
+ * AabbTreeBroadphase
+ */
+void AabbTreeBroadphase::Add(BodyId id, const Vector3f& min,
+                             const Vector3f& max, bool is_static) {
+    grow_to(m_Proxies, id, AabbTree::kNullNode);
+    grow_to(m_Static, id, false);
+
+    assert(m_Proxies[id] == AabbTree::kNullNode);
+    m_Proxies[id] = m_Tree.CreateProxy(min, max, id, kMargin);
+    m_Static[id] = is_static;
+    m_Moved.push_back(id);
+}
+
+void AabbTreeBroadphase::Remove(BodyId id) {
+    assert(m_Proxies[id] != AabbTree::kNullNode);
+    m_Tree.DestroyProxy(m_Proxies[id]);
+    m_Proxies[id] = AabbTree::kNullNode;
+}
+
+void AabbTreeBroadphase::Move(BodyId id, const Vector3f& min,
+                              const Vector3f& max,
+                              const Vector3f& displacement) {
+    if (m_Tree.MoveProxy(m_Proxies[id], min, max, displacement, kMargin)) {
+        m_Moved.push_back(id);
+    }
+}
+
+void AabbTreeBroadphase::Clear() {
+    m_Tree.Clear();
+    m_Proxies.clear();
+    m_Static.clear();
+    m_Moved.clear();
+    m_Pairs.clear();
+    m_NewPairs.clear();
+}
+
+void AabbTreeBroadphase::GetPairs(vector<BodyPair>& pairs) {
+    // overlaps of the proxies which have been reinserted
+    m_NewPairs.clear();
+    for (const BodyId id : m_Moved) {
+        const int32_t proxy = m_Proxies[id];
+        if (proxy == AabbTree::kNullNode) continue;
+
+        const bool is_static = m_Static[id];
+        m_Tree.Query(m_Tree.GetFatMin(proxy), m_Tree.GetFatMax(proxy),
+                     [&](int32_t other) {
+                         const BodyId other_id = m_Tree.GetUserData(other);
+                         if (other_id != id &&
+                             !(is_static && m_Static[other_id])) {
+                             m_NewPairs.push_back(make_pair_of(id, other_id));
+                         }
+                         return true;
+                     });
+    }
+    m_Moved.clear();
+
+    sort(m_NewPairs.begin(), m_NewPairs.end());
+    m_NewPairs.erase(unique(m_NewPairs.begin(), m_NewPairs.end()),
+                     m_NewPairs.end());
+
+    // the other pairs can only have ended, the order is kept
+    m_Pairs.erase(
+        remove_if(m_Pairs.begin(), m_Pairs.end(),
+                  [this](const BodyPair& pair) {
+                      const int32_t a = (pair.first < m_Proxies.size())
+                                            ? m_Proxies[pair.first]
+                                            : AabbTree::kNullNode;
+                      const int32_t b = (pair.second < m_Proxies.size())
+                                            ? m_Proxies[pair.second]
+                                            : AabbTree::kNullNode;
+                      if (a == AabbTree::kNullNode ||
+                          b == AabbTree::kNullNode) {
+                          return true;
+                      }
+                      if (m_Static[pair.first] && m_Static[pair.second]) {
+                          return true;
+                      }
+                      return !overlap(m_Tree.GetFatMin(a), m_Tree.GetFatMax(a),
+                                      m_Tree.GetFatMin(b), m_Tree.GetFatMax(b));
+                  }),
+        m_Pairs.end());
+
+    pairs.clear();
+    set_union(m_Pairs.begin(), m_Pairs.end(), m_NewPairs.begin(),
+              m_NewPairs.end(), back_inserter(pairs));
+    m_Pairs = pairs;
+}
+
+void AabbTreeBroadphase::Query(const Vector3f& min, const Vector3f& max,
+                               vector<BodyId>& ids) const {
+    m_Tree.Query(min, max, [&](int32_t proxy) {
+        ids.push_back(m_Tree.GetUserData(proxy));
+        return true;
+    });
+}
+
+void AabbTreeBroadphase::RayQuery(const Vector3f& origin,
+                                  const Vector3f& direction,
+                                  float max_distance,
+                                  vector<BodyId>& ids) const {
+    m_Tree.RayCast(origin, direction, max_distance, [&](int32_t proxy) {
+        ids.push_back(m_Tree.GetUserData(proxy));
+        return true;
+    });
+}
+
+/*
+ * SweepAndPrune
+ */
+namespace {
+constexpr uint32_t kMaxFlag = 0x80000000;
+constexpr uint32_t kSentinel = 0;
+
+inline uint64_t handle_pair_key(uint32_t a, uint32_t b) {
+    return (a < b) ? (static_cast<uint64_t>(a) << 32) | b
+                   : (static_cast<uint64_t>(b) << 32) | a;
+}
+}  // namespace
+
+SweepAndPrune::SweepAndPrune() { Clear(); }
+
+void SweepAndPrune::Clear() {
+    m_Handles.clear();
+    m_FreeHandles.clear();
+    m_HandleOfBody.clear();
+    m_Added.clear();
+    m_AddedMin.clear();
+    m_AddedMax.clear();
+    m_Removed.clear();
+    m_PairSet.clear();
+
+    Handle sentinel{};
+    sentinel.id = kInvalidBodyId;
+    sentinel.isStatic = true;
+    for (int axis = 0; axis < 3; axis++) {
+        m_EndPoints[axis].clear();
+        m_EndPoints[axis].push_back(
+            {numeric_limits<float>::lowest(), kSentinel});
+        m_EndPoints[axis].push_back(
+            {numeric_limits<float>::max(), kSentinel | kMaxFlag});
+        sentinel.min[axis] = 0;
+        sentinel.max[axis] = 1;
+    }
+    m_Handles.push_back(sentinel);
+}
+
+void SweepAndPrune::Add(BodyId id, const Vector3f& min, const Vector3f& max,
+                        bool is_static) {
+    uint32_t handle;
+    if (!m_FreeHandles.empty()) {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    } else {
+        handle = static_cast<uint32_t>(m_Handles.size());
+        m_Handles.emplace_back();
+    }
+
+    grow_to(m_HandleOfBody, id, kSentinel);
+    assert(m_HandleOfBody[id] == kSentinel);
+    m_HandleOfBody[id] = handle;
+
+    // not in the lists yet, min[0] is the index in m_Added
+    auto& h = m_Handles[handle];
+    h.id = id;
+    h.isStatic = is_static;
+    h.min[0] = static_cast<uint32_t>(m_Added.size());
+    h.max[0] = kSentinel;
+
+    m_Added.push_back(handle);
+    m_AddedMin.push_back(min);
+    m_AddedMax.push_back(max);
+}
+
+void SweepAndPrune::Remove(BodyId id) {
+    const uint32_t handle = m_HandleOfBody[id];
+    assert(handle != kSentinel);
+    m_HandleOfBody[id] = kSentinel;
+
+    // the end points stay in the lists until the next rebuild, which also
+    // drops the pairs of the body
+    m_Handles[handle].id = kInvalidBodyId;
+    m_Removed.push_back(handle);
+}
+
+void SweepAndPrune::Move(BodyId id, const Vector3f& min, const Vector3f& max,
+                         const Vector3f&) {
+    const uint32_t handle = m_HandleOfBody[id];
+    auto& h = m_Handles[handle];
+
+    if (h.max[0] == kSentinel) {
+        // added since the last rebuild
+        m_AddedMin[h.min[0]] = min;
+        m_AddedMax[h.min[0]] = max;
+        return;
+    }
+
+    if (!m_Added.empty() || !m_Removed.empty()) {
+        // the lists are sorted again by the rebuild anyway
+        for (int axis = 0; axis < 3; axis++) {
+            m_EndPoints[axis][h.min[axis]].value = min[axis];
+            m_EndPoints[axis][h.max[axis]].value = max[axis];
+        }
+        return;
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        auto& end_points = m_EndPoints[axis];
+        const uint32_t min_index = h.min[axis];
+        const uint32_t max_index = h.max[axis];
+        const float delta_min = min[axis] - end_points[min_index].value;
+        const float delta_max = max[axis] - end_points[max_index].value;
+        end_points[min_index].value = min[axis];
+        end_points[max_index].value = max[axis];
+
+        // grow first, so that the min never passes the max
+        if (delta_min < 0.0f) sortMinDown(axis, min_index);
+        if (delta_max > 0.0f) sortMaxUp(axis, max_index);
+        if (delta_min > 0.0f) sortMinUp(axis, h.min[axis]);
+        if (delta_max < 0.0f) sortMaxDown(axis, h.max[axis]);
+    }
+}
+
+bool SweepAndPrune::overlaps(uint32_t a, uint32_t b, int axis1,
+                             int axis2) const {
+    const auto& ha = m_Handles[a];
+    const auto& hb = m_Handles[b];
+    return ha.min[axis1] < hb.max[axis1] && hb.min[axis1] < ha.max[axis1] &&
+           ha.min[axis2] < hb.max[axis2] && hb.min[axis2] < ha.max[axis2];
+}
+
+void SweepAndPrune::addPair(uint32_t a, uint32_t b) {
+    if (m_Handles[a].isStatic && m_Handles[b].isStatic) return;
+    m_PairSet.insert(handle_pair_key(a, b));
+}
+
+void SweepAndPrune::removePair(uint32_t a, uint32_t b) {
+    m_PairSet.erase(handle_pair_key(a, b));
+}
+
+// End points are ordered by value, and min before max for equal values so
+// that touching bounds overlap.
+
+void SweepAndPrune::sortMinDown(int axis, uint32_t index) {
+    auto& end_points = m_EndPoints[axis];
+    const uint32_t handle = end_points[index].Handle();
+    const int axis1 = (axis + 1) % 3;
+    const int axis2 = (axis + 2) % 3;
+
+    while (true) {
+        const EndPoint& previous = end_points[index - 1];
+        const EndPoint& current = end_points[index];
+        if (!(previous.value > current.value ||
+              (previous.value == current.value && previous.IsMax()))) {
+            break;
+        }
+
+        const uint32_t other = previous.Handle();
+        if (previous.IsMax()) {
+            // passed the max of the other body, overlapping on this axis
+            if (overlaps(handle, other, axis1, axis2)) addPair(handle, other);
+            m_Handles[other].max[axis]++;
+        } else {
+            m_Handles[other].min[axis]++;
+        }
+        m_Handles[handle].min[axis]--;
+
+        swap(end_points[index], end_points[index - 1]);
+        index--;
+    }
+}
+
+void SweepAndPrune::sortMinUp(int axis, uint32_t index) {
+    auto& end_points = m_EndPoints[axis];
+    const uint32_t handle = end_points[index].Handle();
+
+    while (true) {
+        const EndPoint& next = end_points[index + 1];
+        const EndPoint& current = end_points[index];
+        if (!(next.value < current.value)) break;
+
+        const uint32_t other = next.Handle();
+        if (next.IsMax()) {
+            // passed the max of the other body, separated on this axis
+            removePair(handle, other);
+            m_Handles[other].max[axis]--;
+        } else {
+            m_Handles[other].min[axis]--;
+        }
+        m_Handles[handle].min[axis]++;
+
+        swap(end_points[index], end_points[index + 1]);
+        index++;
+    }
+}
+
+void SweepAndPrune::sortMaxDown(int axis, uint32_t index) {
+    auto& end_points = m_EndPoints[axis];
+    const uint32_t handle = end_points[index].Handle();
+
+    while (true) {
+        const EndPoint& previous = end_points[index - 1];
+        const EndPoint& current = end_points[index];
+        if (!(previous.value > current.value)) break;
+
+        const uint32_t other = previous.Handle();
+        if (previous.IsMax()) {
+            m_Handles[other].max[axis]++;
+        } else {
+            // passed the min of the other body, separated on this axis
+            removePair(handle, other);
+            m_Handles[other].min[axis]++;
+        }
+        m_Handles[handle].max[axis]--;
+
+        swap(end_points[index], end_points[index - 1]);
+        index--;
+    }
+}
+
+void SweepAndPrune::sortMaxUp(int axis, uint32_t index) {
+    auto& end_points = m_EndPoints[axis];
+    const uint32_t handle = end_points[index].Handle();
+    const int axis1 = (axis + 1) % 3;
+    const int axis2 = (axis + 2) % 3;
+
+    while (true) {
+        const EndPoint& next = end_points[index + 1];
+        const EndPoint& current = end_points[index];
+        if (!(next.value < current.value ||
+              (next.value == current.value && !next.IsMax()))) {
+            break;
+        }
+
+        const uint32_t other = next.Handle();
+        if (next.IsMax()) {
+            m_Handles[other].max[axis]--;
+        } else {
+            // passed the min of the other body, overlapping on this axis
+            if (overlaps(handle, other, axis1, axis2)) addPair(handle, other);
+            m_Handles[other].min[axis]--;
+        }
+        m_Handles[handle].max[axis]++;
+
+        swap(end_points[index], end_points[index + 1]);
+        index++;
+    }
+}
+
+void SweepAndPrune::rebuild() {
+    for (int axis = 0; axis < 3; axis++) {
+        auto& end_points = m_EndPoints[axis];
+
+        // drop the removed bodies and the max sentinel
+        end_points.erase(
+            remove_if(end_points.begin(), end_points.end(),
+                      [this](const EndPoint& end_point) {
+                          const uint32_t handle = end_point.Handle();
+                          return handle == kSentinel ||
+                                 m_Handles[handle].id == kInvalidBodyId;
+                      }),
+            end_points.end());
+
+        for (size_t i = 0; i < m_Added.size(); i++) {
+            if (m_Handles[m_Added[i]].id == kInvalidBodyId) continue;
+            end_points.push_back({m_AddedMin[i][axis], m_Added[i]});
+            end_points.push_back({m_AddedMax[i][axis], m_Added[i] | kMaxFlag});
+        }
+
+        // mostly sorted already
+        sort(end_points.begin(), end_points.end(),
+             [](const EndPoint& a, const EndPoint& b) {
+                 if (a.value != b.value) return a.value < b.value;
+                 return !a.IsMax() && b.IsMax();
+             });
+
+        end_points.insert(end_points.begin(),
+                          {numeric_limits<float>::lowest(), kSentinel});
+        end_points.push_back(
+            {numeric_limits<float>::max(), kSentinel | kMaxFlag});
+
+        for (uint32_t i = 0; i < end_points.size(); i++) {
+            auto& h = m_Handles[end_points[i].Handle()];
+            if (end_points[i].IsMax()) {
+                h.max[axis] = i;
+            } else {
+                h.min[axis] = i;
+            }
+        }
+    }
+
+    m_FreeHandles.insert(m_FreeHandles.end(), m_Removed.begin(),
+                         m_Removed.end());
+    m_Removed.clear();
+    m_Added.clear();
+    m_AddedMin.clear();
+    m_AddedMax.clear();
+
+    // sweep along x, the bodies whose interval is open are tested on y and z
+    m_PairSet.clear();
+    vector<uint32_t> open;
+    vector<uint32_t> open_index(m_Handles.size());
+    const auto& end_points = m_EndPoints[0];
+    for (size_t i = 1; i + 1 < end_points.size(); i++) {
+        const uint32_t handle = end_points[i].Handle();
+        if (end_points[i].IsMax()) {
+            const uint32_t slot = open_index[handle];
+            open[slot] = open.back();
+            open_index[open[slot]] = slot;
+            open.pop_back();
+        } else {
+            for (const uint32_t other : open) {
+                if (overlaps(handle, other, 1, 2)) addPair(handle, other);
+            }
+            open_index[handle] = static_cast<uint32_t>(open.size());
+            open.push_back(handle);
+        }
+    }
+}
+
+void SweepAndPrune::GetPairs(vector<BodyPair>& pairs) {
+    if (!m_Added.empty() || !m_Removed.empty()) rebuild();
+
+    pairs.clear();
+    pairs.reserve(m_PairSet.size());
+    for (const uint64_t key : m_PairSet) {
+        const BodyId a = m_Handles[key >> 32].id;
+        const BodyId b = m_Handles[key & 0xFFFFFFFF].id;
+        pairs.push_back(make_pair_of(a, b));
+    }
+}
+
+void SweepAndPrune::getBounds(uint32_t handle, Vector3f& min,
+                              Vector3f& max) const {
+    const auto& h = m_Handles[handle];
+    if (h.max[0] == kSentinel) {
+        min = m_AddedMin[h.min[0]];
+        max = m_AddedMax[h.min[0]];
+        return;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        min[axis] = m_EndPoints[axis][h.min[axis]].value;
+        max[axis] = m_EndPoints[axis][h.max[axis]].value;
+    }
+}
+
+// The lists are only sorted between rebuilds and the sort order does not
+// help segments, the queries go through all the bodies.
+
+void SweepAndPrune::Query(const Vector3f& min, const Vector3f& max,
+                          vector<BodyId>& ids) const {
+    Vector3f handle_min, handle_max;
+    for (uint32_t handle = 1; handle < m_Handles.size(); handle++) {
+        const BodyId id = m_Handles[handle].id;
+        if (id == kInvalidBodyId) continue;
+        getBounds(handle, handle_min, handle_max);
+        if (overlap(min, max, handle_min, handle_max)) ids.push_back(id);
+    }
+}
+
+void SweepAndPrune::RayQuery(const Vector3f& origin,
+                             const Vector3f& direction, float max_distance,
+                             vector<BodyId>& ids) const {
+    Vector3f handle_min, handle_max;
+    for (uint32_t handle = 1; handle < m_Handles.size(); handle++) {
+        const BodyId id = m_Handles[handle].id;
+        if (id == kInvalidBodyId) continue;
+        getBounds(handle, handle_min, handle_max);
+        if (crosses(origin, direction, max_distance, handle_min,
+                    handle_max)) {
+            ids.push_back(id);
+        }
+    }
+}
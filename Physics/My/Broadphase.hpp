@@ -0,0 +1,183 @@
+#pragma once
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "AabbTree.hpp"
+#include "geommath.hpp"
+#include "portable.hpp"
+
+namespace My {
+using BodyId = uint32_t;
+constexpr BodyId kInvalidBodyId = 0xFFFFFFFF;
+
+// (a, b) with a < b
+using BodyPair = std::pair<BodyId, BodyId>;
+
+ENUM(BroadphaseType){kBruteForce, kAabbTree, kSweepAndPrune};
+
+// Finds the pairs of bodies whose bounds overlap. Bodies are added with
+// their world space bounds and moved every step, pairs of two static bodies
+// are never reported.
+class Broadphase {
+   public:
+    virtual ~Broadphase() = default;
+
+    virtual void Add(BodyId id, const Vector3f& min, const Vector3f& max,
+                     bool is_static) = 0;
+    virtual void Remove(BodyId id) = 0;
+    // displacement is how far the body is expected to move by the next step
+    virtual void Move(BodyId id, const Vector3f& min, const Vector3f& max,
+                      const Vector3f& displacement) = 0;
+    virtual void Clear() = 0;
+
+    // Overlapping pairs after the moves so far, each pair once and in no
+    // particular order. Implementations may report pairs whose bounds are
+    // only close to overlapping.
+    virtual void GetPairs(std::vector<BodyPair>& pairs) = 0;
+
+    // The bodies whose bounds overlap [min, max], or that the segment from
+    // origin to origin + direction * max_distance crosses, are appended to
+    // ids, static ones included, maybe with some that are only close. Only
+    // read the broadphase, several threads may query at once.
+    virtual void Query(const Vector3f& min, const Vector3f& max,
+                       std::vector<BodyId>& ids) const = 0;
+    virtual void RayQuery(const Vector3f& origin, const Vector3f& direction,
+                          float max_distance,
+                          std::vector<BodyId>& ids) const = 0;
+};
+
+// Tests all the pairs, as reference.
+class BruteForceBroadphase : public Broadphase {
+   public:
+    void Add(BodyId id, const Vector3f& min, const Vector3f& max,
+             bool is_static) final;
+    void Remove(BodyId id) final;
+    void Move(BodyId id, const Vector3f& min, const Vector3f& max,
+              const Vector3f& displacement) final;
+    void Clear() final;
+    void GetPairs(std::vector<BodyPair>& pairs) final;
+    void Query(const Vector3f& min, const Vector3f& max,
+               std::vector<BodyId>& ids) const final;
+    void RayQuery(const Vector3f& origin, const Vector3f& direction,
+                  float max_distance, std::vector<BodyId>& ids) const final;
+
+   private:
+    std::vector<BodyId> m_Ids;
+    std::vector<Vector3f> m_Min;
+    std::vector<Vector3f> m_Max;
+    std::vector<bool> m_Static;
+    // body id -> index in the arrays above
+    std::vector<uint32_t> m_Index;
+};
+
+// Keeps the fattened bounds in an AabbTree. Only the bodies which left their
+// fat bounds are looked up in the tree, the pairs found before are kept as
+// long as their fat bounds overlap.
+class AabbTreeBroadphase : public Broadphase {
+   public:
+    // the fat bounds are this much larger than the body on each side
+    static constexpr float kMargin = 0.1f;
+
+    void Add(BodyId id, const Vector3f& min, const Vector3f& max,
+             bool is_static) final;
+    void Remove(BodyId id) final;
+    void Move(BodyId id, const Vector3f& min, const Vector3f& max,
+              const Vector3f& displacement) final;
+    void Clear() final;
+    void GetPairs(std::vector<BodyPair>& pairs) final;
+    void Query(const Vector3f& min, const Vector3f& max,
+               std::vector<BodyId>& ids) const final;
+    void RayQuery(const Vector3f& origin, const Vector3f& direction,
+                  float max_distance, std::vector<BodyId>& ids) const final;
+
+    [[nodiscard]] const AabbTree& GetTree() const { return m_Tree; }
+
+   private:
+    AabbTree m_Tree;
+
+    // body id -> proxy, AabbTree::kNullNode for unused ids
+    std::vector<int32_t> m_Proxies;
+    std::vector<bool> m_Static;
+    // bodies added or reinserted since the last GetPairs()
+    std::vector<BodyId> m_Moved;
+
+    // sorted, from the last GetPairs()
+    std::vector<BodyPair> m_Pairs;
+    std::vector<BodyPair> m_NewPairs;
+};
+
+// Incremental sweep and prune: the bounds are kept as sorted lists of
+// end points on all three axes. Moving a body swaps its end points with
+// their neighbors, which is cheap when bodies move little from one step to
+// the next, and each swap of a min with a max end point starts or ends an
+// overlap. Bodies added or removed are handled in a batch by the next
+// GetPairs(), which sorts the lists again and sweeps them. Queries go
+// through all the bodies.
+class SweepAndPrune : public Broadphase {
+   public:
+    SweepAndPrune();
+
+    void Add(BodyId id, const Vector3f& min, const Vector3f& max,
+             bool is_static) final;
+    void Remove(BodyId id) final;
+    void Move(BodyId id, const Vector3f& min, const Vector3f& max,
+              const Vector3f& displacement) final;
+    void Clear() final;
+    void GetPairs(std::vector<BodyPair>& pairs) final;
+    void Query(const Vector3f& min, const Vector3f& max,
+               std::vector<BodyId>& ids) const final;
+    void RayQuery(const Vector3f& origin, const Vector3f& direction,
+                  float max_distance, std::vector<BodyId>& ids) const final;
+
+   private:
+    struct EndPoint {
+        float value;
+        // handle index, with the top bit set for max end points
+        uint32_t data;
+
+        [[nodiscard]] uint32_t Handle() const { return data & 0x7FFFFFFF; }
+        [[nodiscard]] bool IsMax() const { return data & 0x80000000; }
+    };
+
+    struct Handle {
+        BodyId id;
+        bool isStatic;
+        // indices of the end points in each axis list
+        uint32_t min[3];
+        uint32_t max[3];
+    };
+
+    void rebuild();
+    // current bounds of a handle, in the lists or waiting to be added
+    void getBounds(uint32_t handle, Vector3f& min, Vector3f& max) const;
+    void addPair(uint32_t a, uint32_t b);
+    void removePair(uint32_t a, uint32_t b);
+    [[nodiscard]] bool overlaps(uint32_t a, uint32_t b, int axis1,
+                                int axis2) const;
+
+    void sortMinDown(int axis, uint32_t index);
+    void sortMinUp(int axis, uint32_t index);
+    void sortMaxDown(int axis, uint32_t index);
+    void sortMaxUp(int axis, uint32_t index);
+
+   private:
+    // handle 0 is the sentinel, whose end points bound the lists
+    std::vector<Handle> m_Handles;
+    std::vector<uint32_t> m_FreeHandles;
+    // body id -> handle, 0 for unused ids
+    std::vector<uint32_t> m_HandleOfBody;
+    std::vector<EndPoint> m_EndPoints[3];
+
+    // handles waiting for the next rebuild, with their bounds
+    std::vector<uint32_t> m_Added;
+    std::vector<Vector3f> m_AddedMin;
+    std::vector<Vector3f> m_AddedMax;
+    // handles freed by the next rebuild
+    std::vector<uint32_t> m_Removed;
+
+    // keys of the handle pairs
+    std::unordered_set<uint64_t> m_PairSet;
+};
+}  // namespace My
@@ -0,0 +1,1074 @@
+#include "Collision.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+using namespace My;
+using namespace std;
+
+namespace {
+inline Vector3f local_to_world(const ShapePose& pose, const Vector3f& v) {
+    return pose.position + pose.axis[0] * v[0] + pose.axis[1] * v[1] +
+           pose.axis[2] * v[2];
+}
+
+inline Vector3f world_to_local(const ShapePose& pose, const Vector3f& v) {
+    const Vector3f d = v - pose.position;
+    return {DotProduct(d, pose.axis[0]), DotProduct(d, pose.axis[1]),
+            DotProduct(d, pose.axis[2])};
+}
+
+// world space normal and intercept of a plane shape
+inline void world_plane(const CollisionShape& plane, const ShapePose& pose,
+                        Vector3f& normal, float& intercept) {
+    normal = pose.axis[0] * plane.normal[0] + pose.axis[1] * plane.normal[1] +
+             pose.axis[2] * plane.normal[2];
+    intercept = DotProduct(normal, pose.position) + plane.intercept;
+}
+
+inline void add_point(CollisionResult& result, const Vector3f& point,
+                      float depth) {
+    assert(result.pointCount < kMaxContactPoints);
+    result.points[result.pointCount] = point;
+    result.depths[result.pointCount] = depth;
+    result.pointCount++;
+}
+
+// keep the 4 points spanning the largest area, starting from the deepest
+void reduce_points(CollisionResult& result, const Vector3f* points,
+                   const float* depths, uint32_t count) {
+    result.pointCount = 0;
+    if (count <= kMaxContactPoints) {
+        for (uint32_t i = 0; i < count; i++) {
+            add_point(result, points[i], depths[i]);
+        }
+        return;
+    }
+
+    uint32_t chosen[kMaxContactPoints];
+
+    chosen[0] = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        if (depths[i] > depths[chosen[0]]) chosen[0] = i;
+    }
+
+    float best = -1.0f;
+    chosen[1] = chosen[0];
+    for (uint32_t i = 0; i < count; i++) {
+        const float d = LengthSquared(points[i] - points[chosen[0]]);
+        if (d > best) {
+            best = d;
+            chosen[1] = i;
+        }
+    }
+
+    const Vector3f edge = points[chosen[1]] - points[chosen[0]];
+    float most_positive = 0.0f, most_negative = 0.0f;
+    chosen[2] = chosen[0];
+    chosen[3] = chosen[1];
+    for (uint32_t i = 0; i < count; i++) {
+        const float area = DotProduct(
+            CrossProduct(edge, points[i] - points[chosen[0]]), result.normal);
+        if (area > most_positive) {
+            most_positive = area;
+            chosen[2] = i;
+        } else if (area < most_negative) {
+            most_negative = area;
+            chosen[3] = i;
+        }
+    }
+
+    for (uint32_t i = 0; i < kMaxContactPoints; i++) {
+        bool duplicated = false;
+        for (uint32_t j = 0; j < i; j++) {
+            duplicated |= (chosen[j] == chosen[i]);
+        }
+        if (!duplicated) {
+            add_point(result, points[chosen[i]], depths[chosen[i]]);
+        }
+    }
+}
+
+constexpr uint32_t kMaxClipVertices = 8;
+
+// Sutherland-Hodgman against DotProduct(normal, x) <= offset, out has room for
+// capacity vertices
+uint32_t clip_polygon(Vector3f* out, const Vector3f* in, uint32_t count,
+                      const Vector3f& normal, float offset,
+                      uint32_t capacity = kMaxClipVertices) {
+    uint32_t out_count = 0;
+    if (count == 0) return 0;
+
+    Vector3f previous = in[count - 1];
+    float previous_distance = DotProduct(normal, previous) - offset;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const Vector3f& current = in[i];
+        const float distance = DotProduct(normal, current) - offset;
+
+        if ((previous_distance <= 0.0f) != (distance <= 0.0f)) {
+            const float t = previous_distance / (previous_distance - distance);
+            if (out_count < capacity) {
+                out[out_count++] = previous + (current - previous) * t;
+            }
+        }
+
+        if (distance <= 0.0f && out_count < capacity) {
+            out[out_count++] = current;
+        }
+
+        previous = current;
+        previous_distance = distance;
+    }
+
+    return out_count;
+}
+
+// reference is the box owning the separating face axis, with the face
+// normal (pointing to the incident box) along its axis ref_axis
+void clip_box_faces(const ShapePose& ref, const Vector3f& ref_half,
+                    uint32_t ref_axis, const Vector3f& ref_normal,
+                    const ShapePose& inc, const Vector3f& inc_half,
+                    CollisionResult& result) {
+    // incident face: the one most anti-parallel to the reference normal
+    uint32_t inc_axis = 0;
+    float best = -1.0f;
+    for (uint32_t k = 0; k < 3; k++) {
+        const float d = fabs(DotProduct(inc.axis[k], ref_normal));
+        if (d > best) {
+            best = d;
+            inc_axis = k;
+        }
+    }
+
+    const float sign =
+        (DotProduct(inc.axis[inc_axis], ref_normal) > 0.0f) ? -1.0f : 1.0f;
+    const Vector3f inc_center =
+        inc.position + inc.axis[inc_axis] * (sign * inc_half[inc_axis]);
+    const uint32_t u = (inc_axis + 1) % 3;
+    const uint32_t v = (inc_axis + 2) % 3;
+    const Vector3f du = inc.axis[u] * inc_half[u];
+    const Vector3f dv = inc.axis[v] * inc_half[v];
+
+    Vector3f polygon[2][kMaxClipVertices];
+    polygon[0][0] = inc_center + du + dv;
+    polygon[0][1] = inc_center - du + dv;
+    polygon[0][2] = inc_center - du - dv;
+    polygon[0][3] = inc_center + du - dv;
+    uint32_t count = 4;
+    uint32_t current = 0;
+
+    // side planes of the reference face
+    for (uint32_t k = 0; k < 3 && count; k++) {
+        if (k == ref_axis) continue;
+        const float center = DotProduct(ref.axis[k], ref.position);
+        count = clip_polygon(polygon[current ^ 1], polygon[current], count,
+                             ref.axis[k], center + ref_half[k]);
+        current ^= 1;
+        count = clip_polygon(polygon[current ^ 1], polygon[current], count,
+                             -ref.axis[k], -center + ref_half[k]);
+        current ^= 1;
+    }
+
+    const float face_offset =
+        DotProduct(ref_normal, ref.position) + ref_half[ref_axis];
+
+    Vector3f points[kMaxClipVertices];
+    float depths[kMaxClipVertices];
+    uint32_t point_count = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const float separation = DotProduct(ref_normal, polygon[current][i]) -
+                                 face_offset;
+        if (separation <= 0.0f) {
+            points[point_count] =
+                polygon[current][i] - ref_normal * (separation * 0.5f);
+            depths[point_count] = -separation;
+            point_count++;
+        }
+    }
+
+    reduce_points(result, points, depths, point_count);
+}
+}  // namespace
+
+bool My::CollideSphereSphere(const CollisionShape& a, const ShapePose& pa,
+                             const CollisionShape& b, const ShapePose& pb,
+                             CollisionResult& result) {
+    const Vector3f d = pb.position - pa.position;
+    const float radius = a.radius + b.radius;
+    const float distance_squared = LengthSquared(d);
+    if (distance_squared > radius * radius) return false;
+
+    const float distance = sqrt(distance_squared);
+    result.normal = (distance > 1e-6f) ? d * (1.0f / distance)
+                                       : Vector3f({0.0f, 0.0f, 1.0f});
+    result.pointCount = 0;
+    const float depth = radius - distance;
+    add_point(result, pa.position + result.normal * (a.radius - depth * 0.5f),
+              depth);
+
+    return true;
+}
+
+bool My::CollideSphereBox(const CollisionShape& a, const ShapePose& pa,
+                          const CollisionShape& b, const ShapePose& pb,
+                          CollisionResult& result) {
+    const Vector3f center = world_to_local(pb, pa.position);
+    const Vector3f& h = b.halfExtents;
+
+    Vector3f closest;
+    bool inside = true;
+    for (int k = 0; k < 3; k++) {
+        closest[k] = std::clamp(center[k], -h[k], h[k]);
+        inside &= (closest[k] == center[k]);
+    }
+
+    result.pointCount = 0;
+
+    if (!inside) {
+        const Vector3f d = local_to_world(pb, closest) - pa.position;
+        const float distance_squared = LengthSquared(d);
+        if (distance_squared > a.radius * a.radius) return false;
+
+        const float distance = sqrt(distance_squared);
+        result.normal = d * (1.0f / distance);
+        add_point(result,
+                  pa.position + result.normal * ((a.radius + distance) * 0.5f),
+                  a.radius - distance);
+        return true;
+    }
+
+    // the center is inside the box, push it out through the closest face
+    int axis = 0;
+    float min_distance = h[0] - fabs(center[0]);
+    for (int k = 1; k < 3; k++) {
+        const float distance = h[k] - fabs(center[k]);
+        if (distance < min_distance) {
+            min_distance = distance;
+            axis = k;
+        }
+    }
+
+    const float sign = (center[axis] < 0.0f) ? 1.0f : -1.0f;
+    result.normal = pb.axis[axis] * sign;
+    add_point(result, pa.position, a.radius + min_distance);
+
+    return true;
+}
+
+bool My::CollideSpherePlane(const CollisionShape& a, const ShapePose& pa,
+                            const CollisionShape& b, const ShapePose& pb,
+                            CollisionResult& result) {
+    Vector3f normal;
+    float intercept;
+    world_plane(b, pb, normal, intercept);
+
+    const float distance = DotProduct(normal, pa.position) - intercept;
+    if (distance > a.radius) return false;
+
+    result.normal = -normal;
+    result.pointCount = 0;
+    add_point(result, pa.position - normal * ((a.radius + distance) * 0.5f),
+              a.radius - distance);
+
+    return true;
+}
+
+bool My::CollideBoxPlane(const CollisionShape& a, const ShapePose& pa,
+                         const CollisionShape& b, const ShapePose& pb,
+                         CollisionResult& result) {
+    Vector3f normal;
+    float intercept;
+    world_plane(b, pb, normal, intercept);
+
+    const Vector3f& h = a.halfExtents;
+    Vector3f points[8];
+    float depths[8];
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < 8; i++) {
+        const Vector3f corner = local_to_world(
+            pa, {(i & 1) ? h[0] : -h[0], (i & 2) ? h[1] : -h[1],
+                 (i & 4) ? h[2] : -h[2]});
+        const float distance = DotProduct(normal, corner) - intercept;
+        if (distance <= 0.0f) {
+            points[count] = corner - normal * (distance * 0.5f);
+            depths[count] = -distance;
+            count++;
+        }
+    }
+
+    if (count == 0) return false;
+
+    result.normal = -normal;
+    reduce_points(result, points, depths, count);
+
+    return true;
+}
+
+bool My::CollideBoxBox(const CollisionShape& a, const ShapePose& pa,
+                       const CollisionShape& b, const ShapePose& pb,
+                       CollisionResult& result) {
+    const Vector3f& ha = a.halfExtents;
+    const Vector3f& hb = b.halfExtents;
+    const Vector3f t = pb.position - pa.position;
+
+    float c[3][3], abs_c[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            c[i][j] = DotProduct(pa.axis[i], pb.axis[j]);
+            abs_c[i][j] = fabs(c[i][j]) + 1e-6f;
+        }
+    }
+
+    // separation along the face axes of A, then of B
+    float separation_a = -numeric_limits<float>::max();
+    uint32_t axis_a = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        const float s = fabs(DotProduct(t, pa.axis[i])) -
+                        (ha[i] + hb[0] * abs_c[i][0] + hb[1] * abs_c[i][1] +
+                         hb[2] * abs_c[i][2]);
+        if (s > 0.0f) return false;
+        if (s > separation_a) {
+            separation_a = s;
+            axis_a = i;
+        }
+    }
+
+    float separation_b = -numeric_limits<float>::max();
+    uint32_t axis_b = 0;
+    for (uint32_t j = 0; j < 3; j++) {
+        const float s = fabs(DotProduct(t, pb.axis[j])) -
+                        (hb[j] + ha[0] * abs_c[0][j] + ha[1] * abs_c[1][j] +
+                         ha[2] * abs_c[2][j]);
+        if (s > 0.0f) return false;
+        if (s > separation_b) {
+            separation_b = s;
+            axis_b = j;
+        }
+    }
+
+    // edge axes
+    float separation_edge = -numeric_limits<float>::max();
+    uint32_t edge_a = 0, edge_b = 0;
+    Vector3f edge_axis;
+    for (uint32_t i = 0; i < 3; i++) {
+        for (uint32_t j = 0; j < 3; j++) {
+            Vector3f axis = CrossProduct(pa.axis[i], pb.axis[j]);
+            const float length = Length(axis);
+            // parallel edges, already covered by the face axes
+            if (length < 1e-4f) continue;
+            axis = axis * (1.0f / length);
+
+            const float ra = ha[0] * fabs(DotProduct(pa.axis[0], axis)) +
+                             ha[1] * fabs(DotProduct(pa.axis[1], axis)) +
+                             ha[2] * fabs(DotProduct(pa.axis[2], axis));
+            const float rb = hb[0] * fabs(DotProduct(pb.axis[0], axis)) +
+                             hb[1] * fabs(DotProduct(pb.axis[1], axis)) +
+                             hb[2] * fabs(DotProduct(pb.axis[2], axis));
+            const float s = fabs(DotProduct(t, axis)) - (ra + rb);
+            if (s > 0.0f) return false;
+            if (s > separation_edge) {
+                separation_edge = s;
+                edge_a = i;
+                edge_b = j;
+                edge_axis = axis;
+            }
+        }
+    }
+
+    // prefer face contacts, they are more stable, unless an other axis is
+    // clearly better
+    const float kRelativeTolerance = 0.95f;
+    const float kAbsoluteTolerance = 0.01f;
+
+    result.pointCount = 0;
+
+    if (separation_edge >
+        kRelativeTolerance * max(separation_a, separation_b) +
+            kAbsoluteTolerance) {
+        Vector3f normal = edge_axis;
+        if (DotProduct(normal, t) < 0.0f) normal = -normal;
+
+        // the edges of A and B closest to each other along the normal
+        Vector3f center_a = pa.position;
+        Vector3f center_b = pb.position;
+        for (uint32_t k = 0; k < 3; k++) {
+            if (k != edge_a) {
+                const float s =
+                    (DotProduct(pa.axis[k], normal) > 0.0f) ? 1.0f : -1.0f;
+                center_a = center_a + pa.axis[k] * (s * ha[k]);
+            }
+            if (k != edge_b) {
+                const float s =
+                    (DotProduct(pb.axis[k], normal) > 0.0f) ? -1.0f : 1.0f;
+                center_b = center_b + pb.axis[k] * (s * hb[k]);
+            }
+        }
+
+        const Vector3f& d1 = pa.axis[edge_a];
+        const Vector3f& d2 = pb.axis[edge_b];
+        const Vector3f r = center_a - center_b;
+        const float k = DotProduct(d1, d2);
+        const float e = DotProduct(d1, r);
+        const float f = DotProduct(d2, r);
+        const float denominator = 1.0f - k * k;
+        float s = (denominator > 1e-6f) ? (k * f - e) / denominator : 0.0f;
+        s = std::clamp(s, -ha[edge_a], ha[edge_a]);
+        float u = f + k * s;
+        u = std::clamp(u, -hb[edge_b], hb[edge_b]);
+
+        const Vector3f point_a = center_a + d1 * s;
+        const Vector3f point_b = center_b + d2 * u;
+
+        result.normal = normal;
+        add_point(result, (point_a + point_b) * 0.5f, -separation_edge);
+        return true;
+    }
+
+    if (separation_b > kRelativeTolerance * separation_a + kAbsoluteTolerance) {
+        // reference face on B, its normal points to A
+        Vector3f normal = pb.axis[axis_b];
+        if (DotProduct(normal, t) > 0.0f) normal = -normal;
+        result.normal = -normal;
+        clip_box_faces(pb, hb, axis_b, normal, pa, ha, result);
+    } else {
+        Vector3f normal = pa.axis[axis_a];
+        if (DotProduct(normal, t) < 0.0f) normal = -normal;
+        result.normal = normal;
+        clip_box_faces(pa, ha, axis_a, normal, pb, hb, result);
+    }
+
+    return result.pointCount > 0;
+}
+
+namespace {
+// calls function with the shape as a support mapping placed in the world
+template <class Function>
+bool with_convex_instance(const CollisionShape& shape, const ShapePose& pose,
+                          Function&& function) {
+    switch (shape.type) {
+        case GeometryType::kSphere: {
+            const SphereSupport<float> sphere{shape.radius};
+            return function(ConvexInstance(sphere, pose.position, pose.axis));
+        }
+        case GeometryType::kBox: {
+            const BoxSupport<float> box{shape.halfExtents};
+            return function(ConvexInstance(box, pose.position, pose.axis));
+        }
+        case GeometryType::kPlane: {
+            const HalfSpace<float> plane{shape.normal, shape.intercept};
+            return function(ConvexInstance(plane, pose.position, pose.axis));
+        }
+        case GeometryType::kPolyhydron:
+            if (!shape.hull) return false;
+            return function(
+                ConvexInstance(*shape.hull, pose.position, pose.axis));
+        default:
+            return false;
+    }
+}
+}  // namespace
+
+bool My::CollideConvexShapes(const CollisionShape& a, const ShapePose& pa,
+                             const CollisionShape& b, const ShapePose& pb,
+                             CollisionResult& result) {
+    return with_convex_instance(a, pa, [&](const auto& instance_a) {
+        return with_convex_instance(b, pb, [&](const auto& instance_b) {
+            using PlaneInstance = ConvexInstance<HalfSpace<float>>;
+            if constexpr (is_same_v<decay_t<decltype(instance_a)>,
+                                    PlaneInstance> &&
+                          is_same_v<decay_t<decltype(instance_b)>,
+                                    PlaneInstance>) {
+                return false;
+            } else {
+                ConvexContact<float> contact;
+                if (!CollideConvex(instance_a, instance_b, contact)) {
+                    return false;
+                }
+
+                result.normal = contact.normal;
+                result.pointCount = 0;
+                for (uint32_t i = 0; i < contact.pointCount; i++) {
+                    add_point(result, contact.points[i], contact.depths[i]);
+                }
+                return true;
+            }
+        });
+    });
+}
+
+namespace {
+// a triangle of a heightfield as a support mapping
+struct TriangleSupport {
+    using value_type = float;
+    Vector3f vertices[3];
+
+    [[nodiscard]] Vector3f Support(const Vector3f& direction) const {
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < 3; i++) {
+            if (DotProduct(vertices[i], direction) >
+                DotProduct(vertices[best], direction)) {
+                best = i;
+            }
+        }
+        return vertices[best];
+    }
+};
+
+// contacts against the triangles of a heightfield, in its body space
+struct TerrainContacts {
+    std::vector<Vector3f> points;  // half way between the surfaces
+    std::vector<Vector3f> normals;  // out of the terrain
+    std::vector<float> depths;
+
+    void Clear() {
+        points.clear();
+        normals.clear();
+        depths.clear();
+    }
+
+    void Add(const Vector3f& point, const Vector3f& normal, float depth) {
+        points.push_back(point);
+        normals.push_back(normal);
+        depths.push_back(depth);
+    }
+};
+
+// one list per thread, the pairs are collided on the jobs
+TerrainContacts& terrain_contacts() {
+    thread_local TerrainContacts contacts;
+    return contacts;
+}
+
+inline Vector3f to_local_direction(const ShapePose& pose, const Vector3f& v) {
+    return {DotProduct(v, pose.axis[0]), DotProduct(v, pose.axis[1]),
+            DotProduct(v, pose.axis[2])};
+}
+
+inline Vector3f to_world_direction(const ShapePose& pose, const Vector3f& v) {
+    return pose.axis[0] * v[0] + pose.axis[1] * v[1] + pose.axis[2] * v[2];
+}
+
+// pose of a in the body space of b
+ShapePose relative_pose(const ShapePose& a, const ShapePose& b) {
+    ShapePose result;
+    result.position = world_to_local(b, a.position);
+    for (int k = 0; k < 3; k++) {
+        result.axis[k] = to_local_direction(b, a.axis[k]);
+    }
+    return result;
+}
+
+template <class Instance>
+void support_bounds(const Instance& shape, Vector3f& min, Vector3f& max) {
+    for (int k = 0; k < 3; k++) {
+        Vector3f direction(0.0f);
+        direction[k] = 1.0f;
+        max[k] = shape.Support(direction)[k];
+        direction[k] = -1.0f;
+        min[k] = shape.Support(direction)[k];
+    }
+}
+
+inline Vector3f triangle_normal(const Vector3f* t) {
+    const Vector3f n = CrossProduct(t[1] - t[0], t[2] - t[0]);
+    return n * (1.0f / Length(n));
+}
+
+// Real-Time Collision Detection, 5.1.5
+Vector3f closest_on_triangle(const Vector3f& p, const Vector3f* t) {
+    const Vector3f& a = t[0];
+    const Vector3f& b = t[1];
+    const Vector3f& c = t[2];
+    const Vector3f ab = b - a;
+    const Vector3f ac = c - a;
+
+    const float d1 = DotProduct(ab, p - a);
+    const float d2 = DotProduct(ac, p - a);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    const float d3 = DotProduct(ab, p - b);
+    const float d4 = DotProduct(ac, p - b);
+    if (d3 >= 0.0f && d4 <= d3) return b;
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    const float d5 = DotProduct(ab, p - c);
+    const float d6 = DotProduct(ac, p - c);
+    if (d6 >= 0.0f && d5 <= d6) return c;
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    const float denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// the sphere touches the triangle, or its center is below it
+void sphere_triangle(const Vector3f& center, float radius,
+                     const Vector3f* triangle, TerrainContacts& contacts) {
+    const Vector3f n = triangle_normal(triangle);
+    const float height = DotProduct(n, center - triangle[0]);
+    const Vector3f closest = closest_on_triangle(center, triangle);
+    const Vector3f offset = center - closest;
+    const float distance_squared = DotProduct(offset, offset);
+
+    Vector3f normal;
+    float depth;
+    if (height <= 0.0f) {
+        // straight below the triangle only, the closest point is then the
+        // projection of the center
+        if (distance_squared > height * height + 1e-6f * radius * radius) {
+            return;
+        }
+        normal = n;
+        depth = radius - height;
+    } else {
+        if (distance_squared >= radius * radius) return;
+        const float distance = sqrt(distance_squared);
+        normal = (distance > 1e-6f) ? offset * (1.0f / distance) : n;
+        depth = radius - distance;
+    }
+    contacts.Add(closest - normal * (0.5f * depth), normal, depth);
+}
+
+// the face of the shape towards the triangle, clipped to the prism swept
+// by the triangle along its normal, where it is below the triangle
+template <class Instance>
+void face_triangle(const Instance& shape, const Vector3f* triangle,
+                   TerrainContacts& contacts) {
+    const Vector3f n = triangle_normal(triangle);
+    const float offset = DotProduct(n, triangle[0]);
+    if (DotProduct(n, shape.Support(-n)) >= offset) return;
+
+    constexpr uint32_t kCapacity = kMaxSupportFacePoints + 3;
+    Vector3f polygon[2][kCapacity];
+    Vector3f face_normal;
+    uint32_t count = shape.SupportFace(-n, polygon[0], face_normal);
+    uint32_t current = 0;
+    for (uint32_t e = 0; e < 3 && count > 0; e++) {
+        const Vector3f& p = triangle[e];
+        const Vector3f outward = CrossProduct(triangle[(e + 1) % 3] - p, n);
+        count = clip_polygon(polygon[current ^ 1], polygon[current], count,
+                             outward, DotProduct(outward, p), kCapacity);
+        current ^= 1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const Vector3f& p = polygon[current][i];
+        const float depth = offset - DotProduct(n, p);
+        if (depth > 0.0f) contacts.Add(p + n * (0.5f * depth), n, depth);
+    }
+}
+}  // namespace
+
+bool My::CollideHeightfield(const CollisionShape& a, const ShapePose& pa,
+                            const CollisionShape& b, const ShapePose& pb,
+                            CollisionResult& result) {
+    if (!b.heightfield) return false;
+    const auto& heightfield = *b.heightfield;
+    const ShapePose local = relative_pose(pa, pb);
+
+    auto& contacts = terrain_contacts();
+    contacts.Clear();
+    auto collide = [&](const auto& shape) {
+        using PlaneInstance = ConvexInstance<HalfSpace<float>>;
+        if constexpr (is_same_v<decay_t<decltype(shape)>, PlaneInstance>) {
+            return false;
+        } else {
+            auto collide_cell = [&](uint32_t column, uint32_t row) {
+                Vector3f triangles[2][3];
+                heightfield.GetTriangles(column, row, triangles);
+                for (const auto* triangle : triangles) {
+                    if (a.type == GeometryType::kSphere) {
+                        sphere_triangle(local.position, a.radius, triangle,
+                                        contacts);
+                    } else {
+                        face_triangle(shape, triangle, contacts);
+                    }
+                }
+            };
+            Vector3f min, max;
+            support_bounds(shape, min, max);
+            heightfield.QueryCells(min, max, collide_cell);
+            return true;
+        }
+    };
+    if (!with_convex_instance(a, local, collide) || contacts.points.empty()) {
+        return false;
+    }
+
+    // a sphere touches at a single point, the deepest
+    if (a.type == GeometryType::kSphere) {
+        const auto deepest = static_cast<size_t>(
+            max_element(contacts.depths.begin(), contacts.depths.end()) -
+            contacts.depths.begin());
+        result.normal = to_world_direction(pb, contacts.normals[deepest]);
+        result.normal = -result.normal;
+        result.pointCount = 0;
+        add_point(result, local_to_world(pb, contacts.points[deepest]),
+                  contacts.depths[deepest]);
+        return true;
+    }
+
+    Vector3f normal(0.0f);
+    for (size_t i = 0; i < contacts.points.size(); i++) {
+        normal = normal + contacts.normals[i] * contacts.depths[i];
+        contacts.points[i] = local_to_world(pb, contacts.points[i]);
+    }
+    Normalize(normal);
+    // from A down into the terrain
+    result.normal = -to_world_direction(pb, normal);
+    reduce_points(result, contacts.points.data(), contacts.depths.data(),
+                  static_cast<uint32_t>(contacts.points.size()));
+    return result.pointCount > 0;
+}
+
+namespace {
+// Distance to the closest triangle, by GJK. The surface straight below the
+// lowest point of the shape is no farther than its height above it, which
+// bounds the triangles to look at.
+bool heightfield_distance(const CollisionShape& a, const ShapePose& pa,
+                          const CollisionShape& b, const ShapePose& pb,
+                          DistanceResult& result) {
+    CollisionResult touching;
+    if (!b.heightfield || CollideHeightfield(a, pa, b, pb, touching)) {
+        return false;
+    }
+    const auto& heightfield = *b.heightfield;
+    const ShapePose local = relative_pose(pa, pb);
+
+    auto distance = [&](const auto& shape) {
+        using PlaneInstance = ConvexInstance<HalfSpace<float>>;
+        if constexpr (is_same_v<decay_t<decltype(shape)>, PlaneInstance>) {
+            return false;
+        } else {
+            Vector3f min, max;
+            support_bounds(shape, min, max);
+            const Vector3f lowest = shape.Support({0.0f, 0.0f, -1.0f});
+            float surface;
+            float reach = numeric_limits<float>::max();
+            if (heightfield.GetSurfaceHeight(lowest[0], lowest[1], surface)) {
+                reach = lowest[2] - surface;
+                if (reach <= 0.0f) return false;
+            }
+
+            bool found = false;
+            auto distance_cell = [&](uint32_t column, uint32_t row) {
+                Vector3f triangles[2][3];
+                heightfield.GetTriangles(column, row, triangles);
+                for (const auto* triangle : triangles) {
+                    const TriangleSupport support{
+                        {triangle[0], triangle[1], triangle[2]}};
+                    const ConvexInstance instance(support, Vector3f(0.0f));
+                    Simplex<float> simplex;
+                    GjkResult<float> gjk;
+                    // touching was ruled out above, up to the tolerances
+                    if (GjkDistance(shape, instance, simplex, gjk) ||
+                        gjk.distance <= 0.0f) {
+                        continue;
+                    }
+                    if (found && gjk.distance >= result.distance) continue;
+                    found = true;
+                    result.distance = gjk.distance;
+                    result.pointA = gjk.pointA;
+                    result.pointB = gjk.pointB;
+                }
+            };
+            const Vector3f margin(reach);
+            heightfield.QueryCells(min - margin, max + margin, distance_cell);
+            if (!found) return false;
+
+            result.normal = to_world_direction(
+                pb, (result.pointB - result.pointA) * (1.0f / result.distance));
+            result.pointA = local_to_world(pb, result.pointA);
+            result.pointB = local_to_world(pb, result.pointB);
+            return true;
+        }
+    };
+    return with_convex_instance(a, local, distance);
+}
+}  // namespace
+
+bool My::Collide(const CollisionShape& a, const ShapePose& pa,
+                 const CollisionShape& b, const ShapePose& pb,
+                 CollisionResult& result) {
+    auto swapped = [&](auto collide, const CollisionShape& first,
+                       const ShapePose& first_pose,
+                       const CollisionShape& second,
+                       const ShapePose& second_pose) {
+        if (!collide(first, first_pose, second, second_pose, result)) {
+            return false;
+        }
+        result.normal = -result.normal;
+        return true;
+    };
+
+    if (b.type == GeometryType::kHeightfield) {
+        return CollideHeightfield(a, pa, b, pb, result);
+    }
+    if (a.type == GeometryType::kHeightfield) {
+        return swapped(CollideHeightfield, b, pb, a, pa);
+    }
+
+    if (a.type == GeometryType::kPolyhydron ||
+        b.type == GeometryType::kPolyhydron) {
+        return CollideConvexShapes(a, pa, b, pb, result);
+    }
+
+    switch (a.type) {
+        case GeometryType::kSphere:
+            switch (b.type) {
+                case GeometryType::kSphere:
+                    return CollideSphereSphere(a, pa, b, pb, result);
+                case GeometryType::kBox:
+                    return CollideSphereBox(a, pa, b, pb, result);
+                case GeometryType::kPlane:
+                    return CollideSpherePlane(a, pa, b, pb, result);
+                default:
+                    return false;
+            }
+        case GeometryType::kBox:
+            switch (b.type) {
+                case GeometryType::kSphere:
+                    return swapped(CollideSphereBox, b, pb, a, pa);
+                case GeometryType::kBox:
+                    return CollideBoxBox(a, pa, b, pb, result);
+                case GeometryType::kPlane:
+                    return CollideBoxPlane(a, pa, b, pb, result);
+                default:
+                    return false;
+            }
+        case GeometryType::kPlane:
+            switch (b.type) {
+                case GeometryType::kSphere:
+                    return swapped(CollideSpherePlane, b, pb, a, pa);
+                case GeometryType::kBox:
+                    return swapped(CollideBoxPlane, b, pb, a, pa);
+                default:
+                    return false;
+            }
+        default:
+            return false;
+    }
+}
+
+bool My::ShapeDistance(const CollisionShape& a, const ShapePose& pa,
+                       const CollisionShape& b, const ShapePose& pb,
+                       DistanceResult& result) {
+    if (b.type == GeometryType::kHeightfield) {
+        return heightfield_distance(a, pa, b, pb, result);
+    }
+    if (a.type == GeometryType::kHeightfield) {
+        if (!heightfield_distance(b, pb, a, pa, result)) return false;
+        result.normal = -result.normal;
+        swap(result.pointA, result.pointB);
+        return true;
+    }
+
+    using PlaneInstance = ConvexInstance<HalfSpace<float>>;
+
+    // normal points away from the solid side of the plane
+    auto to_plane = [&result](const auto& shape, const PlaneInstance& plane,
+                              float sign) {
+        const Vector3f n = plane.ToWorldDirection(plane.shape.normal);
+        const float intercept =
+            DotProduct(n, plane.position) + plane.shape.intercept;
+        const Vector3f deepest = shape.Support(-n);
+        const float distance = DotProduct(n, deepest) - intercept;
+        if (distance <= 0.0f) return false;
+
+        result.distance = distance;
+        result.normal = n * -sign;
+        const Vector3f on_plane = deepest - n * distance;
+        result.pointA = (sign > 0.0f) ? deepest : on_plane;
+        result.pointB = (sign > 0.0f) ? on_plane : deepest;
+        return true;
+    };
+
+    return with_convex_instance(a, pa, [&](const auto& instance_a) {
+        return with_convex_instance(b, pb, [&](const auto& instance_b) {
+            constexpr bool plane_a =
+                is_same_v<decay_t<decltype(instance_a)>, PlaneInstance>;
+            constexpr bool plane_b =
+                is_same_v<decay_t<decltype(instance_b)>, PlaneInstance>;
+            if constexpr (plane_a && plane_b) {
+                return false;
+            } else if constexpr (plane_b) {
+                return to_plane(instance_a, instance_b, 1.0f);
+            } else if constexpr (plane_a) {
+                return to_plane(instance_b, instance_a, -1.0f);
+            } else {
+                Simplex<float> simplex;
+                GjkResult<float> gjk;
+                if (GjkDistance(instance_a, instance_b, simplex, gjk) ||
+                    gjk.distance <= 0.0f) {
+                    return false;
+                }
+
+                result.distance = gjk.distance;
+                result.normal =
+                    (gjk.pointB - gjk.pointA) * (1.0f / gjk.distance);
+                result.pointA = gjk.pointA;
+                result.pointB = gjk.pointB;
+                return true;
+            }
+        });
+    });
+}
+
+namespace {
+// Clips the ray (in the space of the planes) to the inside of the planes
+// DotProduct(normal, x) <= offset. enter is the plane the ray enters through,
+// kNoPlane if it starts inside.
+const uint32_t kNoPlane = 0xFFFFFFFF;
+
+struct RayClip {
+    float enter{0.0f};
+    float exit;
+    uint32_t plane{kNoPlane};
+
+    explicit RayClip(float max_distance) : exit(max_distance) {}
+
+    // false once the ray misses
+    bool Clip(const Vector3f& origin, const Vector3f& direction,
+              const Vector3f& normal, float offset, uint32_t index) {
+        const float distance = DotProduct(normal, origin) - offset;
+        const float speed = DotProduct(normal, direction);
+        if (fabs(speed) < 1e-12f) return distance <= 0.0f;
+
+        const float t = -distance / speed;
+        if (speed < 0.0f) {
+            if (t > enter) {
+                enter = t;
+                plane = index;
+            }
+        } else {
+            exit = std::min(exit, t);
+        }
+        return enter <= exit;
+    }
+};
+}  // namespace
+
+bool My::RayCastShape(const CollisionShape& shape, const ShapePose& pose,
+                      const Vector3f& origin, const Vector3f& direction,
+                      float max_distance, float& distance,
+                      Vector3f& normal) {
+    switch (shape.type) {
+        case GeometryType::kSphere: {
+            const Vector3f offset = origin - pose.position;
+            const float b = DotProduct(offset, direction);
+            const float c =
+                DotProduct(offset, offset) - shape.radius * shape.radius;
+            if (c <= 0.0f) {
+                distance = 0.0f;
+                normal = direction * -1.0f;
+                return true;
+            }
+            // outside and going away
+            if (b > 0.0f) return false;
+            const float discriminant = b * b - c;
+            if (discriminant < 0.0f) return false;
+            const float t = -b - sqrt(discriminant);
+            if (t > max_distance) return false;
+
+            distance = t;
+            normal = (origin + direction * t - pose.position) *
+                     (1.0f / shape.radius);
+            return true;
+        }
+        case GeometryType::kPlane: {
+            float intercept;
+            world_plane(shape, pose, normal, intercept);
+            const float height = DotProduct(normal, origin) - intercept;
+            if (height <= 0.0f) {
+                distance = 0.0f;
+                normal = direction * -1.0f;
+                return true;
+            }
+            const float speed = DotProduct(normal, direction);
+            if (speed >= 0.0f || -height / speed > max_distance) return false;
+            distance = -height / speed;
+            return true;
+        }
+        case GeometryType::kBox:
+        case GeometryType::kPolyhydron: {
+            // in body space, against the face planes
+            const Vector3f local_origin = world_to_local(pose, origin);
+            const Vector3f local_direction = {
+                DotProduct(direction, pose.axis[0]),
+                DotProduct(direction, pose.axis[1]),
+                DotProduct(direction, pose.axis[2])};
+            RayClip clip(max_distance);
+            Vector3f local_normal;
+            if (shape.type == GeometryType::kBox) {
+                for (uint32_t i = 0; i < 6; i++) {
+                    Vector3f n(0.0f);
+                    n[i >> 1] = (i & 1) ? -1.0f : 1.0f;
+                    if (!clip.Clip(local_origin, local_direction, n,
+                                   shape.halfExtents[i >> 1], i)) {
+                        return false;
+                    }
+                }
+                if (clip.plane != kNoPlane) {
+                    local_normal = Vector3f(0.0f);
+                    local_normal[clip.plane >> 1] =
+                        (clip.plane & 1) ? -1.0f : 1.0f;
+                }
+            } else {
+                if (!shape.hull) return false;
+                const auto& hull = *shape.hull;
+                for (uint32_t f = 0; f < hull.GetFaceCount(); f++) {
+                    const auto& n = hull.faceNormals[f];
+                    const auto& v =
+                        hull.vertices[hull.faceIndices[hull.faceOffsets[f]]];
+                    if (!clip.Clip(local_origin, local_direction, n,
+                                   DotProduct(n, v), f)) {
+                        return false;
+                    }
+                }
+                if (clip.plane != kNoPlane) {
+                    local_normal = hull.faceNormals[clip.plane];
+                }
+            }
+
+            distance = clip.enter;
+            if (clip.plane == kNoPlane) {
+                normal = direction * -1.0f;
+            } else {
+                normal = pose.axis[0] * local_normal[0] +
+                         pose.axis[1] * local_normal[1] +
+                         pose.axis[2] * local_normal[2];
+            }
+            return true;
+        }
+        case GeometryType::kHeightfield: {
+            if (!shape.heightfield) return false;
+            if (!shape.heightfield->RayCast(
+                    world_to_local(pose, origin),
+                    to_local_direction(pose, direction), max_distance,
+                    distance, normal)) {
+                return false;
+            }
+            normal = to_world_direction(pose, normal);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+#include "Geometry.hpp"
+#include "GjkEpa.hpp"
+#include "Heightfield.hpp"
+#include "geommath.hpp"
+
+namespace My {
+// Collision shape of a rigid body, in body space
+struct CollisionShape {
+    GeometryType type{GeometryType::kSphere};
+    float radius{0.0f};     // kSphere
+    Vector3f halfExtents;   // kBox
+    Vector3f normal;        // kPlane: dot(normal, x) = intercept
+    float intercept{0.0f};  // kPlane
+    std::shared_ptr<const ConvexHullSupport<float>> hull;  // kPolyhydron
+    // kHeightfield, only for static bodies
+    std::shared_ptr<const Heightfield> heightfield;
+};
+
+// World placement of a shape: the origin of the body and the world space
+// directions of its x, y and z axes
+struct ShapePose {
+    Vector3f position;
+    Vector3f axis[3];
+};
+
+constexpr uint32_t kMaxContactPoints = 4;
+
+// Narrowphase result. The normal points from shape A to shape B, each point
+// lies half way between the two surfaces.
+struct CollisionResult {
+    Vector3f normal;
+    uint32_t pointCount{0};
+    Vector3f points[kMaxContactPoints];
+    float depths[kMaxContactPoints];
+};
+
+bool CollideSphereSphere(const CollisionShape& a, const ShapePose& pa,
+                         const CollisionShape& b, const ShapePose& pb,
+                         CollisionResult& result);
+bool CollideSphereBox(const CollisionShape& a, const ShapePose& pa,
+                      const CollisionShape& b, const ShapePose& pb,
+                      CollisionResult& result);
+bool CollideSpherePlane(const CollisionShape& a, const ShapePose& pa,
+                        const CollisionShape& b, const ShapePose& pb,
+                        CollisionResult& result);
+bool CollideBoxPlane(const CollisionShape& a, const ShapePose& pa,
+                     const CollisionShape& b, const ShapePose& pb,
+                     CollisionResult& result);
+// separating axis test over the 15 candidate axes, then clipping of the
+// incident face against the reference face (or the closest points of two
+// edges) to build the manifold
+bool CollideBoxBox(const CollisionShape& a, const ShapePose& pa,
+                   const CollisionShape& b, const ShapePose& pb,
+                   CollisionResult& result);
+
+// B is a heightfield. Spheres against the closest points of the triangles
+// under them, other shapes by clipping their face towards each triangle to
+// the triangle, along its normal. The manifold normal is the average of the
+// normals of the triangles touched, weighted by depth.
+bool CollideHeightfield(const CollisionShape& a, const ShapePose& pa,
+                        const CollisionShape& b, const ShapePose& pb,
+                        CollisionResult& result);
+
+// GJK and EPA, for pairs with a convex hull
+bool CollideConvexShapes(const CollisionShape& a, const ShapePose& pa,
+                         const CollisionShape& b, const ShapePose& pb,
+                         CollisionResult& result);
+
+// dispatch on the shape types, false if the shapes do not touch or the pair
+// is not supported (plane or heightfield against plane or heightfield)
+bool Collide(const CollisionShape& a, const ShapePose& pa,
+             const CollisionShape& b, const ShapePose& pb,
+             CollisionResult& result);
+
+// Separation of two shapes that do not touch
+struct DistanceResult {
+    float distance;
+    Vector3f normal;  // from A to B
+    // closest points, on A and on B
+    Vector3f pointA;
+    Vector3f pointB;
+};
+
+// GJK distance, or the support point against a plane. false if the shapes
+// intersect or the pair is not supported (plane or heightfield against
+// plane or heightfield).
+bool ShapeDistance(const CollisionShape& a, const ShapePose& pa,
+                   const CollisionShape& b, const ShapePose& pb,
+                   DistanceResult& result);
+
+// First point of the shape along the ray from origin in the unit direction,
+// no farther than max_distance. The normal is the outward normal of the
+// surface there. A ray starting inside the shape hits it at distance 0,
+// with the normal against the direction.
+bool RayCastShape(const CollisionShape& shape, const ShapePose& pose,
+                  const Vector3f& origin, const Vector3f& direction,
+                  float max_distance, float& distance, Vector3f& normal);
+}  // namespace My
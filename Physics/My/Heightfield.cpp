@@ -0,0 +1,277 @@
+#include "Heightfield.hpp"
+
+#include <cassert>
+
+using namespace My;
+using namespace std;
+
+namespace {
+// part of the segment [enter, exit] of the ray inside the bounds, slab by
+// slab
+bool clip_ray(const Vector3f& origin, const Vector3f& direction,
+              const Vector3f& min, const Vector3f& max, float& enter,
+              float& exit) {
+    for (int i = 0; i < 3; i++) {
+        if (direction[i] == 0.0f) {
+            if (origin[i] < min[i] || max[i] < origin[i]) return false;
+            continue;
+        }
+        const float inverse = 1.0f / direction[i];
+        float t1 = (min[i] - origin[i]) * inverse;
+        float t2 = (max[i] - origin[i]) * inverse;
+        if (t1 > t2) swap(t1, t2);
+        enter = std::max(enter, t1);
+        exit = std::min(exit, t2);
+        if (enter > exit) return false;
+    }
+    return true;
+}
+
+// Moller-Trumbore, front side only
+bool ray_triangle(const Vector3f& origin, const Vector3f& direction,
+                  const Vector3f* triangle, float max_distance,
+                  float& distance, Vector3f& normal) {
+    const Vector3f e1 = triangle[1] - triangle[0];
+    const Vector3f e2 = triangle[2] - triangle[0];
+    const Vector3f n = CrossProduct(e1, e2);
+    if (DotProduct(n, direction) >= 0.0f) return false;
+
+    const Vector3f p = CrossProduct(direction, e2);
+    const float inverse = 1.0f / DotProduct(e1, p);
+    const Vector3f s = origin - triangle[0];
+    const float u = DotProduct(s, p) * inverse;
+    if (u < 0.0f || u > 1.0f) return false;
+    const Vector3f q = CrossProduct(s, e1);
+    const float v = DotProduct(direction, q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    const float t = DotProduct(e2, q) * inverse;
+    if (t < 0.0f || t > max_distance) return false;
+
+    distance = t;
+    normal = n * (1.0f / Length(n));
+    return true;
+}
+}  // namespace
+
+Heightfield::Heightfield(uint32_t columns, uint32_t rows,
+                         const float* heights, float spacing_x,
+                         float spacing_y)
+    : m_nColumns(columns),
+      m_nRows(rows),
+      m_fSpacingX(spacing_x),
+      m_fSpacingY(spacing_y) {
+    assert(columns >= 2 && rows >= 2);
+
+    const size_t count = static_cast<size_t>(columns) * rows;
+    const auto [lowest, highest] = minmax_element(heights, heights + count);
+    m_fHeightOffset = *lowest;
+    // a flat terrain keeps all its samples at 0
+    const float range = *highest - *lowest;
+    m_fHeightScale = (range > 0.0f) ? range / 65535.0f : 1.0f;
+
+    m_Samples.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const float sample =
+            round((heights[i] - m_fHeightOffset) / m_fHeightScale);
+        m_Samples[i] =
+            static_cast<uint16_t>(std::clamp(sample, 0.0f, 65535.0f));
+    }
+
+    // leaves from the samples of their cells
+    uint32_t width = (columns - 1 + kBlockSize - 1) >> kBlockShift;
+    uint32_t height = (rows - 1 + kBlockSize - 1) >> kBlockShift;
+    m_Levels.push_back({0, width, height});
+    m_Nodes.resize(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            Range range_xy = {0xFFFF, 0};
+            const uint32_t c_end =
+                std::min((x + 1) << kBlockShift, columns - 1);
+            const uint32_t r_end =
+                std::min((y + 1) << kBlockShift, rows - 1);
+            for (uint32_t r = y << kBlockShift; r <= r_end; r++) {
+                for (uint32_t c = x << kBlockShift; c <= c_end; c++) {
+                    range_xy.min = std::min(range_xy.min, sample(c, r));
+                    range_xy.max = std::max(range_xy.max, sample(c, r));
+                }
+            }
+            m_Nodes[y * width + x] = range_xy;
+        }
+    }
+
+    // then each level from the one below, up to a single root
+    while (width > 1 || height > 1) {
+        const Level below = m_Levels.back();
+        width = (width + 1) >> 1;
+        height = (height + 1) >> 1;
+        const auto offset = static_cast<uint32_t>(m_Nodes.size());
+        m_Levels.push_back({offset, width, height});
+        m_Nodes.resize(offset + static_cast<size_t>(width) * height);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                Range range_xy = {0xFFFF, 0};
+                for (uint32_t k = 0; k < 4; k++) {
+                    const uint32_t cx = 2 * x + (k & 1);
+                    const uint32_t cy = 2 * y + (k >> 1);
+                    if (cx >= below.width || cy >= below.height) continue;
+                    const auto& child =
+                        m_Nodes[below.offset + cy * below.width + cx];
+                    range_xy.min = std::min(range_xy.min, child.min);
+                    range_xy.max = std::max(range_xy.max, child.max);
+                }
+                m_Nodes[offset + y * width + x] = range_xy;
+            }
+        }
+    }
+}
+
+void Heightfield::GetBounds(Vector3f& min, Vector3f& max) const {
+    const auto& root = m_Nodes.back();
+    min = {0.0f, 0.0f, dequantize(root.min)};
+    max = {m_fSpacingX * static_cast<float>(m_nColumns - 1),
+           m_fSpacingY * static_cast<float>(m_nRows - 1),
+           dequantize(root.max)};
+}
+
+size_t Heightfield::GetMemorySize() const {
+    return sizeof(*this) + m_Samples.size() * sizeof(uint16_t) +
+           m_Nodes.size() * sizeof(Range) + m_Levels.size() * sizeof(Level);
+}
+
+void Heightfield::GetTriangles(uint32_t column, uint32_t row,
+                               Vector3f triangles[2][3]) const {
+    const float x0 = m_fSpacingX * static_cast<float>(column);
+    const float y0 = m_fSpacingY * static_cast<float>(row);
+    const float x1 = x0 + m_fSpacingX;
+    const float y1 = y0 + m_fSpacingY;
+    const Vector3f p00 = {x0, y0, GetHeight(column, row)};
+    const Vector3f p10 = {x1, y0, GetHeight(column + 1, row)};
+    const Vector3f p01 = {x0, y1, GetHeight(column, row + 1)};
+    const Vector3f p11 = {x1, y1, GetHeight(column + 1, row + 1)};
+
+    triangles[0][0] = p00;
+    triangles[0][1] = p10;
+    triangles[0][2] = p11;
+    triangles[1][0] = p00;
+    triangles[1][1] = p11;
+    triangles[1][2] = p01;
+}
+
+bool Heightfield::GetSurfaceHeight(float x, float y, float& height) const {
+    const auto cells_x = static_cast<float>(m_nColumns - 1);
+    const auto cells_y = static_cast<float>(m_nRows - 1);
+    const float fx = x / m_fSpacingX;
+    const float fy = y / m_fSpacingY;
+    if (!(fx >= 0.0f && fy >= 0.0f && fx <= cells_x && fy <= cells_y)) {
+        return false;
+    }
+
+    const float column = std::min(floor(fx), cells_x - 1.0f);
+    const float row = std::min(floor(fy), cells_y - 1.0f);
+    const float u = fx - column;
+    const float v = fy - row;
+    const auto c = static_cast<uint32_t>(column);
+    const auto r = static_cast<uint32_t>(row);
+    const float h00 = GetHeight(c, r);
+    const float h11 = GetHeight(c + 1, r + 1);
+    if (u >= v) {
+        const float h10 = GetHeight(c + 1, r);
+        height = h00 + u * (h10 - h00) + v * (h11 - h10);
+    } else {
+        const float h01 = GetHeight(c, r + 1);
+        height = h00 + v * (h01 - h00) + u * (h11 - h01);
+    }
+    return true;
+}
+
+Heightfield::Range Heightfield::cellRange(uint32_t column,
+                                          uint32_t row) const {
+    const uint16_t a = sample(column, row);
+    const uint16_t b = sample(column + 1, row);
+    const uint16_t c = sample(column, row + 1);
+    const uint16_t d = sample(column + 1, row + 1);
+    return {std::min({a, b, c, d}), std::max({a, b, c, d})};
+}
+
+void Heightfield::nodeCells(const Node& n, uint32_t& column_begin,
+                            uint32_t& row_begin, uint32_t& column_end,
+                            uint32_t& row_end) const {
+    const uint32_t shift = n.level + kBlockShift;
+    column_begin = n.x << shift;
+    row_begin = n.y << shift;
+    column_end = std::min(((n.x + 1) << shift) - 1, m_nColumns - 2);
+    row_end = std::min(((n.y + 1) << shift) - 1, m_nRows - 2);
+}
+
+void Heightfield::pushChildren(const Node& n, Node* stack,
+                               uint32_t& count) const {
+    const auto& below = m_Levels[n.level - 1];
+    for (uint32_t k = 0; k < 4; k++) {
+        const uint32_t x = 2 * n.x + (k & 1);
+        const uint32_t y = 2 * n.y + (k >> 1);
+        if (x >= below.width || y >= below.height) continue;
+        assert(count < kMaxStackSize);
+        stack[count++] = {n.level - 1, x, y};
+    }
+}
+
+bool Heightfield::RayCast(const Vector3f& origin, const Vector3f& direction,
+                          float max_distance, float& distance,
+                          Vector3f& normal) const {
+    float surface;
+    if (GetSurfaceHeight(origin[0], origin[1], surface) &&
+        origin[2] <= surface) {
+        distance = 0.0f;
+        normal = direction * -1.0f;
+        return true;
+    }
+
+    // bounds are padded against rays grazing them
+    const float margin = 1e-4f * std::max(m_fSpacingX, m_fSpacingY);
+    bool hit = false;
+    distance = max_distance;
+
+    Node stack[kMaxStackSize];
+    uint32_t count = 0;
+    stack[count++] = {static_cast<uint32_t>(m_Levels.size() - 1), 0, 0};
+    while (count > 0) {
+        const Node n = stack[--count];
+        uint32_t c0, r0, c1, r1;
+        nodeCells(n, c0, r0, c1, r1);
+
+        const auto& range = node(n);
+        const Vector3f min = {m_fSpacingX * static_cast<float>(c0) - margin,
+                              m_fSpacingY * static_cast<float>(r0) - margin,
+                              dequantize(range.min) - margin};
+        const Vector3f max = {
+            m_fSpacingX * static_cast<float>(c1 + 1) + margin,
+            m_fSpacingY * static_cast<float>(r1 + 1) + margin,
+            dequantize(range.max) + margin};
+        float enter = 0.0f, exit = distance;
+        if (!clip_ray(origin, direction, min, max, enter, exit)) continue;
+
+        if (n.level > 0) {
+            pushChildren(n, stack, count);
+            continue;
+        }
+
+        for (uint32_t r = r0; r <= r1; r++) {
+            for (uint32_t c = c0; c <= c1; c++) {
+                Vector3f triangles[2][3];
+                GetTriangles(c, r, triangles);
+                for (const auto* triangle : triangles) {
+                    float t;
+                    Vector3f n_t;
+                    if (ray_triangle(origin, direction, triangle, distance, t,
+                                     n_t)) {
+                        hit = true;
+                        distance = t;
+                        normal = n_t;
+                    }
+                }
+            }
+        }
+    }
+
+    return hit;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "geommath.hpp"
+
+namespace My {
+// Terrain given by a grid of height samples, collided against without
+// triangulating it. In body space sample (column, row) lies at
+// (column * spacing x, row * spacing y, height), z up. Each cell is split
+// along its diagonal from (column, row) to (column + 1, row + 1), and
+// everything below the surface is solid. The sides are open.
+//
+// Heights are quantized to 16 bits over the range of the samples. A min/max
+// quadtree over blocks of cells lets the queries skip the parts of the
+// terrain they can not reach.
+class Heightfield {
+   public:
+    // columns * rows heights, row by row, at least 2 x 2 of them
+    Heightfield(uint32_t columns, uint32_t rows, const float* heights,
+                float spacing_x, float spacing_y);
+
+    [[nodiscard]] uint32_t GetColumns() const { return m_nColumns; }
+    [[nodiscard]] uint32_t GetRows() const { return m_nRows; }
+    [[nodiscard]] float GetHeight(uint32_t column, uint32_t row) const {
+        return dequantize(m_Samples[row * m_nColumns + column]);
+    }
+    // body space bounds of the surface
+    void GetBounds(Vector3f& min, Vector3f& max) const;
+    // bytes taken by the samples and the quadtree
+    [[nodiscard]] size_t GetMemorySize() const;
+
+    // the two triangles of a cell, counter clockwise seen from above
+    void GetTriangles(uint32_t column, uint32_t row,
+                      Vector3f triangles[2][3]) const;
+    // height of the surface at (x, y), false outside of the grid
+    bool GetSurfaceHeight(float x, float y, float& height) const;
+
+    // Calls function(column, row) for the cells under [min, max] in x and
+    // y whose surface reaches up to min z. Cells above max z are reported
+    // as well, what is below them is solid.
+    template <class Function>
+    void QueryCells(const Vector3f& min, const Vector3f& max,
+                    Function&& function) const;
+
+    // First point of the surface hit from above along the ray from origin
+    // in the unit direction, no farther than max_distance, in body space.
+    // A ray starting below the surface hits it at distance 0, with the
+    // normal against the direction.
+    bool RayCast(const Vector3f& origin, const Vector3f& direction,
+                 float max_distance, float& distance, Vector3f& normal) const;
+
+   private:
+    struct Range {
+        uint16_t min;
+        uint16_t max;
+    };
+
+    // nodes of one level of the quadtree, row by row from offset
+    struct Level {
+        uint32_t offset;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct Node {
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    // leaves cover kBlockSize x kBlockSize cells
+    static constexpr uint32_t kBlockShift = 2;
+    static constexpr uint32_t kBlockSize = 1u << kBlockShift;
+    // 3 siblings left on the stack per level, and the node being visited
+    static constexpr uint32_t kMaxStackSize = 3 * 32 + 1;
+
+    [[nodiscard]] float dequantize(uint16_t sample) const {
+        return m_fHeightOffset + m_fHeightScale * sample;
+    }
+    [[nodiscard]] uint16_t sample(uint32_t column, uint32_t row) const {
+        return m_Samples[row * m_nColumns + column];
+    }
+    [[nodiscard]] Range cellRange(uint32_t column, uint32_t row) const;
+    [[nodiscard]] const Range& node(const Node& n) const {
+        const auto& level = m_Levels[n.level];
+        return m_Nodes[level.offset + n.y * level.width + n.x];
+    }
+    // cells of the node clipped to the grid, last ones included
+    void nodeCells(const Node& n, uint32_t& column_begin, uint32_t& row_begin,
+                   uint32_t& column_end, uint32_t& row_end) const;
+    // pushes the children of n
+    void pushChildren(const Node& n, Node* stack, uint32_t& count) const;
+
+   private:
+    uint32_t m_nColumns;
+    uint32_t m_nRows;
+    float m_fSpacingX;
+    float m_fSpacingY;
+    float m_fHeightOffset{0.0f};
+    float m_fHeightScale{0.0f};
+
+    std::vector<uint16_t> m_Samples;
+    // all the levels, leaves first and the root last
+    std::vector<Range> m_Nodes;
+    std::vector<Level> m_Levels;
+};
+
+template <class Function>
+void Heightfield::QueryCells(const Vector3f& min, const Vector3f& max,
+                             Function&& function) const {
+    const auto cells_x = static_cast<float>(m_nColumns - 1);
+    const auto cells_y = static_cast<float>(m_nRows - 1);
+    const float x0 = std::floor(min[0] / m_fSpacingX);
+    const float y0 = std::floor(min[1] / m_fSpacingY);
+    const float x1 = std::floor(max[0] / m_fSpacingX);
+    const float y1 = std::floor(max[1] / m_fSpacingY);
+    if (!(x1 >= 0.0f && y1 >= 0.0f && x0 < cells_x && y0 < cells_y)) return;
+
+    const auto column_begin = static_cast<uint32_t>(std::max(x0, 0.0f));
+    const auto row_begin = static_cast<uint32_t>(std::max(y0, 0.0f));
+    const auto column_end = static_cast<uint32_t>(std::min(x1, cells_x - 1));
+    const auto row_end = static_cast<uint32_t>(std::min(y1, cells_y - 1));
+
+    // lowest sample reaching min z, rounded down
+    const float lowest = (min[2] - m_fHeightOffset) / m_fHeightScale;
+    if (lowest > 65535.0f) return;
+    const auto low = static_cast<uint16_t>(std::max(std::floor(lowest), 0.0f));
+
+    Node stack[kMaxStackSize];
+    uint32_t count = 0;
+    stack[count++] = {static_cast<uint32_t>(m_Levels.size() - 1), 0, 0};
+    while (count > 0) {
+        const Node n = stack[--count];
+        if (node(n).max < low) continue;
+
+        uint32_t c0, r0, c1, r1;
+        nodeCells(n, c0, r0, c1, r1);
+        if (c0 > column_end || c1 < column_begin || r0 > row_end ||
+            r1 < row_begin) {
+            continue;
+        }
+
+        if (n.level > 0) {
+            pushChildren(n, stack, count);
+            continue;
+        }
+
+        for (uint32_t r = std::max(r0, row_begin); r <= std::min(r1, row_end);
+             r++) {
+            for (uint32_t c = std::max(c0, column_begin);
+                 c <= std::min(c1, column_end); c++) {
+                if (cellRange(c, r).max >= low) function(c, r);
+            }
+        }
+    }
+}
+}  // namespace My
@@ -4,6 +4,8 @@
 
 #include "BaseApplication.hpp"
 #include "Box.hpp"
+#include "ConvexHull.hpp"
+#include "MemoryTracker.hpp"
 #include "Plane.hpp"
 #include "RigidBody.hpp"
 #include "Sphere.hpp"
@@ -11,6 +13,11 @@
 using namespace My;
 using namespace std;
 
+namespace {
+// vertices kept in the hulls of meshes, GJK cost grows with them
+const uint32_t kMaxHullVertexCount = 32;
+}  // namespace
+
 int MyPhysicsManager::Initialize() {
     cout << "[MyPhysicsManager] Initialize" << endl;
     return 0;
@@ -20,47 +27,31 @@ void MyPhysicsManager::Finalize() {
     cout << "[MyPhysicsManager] Finalize" << endl;
     // Clean up
     ClearRigidBodies();
-}
-
-void MyPhysicsManager::IterateConvexHull() {
-    auto pSceneManager =
-        dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
-    auto& scene = pSceneManager->GetSceneForPhysicalSimulation();
-
-    // Geometries
-    for (const auto& _it : scene->GeometryNodes) {
-        auto pGeometryNode = _it.second.lock();
-        if (pGeometryNode) {
-            void* rigidBody = pGeometryNode->RigidBody();
-            if (rigidBody) {
-                auto* _rigidBody = reinterpret_cast<RigidBody<float_precision>*>(rigidBody);
-                auto pGeometry = _rigidBody->GetCollisionShape();
-                if (pGeometry->GetGeometryType() == GeometryType::kPolyhydron) {
-                    if (dynamic_pointer_cast<ConvexHull<float_precision>>(pGeometry)
-                            ->Iterate()) {
-                        // The geometry convex hull is not fully iterated,
-                        // so we break the loop to postpending the process to
-                        // next loop, to avoid too much process in single tick.
-                        break;
-                    }
-
-                    // The geometry convex hull is fully iterated,
-                    // so we move to next geometry
-                }
-            }
-        }
-    }
+    m_World.SetJobSystem(nullptr);
 }
 
 void MyPhysicsManager::Tick() {
-    auto pSceneManager =
-        dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
+    auto* pApp = dynamic_cast<BaseApplication*>(m_pApp);
+    // islands are solved on the application's workers, which it may replace
+    // at any time
+    m_World.SetJobSystem(pApp->GetJobSystem());
+
+    auto pSceneManager = pApp->GetSceneManager();
     auto rev = pSceneManager->GetSceneRevision();
     if (m_nSceneRevision != rev) {
         ClearRigidBodies();
         CreateRigidBodies();
         m_nSceneRevision = rev;
+        m_LastTickTime = chrono::steady_clock::now();
     }
+
+    // the world steps at a fixed rate, whatever the frame rate is
+    const auto now = chrono::steady_clock::now();
+    const chrono::duration<float> elapsed = now - m_LastTickTime;
+    m_LastTickTime = now;
+    m_World.Simulate((m_fFixedFrameTime > 0.0f) ? m_fFixedFrameTime
+                                                : elapsed.count());
+    m_World.GetInterpolatedTransforms(m_Transforms);
 }
 
 void MyPhysicsManager::CreateRigidBody(SceneGeometryNode& node,
@@ -68,61 +59,109 @@ void MyPhysicsManager::CreateRigidBody(SceneGeometryNode& node,
     const float* param = geometry.CollisionParameters();
     RigidBody<float_precision>* rigidBody = nullptr;
 
+    // same masses as the Bullet backend: spheres are dynamic, boxes and
+    // planes static. Hulls, which Bullet does not have here, are dynamic.
     switch (geometry.CollisionType()) {
         case SceneObjectCollisionType::kSceneObjectCollisionTypeSphere: {
-            auto collision_box = make_shared<Sphere<float, void*>>(param[0]);
+            auto collision_box = MakeTaggedShared<Sphere<float, void*>>(
+                MemoryTag::kPhysics, param[0]);
 
             const auto trans = node.GetCalculatedTransform();
-            auto motionState = make_shared<MotionState>(*trans);
-            rigidBody = new RigidBody<float_precision>(collision_box, motionState);
+            auto motionState =
+                MakeTaggedShared<MotionState>(MemoryTag::kPhysics, *trans);
+
+            CollisionShape shape;
+            shape.type = GeometryType::kSphere;
+            shape.radius = param[0];
+            const auto body = m_World.CreateBody(shape, 1.0f, *trans);
+
+            rigidBody = new RigidBody<float_precision>(collision_box,
+                                                       motionState, body);
         } break;
         case SceneObjectCollisionType::kSceneObjectCollisionTypeBox: {
-            auto collision_box =
-                make_shared<Box<float_precision>>(Vector3<float_precision>({param[0], param[1], param[2]}));
+            auto collision_box = MakeTaggedShared<Box<float_precision>>(
+                MemoryTag::kPhysics,
+                Vector3<float_precision>({param[0], param[1], param[2]}));
 
             const auto trans = node.GetCalculatedTransform();
-            auto motionState = make_shared<MotionState>(*trans);
-            rigidBody = new RigidBody<float_precision>(collision_box, motionState);
+            auto motionState =
+                MakeTaggedShared<MotionState>(MemoryTag::kPhysics, *trans);
+
+            CollisionShape shape;
+            shape.type = GeometryType::kBox;
+            shape.halfExtents = {param[0], param[1], param[2]};
+            const auto body = m_World.CreateBody(shape, 0.0f, *trans);
+
+            rigidBody = new RigidBody<float_precision>(collision_box,
+                                                       motionState, body);
         } break;
         case SceneObjectCollisionType::kSceneObjectCollisionTypePlane: {
-            auto collision_box = make_shared<Plane<float_precision>>(
-                Vector3f({param[0], param[1], param[2]}), param[3]);
+            auto collision_box = MakeTaggedShared<Plane<float_precision>>(
+                MemoryTag::kPhysics, Vector3f({param[0], param[1], param[2]}),
+                param[3]);
 
             const auto trans = node.GetCalculatedTransform();
-            auto motionState = make_shared<MotionState>(*trans);
-            rigidBody = new RigidBody<float_precision>(collision_box, motionState);
+            auto motionState =
+                MakeTaggedShared<MotionState>(MemoryTag::kPhysics, *trans);
+
+            CollisionShape shape;
+            shape.type = GeometryType::kPlane;
+            shape.normal = {param[0], param[1], param[2]};
+            shape.intercept = param[3];
+            const auto body = m_World.CreateBody(shape, 0.0f, *trans);
+
+            rigidBody = new RigidBody<float_precision>(collision_box,
+                                                       motionState, body);
         } break;
-        default: {
-            /*
-            // create collision box using convex hull
-            auto bounding_box = geometry.GetBoundingBox();
+        case SceneObjectCollisionType::kSceneObjectCollisionTypeConvexHull: {
+            // built once at load time, simplified for the narrowphase
             auto collision_box =
-            make_shared<ConvexHull>(geometry.GetConvexHull());
+                MakeTaggedShared<ConvexHull<float_precision>>(
+                    MemoryTag::kPhysics,
+                    geometry.GetConvexHull(kMaxHullVertexCount));
+            if (collision_box->GetSupport().vertices.empty()) break;
 
             const auto trans = node.GetCalculatedTransform();
             auto motionState =
-                make_shared<MotionState>(
-                            *trans,
-                            bounding_box.centroid
-                        );
-            rigidBody = new RigidBody(collision_box, motionState);
-            */
-        }
+                MakeTaggedShared<MotionState>(MemoryTag::kPhysics, *trans);
+
+            CollisionShape shape;
+            shape.type = GeometryType::kPolyhydron;
+            shape.hull = MakeTaggedShared<ConvexHullSupport<float>>(
+                MemoryTag::kPhysics, collision_box->GetSupport());
+            const auto body = m_World.CreateBody(shape, 1.0f, *trans);
+
+            rigidBody = new RigidBody<float_precision>(collision_box,
+                                                       motionState, body);
+        } break;
+        default:
+            break;
     }
 
-    node.LinkRigidBody(rigidBody);
+    if (rigidBody) {
+        const BodyId id = rigidBody->GetBodyId();
+        if (id >= m_RigidBodies.size()) m_RigidBodies.resize(id + 1);
+        m_RigidBodies[id] = rigidBody;
+    }
+
+    node.LinkRigidBody(rigidBody, rigidBody ? rigidBody->GetBodyId() : 0);
 }
 
 void MyPhysicsManager::UpdateRigidBodyTransform(SceneGeometryNode& node) {
     const auto trans = node.GetCalculatedTransform();
-    auto rigidBody = node.RigidBody();
-    auto motionState =
-        reinterpret_cast<RigidBody<float_precision>*>(rigidBody)->GetMotionState();
-    motionState->SetTransition(*trans);
+    auto* rigidBody =
+        reinterpret_cast<RigidBody<float_precision>*>(node.RigidBody());
+    if (!rigidBody) return;
+    rigidBody->GetMotionState()->SetTransition(*trans);
+    m_World.SetTransform(rigidBody->GetBodyId(), *trans);
 }
 
 void MyPhysicsManager::DeleteRigidBody(SceneGeometryNode& node) {
     auto* rigidBody = reinterpret_cast<RigidBody<float_precision>*>(node.UnlinkRigidBody());
+    if (rigidBody) {
+        m_World.DestroyBody(rigidBody->GetBodyId());
+        m_RigidBodies[rigidBody->GetBodyId()] = nullptr;
+    }
     delete rigidBody;
 }
 
@@ -143,9 +182,57 @@ int MyPhysicsManager::CreateRigidBodies() {
         }
     }
 
+    if (scene->Terrain) createTerrainBodies(*scene->Terrain);
+
     return 0;
 }
 
+void MyPhysicsManager::createTerrainBodies(SceneObjectTerrain& terrain) {
+    const float spacing = terrain.GetSpacing();
+    const float height_scale = terrain.GetHeightScale();
+    vector<float> heights;
+
+    for (uint32_t i = 0; i < SceneObjectTerrain::GetGridWidth(); i++) {
+        for (uint32_t j = 0; j < SceneObjectTerrain::GetGridHeight(); j++) {
+            const auto image =
+                terrain.GetTexture(SceneObjectTerrain::GetTileIndex(i, j))
+                    .GetTextureImage();
+            // tiles which failed to load, or which can not be sampled
+            if (!image || image->compressed || image->Width < 2 ||
+                image->Height < 2) {
+                continue;
+            }
+
+            heights.resize(static_cast<size_t>(image->Width) * image->Height);
+            for (uint32_t y = 0; y < image->Height; y++) {
+                for (uint32_t x = 0; x < image->Width; x++) {
+                    heights[y * image->Width + x] =
+                        image->GetX(x, y) * height_scale;
+                }
+            }
+
+            CollisionShape shape;
+            shape.type = GeometryType::kHeightfield;
+            shape.heightfield = MakeTaggedShared<Heightfield>(
+                MemoryTag::kPhysics, image->Width, image->Height,
+                heights.data(), spacing, spacing);
+
+            // neighbouring tiles share their edge samples
+            Matrix4X4f trans;
+            MatrixTranslation(trans, spacing * (image->Width - 1) * i,
+                              spacing * (image->Height - 1) * j, 0.0f);
+            auto motionState =
+                MakeTaggedShared<MotionState>(MemoryTag::kPhysics, trans);
+            const auto body = m_World.CreateBody(shape, 0.0f, trans);
+
+            auto* rigidBody =
+                new RigidBody<float_precision>(nullptr, motionState, body);
+            if (body >= m_RigidBodies.size()) m_RigidBodies.resize(body + 1);
+            m_RigidBodies[body] = rigidBody;
+        }
+    }
+}
+
 void MyPhysicsManager::ClearRigidBodies() {
     auto pSceneManager =
         dynamic_cast<BaseApplication*>(m_pApp)->GetSceneManager();
@@ -155,15 +242,112 @@ void MyPhysicsManager::ClearRigidBodies() {
     for (const auto& _it : scene->GeometryNodes) {
         auto pGeometryNode = _it.second.lock();
         if (pGeometryNode) {
-            DeleteRigidBody(*pGeometryNode);
+            pGeometryNode->UnlinkRigidBody();
         }
     }
+
+    // every body in the world, the previous scene's and the terrain's too
+    for (auto* body : m_RigidBodies) {
+        auto* rigidBody = reinterpret_cast<RigidBody<float_precision>*>(body);
+        if (!rigidBody) continue;
+        m_World.DestroyBody(rigidBody->GetBodyId());
+        delete rigidBody;
+    }
+    m_RigidBodies.clear();
 }
 
 Matrix4X4f MyPhysicsManager::GetRigidBodyTransform(void* rigidBody) {
     auto* _rigidBody = reinterpret_cast<RigidBody<float_precision>*>(rigidBody);
-    auto motionState = _rigidBody->GetMotionState();
-    return motionState->GetTransition();
+    return m_World.GetInterpolatedTransform(_rigidBody->GetBodyId());
+}
+
+void MyPhysicsManager::ApplyCentralForce(void* rigidBody, Vector3f force) {
+    auto* _rigidBody = reinterpret_cast<RigidBody<float_precision>*>(rigidBody);
+    m_World.ApplyCentralForce(_rigidBody->GetBodyId(), force);
+}
+
+namespace {
+// shapes of the interface to the ones of the world
+void to_world(const PhysicsQueryShape& query, ShapeQuery& result) {
+    if (query.type == GeometryType::kBox) {
+        result.shape.type = GeometryType::kBox;
+        result.shape.halfExtents = query.halfExtents;
+    } else {
+        result.shape.type = GeometryType::kSphere;
+        result.shape.radius = query.radius;
+    }
+    result.position = query.position;
+    result.orientation = query.orientation;
+}
+}  // namespace
+
+BodyId MyPhysicsManager::bodyOf(void* rigidBody) const {
+    if (!rigidBody) return kInvalidBodyId;
+    return reinterpret_cast<RigidBody<float_precision>*>(rigidBody)
+        ->GetBodyId();
+}
+
+void MyPhysicsManager::fromWorld(const QueryHit& hit,
+                                 PhysicsQueryHit& result) const {
+    if (hit.id == kInvalidBodyId) {
+        result.rigidBody = nullptr;
+        return;
+    }
+    result.rigidBody = m_RigidBodies[hit.id];
+    result.distance = hit.distance;
+    result.point = hit.point;
+    result.normal = hit.normal;
+}
+
+void MyPhysicsManager::CastRays(const PhysicsRay* rays, size_t count,
+                                PhysicsQueryHit* hits) {
+    m_RayQueries.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        auto& query = m_RayQueries[i];
+        query.origin = rays[i].origin;
+        query.direction = rays[i].direction;
+        query.maxDistance = rays[i].maxDistance;
+        query.ignored = bodyOf(rays[i].ignoredRigidBody);
+    }
+
+    m_QueryHits.resize(count);
+    m_World.CastRays(m_RayQueries.data(), count, m_QueryHits.data());
+    for (size_t i = 0; i < count; i++) fromWorld(m_QueryHits[i], hits[i]);
 }
 
-void MyPhysicsManager::ApplyCentralForce(void* rigidBody, Vector3f force) {}
+void MyPhysicsManager::OverlapShapes(const PhysicsQueryShape* shapes,
+                                     size_t count, void** rigid_bodies,
+                                     uint32_t max_results,
+                                     uint32_t* result_counts) {
+    m_ShapeQueries.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        to_world(shapes[i], m_ShapeQueries[i]);
+        m_ShapeQueries[i].ignored = bodyOf(shapes[i].ignoredRigidBody);
+    }
+
+    m_QueryIds.resize(count * max_results);
+    m_World.OverlapShapes(m_ShapeQueries.data(), count, m_QueryIds.data(),
+                          max_results, result_counts);
+    for (size_t i = 0; i < count; i++) {
+        for (uint32_t k = 0; k < result_counts[i]; k++) {
+            const size_t slot = i * max_results + k;
+            rigid_bodies[slot] = m_RigidBodies[m_QueryIds[slot]];
+        }
+    }
+}
+
+void MyPhysicsManager::SweepShapes(const PhysicsShapeSweep* sweeps,
+                                   size_t count, PhysicsQueryHit* hits) {
+    m_SweepQueries.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        auto& query = m_SweepQueries[i];
+        to_world(sweeps[i], query);
+        query.ignored = bodyOf(sweeps[i].ignoredRigidBody);
+        query.direction = sweeps[i].direction;
+        query.maxDistance = sweeps[i].maxDistance;
+    }
+
+    m_QueryHits.resize(count);
+    m_World.SweepShapes(m_SweepQueries.data(), count, m_QueryHits.data());
+    for (size_t i = 0; i < count; i++) fromWorld(m_QueryHits[i], hits[i]);
+}
@@ -1,5 +1,9 @@
 #pragma once
+#include <chrono>
+#include <vector>
+
 #include "PhysicsManager.hpp"
+#include "PhysicsWorld.hpp"
 
 namespace My {
 class MyPhysicsManager : public PhysicsManager {
@@ -21,13 +25,52 @@ class MyPhysicsManager : public PhysicsManager {
     void ClearRigidBodies() final;
 
     Matrix4X4f GetRigidBodyTransform(void* rigidBody) final;
+    // the handles are the body ids of the world
+    PhysicsTransforms GetRigidBodyTransforms() final {
+        return {m_Transforms.data(), m_Transforms.size()};
+    }
     void UpdateRigidBodyTransform(SceneGeometryNode& node) final;
 
     void ApplyCentralForce(void* rigidBody, Vector3f force) final;
 
-    void IterateConvexHull();
+    void SetFixedFrameTime(float frame_time) final {
+        m_fFixedFrameTime = frame_time;
+    }
+    size_t GetContactCount() final { return m_World.GetContactCount(); }
+
+    void CastRays(const PhysicsRay* rays, size_t count,
+                  PhysicsQueryHit* hits) final;
+    void OverlapShapes(const PhysicsQueryShape* shapes, size_t count,
+                       void** rigid_bodies, uint32_t max_results,
+                       uint32_t* result_counts) final;
+    void SweepShapes(const PhysicsShapeSweep* sweeps, size_t count,
+                     PhysicsQueryHit* hits) final;
+
+    PhysicsWorld& GetWorld() { return m_World; }
+
+   private:
+    // static heightfields from the height maps of the scene terrain
+    void createTerrainBodies(SceneObjectTerrain& terrain);
+
+    [[nodiscard]] BodyId bodyOf(void* rigidBody) const;
+    void fromWorld(const QueryHit& hit, PhysicsQueryHit& result) const;
 
    private:
     uint64_t m_nSceneRevision{0};
+    float m_fFixedFrameTime{0.0f};
+
+    PhysicsWorld m_World;
+    // body id -> RigidBody of a scene node or a terrain tile, owned here
+    std::vector<void*> m_RigidBodies;
+    // interpolated transform of each body, by id, as of the last Tick()
+    std::vector<Matrix4X4f> m_Transforms;
+
+    // the queries translated for the world, kept from batch to batch
+    std::vector<RayQuery> m_RayQueries;
+    std::vector<ShapeQuery> m_ShapeQueries;
+    std::vector<SweepQuery> m_SweepQueries;
+    std::vector<QueryHit> m_QueryHits;
+    std::vector<BodyId> m_QueryIds;
+    std::chrono::steady_clock::time_point m_LastTickTime;
 };
 }  // namespace My
\ No newline at end of file
@@ -0,0 +1,1638 @@
+#include "PhysicsWorld.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace My;
+using namespace std;
+
+namespace {
+// contacts closer than this (in the body space of A) to a contact of the
+// previous step take over its impulses
+const float kContactMatchDistance = 0.02f;
+// penetration allowed before the position is corrected, avoids jitter
+const float kPenetrationSlop = 0.005f;
+// fraction of the penetration corrected each step (Baumgarte)
+const float kBaumgarte = 0.2f;
+// relative velocity below which restitution is ignored, lets bodies rest
+const float kRestitutionThreshold = 1.0f;
+// bodies slower than this for kTimeToSleep seconds fall asleep
+const float kSleepLinearVelocity = 0.05f;
+const float kSleepAngularVelocity = 0.05f;
+const float kTimeToSleep = 0.5f;
+// bodies moving more than this fraction of their inner radius in a step get
+// swept against what they may hit
+const float kContinuousMotion = 0.5f;
+// swept bodies stop at most this deep in what they hit, so that the
+// contact is found by the next step
+const float kTimeOfImpactDepth = kPenetrationSlop;
+const uint32_t kMaxTimeOfImpactIterations = 20;
+// impacts handled per swept body and step, the rest of the step is dropped
+const uint32_t kMaxContinuousSubSteps = 4;
+// islands with fewer contacts are solved by a single job
+const uint32_t kMinBatchedManifolds = 32;
+// batches are numbered with the bits of a 64 bit mask, the contacts left
+// over go to one more batch solved sequentially
+const uint32_t kMaxParallelBatches = 64;
+const size_t kManifoldsPerJob = 16;
+const size_t kIslandsPerJob = 4;
+const size_t kBodiesPerJob = 256;
+const size_t kQueriesPerJob = 64;
+// sweeps stop this close to what they hit
+const float kSweepTolerance = 1e-3f;
+const uint32_t kInvalidIndex = numeric_limits<uint32_t>::max();
+
+// quaternions are stored as (x, y, z, w)
+inline Vector3f rotate(const Quaternion<float>& q, const Vector3f& v) {
+    const Vector3f u = {q[0], q[1], q[2]};
+    const Vector3f t = CrossProduct(u, v) * 2.0f;
+    return v + t * q[3] + CrossProduct(u, t);
+}
+
+inline Quaternion<float> normalized(const Quaternion<float>& q) {
+    const float length =
+        sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (length < 1e-12f) return {0.0f, 0.0f, 0.0f, 1.0f};
+    const float inv = 1.0f / length;
+    return {q[0] * inv, q[1] * inv, q[2] * inv, q[3] * inv};
+}
+
+inline Vector3f multiply(const Matrix3X3f& m, const Vector3f& v) {
+    return {m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2],
+            m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2],
+            m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2]};
+}
+
+// transforms use the row vector convention: rows 0 to 2 are the images of
+// the body axes, row 3 the translation
+void decompose(const Matrix4X4f& transform, Vector3f& position,
+               Quaternion<float>& orientation) {
+    position = {transform[3][0], transform[3][1], transform[3][2]};
+
+    // drop the scale
+    float m[3][3];
+    for (int i = 0; i < 3; i++) {
+        Vector3f row = {transform[i][0], transform[i][1], transform[i][2]};
+        const float length = Length(row);
+        if (length > 1e-12f) row = row * (1.0f / length);
+        m[i][0] = row[0];
+        m[i][1] = row[1];
+        m[i][2] = row[2];
+    }
+
+    // m is the transpose of the column vector rotation matrix
+    const float trace = m[0][0] + m[1][1] + m[2][2];
+    Quaternion<float> q;
+    if (trace > 0.0f) {
+        const float s = sqrt(trace + 1.0f) * 2.0f;
+        q = {(m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s,
+             (m[0][1] - m[1][0]) / s, 0.25f * s};
+    } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+        const float s = sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+        q = {0.25f * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s,
+             (m[1][2] - m[2][1]) / s};
+    } else if (m[1][1] > m[2][2]) {
+        const float s = sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+        q = {(m[1][0] + m[0][1]) / s, 0.25f * s, (m[2][1] + m[1][2]) / s,
+             (m[2][0] - m[0][2]) / s};
+    } else {
+        const float s = sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+        q = {(m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25f * s,
+             (m[0][1] - m[1][0]) / s};
+    }
+
+    orientation = normalized(q);
+}
+
+Matrix4X4f compose(const Vector3f& position,
+                   const Quaternion<float>& orientation) {
+    Matrix4X4f transform;
+    MatrixRotationQuaternion(transform, orientation);
+    transform[3][0] = position[0];
+    transform[3][1] = position[1];
+    transform[3][2] = position[2];
+    return transform;
+}
+
+ShapePose make_pose(const Vector3f& position,
+                    const Quaternion<float>& orientation) {
+    ShapePose pose;
+    pose.position = position;
+    pose.axis[0] = rotate(orientation, {1.0f, 0.0f, 0.0f});
+    pose.axis[1] = rotate(orientation, {0.0f, 1.0f, 0.0f});
+    pose.axis[2] = rotate(orientation, {0.0f, 0.0f, 1.0f});
+    return pose;
+}
+
+Matrix3X3f world_inverse_inertia(const Vector3f& local,
+                                 const Quaternion<float>& orientation) {
+    // R * diag(local) * R^T, the columns of R are the rotated body axes
+    const ShapePose pose = make_pose(Vector3f(0.0f), orientation);
+    Matrix3X3f result;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            result[i][j] = local[0] * pose.axis[0][i] * pose.axis[0][j] +
+                           local[1] * pose.axis[1][i] * pose.axis[1][j] +
+                           local[2] * pose.axis[2][i] * pose.axis[2][j];
+        }
+    }
+    return result;
+}
+
+void hull_bounds(const ConvexHullSupport<float>& hull, Vector3f& min,
+                 Vector3f& max) {
+    min = Vector3f(numeric_limits<float>::max());
+    max = Vector3f(numeric_limits<float>::lowest());
+    for (const auto& v : hull.vertices) {
+        for (int k = 0; k < 3; k++) {
+            min[k] = std::min(min[k], v[k]);
+            max[k] = std::max(max[k], v[k]);
+        }
+    }
+}
+
+Vector3f box_inverse_inertia(const Vector3f& size, float mass) {
+    const float xx = size[0] * size[0];
+    const float yy = size[1] * size[1];
+    const float zz = size[2] * size[2];
+    return {12.0f / (mass * (yy + zz)), 12.0f / (mass * (xx + zz)),
+            12.0f / (mass * (xx + yy))};
+}
+
+Vector3f local_inverse_inertia(const CollisionShape& shape, float mass) {
+    if (mass <= 0.0f) return Vector3f(0.0f);
+
+    switch (shape.type) {
+        case GeometryType::kSphere: {
+            const float i = 0.4f * mass * shape.radius * shape.radius;
+            return Vector3f(1.0f / i);
+        }
+        case GeometryType::kBox:
+            return box_inverse_inertia(shape.halfExtents * 2.0f, mass);
+        case GeometryType::kPolyhydron: {
+            // the box around the hull, good enough for a game
+            Vector3f min, max;
+            hull_bounds(*shape.hull, min, max);
+            return box_inverse_inertia(max - min, mass);
+        }
+        default:
+            return Vector3f(0.0f);
+    }
+}
+
+// how far a point of the shape can be from the body origin, to bound the
+// motion of the surface when the body turns (Hitable::GetAngularMotionDisc)
+float angular_motion_disc(const CollisionShape& shape) {
+    switch (shape.type) {
+        case GeometryType::kBox:
+            return Length(shape.halfExtents);
+        case GeometryType::kPolyhydron: {
+            float result = 0.0f;
+            for (const auto& v : shape.hull->vertices) {
+                result = std::max(result, LengthSquared(v));
+            }
+            return sqrt(result);
+        }
+        default:
+            // a sphere turning on itself does not move its surface
+            return 0.0f;
+    }
+}
+
+// radius of a sphere around the body origin inside of the shape, moving
+// further than it in one step could tunnel through thin objects
+float inner_radius(const CollisionShape& shape) {
+    switch (shape.type) {
+        case GeometryType::kSphere:
+            return shape.radius;
+        case GeometryType::kBox:
+            return std::min({shape.halfExtents[0], shape.halfExtents[1],
+                             shape.halfExtents[2]});
+        case GeometryType::kPolyhydron: {
+            const auto& hull = *shape.hull;
+            float result = numeric_limits<float>::max();
+            for (size_t f = 0; f < hull.GetFaceCount(); f++) {
+                const auto& v =
+                    hull.vertices[hull.faceIndices[hull.faceOffsets[f]]];
+                result = std::min(result, DotProduct(hull.faceNormals[f], v));
+            }
+            return std::max(result, 0.0f);
+        }
+        default:
+            return numeric_limits<float>::max();
+    }
+}
+
+// orientation after turning at angular_velocity for time seconds
+Quaternion<float> rotated(const Quaternion<float>& q,
+                          const Vector3f& angular_velocity, float time) {
+    const float speed = Length(angular_velocity);
+    if (speed * time < 1e-6f) return q;
+
+    const float half_angle = 0.5f * speed * time;
+    const Vector3f axis = angular_velocity * (sin(half_angle) / speed);
+    const float w = cos(half_angle);
+
+    // (axis, w) * q
+    const Vector3f u = {q[0], q[1], q[2]};
+    const Vector3f v = u * w + axis * q[3] + CrossProduct(axis, u);
+    return normalized({v[0], v[1], v[2], w * q[3] - DotProduct(axis, u)});
+}
+
+// world space bounds of a shape, which can not be a plane
+void shape_bounds(const CollisionShape& shape, const ShapePose& pose,
+                  Vector3f& min, Vector3f& max) {
+    Vector3f center = pose.position;
+    Vector3f extent;
+    switch (shape.type) {
+        case GeometryType::kSphere:
+            extent = Vector3f(shape.radius);
+            break;
+        case GeometryType::kBox: {
+            const auto& h = shape.halfExtents;
+            for (int k = 0; k < 3; k++) {
+                extent[k] = fabs(pose.axis[0][k]) * h[0] +
+                            fabs(pose.axis[1][k]) * h[1] +
+                            fabs(pose.axis[2][k]) * h[2];
+            }
+        } break;
+        case GeometryType::kPolyhydron: {
+            const ConvexInstance hull(*shape.hull, pose.position, pose.axis);
+            // the hull is not centered on the origin of the body
+            for (int k = 0; k < 3; k++) {
+                Vector3f direction(0.0f);
+                direction[k] = 1.0f;
+                max[k] = hull.Support(direction)[k];
+                direction[k] = -1.0f;
+                min[k] = hull.Support(direction)[k];
+            }
+            extent = (max - min) * 0.5f;
+            center = (max + min) * 0.5f;
+        } break;
+        case GeometryType::kHeightfield: {
+            // the box around the surface, placed like a box shape
+            Vector3f local_min, local_max;
+            shape.heightfield->GetBounds(local_min, local_max);
+            const Vector3f h = (local_max - local_min) * 0.5f;
+            const Vector3f c = (local_max + local_min) * 0.5f;
+            center = pose.position + pose.axis[0] * c[0] +
+                     pose.axis[1] * c[1] + pose.axis[2] * c[2];
+            for (int k = 0; k < 3; k++) {
+                extent[k] = fabs(pose.axis[0][k]) * h[0] +
+                            fabs(pose.axis[1][k]) * h[1] +
+                            fabs(pose.axis[2][k]) * h[2];
+            }
+        } break;
+        default:
+            assert(0);
+    }
+
+    min = center - extent;
+    max = center + extent;
+}
+
+// candidates of the queries, one list per thread kept from batch to batch
+vector<BodyId>& query_candidates() {
+    thread_local vector<BodyId> candidates;
+    return candidates;
+}
+
+inline uint64_t pair_key(BodyId a, BodyId b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+template <class T>
+inline void move_last_to(vector<T>& array, uint32_t index) {
+    array[index] = array.back();
+    array.pop_back();
+}
+
+unique_ptr<Broadphase> create_broadphase(BroadphaseType type) {
+    switch (type) {
+        case BroadphaseType::kBruteForce:
+            return make_unique<BruteForceBroadphase>();
+        case BroadphaseType::kSweepAndPrune:
+            return make_unique<SweepAndPrune>();
+        default:
+            return make_unique<AabbTreeBroadphase>();
+    }
+}
+}  // namespace
+
+PhysicsWorld::PhysicsWorld()
+    : m_pBroadphase(create_broadphase(m_BroadphaseType)) {}
+
+void PhysicsWorld::SetBroadphaseType(BroadphaseType type) {
+    m_BroadphaseType = type;
+    m_pBroadphase = create_broadphase(type);
+
+    for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+        if (m_Bodies.shape[i].type == GeometryType::kPlane) continue;
+        m_pBroadphase->Add(m_Bodies.id[i], m_Bodies.aabbMin[i],
+                           m_Bodies.aabbMax[i],
+                           m_Bodies.inverseMass[i] == 0.0f);
+    }
+}
+
+BodyId PhysicsWorld::CreateBody(const CollisionShape& shape, float mass,
+                                const Matrix4X4f& transform, float friction,
+                                float restitution) {
+    assert(shape.type != GeometryType::kPolyhydron || shape.hull);
+    assert(shape.type != GeometryType::kHeightfield ||
+           (shape.heightfield && mass <= 0.0f));
+
+    BodyId id;
+    if (!m_FreeIds.empty()) {
+        id = m_FreeIds.back();
+        m_FreeIds.pop_back();
+    } else {
+        id = static_cast<BodyId>(m_IdToIndex.size());
+        m_IdToIndex.push_back(0);
+    }
+
+    m_IdToIndex[id] = static_cast<uint32_t>(m_Bodies.size());
+
+    Vector3f position;
+    Quaternion<float> orientation;
+    decompose(transform, position, orientation);
+
+    const Vector3f inverse_inertia = local_inverse_inertia(shape, mass);
+
+    m_Bodies.id.push_back(id);
+    m_Bodies.shape.push_back(shape);
+    m_Bodies.position.push_back(position);
+    m_Bodies.orientation.push_back(orientation);
+    m_Bodies.linearVelocity.emplace_back(0.0f);
+    m_Bodies.angularVelocity.emplace_back(0.0f);
+    m_Bodies.force.emplace_back(0.0f);
+    m_Bodies.torque.emplace_back(0.0f);
+    m_Bodies.inverseMass.push_back((mass > 0.0f) ? 1.0f / mass : 0.0f);
+    m_Bodies.inverseInertiaLocal.push_back(inverse_inertia);
+    m_Bodies.inverseInertiaWorld.push_back(
+        world_inverse_inertia(inverse_inertia, orientation));
+    m_Bodies.friction.push_back(friction);
+    m_Bodies.restitution.push_back(restitution);
+    m_Bodies.previousPosition.push_back(position);
+    m_Bodies.previousOrientation.push_back(orientation);
+    m_Bodies.aabbMin.emplace_back(0.0f);
+    m_Bodies.aabbMax.emplace_back(0.0f);
+    m_Bodies.awake.push_back(1);
+    m_Bodies.sleepTime.push_back(0.0f);
+
+    if (shape.type == GeometryType::kPlane) {
+        m_Planes.push_back(id);
+    } else {
+        const uint32_t index = m_IdToIndex[id];
+        computeBounds(index, 0.0f);
+        m_pBroadphase->Add(id, m_Bodies.aabbMin[index],
+                           m_Bodies.aabbMax[index], mass <= 0.0f);
+    }
+
+    return id;
+}
+
+void PhysicsWorld::DestroyBody(BodyId id) {
+    const uint32_t index = indexOf(id);
+
+    if (m_Bodies.shape[index].type == GeometryType::kPlane) {
+        m_Planes.erase(find(m_Planes.begin(), m_Planes.end(), id));
+    } else {
+        m_pBroadphase->Remove(id);
+    }
+
+    const BodyId moved = m_Bodies.id.back();
+    m_IdToIndex[moved] = index;
+    m_IdToIndex[id] = kInvalidBodyId;
+    m_FreeIds.push_back(id);
+
+    move_last_to(m_Bodies.id, index);
+    move_last_to(m_Bodies.shape, index);
+    move_last_to(m_Bodies.position, index);
+    move_last_to(m_Bodies.orientation, index);
+    move_last_to(m_Bodies.linearVelocity, index);
+    move_last_to(m_Bodies.angularVelocity, index);
+    move_last_to(m_Bodies.force, index);
+    move_last_to(m_Bodies.torque, index);
+    move_last_to(m_Bodies.inverseMass, index);
+    move_last_to(m_Bodies.inverseInertiaLocal, index);
+    move_last_to(m_Bodies.inverseInertiaWorld, index);
+    move_last_to(m_Bodies.friction, index);
+    move_last_to(m_Bodies.restitution, index);
+    move_last_to(m_Bodies.previousPosition, index);
+    move_last_to(m_Bodies.previousOrientation, index);
+    move_last_to(m_Bodies.aabbMin, index);
+    move_last_to(m_Bodies.aabbMax, index);
+    move_last_to(m_Bodies.awake, index);
+    move_last_to(m_Bodies.sleepTime, index);
+
+    // whatever rested on the body has to fall
+    wakeContacts(id);
+
+    // the id could be given to a new body, which must not inherit the
+    // contacts of this one. Body indices of the manifolds are refreshed by
+    // the next step anyway.
+    m_Manifolds.erase(
+        remove_if(m_Manifolds.begin(), m_Manifolds.end(),
+                  [id](const ContactManifold& manifold) {
+                      return manifold.idA == id || manifold.idB == id;
+                  }),
+        m_Manifolds.end());
+}
+
+void PhysicsWorld::Clear() {
+    m_Bodies = RigidBodyArrays();
+    m_IdToIndex.clear();
+    m_FreeIds.clear();
+    m_pBroadphase->Clear();
+    m_Planes.clear();
+    m_BodyPairs.clear();
+    m_Pairs.clear();
+    m_Manifolds.clear();
+    m_PreviousManifolds.clear();
+    m_ManifoldLookup.clear();
+    m_Islands.clear();
+    m_Batches.clear();
+    m_IslandBodies.clear();
+    m_IslandManifolds.clear();
+    m_fAccumulator = 0.0f;
+}
+
+void PhysicsWorld::SetSleepingEnabled(bool enabled) {
+    m_bSleepingEnabled = enabled;
+    if (!enabled) {
+        for (uint32_t i = 0; i < m_Bodies.size(); i++) wake(i);
+    }
+}
+
+bool PhysicsWorld::IsAwake(BodyId id) const {
+    return m_Bodies.awake[indexOf(id)] != 0;
+}
+
+void PhysicsWorld::WakeUp(BodyId id) { wake(indexOf(id)); }
+
+void PhysicsWorld::wake(uint32_t index) {
+    m_Bodies.awake[index] = 1;
+    m_Bodies.sleepTime[index] = 0.0f;
+}
+
+void PhysicsWorld::wakeContacts(BodyId id) {
+    for (const auto& manifold : m_Manifolds) {
+        if (manifold.idA == id) {
+            wake(indexOf(manifold.idB));
+        } else if (manifold.idB == id) {
+            wake(indexOf(manifold.idA));
+        }
+    }
+}
+
+size_t PhysicsWorld::GetContactCount() const {
+    size_t count = 0;
+    for (const auto& manifold : m_Manifolds) {
+        count += manifold.pointCount;
+    }
+    return count;
+}
+
+uint32_t PhysicsWorld::indexOf(BodyId id) const {
+    assert(id < m_IdToIndex.size());
+    const uint32_t index = m_IdToIndex[id];
+    assert(index < m_Bodies.size());
+    return index;
+}
+
+void PhysicsWorld::SetTransform(BodyId id, const Matrix4X4f& transform) {
+    const uint32_t i = indexOf(id);
+    decompose(transform, m_Bodies.position[i], m_Bodies.orientation[i]);
+    m_Bodies.previousPosition[i] = m_Bodies.position[i];
+    m_Bodies.previousOrientation[i] = m_Bodies.orientation[i];
+    m_Bodies.inverseInertiaWorld[i] = world_inverse_inertia(
+        m_Bodies.inverseInertiaLocal[i], m_Bodies.orientation[i]);
+    wake(i);
+    wakeContacts(id);
+
+    if (m_Bodies.shape[i].type != GeometryType::kPlane) {
+        computeBounds(i, 0.0f);
+        m_pBroadphase->Move(id, m_Bodies.aabbMin[i], m_Bodies.aabbMax[i],
+                            Vector3f(0.0f));
+    }
+}
+
+Matrix4X4f PhysicsWorld::GetTransform(BodyId id) const {
+    const uint32_t i = indexOf(id);
+    return compose(m_Bodies.position[i], m_Bodies.orientation[i]);
+}
+
+Matrix4X4f PhysicsWorld::GetInterpolatedTransform(BodyId id) const {
+    return interpolatedTransform(indexOf(id), GetInterpolationFactor());
+}
+
+void PhysicsWorld::GetInterpolatedTransforms(
+    std::vector<Matrix4X4f>& transforms) const {
+    if (transforms.size() < m_IdToIndex.size()) {
+        transforms.resize(m_IdToIndex.size());
+    }
+    const float alpha = GetInterpolationFactor();
+    for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+        transforms[m_Bodies.id[i]] = interpolatedTransform(i, alpha);
+    }
+}
+
+Matrix4X4f PhysicsWorld::interpolatedTransform(uint32_t i,
+                                               float alpha) const {
+    const Vector3f& p0 = m_Bodies.previousPosition[i];
+    const Vector3f& p1 = m_Bodies.position[i];
+    const Vector3f position = p0 + (p1 - p0) * alpha;
+
+    // nlerp along the shortest arc
+    const Quaternion<float>& q0 = m_Bodies.previousOrientation[i];
+    Quaternion<float> q1 = m_Bodies.orientation[i];
+    if (q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3] <
+        0.0f) {
+        q1 = {-q1[0], -q1[1], -q1[2], -q1[3]};
+    }
+    const Quaternion<float> orientation = normalized(
+        {q0[0] + (q1[0] - q0[0]) * alpha, q0[1] + (q1[1] - q0[1]) * alpha,
+         q0[2] + (q1[2] - q0[2]) * alpha, q0[3] + (q1[3] - q0[3]) * alpha});
+
+    return compose(position, orientation);
+}
+
+void PhysicsWorld::SetLinearVelocity(BodyId id, const Vector3f& velocity) {
+    const uint32_t i = indexOf(id);
+    m_Bodies.linearVelocity[i] = velocity;
+    wake(i);
+}
+
+Vector3f PhysicsWorld::GetLinearVelocity(BodyId id) const {
+    return m_Bodies.linearVelocity[indexOf(id)];
+}
+
+void PhysicsWorld::SetAngularVelocity(BodyId id, const Vector3f& velocity) {
+    const uint32_t i = indexOf(id);
+    m_Bodies.angularVelocity[i] = velocity;
+    wake(i);
+}
+
+Vector3f PhysicsWorld::GetAngularVelocity(BodyId id) const {
+    return m_Bodies.angularVelocity[indexOf(id)];
+}
+
+void PhysicsWorld::ApplyCentralForce(BodyId id, const Vector3f& force) {
+    const uint32_t i = indexOf(id);
+    auto& accumulated = m_Bodies.force[i];
+    accumulated = accumulated + force;
+    wake(i);
+}
+
+void PhysicsWorld::ApplyTorque(BodyId id, const Vector3f& torque) {
+    const uint32_t i = indexOf(id);
+    auto& accumulated = m_Bodies.torque[i];
+    accumulated = accumulated + torque;
+    wake(i);
+}
+
+uint32_t PhysicsWorld::Simulate(float elapsed_time) {
+    m_fAccumulator += elapsed_time;
+
+    uint32_t steps = 0;
+    while (m_fAccumulator >= m_fFixedTimeStep && steps < m_nMaxSubSteps) {
+        Step(m_fFixedTimeStep);
+        m_fAccumulator -= m_fFixedTimeStep;
+        steps++;
+    }
+
+    // too far behind, drop the time we could not simulate rather than
+    // spiraling down with more and more steps per call
+    if (m_fAccumulator >= m_fFixedTimeStep) {
+        m_fAccumulator = fmod(m_fAccumulator, m_fFixedTimeStep);
+    }
+
+    if (steps) {
+        fill(m_Bodies.force.begin(), m_Bodies.force.end(), Vector3f(0.0f));
+        fill(m_Bodies.torque.begin(), m_Bodies.torque.end(), Vector3f(0.0f));
+    }
+
+    return steps;
+}
+
+void PhysicsWorld::Step(float time_step) {
+    m_Bodies.previousPosition = m_Bodies.position;
+    m_Bodies.previousOrientation = m_Bodies.orientation;
+
+    collide(time_step);
+    buildIslands();
+    integrateVelocities(time_step);
+    solveIslands(time_step);
+    integratePositions(time_step);
+    solveContinuous(time_step);
+    updateSleep();
+
+    m_bQueryBoundsValid = false;
+}
+
+// Bounds over the coming step, extended by the motion at the current
+// velocities the same way as Hitable::CalculateTemporalAabb.
+void PhysicsWorld::computeBounds(uint32_t i, float time_step) {
+    const auto& shape = m_Bodies.shape[i];
+    const auto pose = make_pose(m_Bodies.position[i], m_Bodies.orientation[i]);
+    Vector3f min, max;
+    shape_bounds(shape, pose, min, max);
+
+    if (time_step > 0.0f && m_Bodies.inverseMass[i] != 0.0f) {
+        const float motion_disc = angular_motion_disc(shape);
+        const Vector3f motion = m_Bodies.linearVelocity[i] * time_step;
+        for (int k = 0; k < 3; k++) {
+            if (motion[k] > 0.0f) {
+                max[k] += motion[k];
+            } else {
+                min[k] += motion[k];
+            }
+        }
+
+        const Vector3f angular_motion(Length(m_Bodies.angularVelocity[i]) *
+                                      motion_disc * time_step);
+        min = min - angular_motion;
+        max = max + angular_motion;
+    }
+
+    m_Bodies.aabbMin[i] = min;
+    m_Bodies.aabbMax[i] = max;
+}
+
+void PhysicsWorld::updateBounds(float time_step) {
+    for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+        // static bodies only move with SetTransform(), sleeping ones not at
+        // all
+        if (m_Bodies.inverseMass[i] == 0.0f || !m_Bodies.awake[i]) continue;
+
+        computeBounds(i, time_step);
+        m_pBroadphase->Move(m_Bodies.id[i], m_Bodies.aabbMin[i],
+                            m_Bodies.aabbMax[i],
+                            m_Bodies.linearVelocity[i] * time_step);
+    }
+}
+
+void PhysicsWorld::findPairs() {
+    m_pBroadphase->GetPairs(m_BodyPairs);
+
+    // planes against the moving bodies on their back side
+    for (const BodyId plane : m_Planes) {
+        const uint32_t p = indexOf(plane);
+        const auto pose =
+            make_pose(m_Bodies.position[p], m_Bodies.orientation[p]);
+        const auto& shape = m_Bodies.shape[p];
+        const Vector3f normal = pose.axis[0] * shape.normal[0] +
+                                pose.axis[1] * shape.normal[1] +
+                                pose.axis[2] * shape.normal[2];
+        const float intercept =
+            DotProduct(normal, pose.position) + shape.intercept;
+
+        for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+            if (m_Bodies.inverseMass[i] == 0.0f) continue;
+
+            const auto& min_i = m_Bodies.aabbMin[i];
+            const auto& max_i = m_Bodies.aabbMax[i];
+            const Vector3f center = (min_i + max_i) * 0.5f;
+            const Vector3f extent = (max_i - min_i) * 0.5f;
+            const float radius = fabs(normal[0]) * extent[0] +
+                                 fabs(normal[1]) * extent[1] +
+                                 fabs(normal[2]) * extent[2];
+            if (DotProduct(normal, center) - intercept > radius) continue;
+
+            const BodyId id = m_Bodies.id[i];
+            m_BodyPairs.emplace_back(min(plane, id), max(plane, id));
+        }
+    }
+
+    sort(m_BodyPairs.begin(), m_BodyPairs.end());
+
+    m_Pairs.clear();
+    m_Pairs.reserve(m_BodyPairs.size());
+    for (const auto& [a, b] : m_BodyPairs) {
+        m_Pairs.emplace_back(indexOf(a), indexOf(b));
+    }
+}
+
+void PhysicsWorld::collide(float time_step) {
+    updateBounds(time_step);
+    findPairs();
+
+    // keep the manifolds of the previous step for warm starting
+    m_PreviousManifolds.swap(m_Manifolds);
+    m_Manifolds.clear();
+    m_ManifoldLookup.clear();
+    for (uint32_t i = 0; i < m_PreviousManifolds.size(); i++) {
+        const auto& manifold = m_PreviousManifolds[i];
+        m_ManifoldLookup.emplace(pair_key(manifold.idA, manifold.idB), i);
+    }
+
+    for (auto [a, b] : m_Pairs) {
+        // order by id so that the pair is found again after bodies moved in
+        // the arrays
+        if (m_Bodies.id[a] > m_Bodies.id[b]) swap(a, b);
+
+        // nothing moved since the last step, keep the contact as it was so
+        // that the island stays in one piece
+        const bool moving_a =
+            m_Bodies.inverseMass[a] != 0.0f && m_Bodies.awake[a];
+        const bool moving_b =
+            m_Bodies.inverseMass[b] != 0.0f && m_Bodies.awake[b];
+        if (!moving_a && !moving_b) {
+            auto it = m_ManifoldLookup.find(
+                pair_key(m_Bodies.id[a], m_Bodies.id[b]));
+            if (it != m_ManifoldLookup.end()) {
+                m_Manifolds.push_back(m_PreviousManifolds[it->second]);
+                m_Manifolds.back().a = a;
+                m_Manifolds.back().b = b;
+            }
+            continue;
+        }
+
+        const ShapePose pose_a =
+            make_pose(m_Bodies.position[a], m_Bodies.orientation[a]);
+        const ShapePose pose_b =
+            make_pose(m_Bodies.position[b], m_Bodies.orientation[b]);
+
+        CollisionResult result;
+        if (!Collide(m_Bodies.shape[a], pose_a, m_Bodies.shape[b], pose_b,
+                     result)) {
+            continue;
+        }
+
+        ContactManifold manifold;
+        manifold.a = a;
+        manifold.b = b;
+        manifold.idA = m_Bodies.id[a];
+        manifold.idB = m_Bodies.id[b];
+        manifold.normal = result.normal;
+        manifold.friction =
+            sqrt(m_Bodies.friction[a] * m_Bodies.friction[b]);
+        manifold.restitution =
+            max(m_Bodies.restitution[a], m_Bodies.restitution[b]);
+        manifold.pointCount = result.pointCount;
+
+        // tangent basis
+        const auto& n = manifold.normal;
+        if (fabs(n[0]) >= 0.57735f) {
+            manifold.tangent[0] = {n[1], -n[0], 0.0f};
+        } else {
+            manifold.tangent[0] = {0.0f, n[2], -n[1]};
+        }
+        Normalize(manifold.tangent[0]);
+        manifold.tangent[1] = CrossProduct(n, manifold.tangent[0]);
+
+        const ContactManifold* previous = nullptr;
+        auto it = m_ManifoldLookup.find(pair_key(manifold.idA, manifold.idB));
+        if (it != m_ManifoldLookup.end()) {
+            previous = &m_PreviousManifolds[it->second];
+        }
+
+        for (uint32_t k = 0; k < result.pointCount; k++) {
+            auto& point = manifold.points[k];
+            const Vector3f d = result.points[k] - pose_a.position;
+            point.localAnchor = {DotProduct(d, pose_a.axis[0]),
+                                 DotProduct(d, pose_a.axis[1]),
+                                 DotProduct(d, pose_a.axis[2])};
+            point.rA = d;
+            point.rB = result.points[k] - pose_b.position;
+            point.depth = result.depths[k];
+            point.normalImpulse = 0.0f;
+            point.tangentImpulse[0] = 0.0f;
+            point.tangentImpulse[1] = 0.0f;
+
+            if (!previous) continue;
+
+            for (uint32_t l = 0; l < previous->pointCount; l++) {
+                const auto& old = previous->points[l];
+                if (LengthSquared(old.localAnchor - point.localAnchor) <
+                    kContactMatchDistance * kContactMatchDistance) {
+                    point.normalImpulse = old.normalImpulse;
+                    // the tangent basis may have rotated, keep the friction
+                    // impulse in world space
+                    const Vector3f friction =
+                        previous->tangent[0] * old.tangentImpulse[0] +
+                        previous->tangent[1] * old.tangentImpulse[1];
+                    point.tangentImpulse[0] =
+                        DotProduct(friction, manifold.tangent[0]);
+                    point.tangentImpulse[1] =
+                        DotProduct(friction, manifold.tangent[1]);
+                    break;
+                }
+            }
+        }
+
+        m_Manifolds.push_back(manifold);
+    }
+}
+
+// Union-find over the contacts between moving bodies. Islands are numbered
+// in the order of their first body and keep the order of the manifolds, so
+// that they do not depend on how they are spread over the threads later.
+void PhysicsWorld::buildIslands() {
+    const auto body_count = static_cast<uint32_t>(m_Bodies.size());
+
+    auto& parent = m_IslandParent;
+    parent.resize(body_count);
+    iota(parent.begin(), parent.end(), 0u);
+    auto find_root = [&parent](uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    for (const auto& manifold : m_Manifolds) {
+        if (m_Bodies.inverseMass[manifold.a] == 0.0f ||
+            m_Bodies.inverseMass[manifold.b] == 0.0f) {
+            continue;
+        }
+        const uint32_t root_a = find_root(manifold.a);
+        const uint32_t root_b = find_root(manifold.b);
+        if (root_a != root_b) parent[max(root_a, root_b)] = min(root_a, root_b);
+    }
+
+    m_Islands.clear();
+    m_BodyIsland.assign(body_count, kInvalidIndex);
+    for (uint32_t i = 0; i < body_count; i++) {
+        if (m_Bodies.inverseMass[i] == 0.0f) continue;
+        const uint32_t root = find_root(i);
+        if (m_BodyIsland[root] == kInvalidIndex) {
+            m_BodyIsland[root] = static_cast<uint32_t>(m_Islands.size());
+            m_Islands.push_back({0, 0, 0, 0, false});
+        }
+        const uint32_t island = m_BodyIsland[root];
+        m_BodyIsland[i] = island;
+        m_Islands[island].bodyEnd++;
+        m_Islands[island].awake |= m_Bodies.awake[i] != 0;
+    }
+
+    // bodies grouped by island
+    uint32_t offset = 0;
+    for (auto& island : m_Islands) {
+        island.bodyBegin = offset;
+        offset += island.bodyEnd;
+        island.bodyEnd = island.bodyBegin;
+    }
+    m_IslandBodies.resize(offset);
+    for (uint32_t i = 0; i < body_count; i++) {
+        if (m_BodyIsland[i] == kInvalidIndex) continue;
+        auto& island = m_Islands[m_BodyIsland[i]];
+        m_IslandBodies[island.bodyEnd++] = i;
+    }
+
+    // manifolds grouped by island, counted in m_Scratch
+    auto& manifold_counts = m_Scratch;
+    manifold_counts.assign(m_Islands.size() + 1, 0);
+    for (const auto& manifold : m_Manifolds) {
+        const uint32_t body = (m_Bodies.inverseMass[manifold.a] != 0.0f)
+                                  ? manifold.a
+                                  : manifold.b;
+        manifold_counts[m_BodyIsland[body] + 1]++;
+    }
+    partial_sum(manifold_counts.begin(), manifold_counts.end(),
+                manifold_counts.begin());
+    m_IslandManifolds.resize(m_Manifolds.size());
+    for (uint32_t k = 0; k < m_Manifolds.size(); k++) {
+        const auto& manifold = m_Manifolds[k];
+        const uint32_t body = (m_Bodies.inverseMass[manifold.a] != 0.0f)
+                                  ? manifold.a
+                                  : manifold.b;
+        m_IslandManifolds[manifold_counts[m_BodyIsland[body]]++] = k;
+    }
+
+    // a moving body touching a sleeping one wakes the whole island up
+    const bool batched =
+        m_bDeterministic || (m_pJobSystem && m_pJobSystem->GetWorkerCount());
+    m_Batches.clear();
+    m_BodyBatches.resize(body_count);
+    uint32_t begin = 0;
+    for (uint32_t n = 0; n < m_Islands.size(); n++) {
+        auto& island = m_Islands[n];
+        // the counts were turned into the end of each island
+        const uint32_t end = manifold_counts[n];
+
+        if (!m_bSleepingEnabled) island.awake = true;
+        if (island.awake) {
+            for (uint32_t k = island.bodyBegin; k < island.bodyEnd; k++) {
+                m_Bodies.awake[m_IslandBodies[k]] = 1;
+            }
+        }
+
+        island.batchBegin = static_cast<uint32_t>(m_Batches.size());
+        if (island.awake && batched && end - begin >= kMinBatchedManifolds) {
+            batchContacts(island, begin, end);
+        } else if (end > begin) {
+            m_Batches.push_back({begin, end, false});
+        }
+        island.batchEnd = static_cast<uint32_t>(m_Batches.size());
+        begin = end;
+    }
+}
+
+// Greedy coloring: each manifold goes to the first batch where none of its
+// moving bodies is yet. Static bodies are only read by the solver and can be
+// shared.
+void PhysicsWorld::batchContacts(const Island& island, uint32_t begin,
+                                 uint32_t end) {
+    for (uint32_t k = island.bodyBegin; k < island.bodyEnd; k++) {
+        m_BodyBatches[m_IslandBodies[k]] = 0;
+    }
+
+    uint32_t starts[kMaxParallelBatches + 1] = {};
+    m_ManifoldBatches.resize(end - begin);
+    for (uint32_t k = begin; k < end; k++) {
+        const auto& manifold = m_Manifolds[m_IslandManifolds[k]];
+        const bool moving_a = m_Bodies.inverseMass[manifold.a] != 0.0f;
+        const bool moving_b = m_Bodies.inverseMass[manifold.b] != 0.0f;
+        uint64_t used = 0;
+        if (moving_a) used |= m_BodyBatches[manifold.a];
+        if (moving_b) used |= m_BodyBatches[manifold.b];
+
+        uint32_t batch = kMaxParallelBatches;
+        if (~used) {
+            batch = static_cast<uint32_t>(countr_zero(~used));
+            const uint64_t bit = uint64_t(1) << batch;
+            if (moving_a) m_BodyBatches[manifold.a] |= bit;
+            if (moving_b) m_BodyBatches[manifold.b] |= bit;
+        }
+        m_ManifoldBatches[k - begin] = batch;
+        starts[batch]++;
+    }
+
+    uint32_t offset = begin;
+    for (uint32_t batch = 0; batch <= kMaxParallelBatches; batch++) {
+        const uint32_t size = starts[batch];
+        starts[batch] = offset;
+        if (!size) continue;
+        m_Batches.push_back(
+            {offset, offset + size, batch < kMaxParallelBatches});
+        offset += size;
+    }
+
+    // stable counting sort of the manifolds by batch
+    m_SortedManifolds.resize(end - begin);
+    for (uint32_t k = begin; k < end; k++) {
+        m_SortedManifolds[starts[m_ManifoldBatches[k - begin]]++ - begin] =
+            m_IslandManifolds[k];
+    }
+    copy(m_SortedManifolds.begin(), m_SortedManifolds.end(),
+         m_IslandManifolds.begin() + begin);
+}
+
+void PhysicsWorld::parallelFor(size_t count, size_t grain_size,
+                               const JobSystem::RangeFunction& function) {
+    if (m_pJobSystem) {
+        m_pJobSystem->ParallelFor(0, count, grain_size, function);
+    } else if (count) {
+        function(0, count);
+    }
+}
+
+void PhysicsWorld::integrateVelocities(float time_step) {
+    parallelFor(m_Bodies.size(), kBodiesPerJob, [&](size_t begin,
+                                                    size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const float inverse_mass = m_Bodies.inverseMass[i];
+            if (inverse_mass == 0.0f || !m_Bodies.awake[i]) continue;
+
+            auto& v = m_Bodies.linearVelocity[i];
+            v = v + (m_Gravity + m_Bodies.force[i] * inverse_mass) * time_step;
+
+            auto& w = m_Bodies.angularVelocity[i];
+            w = w +
+                multiply(m_Bodies.inverseInertiaWorld[i], m_Bodies.torque[i]) *
+                    time_step;
+        }
+    });
+}
+
+// Islands share no moving body and are solved in parallel. Batched islands
+// are solved one at a time, their batches spread over the jobs.
+void PhysicsWorld::solveIslands(float time_step) {
+    const float inverse_time_step = 1.0f / time_step;
+
+    auto& small_islands = m_Scratch;
+    small_islands.clear();
+    for (uint32_t n = 0; n < m_Islands.size(); n++) {
+        const auto& island = m_Islands[n];
+        if (!island.awake || island.batchBegin == island.batchEnd) continue;
+
+        if (m_Batches[island.batchBegin].parallel) {
+            solveIsland(island, inverse_time_step);
+        } else {
+            small_islands.push_back(n);
+        }
+    }
+
+    parallelFor(small_islands.size(), kIslandsPerJob,
+                [&](size_t begin, size_t end) {
+                    for (size_t n = begin; n < end; n++) {
+                        solveIsland(m_Islands[small_islands[n]],
+                                    inverse_time_step);
+                    }
+                });
+}
+
+void PhysicsWorld::solveIsland(const Island& island,
+                               float inverse_time_step) {
+    auto for_each_manifold = [&](auto&& function) {
+        for (uint32_t n = island.batchBegin; n < island.batchEnd; n++) {
+            const auto& batch = m_Batches[n];
+            auto solve_range = [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; k++) {
+                    function(m_Manifolds[m_IslandManifolds[k]]);
+                }
+            };
+
+            if (batch.parallel && m_pJobSystem) {
+                m_pJobSystem->ParallelFor(batch.begin, batch.end,
+                                          kManifoldsPerJob, solve_range);
+            } else {
+                solve_range(batch.begin, batch.end);
+            }
+        }
+    };
+
+    for_each_manifold([&](ContactManifold& manifold) {
+        prepareContact(manifold, inverse_time_step);
+    });
+    for_each_manifold(
+        [&](const ContactManifold& manifold) { warmStart(manifold); });
+    for (uint32_t i = 0; i < m_nSolverIterations; i++) {
+        for_each_manifold(
+            [&](ContactManifold& manifold) { solveContact(manifold); });
+    }
+}
+
+void PhysicsWorld::prepareContact(ContactManifold& manifold,
+                                  float inverse_time_step) {
+    const uint32_t a = manifold.a;
+    const uint32_t b = manifold.b;
+    const float inverse_mass_a = m_Bodies.inverseMass[a];
+    const float inverse_mass_b = m_Bodies.inverseMass[b];
+    const auto& inverse_inertia_a = m_Bodies.inverseInertiaWorld[a];
+    const auto& inverse_inertia_b = m_Bodies.inverseInertiaWorld[b];
+
+    auto effective_mass = [&](const ContactPoint& point,
+                              const Vector3f& direction) {
+        const Vector3f ra_x_d = CrossProduct(point.rA, direction);
+        const Vector3f rb_x_d = CrossProduct(point.rB, direction);
+        const float k =
+            inverse_mass_a + inverse_mass_b +
+            DotProduct(ra_x_d, multiply(inverse_inertia_a, ra_x_d)) +
+            DotProduct(rb_x_d, multiply(inverse_inertia_b, rb_x_d));
+        return (k > 0.0f) ? 1.0f / k : 0.0f;
+    };
+
+    for (uint32_t k = 0; k < manifold.pointCount; k++) {
+        auto& point = manifold.points[k];
+        point.normalMass = effective_mass(point, manifold.normal);
+        point.tangentMass[0] = effective_mass(point, manifold.tangent[0]);
+        point.tangentMass[1] = effective_mass(point, manifold.tangent[1]);
+
+        const Vector3f relative_velocity =
+            m_Bodies.linearVelocity[b] +
+            CrossProduct(m_Bodies.angularVelocity[b], point.rB) -
+            m_Bodies.linearVelocity[a] -
+            CrossProduct(m_Bodies.angularVelocity[a], point.rA);
+        const float normal_velocity =
+            DotProduct(relative_velocity, manifold.normal);
+
+        point.bias = kBaumgarte * inverse_time_step *
+                     max(point.depth - kPenetrationSlop, 0.0f);
+        if (normal_velocity < -kRestitutionThreshold) {
+            point.bias =
+                max(point.bias, -manifold.restitution * normal_velocity);
+        }
+    }
+}
+
+// static bodies are left alone, they may be shared by the manifolds solved
+// at the same time
+void PhysicsWorld::warmStart(const ContactManifold& manifold) {
+    const uint32_t a = manifold.a;
+    const uint32_t b = manifold.b;
+    const bool moving_a = m_Bodies.inverseMass[a] != 0.0f;
+    const bool moving_b = m_Bodies.inverseMass[b] != 0.0f;
+
+    for (uint32_t k = 0; k < manifold.pointCount; k++) {
+        const auto& point = manifold.points[k];
+        const Vector3f impulse = manifold.normal * point.normalImpulse +
+                                 manifold.tangent[0] * point.tangentImpulse[0] +
+                                 manifold.tangent[1] * point.tangentImpulse[1];
+
+        if (moving_a) {
+            m_Bodies.linearVelocity[a] =
+                m_Bodies.linearVelocity[a] - impulse * m_Bodies.inverseMass[a];
+            m_Bodies.angularVelocity[a] =
+                m_Bodies.angularVelocity[a] -
+                multiply(m_Bodies.inverseInertiaWorld[a],
+                         CrossProduct(point.rA, impulse));
+        }
+        if (moving_b) {
+            m_Bodies.linearVelocity[b] =
+                m_Bodies.linearVelocity[b] + impulse * m_Bodies.inverseMass[b];
+            m_Bodies.angularVelocity[b] =
+                m_Bodies.angularVelocity[b] +
+                multiply(m_Bodies.inverseInertiaWorld[b],
+                         CrossProduct(point.rB, impulse));
+        }
+    }
+}
+
+void PhysicsWorld::solveContact(ContactManifold& manifold) {
+    const uint32_t a = manifold.a;
+    const uint32_t b = manifold.b;
+    const float inverse_mass_a = m_Bodies.inverseMass[a];
+    const float inverse_mass_b = m_Bodies.inverseMass[b];
+    const auto& inverse_inertia_a = m_Bodies.inverseInertiaWorld[a];
+    const auto& inverse_inertia_b = m_Bodies.inverseInertiaWorld[b];
+
+    Vector3f va = m_Bodies.linearVelocity[a];
+    Vector3f wa = m_Bodies.angularVelocity[a];
+    Vector3f vb = m_Bodies.linearVelocity[b];
+    Vector3f wb = m_Bodies.angularVelocity[b];
+
+    auto apply = [&](const ContactPoint& point, const Vector3f& impulse) {
+        va = va - impulse * inverse_mass_a;
+        wa = wa - multiply(inverse_inertia_a, CrossProduct(point.rA, impulse));
+        vb = vb + impulse * inverse_mass_b;
+        wb = wb + multiply(inverse_inertia_b, CrossProduct(point.rB, impulse));
+    };
+
+    auto relative_velocity = [&](const ContactPoint& point) {
+        return vb + CrossProduct(wb, point.rB) - va -
+               CrossProduct(wa, point.rA);
+    };
+
+    // friction first, the normal impulse matters more
+    for (uint32_t k = 0; k < manifold.pointCount; k++) {
+        auto& point = manifold.points[k];
+        const float max_friction = manifold.friction * point.normalImpulse;
+
+        for (int t = 0; t < 2; t++) {
+            const float velocity =
+                DotProduct(relative_velocity(point), manifold.tangent[t]);
+            float lambda = -point.tangentMass[t] * velocity;
+
+            const float old_impulse = point.tangentImpulse[t];
+            point.tangentImpulse[t] = std::clamp(old_impulse + lambda,
+                                                 -max_friction, max_friction);
+            lambda = point.tangentImpulse[t] - old_impulse;
+
+            apply(point, manifold.tangent[t] * lambda);
+        }
+    }
+
+    for (uint32_t k = 0; k < manifold.pointCount; k++) {
+        auto& point = manifold.points[k];
+        const float velocity =
+            DotProduct(relative_velocity(point), manifold.normal);
+        float lambda = -point.normalMass * (velocity - point.bias);
+
+        const float old_impulse = point.normalImpulse;
+        point.normalImpulse = max(old_impulse + lambda, 0.0f);
+        lambda = point.normalImpulse - old_impulse;
+
+        apply(point, manifold.normal * lambda);
+    }
+
+    if (inverse_mass_a != 0.0f) {
+        m_Bodies.linearVelocity[a] = va;
+        m_Bodies.angularVelocity[a] = wa;
+    }
+    if (inverse_mass_b != 0.0f) {
+        m_Bodies.linearVelocity[b] = vb;
+        m_Bodies.angularVelocity[b] = wb;
+    }
+}
+
+void PhysicsWorld::integratePositions(float time_step) {
+    const float linear_sleep = kSleepLinearVelocity * kSleepLinearVelocity;
+    const float angular_sleep = kSleepAngularVelocity * kSleepAngularVelocity;
+
+    parallelFor(m_Bodies.size(), kBodiesPerJob, [&](size_t begin,
+                                                    size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (m_Bodies.inverseMass[i] == 0.0f || !m_Bodies.awake[i]) {
+                continue;
+            }
+
+            auto& p = m_Bodies.position[i];
+            p = p + m_Bodies.linearVelocity[i] * time_step;
+
+            // dq/dt = 0.5 * (w, 0) * q
+            const auto& w = m_Bodies.angularVelocity[i];
+            auto& q = m_Bodies.orientation[i];
+            const Vector3f u = {q[0], q[1], q[2]};
+            const Vector3f dv = (w * q[3] + CrossProduct(w, u)) * 0.5f;
+            const float dw = -0.5f * DotProduct(w, u);
+            q = normalized({q[0] + dv[0] * time_step, q[1] + dv[1] * time_step,
+                            q[2] + dv[2] * time_step, q[3] + dw * time_step});
+
+            m_Bodies.inverseInertiaWorld[i] =
+                world_inverse_inertia(m_Bodies.inverseInertiaLocal[i], q);
+
+            auto& sleep_time = m_Bodies.sleepTime[i];
+            if (LengthSquared(m_Bodies.linearVelocity[i]) > linear_sleep ||
+                LengthSquared(w) > angular_sleep) {
+                sleep_time = 0.0f;
+            } else {
+                sleep_time += time_step;
+            }
+        }
+    });
+}
+
+// an island sleeps once all of its bodies have rested long enough
+void PhysicsWorld::updateSleep() {
+    if (!m_bSleepingEnabled) return;
+
+    for (const auto& island : m_Islands) {
+        if (!island.awake) continue;
+
+        bool resting = true;
+        for (uint32_t k = island.bodyBegin; k < island.bodyEnd && resting;
+             k++) {
+            resting = m_Bodies.sleepTime[m_IslandBodies[k]] >= kTimeToSleep;
+        }
+        if (!resting) continue;
+
+        for (uint32_t k = island.bodyBegin; k < island.bodyEnd; k++) {
+            const uint32_t i = m_IslandBodies[k];
+            m_Bodies.awake[i] = 0;
+            m_Bodies.linearVelocity[i] = Vector3f(0.0f);
+            m_Bodies.angularVelocity[i] = Vector3f(0.0f);
+        }
+    }
+}
+
+// Conservative advancement: the distance to j is at least the current one
+// minus what the fastest point of i can travel towards it, so i can be
+// moved that far (plus the allowed depth) without going through j. j stays
+// where the step left it.
+bool PhysicsWorld::timeOfImpact(uint32_t i, uint32_t j,
+                                const Vector3f& position,
+                                const Quaternion<float>& orientation,
+                                float duration, bool skip_touching,
+                                float& fraction,
+                                DistanceResult& contact) const {
+    const auto& v = m_Bodies.linearVelocity[i];
+    const auto& w = m_Bodies.angularVelocity[i];
+    const float disc = angular_motion_disc(m_Bodies.shape[i]);
+    // along the normal the points of i move at most this fast
+    auto approach = [&](const Vector3f& normal) {
+        return DotProduct(v, normal) + Length(CrossProduct(w, normal)) * disc;
+    };
+    const ShapePose pose_j =
+        make_pose(m_Bodies.position[j], m_Bodies.orientation[j]);
+
+    float t = 0.0f;
+    for (uint32_t k = 0; k < kMaxTimeOfImpactIterations; k++) {
+        const ShapePose pose_i =
+            make_pose(position + v * (t * duration),
+                      rotated(orientation, w, t * duration));
+
+        DistanceResult distance;
+        if (!ShapeDistance(m_Bodies.shape[i], pose_i, m_Bodies.shape[j],
+                           pose_j, distance)) {
+            // touching from the start, there is no room to move towards j
+            if (k == 0 && skip_touching) return false;
+            // the closest points were found before the last advance, on a
+            // tilted surface far from where i touches it
+            CollisionResult touching;
+            if (k > 0 && Collide(m_Bodies.shape[i], pose_i,
+                                 m_Bodies.shape[j], pose_j, touching)) {
+                contact.normal = touching.normal;
+                contact.pointA = touching.points[0];
+                contact.pointB = touching.points[0];
+            }
+            break;
+        }
+        contact = distance;
+
+        const float speed = approach(distance.normal);
+        if (speed <= 0.0f) return false;
+
+        t += (distance.distance + kTimeOfImpactDepth) / (speed * duration);
+        if (t >= 1.0f) return false;
+    }
+
+    fraction = t;
+    return true;
+}
+
+// Bodies fast enough to tunnel are swept from where they started the step
+// to the first impact, bounce off it with an impulse along the normal and
+// go on for the rest of the step. The other bodies are not sub-stepped.
+// Candidates are the broadphase pairs, whose bounds were swept over the
+// step at the velocities before solving.
+void PhysicsWorld::solveContinuous(float time_step) {
+    if (!m_bContinuousCollision) return;
+
+    auto& candidates = m_ContinuousPairs;
+    candidates.clear();
+    m_Fast.assign(m_Bodies.size(), 0);
+    bool any = false;
+    for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+        if (m_Bodies.inverseMass[i] == 0.0f || !m_Bodies.awake[i]) continue;
+        const float motion = Length(m_Bodies.linearVelocity[i]) * time_step;
+        if (motion > kContinuousMotion * inner_radius(m_Bodies.shape[i])) {
+            m_Fast[i] = 1;
+            any = true;
+        }
+    }
+    if (!any) return;
+
+    for (const auto& [a, b] : m_Pairs) {
+        if (m_Fast[a]) candidates.emplace_back(a, b);
+        if (m_Fast[b]) candidates.emplace_back(b, a);
+    }
+    stable_sort(candidates.begin(), candidates.end(),
+                [](const auto& x, const auto& y) { return x.first < y.first; });
+
+    for (size_t begin = 0; begin < candidates.size();) {
+        const uint32_t i = candidates[begin].first;
+        size_t end = begin + 1;
+        while (end < candidates.size() && candidates[end].first == i) end++;
+
+        Vector3f position = m_Bodies.previousPosition[i];
+        Quaternion<float> orientation = m_Bodies.previousOrientation[i];
+        float remaining = time_step;
+        bool hit = false;
+
+        for (uint32_t step = 0; step < kMaxContinuousSubSteps; step++) {
+            float first = 1.0f;
+            uint32_t other = kInvalidIndex;
+            DistanceResult contact;
+            for (size_t k = begin; k < end; k++) {
+                float fraction;
+                DistanceResult distance;
+                const uint32_t j = candidates[k].second;
+                // the step started with the contacts solved, anything
+                // touching at the start of a later sub-step was hit on the
+                // way
+                if (timeOfImpact(i, j, position, orientation, remaining,
+                                 step == 0, fraction, distance) &&
+                    fraction < first) {
+                    first = fraction;
+                    other = j;
+                    contact = distance;
+                }
+            }
+
+            const float advance = remaining * first;
+            position = position + m_Bodies.linearVelocity[i] * advance;
+            orientation =
+                rotated(orientation, m_Bodies.angularVelocity[i], advance);
+            remaining -= advance;
+            if (other == kInvalidIndex) break;
+
+            hit = true;
+            m_Bodies.inverseInertiaWorld[i] = world_inverse_inertia(
+                m_Bodies.inverseInertiaLocal[i], orientation);
+            // touching what it hit last time, the contact solver takes over
+            // at the next step and the rest of this one is dropped
+            if (first == 0.0f) break;
+            applyImpact(i, other, position, contact);
+        }
+
+        if (hit) {
+            m_Bodies.position[i] = position;
+            m_Bodies.orientation[i] = orientation;
+            m_Bodies.inverseInertiaWorld[i] = world_inverse_inertia(
+                m_Bodies.inverseInertiaLocal[i], orientation);
+            m_Bodies.sleepTime[i] = 0.0f;
+        }
+
+        begin = end;
+    }
+}
+
+void PhysicsWorld::applyImpact(uint32_t i, uint32_t j,
+                               const Vector3f& position,
+                               const DistanceResult& contact) {
+    const Vector3f point = (contact.pointA + contact.pointB) * 0.5f;
+    const Vector3f& n = contact.normal;
+    const Vector3f ra = point - position;
+    const Vector3f rb = point - m_Bodies.position[j];
+
+    auto& va = m_Bodies.linearVelocity[i];
+    auto& wa = m_Bodies.angularVelocity[i];
+    auto& vb = m_Bodies.linearVelocity[j];
+    auto& wb = m_Bodies.angularVelocity[j];
+
+    const float normal_velocity =
+        DotProduct(vb + CrossProduct(wb, rb) - va - CrossProduct(wa, ra), n);
+    if (normal_velocity >= 0.0f) return;
+
+    const float inverse_mass_a = m_Bodies.inverseMass[i];
+    const float inverse_mass_b = m_Bodies.inverseMass[j];
+    const auto& inverse_inertia_a = m_Bodies.inverseInertiaWorld[i];
+    const auto& inverse_inertia_b = m_Bodies.inverseInertiaWorld[j];
+    const Vector3f ra_x_n = CrossProduct(ra, n);
+    const Vector3f rb_x_n = CrossProduct(rb, n);
+    const float k = inverse_mass_a + inverse_mass_b +
+                    DotProduct(ra_x_n, multiply(inverse_inertia_a, ra_x_n)) +
+                    DotProduct(rb_x_n, multiply(inverse_inertia_b, rb_x_n));
+    if (k <= 0.0f) return;
+
+    const float restitution =
+        max(m_Bodies.restitution[i], m_Bodies.restitution[j]);
+    const Vector3f impulse =
+        n * (-(1.0f + restitution) * normal_velocity / k);
+
+    va = va - impulse * inverse_mass_a;
+    wa = wa - multiply(inverse_inertia_a, CrossProduct(ra, impulse));
+    if (inverse_mass_b != 0.0f) {
+        vb = vb + impulse * inverse_mass_b;
+        wb = wb + multiply(inverse_inertia_b, CrossProduct(rb, impulse));
+        wake(j);
+    }
+}
+
+// The broadphase keeps the bounds swept over the next step, computed before
+// the bodies moved. The queries want them where the bodies are now.
+void PhysicsWorld::updateQueryBounds() {
+    if (m_bQueryBoundsValid) return;
+    for (uint32_t i = 0; i < m_Bodies.size(); i++) {
+        if (m_Bodies.inverseMass[i] == 0.0f) continue;
+        computeBounds(i, 0.0f);
+        m_pBroadphase->Move(m_Bodies.id[i], m_Bodies.aabbMin[i],
+                            m_Bodies.aabbMax[i], Vector3f(0.0f));
+    }
+    m_bQueryBoundsValid = true;
+}
+
+void PhysicsWorld::CastRays(const RayQuery* rays, size_t count,
+                            QueryHit* hits) {
+    updateQueryBounds();
+    parallelFor(count, kQueriesPerJob, [&](size_t begin, size_t end) {
+        auto& candidates = query_candidates();
+        for (size_t i = begin; i < end; i++) {
+            candidates.clear();
+            castRay(rays[i], candidates, hits[i]);
+        }
+    });
+}
+
+void PhysicsWorld::OverlapShapes(const ShapeQuery* shapes, size_t count,
+                                 BodyId* ids, uint32_t max_results,
+                                 uint32_t* counts) {
+    updateQueryBounds();
+    parallelFor(count, kQueriesPerJob, [&](size_t begin, size_t end) {
+        auto& candidates = query_candidates();
+        for (size_t i = begin; i < end; i++) {
+            candidates.clear();
+            counts[i] = overlapShape(shapes[i], candidates,
+                                     ids + i * max_results, max_results);
+        }
+    });
+}
+
+void PhysicsWorld::SweepShapes(const SweepQuery* sweeps, size_t count,
+                               QueryHit* hits) {
+    updateQueryBounds();
+    parallelFor(count, kQueriesPerJob, [&](size_t begin, size_t end) {
+        auto& candidates = query_candidates();
+        for (size_t i = begin; i < end; i++) {
+            candidates.clear();
+            sweepShape(sweeps[i], candidates, hits[i]);
+        }
+    });
+}
+
+void PhysicsWorld::castRay(const RayQuery& ray, vector<BodyId>& candidates,
+                           QueryHit& hit) const {
+    hit.id = kInvalidBodyId;
+    hit.distance = ray.maxDistance;
+
+    m_pBroadphase->RayQuery(ray.origin, ray.direction, ray.maxDistance,
+                            candidates);
+    candidates.insert(candidates.end(), m_Planes.begin(), m_Planes.end());
+
+    for (const BodyId id : candidates) {
+        if (id == ray.ignored) continue;
+        const uint32_t i = indexOf(id);
+        float distance;
+        Vector3f normal;
+        if (!RayCastShape(m_Bodies.shape[i],
+                          make_pose(m_Bodies.position[i],
+                                    m_Bodies.orientation[i]),
+                          ray.origin, ray.direction, hit.distance, distance,
+                          normal)) {
+            continue;
+        }
+        // the same body whatever the order of the candidates
+        if (hit.id != kInvalidBodyId &&
+            (distance > hit.distance ||
+             (distance == hit.distance && id > hit.id))) {
+            continue;
+        }
+        hit.id = id;
+        hit.distance = distance;
+        hit.normal = normal;
+    }
+
+    if (hit.id != kInvalidBodyId) {
+        hit.point = ray.origin + ray.direction * hit.distance;
+    }
+}
+
+uint32_t PhysicsWorld::overlapShape(const ShapeQuery& query,
+                                    vector<BodyId>& candidates, BodyId* ids,
+                                    uint32_t max_results) const {
+    const ShapePose pose = make_pose(query.position, query.orientation);
+    Vector3f min, max;
+    shape_bounds(query.shape, pose, min, max);
+
+    m_pBroadphase->Query(min, max, candidates);
+    candidates.insert(candidates.end(), m_Planes.begin(), m_Planes.end());
+    sort(candidates.begin(), candidates.end());
+
+    uint32_t count = 0;
+    for (const BodyId id : candidates) {
+        if (count == max_results) break;
+        if (id == query.ignored) continue;
+        const uint32_t i = indexOf(id);
+        CollisionResult result;
+        if (Collide(query.shape, pose, m_Bodies.shape[i],
+                    make_pose(m_Bodies.position[i], m_Bodies.orientation[i]),
+                    result)) {
+            ids[count++] = id;
+        }
+    }
+
+    return count;
+}
+
+// Conservative advancement along the direction against each candidate, the
+// shape does not turn.
+void PhysicsWorld::sweepShape(const SweepQuery& sweep,
+                              vector<BodyId>& candidates,
+                              QueryHit& hit) const {
+    hit.id = kInvalidBodyId;
+    hit.distance = sweep.maxDistance;
+
+    const ShapePose start = make_pose(sweep.position, sweep.orientation);
+    Vector3f min, max, end_min, end_max;
+    shape_bounds(sweep.shape, start, min, max);
+    const Vector3f motion = sweep.direction * sweep.maxDistance;
+    end_min = min + motion;
+    end_max = max + motion;
+    for (int k = 0; k < 3; k++) {
+        min[k] = std::min(min[k], end_min[k]);
+        max[k] = std::max(max[k], end_max[k]);
+    }
+
+    m_pBroadphase->Query(min, max, candidates);
+    candidates.insert(candidates.end(), m_Planes.begin(), m_Planes.end());
+
+    for (const BodyId id : candidates) {
+        if (id == sweep.ignored) continue;
+        const uint32_t j = indexOf(id);
+        const ShapePose pose_j =
+            make_pose(m_Bodies.position[j], m_Bodies.orientation[j]);
+
+        ShapePose pose = start;
+        float t = 0.0f;
+        // close enough once the iterations run out
+        bool touching = true;
+        DistanceResult contact;
+        for (uint32_t k = 0; k < kMaxTimeOfImpactIterations; k++) {
+            pose.position = sweep.position + sweep.direction * t;
+            DistanceResult distance;
+            if (!ShapeDistance(sweep.shape, pose, m_Bodies.shape[j], pose_j,
+                               distance)) {
+                // overlapping from the start
+                if (k == 0) {
+                    contact.pointB = sweep.position;
+                    contact.normal = sweep.direction;
+                }
+                break;
+            }
+            contact = distance;
+            if (distance.distance < kSweepTolerance) break;
+
+            const float speed = DotProduct(sweep.direction, distance.normal);
+            if (speed > 0.0f) t += distance.distance / speed;
+            if (speed <= 0.0f || t > hit.distance) {
+                touching = false;
+                break;
+            }
+        }
+        if (!touching) continue;
+        if (hit.id != kInvalidBodyId && t == hit.distance && id > hit.id) {
+            continue;
+        }
+
+        hit.id = id;
+        hit.distance = t;
+        hit.point = contact.pointB;
+        hit.normal = contact.normal * -1.0f;
+    }
+}
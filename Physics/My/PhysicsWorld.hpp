@@ -0,0 +1,342 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Broadphase.hpp"
+#include "Collision.hpp"
+#include "JobSystem.hpp"
+#include "geommath.hpp"
+
+namespace My {
+// Rigid body state, one array per attribute and one element per body, so
+// that each stage of the step only streams through the data it needs.
+// Bodies are kept packed, removing one moves the last body into its slot.
+struct RigidBodyArrays {
+    std::vector<BodyId> id;
+    std::vector<CollisionShape> shape;
+
+    std::vector<Vector3f> position;
+    std::vector<Quaternion<float>> orientation;
+    std::vector<Vector3f> linearVelocity;
+    std::vector<Vector3f> angularVelocity;
+
+    // accumulated until the end of the next Simulate() call
+    std::vector<Vector3f> force;
+    std::vector<Vector3f> torque;
+
+    // 0 for static bodies
+    std::vector<float> inverseMass;
+    // diagonal of the body space inverse inertia tensor
+    std::vector<Vector3f> inverseInertiaLocal;
+    std::vector<Matrix3X3f> inverseInertiaWorld;
+
+    std::vector<float> friction;
+    std::vector<float> restitution;
+
+    // state before the last step, for interpolation
+    std::vector<Vector3f> previousPosition;
+    std::vector<Quaternion<float>> previousOrientation;
+
+    // world space bounds, swept over the next step for moving bodies.
+    // Planes have no bounds and are kept out of the broadphase.
+    std::vector<Vector3f> aabbMin;
+    std::vector<Vector3f> aabbMax;
+
+    // sleeping bodies are neither moved nor solved until something wakes
+    // them up. Static bodies are always awake.
+    std::vector<uint8_t> awake;
+    // time spent below the sleep velocities
+    std::vector<float> sleepTime;
+
+    [[nodiscard]] size_t size() const { return id.size(); }
+};
+
+struct ContactPoint {
+    // anchor in the body space of A, to match points between steps
+    Vector3f localAnchor;
+    // from the body centers to the contact point, in world space
+    Vector3f rA;
+    Vector3f rB;
+    float depth;
+
+    float normalMass;
+    float tangentMass[2];
+    float bias;
+
+    // accumulated impulses, kept from one step to the next (warm starting)
+    float normalImpulse;
+    float tangentImpulse[2];
+};
+
+struct ContactManifold {
+    // body indices for the current step, idA < idB
+    uint32_t a;
+    uint32_t b;
+    BodyId idA;
+    BodyId idB;
+
+    Vector3f normal;  // from A to B
+    Vector3f tangent[2];
+    float friction;
+    float restitution;
+
+    uint32_t pointCount;
+    ContactPoint points[kMaxContactPoints];
+};
+
+// Spatial queries. Bodies are tested where the last step left them, not
+// where GetInterpolatedTransform() shows them. The ignored body is left out
+// of the results, kInvalidBodyId for none.
+struct RayQuery {
+    Vector3f origin;
+    Vector3f direction;  // unit length
+    float maxDistance;
+    BodyId ignored{kInvalidBodyId};
+};
+
+// a shape placed in the world, which can not be a plane
+struct ShapeQuery {
+    CollisionShape shape;
+    Vector3f position;
+    Quaternion<float> orientation{0.0f, 0.0f, 0.0f, 1.0f};
+    BodyId ignored{kInvalidBodyId};
+};
+
+// the shape moved along a unit direction, without turning
+struct SweepQuery : ShapeQuery {
+    Vector3f direction;
+    float maxDistance;
+};
+
+struct QueryHit {
+    BodyId id;  // kInvalidBodyId if nothing was hit
+    float distance;
+    Vector3f point;
+    Vector3f normal;  // of the surface hit
+};
+
+// Headless rigid body simulation: semi-implicit Euler integration at a fixed
+// time step, and a sequential impulse contact solver with warm starting.
+// Bodies in contact form islands, solved independently of each other and
+// put to sleep together once all their bodies have come to rest.
+class PhysicsWorld {
+   public:
+    PhysicsWorld();
+
+    // mass 0 makes a static body. transform may contain a scale, it is
+    // removed.
+    BodyId CreateBody(const CollisionShape& shape, float mass,
+                      const Matrix4X4f& transform, float friction = 0.5f,
+                      float restitution = 0.0f);
+    void DestroyBody(BodyId id);
+    void Clear();
+
+    [[nodiscard]] size_t GetBodyCount() const { return m_Bodies.size(); }
+    [[nodiscard]] size_t GetContactCount() const;
+    [[nodiscard]] const RigidBodyArrays& GetBodies() const { return m_Bodies; }
+    [[nodiscard]] const std::vector<ContactManifold>& GetManifolds() const {
+        return m_Manifolds;
+    }
+
+    // teleport the body, without interpolation from its previous place
+    void SetTransform(BodyId id, const Matrix4X4f& transform);
+    [[nodiscard]] Matrix4X4f GetTransform(BodyId id) const;
+    // transform at the time reached by the last Simulate() call, between
+    // the last two steps
+    [[nodiscard]] Matrix4X4f GetInterpolatedTransform(BodyId id) const;
+    // the same for all the bodies in one pass, at their id. Free ids keep
+    // whatever they had.
+    void GetInterpolatedTransforms(std::vector<Matrix4X4f>& transforms) const;
+
+    void SetLinearVelocity(BodyId id, const Vector3f& velocity);
+    [[nodiscard]] Vector3f GetLinearVelocity(BodyId id) const;
+    void SetAngularVelocity(BodyId id, const Vector3f& velocity);
+    [[nodiscard]] Vector3f GetAngularVelocity(BodyId id) const;
+
+    void ApplyCentralForce(BodyId id, const Vector3f& force);
+    void ApplyTorque(BodyId id, const Vector3f& torque);
+
+    void SetGravity(const Vector3f& gravity) { m_Gravity = gravity; }
+    [[nodiscard]] Vector3f GetGravity() const { return m_Gravity; }
+    void SetFixedTimeStep(float time_step) { m_fFixedTimeStep = time_step; }
+    [[nodiscard]] float GetFixedTimeStep() const { return m_fFixedTimeStep; }
+    void SetMaxSubSteps(uint32_t count) { m_nMaxSubSteps = count; }
+    void SetSolverIterations(uint32_t count) { m_nSolverIterations = count; }
+    // the bodies are moved to the new broadphase
+    void SetBroadphaseType(BroadphaseType type);
+    [[nodiscard]] BroadphaseType GetBroadphaseType() const {
+        return m_BroadphaseType;
+    }
+
+    // islands, large islands' contact batches and the integration are
+    // spread over the jobs. nullptr runs everything on the calling thread.
+    void SetJobSystem(JobSystem* job_system) { m_pJobSystem = job_system; }
+    // Large islands are split into batches of contacts sharing no moving
+    // body, which changes the solving order. By default they are only
+    // batched when there are worker threads to run the batches; in
+    // deterministic mode they always are, so that the results are bit
+    // identical whatever the number of threads.
+    void SetDeterministic(bool deterministic) {
+        m_bDeterministic = deterministic;
+    }
+    [[nodiscard]] bool IsDeterministic() const { return m_bDeterministic; }
+    // sweeps the bodies fast enough to go through others in one step
+    // (conservative advancement), on by default
+    void SetContinuousCollision(bool enabled) {
+        m_bContinuousCollision = enabled;
+    }
+    // disabling wakes every body up
+    void SetSleepingEnabled(bool enabled);
+    [[nodiscard]] bool IsAwake(BodyId id) const;
+    // wakes the whole island up at the next step
+    void WakeUp(BodyId id);
+    // islands of the last step, sleeping ones included
+    [[nodiscard]] size_t GetIslandCount() const { return m_Islands.size(); }
+
+    // Advance the simulation by elapsed_time, in as many fixed steps as fit
+    // (at most max sub steps, the rest of the time is dropped). Forces are
+    // applied to every step and cleared afterwards. Returns the number of
+    // steps taken.
+    uint32_t Simulate(float elapsed_time);
+    // one fixed step of time_step seconds
+    void Step(float time_step);
+
+    // Batches of queries, spread over the jobs. The results go to arrays of
+    // the caller, one per query: the first hit of each ray or sweep, and
+    // the ids of the bodies overlapping each shape, at most max_results of
+    // them from ids + i * max_results in id order, counts[i] of them.
+    // Shapes already touching a body at the start of a ray or sweep hit it
+    // at distance 0.
+    void CastRays(const RayQuery* rays, size_t count, QueryHit* hits);
+    void OverlapShapes(const ShapeQuery* shapes, size_t count, BodyId* ids,
+                       uint32_t max_results, uint32_t* counts);
+    void SweepShapes(const SweepQuery* sweeps, size_t count, QueryHit* hits);
+
+    // fraction of a step between the last step and the simulated time
+    [[nodiscard]] float GetInterpolationFactor() const {
+        return m_fAccumulator / m_fFixedTimeStep;
+    }
+
+   private:
+    // moving bodies connected by contacts, static bodies do not connect
+    // islands. Ranges in m_IslandBodies and m_Batches.
+    struct Island {
+        uint32_t bodyBegin;
+        uint32_t bodyEnd;
+        uint32_t batchBegin;
+        uint32_t batchEnd;
+        bool awake;
+    };
+
+    // a range of m_IslandManifolds. The manifolds of a parallel batch share
+    // no moving body and can be solved in any order.
+    struct ContactBatch {
+        uint32_t begin;
+        uint32_t end;
+        bool parallel;
+    };
+
+    void computeBounds(uint32_t index, float time_step);
+    void updateBounds(float time_step);
+    void findPairs();
+    void collide(float time_step);
+    void buildIslands();
+    void batchContacts(const Island& island, uint32_t begin, uint32_t end);
+    void integrateVelocities(float time_step);
+    void solveIslands(float time_step);
+    void solveIsland(const Island& island, float inverse_time_step);
+    void prepareContact(ContactManifold& manifold, float inverse_time_step);
+    void warmStart(const ContactManifold& manifold);
+    void solveContact(ContactManifold& manifold);
+    void integratePositions(float time_step);
+    void solveContinuous(float time_step);
+    // first time, as a fraction of duration, at which i moving from the
+    // given pose hits j. false if it does not. Shapes touching at the
+    // start are skipped, or hit at 0 if skip_touching is false.
+    bool timeOfImpact(uint32_t i, uint32_t j, const Vector3f& position,
+                      const Quaternion<float>& orientation, float duration,
+                      bool skip_touching, float& fraction,
+                      DistanceResult& contact) const;
+    // i, at position, hits j
+    void applyImpact(uint32_t i, uint32_t j, const Vector3f& position,
+                     const DistanceResult& contact);
+    void updateSleep();
+    // brings the bounds up to the positions, once after each step
+    void updateQueryBounds();
+    // candidates is scratch space of the calling thread
+    void castRay(const RayQuery& ray, std::vector<BodyId>& candidates,
+                 QueryHit& hit) const;
+    uint32_t overlapShape(const ShapeQuery& query,
+                          std::vector<BodyId>& candidates, BodyId* ids,
+                          uint32_t max_results) const;
+    void sweepShape(const SweepQuery& sweep, std::vector<BodyId>& candidates,
+                    QueryHit& hit) const;
+    void wake(uint32_t index);
+    // wakes the bodies touching id up
+    void wakeContacts(BodyId id);
+    // runs function(begin, end) over [0, count), on the jobs if any
+    void parallelFor(size_t count, size_t grain_size,
+                     const JobSystem::RangeFunction& function);
+
+    [[nodiscard]] uint32_t indexOf(BodyId id) const;
+    [[nodiscard]] Matrix4X4f interpolatedTransform(uint32_t index,
+                                                   float alpha) const;
+
+   private:
+    RigidBodyArrays m_Bodies;
+
+    // body id -> index in m_Bodies
+    std::vector<uint32_t> m_IdToIndex;
+    std::vector<BodyId> m_FreeIds;
+
+    BroadphaseType m_BroadphaseType = BroadphaseType::kAabbTree;
+    std::unique_ptr<Broadphase> m_pBroadphase;
+    // bodies with a plane shape, paired with the moving bodies directly
+    std::vector<BodyId> m_Planes;
+
+    // candidate pairs, sorted by id so that the contacts are solved in the
+    // same order whatever the broadphase
+    std::vector<BodyPair> m_BodyPairs;
+    // the same pairs as body indices
+    std::vector<std::pair<uint32_t, uint32_t>> m_Pairs;
+
+    std::vector<ContactManifold> m_Manifolds;
+    std::vector<ContactManifold> m_PreviousManifolds;
+    // pair key -> index in m_PreviousManifolds
+    std::unordered_map<uint64_t, uint32_t> m_ManifoldLookup;
+
+    std::vector<Island> m_Islands;
+    std::vector<ContactBatch> m_Batches;
+    // body indices grouped by island
+    std::vector<uint32_t> m_IslandBodies;
+    // manifold indices grouped by island, then by batch
+    std::vector<uint32_t> m_IslandManifolds;
+    // scratch space of buildIslands(), per body
+    std::vector<uint32_t> m_IslandParent;
+    std::vector<uint32_t> m_BodyIsland;
+    std::vector<uint64_t> m_BodyBatches;
+    // scratch space of buildIslands() and solveIslands()
+    std::vector<uint32_t> m_Scratch;
+    // scratch space of batchContacts(), per manifold of the island
+    std::vector<uint32_t> m_ManifoldBatches;
+    std::vector<uint32_t> m_SortedManifolds;
+    // scratch space of solveContinuous(): fast bodies and their candidates
+    std::vector<uint8_t> m_Fast;
+    std::vector<std::pair<uint32_t, uint32_t>> m_ContinuousPairs;
+
+    JobSystem* m_pJobSystem = nullptr;
+    bool m_bDeterministic = false;
+    bool m_bSleepingEnabled = true;
+    bool m_bContinuousCollision = true;
+    // the broadphase has the bounds of the bodies where they are
+    bool m_bQueryBoundsValid = false;
+
+    Vector3f m_Gravity{0.0f, 0.0f, -9.8f};
+    float m_fFixedTimeStep = 1.0f / 60.0f;
+    float m_fAccumulator = 0.0f;
+    uint32_t m_nMaxSubSteps = 10;
+    uint32_t m_nSolverIterations = 10;
+};
+}  // namespace My
@@ -4,20 +4,25 @@
 
 #include "Geometry.hpp"
 #include "MotionState.hpp"
+#include "PhysicsWorld.hpp"
 
 namespace My {
 template<class T>
 class RigidBody {
    public:
     RigidBody(std::shared_ptr<Geometry<T>> collisionShape,
-              std::shared_ptr<MotionState> state)
+              std::shared_ptr<MotionState> state, BodyId body)
         : m_pCollisionShape(std::move(collisionShape)),
-          m_pMotionState(std::move(state)) {}
+          m_pMotionState(std::move(state)),
+          m_nBodyId(body) {}
     std::shared_ptr<MotionState> GetMotionState() { return m_pMotionState; }
     std::shared_ptr<Geometry<T>> GetCollisionShape() { return m_pCollisionShape; }
+    // the body simulated by the physics world
+    [[nodiscard]] BodyId GetBodyId() const { return m_nBodyId; }
 
    private:
     std::shared_ptr<Geometry<T>> m_pCollisionShape;
     std::shared_ptr<MotionState> m_pMotionState;
+    BodyId m_nBodyId;
 };
 }  // namespace My
\ No newline at end of file
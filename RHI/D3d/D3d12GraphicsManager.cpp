@@ -362,6 +362,10 @@ void D3d12GraphicsManager::initializeGeometries(const Scene& scene) {
             dbc->index_count = (UINT)index_array.GetIndexCount();
             dbc->property_count = vertexPropertiesCount;
 
+            if (pMesh->HasMeshlets()) {
+                dbc->meshlets = &pMesh->GetMeshlets(0);
+            }
+
 #if 0
             // load material textures
             dbc->cbv_srv_uav_offset =
@@ -512,7 +516,21 @@ void D3d12GraphicsManager::DrawBatch(const Frame& frame) {
         const D3dDrawBatchContext& dbc =
             dynamic_cast<const D3dDrawBatchContext&>(*pDbc);
 
-        rhi.Draw(m_VertexBuffers[dbc.property_offset].descriptor, m_IndexBuffers[dbc.index_offset].descriptor, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, dbc.index_count);
+        const auto& vertexBuffer = m_VertexBuffers[dbc.property_offset].descriptor;
+        const auto& indexBuffer = m_IndexBuffers[dbc.index_offset].descriptor;
+
+        if (dbc.clustersCulled && !m_bDrawingShadowMap) {
+            // only the meshlets which survived culling, shadow maps need
+            // the whole mesh since they are not rendered from the camera
+            for (const auto& range : dbc.visibleRanges) {
+                rhi.Draw(vertexBuffer, indexBuffer,
+                         D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, range.count,
+                         range.offset);
+            }
+        } else {
+            rhi.Draw(vertexBuffer, indexBuffer,
+                     D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, dbc.index_count);
+        }
     }
 }
 
@@ -552,10 +570,14 @@ void D3d12GraphicsManager::GenerateTextureArray(Texture2DArray& texture_array) {
 }
 
 void D3d12GraphicsManager::BeginShadowMap(
-    const int32_t light_index, const TextureBase* pShadowmap, const int32_t layer_index, const Frame& frame) {}
+    const int32_t light_index, const TextureBase* pShadowmap, const int32_t layer_index, const Frame& frame) {
+    m_bDrawingShadowMap = true;
+}
 
 void D3d12GraphicsManager::EndShadowMap(const TextureBase* pShadowmap,
-                                        const int32_t layer_index, const Frame& frame) {}
+                                        const int32_t layer_index, const Frame& frame) {
+    m_bDrawingShadowMap = false;
+}
 
 void D3d12GraphicsManager::SetShadowMaps(const Frame& frame) {}
 
@@ -86,6 +86,7 @@ class D3d12GraphicsManager : public GraphicsManager {
     };
 
     D3dDrawBatchContext m_dbcSkyBox;
+    bool m_bDrawingShadowMap = false;
     std::vector<D3d12RHI::IndexBuffer> m_IndexBuffers;
     std::vector<D3d12RHI::VertexBuffer> m_VertexBuffers;
 };
@@ -845,7 +845,7 @@ void D3d12RHI::SetRootSignature(ID3D12RootSignature* pRootSignature) {
     m_pCmdList->SetGraphicsRootSignature(pRootSignature);
 }
 
-void D3d12RHI::Draw(const D3D12_VERTEX_BUFFER_VIEW &vertexBufferView, const D3D12_INDEX_BUFFER_VIEW &indexBufferView, D3D_PRIMITIVE_TOPOLOGY primitive_topology, uint32_t index_count_per_instance) {
+void D3d12RHI::Draw(const D3D12_VERTEX_BUFFER_VIEW &vertexBufferView, const D3D12_INDEX_BUFFER_VIEW &indexBufferView, D3D_PRIMITIVE_TOPOLOGY primitive_topology, uint32_t index_count_per_instance, uint32_t start_index_location) {
     auto config = m_fGetGfxConfigHandler();
 
     auto& m_pCmdList = m_pGraphicsCommandLists[0];
@@ -875,7 +875,8 @@ void D3d12RHI::Draw(const D3D12_VERTEX_BUFFER_VIEW &vertexBufferView, const D3D1
     m_pCmdList->SetGraphicsRootDescriptorTable(1, descriptorHandler);
 
     // draw the vertex buffer to the back buffer
-    m_pCmdList->DrawIndexedInstanced(index_count_per_instance, 1, 0, 0, 0);
+    m_pCmdList->DrawIndexedInstanced(index_count_per_instance, 1,
+                                     start_index_location, 0, 0);
 
     // 更新常量
     updateUniformBufer();
@@ -96,7 +96,8 @@ class D3d12RHI {
     void Draw(const D3D12_VERTEX_BUFFER_VIEW& vertexBufferView,
               const D3D12_INDEX_BUFFER_VIEW& indexBufferView,
               D3D_PRIMITIVE_TOPOLOGY primitive_topology,
-              uint32_t index_count_per_instance);
+              uint32_t index_count_per_instance,
+              uint32_t start_index_location = 0);
     void DrawGUI(ID3D12DescriptorHeap* pCbvSrvHeap);
     void EndPass();
     void EndFrame();
@@ -1 +1,130 @@
-// empty file
\ No newline at end of file
+#include "EmptyGraphicsManager.hpp"
+
+using namespace My;
+using namespace std;
+
+void EmptyGraphicsManager::initializeGeometries(const Scene& scene) {
+    int32_t batch_index = 0;
+
+    for (const auto& _it : scene.GeometryNodes) {
+        const auto& pGeometryNode = _it.second.lock();
+        if (!pGeometryNode || !pGeometryNode->Visible()) continue;
+
+        const auto& pGeometry =
+            scene.GetGeometry(pGeometryNode->GetSceneObjectRef());
+        if (!pGeometry) continue;
+        const auto& pMesh = pGeometry->GetMesh().lock();
+        if (!pMesh) continue;
+
+        for (size_t i = 0; i < pMesh->GetIndexGroupCount(); i++) {
+            auto dbc = make_shared<DrawBatchContext>();
+
+            const auto lodCount = pMesh->GetLodCount();
+            if (lodCount > 1) {
+                dbc->lodErrors.push_back(0.0f);
+                for (uint32_t lod = 1; lod < lodCount; lod++) {
+                    dbc->lodErrors.push_back(pMesh->GetLodError(lod));
+                }
+                dbc->boundingBox = pMesh->GetBoundingBox();
+            }
+
+            if (pMesh->HasMeshlets()) {
+                dbc->meshlets = &pMesh->GetMeshlets(i);
+            }
+
+            dbc->batchIndex = batch_index++;
+            dbc->node = pGeometryNode;
+
+            for (uint32_t n = 0; n < GfxConfiguration::kMaxInFlightFrameCount;
+                 n++) {
+                m_Frames[n].batchContexts.push_back(dbc);
+            }
+        }
+    }
+}
+
+void EmptyGraphicsManager::Present() {
+    m_RecordedCommands.frames++;
+    // a new command buffer, nothing is bound
+    m_pBoundPipelineState = nullptr;
+}
+
+void EmptyGraphicsManager::SetPipelineState(
+    const std::shared_ptr<PipelineState>& pipelineState, const Frame& frame) {
+    m_RecordedCommands.pipelineStateBinds++;
+    if (pipelineState.get() != m_pBoundPipelineState) {
+        m_RecordedCommands.pipelineStateChanges++;
+        m_pBoundPipelineState = pipelineState.get();
+    }
+}
+
+void EmptyGraphicsManager::DrawBatch(const Frame& frame) {
+    m_RecordedCommands.batchDraws++;
+    for (const auto& pDbc : frame.batchContexts) {
+        // shadow maps need the whole mesh, they are not rendered from the
+        // camera the clusters were culled for
+        if (pDbc->clustersCulled && !m_bDrawingShadowMap) {
+            m_RecordedCommands.drawCalls += pDbc->visibleRanges.size();
+        } else {
+            m_RecordedCommands.drawCalls++;
+        }
+    }
+}
+
+void EmptyGraphicsManager::BeginPass(Frame& frame) {
+    m_RecordedCommands.passes++;
+}
+
+void EmptyGraphicsManager::BeginCompute() {
+    m_RecordedCommands.computePasses++;
+}
+
+void EmptyGraphicsManager::Dispatch(const uint32_t width,
+                                    const uint32_t height,
+                                    const uint32_t depth) {
+    m_RecordedCommands.dispatches++;
+}
+
+void EmptyGraphicsManager::BeginShadowMap(const int32_t light_index,
+                                          const TextureBase* pShadowmap,
+                                          const int32_t layer_index,
+                                          const Frame& frame) {
+    m_RecordedCommands.shadowMaps++;
+    m_bDrawingShadowMap = true;
+}
+
+void EmptyGraphicsManager::EndShadowMap(const TextureBase* pShadowmap,
+                                        const int32_t layer_index,
+                                        const Frame& frame) {
+    m_bDrawingShadowMap = false;
+}
+
+void EmptyGraphicsManager::DrawSkyBox(const Frame& frame) {
+    m_RecordedCommands.drawCalls++;
+}
+
+void EmptyGraphicsManager::DrawFullScreenQuad() {
+    m_RecordedCommands.drawCalls++;
+}
+
+void EmptyGraphicsManager::CreateTexture(SceneObjectTexture& texture) {
+    m_RecordedCommands.textureCreations++;
+}
+
+void EmptyGraphicsManager::GenerateTexture(Texture2D& texture) {
+    m_RecordedCommands.textureCreations++;
+}
+
+void EmptyGraphicsManager::GenerateCubemapArray(
+    TextureCubeArray& texture_array) {
+    m_RecordedCommands.textureCreations++;
+}
+
+void EmptyGraphicsManager::GenerateTextureArray(
+    Texture2DArray& texture_array) {
+    m_RecordedCommands.textureCreations++;
+}
+
+void EmptyGraphicsManager::GenerateTextureForWrite(Texture2D& texture) {
+    m_RecordedCommands.textureCreations++;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "GraphicsManager.hpp"
+
+namespace My {
+// what the passes asked of the RHI, counted in place of the work a real
+// backend would do for it
+struct RecordedCommandCounts {
+    uint64_t frames{0};
+    uint64_t passes{0};
+    uint64_t computePasses{0};
+    // SetPipelineState() calls, and those binding another state than the
+    // one already bound
+    uint64_t pipelineStateBinds{0};
+    uint64_t pipelineStateChanges{0};
+    uint64_t shadowMaps{0};
+    // DrawBatch() calls, and the draws a real backend issues for them: one
+    // per batch, or one per visible range of a batch with culled clusters
+    uint64_t batchDraws{0};
+    uint64_t drawCalls{0};
+    uint64_t dispatches{0};
+    uint64_t textureCreations{0};
+};
+
+// Renders nothing, but still builds a batch context for every visible mesh
+// so that the per-frame CPU work (constants, lights, LOD selection and
+// culling) runs as it does on a real backend. The commands it gets are
+// counted.
+class EmptyGraphicsManager : public GraphicsManager {
+   public:
+    void Present() override;
+
+    void SetPipelineState(const std::shared_ptr<PipelineState>& pipelineState,
+                          const Frame& frame) override;
+    void DrawBatch(const Frame& frame) override;
+
+    void BeginPass(Frame& frame) override;
+    void BeginCompute() override;
+    void Dispatch(const uint32_t width, const uint32_t height,
+                  const uint32_t depth) override;
+
+    void BeginShadowMap(const int32_t light_index,
+                        const TextureBase* pShadowmap,
+                        const int32_t layer_index,
+                        const Frame& frame) override;
+    void EndShadowMap(const TextureBase* pShadowmap,
+                      const int32_t layer_index, const Frame& frame) override;
+
+    void DrawSkyBox(const Frame& frame) override;
+    void DrawFullScreenQuad() override;
+
+    void CreateTexture(SceneObjectTexture& texture) override;
+    void GenerateTexture(Texture2D& texture) override;
+    void GenerateCubemapArray(TextureCubeArray& texture_array) override;
+    void GenerateTextureArray(Texture2DArray& texture_array) override;
+    void GenerateTextureForWrite(Texture2D& texture) override;
+
+    // since the last reset, by the thread rendering
+    [[nodiscard]] const RecordedCommandCounts& GetRecordedCommands() const {
+        return m_RecordedCommands;
+    }
+    void ResetRecordedCommands() { m_RecordedCommands = {}; }
+
+   protected:
+    void initializeGeometries(const Scene& scene) final;
+
+   private:
+    RecordedCommandCounts m_RecordedCommands;
+    const PipelineState* m_pBoundPipelineState{nullptr};
+    bool m_bDrawingShadowMap{false};
+};
+}  // namespace My
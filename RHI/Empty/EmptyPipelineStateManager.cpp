@@ -4,6 +4,7 @@ using namespace My;
 
 bool EmptyPipelineStateManager::InitializePipelineState(
     PipelineState** ppPipelineState) {
+    *ppPipelineState = new PipelineState(**ppPipelineState);
     return true;
 }
 
@@ -6,12 +6,8 @@ class EmptyPipelineStateManager : public PipelineStateManager {
    using PipelineStateManager::PipelineStateManager;
     ~EmptyPipelineStateManager() = default;
 
-    int Initialize() final { return 0; }
-    void Finalize() final {}
-
-    void Tick() final {}
-
    protected:
+    // keeps a copy of the description, there is nothing to compile
     bool InitializePipelineState(PipelineState** ppPipelineState) final;
     void DestroyPipelineState(PipelineState& pipelineState) final;
 };
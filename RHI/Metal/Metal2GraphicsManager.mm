@@ -115,6 +115,9 @@ void Metal2GraphicsManager::initializeGeometries(const Scene& scene) {
             dbc->index_type = type;
             dbc->property_offset = v_property_offset;
             dbc->property_count = vertexPropertiesCount;
+            if (pMesh->HasMeshlets()) {
+                dbc->meshlets = &pMesh->GetMeshlets(0);
+            }
 
             auto it = material_map.find(material_key);
             if (it == material_map.end()) {
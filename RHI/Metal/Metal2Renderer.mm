@@ -148,6 +148,7 @@ static const NSUInteger GEFSMaxBuffersInFlight = GfxConfiguration::kMaxInFlightF
     id<MTLBuffer> _uniformBuffers[GEFSMaxBuffersInFlight];
     id<MTLBuffer> _lightInfo[GEFSMaxBuffersInFlight];
     ShadowMapConstants shadow_map_constants;
+    BOOL _drawingShadowMap;
     std::vector<id<MTLBuffer>> _vertexBuffers;
     std::vector<id<MTLBuffer>> _indexBuffers;
     id<MTLSamplerState> _sampler0;
@@ -633,11 +634,24 @@ static const NSUInteger GEFSMaxBuffersInFlight = GfxConfiguration::kMaxInFlightF
         [_renderEncoder setFragmentSamplerState:_sampler0 atIndex:0];
 
         // Draw our mesh
-        [_renderEncoder drawIndexedPrimitives:dbc.index_mode
-                                   indexCount:dbc.index_count
-                                    indexType:dbc.index_type
-                                  indexBuffer:_indexBuffers[dbc.index_offset]
-                            indexBufferOffset:0];
+        if (dbc.clustersCulled && !_drawingShadowMap) {
+            // only the meshlets which survived culling, shadow maps need
+            // the whole mesh since they are not rendered from the camera
+            const NSUInteger index_size = (dbc.index_type == MTLIndexTypeUInt16) ? 2 : 4;
+            for (const auto& range : dbc.visibleRanges) {
+                [_renderEncoder drawIndexedPrimitives:dbc.index_mode
+                                           indexCount:range.count
+                                            indexType:dbc.index_type
+                                          indexBuffer:_indexBuffers[dbc.index_offset]
+                                    indexBufferOffset:range.offset * index_size];
+            }
+        } else {
+            [_renderEncoder drawIndexedPrimitives:dbc.index_mode
+                                       indexCount:dbc.index_count
+                                        indexType:dbc.index_type
+                                      indexBuffer:_indexBuffers[dbc.index_offset]
+                                indexBufferOffset:0];
+        }
     }
 
     [_renderEncoder popDebugGroup];
@@ -720,6 +734,8 @@ static const NSUInteger GEFSMaxBuffersInFlight = GfxConfiguration::kMaxInFlightF
     shadow_map_constants.shadowmap_layer_index = static_cast<float>(layer_index);
     shadow_map_constants.near_plane = 1.0;
     shadow_map_constants.far_plane = 100.0;
+
+    _drawingShadowMap = YES;
 }
 
 - (void)endShadowMap:(const id<MTLTexture>)shadowmap
@@ -728,6 +744,8 @@ static const NSUInteger GEFSMaxBuffersInFlight = GfxConfiguration::kMaxInFlightF
     [_renderEncoder popDebugGroup];
     [_renderEncoder endEncoding];
     [_renderEncoder release];
+
+    _drawingShadowMap = NO;
 }
 
 - (void)setShadowMaps:(const Frame&)frame {
@@ -293,6 +293,40 @@ void OpenGLGraphicsManagerCommonBase::initializeGeometries(const Scene& scene) {
 
                 auto dbc = make_shared<OpenGLDrawBatchContext>();
 
+                // LOD index buffers share the vertex buffers above, LOD 0
+                // is the index buffer just created
+                const auto lodCount = pMesh->GetLodCount();
+                if (lodCount > 1) {
+                    dbc->lodBuffers.push_back(buffer_id);
+                    dbc->lodCounts.push_back(indexCount);
+                    dbc->lodErrors.push_back(0.0f);
+
+                    for (uint32_t lod = 1; lod < lodCount; lod++) {
+                        const auto& lod_index_array =
+                            pMesh->GetLodIndexArray(lod, i);
+                        uint32_t lod_buffer_id;
+                        glGenBuffers(1, &lod_buffer_id);
+                        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod_buffer_id);
+                        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                                     lod_index_array.GetDataSize(),
+                                     lod_index_array.GetData(), GL_STATIC_DRAW);
+                        m_Buffers.push_back(lod_buffer_id);
+
+                        dbc->lodBuffers.push_back(lod_buffer_id);
+                        dbc->lodCounts.push_back(static_cast<int32_t>(
+                            lod_index_array.GetIndexCount()));
+                        dbc->lodErrors.push_back(pMesh->GetLodError(lod));
+                    }
+
+                    // restore the LOD 0 binding in the vertex array object
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_id);
+                    dbc->boundingBox = pMesh->GetBoundingBox();
+                }
+
+                if (pMesh->HasMeshlets()) {
+                    dbc->meshlets = &pMesh->GetMeshlets(i);
+                }
+
                 const auto material_index = index_array.GetMaterialIndex();
                 const auto& material_key =
                     pGeometryNode->GetMaterialRef(material_index);
@@ -850,7 +884,29 @@ void OpenGLGraphicsManagerCommonBase::DrawBatch(const Frame& frame) {
 
         glBindVertexArray(dbc.vao);
 
-        glDrawElements(dbc.mode, dbc.count, dbc.type, nullptr);
+        if (dbc.clustersCulled && !m_bDrawingShadowMap) {
+            // only the meshlets which survived culling, shadow maps need
+            // the whole mesh since they are not rendered from the camera
+            if (!dbc.lodBuffers.empty()) {
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dbc.lodBuffers[0]);
+            }
+
+            const size_t index_size = (dbc.type == GL_UNSIGNED_BYTE)    ? 1
+                                      : (dbc.type == GL_UNSIGNED_SHORT) ? 2
+                                                                        : 4;
+            for (const auto& range : dbc.visibleRanges) {
+                glDrawElements(
+                    dbc.mode, static_cast<int32_t>(range.count), dbc.type,
+                    reinterpret_cast<const void*>(range.offset * index_size));
+            }
+        } else if (dbc.lodBuffers.empty()) {
+            glDrawElements(dbc.mode, dbc.count, dbc.type, nullptr);
+        } else {
+            const auto lod =
+                (dbc.lod < dbc.lodBuffers.size()) ? dbc.lod : 0;
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dbc.lodBuffers[lod]);
+            glDrawElements(dbc.mode, dbc.lodCounts[lod], dbc.type, nullptr);
+        }
     }
 
     glBindVertexArray(0);
@@ -919,6 +975,8 @@ void OpenGLGraphicsManagerCommonBase::BeginShadowMap(
 
     glBindFramebuffer(GL_FRAMEBUFFER, m_ShadowmapFramebuffer);
 
+    m_bDrawingShadowMap = true;
+
     if (frame.lightInfo.lights[light_index].lightType == LightType::Omni) {
 #if defined(OS_WEBASSEMBLY)
         glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
@@ -979,6 +1037,8 @@ void OpenGLGraphicsManagerCommonBase::EndShadowMap(
     const TextureBase* pShadowmap, int32_t layer_index, const Frame&) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    m_bDrawingShadowMap = false;
+
     glDeleteFramebuffers(1, &m_ShadowmapFramebuffer);
 
     glViewport(0, 0, m_canvasWidth, m_canvasHeight);
@@ -110,10 +110,14 @@ class OpenGLGraphicsManagerCommonBase : public GraphicsManager {
         uint32_t mode{0};
         uint32_t type{0};
         int32_t count{0};
+        std::vector<uint32_t> lodBuffers;
+        std::vector<int32_t> lodCounts;
     };
 
     std::vector<uint32_t> m_Buffers;
 
+    bool m_bDrawingShadowMap = false;
+
     OpenGLDrawBatchContext m_SkyBoxDrawBatchContext;
     OpenGLDrawBatchContext m_TerrainDrawBatchContext;
 };
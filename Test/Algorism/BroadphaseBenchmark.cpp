@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "My/Broadphase.hpp"
+
+using namespace My;
+using namespace std;
+
+// Pair generation cost of the broadphases: boxes of random sizes drifting in
+// a cube, at a constant density whatever their count. Each step moves all
+// the boxes and asks for the pairs. Brute force only runs a few steps on
+// large counts.
+//
+// usage: BroadphaseBenchmark [step count] [body count...]
+
+struct Scene {
+    vector<Vector3f> min;
+    vector<Vector3f> max;
+    vector<Vector3f> velocity;
+    float side;
+};
+
+static Scene make_scene(uint32_t count) {
+    default_random_engine generator(count);
+    Scene scene;
+    // about 8 cubic meters per body
+    scene.side = cbrt(count * 8.0f);
+    uniform_real_distribution<float> position(0.0f, scene.side);
+    uniform_real_distribution<float> size(0.5f, 2.0f);
+    uniform_real_distribution<float> speed(-0.05f, 0.05f);
+
+    for (uint32_t i = 0; i < count; i++) {
+        Vector3f min, max, velocity;
+        for (int k = 0; k < 3; k++) {
+            min[k] = position(generator);
+            max[k] = min[k] + size(generator);
+            // one body in ten does not move
+            velocity[k] = (i % 10) ? speed(generator) : 0.0f;
+        }
+        scene.min.push_back(min);
+        scene.max.push_back(max);
+        scene.velocity.push_back(velocity);
+    }
+
+    return scene;
+}
+
+static void step_scene(Scene& scene) {
+    for (size_t i = 0; i < scene.min.size(); i++) {
+        auto& v = scene.velocity[i];
+        for (int k = 0; k < 3; k++) {
+            if (scene.min[i][k] < 0.0f || scene.max[i][k] > scene.side) {
+                v[k] = -v[k];
+            }
+        }
+        scene.min[i] = scene.min[i] + v;
+        scene.max[i] = scene.max[i] + v;
+    }
+}
+
+struct Result {
+    double add;   // ms to add all the bodies and get the first pairs
+    double step;  // ms per step
+    size_t pairs;
+};
+
+static Result run(Broadphase& broadphase, uint32_t count, uint32_t steps) {
+    Scene scene = make_scene(count);
+    vector<BodyPair> pairs;
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        const bool is_static = (i % 10) == 0;
+        broadphase.Add(i, scene.min[i], scene.max[i], is_static);
+    }
+    broadphase.GetPairs(pairs);
+    auto end = chrono::steady_clock::now();
+
+    Result result;
+    result.add = chrono::duration<double, milli>(end - start).count();
+
+    double total = 0.0;
+    for (uint32_t s = 0; s < steps; s++) {
+        step_scene(scene);
+
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; i++) {
+            if (i % 10 == 0) continue;
+            broadphase.Move(i, scene.min[i], scene.max[i], scene.velocity[i]);
+        }
+        broadphase.GetPairs(pairs);
+        end = chrono::steady_clock::now();
+
+        total += chrono::duration<double, milli>(end - start).count();
+    }
+    result.step = total / steps;
+
+    // the tree reports pairs of fat bounds, count the real overlaps
+    result.pairs = 0;
+    for (const auto& [a, b] : pairs) {
+        bool overlap = true;
+        for (int k = 0; k < 3; k++) {
+            if (scene.max[a][k] < scene.min[b][k] ||
+                scene.max[b][k] < scene.min[a][k]) {
+                overlap = false;
+            }
+        }
+        if (overlap) result.pairs++;
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t step_count = (argc > 1) ? atoi(argv[1]) : 50;
+    vector<uint32_t> body_counts;
+    for (int i = 2; i < argc; i++) body_counts.push_back(atoi(argv[i]));
+    if (body_counts.empty()) body_counts = {1000, 10000, 50000};
+
+    cout << setw(8) << "bodies" << setw(16) << "broadphase" << setw(12)
+         << "add (ms)" << setw(12) << "step (ms)" << setw(10) << "pairs"
+         << endl;
+
+    int result = 0;
+    for (const auto count : body_counts) {
+        // pairs at the end of the full runs, which must agree
+        vector<size_t> pair_counts;
+
+        for (auto type :
+             {BroadphaseType::kBruteForce, BroadphaseType::kAabbTree,
+              BroadphaseType::kSweepAndPrune}) {
+            unique_ptr<Broadphase> broadphase;
+            const char* name;
+            uint32_t steps = step_count;
+            switch (type) {
+                case BroadphaseType::kBruteForce:
+                    broadphase = make_unique<BruteForceBroadphase>();
+                    name = "brute force";
+                    // quadratic, a few steps are enough
+                    steps = std::max(
+                        1u, std::min(step_count, 1000000000u / (count * count)));
+                    break;
+                case BroadphaseType::kAabbTree:
+                    broadphase = make_unique<AabbTreeBroadphase>();
+                    name = "aabb tree";
+                    break;
+                default:
+                    broadphase = make_unique<SweepAndPrune>();
+                    name = "sweep & prune";
+            }
+
+            const Result r = run(*broadphase, count, steps);
+            if (steps == step_count) pair_counts.push_back(r.pairs);
+
+            cout << setw(8) << count << setw(16) << name << setw(12) << fixed
+                 << setprecision(3) << r.add << setw(12) << r.step << setw(10)
+                 << r.pairs << endl;
+        }
+
+        if (adjacent_find(pair_counts.begin(), pair_counts.end(),
+                          not_equal_to<>()) != pair_counts.end()) {
+            cerr << "the broadphases disagree on " << count << " bodies"
+                 << endl;
+            result = -1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "My/Broadphase.hpp"
+
+using namespace My;
+using namespace std;
+
+struct Body {
+    Vector3f min;
+    Vector3f max;
+    Vector3f velocity;
+    bool isStatic;
+    bool alive;
+};
+
+static bool overlap(const Body& a, const Body& b) {
+    for (int i = 0; i < 3; i++) {
+        if (a.max[i] < b.min[i] || b.max[i] < a.min[i]) return false;
+    }
+    return true;
+}
+
+// the pairs whose bounds really overlap, the tree also reports pairs whose
+// fat bounds overlap
+static vector<BodyPair> exact_pairs(const vector<BodyPair>& pairs,
+                                    const vector<Body>& bodies) {
+    vector<BodyPair> result;
+    for (const auto& pair : pairs) {
+        assert(pair.first < pair.second);
+        assert(bodies[pair.first].alive && bodies[pair.second].alive);
+        assert(!(bodies[pair.first].isStatic && bodies[pair.second].isStatic));
+        if (overlap(bodies[pair.first], bodies[pair.second])) {
+            result.push_back(pair);
+        }
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+// segment against bounds, slab by slab
+static bool crosses(const Vector3f& origin, const Vector3f& direction,
+                    float length, const Body& body) {
+    float enter = 0.0f, exit = length;
+    for (int i = 0; i < 3; i++) {
+        if (direction[i] == 0.0f) {
+            if (origin[i] < body.min[i] || body.max[i] < origin[i]) {
+                return false;
+            }
+            continue;
+        }
+        float t1 = (body.min[i] - origin[i]) / direction[i];
+        float t2 = (body.max[i] - origin[i]) / direction[i];
+        if (t1 > t2) swap(t1, t2);
+        enter = max(enter, t1);
+        exit = min(exit, t2);
+    }
+    return enter <= exit;
+}
+
+// the queries may report bodies which are only close, never miss one
+static void check_queries(const vector<unique_ptr<Broadphase>>& broadphases,
+                          const vector<Body>& bodies,
+                          default_random_engine& generator) {
+    uniform_real_distribution<float> position(0.0f, 20.0f);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    vector<BodyId> ids;
+    for (int q = 0; q < 5; q++) {
+        Body box;
+        for (int i = 0; i < 3; i++) {
+            box.min[i] = position(generator);
+            box.max[i] = box.min[i] + 3.0f;
+        }
+        const Vector3f origin = {position(generator), position(generator),
+                                 position(generator)};
+        Vector3f direction = {unit(generator), unit(generator),
+                              unit(generator)};
+        direction = direction * (1.0f / Length(direction));
+        if (q == 0) direction = {0.0f, 0.0f, 1.0f};
+
+        for (const auto& broadphase : broadphases) {
+            ids.clear();
+            broadphase->Query(box.min, box.max, ids);
+            for (BodyId id = 0; id < bodies.size(); id++) {
+                if (!bodies[id].alive || !overlap(box, bodies[id])) continue;
+                assert(find(ids.begin(), ids.end(), id) != ids.end());
+            }
+            for (const BodyId id : ids) assert(bodies[id].alive);
+
+            ids.clear();
+            broadphase->RayQuery(origin, direction, 10.0f, ids);
+            for (BodyId id = 0; id < bodies.size(); id++) {
+                if (!bodies[id].alive) continue;
+                if (!crosses(origin, direction, 10.0f, bodies[id])) continue;
+                assert(find(ids.begin(), ids.end(), id) != ids.end());
+            }
+            for (const BodyId id : ids) assert(bodies[id].alive);
+        }
+    }
+}
+
+int main() {
+    default_random_engine generator(42);
+    uniform_real_distribution<float> position(0.0f, 20.0f);
+    uniform_real_distribution<float> size(0.2f, 1.5f);
+    uniform_real_distribution<float> speed(-0.2f, 0.2f);
+
+    vector<unique_ptr<Broadphase>> broadphases;
+    broadphases.push_back(make_unique<BruteForceBroadphase>());
+    broadphases.push_back(make_unique<AabbTreeBroadphase>());
+    broadphases.push_back(make_unique<SweepAndPrune>());
+
+    vector<Body> bodies;
+    auto add_body = [&](bool is_static) {
+        Body body;
+        for (int i = 0; i < 3; i++) {
+            body.min[i] = position(generator);
+            body.max[i] = body.min[i] + size(generator);
+            body.velocity[i] = is_static ? 0.0f : speed(generator);
+        }
+        body.isStatic = is_static;
+        body.alive = true;
+
+        // reuse the first free id, as the physics world does
+        BodyId id = 0;
+        while (id < bodies.size() && bodies[id].alive) id++;
+        if (id == bodies.size()) {
+            bodies.push_back(body);
+        } else {
+            bodies[id] = body;
+        }
+
+        for (auto& broadphase : broadphases) {
+            broadphase->Add(id, body.min, body.max, is_static);
+        }
+    };
+
+    for (int i = 0; i < 400; i++) add_body(i % 8 == 0);
+
+    vector<BodyPair> pairs;
+    for (int step = 0; step < 200; step++) {
+        for (BodyId id = 0; id < bodies.size(); id++) {
+            auto& body = bodies[id];
+            if (!body.alive || body.isStatic) continue;
+
+            for (int i = 0; i < 3; i++) {
+                if (body.min[i] < 0.0f || body.max[i] > 21.0f) {
+                    body.velocity[i] = -body.velocity[i];
+                }
+            }
+            body.min = body.min + body.velocity;
+            body.max = body.max + body.velocity;
+            for (auto& broadphase : broadphases) {
+                broadphase->Move(id, body.min, body.max, body.velocity);
+            }
+        }
+
+        // some churn
+        if (step % 10 == 5) {
+            for (BodyId id = step % 7; id < bodies.size(); id += 37) {
+                if (!bodies[id].alive) continue;
+                bodies[id].alive = false;
+                for (auto& broadphase : broadphases) broadphase->Remove(id);
+            }
+        }
+        if (step % 10 == 8) {
+            for (int i = 0; i < 8; i++) add_body(i == 0);
+        }
+
+        // before the sweep and prune has sorted in the changes
+        check_queries(broadphases, bodies, generator);
+
+        broadphases[0]->GetPairs(pairs);
+        const auto expected = exact_pairs(pairs, bodies);
+        assert(expected.size() == pairs.size());
+
+        for (int k = 1; k < 3; k++) {
+            broadphases[k]->GetPairs(pairs);
+
+            // no duplicates
+            auto sorted = pairs;
+            sort(sorted.begin(), sorted.end());
+            assert(adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+            assert(exact_pairs(pairs, bodies) == expected);
+        }
+
+        if (step % 50 == 0) {
+            cout << "step " << step << ": " << expected.size() << " pairs"
+                 << endl;
+        }
+    }
+
+    auto tree = dynamic_cast<AabbTreeBroadphase*>(broadphases[1].get());
+    cout << "tree height: " << tree->GetTree().GetHeight() << " for "
+         << tree->GetTree().GetProxyCount() << " proxies" << endl;
+    // balanced, 1.44 log2(n) at worst
+    assert(tree->GetTree().GetHeight() < 20);
+
+    cout << "Broadphase test passed" << endl;
+
+    return 0;
+}
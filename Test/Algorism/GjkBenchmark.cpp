@@ -0,0 +1,215 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "ConvexHull.hpp"
+#include "Gjk.hpp"
+#include "GjkEpa.hpp"
+
+using namespace My;
+using namespace std;
+
+// Pairs per second of the narrowphase: the std::function based
+// GjkIntersection against the allocation free GJK, then the full contact
+// (GJK, EPA and manifold) on hulls, boxes and spheres.
+//
+// usage: GjkBenchmark [pair count] [points per hull]
+
+static Polyhedron<float> make_polyhedron(default_random_engine& generator,
+                                         const Vector3f& center,
+                                         int point_count) {
+    uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    ConvexHull<float> convex_hull;
+    for (int i = 0; i < point_count; i++) {
+        convex_hull.AddPoint(
+            Point<float>({center[0] + distribution(generator),
+                          center[1] + distribution(generator),
+                          center[2] + distribution(generator)}));
+    }
+    while (convex_hull.Iterate())
+        ;
+
+    return convex_hull.GetHull();
+}
+
+static ConvexHullSupport<float> make_hull(const Polyhedron<float>& polyhedron) {
+    ConvexHullSupport<float> hull;
+    unordered_map<const Point<float>*, uint32_t> indices;
+    vector<uint32_t> face;
+
+    for (const auto& pFace : polyhedron.Faces) {
+        face.clear();
+        for (const auto& pEdge : pFace->Edges) {
+            const auto index = static_cast<uint32_t>(hull.vertices.size());
+            auto [it, inserted] = indices.try_emplace(pEdge->first.get(), index);
+            if (inserted) hull.vertices.push_back(*pEdge->first);
+            face.push_back(it->second);
+        }
+        hull.AddFace(face.data(), static_cast<uint32_t>(face.size()));
+    }
+
+    return hull;
+}
+
+template <class Function>
+static double measure(size_t pair_count, uint32_t repeat, Function&& function) {
+    const auto start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < pair_count; i++) function(i);
+    }
+    const auto end = chrono::steady_clock::now();
+    const double seconds = chrono::duration<double>(end - start).count();
+    return pair_count * repeat / seconds;
+}
+
+static void report(const char* name, double pairs_per_second, size_t hits,
+                   size_t pair_count) {
+    cout << setw(36) << left << name << right << setw(14) << fixed
+         << setprecision(0) << pairs_per_second << setw(10) << hits << " / "
+         << pair_count << endl;
+}
+
+int main(int argc, char** argv) {
+    const size_t pair_count = (argc > 1) ? atoi(argv[1]) : 1000;
+    const int point_count = (argc > 2) ? atoi(argv[2]) : 32;
+
+    default_random_engine generator(1);
+    // about half of the pairs intersect
+    uniform_real_distribution<float> offset(-2.2f, 2.2f);
+
+    vector<Polyhedron<float>> polyhedra;
+    vector<ConvexHullSupport<float>> hulls;
+    for (size_t i = 0; i < 2 * pair_count; i++) {
+        const Vector3f center = (i % 2) ? Vector3f({offset(generator),
+                                                    offset(generator),
+                                                    offset(generator)})
+                                        : Vector3f(0.0f);
+        polyhedra.push_back(make_polyhedron(generator, center, point_count));
+        hulls.push_back(make_hull(polyhedra.back()));
+    }
+
+    size_t vertex_count = 0;
+    for (const auto& hull : hulls) vertex_count += hull.vertices.size();
+    cout << pair_count << " pairs of hulls of " << vertex_count / hulls.size()
+         << " vertices on average" << endl;
+    cout << setw(36) << left << "test" << right << setw(14) << "pairs/s"
+         << setw(10) << "hits" << endl;
+
+    // the old implementation may need a few calls per pair
+    vector<int> old_results(pair_count);
+    const double old_rate = measure(pair_count, 1, [&](size_t i) {
+        const auto& A = polyhedra[2 * i];
+        const auto& B = polyhedra[2 * i + 1];
+        SupportFunction<float> support_a = [&](const Vector3f& d) {
+            return ConvexPolyhedronSupportFunction(A, d);
+        };
+        SupportFunction<float> support_b = [&](const Vector3f& d) {
+            return ConvexPolyhedronSupportFunction(B, d);
+        };
+        PointListf simplex;
+        Vector3f direction({1.0f, 0.0f, 0.0f});
+        int result;
+        int iterations = 0;
+        while ((result = GjkIntersection(support_a, support_b, direction,
+                                         simplex)) == -1 &&
+               ++iterations < 64)
+            ;
+        old_results[i] = result;
+    });
+
+    size_t old_hits = 0;
+    for (const auto result : old_results) old_hits += (result == 1);
+    report("GjkIntersection (hulls)", old_rate, old_hits, pair_count);
+
+    const uint32_t repeat = 20;
+    vector<bool> new_results(pair_count);
+    const double new_rate = measure(pair_count, repeat, [&](size_t i) {
+        ConvexInstance a(hulls[2 * i], Vector3f(0.0f));
+        ConvexInstance b(hulls[2 * i + 1], Vector3f(0.0f));
+        Simplex<float> simplex;
+        GjkResult<float> result;
+        new_results[i] = GjkDistance(a, b, simplex, result);
+    });
+
+    size_t new_hits = 0;
+    size_t disagreements = 0;
+    for (size_t i = 0; i < pair_count; i++) {
+        new_hits += new_results[i];
+        if (old_results[i] != -1 && (old_results[i] == 1) != new_results[i]) {
+            disagreements++;
+        }
+    }
+    report("GjkDistance (hulls)", new_rate, new_hits, pair_count);
+
+    size_t contact_hits = 0;
+    const double contact_rate = measure(pair_count, repeat, [&](size_t i) {
+        ConvexInstance a(hulls[2 * i], Vector3f(0.0f));
+        ConvexInstance b(hulls[2 * i + 1], Vector3f(0.0f));
+        ConvexContact<float> contact;
+        contact_hits += CollideConvex(a, b, contact);
+    });
+    report("CollideConvex (hulls)", contact_rate, contact_hits / repeat,
+           pair_count);
+
+    // randomly rotated boxes and spheres
+    const BoxSupport<float> box{{0.5f, 0.4f, 0.3f}};
+    const SphereSupport<float> sphere{0.5f};
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    struct Placement {
+        Vector3f position;
+        Vector3f axis[3];
+    };
+    vector<Placement> placements(2 * pair_count);
+    for (size_t i = 0; i < placements.size(); i++) {
+        auto& p = placements[i];
+        p.position = (i % 2) ? Vector3f({offset(generator) * 0.5f,
+                                         offset(generator) * 0.5f,
+                                         offset(generator) * 0.5f})
+                             : Vector3f(0.0f);
+        const float t = angle(generator);
+        const float u = angle(generator);
+        // yaw then pitch
+        p.axis[0] = {cos(t), 0.0f, -sin(t)};
+        p.axis[1] = {sin(t) * sin(u), cos(u), cos(t) * sin(u)};
+        p.axis[2] = {sin(t) * cos(u), -sin(u), cos(t) * cos(u)};
+    }
+
+    size_t box_hits = 0;
+    const double box_rate = measure(pair_count, repeat, [&](size_t i) {
+        const auto& p = placements[2 * i];
+        const auto& q = placements[2 * i + 1];
+        ConvexInstance a(box, p.position, p.axis);
+        ConvexInstance b(box, q.position, q.axis);
+        ConvexContact<float> contact;
+        box_hits += CollideConvex(a, b, contact);
+    });
+    report("CollideConvex (box, box)", box_rate, box_hits / repeat,
+           pair_count);
+
+    size_t sphere_hits = 0;
+    const double sphere_rate = measure(pair_count, repeat, [&](size_t i) {
+        const auto& p = placements[2 * i];
+        const auto& q = placements[2 * i + 1];
+        ConvexInstance a(sphere, p.position, p.axis);
+        ConvexInstance b(box, q.position, q.axis);
+        ConvexContact<float> contact;
+        sphere_hits += CollideConvex(a, b, contact);
+    });
+    report("CollideConvex (sphere, box)", sphere_rate, sphere_hits / repeat,
+           pair_count);
+
+    cout << "speedup of GjkDistance over GjkIntersection: " << setprecision(1)
+         << new_rate / old_rate << "x" << endl;
+    if (disagreements) {
+        cout << disagreements
+             << " pairs where GjkIntersection gives another answer" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "GjkEpa.hpp"
+
+using namespace My;
+using namespace std;
+
+static bool near(float a, float b, float tolerance = 1e-3f) {
+    return std::abs(a - b) <= tolerance;
+}
+
+// a box as a hull with its six faces
+static ConvexHullSupport<float> make_box_hull(const Vector3f& half_extents) {
+    ConvexHullSupport<float> hull;
+    for (int i = 0; i < 8; i++) {
+        hull.vertices.push_back({(i & 1) ? half_extents[0] : -half_extents[0],
+                                 (i & 2) ? half_extents[1] : -half_extents[1],
+                                 (i & 4) ? half_extents[2] : -half_extents[2]});
+    }
+    const uint32_t faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                                  {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    for (const auto& face : faces) hull.AddFace(face, 4);
+    return hull;
+}
+
+static void sphere_test() {
+    const SphereSupport<float> sphere{1.0f};
+
+    // apart
+    {
+        ConvexInstance a(sphere, Vector3f({0.0f, 0.0f, 0.0f}));
+        ConvexInstance b(sphere, Vector3f({3.0f, 1.0f, 0.0f}));
+        Simplex<float> simplex;
+        GjkResult<float> result;
+        assert(!GjkDistance(a, b, simplex, result));
+        assert(near(result.distance, sqrt(10.0f) - 2.0f, 1e-2f));
+
+        ConvexContact<float> contact;
+        assert(!CollideConvex(a, b, contact));
+    }
+
+    // overlapping, against the closed form and the generic path
+    {
+        ConvexInstance a(sphere, Vector3f({0.0f, 0.0f, 0.0f}));
+        ConvexInstance b(sphere, Vector3f({1.5f, 0.0f, 0.0f}));
+        ConvexContact<float> contact;
+        assert(CollideConvex(a, b, contact));
+        assert(contact.pointCount == 1);
+        assert(near(contact.depths[0], 0.5f));
+        assert(near(contact.normal[0], 1.0f));
+
+        Simplex<float> simplex;
+        GjkResult<float> result;
+        assert(GjkDistance(a, b, simplex, result));
+        Vector3f normal, point_a, point_b;
+        float depth;
+        assert(Epa(a, b, simplex, normal, depth, point_a, point_b));
+        assert(near(depth, 0.5f, 2e-2f));
+        assert(near(normal[0], 1.0f, 1e-2f));
+    }
+
+    // sphere against a box, center outside then inside
+    {
+        const BoxSupport<float> box{{1.0f, 1.0f, 1.0f}};
+        ConvexInstance b(box, Vector3f({0.0f, 0.0f, 0.0f}));
+        ConvexContact<float> contact;
+
+        ConvexInstance a(sphere, Vector3f({0.0f, 1.8f, 0.0f}));
+        assert(CollideConvex(a, b, contact));
+        assert(near(contact.depths[0], 0.2f));
+        assert(near(contact.normal[1], -1.0f));
+
+        ConvexInstance c(sphere, Vector3f({0.0f, 0.7f, 0.0f}));
+        assert(CollideConvex(c, b, contact));
+        assert(near(contact.depths[0], 1.3f, 1e-2f));
+        assert(near(contact.normal[1], -1.0f, 1e-2f));
+
+        // the same pair the other way round
+        assert(CollideConvex(b, a, contact));
+        assert(near(contact.normal[1], 1.0f));
+    }
+}
+
+static void box_test() {
+    const BoxSupport<float> box{{1.0f, 1.0f, 1.0f}};
+    const ConvexHullSupport<float> hull = make_box_hull({1.0f, 1.0f, 1.0f});
+
+    // resting face to face, sunk by 0.1
+    ConvexInstance a(box, Vector3f({0.0f, 0.0f, 0.0f}));
+    ConvexInstance b(box, Vector3f({0.3f, 1.9f, 0.2f}));
+    ConvexContact<float> contact;
+    assert(CollideConvex(a, b, contact));
+    assert(near(contact.normal[1], 1.0f));
+    assert(contact.pointCount == 4);
+    for (uint32_t i = 0; i < contact.pointCount; i++) {
+        assert(near(contact.depths[i], 0.1f));
+        assert(near(contact.points[i][1], 0.95f));
+    }
+
+    // the hull of a box gives the same contact
+    ConvexInstance c(hull, Vector3f({0.0f, 0.0f, 0.0f}));
+    ConvexInstance d(hull, Vector3f({0.3f, 1.9f, 0.2f}));
+    ConvexContact<float> hull_contact;
+    assert(CollideConvex(c, d, hull_contact));
+    assert(hull_contact.pointCount == 4);
+    assert(near(hull_contact.normal[1], 1.0f));
+    assert(near(hull_contact.depths[0], 0.1f));
+
+    // tilted 45 degrees about z, an edge in a face: two points
+    const float s = sqrt(0.5f);
+    const Vector3f axis[3] = {{s, s, 0.0f}, {-s, s, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    ConvexInstance e(box, Vector3f({0.0f, 1.0f + sqrt(2.0f) - 0.05f, 0.0f}),
+                     axis);
+    assert(CollideConvex(a, e, contact));
+    assert(contact.pointCount == 2);
+    assert(near(contact.normal[1], 1.0f));
+    assert(near(contact.depths[0], 0.05f));
+    assert(near(contact.depths[1], 0.05f));
+
+    // a box on the ground plane
+    const HalfSpace<float> ground{{0.0f, 1.0f, 0.0f}, 0.0f};
+    ConvexInstance plane(ground, Vector3f({0.0f, 0.0f, 0.0f}));
+    ConvexInstance f(box, Vector3f({5.0f, 0.98f, 0.0f}));
+    assert(CollideConvex(f, plane, contact));
+    assert(contact.pointCount == 4);
+    assert(near(contact.normal[1], -1.0f));
+    assert(near(contact.depths[0], 0.02f));
+    assert(CollideConvex(plane, f, contact));
+    assert(near(contact.normal[1], 1.0f));
+}
+
+// random placements of two boxes, the hull and the box give the same depth
+static void random_test() {
+    default_random_engine generator(7);
+    uniform_real_distribution<float> offset(-2.5f, 2.5f);
+    uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+    const BoxSupport<float> box{{1.0f, 0.5f, 0.75f}};
+    const ConvexHullSupport<float> hull = make_box_hull(box.halfExtents);
+
+    int hits = 0;
+    for (int i = 0; i < 1000; i++) {
+        const float t = angle(generator);
+        const Vector3f axis[3] = {{cos(t), 0.0f, -sin(t)},
+                                  {0.0f, 1.0f, 0.0f},
+                                  {sin(t), 0.0f, cos(t)}};
+        const Vector3f position(
+            {offset(generator), offset(generator), offset(generator)});
+
+        ConvexInstance a(box, Vector3f(0.0f));
+        ConvexInstance b(box, position, axis);
+        ConvexInstance c(hull, Vector3f(0.0f));
+        ConvexInstance d(hull, position, axis);
+
+        ConvexContact<float> box_contact, hull_contact;
+        const bool box_hit = CollideConvex(a, b, box_contact);
+        const bool hull_hit = CollideConvex(c, d, hull_contact);
+        assert(box_hit == hull_hit);
+        if (!box_hit) continue;
+        hits++;
+
+        float box_depth = 0.0f, hull_depth = 0.0f;
+        for (uint32_t k = 0; k < box_contact.pointCount; k++) {
+            box_depth = std::max(box_depth, box_contact.depths[k]);
+        }
+        for (uint32_t k = 0; k < hull_contact.pointCount; k++) {
+            hull_depth = std::max(hull_depth, hull_contact.depths[k]);
+        }
+        assert(near(box_depth, hull_depth, 1e-2f));
+        assert(box_contact.pointCount >= 1 &&
+               box_contact.pointCount <= kMaxConvexContactPoints);
+
+        // moving b out along the normal separates the boxes
+        const Vector3f moved =
+            position + box_contact.normal * (box_depth + 1e-2f);
+        ConvexInstance e(box, moved, axis);
+        Simplex<float> simplex;
+        GjkResult<float> result;
+        assert(!GjkDistance(a, e, simplex, result));
+    }
+
+    cout << hits << " of 1000 random pairs intersect" << endl;
+    assert(hits > 100);
+}
+
+int main() {
+    sphere_test();
+    box_test();
+    random_test();
+
+    cout << "GJK/EPA test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ConvexHull.hpp"
+#include "HalfEdgeHull.hpp"
+
+using namespace My;
+using namespace std;
+
+// twins, faces and Euler's formula of a closed triangle mesh
+static void check_topology(const HalfEdgeHull<float>& hull) {
+    const auto& edges = hull.GetHalfEdges();
+    size_t edge_count = 0;
+    for (uint32_t e = 0; e < edges.size(); e++) {
+        if (edges[e].face == HalfEdgeHull<float>::kInvalidIndex) continue;
+        edge_count++;
+        const auto& twin = edges[edges[e].twin];
+        assert(twin.twin == e);
+        assert(twin.face != HalfEdgeHull<float>::kInvalidIndex);
+        // the twin runs the other way
+        assert(twin.vertex == edges[edges[e].next].vertex);
+        assert(edges[edges[edges[e].next].next].next == e);
+    }
+
+    const size_t face_count = hull.GetFaceCount();
+    assert(edge_count == 3 * face_count);
+    const size_t vertex_count = hull.GetVertices().size();
+    assert(vertex_count - edge_count / 2 + face_count == 2);
+}
+
+// largest distance of the points outside of the hull
+static float max_outside(const ConvexHullSupport<float>& hull,
+                         const vector<Vector3f>& points) {
+    float result = 0.0f;
+    for (const auto& p : points) {
+        float outside = -1e30f;
+        for (size_t f = 0; f < hull.GetFaceCount(); f++) {
+            const auto& n = hull.faceNormals[f];
+            const auto& v =
+                hull.vertices[hull.faceIndices[hull.faceOffsets[f]]];
+            const float d = n[0] * (p[0] - v[0]) + n[1] * (p[1] - v[1]) +
+                            n[2] * (p[2] - v[2]);
+            outside = std::max(outside, d);
+        }
+        result = std::max(result, outside);
+    }
+    return result;
+}
+
+static void random_test() {
+    default_random_engine generator(3);
+    uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    vector<Vector3f> points(2000);
+    for (auto& p : points) {
+        p = {distribution(generator), distribution(generator),
+             distribution(generator)};
+    }
+
+    HalfEdgeHull<float> hull;
+    assert(hull.Build(points.data(), points.size()));
+    check_topology(hull);
+
+    const auto support = hull.GetSupport();
+    assert(max_outside(support, points) < 1e-4f);
+    cout << "random points: " << hull.GetVertices().size() << " vertices, "
+         << support.GetFaceCount() << " faces" << endl;
+}
+
+// a box mesh: corners, points on the faces and duplicates
+static void box_test() {
+    vector<Vector3f> points;
+    for (int i = 0; i < 8; i++) {
+        const Vector3f corner = {(i & 1) ? 1.0f : -1.0f, (i & 2) ? 2.0f : -2.0f,
+                                 (i & 4) ? 0.5f : -0.5f};
+        points.push_back(corner);
+        points.push_back(corner);
+        points.push_back(corner * 0.5f);
+    }
+    points.push_back({1.0f, 0.3f, 0.2f});
+    points.push_back({0.0f, 2.0f, 0.0f});
+    points.push_back({0.5f, -2.0f, 0.5f});
+
+    HalfEdgeHull<float> hull;
+    assert(hull.Build(points.data(), points.size()));
+    check_topology(hull);
+    assert(hull.GetVertices().size() == 8);
+
+    const auto support = hull.GetSupport();
+    assert(support.vertices.size() == 8);
+    assert(support.GetFaceCount() == 6);
+    for (size_t f = 0; f < 6; f++) {
+        assert(support.faceOffsets[f + 1] - support.faceOffsets[f] == 4);
+    }
+    assert(max_outside(support, points) < 1e-5f);
+
+    // flat input has no hull
+    vector<Vector3f> flat = {
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+        {1.0f, 1.0f, 0.0f}, {0.5f, 0.2f, 0.0f}};
+    assert(!hull.Build(flat.data(), flat.size()));
+    assert(hull.Empty());
+}
+
+// a finely tessellated sphere simplified to a vertex budget
+static void simplify_test() {
+    vector<Vector3f> points;
+    const int rings = 64;
+    const int segments = 128;
+    for (int i = 1; i < rings; i++) {
+        const float theta = PI * i / rings;
+        for (int j = 0; j < segments; j++) {
+            const float phi = 2.0f * PI * j / segments;
+            points.push_back({sin(theta) * cos(phi), sin(theta) * sin(phi),
+                              cos(theta)});
+        }
+    }
+    points.push_back({0.0f, 0.0f, 1.0f});
+    points.push_back({0.0f, 0.0f, -1.0f});
+
+    HalfEdgeHull<float> hull;
+    auto start = chrono::steady_clock::now();
+    assert(hull.Build(points.data(), points.size()));
+    auto end = chrono::steady_clock::now();
+    check_topology(hull);
+    cout << "sphere of " << points.size() << " points: "
+         << hull.GetVertices().size() << " vertices in "
+         << chrono::duration<double, milli>(end - start).count() << " ms"
+         << endl;
+
+    for (const uint32_t budget : {16u, 32u, 64u}) {
+        assert(hull.Build(points.data(), points.size(), budget));
+        check_topology(hull);
+        assert(hull.GetVertices().size() <= budget);
+        for (const auto index : hull.GetVertexIndices()) {
+            assert(index < points.size());
+        }
+
+        const auto support = hull.GetSupport();
+        const float error = max_outside(support, points);
+        cout << budget << " vertices: " << support.GetFaceCount()
+             << " faces, points at most " << error << " outside" << endl;
+        // the farthest point first keeps the error down
+        assert(error < 0.5f * 16.0f / budget);
+    }
+
+    // the same through ConvexHull
+    ConvexHull<float> convex_hull;
+    for (const auto& p : points) convex_hull.AddPoint(p);
+    convex_hull.SetMaxVertexCount(32);
+    assert(!convex_hull.Iterate());
+    assert(convex_hull.GetSupport().vertices.size() <= 32);
+    assert(convex_hull.Faces.size() == convex_hull.GetSupport().GetFaceCount());
+}
+
+int main() {
+    random_test();
+    box_test();
+    simplify_test();
+
+    cout << "HalfEdgeHull test passed" << endl;
+
+    return 0;
+}
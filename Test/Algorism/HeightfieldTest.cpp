@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "My/Heightfield.hpp"
+
+using namespace My;
+using namespace std;
+
+const uint32_t kColumns = 257;
+const uint32_t kRows = 193;
+const float kSpacingX = 0.5f;
+const float kSpacingY = 0.75f;
+
+static float terrain(float x, float y) {
+    return 2.0f * sin(0.3f * x) * cos(0.2f * y) + 0.1f * x;
+}
+
+// every triangle against the ray, front side only
+static bool brute_force_ray(const Heightfield& heightfield,
+                            const Vector3f& origin,
+                            const Vector3f& direction, float max_distance,
+                            float& distance) {
+    bool hit = false;
+    distance = max_distance;
+    for (uint32_t r = 0; r + 1 < heightfield.GetRows(); r++) {
+        for (uint32_t c = 0; c + 1 < heightfield.GetColumns(); c++) {
+            Vector3f triangles[2][3];
+            heightfield.GetTriangles(c, r, triangles);
+            for (const auto* t : triangles) {
+                const Vector3f n = CrossProduct(t[1] - t[0], t[2] - t[0]);
+                const float speed = DotProduct(n, direction);
+                if (speed >= 0.0f) continue;
+                const float d = DotProduct(n, t[0] - origin) / speed;
+                if (d < 0.0f || d > distance) continue;
+                const Vector3f p = origin + direction * d;
+                // inside all three edges, seen along the normal
+                bool inside = true;
+                for (int e = 0; e < 3; e++) {
+                    const Vector3f edge = t[(e + 1) % 3] - t[e];
+                    inside &=
+                        DotProduct(CrossProduct(edge, p - t[e]), n) >= 0.0f;
+                }
+                if (!inside) continue;
+                hit = true;
+                distance = d;
+            }
+        }
+    }
+    return hit;
+}
+
+int main() {
+    vector<float> heights(kColumns * kRows);
+    for (uint32_t r = 0; r < kRows; r++) {
+        for (uint32_t c = 0; c < kColumns; c++) {
+            heights[r * kColumns + c] = terrain(c * kSpacingX, r * kSpacingY);
+        }
+    }
+    const auto [lowest, highest] =
+        minmax_element(heights.begin(), heights.end());
+    const float quantum = (*highest - *lowest) / 65535.0f;
+
+    const Heightfield heightfield(kColumns, kRows, heights.data(), kSpacingX,
+                                  kSpacingY);
+
+    // samples, surface and bounds
+    for (uint32_t r = 0; r < kRows; r++) {
+        for (uint32_t c = 0; c < kColumns; c++) {
+            const float h = heights[r * kColumns + c];
+            assert(fabs(heightfield.GetHeight(c, r) - h) <= quantum);
+            float surface;
+            assert(heightfield.GetSurfaceHeight(c * kSpacingX, r * kSpacingY,
+                                                surface));
+            assert(fabs(surface - heightfield.GetHeight(c, r)) < 1e-4f);
+        }
+    }
+    Vector3f lower, upper;
+    heightfield.GetBounds(lower, upper);
+    assert(fabs(lower[2] - *lowest) < 1e-4f);
+    assert(fabs(upper[2] - *highest) < 1e-4f);
+    assert(upper[0] == kSpacingX * (kColumns - 1));
+    float surface;
+    assert(!heightfield.GetSurfaceHeight(-0.1f, 1.0f, surface));
+    assert(!heightfield.GetSurfaceHeight(1.0f, upper[1] + 0.1f, surface));
+
+    // two bytes a sample, the quadtree is small next to them
+    const size_t floats = heights.size() * sizeof(float);
+    cout << kColumns << " x " << kRows << " samples in "
+         << heightfield.GetMemorySize() << " bytes, " << floats
+         << " as floats" << endl;
+    assert(heightfield.GetMemorySize() < floats * 6 / 10);
+
+    default_random_engine generator(7);
+    uniform_real_distribution<float> x_position(-5.0f, upper[0] + 5.0f);
+    uniform_real_distribution<float> y_position(-5.0f, upper[1] + 5.0f);
+    uniform_real_distribution<float> z_position(lower[2] - 1.0f,
+                                                upper[2] + 3.0f);
+    uniform_real_distribution<float> size(0.0f, 4.0f);
+
+    // the cells reported are those under the box reaching its bottom
+    vector<uint8_t> reported((kColumns - 1) * (kRows - 1));
+    for (int q = 0; q < 200; q++) {
+        const Vector3f box_min = {x_position(generator), y_position(generator),
+                                  z_position(generator)};
+        const Vector3f box_max =
+            box_min + Vector3f({size(generator), size(generator), 1.0f});
+        fill(reported.begin(), reported.end(), 0);
+        heightfield.QueryCells(box_min, box_max, [&](uint32_t c, uint32_t r) {
+            assert(c + 1 < kColumns && r + 1 < kRows);
+            assert(!reported[r * (kColumns - 1) + c]);
+            reported[r * (kColumns - 1) + c] = 1;
+        });
+
+        for (uint32_t r = 0; r + 1 < kRows; r++) {
+            for (uint32_t c = 0; c + 1 < kColumns; c++) {
+                const bool under =
+                    (c + 1) * kSpacingX >= box_min[0] &&
+                    c * kSpacingX <= box_max[0] &&
+                    (r + 1) * kSpacingY >= box_min[1] &&
+                    r * kSpacingY <= box_max[1];
+                const float top = max({heightfield.GetHeight(c, r),
+                                       heightfield.GetHeight(c + 1, r),
+                                       heightfield.GetHeight(c, r + 1),
+                                       heightfield.GetHeight(c + 1, r + 1)});
+                if (under && top >= box_min[2] + quantum) {
+                    assert(reported[r * (kColumns - 1) + c]);
+                }
+                // cells on the edges of the box may be reported
+                if (reported[r * (kColumns - 1) + c]) {
+                    assert((c + 2) * kSpacingX >= box_min[0] &&
+                           (c - 1.0f) * kSpacingX <= box_max[0]);
+                    assert(top >= box_min[2] - quantum);
+                }
+            }
+        }
+    }
+
+    // rays against every triangle
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    vector<Vector3f> origins, directions;
+    for (int q = 0; q < 300; q++) {
+        Vector3f origin = {x_position(generator), y_position(generator),
+                           upper[2] + size(generator)};
+        Vector3f direction = {unit(generator), unit(generator),
+                              -fabs(unit(generator)) - 0.05f};
+        if (q % 10 == 0) direction = {0.0f, 0.0f, -1.0f};
+        if (q % 10 == 1) direction = {1.0f, 0.3f, -0.02f};
+        direction = direction * (1.0f / Length(direction));
+        origins.push_back(origin);
+        directions.push_back(direction);
+    }
+
+    size_t hits = 0;
+    double tree_time = 0.0, brute_force_time = 0.0;
+    for (size_t q = 0; q < origins.size(); q++) {
+        float distance, expected;
+        Vector3f normal;
+        auto start = chrono::steady_clock::now();
+        const bool hit = heightfield.RayCast(origins[q], directions[q], 100.0f,
+                                             distance, normal);
+        auto middle = chrono::steady_clock::now();
+        const bool expected_hit = brute_force_ray(
+            heightfield, origins[q], directions[q], 100.0f, expected);
+        auto end = chrono::steady_clock::now();
+        tree_time += chrono::duration<double, milli>(middle - start).count();
+        brute_force_time +=
+            chrono::duration<double, milli>(end - middle).count();
+
+        assert(hit == expected_hit);
+        if (!hit) continue;
+        hits++;
+        assert(fabs(distance - expected) < 1e-3f);
+        assert(fabs(Length(normal) - 1.0f) < 1e-4f);
+        assert(normal[2] > 0.0f && DotProduct(normal, directions[q]) < 0.0f);
+
+        // the point hit is on the surface
+        const Vector3f p = origins[q] + directions[q] * distance;
+        assert(heightfield.GetSurfaceHeight(p[0], p[1], surface));
+        assert(fabs(surface - p[2]) < 1e-3f);
+    }
+    cout << hits << " of " << origins.size() << " rays hit, "
+         << tree_time << " ms with the quadtree, " << brute_force_time
+         << " ms against every triangle" << endl;
+    assert(hits > origins.size() / 2);
+
+    // below the surface, hit at once
+    float distance;
+    Vector3f normal;
+    const Vector3f below = {10.0f, 10.0f, terrain(10.0f, 10.0f) - 0.5f};
+    assert(heightfield.RayCast(below, {0.0f, 0.0f, 1.0f}, 10.0f, distance,
+                               normal));
+    assert(distance == 0.0f && normal[2] == -1.0f);
+
+    // a flat terrain
+    const vector<float> flat(4 * 3, 1.5f);
+    const Heightfield plateau(4, 3, flat.data(), 1.0f, 1.0f);
+    assert(plateau.GetHeight(2, 1) == 1.5f);
+    assert(plateau.RayCast({1.2f, 0.7f, 3.0f}, {0.0f, 0.0f, -1.0f}, 10.0f,
+                           distance, normal));
+    assert(fabs(distance - 1.5f) < 1e-6f && normal[2] == 1.0f);
+
+    cout << "Heightfield test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <random>
+
+#include "MeshOptimizer.hpp"
+
+using namespace My;
+using namespace std;
+
+using Triangle = array<uint32_t, 3>;
+using TrianglePositions = array<float, 9>;
+
+// triangles expressed by their vertex positions, rotated so that the
+// smallest vertex comes first (winding is preserved) and sorted, so the
+// result is independent of both triangle and vertex order
+static vector<TrianglePositions> triangles_of(
+    const vector<uint32_t>& indices, const vector<Vector3f>& positions) {
+    vector<TrianglePositions> result;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        TrianglePositions best;
+        for (int r = 0; r < 3; r++) {
+            TrianglePositions t;
+            for (int k = 0; k < 3; k++) {
+                const auto& p = positions[indices[i + (k + r) % 3]];
+                t[k * 3 + 0] = p[0];
+                t[k * 3 + 1] = p[1];
+                t[k * 3 + 2] = p[2];
+            }
+            if (r == 0 || t < best) best = t;
+        }
+        result.push_back(best);
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+// a uv sphere, facing inward when radius is negative
+static void append_sphere(vector<Vector3f>& positions,
+                          vector<uint32_t>& indices, float radius,
+                          uint32_t segments, uint32_t rings) {
+    const auto base = static_cast<uint32_t>(positions.size());
+    for (uint32_t r = 0; r <= rings; r++) {
+        const float theta = static_cast<float>(PI) * r / rings;
+        for (uint32_t s = 0; s <= segments; s++) {
+            const float phi = static_cast<float>(TWO_PI) * s / segments;
+            positions.push_back(Vector3f({sin(theta) * cos(phi),
+                                          sin(theta) * sin(phi), cos(theta)}) *
+                                radius);
+        }
+    }
+
+    auto vertex = [&](uint32_t r, uint32_t s) {
+        return base + r * (segments + 1) + s;
+    };
+    // the triangles touching a pole with two vertices are degenerate
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            if (r + 1 < rings) {
+                indices.insert(indices.end(), {vertex(r, s), vertex(r + 1, s),
+                                               vertex(r + 1, s + 1)});
+            }
+            if (r > 0) {
+                indices.insert(indices.end(),
+                               {vertex(r, s), vertex(r + 1, s + 1),
+                                vertex(r, s + 1)});
+            }
+        }
+    }
+}
+
+// how much the triangle faces away from the mesh center at the origin
+static float outward(const vector<uint32_t>& indices,
+                     const vector<Vector3f>& positions, size_t triangle) {
+    const auto& p0 = positions[indices[triangle * 3 + 0]];
+    const auto& p1 = positions[indices[triangle * 3 + 1]];
+    const auto& p2 = positions[indices[triangle * 3 + 2]];
+    Vector3f n;
+    CrossProduct(n, p1 - p0, p2 - p0);
+    float d;
+    DotProduct(d, p0 + p1 + p2, n);
+    return d;
+}
+
+// a hollow ball: an outer sphere facing outward around a smaller one facing
+// inward, so that the outer shell occludes the inner one from any viewpoint
+static void overdraw_test() {
+    const float threshold = 1.05f;
+
+    vector<Vector3f> positions;
+    vector<uint32_t> indices;
+    append_sphere(positions, indices, 1.0f, 32, 16);
+    const size_t outer_triangles = indices.size() / 3;
+    append_sphere(positions, indices, -0.5f, 32, 16);
+    const size_t triangles_count = indices.size() / 3;
+
+    // start with the inner shell, the order overdraw ordering must undo
+    rotate(indices.begin(), indices.begin() + outer_triangles * 3,
+           indices.end());
+
+    OptimizeVertexCache(indices, positions.size());
+    const auto before = AnalyzeVertexCache(indices, positions.size());
+
+    OptimizeOverdraw(indices, positions.data(), positions.size(), threshold);
+    const auto after = AnalyzeVertexCache(indices, positions.size());
+    cout << "Overdraw: ACMR = " << before.acmr << " -> " << after.acmr << endl;
+
+    assert(indices.size() == triangles_count * 3);
+    assert(after.acmr <= before.acmr * threshold);
+
+    // the outward facing clusters are drawn first
+    size_t outward_first = 0;
+    for (size_t i = 0; i < outer_triangles; i++) {
+        if (outward(indices, positions, i) > 0.0f) outward_first++;
+    }
+    cout << "Outward facing first: " << outward_first << " of "
+         << outer_triangles << endl;
+    assert(outward_first == outer_triangles);
+}
+
+int main(int argc, char** argv) {
+    int grid_size = 64;
+
+    if (argc > 1) {
+        grid_size = atoi(argv[1]);
+    }
+
+    // a regular grid, emitted as independent quads so that every
+    // interior vertex is duplicated
+    vector<Vector3f> positions;
+    vector<uint32_t> indices;
+    for (int y = 0; y < grid_size; y++) {
+        for (int x = 0; x < grid_size; x++) {
+            auto base = static_cast<uint32_t>(positions.size());
+            positions.push_back({(float)x, (float)y, 0.0f});
+            positions.push_back({(float)x + 1, (float)y, 0.0f});
+            positions.push_back({(float)x + 1, (float)y + 1, 0.0f});
+            positions.push_back({(float)x, (float)y + 1, 0.0f});
+            indices.insert(indices.end(),
+                           {base, base + 1, base + 2, base, base + 2, base + 3});
+        }
+    }
+
+    // shuffle the triangles to get a bad cache behavior
+    {
+        default_random_engine generator;
+        generator.seed(1);
+        vector<Triangle> tris;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            tris.push_back({indices[i], indices[i + 1], indices[i + 2]});
+        }
+        shuffle(tris.begin(), tris.end(), generator);
+        indices.clear();
+        for (const auto& t : tris) {
+            indices.insert(indices.end(), t.begin(), t.end());
+        }
+    }
+
+    const auto reference = triangles_of(indices, positions);
+    auto vertex_count = positions.size();
+
+    auto before = AnalyzeVertexCache(indices, vertex_count);
+    cout << "Before: " << vertex_count << " vertices, ACMR = " << before.acmr
+         << ", ATVR = " << before.atvr << endl;
+
+    // weld
+    vector<uint32_t> remap;
+    auto welded = GenerateVertexRemap(
+        remap, indices, vertex_count,
+        {{positions.data(), sizeof(Vector3f)}});
+    vector<Vector3f> welded_positions(welded);
+    RemapVertexBuffer(welded_positions.data(), positions.data(), vertex_count,
+                      sizeof(Vector3f), remap);
+    RemapIndexBuffer(indices, remap);
+    positions.swap(welded_positions);
+    vertex_count = welded;
+    assert(vertex_count == (size_t)(grid_size + 1) * (grid_size + 1));
+
+    auto after_weld = AnalyzeVertexCache(indices, vertex_count);
+    cout << "Welded: " << vertex_count << " vertices, ACMR = "
+         << after_weld.acmr << ", ATVR = " << after_weld.atvr << endl;
+
+    OptimizeVertexCache(indices, vertex_count);
+    auto after_cache = AnalyzeVertexCache(indices, vertex_count);
+    cout << "Vertex cache: ACMR = " << after_cache.acmr
+         << ", ATVR = " << after_cache.atvr << endl;
+    assert(after_cache.acmr < after_weld.acmr);
+    assert(after_cache.acmr < 1.0f);
+
+    auto fetched = OptimizeVertexFetchRemap(remap, indices, vertex_count);
+    assert(fetched == vertex_count);
+    vector<Vector3f> fetched_positions(fetched);
+    RemapVertexBuffer(fetched_positions.data(), positions.data(), vertex_count,
+                      sizeof(Vector3f), remap);
+    RemapIndexBuffer(indices, remap);
+    positions.swap(fetched_positions);
+
+    // vertex order should now follow the first use in index buffer
+    {
+        uint32_t next = 0;
+        for (const auto& index : indices) {
+            assert(index <= next);
+            if (index == next) next++;
+        }
+    }
+
+    // and the set of triangles must not change
+    assert(triangles_of(indices, positions) == reference);
+    cout << "Triangles preserved: " << indices.size() / 3 << endl;
+
+    overdraw_test();
+
+    return 0;
+}
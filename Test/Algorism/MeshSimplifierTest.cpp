@@ -0,0 +1,91 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "MeshSimplifier.hpp"
+#include "TestMesh.hpp"
+
+using namespace My;
+using namespace std;
+
+int main(int argc, char** argv) {
+    // roughly the size of viking_room.obj (~4k triangles)
+    uint32_t segments = 64;
+
+    if (argc > 1) {
+        segments = atoi(argv[1]);
+    }
+
+    vector<Vector3f> positions;
+    vector<uint32_t> indices;
+    generate_sphere(positions, indices, segments, segments / 2);
+
+    cout << "Source: " << positions.size() << " vertices, "
+         << indices.size() / 3 << " triangles" << endl;
+
+    const float target_error = 0.05f;
+    float lod_errors[4] = {0.0f};
+    vector<uint32_t> lod = indices;
+
+    for (int i = 1; i < 4; i++) {
+        vector<uint32_t> result;
+        float error;
+
+        auto start = chrono::steady_clock::now();
+        SimplifyMesh(result, lod, positions.data(), positions.size(),
+                     lod.size() / 2, target_error - lod_errors[i - 1], &error);
+        auto end = chrono::steady_clock::now();
+
+        cout << "LOD " << i << ": " << result.size() / 3 << " triangles, error "
+             << error << ", "
+             << chrono::duration<double, milli>(end - start).count() << " ms"
+             << endl;
+
+        assert(result.size() % 3 == 0);
+        assert(result.size() < lod.size());
+        // each LOD is simplified from the previous one, its deviation from
+        // the source is bounded by the sum of the steps
+        lod_errors[i] = lod_errors[i - 1] + error;
+        assert(lod_errors[i] <= target_error);
+        for (const auto& index : result) {
+            assert(index < positions.size());
+        }
+
+        lod.swap(result);
+    }
+
+    // nothing should happen when the error budget is zero on a curved mesh
+    {
+        vector<uint32_t> result;
+        SimplifyMesh(result, indices, positions.data(), positions.size(), 0,
+                     0.0f);
+        assert(result.size() == indices.size());
+    }
+
+    // a collapse may remove fewer triangles than are left above the target
+    {
+        vector<uint32_t> result;
+        SimplifyMesh(result, lod, positions.data(), positions.size(),
+                     lod.size() - 3, 1.0f);
+        assert(result.size() >= lod.size() - 6);
+        assert(result.size() < lod.size());
+    }
+
+    // screen space error selection: closer objects get finer LODs
+    const float fov = static_cast<float>(PI) / 3.0f;
+    uint32_t previous = 0;
+    for (float distance = 1.0f; distance < 10000.0f; distance *= 2.0f) {
+        auto selected =
+            SelectLodByScreenSpaceError(lod_errors, 4, distance, fov, 1080.0f,
+                                        1.0f);
+        cout << "distance " << distance << " -> LOD " << selected << endl;
+        assert(selected >= previous);
+        previous = selected;
+    }
+    assert(SelectLodByScreenSpaceError(lod_errors, 4, 0.1f, fov, 1080.0f,
+                                       1.0f) == 0);
+    assert(previous == 3);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "MeshOptimizer.hpp"
+#include "Meshlet.hpp"
+#include "TestMesh.hpp"
+
+using namespace My;
+using namespace std;
+
+int main(int argc, char** argv) {
+    uint32_t segments = 128;
+
+    if (argc > 1) {
+        segments = atoi(argv[1]);
+    }
+
+    vector<Vector3f> positions;
+    vector<uint32_t> indices;
+    generate_sphere(positions, indices, segments, segments / 2);
+    OptimizeVertexCache(indices, positions.size());
+
+    vector<Meshlet> meshlets;
+    vector<uint32_t> meshlet_vertices;
+    vector<uint8_t> meshlet_triangles;
+    BuildMeshlets(meshlets, meshlet_vertices, meshlet_triangles, indices,
+                  positions.size());
+
+    cout << indices.size() / 3 << " triangles split into " << meshlets.size()
+         << " meshlets" << endl;
+
+    size_t triangles = 0;
+    vector<MeshletBounds> bounds;
+    for (const auto& meshlet : meshlets) {
+        assert(meshlet.vertex_count <= kMeshletMaxVertices);
+        assert(meshlet.triangle_count <= kMeshletMaxTriangles);
+        triangles += meshlet.triangle_count;
+
+        auto b = ComputeMeshletBounds(meshlet, meshlet_vertices,
+                                      meshlet_triangles, positions.data());
+        for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+            const auto& v = positions[meshlet_vertices[meshlet.vertex_offset + i]];
+            assert(Length(v - b.center) <= b.radius * 1.0001f);
+        }
+        bounds.push_back(b);
+    }
+    assert(triangles == indices.size() / 3);
+
+    vector<uint32_t> flat;
+    vector<MeshletIndexRange> ranges;
+    FlattenMeshlets(flat, ranges, meshlets, meshlet_vertices,
+                    meshlet_triangles);
+    assert(flat == indices);
+
+    // camera in front of the sphere, looking at it
+    Matrix4X4f view, projection;
+    Vector3f camera = {0.0f, -5.0f, 0.0f};
+    BuildViewRHMatrix(view, camera, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f});
+    BuildPerspectiveFovRHMatrix(projection, static_cast<float>(PI) / 3.0f,
+                                16.0f / 9.0f, 0.1f, 100.0f);
+    Frustumf frustum(view * projection);
+
+    vector<MeshletIndexRange> visible;
+    auto passed = CullMeshlets(visible, ranges, bounds, frustum, camera);
+    size_t visible_indices = 0;
+    for (const auto& range : visible) visible_indices += range.count;
+
+    cout << "Facing camera: " << passed << " meshlets, " << visible.size()
+         << " ranges, " << visible_indices / 3 << " triangles" << endl;
+    assert(passed > 0 && passed < meshlets.size());
+
+    // culling must be conservative: every front facing triangle survives
+    {
+        vector<bool> drawn(indices.size() / 3, false);
+        for (const auto& range : visible) {
+            for (uint32_t i = range.offset; i < range.offset + range.count;
+                 i += 3)
+                drawn[i / 3] = true;
+        }
+
+        for (size_t t = 0; t < drawn.size(); t++) {
+            const auto& p0 = positions[flat[t * 3 + 0]];
+            const auto& p1 = positions[flat[t * 3 + 1]];
+            const auto& p2 = positions[flat[t * 3 + 2]];
+            Vector3f n;
+            CrossProduct(n, p1 - p0, p2 - p0);
+            float d;
+            DotProduct(d, n, p0 - camera);
+            if (d < 0.0f) assert(drawn[t]);
+        }
+    }
+
+    // camera looking away from the sphere, everything is culled
+    BuildViewRHMatrix(view, camera, {0.0f, -10.0f, 0.0f}, {0.0f, 0.0f, 1.0f});
+    frustum = Frustumf(view * projection);
+    visible.clear();
+    passed = CullMeshlets(visible, ranges, bounds, frustum, camera);
+    cout << "Looking away: " << passed << " meshlets" << endl;
+    assert(passed == 0 && visible.empty());
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "My/PhysicsWorld.hpp"
+
+using namespace My;
+using namespace std;
+
+// Step time of the in-house physics world: a pile of spheres and boxes
+// dropped into a walled pit.
+//
+// usage: PhysicsWorldBenchmark [body count] [step count]
+
+int main(int argc, char** argv) {
+    const uint32_t body_count = (argc > 1) ? atoi(argv[1]) : 2000;
+    const uint32_t step_count = (argc > 2) ? atoi(argv[2]) : 300;
+
+    PhysicsWorld world;
+
+    const uint32_t row = 20;
+    const float spacing = 1.2f;
+    const float half_width = row * spacing * 0.5f;
+
+    {
+        Matrix4X4f identity;
+        BuildIdentityMatrix(identity);
+
+        CollisionShape ground;
+        ground.type = GeometryType::kPlane;
+        ground.normal = {0.0f, 0.0f, 1.0f};
+        world.CreateBody(ground, 0.0f, identity);
+
+        CollisionShape wall;
+        wall.type = GeometryType::kBox;
+        const float height = body_count / (row * row) * spacing + 2.0f;
+        for (int i = 0; i < 4; i++) {
+            const float side = (i & 1) ? 1.0f : -1.0f;
+            Matrix4X4f transform;
+            if (i < 2) {
+                wall.halfExtents = {0.5f, half_width + 1.0f, height};
+                MatrixTranslation(transform, side * (half_width + 0.5f), 0.0f,
+                                  height);
+            } else {
+                wall.halfExtents = {half_width + 1.0f, 0.5f, height};
+                MatrixTranslation(transform, 0.0f, side * (half_width + 0.5f),
+                                  height);
+            }
+            world.CreateBody(wall, 0.0f, transform);
+        }
+    }
+
+    CollisionShape sphere;
+    sphere.type = GeometryType::kSphere;
+    sphere.radius = 0.4f;
+
+    CollisionShape box;
+    box.type = GeometryType::kBox;
+    box.halfExtents = {0.4f, 0.4f, 0.4f};
+
+    for (uint32_t i = 0; i < body_count; i++) {
+        const uint32_t x = i % row;
+        const uint32_t y = (i / row) % row;
+        const uint32_t z = i / (row * row);
+
+        Matrix4X4f rotation;
+        MatrixRotationYawPitchRoll(rotation, 0.1f * i, 0.2f * i, 0.3f * i);
+        Matrix4X4f transform;
+        MatrixTranslation(transform,
+                          -half_width + (x + 0.5f) * spacing + 0.05f * (z & 1),
+                          -half_width + (y + 0.5f) * spacing,
+                          1.0f + z * spacing);
+        transform = rotation * transform;
+
+        world.CreateBody((i & 1) ? box : sphere, 1.0f, transform);
+    }
+
+    vector<double> step_times;
+    step_times.reserve(step_count);
+    size_t max_contacts = 0;
+
+    for (uint32_t i = 0; i < step_count; i++) {
+        auto start = chrono::steady_clock::now();
+        world.Step(world.GetFixedTimeStep());
+        auto end = chrono::steady_clock::now();
+
+        step_times.push_back(
+            chrono::duration<double, milli>(end - start).count());
+        max_contacts = max(max_contacts, world.GetContactCount());
+    }
+
+    // bodies which went through the ground or the walls
+    size_t escaped = 0;
+    const auto& bodies = world.GetBodies();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (bodies.inverseMass[i] == 0.0f) continue;
+        const auto& p = bodies.position[i];
+        if (p[2] < 0.0f || fabs(p[0]) > half_width || fabs(p[1]) > half_width) {
+            escaped++;
+        }
+    }
+
+    double total = 0.0;
+    for (const auto& t : step_times) total += t;
+    sort(step_times.begin(), step_times.end());
+
+    cout << "Bodies: " << body_count << " Steps: " << step_count << endl;
+    cout << "Average: " << total / step_count << " ms/step" << endl;
+    cout << "Median:  " << step_times[step_count / 2] << " ms/step" << endl;
+    cout << "Max:     " << step_times.back() << " ms/step" << endl;
+    cout << "Contacts: " << world.GetContactCount() << " (max "
+         << max_contacts << ")" << endl;
+    cout << "Escaped bodies: " << escaped << endl;
+
+    return escaped ? -1 : 0;
+}
@@ -0,0 +1,658 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "My/PhysicsWorld.hpp"
+
+using namespace My;
+using namespace std;
+
+static CollisionShape make_sphere(float radius) {
+    CollisionShape shape;
+    shape.type = GeometryType::kSphere;
+    shape.radius = radius;
+    return shape;
+}
+
+static CollisionShape make_box(float x, float y, float z) {
+    CollisionShape shape;
+    shape.type = GeometryType::kBox;
+    shape.halfExtents = {x, y, z};
+    return shape;
+}
+
+// a box given as a convex hull
+static CollisionShape make_hull_box(float x, float y, float z) {
+    auto hull = make_shared<ConvexHullSupport<float>>();
+    for (int i = 0; i < 8; i++) {
+        hull->vertices.push_back(
+            {(i & 1) ? x : -x, (i & 2) ? y : -y, (i & 4) ? z : -z});
+    }
+    const uint32_t faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+                                  {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+    for (const auto& face : faces) hull->AddFace(face, 4);
+
+    CollisionShape shape;
+    shape.type = GeometryType::kPolyhydron;
+    shape.hull = std::move(hull);
+    return shape;
+}
+
+static CollisionShape make_ground() {
+    CollisionShape shape;
+    shape.type = GeometryType::kPlane;
+    shape.normal = {0.0f, 0.0f, 1.0f};
+    shape.intercept = 0.0f;
+    return shape;
+}
+
+static Matrix4X4f translation(float x, float y, float z) {
+    Matrix4X4f result;
+    MatrixTranslation(result, x, y, z);
+    return result;
+}
+
+static void resting_test() {
+    PhysicsWorld world;
+    Matrix4X4f identity;
+    BuildIdentityMatrix(identity);
+    world.CreateBody(make_ground(), 0.0f, identity);
+
+    const auto sphere =
+        world.CreateBody(make_sphere(0.5f), 1.0f, translation(0, 0, 5.0f));
+    const auto box = world.CreateBody(make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                      translation(3.0f, 0, 2.0f));
+
+    for (int i = 0; i < 300; i++) world.Simulate(1.0f / 60.0f);
+
+    const auto sphere_transform = world.GetTransform(sphere);
+    cout << "sphere height: " << sphere_transform[3][2] << endl;
+    assert(fabs(sphere_transform[3][2] - 0.5f) < 0.02f);
+    assert(Length(world.GetLinearVelocity(sphere)) < 0.05f);
+
+    const auto box_transform = world.GetTransform(box);
+    cout << "box height: " << box_transform[3][2] << endl;
+    assert(fabs(box_transform[3][2] - 0.5f) < 0.02f);
+    // still upright
+    assert(box_transform[2][2] > 0.999f);
+    assert(world.GetContactCount() == 5);
+}
+
+static void hull_test() {
+    PhysicsWorld world;
+    Matrix4X4f identity;
+    BuildIdentityMatrix(identity);
+    world.CreateBody(make_ground(), 0.0f, identity);
+
+    const auto hull = world.CreateBody(make_hull_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                       translation(0, 0, 1.0f));
+    const auto sphere =
+        world.CreateBody(make_sphere(0.25f), 1.0f, translation(0, 0, 2.5f));
+
+    for (int i = 0; i < 300; i++) world.Simulate(1.0f / 60.0f);
+
+    const auto hull_transform = world.GetTransform(hull);
+    const auto sphere_transform = world.GetTransform(sphere);
+    cout << "hull height: " << hull_transform[3][2]
+         << ", sphere on it: " << sphere_transform[3][2] << endl;
+    assert(fabs(hull_transform[3][2] - 0.5f) < 0.02f);
+    assert(hull_transform[2][2] > 0.999f);
+    assert(fabs(sphere_transform[3][2] - 1.25f) < 0.03f);
+    assert(Length(world.GetLinearVelocity(sphere)) < 0.05f);
+}
+
+static void stacking_test() {
+    PhysicsWorld world;
+    Matrix4X4f identity;
+    BuildIdentityMatrix(identity);
+    world.CreateBody(make_ground(), 0.0f, identity);
+
+    const int count = 5;
+    BodyId boxes[count];
+    for (int i = 0; i < count; i++) {
+        boxes[i] = world.CreateBody(make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                    translation(0, 0, 0.5f + i * 1.0f));
+    }
+
+    for (int i = 0; i < 600; i++) world.Simulate(1.0f / 60.0f);
+
+    for (int i = 0; i < count; i++) {
+        const auto transform = world.GetTransform(boxes[i]);
+        assert(fabs(transform[3][0]) < 0.05f);
+        assert(fabs(transform[3][1]) < 0.05f);
+        assert(fabs(transform[3][2] - (0.5f + i * 1.0f)) < 0.05f);
+    }
+    cout << "stack of " << count << " boxes is stable" << endl;
+}
+
+static void restitution_test() {
+    PhysicsWorld world;
+    world.SetGravity(Vector3f(0.0f));
+
+    const auto a = world.CreateBody(make_sphere(0.5f), 1.0f,
+                                    translation(-2.0f, 0, 0), 0.0f, 1.0f);
+    const auto b = world.CreateBody(make_sphere(0.5f), 1.0f,
+                                    translation(2.0f, 0, 0), 0.0f, 1.0f);
+    world.SetLinearVelocity(a, {4.0f, 0.0f, 0.0f});
+
+    for (int i = 0; i < 60; i++) world.Simulate(1.0f / 60.0f);
+
+    // equal masses exchange their velocities in an elastic collision
+    const auto va = world.GetLinearVelocity(a);
+    const auto vb = world.GetLinearVelocity(b);
+    cout << "velocities after impact: " << va[0] << " " << vb[0] << endl;
+    assert(fabs(va[0]) < 0.1f);
+    assert(fabs(vb[0] - 4.0f) < 0.1f);
+}
+
+static void force_test() {
+    PhysicsWorld world;
+    world.SetGravity(Vector3f(0.0f));
+
+    const auto body =
+        world.CreateBody(make_sphere(0.5f), 2.0f, translation(0, 0, 0));
+
+    // 4 N on 2 kg, applied to every step of the call
+    world.ApplyCentralForce(body, {4.0f, 0.0f, 0.0f});
+    const auto steps = world.Simulate(1.0f);
+    assert(steps == 10);  // capped by the max sub steps
+    const float velocity = 10.0f / 60.0f * 2.0f;
+    assert(fabs(world.GetLinearVelocity(body)[0] - velocity) < 1e-4f);
+
+    // the force has been consumed
+    world.Simulate(1.0f / 60.0f);
+    assert(fabs(world.GetLinearVelocity(body)[0] - velocity) < 1e-4f);
+}
+
+static void fixed_step_test() {
+    PhysicsWorld world;
+    world.SetGravity({0.0f, 0.0f, -10.0f});
+    const float dt = world.GetFixedTimeStep();
+
+    const auto body =
+        world.CreateBody(make_sphere(0.5f), 1.0f, translation(0, 0, 0));
+
+    assert(world.Simulate(dt * 0.5f) == 0);
+    assert(world.Simulate(dt * 0.5f + 1e-6f) == 1);
+    assert(world.Simulate(dt * 2.5f) == 2);
+    assert(fabs(world.GetInterpolationFactor() - 0.5f) < 1e-3f);
+
+    // half way between the last two steps
+    const auto previous = -10.0f * dt * dt * (1 + 2);     // after 2 steps
+    const auto current = -10.0f * dt * dt * (1 + 2 + 3);  // after 3 steps
+    const auto interpolated = world.GetInterpolatedTransform(body)[3][2];
+    assert(fabs(interpolated - (previous + current) * 0.5f) < 1e-5f);
+
+    // all of them at once, by id
+    vector<Matrix4X4f> transforms;
+    world.GetInterpolatedTransforms(transforms);
+    assert(transforms.size() == body + 1);
+    assert(transforms[body][3][2] == interpolated);
+}
+
+static void destroy_test() {
+    PhysicsWorld world;
+
+    const auto a = world.CreateBody(make_sphere(1.0f), 1.0f, translation(1, 0, 0));
+    const auto b = world.CreateBody(make_sphere(1.0f), 1.0f, translation(2, 0, 0));
+    const auto c = world.CreateBody(make_sphere(1.0f), 1.0f, translation(3, 0, 0));
+
+    world.DestroyBody(a);
+    assert(world.GetBodyCount() == 2);
+    assert(world.GetTransform(b)[3][0] == 2.0f);
+    assert(world.GetTransform(c)[3][0] == 3.0f);
+
+    // the id is reused
+    const auto d = world.CreateBody(make_sphere(1.0f), 1.0f, translation(4, 0, 0));
+    assert(d == a);
+    assert(world.GetTransform(d)[3][0] == 4.0f);
+}
+
+// the pairs are solved in id order, the simulation must not depend on the
+// broadphase
+static void broadphase_test() {
+    Matrix4X4f final_transforms[3][20];
+    const BroadphaseType types[] = {BroadphaseType::kBruteForce,
+                                    BroadphaseType::kAabbTree,
+                                    BroadphaseType::kSweepAndPrune};
+
+    for (int t = 0; t < 3; t++) {
+        PhysicsWorld world;
+        world.SetBroadphaseType(types[t]);
+        Matrix4X4f identity;
+        BuildIdentityMatrix(identity);
+        world.CreateBody(make_ground(), 0.0f, identity);
+
+        BodyId bodies[20];
+        for (int i = 0; i < 20; i++) {
+            const auto shape =
+                (i & 1) ? make_box(0.4f, 0.4f, 0.4f) : make_sphere(0.4f);
+            bodies[i] = world.CreateBody(
+                shape, 1.0f,
+                translation(0.3f * (i % 3), 0.2f * (i % 2), 0.5f + i * 0.9f));
+        }
+
+        for (int i = 0; i < 120; i++) world.Simulate(1.0f / 60.0f);
+
+        for (int i = 0; i < 20; i++) {
+            final_transforms[t][i] = world.GetTransform(bodies[i]);
+        }
+    }
+
+    for (int t = 1; t < 3; t++) {
+        for (int i = 0; i < 20; i++) {
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    assert(final_transforms[t][i][r][c] ==
+                           final_transforms[0][i][r][c]);
+                }
+            }
+        }
+    }
+    cout << "same simulation with all the broadphases" << endl;
+}
+
+static void sleeping_test() {
+    PhysicsWorld world;
+    Matrix4X4f identity;
+    BuildIdentityMatrix(identity);
+    world.CreateBody(make_ground(), 0.0f, identity);
+
+    // a stack and a lone box, two islands
+    BodyId boxes[3];
+    for (int i = 0; i < 3; i++) {
+        boxes[i] = world.CreateBody(make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                    translation(0, 0, 0.5f + i * 1.0f));
+    }
+    const auto lone = world.CreateBody(make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                       translation(5.0f, 0, 0.5f));
+
+    for (int i = 0; i < 300; i++) world.Simulate(1.0f / 60.0f);
+    assert(world.GetIslandCount() == 2);
+    for (const auto box : boxes) assert(!world.IsAwake(box));
+    assert(!world.IsAwake(lone));
+
+    // sleeping bodies do not move and keep their contacts
+    const auto contact_count = world.GetContactCount();
+    const auto resting = world.GetTransform(boxes[2]);
+    for (int i = 0; i < 60; i++) world.Simulate(1.0f / 60.0f);
+    assert(world.GetTransform(boxes[2]) == resting);
+    assert(world.GetContactCount() == contact_count);
+
+    // a box dropped on the stack wakes all of it, not the lone box
+    const auto falling = world.CreateBody(make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                                          translation(0, 0, 4.0f));
+    for (int i = 0; i < 30; i++) world.Simulate(1.0f / 60.0f);
+    assert(world.IsAwake(falling));
+    for (const auto box : boxes) assert(world.IsAwake(box));
+    assert(!world.IsAwake(lone));
+
+    for (int i = 0; i < 300; i++) world.Simulate(1.0f / 60.0f);
+    assert(!world.IsAwake(falling));
+    assert(fabs(world.GetTransform(falling)[3][2] - 3.5f) < 0.05f);
+
+    // forces wake bodies up
+    world.ApplyCentralForce(lone, {600.0f, 0.0f, 0.0f});
+    assert(world.IsAwake(lone));
+    world.Simulate(1.0f / 60.0f);
+    assert(world.GetLinearVelocity(lone)[0] > 1.0f);
+
+    // so does removing what they rest on
+    world.DestroyBody(boxes[0]);
+    assert(world.IsAwake(boxes[1]));
+    cout << "islands fall asleep and wake up" << endl;
+}
+
+// a small ball shot at a thin wall covers twice the wall thickness and its
+// own size in one step
+static void continuous_test() {
+    for (const bool continuous : {false, true}) {
+        PhysicsWorld world;
+        world.SetGravity({0.0f, 0.0f, 0.0f});
+        world.SetContinuousCollision(continuous);
+        world.CreateBody(make_box(0.05f, 2.0f, 2.0f), 0.0f,
+                         translation(5.0f, 0, 0));
+
+        const auto ball = world.CreateBody(make_sphere(0.1f), 1.0f,
+                                           translation(0, 0, 0), 0.5f, 1.0f);
+        world.SetLinearVelocity(ball, {60.0f, 0.0f, 0.0f});
+        // a spinning box as well
+        const auto box = world.CreateBody(make_box(0.1f, 0.1f, 0.1f), 1.0f,
+                                          translation(0, 1.0f, 0));
+        world.SetLinearVelocity(box, {45.0f, 0.0f, 0.0f});
+        world.SetAngularVelocity(box, {0.0f, 0.0f, 20.0f});
+
+        for (int i = 0; i < 30; i++) world.Simulate(1.0f / 60.0f);
+
+        const float ball_x = world.GetTransform(ball)[3][0];
+        const float box_x = world.GetTransform(box)[3][0];
+        cout << (continuous ? "swept" : "discrete") << " ball at " << ball_x
+             << ", box at " << box_x << endl;
+        if (continuous) {
+            assert(ball_x < 5.0f);
+            assert(box_x < 5.0f);
+            // bounced back at full speed
+            assert(fabs(world.GetLinearVelocity(ball)[0] + 60.0f) < 0.5f);
+        } else {
+            assert(ball_x > 5.0f);
+        }
+    }
+}
+
+// a pyramid large enough to be split into batches, simulated with different
+// thread counts
+static void deterministic_test() {
+    const int rows = 10;
+    vector<Matrix4X4f> final_transforms[3];
+    JobSystem no_workers(0);
+    JobSystem workers(3);
+    JobSystem* job_systems[] = {nullptr, &no_workers, &workers};
+
+    for (int t = 0; t < 3; t++) {
+        PhysicsWorld world;
+        world.SetDeterministic(true);
+        world.SetJobSystem(job_systems[t]);
+        Matrix4X4f identity;
+        BuildIdentityMatrix(identity);
+        world.CreateBody(make_ground(), 0.0f, identity);
+
+        vector<BodyId> bodies;
+        for (int row = 0; row < rows; row++) {
+            for (int i = 0; i < rows - row; i++) {
+                const float x = (i - 0.5f * (rows - row - 1)) * 1.02f;
+                bodies.push_back(world.CreateBody(
+                    make_box(0.5f, 0.5f, 0.5f), 1.0f,
+                    translation(x, 0, 0.5f + row * 1.0f)));
+            }
+        }
+        // and a few spheres thrown in
+        for (int i = 0; i < 8; i++) {
+            bodies.push_back(world.CreateBody(
+                make_sphere(0.3f), 1.0f, translation(-8.0f, i * 0.1f, 2.0f)));
+            world.SetLinearVelocity(bodies.back(), {10.0f, 0.0f, 1.0f});
+        }
+
+        for (int i = 0; i < 120; i++) world.Simulate(1.0f / 60.0f);
+        assert(world.GetIslandCount() < bodies.size());
+
+        for (const auto body : bodies) {
+            final_transforms[t].push_back(world.GetTransform(body));
+        }
+    }
+
+    for (int t = 1; t < 3; t++) {
+        assert(memcmp(final_transforms[t].data(), final_transforms[0].data(),
+                      final_transforms[0].size() * sizeof(Matrix4X4f)) == 0);
+    }
+    cout << "same simulation with 1 and 4 threads" << endl;
+}
+
+static bool near(float a, float b, float tolerance = 1e-3f) {
+    return fabs(a - b) <= tolerance;
+}
+
+// rays, overlaps and sweeps with known answers, the same whatever the
+// broadphase and the number of threads
+static void query_test() {
+    const BroadphaseType types[] = {BroadphaseType::kBruteForce,
+                                    BroadphaseType::kAabbTree,
+                                    BroadphaseType::kSweepAndPrune};
+    JobSystem job_system(3);
+    vector<BodyId> random_hits[4];
+
+    for (int run = 0; run < 4; run++) {
+        PhysicsWorld world;
+        world.SetBroadphaseType(types[run % 3]);
+        if (run == 3) world.SetJobSystem(&job_system);
+
+        Matrix4X4f identity;
+        BuildIdentityMatrix(identity);
+        const BodyId ground = world.CreateBody(make_ground(), 0.0f, identity);
+        const BodyId box = world.CreateBody(make_box(1.0f, 1.0f, 1.0f), 0.0f,
+                                            translation(0.0f, 0.0f, 1.0f));
+        const BodyId sphere = world.CreateBody(
+            make_sphere(0.5f), 0.0f, translation(5.0f, 0.0f, 0.5f));
+        const BodyId hull =
+            world.CreateBody(make_hull_box(1.0f, 1.0f, 1.0f), 0.0f,
+                             translation(-5.0f, 0.0f, 1.0f));
+        // falls to the ground, found where it rests
+        const BodyId ball = world.CreateBody(make_sphere(0.5f), 1.0f,
+                                             translation(0.0f, 5.0f, 3.0f));
+        for (int i = 0; i < 120; i++) world.Simulate(1.0f / 60.0f);
+
+        const RayQuery rays[] = {
+            {{0.0f, 0.0f, 10.0f}, {0.0f, 0.0f, -1.0f}, 20.0f},
+            {{-10.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, 100.0f},
+            {{5.0f, -10.0f, 0.5f}, {0.0f, 1.0f, 0.0f}, 100.0f},
+            {{20.0f, 20.0f, 5.0f}, {1.0f, 0.0f, 0.0f}, 100.0f},
+            {{20.0f, 20.0f, 5.0f}, {0.0f, 0.0f, -1.0f}, 3.0f},
+            {{0.0f, 0.0f, 10.0f}, {0.0f, 0.0f, -1.0f}, 20.0f, box},
+            {{0.0f, 5.0f, 10.0f}, {0.0f, 0.0f, -1.0f}, 20.0f},
+            {{0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, 20.0f},
+        };
+        QueryHit hits[8];
+        world.CastRays(rays, 8, hits);
+        assert(hits[0].id == box && near(hits[0].distance, 8.0f));
+        assert(near(hits[0].normal[2], 1.0f) && near(hits[0].point[2], 2.0f));
+        assert(hits[1].id == hull && near(hits[1].distance, 4.0f));
+        assert(near(hits[1].normal[0], -1.0f));
+        assert(hits[2].id == sphere && near(hits[2].distance, 9.5f));
+        assert(near(hits[2].normal[1], -1.0f));
+        assert(hits[3].id == kInvalidBodyId);
+        assert(hits[4].id == kInvalidBodyId);
+        assert(hits[5].id == ground && near(hits[5].distance, 10.0f));
+        assert(hits[6].id == ball && near(hits[6].distance, 9.0f, 2e-2f));
+        // from the inside
+        assert(hits[7].id == box && hits[7].distance == 0.0f);
+
+        ShapeQuery shapes[2];
+        shapes[0].shape = make_sphere(1.0f);
+        shapes[0].position = {0.0f, 0.0f, 2.5f};
+        shapes[1].shape = make_box(10.0f, 10.0f, 0.5f);
+        shapes[1].position = {0.0f, 0.0f, 0.25f};
+        shapes[1].ignored = sphere;
+        BodyId ids[2 * 3];
+        uint32_t counts[2];
+        world.OverlapShapes(shapes, 2, ids, 3, counts);
+        assert(counts[0] == 1 && ids[0] == box);
+        // ground, box, hull and ball, the first three kept
+        assert(counts[1] == 3);
+        assert(ids[3] == ground && ids[4] == box && ids[5] == hull);
+
+        SweepQuery sweeps[3];
+        sweeps[0].shape = make_sphere(0.5f);
+        sweeps[0].position = {-10.0f, 0.0f, 1.0f};
+        sweeps[0].direction = {1.0f, 0.0f, 0.0f};
+        sweeps[0].maxDistance = 100.0f;
+        sweeps[1].shape = make_box(0.5f, 0.5f, 0.5f);
+        sweeps[1].position = {0.2f, 0.1f, 10.0f};
+        sweeps[1].direction = {0.0f, 0.0f, -1.0f};
+        sweeps[1].maxDistance = 20.0f;
+        sweeps[2] = sweeps[1];
+        sweeps[2].position = {0.0f, 0.0f, 2.2f};
+        QueryHit sweep_hits[3];
+        world.SweepShapes(sweeps, 3, sweep_hits);
+        assert(sweep_hits[0].id == hull);
+        assert(near(sweep_hits[0].distance, 3.5f, 2e-3f));
+        assert(near(sweep_hits[0].normal[0], -1.0f, 1e-2f));
+        assert(near(sweep_hits[0].point[0], -6.0f, 2e-3f));
+        assert(sweep_hits[1].id == box);
+        assert(near(sweep_hits[1].distance, 7.5f, 2e-3f));
+        assert(near(sweep_hits[1].normal[2], 1.0f, 1e-2f));
+        assert(sweep_hits[2].id == box && sweep_hits[2].distance == 0.0f);
+
+        // many rays in all directions
+        const size_t ray_count = 10000;
+        vector<RayQuery> random_rays(ray_count);
+        uint32_t seed = 1;
+        auto random = [&seed] {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+        };
+        for (auto& ray : random_rays) {
+            ray.origin = {random() * 10.0f, random() * 10.0f,
+                          3.0f + random() * 2.0f};
+            Vector3f direction = {random(), random(), random()};
+            ray.direction = direction * (1.0f / Length(direction));
+            ray.maxDistance = 30.0f;
+        }
+        vector<QueryHit> random_results(ray_count);
+        auto start = chrono::steady_clock::now();
+        world.CastRays(random_rays.data(), ray_count, random_results.data());
+        auto end = chrono::steady_clock::now();
+        cout << ray_count << " rays in "
+             << chrono::duration<double, milli>(end - start).count() << " ms"
+             << endl;
+        for (const auto& hit : random_results) {
+            random_hits[run].push_back(hit.id);
+        }
+    }
+
+    for (int run = 1; run < 4; run++) {
+        assert(random_hits[run] == random_hits[0]);
+    }
+    cout << "same query results with all the broadphases" << endl;
+}
+
+// egg crate hills, bodies dropped into the hollows settle on the surface
+// instead of sinking in, rays and sweeps stop on it
+static void terrain_test() {
+    const uint32_t columns = 65;
+    const uint32_t rows = 65;
+    const float spacing = 0.5f;
+    // terrain space to world
+    const float offset = -16.0f;
+    vector<float> heights(columns * rows);
+    for (uint32_t r = 0; r < rows; r++) {
+        for (uint32_t c = 0; c < columns; c++) {
+            const float x = c * spacing + offset;
+            const float y = r * spacing + offset;
+            heights[r * columns + c] = 1.5f * sin(0.25f * x) * cos(0.3f * y);
+        }
+    }
+    CollisionShape terrain;
+    terrain.type = GeometryType::kHeightfield;
+    terrain.heightfield = make_shared<Heightfield>(columns, rows,
+                                                   heights.data(), spacing,
+                                                   spacing);
+    auto surface = [&](float x, float y) {
+        float height;
+        assert(terrain.heightfield->GetSurfaceHeight(x - offset, y - offset,
+                                                     height));
+        return height;
+    };
+
+    PhysicsWorld world;
+    const BodyId ground =
+        world.CreateBody(terrain, 0.0f, translation(offset, offset, 0.0f));
+
+    // hollows at (-2 pi / 0.25, 0) and (2 pi / 0.25, +-pi / 0.3)
+    const float hollows[3][2] = {{-2.0f * PI, 0.0f},
+                                 {2.0f * PI, PI / 0.3f},
+                                 {2.0f * PI, -PI / 0.3f}};
+    // spheres with their radius
+    vector<pair<BodyId, float>> spheres;
+    vector<BodyId> boxes;
+    for (int i = 0; i < 12; i++) {
+        const float x = hollows[i % 3][0] + 0.6f * (i / 3) - 0.9f;
+        const float y = hollows[i % 3][1] + 0.4f * (i % 4) - 0.6f;
+        const auto start = translation(x, y, surface(x, y) + 1.0f + 0.3f * i);
+        if (i % 2) {
+            spheres.emplace_back(
+                world.CreateBody(make_sphere(0.3f), 1.0f, start), 0.3f);
+        } else {
+            const auto shape = (i % 4) ? make_hull_box(0.3f, 0.3f, 0.3f)
+                                       : make_box(0.3f, 0.3f, 0.3f);
+            boxes.push_back(world.CreateBody(shape, 1.0f, start));
+        }
+    }
+    // fast enough to go through the terrain in one step, clear of the rest
+    const BodyId bullet = world.CreateBody(
+        make_sphere(0.1f), 1.0f,
+        translation(hollows[0][0] - 0.15f, 0.0f, 10.0f));
+    world.SetLinearVelocity(bullet, {0.0f, 0.0f, -200.0f});
+    spheres.emplace_back(bullet, 0.1f);
+
+    for (int i = 0; i < 360; i++) world.Simulate(1.0f / 60.0f);
+
+    auto height = [&](BodyId id) {
+        const auto transform = world.GetTransform(id);
+        return transform[3][2] - surface(transform[3][0], transform[3][1]);
+    };
+    // nothing stops the spheres rolling, they keep going in the hollows
+    for (const auto& [sphere, radius] : spheres) {
+        assert(height(sphere) > radius - 0.02f);
+        assert(Length(world.GetLinearVelocity(sphere)) < 1.5f);
+    }
+    for (const BodyId box : boxes) {
+        assert(height(box) > 0.25f);
+        assert(Length(world.GetLinearVelocity(box)) < 0.5f);
+    }
+    cout << "bodies rest on the terrain" << endl;
+
+    // straight down from above the hills, between the bodies
+    RayQuery rays[4];
+    for (int i = 0; i < 4; i++) {
+        rays[i].origin = {-14.0f + 7.5f * i, 13.0f - 3.0f * i, 5.0f};
+        rays[i].direction = {0.0f, 0.0f, -1.0f};
+        rays[i].maxDistance = 10.0f;
+    }
+    QueryHit hits[4];
+    world.CastRays(rays, 4, hits);
+    for (int i = 0; i < 4; i++) {
+        const auto& o = rays[i].origin;
+        assert(hits[i].id == ground);
+        assert(near(hits[i].distance, 5.0f - surface(o[0], o[1])));
+        assert(hits[i].normal[2] > 0.5f);
+    }
+
+    SweepQuery sweep;
+    sweep.shape = make_sphere(0.5f);
+    sweep.position = {10.0f, 3.0f, 4.0f};
+    sweep.direction = {0.0f, 0.0f, -1.0f};
+    sweep.maxDistance = 10.0f;
+    QueryHit sweep_hit;
+    world.SweepShapes(&sweep, 1, &sweep_hit);
+    assert(sweep_hit.id == ground);
+    // the center stops half a radius or more above the surface under it
+    const float center = 4.0f - sweep_hit.distance;
+    assert(center - surface(10.0f, 3.0f) > 0.49f);
+    assert(near(sweep_hit.point[2], surface(sweep_hit.point[0],
+                                            sweep_hit.point[1]), 1e-2f));
+
+    ShapeQuery shape;
+    shape.shape = make_box(0.5f, 0.5f, 0.5f);
+    shape.position = {10.0f, 3.0f, surface(10.0f, 3.0f) + 0.4f};
+    BodyId ids[4];
+    uint32_t count;
+    world.OverlapShapes(&shape, 1, ids, 4, &count);
+    assert(count == 1 && ids[0] == ground);
+    shape.position[2] += 2.0f;
+    world.OverlapShapes(&shape, 1, ids, 4, &count);
+    assert(count == 0);
+    cout << "queries stop on the terrain" << endl;
+}
+
+int main() {
+    resting_test();
+    hull_test();
+    stacking_test();
+    restitution_test();
+    force_test();
+    fixed_step_test();
+    destroy_test();
+    broadphase_test();
+    sleeping_test();
+    continuous_test();
+    deterministic_test();
+    query_test();
+    terrain_test();
+
+    cout << "PhysicsWorld test passed" << endl;
+
+    return 0;
+}
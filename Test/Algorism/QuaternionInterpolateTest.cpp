@@ -0,0 +1,150 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "Bezier.hpp"
+#include "Linear.hpp"
+#include "geommath.hpp"
+
+using namespace My;
+using namespace std;
+
+static bool near(float a, float b, float tolerance = 1e-4f) {
+    return fabs(a - b) < tolerance;
+}
+
+// q and -q are the same rotation
+static bool near(const Quaternion<float>& a, const Quaternion<float>& b) {
+    return QuaternionAngle(a, b) < 1e-3f;
+}
+
+static bool near(const Matrix4X4f& a, const Matrix4X4f& b) {
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            if (!near(a[r][c], b[r][c], 1e-3f)) return false;
+        }
+    }
+    return true;
+}
+
+static Matrix4X4f rotation_z(float angle, float scale, float x) {
+    Matrix4X4f rotation, scaling, translation;
+    MatrixRotationZ(rotation, angle);
+    MatrixScale(scaling, scale, scale, scale);
+    MatrixTranslation(translation, x, 1.0f, -2.0f);
+    return scaling * rotation * translation;
+}
+
+static void test_slerp() {
+    const auto a = QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, 0.0f);
+    const auto b = QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, PI / 2.0f);
+
+    // at a constant angular speed
+    for (const float s : {0.0f, 0.25f, 0.5f, 0.9f, 1.0f}) {
+        const auto q = Slerp(a, b, s);
+        assert(near(Length(q), 1.0f));
+        assert(near(q, QuaternionRotationAxis({0.0f, 0.0f, 1.0f},
+                                              s * PI / 2.0f)));
+    }
+
+    // the shorter way round whatever the sign of b
+    const auto negated = Quaternion<float>(-b);
+    const auto half = QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, PI / 4);
+    assert(near(Slerp(a, negated, 0.5f), half));
+    assert(near(Nlerp(a, negated, 0.5f), half));
+
+    // nlerp is on the same arc, only not at the same speed
+    const auto n = Nlerp(a, b, 0.25f);
+    assert(near(Length(n), 1.0f));
+    assert(near(QuaternionAngle(a, n) + QuaternionAngle(n, b), PI / 2.0f));
+    assert(!near(QuaternionAngle(a, n), PI / 8.0f));
+
+    // control points on the arc a third of the way apart make it a slerp
+    const auto c1 = Slerp(a, b, 1.0f / 3.0f);
+    const auto c2 = Slerp(a, b, 2.0f / 3.0f);
+    for (const float s : {0.0f, 0.3f, 0.5f, 1.0f}) {
+        assert(near(QuaternionBezier(a, c1, c2, b, s), Slerp(a, b, s)));
+    }
+}
+
+static void test_quaternion_curves() {
+    const Vector3f x_axis = {1.0f, 0.0f, 0.0f};
+    const Vector3f y_axis = {0.0f, 1.0f, 0.0f};
+    const Vector3f z_axis = {0.0f, 0.0f, 1.0f};
+    const Quaternion<float> knots[] = {QuaternionRotationAxis(x_axis, 0.0f),
+                                       QuaternionRotationAxis(x_axis, 1.0f),
+                                       QuaternionRotationAxis(y_axis, 1.0f)};
+    Linear<Quaternion<float>, float> linear(knots, 3);
+    assert(near(linear.Interpolate(0.5f, 1),
+                QuaternionRotationAxis(x_axis, 0.5f)));
+    assert(near(linear.Interpolate(0.5f, 0), knots[0]));
+    assert(near(linear.Interpolate(0.5f, 3), knots[2]));
+
+    // back to where it was interpolated from
+    size_t index = 0;
+    const auto q = linear.Interpolate(0.3f, 2);
+    const float s = linear.Reverse(q, index);
+    assert(index == 2 && near(s, 0.3f, 1e-3f));
+
+    // from knot to knot, leaving along the control points
+    const Quaternion<float> incoming[] = {knots[0],
+                                          QuaternionRotationAxis(x_axis, 0.8f),
+                                          QuaternionRotationAxis(y_axis, 0.8f)};
+    const Quaternion<float> outgoing[] = {QuaternionRotationAxis(z_axis, 0.3f),
+                                          QuaternionRotationAxis(x_axis, 1.2f),
+                                          knots[2]};
+    Bezier<Quaternion<float>, float> bezier(knots, incoming, outgoing, 3);
+    assert(near(bezier.Interpolate(0.0f, 1), knots[0]));
+    assert(near(bezier.Interpolate(1.0f, 1), knots[1]));
+    assert(near(bezier.Interpolate(1.0f, 2), knots[2]));
+    const auto early = bezier.Interpolate(0.01f, 1);
+    assert(QuaternionAngle(early, Slerp(knots[0], outgoing[0], 0.03f)) <
+           QuaternionAngle(early, Slerp(knots[0], knots[1], 0.03f)));
+}
+
+static void test_matrix_curves() {
+    // the rotation back out as a quaternion, mirrors too
+    for (const float scale : {1.5f, -1.0f}) {
+        const auto matrix = rotation_z(0.7f, scale, 3.0f);
+        Quaternion<float> rotation;
+        Vector3f scalar, translation;
+        Matrix4X4fDecompose(matrix, rotation, scalar, translation);
+        Matrix4X4f composed;
+        Matrix4X4fCompose(composed, rotation, scalar, translation);
+        assert(near(composed, matrix));
+    }
+
+    // from nearly half a turn one way to nearly half a turn the other, the
+    // rotation goes through half a turn rather than back through 0
+    Linear<Matrix4X4f, float> linear(
+        vector<Matrix4X4f>({rotation_z(3.0f, 1.0f, 0.0f),
+                            rotation_z(-3.0f, 3.0f, 2.0f)}));
+    assert(near(linear.Interpolate(0.5f, 1), rotation_z(PI, 2.0f, 1.0f)));
+
+    size_t index = 0;
+    const float s = linear.Reverse(linear.Interpolate(0.0f, 1), index);
+    assert(index == 1 && near(s, 0.0f, 1e-3f));
+
+    const vector<Matrix4X4f> knots = {rotation_z(0.0f, 1.0f, 0.0f),
+                                      rotation_z(1.0f, 2.0f, 1.0f)};
+    Bezier<Matrix4X4f, float> bezier(
+        knots, {knots[0], rotation_z(0.7f, 1.8f, 0.8f)},
+        {rotation_z(0.3f, 1.2f, 0.2f), knots[1]});
+    assert(near(bezier.Interpolate(0.0f, 1), knots[0]));
+    assert(near(bezier.Interpolate(1.0f, 1), knots[1]));
+    Quaternion<float> rotation;
+    Vector3f scalar, translation;
+    Matrix4X4fDecompose(bezier.Interpolate(0.5f, 1), rotation, scalar,
+                        translation);
+    assert(near(scalar[0], 1.5f, 1e-3f) && near(translation[0], 0.5f, 1e-3f));
+}
+
+int main() {
+    test_slerp();
+    test_quaternion_curves();
+    test_matrix_curves();
+
+    cout << "Quaternion interpolate test passed" << endl;
+
+    return 0;
+}
@@ -40,6 +40,12 @@ static void getOpenALFormat(ALenum& out_format, My::AudioClipFormat in_format) {
         case My::AudioClipFormat::STEREO_16:
             out_format = AL_FORMAT_STEREO16;
             break;
+        case My::AudioClipFormat::MONO_FLOAT32:
+            out_format = AL_FORMAT_MONO_FLOAT32;
+            break;
+        case My::AudioClipFormat::STEREO_FLOAT32:
+            out_format = AL_FORMAT_STEREO_FLOAT32;
+            break;
         default:
             assert(0);
     }
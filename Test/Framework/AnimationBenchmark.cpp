@@ -0,0 +1,210 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Bezier.hpp"
+#include "CompiledAnimationClip.hpp"
+#include "Linear.hpp"
+
+using namespace My;
+using namespace std;
+
+// Per-frame cost of playing one clip of many tracks through
+// SceneObjectAnimationClip::Update() and through the compiled clip, and the
+// largest difference between the transforms the two set.
+//
+// usage: AnimationBenchmark [track count] [key count] [frame count]
+
+// a fixed sequence, the clip must be the same for every run
+static uint32_t seed = 12345;
+static float random_float(float low, float high) {
+    seed = seed * 1664525u + 1013904223u;
+    return low + (high - low) * static_cast<float>(seed >> 8) / 16777216.0f;
+}
+
+static vector<float> random_floats(size_t count, float low, float high) {
+    vector<float> values(count);
+    for (auto& value : values) value = random_float(low, high);
+    return values;
+}
+
+static vector<Vector3f> random_vectors(size_t count, float low, float high) {
+    vector<Vector3f> values(count);
+    for (auto& value : values) {
+        value = {random_float(low, high), random_float(low, high),
+                 random_float(low, high)};
+    }
+    return values;
+}
+
+// Bezier control points a little before and after each key
+static shared_ptr<CurveBase> bezier_floats(const vector<float>& knots) {
+    vector<float> incoming(knots.size()), outgoing(knots.size());
+    for (size_t i = 0; i < knots.size(); i++) {
+        const float delta = random_float(0.0f, 0.3f);
+        incoming[i] = knots[i] - delta;
+        outgoing[i] = knots[i] + delta;
+    }
+    return make_shared<Bezier<float, float>>(knots, incoming, outgoing);
+}
+
+static shared_ptr<CurveBase> bezier_vectors(const vector<Vector3f>& knots) {
+    vector<Vector3f> incoming(knots.size()), outgoing(knots.size());
+    for (size_t i = 0; i < knots.size(); i++) {
+        const Vector3f delta = {random_float(0.0f, 0.3f),
+                                random_float(0.0f, 0.3f),
+                                random_float(0.0f, 0.3f)};
+        incoming[i] = knots[i] - delta;
+        outgoing[i] = knots[i] + delta;
+    }
+    return make_shared<Bezier<Vector3f, Vector3f>>(knots, incoming, outgoing);
+}
+
+int main(int argc, char** argv) {
+    const auto track_count =
+        static_cast<uint32_t>(argc > 1 ? atoi(argv[1]) : 5000);
+    const auto key_count =
+        static_cast<uint32_t>(argc > 2 ? atoi(argv[2]) : 16);
+    const auto frame_count =
+        static_cast<uint32_t>(argc > 3 ? atoi(argv[3]) : 300);
+
+    // keys a third of a second apart on average, played at 60 fps
+    vector<float> key_times(key_count);
+    float time_point = 0.0f;
+    for (auto& key_time : key_times) {
+        key_time = time_point;
+        time_point += random_float(0.1f, 0.55f);
+    }
+    const float duration = key_times.back();
+    auto linear_time = make_shared<Linear<float, float>>(key_times);
+
+    // control points within a third of the way to the next keys, as
+    // exporters write them, the time must keep increasing for
+    // Bezier::Reverse() to converge
+    vector<float> incoming_times(key_count), outgoing_times(key_count);
+    for (uint32_t i = 0; i < key_count; i++) {
+        const float before = i > 0 ? key_times[i] - key_times[i - 1] : 0.0f;
+        const float after =
+            i + 1 < key_count ? key_times[i + 1] - key_times[i] : 0.0f;
+        incoming_times[i] = key_times[i] - random_float(0.0f, before / 3.0f);
+        outgoing_times[i] = key_times[i] + random_float(0.0f, after / 3.0f);
+    }
+    auto bezier_time = make_shared<Bezier<float, float>>(
+        key_times, incoming_times, outgoing_times);
+
+    // the kinds of tracks OGEX files have, one after the other
+    SceneObjectAnimationClip clip(0);
+    vector<shared_ptr<SceneObjectTransform>> transforms;
+    for (uint32_t i = 0; i < track_count; i++) {
+        const bool bezier = random_float(0.0f, 1.0f) < 0.5f;
+        shared_ptr<CurveBase> time =
+            bezier ? static_pointer_cast<CurveBase>(bezier_time)
+                   : static_pointer_cast<CurveBase>(linear_time);
+        shared_ptr<SceneObjectTransform> transform;
+        shared_ptr<CurveBase> value;
+        SceneObjectTrackType type;
+        switch (i % 4) {
+            case 0: {
+                transform = make_shared<SceneObjectTranslation>(
+                    static_cast<char>('x' + i % 3), 0.0f);
+                auto values = random_floats(key_count, -5.0f, 5.0f);
+                value = bezier ? bezier_floats(values)
+                               : make_shared<Linear<float, float>>(values);
+                type = SceneObjectTrackType::kScalar;
+            } break;
+            case 1: {
+                transform = make_shared<SceneObjectRotation>(
+                    static_cast<char>('x' + i % 3), 0.0f);
+                auto values = random_floats(key_count, -PI, PI);
+                value = bezier ? bezier_floats(values)
+                               : make_shared<Linear<float, float>>(values);
+                type = SceneObjectTrackType::kScalar;
+            } break;
+            case 2: {
+                transform = make_shared<SceneObjectTranslation>(0.0f, 0.0f,
+                                                                0.0f);
+                auto values = random_vectors(key_count, -5.0f, 5.0f);
+                value = bezier
+                            ? bezier_vectors(values)
+                            : make_shared<Linear<Vector3f, Vector3f>>(values);
+                type = SceneObjectTrackType::kVector3;
+            } break;
+            default: {
+                transform = make_shared<SceneObjectScale>(1.0f, 1.0f, 1.0f);
+                auto values = random_vectors(key_count, 0.5f, 2.0f);
+                value = bezier
+                            ? bezier_vectors(values)
+                            : make_shared<Linear<Vector3f, Vector3f>>(values);
+                type = SceneObjectTrackType::kVector3;
+            } break;
+        }
+        transforms.push_back(transform);
+        auto track = make_shared<SceneObjectTrack>(transform, std::move(time),
+                                                   std::move(value), type);
+        clip.AddTrack(track);
+    }
+
+    auto start = chrono::steady_clock::now();
+    CompiledAnimationClip compiled;
+    if (!compiled.Compile(clip)) {
+        cerr << "the clip could not be compiled" << endl;
+        return 1;
+    }
+    const double compile_ms = chrono::duration<double, milli>(
+                                  chrono::steady_clock::now() - start)
+                                  .count();
+
+    // looping, so the compiled clip also goes back to its first keys
+    auto frame_time = [duration](uint32_t frame) {
+        return fmod(frame / 60.0f, duration);
+    };
+
+    start = chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+        clip.Update(frame_time(frame));
+    }
+    const double reference_ms = chrono::duration<double, milli>(
+                                    chrono::steady_clock::now() - start)
+                                    .count() /
+                                frame_count;
+
+    start = chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+        compiled.Evaluate(frame_time(frame));
+    }
+    const double compiled_ms = chrono::duration<double, milli>(
+                                   chrono::steady_clock::now() - start)
+                                   .count() /
+                               frame_count;
+
+    // both at the last frame
+    vector<Matrix4X4f> expected;
+    clip.Update(frame_time(frame_count - 1));
+    for (const auto& transform : transforms) {
+        expected.push_back(static_cast<Matrix4X4f>(*transform));
+    }
+    compiled.Evaluate(frame_time(frame_count - 1));
+    float max_error = 0.0f;
+    for (size_t i = 0; i < transforms.size(); i++) {
+        const auto result = static_cast<Matrix4X4f>(*transforms[i]);
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                max_error =
+                    max(max_error, fabs(result[r][c] - expected[i][r][c]));
+            }
+        }
+    }
+
+    cout << track_count << " tracks of " << key_count << " keys, "
+         << frame_count << " frames" << endl;
+    cout << "compile:   " << compile_ms << " ms" << endl;
+    cout << "reference: " << reference_ms << " ms/frame" << endl;
+    cout << "compiled:  " << compiled_ms << " ms/frame ("
+         << reference_ms / compiled_ms << "x)" << endl;
+    cout << "max error: " << max_error << endl;
+
+    return max_error < 1e-3f ? 0 : 1;
+}
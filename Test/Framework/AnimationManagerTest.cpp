@@ -0,0 +1,171 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "AnimationManager.hpp"
+#include "BaseApplication.hpp"
+#include "Linear.hpp"
+#include "SceneManager.hpp"
+
+using namespace My;
+using namespace std;
+
+class TestSceneManager : public SceneManager {
+   public:
+    // a camera at the origin looking along y, and nodes spinning around z
+    // at each of positions
+    void CreateScene(const vector<Vector3f>& positions,
+                     vector<shared_ptr<SceneObjectTransform>>& spins) {
+        auto scene = make_shared<Scene>("animation");
+
+        auto camera = make_shared<SceneObjectPerspectiveCamera>(PI / 3.0f);
+        string near_param = "near", far_param = "far";
+        camera->SetParam(near_param, 1.0f);
+        camera->SetParam(far_param, 1000.0f);
+        scene->Cameras["camera"] = camera;
+        auto camera_node = make_shared<SceneCameraNode>("camera");
+        camera_node->AddSceneObjectRef("camera");
+        camera_node->SetTarget({0.0f, 1.0f, 0.0f});
+        scene->CameraNodes.emplace("camera", camera_node);
+        scene->SceneGraph->AppendChild(std::move(camera_node));
+
+        // one radian a second
+        auto time = make_shared<Linear<float, float>>(
+            vector<float>({0.0f, 100.0f}));
+        auto angle = make_shared<Linear<float, float>>(
+            vector<float>({0.0f, 100.0f}));
+
+        for (size_t i = 0; i < positions.size(); i++) {
+            const string name = "node_" + to_string(i);
+            auto node = make_shared<SceneGeometryNode>(name);
+            node->AppendTransform(
+                "translation",
+                make_shared<SceneObjectTranslation>(
+                    positions[i][0], positions[i][1], positions[i][2]));
+            auto spin = make_shared<SceneObjectRotation>('z', 0.0f);
+            node->AppendTransform("spin", spin);
+            spins.push_back(spin);
+
+            auto clip = make_shared<SceneObjectAnimationClip>(0);
+            auto track = make_shared<SceneObjectTrack>(
+                spin, time, angle, SceneObjectTrackType::kScalar);
+            clip->AddTrack(track);
+            node->AttachAnimationClip(0, clip);
+
+            scene->GeometryNodes.emplace(name, node);
+            scene->AnimatableNodes.push_back(node);
+            scene->SceneGraph->AppendChild(std::move(node));
+        }
+
+        m_pScene = scene;
+        m_nSceneRevision++;
+    }
+};
+
+class TestApplication : public BaseApplication {
+   public:
+    void UseJobSystem(int32_t worker_count) {
+        m_pJobSystem = make_unique<JobSystem>(worker_count);
+    }
+};
+
+static void test(bool use_job_system) {
+    TestApplication app;
+    TestSceneManager sceneManager;
+    AnimationManager animationManager;
+    app.RegisterManagerModule(&sceneManager);
+    app.RegisterManagerModule(&animationManager);
+    if (use_job_system) app.UseJobSystem(2);
+
+    // near and in view, far, behind the camera, a few of each so the
+    // clips span several jobs
+    vector<Vector3f> positions;
+    for (int i = 0; i < 20; i++) {
+        const float x = i - 10.0f;
+        positions.push_back({x, 10.0f, 0.0f});
+        positions.push_back({x, 200.0f, 0.0f});
+        positions.push_back({x, -20.0f, 0.0f});
+    }
+    vector<shared_ptr<SceneObjectTransform>> spins;
+    sceneManager.CreateScene(positions, spins);
+
+    // picks up the clips of the scene, and gives every clip its pose
+    animationManager.Initialize();
+    animationManager.Tick();
+    assert(animationManager.GetAnimationClipCount() == positions.size());
+    assert(animationManager.GetUpdatedClipCount() == positions.size());
+
+    vector<uint32_t> update_counts(positions.size(), 0);
+    const uint32_t tick_count = AnimationManager::kHiddenTickInterval * 2;
+    for (uint32_t tick = 0; tick < tick_count; tick++) {
+        vector<Matrix4X4f> before;
+        for (const auto& spin : spins) {
+            before.push_back(static_cast<Matrix4X4f>(*spin));
+        }
+
+        const float time_point = 0.5f + tick * 0.1f;
+        animationManager.Update(time_point);
+
+        Matrix4X4f expected;
+        MatrixRotationZ(expected, time_point);
+        size_t updated = 0;
+        for (size_t i = 0; i < spins.size(); i++) {
+            const auto spin = static_cast<Matrix4X4f>(*spins[i]);
+            bool changed = false;
+            bool current = true;
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    changed |= fabs(spin[r][c] - before[i][r][c]) > 1e-6f;
+                    current &= fabs(spin[r][c] - expected[r][c]) < 1e-4f;
+                }
+            }
+            // the transforms of a clip are either left alone or brought
+            // up to date
+            assert(!changed || current);
+            if (changed) {
+                update_counts[i]++;
+                updated++;
+            }
+        }
+        assert(updated == animationManager.GetUpdatedClipCount());
+    }
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        const auto lod = animationManager.GetAnimationLod(i);
+        switch (i % 3) {
+            case 0:
+                assert(lod == AnimationManager::kAnimationLodFull);
+                assert(update_counts[i] == tick_count);
+                break;
+            case 1:
+                assert(lod == AnimationManager::kAnimationLodFar);
+                assert(update_counts[i] ==
+                       tick_count / AnimationManager::kFarTickInterval);
+                break;
+            default:
+                assert(lod == AnimationManager::kAnimationLodHidden);
+                assert(update_counts[i] ==
+                       tick_count / AnimationManager::kHiddenTickInterval);
+                break;
+        }
+    }
+
+    // with the LOD distance past them the far nodes are near again
+    animationManager.SetLodDistance(1000.0f);
+    animationManager.Update(100.0f);
+    assert(animationManager.GetAnimationLod(1) ==
+           AnimationManager::kAnimationLodFull);
+
+    animationManager.Finalize();
+    assert(animationManager.GetAnimationClipCount() == 0);
+}
+
+int main() {
+    test(false);
+    test(true);
+
+    cout << "Animation manager test passed" << endl;
+
+    return 0;
+}
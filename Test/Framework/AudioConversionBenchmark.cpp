@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "PcmConversion.hpp"
+#include "Resampler.hpp"
+
+using namespace My;
+using namespace std;
+
+// Samples per second through each conversion between a sample format and
+// float, and through the resampler between common sample rates. What a clip
+// costs to normalize to the mixer format at load time.
+//
+// usage: AudioConversionBenchmark [second count] [repeat count]
+
+static const struct {
+    AudioClipFormat format;
+    const char* name;
+} kFormats[] = {{AudioClipFormat::STEREO_8, "8-bit"},
+                {AudioClipFormat::STEREO_16, "16-bit"},
+                {AudioClipFormat::STEREO_24, "24-bit"},
+                {AudioClipFormat::STEREO_32, "32-bit"},
+                {AudioClipFormat::STEREO_FLOAT32, "float"}};
+
+template <typename Function>
+static double samples_per_second(size_t sample_count, uint32_t repeat_count,
+                                 Function function) {
+    const auto start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repeat_count; r++) function();
+    const chrono::duration<double> seconds =
+        chrono::steady_clock::now() - start;
+    return static_cast<double>(sample_count) * repeat_count / seconds.count();
+}
+
+int main(int argc, char** argv) {
+    const auto second_count =
+        static_cast<uint32_t>(argc > 1 ? atoi(argv[1]) : 10);
+    const auto repeat_count =
+        static_cast<uint32_t>(argc > 2 ? atoi(argv[2]) : 10);
+
+    // stereo at 96kHz, the highest input rate, a tone and its octave
+    const uint32_t rate = 96000;
+    const size_t frame_count = static_cast<size_t>(rate) * second_count;
+    vector<float> samples(frame_count * 2);
+    for (size_t i = 0; i < frame_count; i++) {
+        const float t = static_cast<float>(i) / rate;
+        samples[i * 2] = 0.5f * sin(2.0f * 3.14159265f * 440.0f * t);
+        samples[i * 2 + 1] = 0.5f * sin(2.0f * 3.14159265f * 880.0f * t);
+    }
+
+    cout << second_count << " seconds of 96kHz stereo, " << repeat_count
+         << " times, in millions of samples per second" << endl;
+
+    vector<uint8_t> encoded(samples.size() * 4);
+    vector<float> decoded(samples.size());
+    for (const auto& format : kFormats) {
+        const auto from_float =
+            samples_per_second(samples.size(), repeat_count, [&] {
+                ConvertFromFloat(format.format, samples.data(), samples.size(),
+                                 encoded.data());
+            });
+        const auto to_float =
+            samples_per_second(samples.size(), repeat_count, [&] {
+                ConvertToFloat(format.format, encoded.data(), samples.size(),
+                               decoded.data());
+            });
+        cout << format.name << "\tto float: " << to_float / 1e6
+             << "\tfrom float: " << from_float / 1e6 << endl;
+    }
+
+    const struct {
+        uint32_t input_rate;
+        uint32_t output_rate;
+    } ratios[] = {{44100, 48000}, {48000, 44100}, {22050, 48000},
+                  {96000, 48000}};
+    vector<float> resampled;
+    for (const auto& ratio : ratios) {
+        // as many input frames as there are seconds at the input rate
+        const size_t input_frames =
+            static_cast<size_t>(ratio.input_rate) * second_count;
+        PolyphaseResampler resampler(ratio.input_rate, ratio.output_rate);
+        resampled.resize(resampler.GetOutputFrameCount(input_frames) * 2);
+        const auto output_samples =
+            samples_per_second(resampled.size(), repeat_count, [&] {
+                resampler.Process(samples.data(), input_frames, 2,
+                                  resampled.data());
+            });
+        cout << ratio.input_rate << " -> " << ratio.output_rate
+             << "\toutput: " << output_samples / 1e6 << endl;
+    }
+
+    return 0;
+}
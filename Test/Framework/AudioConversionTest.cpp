@@ -0,0 +1,207 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "PcmConversion.hpp"
+#include "Resampler.hpp"
+#include "WAVE.hpp"
+#include "geommath.hpp"
+
+using namespace My;
+using namespace std;
+
+static const AudioClipFormat kFormats[] = {
+    AudioClipFormat::MONO_8,       AudioClipFormat::STEREO_16,
+    AudioClipFormat::MONO_24,      AudioClipFormat::STEREO_24,
+    AudioClipFormat::STEREO_32,    AudioClipFormat::MONO_FLOAT32,
+    AudioClipFormat::STEREO_FLOAT32};
+
+static void test_round_trip() {
+    vector<float> samples;
+    // up to the largest 8-bit one, 127 / 128, which the others have too
+    for (int i = -1000; i <= 990; i++) samples.push_back(i / 1000.0f);
+    // clamped to the largest and smallest there are
+    samples.push_back(1.5f);
+    samples.push_back(-1.5f);
+
+    for (const auto format : kFormats) {
+        const auto bytes = GetBytesPerSample(format);
+        vector<uint8_t> encoded(samples.size() * bytes);
+        vector<float> decoded(samples.size());
+        ConvertFromFloat(format, samples.data(), samples.size(),
+                         encoded.data());
+        ConvertToFloat(format, encoded.data(), samples.size(),
+                       decoded.data());
+
+        const bool is_float = format == AudioClipFormat::MONO_FLOAT32 ||
+                              format == AudioClipFormat::STEREO_FLOAT32;
+        // half a step of the format, or of a float when that is larger
+        const float tolerance =
+            is_float ? 0.0f : max(ldexp(1.0f, -bytes * 8), ldexp(1.0f, -24));
+        for (size_t i = 0; i < samples.size() - 2; i++) {
+            assert(fabs(decoded[i] - samples[i]) <= tolerance * 1.01f);
+        }
+        if (!is_float) {
+            assert(decoded[samples.size() - 2] < 1.0f &&
+                   decoded[samples.size() - 2] > 0.99f);
+            assert(decoded[samples.size() - 1] == -1.0f);
+        }
+    }
+
+    // 24-bit ones are signed, little endian
+    const uint8_t packed[] = {0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F,
+                              0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x40};
+    float values[4];
+    ConvertToFloat(AudioClipFormat::MONO_24, packed, 4, values);
+    assert(values[0] == -1.0f);
+    assert(values[1] == 8388607.0f / 8388608.0f);
+    assert(values[2] == -1.0f / 8388608.0f);
+    assert(values[3] == 0.5f);
+}
+
+// a header and a format chunk, with a data chunk of 4 bytes
+static Buffer wave_file(uint16_t format_type, uint16_t channels,
+                        uint16_t bits, uint16_t sub_format = 0) {
+    WAVE_FORMAT_EXTENSIBLE_CHUNKHEADER format{};
+    memcpy(format.ChunkMarker, "fmt ", 4);
+    format.FormatType = format_type;
+    format.ChannelNum = channels;
+    format.SampleRate = 96000;
+    format.BlockSize = static_cast<uint16_t>(channels * bits / 8);
+    format.ByteRate = format.SampleRate * format.BlockSize;
+    format.BitsPerSample = bits;
+    size_t format_size = sizeof(WAVE_FORMAT_CHUNKHEADER);
+    if (format_type == WAVE_FORMAT_EXTENSIBLE) {
+        format.ExtensionSize = 22;
+        format.ValidBitsPerSample = bits;
+        format.SubFormat[0] = static_cast<uint8_t>(sub_format);
+        format.SubFormat[1] = static_cast<uint8_t>(sub_format >> 8);
+        format_size = sizeof(format);
+    }
+    format.ChunkSize =
+        static_cast<uint32_t>(format_size - sizeof(WAVE_CHUNKHEADER));
+
+    WAVE_DATA_CHUNKHEADER data = {{{'d', 'a', 't', 'a'}, 4}};
+    const size_t size = sizeof(WAVE_FILEHEADER) + format_size +
+                        sizeof(data) + data.ChunkSize;
+    WAVE_FILEHEADER header = {{'R', 'I', 'F', 'F'},
+                              static_cast<uint32_t>(size - RIFF_HEADER_SIZE),
+                              {'W', 'A', 'V', 'E'}};
+
+    Buffer buffer(size);
+    uint8_t* p = buffer.GetData();
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, &format, format_size);
+    p += format_size;
+    memcpy(p, &data, sizeof(data));
+    memset(p + sizeof(data), 0, data.ChunkSize);
+    return buffer;
+}
+
+static void test_wave_formats() {
+    WaveParser parser;
+    auto buffer = wave_file(WAVE_FORMAT_PCM, 2, 24);
+    auto clip = parser.Parse(buffer);
+    assert(clip.format == AudioClipFormat::STEREO_24);
+    assert(clip.sample_rate == 96000 && clip.data_length == 4);
+
+    buffer = wave_file(WAVE_FORMAT_IEEE_FLOAT, 1, 32);
+    assert(parser.Parse(buffer).format == AudioClipFormat::MONO_FLOAT32);
+
+    // what most tools write for more than 16 bits
+    buffer = wave_file(WAVE_FORMAT_EXTENSIBLE, 2, 32, WAVE_FORMAT_PCM);
+    assert(parser.Parse(buffer).format == AudioClipFormat::STEREO_32);
+    buffer = wave_file(WAVE_FORMAT_EXTENSIBLE, 2, 32, WAVE_FORMAT_IEEE_FLOAT);
+    assert(parser.Parse(buffer).format == AudioClipFormat::STEREO_FLOAT32);
+
+    // not one of AudioClipFormat
+    WAVE_FORMAT_CHUNKHEADER format{};
+    format.FormatType = WAVE_FORMAT_PCM;
+    format.ChannelNum = 2;
+    format.BitsPerSample = 12;
+    assert(!WaveParser::ParseFormat(format, clip));
+    format.BitsPerSample = 16;
+    format.ChannelNum = 6;
+    assert(!WaveParser::ParseFormat(format, clip));
+    format.ChannelNum = 1;
+    format.FormatType = WAVE_FORMAT_IEEE_FLOAT;
+    assert(!WaveParser::ParseFormat(format, clip));
+
+    // nothing for the mixer to read
+    buffer = wave_file(WAVE_FORMAT_PCM, 6, 16);
+    assert(parser.Parse(buffer).data == nullptr);
+    buffer = wave_file(WAVE_FORMAT_PCM, 2, 12);
+    assert(parser.Parse(buffer).data == nullptr);
+}
+
+// the largest difference to a sine of frequency, away from the ends
+static float sine_error(const vector<float>& samples, uint16_t channels,
+                        float frequency, uint32_t rate) {
+    const size_t frames = samples.size() / channels;
+    float error = 0.0f;
+    for (size_t i = frames / 4; i < frames * 3 / 4; i++) {
+        const float expected =
+            sin(2.0f * PI * frequency * static_cast<float>(i) / rate);
+        for (uint16_t c = 0; c < channels; c++) {
+            error = max(error, fabs(samples[i * channels + c] - expected));
+        }
+    }
+    return error;
+}
+
+static void test_resampler() {
+    const struct {
+        uint32_t input_rate;
+        uint32_t output_rate;
+    } ratios[] = {{44100, 48000}, {48000, 44100}, {22050, 48000},
+                  {48000, 8000}, {11025, 96000}};
+
+    for (const auto& ratio : ratios) {
+        // a second, a tone well under both Nyquist rates
+        const size_t frames = ratio.input_rate;
+        const float frequency = 1000.0f;
+        vector<float> input(frames * 2);
+        for (size_t i = 0; i < frames; i++) {
+            input[i * 2] = input[i * 2 + 1] =
+                sin(2.0f * PI * frequency * static_cast<float>(i) /
+                    ratio.input_rate);
+        }
+
+        PolyphaseResampler resampler(ratio.input_rate, ratio.output_rate);
+        const auto output_frames = resampler.GetOutputFrameCount(frames);
+        assert(output_frames == ratio.output_rate);
+        vector<float> output(output_frames * 2);
+        resampler.Process(input.data(), frames, 2, output.data());
+        assert(sine_error(output, 2, frequency, ratio.output_rate) < 5e-3f);
+    }
+
+    // above the Nyquist rate of the output it is filtered out, not folded
+    // back
+    const uint32_t input_rate = 48000;
+    vector<float> input(input_rate);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = sin(2.0f * PI * 15000.0f * static_cast<float>(i) /
+                       input_rate);
+    }
+    PolyphaseResampler down(input_rate, 22050);
+    vector<float> output(down.GetOutputFrameCount(input.size()));
+    down.Process(input.data(), input.size(), 1, output.data());
+    float peak = 0.0f;
+    for (size_t i = output.size() / 4; i < output.size() * 3 / 4; i++) {
+        peak = max(peak, fabs(output[i]));
+    }
+    assert(peak < 1e-2f);
+}
+
+int main() {
+    test_round_trip();
+    test_wave_formats();
+    test_resampler();
+
+    cout << "Audio conversion test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "AssetLoader.hpp"
+#include "AudioManager.hpp"
+#include "BaseApplication.hpp"
+#include "PcmConversion.hpp"
+#include "RingBuffer.hpp"
+#include "WAVE.hpp"
+
+using namespace My;
+using namespace std;
+
+static const uint32_t kClipRate = 22050;
+static const uint32_t kClipFrames = kClipRate;
+
+// a second of 441Hz on the left and 882Hz on the right, or 441Hz only
+static void write_clip(const filesystem::path& path, uint16_t channels,
+                       uint16_t bits) {
+    const uint16_t block = channels * bits / 8;
+    WAVE_FILEHEADER file_header = {
+        {'R', 'I', 'F', 'F'}, 0, {'W', 'A', 'V', 'E'}};
+    WAVE_FORMAT_CHUNKHEADER format_chunk_header = {
+        {{'f', 'm', 't', ' '},
+         sizeof(WAVE_FORMAT_CHUNKHEADER) - sizeof(WAVE_CHUNKHEADER)},
+        1,
+        channels,
+        kClipRate,
+        kClipRate * block,
+        block,
+        bits};
+    // skipped when streamed
+    const char list[] = {'L', 'I', 'S', 'T', 4, 0, 0, 0, 'a', 'b', 'c', 0};
+    WAVE_DATA_CHUNKHEADER data_chunk_header = {
+        {{'d', 'a', 't', 'a'}, kClipFrames * block}};
+
+    vector<uint8_t> data(kClipFrames * block);
+    for (uint32_t i = 0; i < kClipFrames; i++) {
+        for (uint16_t c = 0; c < channels; c++) {
+            const float value = 0.5f * sin(2.0f * PI * 441.0f * (c + 1) *
+                                           static_cast<float>(i) / kClipRate);
+            if (bits == 8) {
+                data[i * channels + c] =
+                    static_cast<uint8_t>(lround(value * 127.0f + 128.0f));
+            } else {
+                reinterpret_cast<int16_t*>(data.data())[i * channels + c] =
+                    static_cast<int16_t>(lround(value * 32767.0f));
+            }
+        }
+    }
+
+    file_header.FileSize = sizeof(file_header) + sizeof(format_chunk_header) +
+                           sizeof(list) + sizeof(data_chunk_header) +
+                           data.size() - RIFF_HEADER_SIZE;
+    auto fp = fopen(path.string().c_str(), "wb");
+    assert(fp);
+    fwrite(&file_header, sizeof(file_header), 1, fp);
+    fwrite(&format_chunk_header, sizeof(format_chunk_header), 1, fp);
+    fwrite(list, sizeof(list), 1, fp);
+    fwrite(&data_chunk_header, sizeof(data_chunk_header), 1, fp);
+    fwrite(data.data(), 1, data.size(), fp);
+    fclose(fp);
+}
+
+static void test_ring_buffer() {
+    RingBuffer<uint32_t> ring(1000);
+    assert(ring.GetCapacity() == 1024);
+
+    // in and out in pieces of any size, in order
+    const uint32_t count = 200000;
+    thread producer([&ring] {
+        vector<uint32_t> values(97);
+        uint32_t next = 0;
+        while (next < count) {
+            const uint32_t n = min<uint32_t>(next % 97 + 1, count - next);
+            for (uint32_t i = 0; i < n; i++) values[i] = next + i;
+            const auto written = ring.Write(values.data(), n);
+            if (!written) this_thread::yield();
+            next += static_cast<uint32_t>(written);
+        }
+    });
+
+    vector<uint32_t> values(61);
+    uint32_t expected = 0;
+    while (expected < count) {
+        const auto n = ring.Read(values.data(), expected % 61 + 1);
+        if (!n) this_thread::yield();
+        for (size_t i = 0; i < n; i++) assert(values[i] == expected++);
+    }
+    producer.join();
+    assert(ring.GetReadAvailable() == 0);
+}
+
+static void test_wave_stream(IAssetLoader* pAssetLoader) {
+    // chunk by chunk, the same samples as the whole file
+    Buffer buffer = pAssetLoader->SyncOpenAndReadBinary("Audio/stereo16.wav");
+    WaveParser parser;
+    const auto clip = parser.Parse(buffer);
+    vector<float> expected(kClipFrames * 2);
+    ConvertToFloat(clip.format, clip.data, expected.size(), expected.data());
+
+    WaveStream stream;
+    assert(stream.Open(pAssetLoader, "Audio/stereo16.wav"));
+    assert(stream.GetFormat().format == AudioClipFormat::STEREO_16);
+    assert(stream.GetFrameCount() == kClipFrames);
+    vector<float> frames(1000 * 2);
+    for (int pass = 0; pass < 2; pass++) {
+        size_t frame = 0;
+        while (size_t read = stream.Read(frames.data(), 1000)) {
+            for (size_t i = 0; i < read * 2; i++) {
+                assert(frames[i] == expected[frame * 2 + i]);
+            }
+            frame += read;
+        }
+        assert(frame == kClipFrames);
+        assert(stream.Rewind());
+    }
+}
+
+static size_t zero_crossings(const vector<float>& frames, size_t channel) {
+    size_t crossings = 0;
+    for (size_t i = 2 + channel; i < frames.size(); i += 2) {
+        if ((frames[i - 2] < 0.0f) != (frames[i] < 0.0f)) crossings++;
+    }
+    return crossings;
+}
+
+static void test_mixer(IAssetLoader* pAssetLoader) {
+    // the output rate is twice the clip one
+    AudioMixer mixer(kClipRate * 2);
+
+    // a streamed clip sounds as the loaded one, however small its buffer.
+    // Both are converted by the mixer, the loaded one is kept at its rate.
+    Buffer buffer = pAssetLoader->SyncOpenAndReadBinary("Audio/stereo16.wav");
+    WaveParser parser;
+    const auto clip = parser.Parse(buffer);
+    const auto loaded = mixer.AddVoice(
+        make_shared<AudioClipSource>(clip, false, kClipRate), 1.0f, 0.0f);
+    vector<float> expected(kClipFrames * 2 * 2);
+    mixer.Mix(expected.data(), kClipFrames * 2);
+    // 441Hz resampled keeps its pitch
+    assert(zero_crossings(expected, 0) >= 880 &&
+           zero_crossings(expected, 0) <= 884);
+    assert(zero_crossings(expected, 1) >= 1762 &&
+           zero_crossings(expected, 1) <= 1766);
+    vector<float> silence(100 * 2);
+    mixer.Mix(silence.data(), 100);
+    assert(!mixer.IsPlaying(loaded) && mixer.GetVoiceCount() == 0);
+
+    auto stream = make_unique<WaveStream>();
+    assert(stream->Open(pAssetLoader, "Audio/stereo16.wav"));
+    auto source = make_shared<StreamingAudioSource>(std::move(stream), false,
+                                                    700);
+    const auto streamed = mixer.AddVoice(source, 1.0f, 0.0f);
+    vector<float> frames(300 * 2);
+    for (size_t frame = 0; frame < kClipFrames * 2; frame += 300) {
+        source->Decode();
+        mixer.Mix(frames.data(), 300);
+        for (size_t i = 0; i < 300 * 2 && frame * 2 + i < expected.size();
+             i++) {
+            assert(frames[i] == expected[frame * 2 + i]);
+        }
+    }
+    source->Decode();
+    mixer.Mix(silence.data(), 100);
+    assert(mixer.GetUnderrunCount() == 0);
+    assert(!mixer.IsPlaying(streamed));
+
+    // a mono clip at the rate of the mixer, panned left, then at half the
+    // volume
+    buffer = pAssetLoader->SyncOpenAndReadBinary("Audio/mono8.wav");
+    const auto mono = parser.Parse(buffer);
+    const auto panned = mixer.AddVoice(
+        make_shared<AudioClipSource>(mono, true, kClipRate * 2), 1.0f,
+        -1.0f);
+    mixer.Mix(frames.data(), 300);
+    float peak[2] = {0.0f, 0.0f};
+    for (size_t i = 0; i < 300; i++) {
+        peak[0] = max(peak[0], fabs(frames[2 * i]));
+        peak[1] = max(peak[1], fabs(frames[2 * i + 1]));
+    }
+    assert(peak[0] > 0.45f && peak[0] < 0.51f && peak[1] < 1e-6f);
+
+    mixer.SetVolume(panned, 0.5f);
+    mixer.SetPan(panned, 0.0f);
+    mixer.Mix(frames.data(), 300);
+    mixer.Mix(frames.data(), 300);
+    peak[0] = peak[1] = 0.0f;
+    for (size_t i = 0; i < 300; i++) {
+        peak[0] = max(peak[0], fabs(frames[2 * i]));
+        peak[1] = max(peak[1], fabs(frames[2 * i + 1]));
+    }
+    // constant power, both at 0.5 * 0.5 * cos(pi / 4)
+    assert(fabs(peak[0] - peak[1]) < 1e-6f);
+    assert(peak[0] > 0.17f && peak[0] < 0.18f);
+
+    // a looping voice plays until it is stopped
+    assert(mixer.IsPlaying(panned));
+    mixer.StopVoice(panned);
+    assert(mixer.GetVoiceCount() == 0);
+}
+
+static void test_manager(const filesystem::path& output) {
+    // headless: decoded and mixed on this thread, into a file
+    {
+        BaseApplication app;
+        AssetLoader assetLoader;
+        AudioManager audioManager;
+        WaveFileAudioSink sink(output.string());
+        audioManager.SetSink(&sink);
+        audioManager.SetSampleRate(44100);
+        audioManager.SetThreaded(false);
+        audioManager.SetStreamBufferFrames(1024);
+        app.RegisterManagerModule(&assetLoader);
+        app.RegisterManagerModule(&audioManager);
+        assert(app.Initialize() == 0);
+
+        assert(audioManager.StreamClip("Audio/missing.wav") ==
+               IAudioManager::kInvalidVoice);
+        const auto music =
+            audioManager.StreamClip("Audio/stereo16.wav", 0.5f, 0.0f, true);
+        const auto effect = audioManager.PlayClip("Audio/mono8.wav");
+        assert(music != IAudioManager::kInvalidVoice &&
+               effect != IAudioManager::kInvalidVoice);
+        for (int i = 0; i < 110; i++) audioManager.Mix(441);
+        // the effect ended, the music loops
+        assert(!audioManager.IsVoicePlaying(effect));
+        assert(audioManager.IsVoicePlaying(music));
+        assert(audioManager.GetMixer().GetUnderrunCount() == 0);
+
+        app.Finalize();
+    }
+
+    auto fp = fopen(output.string().c_str(), "rb");
+    assert(fp);
+    fseek(fp, 0, SEEK_END);
+    Buffer buffer(ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    fread(buffer.GetData(), 1, buffer.GetDataSize(), fp);
+    fclose(fp);
+    WaveParser parser;
+    const auto clip = parser.Parse(buffer);
+    assert(clip.format == AudioClipFormat::STEREO_16);
+    assert(clip.sample_rate == 44100);
+    assert(clip.data_length == 110 * 441 * 2 * 2);
+
+    // threaded: keeps the sink fed in real time
+    BaseApplication app;
+    AssetLoader assetLoader;
+    AudioManager audioManager;
+    NullAudioSink sink;
+    audioManager.SetSink(&sink);
+    app.RegisterManagerModule(&assetLoader);
+    app.RegisterManagerModule(&audioManager);
+    assert(app.Initialize() == 0);
+
+    const auto music =
+        audioManager.StreamClip("Audio/stereo16.wav", 1.0f, 0.0f, true);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    assert(audioManager.IsVoicePlaying(music));
+    audioManager.StopVoice(music);
+    assert(!audioManager.IsVoicePlaying(music));
+
+    app.Finalize();
+    assert(sink.GetFrameCount() > 0);
+    assert(sink.GetPeak() > 0.4f);
+}
+
+int main(int argc, char** argv) {
+    test_ring_buffer();
+
+    // next to the test, where AssetLoader looks for them
+    const auto directory =
+        filesystem::absolute(argv[0]).parent_path() / "Asset" / "Audio";
+    filesystem::create_directories(directory);
+    write_clip(directory / "stereo16.wav", 2, 16);
+    write_clip(directory / "mono8.wav", 1, 8);
+
+    AssetLoader assetLoader;
+    assetLoader.Initialize();
+    test_wave_stream(&assetLoader);
+    test_mixer(&assetLoader);
+    assetLoader.Finalize();
+
+    test_manager(filesystem::temp_directory_path() / "AudioManagerTest.wav");
+
+    cout << "Audio manager test passed" << endl;
+
+    return 0;
+}
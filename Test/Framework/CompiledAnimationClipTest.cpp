@@ -0,0 +1,168 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Bezier.hpp"
+#include "CompiledAnimationClip.hpp"
+#include "Linear.hpp"
+#include "TestAnimationClip.hpp"
+
+using namespace My;
+using namespace std;
+
+int main() {
+    const vector<float> times = {0.0f, 0.5f, 1.5f, 2.0f};
+    auto linear_time = make_shared<Linear<float, float>>(times);
+    // slow in and out
+    auto bezier_time = make_shared<Bezier<float, float>>(
+        times, vector<float>({0.0f, 0.4f, 1.3f, 1.9f}),
+        vector<float>({0.1f, 0.7f, 1.6f, 2.0f}));
+
+    SceneObjectAnimationClip clip(0);
+    add_track(clip, make_shared<SceneObjectTranslation>('x', 0.0f),
+              linear_time,
+              make_shared<Linear<float, float>>(
+                  vector<float>({0.0f, 1.0f, -1.0f, 3.0f})),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectRotation>('z', 0.0f), bezier_time,
+              make_shared<Bezier<float, float>>(
+                  vector<float>({0.0f, 1.0f, 2.0f, 0.5f}),
+                  vector<float>({-0.2f, 0.8f, 1.9f, 0.6f}),
+                  vector<float>({0.2f, 1.2f, 2.1f, 0.4f})),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectScale>(1.0f, 1.0f, 1.0f),
+              linear_time,
+              make_shared<Linear<float, float>>(
+                  vector<float>({1.0f, 2.0f, 0.5f, 1.0f})),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectScale>(1.0f, 1.0f, 1.0f),
+              bezier_time,
+              make_shared<Linear<Vector3f, Vector3f>>(vector<Vector3f>(
+                  {{1.0f, 1.0f, 1.0f},
+                   {2.0f, 1.0f, 0.5f},
+                   {1.0f, 3.0f, 1.0f},
+                   {0.5f, 0.5f, 0.5f}})),
+              SceneObjectTrackType::kVector3);
+    add_track(clip, make_shared<SceneObjectTranslation>(0.0f, 0.0f, 0.0f),
+              linear_time,
+              make_shared<Bezier<Vector3f, Vector3f>>(
+                  vector<Vector3f>({{0.0f, 0.0f, 0.0f},
+                                    {1.0f, 2.0f, 3.0f},
+                                    {-1.0f, 0.0f, 1.0f},
+                                    {2.0f, 2.0f, 2.0f}}),
+                  vector<Vector3f>({{0.0f, -0.5f, 0.0f},
+                                    {0.5f, 1.5f, 2.5f},
+                                    {-1.5f, 0.0f, 0.5f},
+                                    {1.5f, 2.0f, 2.5f}}),
+                  vector<Vector3f>({{0.5f, 0.0f, 0.5f},
+                                    {1.5f, 2.5f, 3.5f},
+                                    {-0.5f, 0.0f, 1.5f},
+                                    {2.5f, 2.0f, 1.5f}})),
+              SceneObjectTrackType::kVector3);
+    add_track(clip, make_shared<SceneObjectRotation>('y', 0.0f), linear_time,
+              make_shared<Linear<Vector3f, Vector3f>>(vector<Vector3f>(
+                  {{0.0f, 0.0f, 0.0f},
+                   {0.3f, 0.2f, 0.1f},
+                   {-0.3f, 0.4f, 1.0f},
+                   {0.0f, 1.0f, 0.0f}})),
+              SceneObjectTrackType::kVector3);
+    add_track(clip, make_shared<SceneObjectTransform>(), linear_time,
+              make_shared<Linear<Matrix4X4f, float>>(vector<Matrix4X4f>(
+                  {rotation_scale_translation(0.0f, 1.0f, 0.0f),
+                   rotation_scale_translation(0.5f, 2.0f, 1.0f),
+                   rotation_scale_translation(1.0f, 0.5f, -1.0f),
+                   rotation_scale_translation(-0.5f, 1.0f, 2.0f)})),
+              SceneObjectTrackType::kMatrix);
+    // the third key on the other hemisphere, slerp takes the shorter arc
+    add_track(clip, make_shared<SceneObjectRotation>('x', 0.0f), linear_time,
+              make_shared<Linear<Quaternion<float>, float>>(
+                  vector<Quaternion<float>>(
+                      {QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.0f),
+                       QuaternionRotationAxis({0.0f, 0.6f, 0.8f}, 1.0f),
+                       Quaternion<float>(
+                           -QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, 2.5f)),
+                       QuaternionRotationAxis({0.8f, 0.0f, 0.6f}, -1.0f)})),
+              SceneObjectTrackType::kQuoternion);
+    add_track(clip, make_shared<SceneObjectRotation>('x', 0.0f), bezier_time,
+              make_shared<Bezier<Quaternion<float>, float>>(
+                  vector<Quaternion<float>>(
+                      {QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.0f),
+                       QuaternionRotationAxis({0.0f, 1.0f, 0.0f}, 1.0f),
+                       QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, 2.0f),
+                       QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.5f)}),
+                  vector<Quaternion<float>>(
+                      {QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.0f),
+                       QuaternionRotationAxis({0.0f, 1.0f, 0.0f}, 0.8f),
+                       QuaternionRotationAxis({0.0f, 0.6f, 0.8f}, 1.8f),
+                       QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.6f)}),
+                  vector<Quaternion<float>>(
+                      {QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.2f),
+                       QuaternionRotationAxis({0.0f, 0.8f, 0.6f}, 1.2f),
+                       QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, 2.2f),
+                       QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.5f)})),
+              SceneObjectTrackType::kQuoternion);
+    add_track(clip, make_shared<SceneObjectTransform>(), linear_time,
+              make_shared<Bezier<Matrix4X4f, float>>(
+                  vector<Matrix4X4f>(
+                      {rotation_scale_translation(0.0f, 1.0f, 0.0f),
+                       rotation_scale_translation(1.0f, 2.0f, 1.0f),
+                       rotation_scale_translation(2.0f, 0.5f, -1.0f),
+                       rotation_scale_translation(-0.5f, 1.0f, 2.0f)}),
+                  vector<Matrix4X4f>(
+                      {rotation_scale_translation(-0.2f, 1.0f, 0.0f),
+                       rotation_scale_translation(0.8f, 1.5f, 0.5f),
+                       rotation_scale_translation(1.8f, 0.8f, -0.5f),
+                       rotation_scale_translation(-0.3f, 1.0f, 1.5f)}),
+                  vector<Matrix4X4f>(
+                      {rotation_scale_translation(0.2f, 1.0f, 0.5f),
+                       rotation_scale_translation(1.2f, 2.5f, 1.5f),
+                       rotation_scale_translation(2.2f, 0.2f, -1.5f),
+                       rotation_scale_translation(-0.7f, 1.0f, 2.5f)})),
+              SceneObjectTrackType::kMatrix);
+
+    CompiledAnimationClip compiled;
+    assert(compiled.Compile(clip));
+    assert(compiled.GetTrackCount() == transforms.size());
+
+    // forward, at and between the keys, then back and out of the range
+    vector<float> time_points;
+    for (float t = -0.25f; t < 2.5f; t += 1.0f / 60.0f) {
+        time_points.push_back(t);
+    }
+    time_points.insert(time_points.end(),
+                       {0.5f, 1.5f, 1.0f, 0.2f, 1.9f, 0.0f, 2.0f, -1.0f});
+
+    for (const float t : time_points) {
+        clip.Update(t);
+        vector<Matrix4X4f> expected;
+        for (const auto& transform : transforms) {
+            expected.push_back(static_cast<Matrix4X4f>(*transform));
+        }
+
+        compiled.Evaluate(t);
+        for (size_t i = 0; i < transforms.size(); i++) {
+            const auto result = static_cast<Matrix4X4f>(*transforms[i]);
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    assert(fabs(result[r][c] - expected[i][r][c]) < 1e-4f);
+                }
+            }
+        }
+    }
+
+    // what SceneObjectTrack can not evaluate either, a translation turned
+    SceneObjectAnimationClip rotations(1);
+    add_track(rotations, make_shared<SceneObjectTranslation>('x', 0.0f),
+              linear_time,
+              make_shared<Linear<Quaternion<float>, float>>(
+                  vector<Quaternion<float>>(4, {0.0f, 0.0f, 0.0f, 1.0f})),
+              SceneObjectTrackType::kQuoternion);
+    assert(!compiled.Compile(rotations));
+    assert(compiled.GetTrackCount() == 0);
+
+    cout << "Compiled animation clip test passed" << endl;
+
+    return 0;
+}
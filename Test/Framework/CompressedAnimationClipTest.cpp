@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Bezier.hpp"
+#include "CompressedAnimationClip.hpp"
+#include "Linear.hpp"
+#include "TestAnimationClip.hpp"
+
+using namespace My;
+using namespace std;
+
+// the transforms after compiled and compressed are evaluated at the same
+// time points, no further apart than tolerance
+static void compare(CompiledAnimationClip& compiled,
+                    CompressedAnimationClip& compressed, float end_time,
+                    float tolerance) {
+    for (float t = -0.5f; t < end_time + 0.5f; t += 1.0f / 97.0f) {
+        compiled.Evaluate(t);
+        vector<Matrix4X4f> expected;
+        for (const auto& transform : transforms) {
+            expected.push_back(static_cast<Matrix4X4f>(*transform));
+        }
+
+        compressed.Evaluate(t);
+        for (size_t i = 0; i < transforms.size(); i++) {
+            const auto result = static_cast<Matrix4X4f>(*transforms[i]);
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    assert(fabs(result[r][c] - expected[i][r][c]) <
+                           tolerance);
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    // dense keys, as baked out of a DCC tool
+    const size_t key_count = 241;
+    vector<float> times(key_count);
+    vector<float> line(key_count), still(key_count), wave(key_count);
+    vector<Vector3f> path(key_count);
+    vector<Quaternion<float>> spin(key_count);
+    for (size_t k = 0; k < key_count; k++) {
+        const float t = k / 60.0f;
+        times[k] = t;
+        line[k] = 2.0f * t - 1.0f;
+        still[k] = 0.5f;
+        wave[k] = sin(t * 3.0f);
+        path[k] = {t, cos(t * 2.0f), 0.25f * t * t};
+        spin[k] = QuaternionRotationAxis({0.0f, 0.6f, 0.8f}, t * 2.0f);
+    }
+    auto dense_time = make_shared<Linear<float, float>>(times);
+
+    SceneObjectAnimationClip clip(0);
+    add_track(clip, make_shared<SceneObjectTranslation>('x', 0.0f),
+              dense_time, make_shared<Linear<float, float>>(line),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectTranslation>('y', 0.0f),
+              dense_time, make_shared<Linear<float, float>>(still),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectRotation>('z', 0.0f), dense_time,
+              make_shared<Linear<float, float>>(wave),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectTranslation>(0.0f, 0.0f, 0.0f),
+              dense_time, make_shared<Linear<Vector3f, Vector3f>>(path),
+              SceneObjectTrackType::kVector3);
+    add_track(clip, make_shared<SceneObjectRotation>('x', 0.0f), dense_time,
+              make_shared<Linear<Quaternion<float>, float>>(spin),
+              SceneObjectTrackType::kQuoternion);
+
+    // and sparse curved ones, sampled between their keys
+    const vector<float> sparse_times = {0.0f, 1.5f, 4.0f};
+    auto sparse_time = make_shared<Linear<float, float>>(sparse_times);
+    add_track(clip, make_shared<SceneObjectScale>('z', 1.0f), sparse_time,
+              make_shared<Bezier<float, float>>(
+                  vector<float>({1.0f, 2.0f, 0.5f}),
+                  vector<float>({1.0f, 1.5f, 0.8f}),
+                  vector<float>({1.4f, 2.5f, 0.5f})),
+              SceneObjectTrackType::kScalar);
+    add_track(clip, make_shared<SceneObjectTransform>(), sparse_time,
+              make_shared<Linear<Matrix4X4f, float>>(vector<Matrix4X4f>(
+                  {rotation_scale_translation(0.0f, 1.0f, 0.0f),
+                   rotation_scale_translation(2.0f, 2.0f, 1.0f),
+                   rotation_scale_translation(-1.0f, 0.5f, -1.0f)})),
+              SceneObjectTrackType::kMatrix);
+
+    CompiledAnimationClip compiled;
+    assert(compiled.Compile(clip));
+
+    const float tolerance = 1e-3f;
+    CompressedAnimationClip compressed;
+    compressed.Compress(compiled, tolerance);
+    assert(compressed.GetTrackCount() == transforms.size());
+    assert(compressed.GetEndTime() == 4.0f);
+    compare(compiled, compressed, 4.0f, 1e-2f);
+
+    // a line keeps its ends, a constant its first key
+    CompiledAnimationClip one_track;
+    SceneObjectAnimationClip line_clip(1), still_clip(2);
+    add_track(line_clip, transforms[0], dense_time,
+              make_shared<Linear<float, float>>(line),
+              SceneObjectTrackType::kScalar);
+    assert(one_track.Compile(line_clip));
+    CompressedAnimationClip compressed_track;
+    compressed_track.Compress(one_track, tolerance);
+    assert(compressed_track.GetKeyCount() == 2);
+    add_track(still_clip, transforms[1], dense_time,
+              make_shared<Linear<float, float>>(still),
+              SceneObjectTrackType::kScalar);
+    assert(one_track.Compile(still_clip));
+    compressed_track.Compress(one_track, tolerance);
+    assert(compressed_track.GetKeyCount() == 1);
+
+    const size_t compiled_keys = key_count * 5 + sparse_times.size() * 2;
+    cout << "keys: " << compiled_keys << " -> " << compressed.GetKeyCount()
+         << ", bytes: " << compiled.GetMemorySize() << " -> "
+         << compressed.GetMemorySize() << endl;
+    assert(compressed.GetMemorySize() * 4 < compiled.GetMemorySize());
+
+    cout << "Compressed animation clip test passed" << endl;
+
+    return 0;
+}
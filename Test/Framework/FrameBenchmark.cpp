@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AnimationManager.hpp"
+#include "AssetLoader.hpp"
+#include "BaseApplication.hpp"
+#include "MemoryManager.hpp"
+#include "MemoryTracker.hpp"
+#include "My/MyPhysicsManager.hpp"
+#include "Profiler.hpp"
+#include "RHI/Empty/EmptyGraphicsManager.hpp"
+#include "RHI/Empty/EmptyPipelineStateManager.hpp"
+#include "SceneManager.hpp"
+#include "imgui.h"
+
+using namespace My;
+using namespace std;
+
+// End to end CPU cost of a frame, without a GPU: the module stack of the
+// Viewer (scene, animation, physics, graphics and its passes) runs on the
+// Empty RHI, which records what it is asked to do instead of doing it.
+//
+// usage: FrameBenchmark [scene file] [frame count] [json file]
+//
+// Written as JSON to the file, frame_benchmark.json by default: the time of
+// the frame and of each module and pass as percentiles over the frames, the
+// allocations of each memory tag, and the commands recorded per frame.
+
+namespace {
+const uint32_t kWarmUpFrames = 10;
+
+class BenchmarkGraphicsManager : public EmptyGraphicsManager {
+   public:
+    [[nodiscard]] vector<string> GetPassNames() const {
+        vector<string> names;
+        for (const auto& pass : m_DispatchPasses) {
+            names.emplace_back(pass->GetName());
+        }
+        for (const auto& pass : m_DrawPasses) {
+            names.emplace_back(pass->GetName());
+        }
+        return names;
+    }
+};
+
+// a quoted JSON string, scene paths may hold backslashes and zone names
+// anything
+string json_string(const string& text) {
+    ostringstream out;
+    out << '"';
+    for (const auto c : text) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\r':
+                out << "\\r";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u" << hex << setw(4) << setfill('0')
+                        << static_cast<int>(c) << dec;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+// milliseconds of each frame, per zone name
+using ZoneTimes = map<string, vector<double>>;
+
+// the time spent in the zones of each name during the frame, on any thread
+void gather(const ProfileFrame& frame, ZoneTimes& times) {
+    map<string, uint64_t> frame_times;
+    for (const auto& zone : frame.zones) {
+        frame_times[zone.name] += zone.end - zone.begin;
+    }
+    for (auto& [name, samples] : times) {
+        samples.push_back(frame_times[name] / 1e6);
+    }
+}
+
+// nearest rank
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const auto rank = static_cast<size_t>(ceil(p * sorted.size()));
+    return sorted[max<size_t>(rank, 1) - 1];
+}
+
+void write_statistics(ostream& out, vector<double> samples) {
+    sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (const auto sample : samples) sum += sample;
+    out << "{\"mean\":" << (samples.empty() ? 0.0 : sum / samples.size())
+        << ",\"p50\":" << percentile(samples, 0.5)
+        << ",\"p90\":" << percentile(samples, 0.9)
+        << ",\"p99\":" << percentile(samples, 0.99)
+        << ",\"max\":" << (samples.empty() ? 0.0 : samples.back()) << '}';
+}
+
+void write_zones(ostream& out, const char* key, const vector<string>& names,
+                 const ZoneTimes& times) {
+    out << ",\n" << json_string(key) << ":{";
+    for (size_t i = 0; i < names.size(); i++) {
+        if (i) out << ",\n";
+        out << json_string(names[i]) << ':';
+        write_statistics(out, times.at(names[i]));
+    }
+    out << '}';
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* scene_file = (argc > 1) ? argv[1] : "Scene/splash.ogex";
+    const long long frames_argument =
+        (argc > 2) ? strtoll(argv[2], nullptr, 10) : 300;
+    const char* json_file = (argc > 3) ? argv[3] : "frame_benchmark.json";
+
+    if (frames_argument < 1 || frames_argument > UINT32_MAX) {
+        cerr << "frame count must be a positive number, got " << argv[2]
+             << endl;
+        return -1;
+    }
+    const auto frame_count = static_cast<uint32_t>(frames_argument);
+
+    GfxConfiguration config(8, 8, 8, 8, 24, 8, 4, 1920, 1080,
+                            "Frame Benchmark");
+    BaseApplication app(config);
+    AnimationManager animationManager;
+    AssetLoader assetLoader;
+    BenchmarkGraphicsManager graphicsManager;
+    MemoryManager memoryManager;
+    MyPhysicsManager physicsManager;
+    EmptyPipelineStateManager pipelineStateManager;
+    SceneManager sceneManager;
+
+    // in the order of the Viewer, which is the order they tick in
+    app.RegisterManagerModule(&animationManager);
+    app.RegisterManagerModule(&assetLoader);
+    app.RegisterManagerModule(&graphicsManager);
+    app.RegisterManagerModule(&memoryManager);
+    app.RegisterManagerModule(&physicsManager);
+    app.RegisterManagerModule(&pipelineStateManager);
+    app.RegisterManagerModule(&sceneManager);
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(config.screenWidth),
+                            static_cast<float>(config.screenHeight));
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    if (app.Initialize()) {
+        cerr << "Initialize failed" << endl;
+        return -1;
+    }
+    graphicsManager.ResizeCanvas(config.screenWidth, config.screenHeight);
+
+    auto start = chrono::steady_clock::now();
+    if (sceneManager.LoadScene(scene_file)) {
+        cerr << "Can not load " << scene_file << endl;
+        app.Finalize();
+        ImGui::DestroyContext();
+        return -1;
+    }
+    const double load_time =
+        chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+            .count();
+
+    // the first frames set the scene up in every module
+    for (uint32_t i = 0; i < kWarmUpFrames; i++) app.Tick();
+
+    ZoneTimes times;
+    vector<string> module_names;
+    for (const auto* name : app.GetModuleNames()) {
+        module_names.emplace_back(name);
+    }
+    const auto pass_names = graphicsManager.GetPassNames();
+    for (const auto& name : module_names) times[name];
+    for (const auto& name : pass_names) times[name];
+
+    // close the last warm up frame, so that measuring starts with a frame
+    Profiler::SetEnabled(true);
+    Profiler::NextFrame();
+    Profiler::ClearFrames();
+    MemoryTracker::NextFrame();
+    graphicsManager.ResetRecordedCommands();
+    MemoryTagStats memory_begin[kMemoryTagCount];
+    int64_t frame_high_water[kMemoryTagCount]{};
+    for (size_t t = 0; t < kMemoryTagCount; t++) {
+        memory_begin[t] = MemoryTracker::GetStats(static_cast<MemoryTag>(t));
+    }
+
+    // a Tick() closes the frame of the one before it
+    auto close_frame = [&] {
+        gather(Profiler::GetFrames().back(), times);
+        for (size_t t = 0; t < kMemoryTagCount; t++) {
+            frame_high_water[t] = max(
+                frame_high_water[t],
+                MemoryTracker::GetStats(static_cast<MemoryTag>(t))
+                    .frameHighWater);
+        }
+    };
+
+    vector<double> frame_times;
+    for (uint32_t i = 0; i < frame_count; i++) {
+        start = chrono::steady_clock::now();
+        app.Tick();
+        frame_times.push_back(chrono::duration<double, milli>(
+                                  chrono::steady_clock::now() - start)
+                                  .count());
+        if (i) close_frame();
+    }
+    Profiler::NextFrame();
+    MemoryTracker::NextFrame();
+    close_frame();
+    Profiler::SetEnabled(false);
+
+    const auto commands = graphicsManager.GetRecordedCommands();
+    const double frames = frame_count;
+
+    ofstream out(json_file);
+
+    out << "{\"scene\":" << json_string(scene_file)
+        << ",\n\"frames\":" << frame_count
+        << ",\n\"sceneLoadMilliseconds\":" << load_time
+        << ",\n\"frameMilliseconds\":";
+    write_statistics(out, frame_times);
+    write_zones(out, "moduleMilliseconds", module_names, times);
+    write_zones(out, "passMilliseconds", pass_names, times);
+
+    out << ",\n\"memory\":{";
+    for (size_t t = 0; t < kMemoryTagCount; t++) {
+        const auto tag = static_cast<MemoryTag>(t);
+        const auto stats = MemoryTracker::GetStats(tag);
+        if (t) out << ",\n";
+        out << json_string(GetMemoryTagName(tag))
+            << ":{\"allocationsPerFrame\":"
+            << (stats.allocationCount - memory_begin[t].allocationCount) /
+                   frames
+            << ",\"bytes\":" << stats.bytes
+            << ",\"frameHighWater\":" << frame_high_water[t]
+            << ",\"peakBytes\":" << stats.peakBytes << '}';
+    }
+    out << '}';
+
+    out << ",\n\"commandsPerFrame\":{"
+        << "\"passes\":" << commands.passes / frames
+        << ",\"computePasses\":" << commands.computePasses / frames
+        << ",\"pipelineStateBinds\":" << commands.pipelineStateBinds / frames
+        << ",\"pipelineStateChanges\":"
+        << commands.pipelineStateChanges / frames
+        << ",\"shadowMaps\":" << commands.shadowMaps / frames
+        << ",\"batchDraws\":" << commands.batchDraws / frames
+        << ",\"drawCalls\":" << commands.drawCalls / frames
+        << ",\"dispatches\":" << commands.dispatches / frames
+        << ",\"textureCreations\":" << commands.textureCreations / frames
+        << "}}" << endl;
+
+    const double mean =
+        accumulate(frame_times.begin(), frame_times.end(), 0.0) / frames;
+    cout << "Frames: " << frame_count << " (" << commands.frames
+         << " presented) Mean: " << mean << " ms/frame, written to "
+         << json_file << endl;
+
+    app.Finalize();
+    ImGui::DestroyContext();
+
+    return 0;
+}
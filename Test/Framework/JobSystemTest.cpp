@@ -0,0 +1,150 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "JobSystem.hpp"
+
+using namespace My;
+using namespace std;
+
+static void dependency_test(JobSystem& jobs) {
+    // a diamond: b and c after a, d after both
+    vector<int> order;
+    mutex order_lock;
+    auto record = [&](int id) {
+        lock_guard<mutex> lock(order_lock);
+        order.push_back(id);
+    };
+
+    auto a = jobs.CreateJob([&] { record(0); });
+    auto b = jobs.CreateJob([&] { record(1); });
+    auto c = jobs.CreateJob([&] { record(2); });
+    auto d = jobs.CreateJob([&] { record(3); });
+    jobs.AddDependency(b, a);
+    jobs.AddDependency(c, a);
+    jobs.AddDependency(d, b);
+    jobs.AddDependency(d, c);
+
+    // submit in reverse order, nothing may run before its dependencies
+    jobs.Submit(d);
+    jobs.Submit(c);
+    jobs.Submit(b);
+    jobs.Submit(a);
+    jobs.Wait(d);
+
+    assert(order.size() == 4);
+    assert(order.front() == 0);
+    assert(order.back() == 3);
+
+    // depending on a finished job does not block
+    auto e = jobs.Schedule([&] { record(4); }, {d});
+    jobs.Wait(e);
+    assert(order.back() == 4);
+}
+
+static void parallel_for_test(JobSystem& jobs) {
+    const size_t count = 100003;
+    vector<atomic<int>> visited(count);
+    for (auto& v : visited) v = 0;
+
+    jobs.ParallelFor(0, count, 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) visited[i]++;
+    });
+
+    for (const auto& v : visited) assert(v == 1);
+
+    // empty ranges still finish, and still respect dependencies
+    atomic<bool> first{false};
+    auto before = jobs.Schedule([&] { first = true; });
+    auto empty = jobs.ScheduleParallelFor(
+        10, 10, 1, [](size_t, size_t) { assert(0); }, {before});
+    jobs.Wait(empty);
+    assert(first);
+}
+
+static void chained_parallel_for_test(JobSystem& jobs) {
+    const size_t count = 4096;
+    vector<int> values(count, 1);
+
+    auto doubled = jobs.ScheduleParallelFor(
+        0, count, 100, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) values[i] *= 2;
+        });
+    auto incremented = jobs.ScheduleParallelFor(
+        0, count, 33,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) values[i] += 1;
+        },
+        {doubled});
+    jobs.Wait(incremented);
+
+    for (const auto& v : values) assert(v == 3);
+}
+
+static void nested_wait_test(JobSystem& jobs) {
+    // jobs waiting on other jobs must not starve the pool
+    atomic<int> sum{0};
+    jobs.ParallelFor(0, 64, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            jobs.ParallelFor(0, 100, 10, [&](size_t b, size_t e) {
+                sum += static_cast<int>(e - b);
+            });
+        }
+    });
+
+    assert(sum == 6400);
+}
+
+static void background_test(JobSystem& jobs) {
+    // waiting for other jobs never runs a background job inline, only
+    // waiting for the background job itself does
+    const auto caller = this_thread::get_id();
+    atomic<bool> waiting{false};
+    atomic<bool> ran_inline{false};
+    auto background = jobs.ScheduleBackground([&] {
+        if (this_thread::get_id() == caller && !waiting) ran_inline = true;
+    });
+
+    atomic<int> sum{0};
+    jobs.ParallelFor(0, 1000, 1, [&](size_t begin, size_t end) {
+        sum += static_cast<int>(end - begin);
+    });
+    assert(sum == 1000);
+
+    waiting = true;
+    jobs.Wait(background);
+    assert(background->finished);
+    assert(!ran_inline);
+}
+
+static void run_all(JobSystem& jobs) {
+    cout << "Testing with " << jobs.GetWorkerCount() << " workers" << endl;
+    dependency_test(jobs);
+    parallel_for_test(jobs);
+    chained_parallel_for_test(jobs);
+    nested_wait_test(jobs);
+    background_test(jobs);
+}
+
+int main() {
+    {
+        JobSystem jobs;
+        run_all(jobs);
+    }
+
+    {
+        JobSystem jobs(3);
+        run_all(jobs);
+    }
+
+    // no worker at all, everything runs in Wait()
+    {
+        JobSystem jobs(0);
+        run_all(jobs);
+    }
+
+    cout << "JobSystem test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "Buffer.hpp"
+#include "MemoryManager.hpp"
+#include "MemoryTracker.hpp"
+
+using namespace My;
+using namespace std;
+
+static int64_t bytes_of(MemoryTag tag) {
+    return MemoryTracker::GetStats(tag).bytes;
+}
+
+static void test_scope() {
+    assert(MemoryTagScope::GetCurrentTag() == MemoryTag::kUntagged);
+    {
+        MemoryTagScope outer(MemoryTag::kTextures);
+        {
+            MemoryTagScope inner(MemoryTag::kParsers);
+            assert(MemoryTagScope::GetCurrentTag() == MemoryTag::kParsers);
+        }
+        assert(MemoryTagScope::GetCurrentTag() == MemoryTag::kTextures);
+    }
+    assert(MemoryTagScope::GetCurrentTag() == MemoryTag::kUntagged);
+}
+
+static void test_buffer() {
+    MemoryTracker::NextFrame();
+    const auto textures = bytes_of(MemoryTag::kTextures);
+    const auto untagged = bytes_of(MemoryTag::kUntagged);
+    const auto allocations =
+        MemoryTracker::GetStats(MemoryTag::kTextures).allocationCount;
+
+    {
+        MemoryTagScope memory_tag(MemoryTag::kTextures);
+        Buffer buffer(1000);
+        assert(buffer.GetTag() == MemoryTag::kTextures);
+
+        // moved buffers keep the tag they were allocated under
+        Buffer moved;
+        {
+            MemoryTagScope other(MemoryTag::kMeshes);
+            moved = std::move(buffer);
+        }
+        MemoryTracker::NextFrame();
+        assert(bytes_of(MemoryTag::kTextures) == textures + 1000);
+        assert(MemoryTracker::GetStats(MemoryTag::kTextures).count >= 1);
+        assert(MemoryTracker::GetStats(MemoryTag::kTextures).allocationCount ==
+               allocations + 1);
+
+        // the data handed out is no longer counted, until taken back
+        uint8_t* data = moved.MoveData();
+        MemoryTracker::NextFrame();
+        assert(bytes_of(MemoryTag::kTextures) == textures);
+        moved.SetData(data, 1000);
+        MemoryTracker::NextFrame();
+        assert(bytes_of(MemoryTag::kTextures) == textures + 1000);
+    }
+
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kTextures) == textures);
+    assert(bytes_of(MemoryTag::kUntagged) == untagged);
+}
+
+static void test_shared() {
+    MemoryTracker::NextFrame();
+    const auto scene_graph = bytes_of(MemoryTag::kSceneGraph);
+
+    struct Node {
+        char payload[256];
+    };
+    auto node = MakeTaggedShared<Node>(MemoryTag::kSceneGraph);
+    MemoryTracker::NextFrame();
+    // the control block is counted along with the object
+    assert(bytes_of(MemoryTag::kSceneGraph) >=
+           scene_graph + static_cast<int64_t>(sizeof(Node)));
+
+    node.reset();
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kSceneGraph) == scene_graph);
+}
+
+static void test_threads() {
+    MemoryTracker::NextFrame();
+    const auto audio = bytes_of(MemoryTag::kAudio);
+
+    // allocated on one thread, freed on another
+    Buffer buffer;
+    thread worker([&buffer] {
+        MemoryTagScope memory_tag(MemoryTag::kAudio);
+        buffer = Buffer(4096);
+    });
+    worker.join();
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kAudio) == audio + 4096);
+
+    buffer = Buffer();
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kAudio) == audio);
+}
+
+static void test_high_water() {
+    MemoryTracker::NextFrame();
+    const auto animation = bytes_of(MemoryTag::kAnimation);
+
+    // gone before the frame ended, still in its high water mark
+    {
+        MemoryTagScope memory_tag(MemoryTag::kAnimation);
+        Buffer first(1 << 20);
+        Buffer second(1 << 10);
+    }
+    MemoryTracker::NextFrame();
+    auto stats = MemoryTracker::GetStats(MemoryTag::kAnimation);
+    assert(stats.bytes == animation);
+    assert(stats.frameHighWater == animation + (1 << 20) + (1 << 10));
+    assert(stats.peakBytes >= stats.frameHighWater);
+
+    MemoryTracker::NextFrame();
+    stats = MemoryTracker::GetStats(MemoryTag::kAnimation);
+    assert(stats.frameHighWater == animation);
+    assert(stats.peakBytes >= animation + (1 << 20) + (1 << 10));
+}
+
+static void test_budget() {
+    MemoryTracker::NextFrame();
+    const auto physics = bytes_of(MemoryTag::kPhysics);
+    MemoryTracker::SetBudget(MemoryTag::kPhysics, physics + 100);
+    assert(!MemoryTracker::IsOverBudget(MemoryTag::kPhysics));
+
+    {
+        MemoryTagScope memory_tag(MemoryTag::kPhysics);
+        Buffer buffer(200);
+        MemoryTracker::NextFrame();
+        assert(MemoryTracker::IsOverBudget(MemoryTag::kPhysics));
+        assert(MemoryTracker::GetStats(MemoryTag::kPhysics).budget ==
+               static_cast<size_t>(physics + 100));
+
+        stringstream report;
+        MemoryTracker::Report(report);
+        const auto text = report.str();
+        for (size_t i = 0; i < kMemoryTagCount; i++) {
+            assert(text.find(GetMemoryTagName(static_cast<MemoryTag>(i))) !=
+                   string::npos);
+        }
+        assert(text.find(" !") != string::npos);
+    }
+
+    // the frame it was freed in started with it
+    MemoryTracker::NextFrame();
+    assert(MemoryTracker::IsOverBudget(MemoryTag::kPhysics));
+    MemoryTracker::NextFrame();
+    assert(!MemoryTracker::IsOverBudget(MemoryTag::kPhysics));
+    MemoryTracker::SetBudget(MemoryTag::kPhysics, 0);
+}
+
+static void test_memory_manager() {
+    MemoryManager memoryManager;
+    assert(memoryManager.Initialize() == 0);
+
+    MemoryTracker::NextFrame();
+    const auto meshes = bytes_of(MemoryTag::kMeshes);
+    void* page;
+    {
+        MemoryTagScope memory_tag(MemoryTag::kMeshes);
+        page = memoryManager.AllocatePage(8192);
+    }
+    assert(page);
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kMeshes) == meshes + 8192);
+
+    // counted under the tag it was allocated with
+    memoryManager.FreePage(page);
+    MemoryTracker::NextFrame();
+    assert(bytes_of(MemoryTag::kMeshes) == meshes);
+
+    memoryManager.Finalize();
+}
+
+int main() {
+    test_scope();
+    test_buffer();
+    test_shared();
+    test_threads();
+    test_high_water();
+    test_budget();
+    test_memory_manager();
+
+    cout << "MemoryTracker test passed" << endl;
+
+    return 0;
+}
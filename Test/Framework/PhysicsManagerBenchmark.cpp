@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "AssetLoader.hpp"
+#include "BaseApplication.hpp"
+#include "Bullet/BulletPhysicsManager.hpp"
+#include "My/MyPhysicsManager.hpp"
+#include "SceneManager.hpp"
+
+using namespace My;
+using namespace std;
+
+// Step time, contacts, memory and determinism of the physics backends,
+// driven through IPhysicsManager only. Each frame simulates a 60th of a
+// second. The in-house backend runs in deterministic mode, without and with
+// the job system, and both runs must give the same state at every frame.
+//
+// usage: PhysicsManagerBenchmark [stacks|pile|billiard|<scene file>]
+//                                [frame count] [hash file]
+//
+// The state hashes of every frame are written to the hash file, or compared
+// with it when it already exists, to check runs against each other.
+
+namespace {
+const float kFrameTime = 1.0f / 60.0f;
+
+// resident set size, 0 where it is not known
+size_t resident_memory() {
+#if defined(__linux__)
+    ifstream statm("/proc/self/statm");
+    size_t pages, resident;
+    if (statm >> pages >> resident) {
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+// FNV-1a
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+const uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+const auto kSphere = SceneObjectCollisionType::kSceneObjectCollisionTypeSphere;
+const auto kBox = SceneObjectCollisionType::kSceneObjectCollisionTypeBox;
+const auto kPlane = SceneObjectCollisionType::kSceneObjectCollisionTypePlane;
+}  // namespace
+
+class GeneratedSceneManager : public SceneManager {
+   public:
+    // false if the name is neither a generated scene nor a scene file
+    bool CreateScene(const string& name) {
+        if (name == "stacks") {
+            createStacks();
+        } else if (name == "pile") {
+            createPile();
+        } else if (name == "billiard") {
+            createBilliard();
+        } else {
+            return LoadScene(name.c_str()) == 0;
+        }
+
+        m_nSceneRevision++;
+        return true;
+    }
+
+    [[nodiscard]] const string& GetCueNode() const { return m_CueNode; }
+
+   private:
+    // the backends only make spheres dynamic, boxes and planes are static
+    void addShape(const string& key, SceneObjectCollisionType type,
+                  const vector<float>& parameters) {
+        auto geometry = make_shared<SceneObjectGeometry>();
+        geometry->SetCollisionType(type);
+        geometry->SetCollisionParameters(
+            parameters.data(), static_cast<int32_t>(parameters.size()));
+        m_pScene->Geometries[key] = geometry;
+    }
+
+    string addNode(const string& key, float x, float y, float z) {
+        const string name = key + "_" + to_string(m_nNodeCount++);
+        auto node = make_shared<SceneGeometryNode>(name);
+        node->AddSceneObjectRef(key);
+
+        Matrix4X4f translation;
+        MatrixTranslation(translation, x, y, z);
+        node->AppendTransform("translation",
+                              make_shared<SceneObjectTransform>(translation));
+
+        m_pScene->GeometryNodes.emplace(name, node);
+        m_pScene->LUT_Name_GeometryNode.emplace(name, node);
+        m_pScene->SceneGraph->AppendChild(std::move(node));
+        return name;
+    }
+
+    void newScene(const string& name) {
+        m_pScene = make_shared<Scene>(name);
+        // Bullet has no terrain, the scenes compared keep to what both have
+        m_pScene->Terrain.reset();
+        m_nNodeCount = 0;
+        m_CueNode.clear();
+        addShape("ground", kPlane, {0.0f, 0.0f, 1.0f, 0.0f});
+        addNode("ground", 0.0f, 0.0f, 0.0f);
+    }
+
+    // columns of spheres, each in a well of four walls
+    void createStacks() {
+        newScene("stacks");
+        const float radius = 0.5f;
+        const int side = 8;
+        const int height = 10;
+        const float well = 2.0f * radius + 0.02f;
+        const float wall = 0.05f;
+        const float wall_height = height * radius;
+        const float spacing = well + 2.0f * wall;
+
+        addShape("sphere", kSphere, {radius});
+        addShape("wall_x", kBox, {wall, 0.5f * spacing, wall_height});
+        addShape("wall_y", kBox, {0.5f * spacing, wall, wall_height});
+
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                const float x = i * spacing;
+                const float y = j * spacing;
+                const float offset = 0.5f * well + wall;
+                addNode("wall_x", x - offset, y, wall_height);
+                addNode("wall_x", x + offset, y, wall_height);
+                addNode("wall_y", x, y - offset, wall_height);
+                addNode("wall_y", x, y + offset, wall_height);
+                for (int k = 0; k < height; k++) {
+                    addNode("sphere", x, y, radius + k * 2.0f * radius);
+                }
+            }
+        }
+    }
+
+    // spheres of a few sizes poured into a box
+    void createPile() {
+        newScene("pile");
+        const float half_size = 5.0f;
+        const float wall = 0.25f;
+        addShape("wall_x", kBox, {wall, half_size, 5.0f});
+        addShape("wall_y", kBox, {half_size, wall, 5.0f});
+        addNode("wall_x", -half_size - wall, 0.0f, 5.0f);
+        addNode("wall_x", half_size + wall, 0.0f, 5.0f);
+        addNode("wall_y", 0.0f, -half_size - wall, 5.0f);
+        addNode("wall_y", 0.0f, half_size + wall, 5.0f);
+
+        const float radii[] = {0.2f, 0.3f, 0.4f};
+        for (int r = 0; r < 3; r++) {
+            addShape("sphere" + to_string(r), kSphere, {radii[r]});
+        }
+
+        // a fixed sequence, the scene must be the same for every run
+        uint32_t seed = 12345;
+        auto jitter = [&seed] {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+        };
+
+        const int side = 12;
+        for (int k = 0; k < 10; k++) {
+            for (int i = 0; i < side; i++) {
+                for (int j = 0; j < side; j++) {
+                    const float x = (i + 0.5f) * 0.8f - 0.4f * side;
+                    const float y = (j + 0.5f) * 0.8f - 0.4f * side;
+                    addNode("sphere" + to_string((i + j + k) % 3),
+                            x + jitter() * 0.1f, y + jitter() * 0.1f,
+                            1.0f + k * 0.9f);
+                }
+            }
+        }
+    }
+
+    // a rack of fifteen balls and the cue ball, on a table with cushions
+    void createBilliard() {
+        newScene("billiard");
+        const float radius = 0.0286f;
+        addShape("ball", kSphere, {radius});
+        addShape("cushion_x", kBox, {0.05f, 0.7f, 0.05f});
+        addShape("cushion_y", kBox, {1.3f, 0.05f, 0.05f});
+        addNode("cushion_x", -1.3f, 0.0f, 0.05f);
+        addNode("cushion_x", 1.3f, 0.0f, 0.05f);
+        addNode("cushion_y", 0.0f, -0.7f, 0.05f);
+        addNode("cushion_y", 0.0f, 0.7f, 0.05f);
+
+        m_CueNode = addNode("ball", -0.6f, 0.0f, radius);
+        const float row_spacing = 2.0f * radius * 0.8661f + 1e-4f;
+        for (int row = 0; row < 5; row++) {
+            for (int i = 0; i <= row; i++) {
+                addNode("ball", 0.6f + row * row_spacing,
+                        (i - 0.5f * row) * (2.0f * radius + 1e-4f), radius);
+            }
+        }
+    }
+
+    // the node hit after the first frame, if any
+    string m_CueNode;
+    uint32_t m_nNodeCount{0};
+};
+
+class BenchmarkApplication : public BaseApplication {
+   public:
+    // null: run serially, negative: one worker per extra hardware thread
+    void UseJobSystem(bool enable, int32_t worker_count) {
+        if (enable) {
+            m_pJobSystem = make_unique<JobSystem>(worker_count);
+        } else {
+            m_pJobSystem.reset();
+        }
+    }
+};
+
+struct RunResult {
+    bool loaded{false};
+    size_t bodies{0};
+    double setup_milliseconds{0.0};
+    vector<double> frame_milliseconds;
+    size_t max_contacts{0};
+    double average_contacts{0.0};
+    size_t memory{0};
+    vector<uint64_t> hashes;
+};
+
+static RunResult run(IPhysicsManager& physicsManager, const string& scene_name,
+                     uint32_t frame_count, bool job_system) {
+    RunResult result;
+
+    BenchmarkApplication app;
+    AssetLoader assetLoader;
+    GeneratedSceneManager sceneManager;
+    app.RegisterManagerModule(&assetLoader);
+    app.RegisterManagerModule(&sceneManager);
+    app.RegisterManagerModule(&physicsManager);
+
+    if (app.Initialize()) {
+        cerr << "Initialize failed" << endl;
+        return result;
+    }
+    app.UseJobSystem(job_system, -1);
+
+    // nothing to finalize against without a scene
+    if (!sceneManager.CreateScene(scene_name)) {
+        cerr << "Can not load " << scene_name << endl;
+        return result;
+    }
+    result.loaded = true;
+
+    // the nodes with a body, in name order so that the hashes do not depend
+    // on the hash map
+    auto scene = sceneManager.GetSceneForPhysicalSimulation();
+    vector<pair<string, shared_ptr<SceneGeometryNode>>> nodes;
+    for (const auto& [name, node] : scene->GeometryNodes) {
+        if (auto pNode = node.lock()) nodes.emplace_back(name, pNode);
+    }
+    sort(nodes.begin(), nodes.end(),
+         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    physicsManager.SetFixedFrameTime(kFrameTime);
+    const size_t memory_before = resident_memory();
+
+    // the first frame creates the bodies
+    auto start = chrono::steady_clock::now();
+    physicsManager.Tick();
+    auto end = chrono::steady_clock::now();
+    result.setup_milliseconds =
+        chrono::duration<double, milli>(end - start).count();
+
+    for (const auto& [name, node] : nodes) {
+        if (node->RigidBody()) result.bodies++;
+    }
+
+    // break: the cue ball is hit towards the rack
+    if (!sceneManager.GetCueNode().empty()) {
+        for (const auto& [name, node] : nodes) {
+            if (name != sceneManager.GetCueNode()) continue;
+            if (!node->RigidBody()) continue;
+            physicsManager.ApplyCentralForce(node->RigidBody(),
+                                             Vector3f({600.0f, 3.0f, 0.0f}));
+        }
+    }
+
+    size_t contact_sum = 0;
+    result.frame_milliseconds.reserve(frame_count);
+    result.hashes.reserve(frame_count);
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+        start = chrono::steady_clock::now();
+        physicsManager.Tick();
+        end = chrono::steady_clock::now();
+        result.frame_milliseconds.push_back(
+            chrono::duration<double, milli>(end - start).count());
+
+        const size_t contacts = physicsManager.GetContactCount();
+        contact_sum += contacts;
+        result.max_contacts = max(result.max_contacts, contacts);
+
+        // what the renderer reads, the transforms published by the step
+        const auto transforms = physicsManager.GetRigidBodyTransforms();
+        uint64_t hash = kHashSeed;
+        for (const auto& [name, node] : nodes) {
+            if (!node->RigidBody()) continue;
+            assert(node->RigidBodyHandle() < transforms.count);
+            const Matrix4X4f& transform =
+                transforms.transforms[node->RigidBodyHandle()];
+            hash = hash_bytes(hash, &transform, sizeof(transform));
+        }
+        result.hashes.push_back(hash);
+    }
+
+    const size_t memory_after = resident_memory();
+    result.memory =
+        (memory_after > memory_before) ? memory_after - memory_before : 0;
+    result.average_contacts =
+        frame_count ? static_cast<double>(contact_sum) / frame_count : 0.0;
+
+    app.Finalize();
+
+    return result;
+}
+
+static void report(const string& label, const RunResult& result) {
+    auto times = result.frame_milliseconds;
+    sort(times.begin(), times.end());
+    auto percentile = [&times](double p) {
+        if (times.empty()) return 0.0;
+        const auto index = static_cast<size_t>(p * (times.size() - 1) + 0.5);
+        return times[index];
+    };
+
+    uint64_t run_hash = kHashSeed;
+    for (const auto hash : result.hashes) {
+        run_hash = hash_bytes(run_hash, &hash, sizeof(hash));
+    }
+
+    cout << label << ": " << result.bodies << " bodies" << endl;
+    cout << "  setup:    " << result.setup_milliseconds << " ms" << endl;
+    cout << "  step:     p50 " << percentile(0.5) << " ms, p90 "
+         << percentile(0.9) << " ms, p99 " << percentile(0.99)
+         << " ms, max " << percentile(1.0) << " ms" << endl;
+    cout << "  contacts: " << result.average_contacts << " average, "
+         << result.max_contacts << " max" << endl;
+    cout << "  memory:   " << result.memory / 1024 << " KiB" << endl;
+    cout << "  hash:     " << hex << run_hash << dec << endl;
+}
+
+// index of the first frame whose hashes differ, or the common size
+static size_t first_difference(const vector<uint64_t>& a,
+                               const vector<uint64_t>& b) {
+    const size_t size = min(a.size(), b.size());
+    for (size_t i = 0; i < size; i++) {
+        if (a[i] != b[i]) return i;
+    }
+    return (a.size() == b.size()) ? size : size + 1;
+}
+
+int main(int argc, char** argv) {
+    const string scene_name = (argc > 1) ? argv[1] : "pile";
+    const uint32_t frame_count = (argc > 2) ? atoi(argv[2]) : 600;
+    const string hash_file = (argc > 3) ? argv[3] : "";
+
+    struct Backend {
+        string label;
+        function<unique_ptr<IPhysicsManager>()> create;
+        bool job_system;
+    };
+
+    auto create_my = [] {
+        auto manager = make_unique<MyPhysicsManager>();
+        // the same results whatever the number of threads
+        manager->GetWorld().SetDeterministic(true);
+        return manager;
+    };
+
+    const Backend backends[] = {
+        {"Bullet", [] { return make_unique<BulletPhysicsManager>(); }, false},
+        {"My (serial)", create_my, false},
+        {"My (job system)", create_my, true},
+    };
+
+    cout << "Scene: " << scene_name << " Frames: " << frame_count << endl;
+
+    int error = 0;
+    vector<RunResult> results;
+    for (const auto& backend : backends) {
+        auto manager = backend.create();
+        results.push_back(
+            run(*manager, scene_name, frame_count, backend.job_system));
+        if (!results.back().loaded) return -1;
+        report(backend.label, results.back());
+    }
+
+    const auto& serial = results[1].hashes;
+    const size_t difference = first_difference(serial, results[2].hashes);
+    if (difference < serial.size()) {
+        cerr << "My backend differs with the job system from frame "
+             << difference << endl;
+        error = -1;
+    } else {
+        cout << "My backend: same states with and without the job system"
+             << endl;
+    }
+
+    if (!hash_file.empty()) {
+        ifstream in(hash_file);
+        if (in) {
+            // the serial run of the in-house backend against a previous one
+            vector<uint64_t> previous;
+            uint64_t hash;
+            while (in >> hex >> hash) previous.push_back(hash);
+            const size_t frame = first_difference(previous, serial);
+            if (frame < max(previous.size(), serial.size())) {
+                cerr << "Differs from " << hash_file << " from frame "
+                     << frame << endl;
+                error = -1;
+            } else {
+                cout << "Same states as " << hash_file << endl;
+            }
+        } else {
+            ofstream out(hash_file);
+            for (const auto hash : serial) out << hex << hash << endl;
+            cout << "Hashes written to " << hash_file << endl;
+        }
+    }
+
+    return error;
+}
@@ -0,0 +1,130 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "AudioManager.hpp"
+#include "BaseApplication.hpp"
+#include "Profiler.hpp"
+
+using namespace My;
+using namespace std;
+
+static size_t count_of(const string& text, const string& pattern) {
+    size_t count = 0;
+    for (auto i = text.find(pattern); i != string::npos;
+         i = text.find(pattern, i + 1)) {
+        count++;
+    }
+    return count;
+}
+
+static void test_disabled() {
+    assert(!Profiler::IsEnabled());
+    { PROFILE_SCOPE("Disabled"); }
+    Profiler::NextFrame();
+    assert(Profiler::GetFrames().empty());
+}
+
+static void test_zones() {
+    Profiler::SetEnabled(true);
+    Profiler::NextFrame();
+    Profiler::ClearFrames();
+
+    {
+        PROFILE_SCOPE("Outer");
+        {
+            PROFILE_SCOPE("Inner");
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        thread worker([] {
+            Profiler::SetThreadName("Worker");
+            PROFILE_SCOPE("Work");
+        });
+        worker.join();
+    }
+    Profiler::NextFrame();
+
+    assert(Profiler::GetFrames().size() == 1);
+    const auto& frame = Profiler::GetFrames().back();
+    assert(frame.zones.size() == 3 && frame.droppedCount == 0);
+    const ProfileZone *outer = nullptr, *inner = nullptr, *work = nullptr;
+    for (const auto& zone : frame.zones) {
+        const string name = zone.name;
+        if (name == "Outer") outer = &zone;
+        if (name == "Inner") inner = &zone;
+        if (name == "Work") work = &zone;
+    }
+    assert(outer && inner && work);
+    // nested in time and depth, the worker on a thread of its own
+    assert(outer->depth == 0 && inner->depth == 1 && work->depth == 0);
+    assert(outer->begin <= inner->begin && inner->end <= outer->end);
+    assert(inner->end - inner->begin >= 1000000);
+    assert(frame.begin <= outer->begin && outer->end <= frame.end);
+    assert(work->thread != outer->thread);
+    assert(Profiler::GetThreadName(work->thread) == "Worker");
+
+    // zones past what a thread buffers in a frame are counted, not kept
+    for (size_t i = 0; i < Profiler::kThreadBufferZones + 10; i++) {
+        PROFILE_SCOPE("Many");
+    }
+    Profiler::NextFrame();
+    assert(Profiler::GetFrames().back().zones.size() ==
+           Profiler::kThreadBufferZones);
+    assert(Profiler::GetFrames().back().droppedCount == 10);
+
+    // a frame event and a complete event per zone, and the track names
+    stringstream trace;
+    Profiler::WriteChromeTrace(trace);
+    const auto json = trace.str();
+    assert(json.rfind("{\"traceEvents\":[", 0) == 0);
+    assert(count_of(json, "\"ph\":\"X\"") ==
+           2 + 3 + Profiler::kThreadBufferZones);
+    assert(count_of(json, "\"name\":\"Frame ") == 2);
+    assert(count_of(json, "\"args\":{\"name\":\"Worker\"}") == 1);
+    assert(count_of(json, "\"args\":{\"name\":\"Frames\"}") == 1);
+
+    Profiler::ClearFrames();
+    Profiler::SetEnabled(false);
+}
+
+static void test_application() {
+    // a zone around the Tick() of every module, a frame per Tick()
+    BaseApplication app;
+    AudioManager audioManager;
+    audioManager.SetThreaded(false);
+    app.RegisterManagerModule(&audioManager);
+    assert(app.Initialize() == 0);
+
+    Profiler::SetEnabled(true);
+    app.Tick();
+    // the frame before the first Tick() had nothing in it
+    Profiler::ClearFrames();
+    app.Tick();
+    app.Tick();
+    Profiler::SetEnabled(false);
+
+    const auto& frames = Profiler::GetFrames();
+    assert(frames.size() == 2);
+    for (const auto& frame : frames) {
+        assert(frame.zones.size() == 1);
+        assert(string(frame.zones[0].name) == "AudioManager");
+        assert(Profiler::GetThreadName(frame.zones[0].thread) == "Main");
+    }
+    assert(frames[1].number == frames[0].number + 1);
+    assert(frames[0].end == frames[1].begin);
+
+    app.Finalize();
+    Profiler::ClearFrames();
+}
+
+int main() {
+    test_disabled();
+    test_zones();
+    test_application();
+
+    cout << "Profiler test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "BaseApplication.hpp"
+#include "RHI/Empty/EmptyGraphicsManager.hpp"
+#include "SceneManager.hpp"
+#include "TestMesh.hpp"
+#include "imgui.h"
+
+using namespace My;
+using namespace std;
+
+// Per-frame CPU cost of the graphics manager (constants, lights, LOD
+// selection and cluster culling) on a synthetic scene, without the job
+// system, with it, and with the pipelined frame loop. Nothing is rendered,
+// the Empty RHI only builds batch contexts.
+//
+// usage: SceneUpdateBenchmark [node count] [frame count] [worker count]
+
+static shared_ptr<SceneObjectMesh> create_sphere(uint32_t segments,
+                                                 uint32_t rings) {
+    vector<Vector3f> sphere_positions;
+    vector<uint32_t> sphere_indices;
+    generate_sphere(sphere_positions, sphere_indices, segments, rings);
+
+    // the arrays take the buffers over
+    const size_t vertex_count = sphere_positions.size();
+    auto* positions = new uint8_t[vertex_count * sizeof(Vector3f)];
+    memcpy(positions, sphere_positions.data(), vertex_count * sizeof(Vector3f));
+    const size_t index_count = sphere_indices.size();
+    auto* indices = new uint8_t[index_count * sizeof(uint32_t)];
+    memcpy(indices, sphere_indices.data(), index_count * sizeof(uint32_t));
+
+    auto mesh = make_shared<SceneObjectMesh>();
+    mesh->SetPrimitiveType(PrimitiveType::kPrimitiveTypeTriList);
+    mesh->AddVertexArray(SceneObjectVertexArray(
+        "position", 0, VertexDataType::kVertexDataTypeFloat3,
+        positions, vertex_count * 3));
+    mesh->AddIndexArray(SceneObjectIndexArray(
+        0, 0, IndexDataType::kIndexDataTypeInt32, indices, index_count));
+
+    mesh->Optimize();
+    mesh->BuildMeshlets();
+    mesh->GenerateLods(3);
+
+    return mesh;
+}
+
+class SyntheticSceneManager : public SceneManager {
+   public:
+    // a grid of node_count spheres sharing one mesh, lit by light_count
+    // omni lights and looked at by one camera
+    void CreateScene(uint32_t node_count, uint32_t light_count) {
+        auto scene = make_shared<Scene>("synthetic");
+
+        auto geometry = make_shared<SceneObjectGeometry>();
+        geometry->AddMesh(create_sphere(32, 16));
+        scene->Geometries["sphere"] = geometry;
+
+        const auto side = static_cast<uint32_t>(
+            ceil(sqrt(static_cast<double>(node_count))));
+        const float spacing = 3.0f;
+
+        for (uint32_t i = 0; i < node_count; i++) {
+            const string name = "node_" + to_string(i);
+            auto node = make_shared<SceneGeometryNode>(name);
+            node->SetVisibility(true);
+            node->SetIfCastShadow(false);
+            node->SetIfMotionBlur(false);
+            node->AddSceneObjectRef("sphere");
+
+            Matrix4X4f translation;
+            MatrixTranslation(translation, (i % side) * spacing,
+                              (i / side) * spacing, 0.0f);
+            node->AppendTransform(
+                "translation",
+                make_shared<SceneObjectTransform>(translation));
+
+            scene->GeometryNodes.emplace(name, node);
+            scene->SceneGraph->AppendChild(std::move(node));
+        }
+
+        for (uint32_t i = 0; i < light_count; i++) {
+            const string name = "light_" + to_string(i);
+            scene->Lights[name] = make_shared<SceneObjectOmniLight>();
+
+            auto node = make_shared<SceneLightNode>(name);
+            node->AddSceneObjectRef(name);
+            Matrix4X4f translation;
+            MatrixTranslation(translation, i * spacing * side / light_count,
+                              side * spacing * 0.5f, 10.0f);
+            node->AppendTransform(
+                "translation",
+                make_shared<SceneObjectTransform>(translation));
+
+            scene->LightNodes.emplace(name, node);
+            scene->SceneGraph->AppendChild(std::move(node));
+        }
+
+        {
+            auto camera = make_shared<SceneObjectPerspectiveCamera>(PI / 3.0f);
+            string near_param = "near", far_param = "far";
+            camera->SetParam(near_param, 1.0f);
+            camera->SetParam(far_param, side * spacing * 2.0f);
+            scene->Cameras["camera"] = camera;
+
+            auto node = make_shared<SceneCameraNode>("camera");
+            node->AddSceneObjectRef("camera");
+            Matrix4X4f translation;
+            MatrixTranslation(translation, -side * spacing * 0.25f,
+                              -side * spacing * 0.25f, side * spacing * 0.5f);
+            node->AppendTransform(
+                "translation",
+                make_shared<SceneObjectTransform>(translation));
+            node->SetTarget(
+                {side * spacing * 0.5f, side * spacing * 0.5f, 0.0f});
+
+            scene->CameraNodes.emplace("camera", node);
+            scene->SceneGraph->AppendChild(std::move(node));
+        }
+
+        m_pScene = scene;
+        m_nSceneRevision++;
+    }
+};
+
+class BenchmarkGraphicsManager : public EmptyGraphicsManager {
+   public:
+    [[nodiscard]] const Frame& GetCurrentFrame() const {
+        return m_Frames[m_nFrameIndex];
+    }
+};
+
+class BenchmarkApplication : public BaseApplication {
+   public:
+    using BaseApplication::BaseApplication;
+
+    // negative: one worker per extra hardware thread, null: run serially
+    void UseJobSystem(bool enable, int32_t worker_count) {
+        if (enable) {
+            m_pJobSystem = make_unique<JobSystem>(worker_count);
+        } else {
+            m_pJobSystem.reset();
+        }
+    }
+};
+
+struct RunResult {
+    double milliseconds_per_frame;
+    int32_t lights;
+    size_t visible_indices;
+    uint32_t lod_sum;
+};
+
+static RunResult run(BenchmarkApplication& app,
+                     BenchmarkGraphicsManager& graphicsManager,
+                     uint32_t frame_count) {
+    // warm up, the first tick also creates the batch contexts
+    for (uint32_t i = 0; i < 3; i++) app.Tick();
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frame_count; i++) app.Tick();
+    auto end = chrono::steady_clock::now();
+
+    RunResult result{};
+    result.milliseconds_per_frame =
+        chrono::duration<double, milli>(end - start).count() / frame_count;
+
+    const auto& frame = graphicsManager.GetCurrentFrame();
+    result.lights = frame.frameContext.numLights;
+    for (const auto& pDbc : frame.batchContexts) {
+        result.lod_sum += pDbc->lod;
+        if (!pDbc->clustersCulled) continue;
+        for (const auto& range : pDbc->visibleRanges) {
+            result.visible_indices += range.count;
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t node_count = (argc > 1) ? atoi(argv[1]) : 10000;
+    const uint32_t frame_count = (argc > 2) ? atoi(argv[2]) : 100;
+    const int32_t worker_count = (argc > 3) ? atoi(argv[3]) : -1;
+
+    GfxConfiguration config(8, 8, 8, 8, 24, 8, 4, 1920, 1080,
+                            "Scene Update Benchmark");
+    BenchmarkApplication app(config);
+    SyntheticSceneManager sceneManager;
+    BenchmarkGraphicsManager graphicsManager;
+
+    app.RegisterManagerModule(&sceneManager);
+    app.RegisterManagerModule(&graphicsManager);
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(config.screenWidth),
+                            static_cast<float>(config.screenHeight));
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    if (app.Initialize()) {
+        cerr << "Initialize failed" << endl;
+        return -1;
+    }
+
+    graphicsManager.ResizeCanvas(config.screenWidth, config.screenHeight);
+    sceneManager.CreateScene(node_count, 16);
+
+    app.UseJobSystem(false, 0);
+    const auto serial = run(app, graphicsManager, frame_count);
+
+    app.UseJobSystem(true, worker_count);
+    app.SetPipelinedFrameLoop(false);
+    const auto parallel = run(app, graphicsManager, frame_count);
+
+    app.SetPipelinedFrameLoop(true);
+    const auto pipelined = run(app, graphicsManager, frame_count);
+
+    cout << "Nodes: " << node_count << " Frames: " << frame_count << endl;
+    cout << "Serial:   " << serial.milliseconds_per_frame << " ms/frame"
+         << endl;
+    cout << "Parallel: " << parallel.milliseconds_per_frame << " ms/frame ("
+         << app.GetJobSystem()->GetWorkerCount() << " workers)" << endl;
+    cout << "Pipelined: " << pipelined.milliseconds_per_frame << " ms/frame"
+         << endl;
+    cout << "Speed up: "
+         << serial.milliseconds_per_frame / parallel.milliseconds_per_frame
+         << "x (parallel) "
+         << serial.milliseconds_per_frame / pipelined.milliseconds_per_frame
+         << "x (pipelined)" << endl;
+
+    // every path must produce the same frame, the scene is static so the
+    // frame of delay of the pipelined loop does not matter
+    int result = 0;
+    for (const auto& other : {parallel, pipelined}) {
+        if (serial.lights != other.lights ||
+            serial.visible_indices != other.visible_indices ||
+            serial.lod_sum != other.lod_sum) {
+            cerr << "Serial and parallel results differ!" << endl;
+            result = -1;
+        }
+    }
+
+    app.Finalize();
+    ImGui::DestroyContext();
+
+    return result;
+}
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "Skeleton.hpp"
+#include "Skinning.hpp"
+#include "random.hpp"
+
+using namespace My;
+using namespace std;
+
+// Skinned vertices per millisecond per core, with linear blend and dual
+// quaternion skinning, on one thread and on the job system. Every frame
+// two clips are sampled and blended into the pose the vertices are skinned
+// with.
+//
+// usage: SkinningBenchmark [vertex count] [joint count] [frame count]
+//                          [worker count]
+
+// random_f() always starts from the same seed, the mesh is the same for
+// every run
+static Quaternion<float> random_rotation(float max_angle) {
+    Vector3f axis = {random_f(-1.0f, 1.0f), random_f(-1.0f, 1.0f),
+                     random_f(-1.0f, 1.0f)};
+    Normalize(axis);
+    return QuaternionRotationAxis(axis, random_f(-max_angle, max_angle));
+}
+
+// joints bending slowly, one second long
+static SkeletalAnimationClip create_clip(const Skeleton& skeleton) {
+    SkeletalAnimationClip clip(skeleton.GetJointCount(), 1.0f, 30.0f);
+    for (size_t frame = 0; frame < clip.GetFrameCount(); frame++) {
+        auto* pose = clip.GetFrame(frame);
+        for (size_t i = 0; i < skeleton.GetJointCount(); i++) {
+            pose[i] = skeleton.GetBindPose()[i];
+            pose[i].rotation = random_rotation(0.3f);
+        }
+    }
+    return clip;
+}
+
+struct Mesh {
+    vector<uint16_t> joints;
+    vector<float> weights;
+    vector<float> positions;
+    vector<float> normals;
+    vector<float> skinnedPositions;
+    vector<float> skinnedNormals;
+
+    [[nodiscard]] SkinningStreams GetStreams() {
+        return {joints.data(),    weights.data(),
+                positions.data(), normals.data(),
+                skinnedPositions.data(), skinnedNormals.data()};
+    }
+};
+
+// vertices around random joints, each weighted to its joint and up to 3
+// others
+static Mesh create_mesh(size_t vertex_count, size_t joint_count) {
+    Mesh mesh;
+    mesh.joints.resize(vertex_count * kMaxJointInfluences);
+    mesh.weights.resize(vertex_count * kMaxJointInfluences);
+    mesh.positions.resize(vertex_count * 3);
+    mesh.normals.resize(vertex_count * 3);
+    mesh.skinnedPositions.resize(vertex_count * 3);
+    mesh.skinnedNormals.resize(vertex_count * 3);
+
+    for (size_t v = 0; v < vertex_count; v++) {
+        float total = 0.0f;
+        const auto influences = 1 + v % kMaxJointInfluences;
+        for (uint32_t k = 0; k < kMaxJointInfluences; k++) {
+            const auto i = v * kMaxJointInfluences + k;
+            mesh.joints[i] = static_cast<uint16_t>(
+                random_f(0.0f, static_cast<float>(joint_count - 1)));
+            mesh.weights[i] = k < influences ? random_f(0.1f, 1.0f) : 0.0f;
+            total += mesh.weights[i];
+        }
+        for (uint32_t k = 0; k < kMaxJointInfluences; k++) {
+            mesh.weights[v * kMaxJointInfluences + k] /= total;
+        }
+
+        Vector3f normal = {random_f(-1.0f, 1.0f), random_f(-1.0f, 1.0f),
+                           random_f(-1.0f, 1.0f)};
+        Normalize(normal);
+        for (int c = 0; c < 3; c++) {
+            mesh.positions[v * 3 + c] = random_f(-1.0f, 1.0f);
+            mesh.normals[v * 3 + c] = normal[c];
+        }
+    }
+
+    return mesh;
+}
+
+int main(int argc, char** argv) {
+    const auto vertex_count =
+        static_cast<size_t>(argc > 1 ? atoi(argv[1]) : 200000);
+    const auto joint_count =
+        static_cast<size_t>(argc > 2 ? atoi(argv[2]) : 64);
+    const auto frame_count =
+        static_cast<uint32_t>(argc > 3 ? atoi(argv[3]) : 100);
+    const int32_t worker_count = argc > 4 ? atoi(argv[4]) : -1;
+
+    // a random tree, a parent always before its children
+    Skeleton skeleton;
+    for (size_t i = 0; i < joint_count; i++) {
+        JointPose pose;
+        pose.translation = {0.0f, 0.0f, 0.2f};
+        const auto parent =
+            i == 0 ? Skeleton::kNoParent
+                   : static_cast<int16_t>(random_f(0.0f, i - 0.5f));
+        skeleton.AddJoint("joint_" + to_string(i), parent, pose);
+    }
+    const auto walk = create_clip(skeleton);
+    const auto run = create_clip(skeleton);
+    auto mesh = create_mesh(vertex_count, joint_count);
+    const auto streams = mesh.GetStreams();
+
+    vector<JointPose> pose(joint_count), other(joint_count);
+    vector<Matrix4X4f> model(joint_count), skinning(joint_count);
+    vector<DualQuaternion> dual_quaternions(joint_count);
+    double pose_ms = 0.0;
+    auto update_pose = [&](uint32_t frame) {
+        const auto start = chrono::steady_clock::now();
+        const float time_point = fmod(frame / 60.0f, 1.0f);
+        walk.Sample(time_point, pose.data());
+        run.Sample(time_point, other.data());
+        BlendPoses(pose.data(), other.data(),
+                   0.5f + 0.5f * sin(frame / 30.0f), joint_count,
+                   pose.data());
+        skeleton.LocalToModel(pose.data(), model.data());
+        skeleton.GetSkinningMatrices(model.data(), skinning.data());
+        BuildDualQuaternions(skinning.data(), joint_count,
+                             dual_quaternions.data());
+        pose_ms += chrono::duration<double, milli>(
+                       chrono::steady_clock::now() - start)
+                       .count();
+    };
+
+    JobSystem job_system(worker_count);
+    const uint32_t cores = job_system.GetWorkerCount() + 1;
+    const size_t grain_size = 4096;
+
+    cout << vertex_count << " vertices, " << joint_count << " joints, "
+         << frame_count << " frames, " << cores << " cores" << endl;
+
+    for (const bool dual_quaternion : {false, true}) {
+        for (const bool parallel : {false, true}) {
+            const auto start = chrono::steady_clock::now();
+            for (uint32_t frame = 0; frame < frame_count; frame++) {
+                update_pose(frame);
+                auto skin = [&](size_t begin, size_t end) {
+                    if (dual_quaternion) {
+                        SkinDualQuaternion(dual_quaternions.data(), streams,
+                                           begin, end);
+                    } else {
+                        SkinLinearBlend(skinning.data(), streams, begin, end);
+                    }
+                };
+                if (parallel) {
+                    job_system.ParallelFor(0, vertex_count, grain_size, skin);
+                } else {
+                    skin(0, vertex_count);
+                }
+            }
+            const double ms = chrono::duration<double, milli>(
+                                  chrono::steady_clock::now() - start)
+                                  .count();
+
+            const double vertices_per_ms =
+                static_cast<double>(vertex_count) * frame_count / ms;
+            cout << (dual_quaternion ? "dual quaternion" : "linear blend   ")
+                 << (parallel ? "  job system: " : "  one thread: ")
+                 << ms / frame_count << " ms/frame, "
+                 << vertices_per_ms / (parallel ? cores : 1)
+                 << " vertices/ms/core" << endl;
+        }
+    }
+    cout << "pose: " << pose_ms / (frame_count * 4) << " ms/frame" << endl;
+
+    return 0;
+}
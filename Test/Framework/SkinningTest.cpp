@@ -0,0 +1,262 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "CompiledAnimationClip.hpp"
+#include "Linear.hpp"
+#include "SceneBoneNode.hpp"
+#include "Skeleton.hpp"
+#include "Skinning.hpp"
+
+using namespace My;
+using namespace std;
+
+static bool near(float a, float b, float tolerance = 1e-4f) {
+    return fabs(a - b) < tolerance;
+}
+
+static bool near(const Matrix4X4f& a, const Matrix4X4f& b) {
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            if (!near(a[r][c], b[r][c])) return false;
+        }
+    }
+    return true;
+}
+
+static Vector3f transform_point(const Vector3f& p, const Matrix4X4f& m) {
+    Vector3f result;
+    for (int c = 0; c < 3; c++) {
+        result[c] =
+            p[0] * m[0][c] + p[1] * m[1][c] + p[2] * m[2][c] + m[3][c];
+    }
+    return result;
+}
+
+static void test_pose_matrices() {
+    JointPose pose;
+    pose.rotation = QuaternionRotationAxis({0.0f, 0.6f, 0.8f}, 1.1f);
+    pose.translation = {1.0f, -2.0f, 3.0f};
+    pose.scale = {2.0f, 0.5f, 1.5f};
+    auto back = JointPoseFromMatrix(JointPoseToMatrix(pose));
+    assert(near(JointPoseToMatrix(back), JointPoseToMatrix(pose)));
+
+    // a mirror
+    pose.scale = {-1.0f, 1.0f, 1.0f};
+    back = JointPoseFromMatrix(JointPoseToMatrix(pose));
+    assert(near(JointPoseToMatrix(back), JointPoseToMatrix(pose)));
+
+    // the shorter arc, q and -q blend to q
+    JointPose a, b;
+    a.rotation = QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.5f);
+    b.rotation = Quaternion<float>(-a.rotation);
+    b.translation = {2.0f, 0.0f, 0.0f};
+    JointPose blended;
+    BlendPoses(&a, &b, 0.5f, 1, &blended);
+    for (int k = 0; k < 4; k++) {
+        assert(near(blended.rotation[k], a.rotation[k]));
+    }
+    assert(near(blended.translation[0], 1.0f));
+}
+
+// a chain of three joints one unit apart along z
+static Skeleton create_chain() {
+    Skeleton skeleton;
+    JointPose pose;
+    const auto root = skeleton.AddJoint("root", Skeleton::kNoParent, pose);
+    pose.translation = {0.0f, 0.0f, 1.0f};
+    const auto middle = skeleton.AddJoint("middle", root, pose);
+    skeleton.AddJoint("tip", middle, pose);
+    return skeleton;
+}
+
+static void test_skeleton() {
+    const auto skeleton = create_chain();
+    assert(skeleton.GetJointCount() == 3);
+    assert(skeleton.FindJoint("tip") == 2);
+    assert(skeleton.FindJoint("none") == Skeleton::kNoParent);
+
+    // at the bind pose the skinning matrices do nothing
+    vector<Matrix4X4f> model(3), skinning(3);
+    skeleton.LocalToModel(skeleton.GetBindPose().data(), model.data());
+    skeleton.GetSkinningMatrices(model.data(), skinning.data());
+    Matrix4X4f identity;
+    BuildIdentityMatrix(identity);
+    for (const auto& matrix : skinning) assert(near(matrix, identity));
+    assert(near(model[2][3][2], 2.0f));
+
+    // bending the middle joint moves the tip around it
+    auto pose = skeleton.GetBindPose();
+    pose[1].rotation = QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, PI / 2.0f);
+    skeleton.LocalToModel(pose.data(), model.data());
+    const auto tip = transform_point({0.0f, 0.0f, 0.0f}, model[2]);
+    assert(near(tip[0], 0.0f) && near(tip[1], -1.0f) && near(tip[2], 1.0f));
+}
+
+// every vertex of a random looking mesh through both paths, against the
+// same vertex done one at a time
+static void test_skinning() {
+    const auto skeleton = create_chain();
+    auto pose = skeleton.GetBindPose();
+    pose[0].translation = {0.5f, 0.0f, 0.0f};
+    pose[1].rotation = QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, 0.7f);
+    pose[2].rotation = QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, -0.4f);
+    vector<Matrix4X4f> model(3), skinning(3);
+    skeleton.LocalToModel(pose.data(), model.data());
+    skeleton.GetSkinningMatrices(model.data(), skinning.data());
+    vector<DualQuaternion> dual_quaternions(3);
+    BuildDualQuaternions(skinning.data(), 3, dual_quaternions.data());
+
+    // not a multiple of the vertices skinned together
+    const size_t count = 19;
+    vector<uint16_t> joints(count * kMaxJointInfluences);
+    vector<float> weights(count * kMaxJointInfluences, 0.0f);
+    vector<float> positions(count * 3), normals(count * 3);
+    for (size_t v = 0; v < count; v++) {
+        const float z = 2.0f * v / (count - 1);
+        positions[v * 3 + 0] = cos(v * 1.3f);
+        positions[v * 3 + 1] = sin(v * 1.3f);
+        positions[v * 3 + 2] = z;
+        normals[v * 3 + 0] = cos(v * 1.3f);
+        normals[v * 3 + 1] = sin(v * 1.3f);
+        // the nearest two joints
+        const auto lower = static_cast<uint16_t>(min(z, 1.0f));
+        const float t = min(z - lower, 1.0f);
+        joints[v * kMaxJointInfluences + 0] = lower;
+        joints[v * kMaxJointInfluences + 1] = lower + 1;
+        weights[v * kMaxJointInfluences + 0] = 1.0f - t;
+        weights[v * kMaxJointInfluences + 1] = t;
+    }
+
+    vector<float> skinned_positions(count * 3), skinned_normals(count * 3);
+    SkinningStreams streams = {joints.data(),
+                               weights.data(),
+                               positions.data(),
+                               normals.data(),
+                               skinned_positions.data(),
+                               skinned_normals.data()};
+
+    // in two ranges, as two threads would
+    SkinLinearBlend(skinning.data(), streams, 0, 5);
+    SkinLinearBlend(skinning.data(), streams, 5, count);
+    for (size_t v = 0; v < count; v++) {
+        Matrix4X4f blended;
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                blended[r][c] = 0.0f;
+                for (uint32_t k = 0; k < 2; k++) {
+                    const auto i = v * kMaxJointInfluences + k;
+                    blended[r][c] += weights[i] * skinning[joints[i]][r][c];
+                }
+            }
+        }
+        const auto expected = transform_point(
+            {positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]},
+            blended);
+        for (int c = 0; c < 3; c++) {
+            assert(near(skinned_positions[v * 3 + c], expected[c]));
+        }
+    }
+
+    // rigid vertices go where their joint takes them, and the normals
+    // keep their length
+    SkinDualQuaternion(dual_quaternions.data(), streams, 0, count);
+    for (size_t v = 0; v < count; v++) {
+        const auto* joint = &joints[v * kMaxJointInfluences];
+        const auto* weight = &weights[v * kMaxJointInfluences];
+        const float* normal = &skinned_normals[v * 3];
+        assert(near(normal[0] * normal[0] + normal[1] * normal[1] +
+                        normal[2] * normal[2],
+                    1.0f));
+        if (weight[1] != 0.0f && weight[0] != 0.0f) continue;
+        const auto expected = transform_point(
+            {positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]},
+            skinning[weight[0] != 0.0f ? joint[0] : joint[1]]);
+        for (int c = 0; c < 3; c++) {
+            assert(near(skinned_positions[v * 3 + c], expected[c]));
+        }
+    }
+
+    // half way between a joint and one twisted by 180 degrees, linear
+    // blending collapses onto the axis, dual quaternions keep the radius
+    pose = skeleton.GetBindPose();
+    pose[1].rotation = QuaternionRotationAxis({0.0f, 0.0f, 1.0f}, PI);
+    skeleton.LocalToModel(pose.data(), model.data());
+    skeleton.GetSkinningMatrices(model.data(), skinning.data());
+    BuildDualQuaternions(skinning.data(), 3, dual_quaternions.data());
+    const uint16_t twist_joints[] = {0, 1, 0, 0};
+    const float twist_weights[] = {0.5f, 0.5f, 0.0f, 0.0f};
+    const float twist_position[] = {1.0f, 0.0f, 1.0f};
+    float twisted[3];
+    streams = {twist_joints, twist_weights, twist_position,
+               nullptr,      twisted,       nullptr};
+    SkinLinearBlend(skinning.data(), streams, 0, 1);
+    assert(near(hypot(twisted[0], twisted[1]), 0.0f));
+    SkinDualQuaternion(dual_quaternions.data(), streams, 0, 1);
+    assert(near(hypot(twisted[0], twisted[1]), 1.0f));
+    assert(near(twisted[2], 1.0f));
+}
+
+// bone nodes animated by a clip, recorded and sampled back
+static void test_animation() {
+    auto root = make_shared<SceneBoneNode>("root");
+    auto bend = make_shared<SceneObjectRotation>('x', 0.0f);
+    auto child = make_shared<SceneBoneNode>("child");
+    child->AppendTransform(
+        "translation", make_shared<SceneObjectTranslation>(0.0f, 0.0f, 1.0f));
+    child->AppendTransform("rotation", bend);
+    root->AppendChild(std::move(child));
+
+    Skeleton skeleton;
+    vector<const BaseSceneNode*> nodes;
+    skeleton.AddBoneNodes(*root, Skeleton::kNoParent, nodes);
+    assert(skeleton.GetJointCount() == 2 && nodes.size() == 2);
+    assert(skeleton.GetParents()[1] == 0);
+
+    SceneObjectAnimationClip clip(0);
+    auto track = make_shared<SceneObjectTrack>(
+        bend, make_shared<Linear<float, float>>(vector<float>({0.0f, 1.0f})),
+        make_shared<Linear<float, float>>(vector<float>({0.0f, 1.0f})),
+        SceneObjectTrackType::kScalar);
+    clip.AddTrack(track);
+    CompiledAnimationClip compiled;
+    assert(compiled.Compile(clip));
+
+    SkeletalAnimationClip recorded(2, 1.0f, 30.0f);
+    recorded.Record(compiled, nodes);
+    assert(recorded.GetFrameCount() == 31);
+
+    // a linear angle comes back as a slerp would have it
+    vector<JointPose> pose(2);
+    for (const float t : {0.0f, 0.25f, 0.5f, 1.0f, 2.0f}) {
+        recorded.Sample(t, pose.data());
+        const float angle = min(t, 1.0f);
+        const auto expected = QuaternionRotationAxis({1.0f, 0.0f, 0.0f}, angle);
+        float dot = 0.0f;
+        for (int k = 0; k < 4; k++) dot += pose[1].rotation[k] * expected[k];
+        assert(near(fabs(dot), 1.0f, 1e-3f));
+        assert(near(pose[1].translation[2], 1.0f));
+    }
+
+    // two clips half and half
+    SkeletalAnimationClip still(2, 0.0f, 30.0f);
+    assert(still.GetFrameCount() == 1);
+    vector<JointPose> other(2);
+    still.Sample(0.0f, other.data());
+    recorded.Sample(1.0f, pose.data());
+    BlendPoses(pose.data(), other.data(), 0.5f, 2, pose.data());
+    assert(near(pose[1].rotation[0], sin(0.25f), 1e-3f));
+}
+
+int main() {
+    test_pose_matrices();
+    test_skeleton();
+    test_skinning();
+    test_animation();
+
+    cout << "Skinning test passed" << endl;
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "SceneObjectAnimation.hpp"
+#include "geommath.hpp"
+
+// everything add_track() animated, in the order of the tracks
+static std::vector<std::shared_ptr<My::SceneObjectTransform>> transforms;
+
+static void add_track(My::SceneObjectAnimationClip& clip,
+                      std::shared_ptr<My::SceneObjectTransform> transform,
+                      std::shared_ptr<My::CurveBase> time,
+                      std::shared_ptr<My::CurveBase> value,
+                      My::SceneObjectTrackType type) {
+    transforms.push_back(transform);
+    auto track = std::make_shared<My::SceneObjectTrack>(
+        transform, std::move(time), std::move(value), type);
+    clip.AddTrack(track);
+}
+
+static My::Matrix4X4f rotation_scale_translation(float angle, float scale,
+                                                 float x) {
+    My::Matrix4X4f rotation, scaling, translation;
+    My::MatrixRotationZ(rotation, angle);
+    My::MatrixScale(scaling, scale, scale, scale);
+    My::MatrixTranslation(translation, x, 1.0f, -2.0f);
+    return scaling * rotation * translation;
+}
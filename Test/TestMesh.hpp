@@ -0,0 +1,44 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "geommath.hpp"
+
+// a closed uv sphere of unit radius without seams, rings - 1 rings of
+// segments vertices between the poles
+static void generate_sphere(std::vector<My::Vector3f>& positions,
+                            std::vector<uint32_t>& indices, uint32_t segments,
+                            uint32_t rings) {
+    positions.push_back({0.0f, 0.0f, 1.0f});
+    for (uint32_t r = 1; r < rings; r++) {
+        const float theta = static_cast<float>(PI) * r / rings;
+        for (uint32_t s = 0; s < segments; s++) {
+            const float phi = static_cast<float>(TWO_PI) * s / segments;
+            positions.push_back({std::sin(theta) * std::cos(phi),
+                                 std::sin(theta) * std::sin(phi),
+                                 std::cos(theta)});
+        }
+    }
+    positions.push_back({0.0f, 0.0f, -1.0f});
+
+    const auto south = static_cast<uint32_t>(positions.size() - 1);
+    auto ring = [segments](uint32_t r, uint32_t s) {
+        return 1 + (r - 1) * segments + s % segments;
+    };
+
+    for (uint32_t s = 0; s < segments; s++) {
+        indices.insert(indices.end(), {0, ring(1, s), ring(1, s + 1)});
+        indices.insert(indices.end(), {south, ring(rings - 1, s + 1),
+                                       ring(rings - 1, s)});
+    }
+
+    for (uint32_t r = 1; r + 1 < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            indices.insert(indices.end(),
+                           {ring(r, s), ring(r + 1, s), ring(r + 1, s + 1)});
+            indices.insert(indices.end(),
+                           {ring(r, s), ring(r + 1, s + 1), ring(r, s + 1)});
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "AssetLoader.hpp"
+#include "BaseApplication.hpp"
+#include "CompressedAnimationClip.hpp"
+#include "SceneManager.hpp"
+
+using namespace My;
+using namespace std;
+
+// Compresses the animation clips of a scene and reports how many keys and
+// bytes they take before and after, and the largest difference of a
+// transform over the clip.
+//
+// usage: AnimationCompressor [scene] [tolerance] [sample rate]
+
+struct Report {
+    size_t tracks = 0;
+    size_t keysBefore = 0;
+    size_t keysAfter = 0;
+    size_t bytesBefore = 0;
+    size_t bytesAfter = 0;
+    float maxError = 0.0f;
+};
+
+static void print_report(const string& name, const Report& report) {
+    cout << setw(32) << left << name << right << setw(8) << report.tracks
+         << setw(10) << report.keysBefore << setw(10) << report.keysAfter
+         << setw(12) << report.bytesBefore << setw(12) << report.bytesAfter
+         << scientific << setprecision(2) << setw(12) << report.maxError
+         << defaultfloat << endl;
+}
+
+static Report compress(const SceneObjectAnimationClip& clip, float tolerance,
+                       float sample_rate) {
+    Report report;
+    CompiledAnimationClip compiled;
+    if (!compiled.Compile(clip)) return report;
+    CompressedAnimationClip compressed;
+    compressed.Compress(compiled, tolerance, sample_rate);
+
+    report.tracks = compiled.GetTrackCount();
+    report.keysBefore = compiled.GetKeyCount();
+    report.keysAfter = compressed.GetKeyCount();
+    report.bytesBefore = compiled.GetMemorySize();
+    report.bytesAfter = compressed.GetMemorySize();
+
+    // both played at twice the sample rate
+    const auto end_time = compressed.GetEndTime();
+    for (float t = 0.0f; t <= end_time; t += 0.5f / sample_rate) {
+        compiled.Evaluate(t);
+        vector<Matrix4X4f> expected;
+        for (const auto& track : clip.GetTracks()) {
+            if (!track->GetTransform()) continue;
+            expected.push_back(static_cast<Matrix4X4f>(*track->GetTransform()));
+        }
+
+        compressed.Evaluate(t);
+        size_t i = 0;
+        for (const auto& track : clip.GetTracks()) {
+            if (!track->GetTransform()) continue;
+            const auto result = static_cast<Matrix4X4f>(*track->GetTransform());
+            for (int r = 0; r < 4; r++) {
+                for (int c = 0; c < 4; c++) {
+                    const float error = fabs(result[r][c] - expected[i][r][c]);
+                    report.maxError = max(report.maxError, error);
+                }
+            }
+            i++;
+        }
+    }
+
+    return report;
+}
+
+int main(int argc, char** argv) {
+    int error = 0;
+
+    BaseApplication app;
+    AssetLoader assetLoader;
+    SceneManager sceneManager;
+
+    app.RegisterManagerModule(&assetLoader);
+    app.RegisterManagerModule(&sceneManager);
+
+    error = app.Initialize();
+
+    const float tolerance =
+        argc >= 3 ? static_cast<float>(atof(argv[2])) : 1e-3f;
+    const float sample_rate =
+        argc >= 4 ? static_cast<float>(atof(argv[3])) : 30.0f;
+
+    if (argc >= 2) {
+        sceneManager.LoadScene(argv[1]);
+    } else {
+        sceneManager.LoadScene("Scene/splash.ogex");
+    }
+
+    auto& scene = sceneManager.GetSceneForRendering();
+    if (!scene) {
+        cerr << "Failed to load the scene" << endl;
+        app.Finalize();
+        return -1;
+    }
+
+    cout << setw(32) << left << "Clip" << right << setw(8) << "Tracks"
+         << setw(10) << "Keys" << setw(10) << "Keys'" << setw(12) << "Bytes"
+         << setw(12) << "Bytes'" << setw(12) << "Error" << endl;
+
+    Report total;
+    for (const auto& node : scene->AnimatableNodes) {
+        auto pNode = node.lock();
+        if (!pNode) continue;
+
+        BaseSceneNode::animation_clip_iterator it;
+        if (!pNode->GetFirstAnimationClip(it)) continue;
+        do {
+            const auto name =
+                pNode->GetName() + "[" + to_string(it->first) + "]";
+            const auto report = compress(*it->second, tolerance, sample_rate);
+            if (!report.tracks) {
+                cout << setw(32) << left << name << right
+                     << "  can not be compiled" << endl;
+                continue;
+            }
+            print_report(name, report);
+
+            total.tracks += report.tracks;
+            total.keysBefore += report.keysBefore;
+            total.keysAfter += report.keysAfter;
+            total.bytesBefore += report.bytesBefore;
+            total.bytesAfter += report.bytesAfter;
+            total.maxError = max(total.maxError, report.maxError);
+        } while (pNode->GetNextAnimationClip(it));
+    }
+
+    print_report("Total", total);
+
+    app.Finalize();
+
+    return error;
+}
@@ -0,0 +1,99 @@
+#include <iomanip>
+#include <iostream>
+
+#include "AssetLoader.hpp"
+#include "BaseApplication.hpp"
+#include "SceneManager.hpp"
+
+using namespace My;
+using namespace std;
+
+static void print_report(const string& name,
+                         const MeshOptimizationReport& report) {
+    cout << setw(32) << left << name << right << setw(10)
+         << report.before.triangles_count << setw(10)
+         << report.vertices_before << setw(10) << report.vertices_after
+         << fixed << setprecision(3) << setw(10) << report.before.acmr
+         << setw(10) << report.after.acmr << setw(10) << report.before.atvr
+         << setw(10) << report.after.atvr << endl;
+}
+
+int main(int argc, char** argv) {
+    int error = 0;
+    float overdraw_threshold = 1.05f;
+
+    BaseApplication app;
+    AssetLoader assetLoader;
+    SceneManager sceneManager;
+
+    app.RegisterManagerModule(&assetLoader);
+    app.RegisterManagerModule(&sceneManager);
+
+    error = app.Initialize();
+
+    // we want to see the numbers before optimization as well
+    sceneManager.EnableMeshOptimization(false);
+
+    if (argc >= 3) {
+        overdraw_threshold = static_cast<float>(atof(argv[2]));
+    }
+
+    if (argc >= 2) {
+        sceneManager.LoadScene(argv[1]);
+    } else {
+        sceneManager.LoadScene("Scene/splash.ogex");
+    }
+
+    auto& scene = sceneManager.GetSceneForRendering();
+    if (!scene) {
+        cerr << "Failed to load the scene" << endl;
+        app.Finalize();
+        return -1;
+    }
+
+    cout << setw(32) << left << "Geometry" << right << setw(10) << "Tris"
+         << setw(10) << "Verts" << setw(10) << "Welded" << setw(10) << "ACMR"
+         << setw(10) << "ACMR'" << setw(10) << "ATVR" << setw(10) << "ATVR'"
+         << endl;
+
+    MeshOptimizationReport total;
+    for (const auto& _it : scene->Geometries) {
+        const auto& pGeometry = _it.second;
+        for (size_t lod = 0;; lod++) {
+            auto pMesh = pGeometry->GetMeshLOD(lod).lock();
+            if (!pMesh) break;
+
+            auto report = pMesh->Optimize(overdraw_threshold);
+            print_report(_it.first + "[" + to_string(lod) + "]", report);
+
+            total.before.triangles_count += report.before.triangles_count;
+            total.before.vertices_transformed +=
+                report.before.vertices_transformed;
+            total.after.vertices_transformed +=
+                report.after.vertices_transformed;
+            total.vertices_before += report.vertices_before;
+            total.vertices_after += report.vertices_after;
+        }
+    }
+
+    if (total.before.triangles_count) {
+        const auto triangles =
+            static_cast<float>(total.before.triangles_count);
+        total.before.acmr = total.before.vertices_transformed / triangles;
+        total.after.acmr = total.after.vertices_transformed / triangles;
+    }
+    if (total.vertices_before) {
+        total.before.atvr = static_cast<float>(total.before.vertices_transformed) /
+                            total.vertices_before;
+    }
+    if (total.vertices_after) {
+        total.after.atvr = static_cast<float>(total.after.vertices_transformed) /
+                           total.vertices_after;
+    }
+
+    print_report("Total", total);
+
+    app.Finalize();
+
+    return error;
+}